@@ -85,6 +85,9 @@ class bpgl_comp_rational_camera : public vpgl_rational_camera<T>
   //: The generic camera interface. u represents image column, v image row.
   virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+  //: Project \p n points stored as x, y, z triples into \p uv, as u, v pairs
+  virtual void project(const T* xyz, std::size_t n, T* uv) const;
+
         // Interface for vnl
 
   //: Project a world point onto the image
@@ -119,6 +119,21 @@ void bpgl_comp_rational_camera<T>::project(const T x, const T y, const T z,
   v = pt[1];
 }
 
+template <class T>
+void bpgl_comp_rational_camera<T>::project(const T* xyz, std::size_t n, T* uv) const
+{
+  vpgl_rational_camera<T>::project(xyz, n, uv);
+  //transform each image point by the affine map
+  const T m00 = matrix_[0][0], m01 = matrix_[0][1], m02 = matrix_[0][2];
+  const T m10 = matrix_[1][0], m11 = matrix_[1][1], m12 = matrix_[1][2];
+  for (std::size_t i = 0; i < n; ++i, uv += 2)
+  {
+    const T ur = uv[0], vr = uv[1];
+    uv[0] = m00*ur + m01*vr + m02;
+    uv[1] = m10*ur + m11*vr + m12;
+  }
+}
+
 //vnl interface methods
 template <class T>
 vnl_vector_fixed<T, 2>
@@ -53,6 +53,8 @@ class  bpgl_segmented_rolling_shutter_camera : public bpgl_rolling_shutter_camer
   //: The generic camera interface. u represents image column, v image row.
   virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+  using vpgl_camera<T>::project;
+
   // === Interface for vnl ===
 
   //: Project a world point onto the image
@@ -13,7 +13,13 @@
 //   Daniel E. Crispell - Feb. 22, 2010 - Added versions of functions that allow user to provide own vnl_random object
 //   Brandon A. Mayer - Oct. 25, 2012 - Added static default random number generator. Consecutive calls to bsta_sampler
 //       produced the same samples if time between calls was less than std::time resolution.
+//   Oct 2026 - documented use from several threads
 // \endverbatim
+//
+// The functions without a vnl_random argument share default_rand, so
+// must not be called from two threads at once. For parallel sampling,
+// give each task its own counter-based generator, vnl_random(seed, task);
+// the samples of each task are then the same whatever the number of threads.
 
 #include <vector>
 #include <iostream>
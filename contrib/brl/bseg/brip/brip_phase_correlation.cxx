@@ -6,6 +6,7 @@
 #include <vnl/vnl_math.h>
 #include <vil/vil_math.h>
 #include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_fft_2d.h>
 #include <vil/vil_resample_bicub.h>
 #include <bsta/bsta_histogram.h>
 #include <bsta/bsta_otsu_threshold.h>
@@ -60,31 +61,64 @@ brip_phase_correlation(vil_image_view<float> const&img0,
 }
 
 bool brip_phase_correlation::compute_ffts(){
-  bool good = brip_vil_float_ops::fourier_transform(img0_, mag0_, phase0_);
-  if(!good) return false;
-  good =  brip_vil_float_ops::fourier_transform(img1_, mag1_, phase1_);
-  return good;
+  // the images are real, so only the left half of each spectrum is needed
+  unsigned ni = img0_.ni(), nj = img0_.nj();
+  if(ni == 0 || nj == 0) return false;
+  vnl_matrix<double> m0(nj, ni), m1(nj, ni);
+  for(unsigned j = 0; j<nj; ++j)
+    for(unsigned i = 0; i<ni; ++i){
+      m0(j,i) = img0_(i,j);
+      m1(j,i) = img1_(i,j);
+    }
+  vnl_fft_2d<double> fft(nj, ni);
+  fft.fwd_transform_real(m0, F0_);
+  fft.fwd_transform_real(m1, F1_);
+  return true;
+}
+
+vil_image_view<float> brip_phase_correlation::
+spectrum_image(vnl_matrix<std::complex<double> > const& F, bool phase) const{
+  unsigned ni = img0_.ni(), nj = img0_.nj();
+  if(F.rows() != nj || F.cols() != ni/2+1)
+    return vil_image_view<float>();
+  // as brip_vil_float_ops::fourier_transform: normalised, with the opposite
+  // sign convention to vnl_fft_2d, and zero frequency at the centre
+  double scale = 1.0/(double(ni)*nj);
+  vil_image_view<float> img(ni, nj);
+  for(unsigned j = 0; j<nj; ++j)
+    for(unsigned i = 0; i<ni; ++i){
+      unsigned r = (j + nj/2)%nj, c = (i + ni/2)%ni;
+      std::complex<double> v = scale*(2*c <= ni ? std::conj(F(r,c)) : F((nj-r)%nj, ni-c));
+      img(i,j) = phase ? static_cast<float>(std::arg(v)) : static_cast<float>(std::abs(v));
+    }
+  return img;
 }
 
 bool brip_phase_correlation::compute_correlation_array(){
-  unsigned ni0 = phase0_.ni(), nj0 = phase0_.nj();
-  unsigned ni1 = phase1_.ni(), nj1 = phase1_.nj();
-  if(ni0 != ni1 || nj0 != nj1) return false;
-  // form complex conjugate product of phase terms, magnitude is set to 1
-  vil_image_view<float>  prod_mag(ni0, nj0), prod_phase(ni0, nj0);
-  prod_mag.fill(1.0f);
-  for(unsigned j = 0; j<nj0; ++j)
-    for(unsigned i = 0; i<ni0; ++i)
-      prod_phase(i,j)=  phase0_(i,j) - phase1_(i,j);
-  //                                 ^---------------------complex conjugate (minus sign)
-  bool good = brip_vil_float_ops::inverse_fourier_transform(prod_mag, prod_phase, corr_);
-  if(good){
-    for(unsigned j = 0; j<corr_.nj(); ++j)
-      for(unsigned i = 0; i<corr_.ni(); ++i)
-        corr_(i,j) = std::fabs(corr_(i,j));
-  }
+  if(F0_.rows() != F1_.rows() || F0_.cols() != F1_.cols() || F0_.empty()) return false;
+  unsigned ni = img0_.ni(), nj = img0_.nj();
+  // form complex conjugate product of phase terms, magnitude is set to 1.
+  // A zero coefficient has phase zero.
+  vnl_matrix<std::complex<double> > prod(F0_.rows(), F0_.cols());
+  for(unsigned r = 0; r<prod.rows(); ++r)
+    for(unsigned c = 0; c<prod.cols(); ++c){
+      std::complex<double> f0 = F0_(r,c), f1 = F1_(r,c);
+      double a0 = std::abs(f0), a1 = std::abs(f1);
+      if(a0 > 0.0) f0 /= a0; else f0 = 1.0;
+      if(a1 > 0.0) f1 /= a1; else f1 = 1.0;
+      prod(r,c) = f0*std::conj(f1);
+      //               ^---------------------complex conjugate
+    }
+  // the inverse transform is real, since both images are
+  vnl_fft_2d<double> fft(nj, ni);
+  vnl_matrix<double> corr;
+  fft.bwd_transform_real(prod, corr);
+  corr_.set_size(ni, nj);
+  for(unsigned j = 0; j<nj; ++j)
+    for(unsigned i = 0; i<ni; ++i)
+      corr_(i,j) = static_cast<float>(std::fabs(corr(j,i)));
   thresh_ = compute_threshold(corr_);
-  return good;
+  return true;
 }
 float brip_phase_correlation::compute_threshold(vil_image_view<float> const& img) const{
   float min0, max0;
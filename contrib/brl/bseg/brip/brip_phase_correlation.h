@@ -9,7 +9,9 @@
 //
 // \verbatim
 //  Modifications
-//   <none yet>
+//   Oct 2026 - keep the half spectra of the images from real FFTs and form
+//              the correlation array from them with a real inverse FFT;
+//              the magnitude and phase images are made only when asked for
 // \endverbatim
 // Suppose two images are related by I1(u,v) = I0(u-tu, v-tv)
 // The Fourier transforms of the images are related by the shift theorem
@@ -49,7 +51,9 @@
 //
 #include <iostream>
 #include <vector>
+#include <complex>
 #include <vil/vil_image_view.h>
+#include <vnl/vnl_matrix.h>
 #include <vcl_compiler.h>
 
 // a struct for holding correlation peak info
@@ -76,10 +80,11 @@ class brip_phase_correlation
   bool extract_correlation_peaks();
   vil_image_view<float> img0() const {return img0_;}
   vil_image_view<float> img1() const {return img1_;}
-  vil_image_view<float> mag0() const {return mag0_;}
-  vil_image_view<float> phase0() const {return phase0_;}
-  vil_image_view<float> mag1() const {return mag0_;}
-  vil_image_view<float> phase1() const {return phase0_;}
+  // magnitude and phase of the transforms, centred as by brip_vil_float_ops::fourier_transform
+  vil_image_view<float> mag0() const {return spectrum_image(F0_, false);}
+  vil_image_view<float> phase0() const {return spectrum_image(F0_, true);}
+  vil_image_view<float> mag1() const {return spectrum_image(F1_, false);}
+  vil_image_view<float> phase1() const {return spectrum_image(F1_, true);}
   vil_image_view<float> correlation_array() const {return corr_;}
   vil_image_view<float> corr_peaks() const {return corr_peaks_;}
 
@@ -103,12 +108,13 @@ class brip_phase_correlation
   int nip2_margin1_;
   int njp2_margin1_;
 
-  // Fourier transform of img0_
-  vil_image_view<float> mag0_;
-  vil_image_view<float> phase0_;
+  // magnitude or phase image of a half spectrum
+  vil_image_view<float> spectrum_image(vnl_matrix<std::complex<double> > const& F, bool phase) const;
+
+  // Fourier transform of img0_ (left half, from vnl_fft_2d::fwd_transform_real)
+  vnl_matrix<std::complex<double> > F0_;
   // Fourier transform of img1_
-  vil_image_view<float> mag1_;
-  vil_image_view<float> phase1_;
+  vnl_matrix<std::complex<double> > F1_;
   // Inverse transform (correlation surface)
   vil_image_view<float> corr_;
   // Local maxima in the correlation surface
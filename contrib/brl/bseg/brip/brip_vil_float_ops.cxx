@@ -20,6 +20,7 @@
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_double_2x3.h>
 #include <vnl/algo/vnl_fft_prime_factors.h>
+#include <vnl/algo/vnl_fft_2d.h>
 #include <vnl/algo/vnl_svd.h>
 
 #include <vil/vil_pixel_format.h>
@@ -2329,54 +2330,16 @@ bool brip_vil_float_ops::fft_1d(int dir, int m, double* x, double* y)
 //: Perform a 2D FFT inplace given a complex 2D array
 //  The direction dir, 1 for forward, -1 for reverse
 //  The size of the array (nx,ny)
-//  Return false if there are memory problems or
-//  the dimensions are not powers of 2
+//  As fft_1d, the forward transform has a negative exponent and is
+//  divided by the number of elements. Any size is supported.
 //
 bool brip_vil_float_ops::fft_2d(vnl_matrix<std::complex<double> >& c,int nx,int ny,int dir)
 {
-  int i,j;
-  int mx, my;
-  double *real,*imag;
-  vnl_fft_prime_factors<double> pfx (nx);
-  vnl_fft_prime_factors<double> pfy (ny);
-  mx = (int)pfx.pqr()[0];
-  my = (int)pfy.pqr()[0];
-  // Transform the rows
-  real = new double[nx];
-  imag = new double[nx];
-  if (real == VXL_NULLPTR || imag == VXL_NULLPTR)
-    return false;
-  for (j=0;j<ny;j++) {
-    for (i=0;i<nx;i++) {
-      real[i] = c[j][i].real();
-      imag[i] = c[j][i].imag();
-    }
-    brip_vil_float_ops::fft_1d(dir,mx,real,imag);
-    for (i=0;i<nx;i++) {
-      std::complex<double> v(real[i], imag[i]);
-      c[j][i] = v;
-    }
-  }
-  delete [] real;
-  delete [] imag;
-  // Transform the columns
-  real = new double[ny];
-  imag = new double[ny];
-  if (real == VXL_NULLPTR || imag == VXL_NULLPTR)
-    return false;
-  for (i=0;i<nx;i++) {
-    for (j=0;j<ny;j++) {
-      real[j] = c[j][i].real();
-      imag[j] = c[j][i].imag();
-    }
-    fft_1d(dir,my,real,imag);
-    for (j=0;j<ny;j++) {
-      std::complex<double> v(real[j], imag[j]);
-      c[j][i] =  v;
-    }
-  }
-  delete [] real;
-  delete [] imag;
+  // vnl_fft_2d uses the opposite sign convention and does not normalise
+  vnl_fft_2d<double> fft(ny, nx);
+  fft.transform(c, -dir);
+  if (dir == 1)
+    c /= double(nx)*ny;
   return true;
 }
 
@@ -2419,24 +2382,24 @@ fourier_transform(vil_image_view<float> const& input,
   vnl_fft_prime_factors<float> pfy (h);
   if (!pfx.pqr()[0]||!pfy.pqr()[0])
     return false;
-  // fill the fft matrix
-  vnl_matrix<std::complex<double> > fft_matrix(h, w), fourier_matrix(h,w);
+  // the transform of a real image; only the left half needs computing
+  vnl_matrix<double> signal(h, w);
   for (unsigned y = 0; y<h; y++)
     for (unsigned x =0; x<w; x++)
-    {
-      std::complex<double> cv(input(x,y), 0.0);
-      fft_matrix.put(y, x, cv);
-    }
-#ifdef DEBUG
+      signal(y, x) = input(x,y);
+  vnl_fft_2d<double> fft(h, w);
+  vnl_matrix<std::complex<double> > half;
+  fft.fwd_transform_real(signal, half);
+
+  // fill the fft matrix as fft_2d would: conjugated, as vnl_fft_2d has the
+  // opposite sign convention, and normalised. The right half follows by
+  // conjugate symmetry.
+  const double scale = 1.0/(double(w)*h);
+  vnl_matrix<std::complex<double> > fft_matrix(h, w), fourier_matrix(h,w);
   for (unsigned r = 0; r<h; r++)
     for (unsigned c =0; c<w; c++)
-    {
-      std::complex<double> res = fft_matrix[r][c];
-      std::cout << res << '\n';
-    }
-#endif
+      fft_matrix[r][c] = scale * (2*c <= w ? std::conj(half[r][c]) : half[(h-r)%h][w-c]);
 
-  brip_vil_float_ops::fft_2d(fft_matrix, w, h, 1);
   brip_vil_float_ops::ftt_fourier_2d_reorder(fft_matrix, fourier_matrix);
   mag.set_size(w,h);
   phase.set_size(w,h);
@@ -159,7 +159,31 @@ static void test_phase_correlation_homography(){
         std::cout << "act_t_avg(" << act_tu<< ' ' << act_tv << '\n';
 #endif
 }
+//: A circularly shifted copy of a synthetic image
+static void test_phase_correlation_shift()
+{
+  const int ni = 64, nj = 64, tu = -5, tv = -3;
+  vil_image_view<float> img0(ni, nj), img1(ni, nj);
+  for (int j = 0; j<nj; ++j)
+    for (int i = 0; i<ni; ++i)
+      img0(i,j) = static_cast<float>(((i*7 + j*13) % 17) + ((i*i + 3*j) % 5)*3);
+  // I1(u,v) = I0(u-tu, v-tv)
+  for (int j = 0; j<nj; ++j)
+    for (int i = 0; i<ni; ++i)
+      img1(i,j) = img0((i - tu + ni) % ni, (j - tv + nj) % nj);
+  brip_phase_correlation bpc(img0, img1);
+  TEST("compute", bpc.compute(), true);
+  float t_u = 0.0f, t_v = 0.0f, conf = 0.0f;
+  TEST("translation", bpc.translation(t_u, t_v, conf), true);
+  std::cout << "t(" << t_u << ' ' << t_v << "): " << conf << '\n';
+  TEST_NEAR("tu", t_u, tu, 0.5);
+  TEST_NEAR("tv", t_v, tv, 0.5);
+  TEST("confident", conf > 0.5f, true);
+  TEST("magnitude image", bpc.mag1().ni() == unsigned(ni) && bpc.mag1().nj() == unsigned(nj), true);
+}
+
 static void test_phase_correlation(){
+        test_phase_correlation_shift();
         test_phase_correlation_ortho();
         test_phase_correlation_homography();
 }
@@ -17,6 +17,11 @@ void mbl_random_n_from_m::reseed(long new_seed)
   mz_random_.reseed(new_seed);
 }
 
+void mbl_random_n_from_m::reseed(long new_seed, vxl_uint_64 stream)
+{
+  mz_random_.reseed(vxl_uint_64(new_seed), stream);
+}
+
 //: Select n integers from range [0,m-1], without replacement
 void mbl_random_n_from_m::choose_n_from_m(std::vector<unsigned>& choice,
                                           unsigned int n, unsigned int m)
@@ -4,6 +4,10 @@
 // \file
 // \brief Randomly select n from m integers without replacement
 // \author Tim Cootes
+// \verbatim
+//  Modifications
+//   Oct 2026 - reseed() with a stream number, for parallel use
+// \endverbatim
 
 #include <iostream>
 #include <vector>
@@ -24,6 +28,12 @@ class mbl_random_n_from_m
   //: Set seed of random number generator
   void reseed(long new_seed);
 
+  //: Use stream number \p stream of a counter-based generator with the given seed.
+  //  Objects reseeded with the same seed and stream make the same choices,
+  //  so giving each task of a parallel loop its own stream makes the
+  //  choices independent of the number of threads.
+  void reseed(long new_seed, vxl_uint_64 stream);
+
   //: Select n integers from range [0,m-1], without replacement.
   //  ie all different
   //  n is required to be <= m; otherwise, the function abort()s.
@@ -11,6 +11,7 @@
 #include <iosfwd>
 #include <vimt/vimt_image_2d_of.h>
 #include <vimt/vimt_image_pyramid_builder.h>
+#include <vil/algo/vil_gauss_reduce.h>
 #include <vsl/vsl_binary_io.h>
 #include <vcl_compiler.h>
 
@@ -25,6 +26,9 @@ class vimt_gaussian_pyramid_builder_2d : public vimt_image_pyramid_builder
 
   mutable vimt_image_2d_of<T> work_im_;
 
+  //: Row buffer reused by each 1-5-8-5-1 reduction
+  mutable vil_gauss_reduce_workspace<T> workspace_;
+
   //: Filter width (usually 5 for a 15851 filter, or 3 for a 121 filter)
   unsigned filter_width_;
 
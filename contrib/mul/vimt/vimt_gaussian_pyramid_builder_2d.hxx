@@ -97,7 +97,7 @@ void vimt_gaussian_pyramid_builder_2d<T>::gauss_reduce(const vimt_image_2d_of<T>
       vil_gauss_reduce_121(src_im.image(),dest_im.image());
       break;
     case (5):
-      vil_gauss_reduce(src_im.image(),dest_im.image(),work_im_.image());
+      vil_gauss_reduce(src_im.image(),dest_im.image(),workspace_);
       break;
     default:
       std::cerr << "vimt_gaussian_pyramid_builder_2d<T>::gauss_reduce() "
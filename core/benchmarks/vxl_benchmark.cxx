@@ -0,0 +1,222 @@
+// This is core/benchmarks/vxl_benchmark.cxx
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include "vxl_benchmark.h"
+//:
+// \file
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# include <intrin.h>
+# define VXL_BENCHMARK_HAS_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+# include <x86intrin.h>
+# define VXL_BENCHMARK_HAS_RDTSC 1
+#else
+# define VXL_BENCHMARK_HAS_RDTSC 0
+#endif
+
+std::vector<vxl_benchmark>& vxl_benchmark_registry()
+{
+  static std::vector<vxl_benchmark> registry;
+  return registry;
+}
+
+bool vxl_benchmark_has_cycle_counter()
+{
+  return VXL_BENCHMARK_HAS_RDTSC != 0;
+}
+
+namespace
+{
+  //: Time stamp counter, or 0 where there is none
+  inline unsigned long long vxl_benchmark_cycles()
+  {
+#if VXL_BENCHMARK_HAS_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  typedef std::chrono::steady_clock vxl_benchmark_clock;
+
+  //: Nanoseconds for `calls` calls of f
+  double vxl_benchmark_time(std::function<void()> const& f, unsigned calls, double& cycles)
+  {
+    const unsigned long long c0 = vxl_benchmark_cycles();
+    const vxl_benchmark_clock::time_point t0 = vxl_benchmark_clock::now();
+    for (unsigned i = 0; i < calls; ++i)
+      f();
+    const vxl_benchmark_clock::time_point t1 = vxl_benchmark_clock::now();
+    cycles = double(vxl_benchmark_cycles() - c0);
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+  }
+
+  //: Median of v, which is reordered
+  double vxl_benchmark_median(std::vector<double>& v)
+  {
+    std::sort(v.begin(), v.end());
+    const std::size_t m = v.size()/2;
+    return v.size() % 2 ? v[m] : 0.5*(v[m-1] + v[m]);
+  }
+}
+
+vxl_benchmark_result vxl_benchmark_run(vxl_benchmark const& b, unsigned n,
+                                       vxl_benchmark_options const& options)
+{
+  vxl_benchmark_kernel k = b.make(n);
+  for (unsigned i = 0; i < options.warmup; ++i)
+    k.run();
+
+  // Enough calls per sample for the minimum sample time
+  double cycles;
+  const double first_ns = std::max(vxl_benchmark_time(k.run, 1, cycles), 1.0);
+  const unsigned calls = unsigned(std::max(1.0, std::ceil(options.min_sample_ms*1e6/first_ns)));
+
+  const unsigned reps = std::max(1u, options.reps);
+  std::vector<double> ns(reps), cy(reps);
+  for (unsigned r = 0; r < reps; ++r)
+  {
+    ns[r] = vxl_benchmark_time(k.run, calls, cy[r]) / calls;
+    cy[r] /= calls;
+  }
+
+  vxl_benchmark_result res;
+  res.name = b.name;
+  res.size = n;
+  res.reps = reps;
+  res.calls = calls;
+  res.min_ns = *std::min_element(ns.begin(), ns.end());
+  res.median_ns = vxl_benchmark_median(ns);
+  res.elements = k.elements;
+  res.bytes = k.bytes;
+  res.cycles_per_element = vxl_benchmark_has_cycle_counter() && k.elements > 0
+                         ? vxl_benchmark_median(cy)/k.elements : -1.0;
+  res.gb_per_s = res.median_ns > 0 ? k.bytes/res.median_ns : 0.0;
+  return res;
+}
+
+void vxl_benchmark_write_json(std::ostream& os, std::vector<vxl_benchmark_result> const& results)
+{
+  std::ostringstream s;
+  s.precision(6);
+  s << "{\n  \"format\": \"vxl_benchmarks 1\",\n  \"results\": [\n";
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    vxl_benchmark_result const& r = results[i];
+    s << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size
+      << ", \"reps\": " << r.reps << ", \"calls\": " << r.calls
+      << ", \"median_ns\": " << r.median_ns << ", \"min_ns\": " << r.min_ns
+      << ", \"elements\": " << r.elements << ", \"bytes\": " << r.bytes
+      << ", \"cycles_per_element\": ";
+    if (r.cycles_per_element < 0)
+      s << "null";
+    else
+      s << r.cycles_per_element;
+    s << ", \"gb_per_s\": " << r.gb_per_s << '}' << (i+1 < results.size() ? ",\n" : "\n");
+  }
+  s << "  ]\n}\n";
+  os << s.str();
+}
+
+namespace
+{
+  //: Position just after the colon following "key" in object o, or npos
+  std::size_t vxl_benchmark_find_key(std::string const& o, char const* key)
+  {
+    const std::string quoted = std::string("\"") + key + '"';
+    std::size_t p = o.find(quoted);
+    if (p == std::string::npos)
+      return p;
+    p = o.find(':', p + quoted.size());
+    return p == std::string::npos ? p : p + 1;
+  }
+
+  bool vxl_benchmark_read_string(std::string const& o, char const* key, std::string& value)
+  {
+    std::size_t p = vxl_benchmark_find_key(o, key);
+    if (p == std::string::npos || (p = o.find('"', p)) == std::string::npos)
+      return false;
+    const std::size_t e = o.find('"', p + 1);
+    if (e == std::string::npos)
+      return false;
+    value = o.substr(p + 1, e - p - 1);
+    return true;
+  }
+
+  bool vxl_benchmark_read_number(std::string const& o, char const* key, double& value)
+  {
+    const std::size_t p = vxl_benchmark_find_key(o, key);
+    if (p == std::string::npos)
+      return false;
+    std::istringstream s(o.substr(p));
+    return bool(s >> value);
+  }
+}
+
+bool vxl_benchmark_read_json(std::istream& is, std::vector<vxl_benchmark_result>& results)
+{
+  const std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  std::size_t p = text.find("\"results\"");
+  if (p == std::string::npos)
+    return false;
+  results.clear();
+  // Each result is an object with no nested objects
+  while ((p = text.find('{', p)) != std::string::npos)
+  {
+    const std::size_t e = text.find('}', p);
+    if (e == std::string::npos)
+      break;
+    const std::string o = text.substr(p, e - p);
+    vxl_benchmark_result r;
+    double size;
+    if (vxl_benchmark_read_string(o, "name", r.name) &&
+        vxl_benchmark_read_number(o, "size", size) &&
+        vxl_benchmark_read_number(o, "median_ns", r.median_ns))
+    {
+      r.size = unsigned(size);
+      r.reps = r.calls = 0;
+      r.min_ns = r.elements = r.bytes = r.gb_per_s = 0.0;
+      r.cycles_per_element = -1.0;
+      results.push_back(r);
+    }
+    p = e;
+  }
+  return !results.empty();
+}
+
+unsigned vxl_benchmark_compare(std::vector<vxl_benchmark_result> const& results,
+                               std::vector<vxl_benchmark_result> const& baseline,
+                               double threshold_percent, std::ostream& os)
+{
+  unsigned n_slower = 0;
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    vxl_benchmark_result const& r = results[i];
+    for (std::size_t j = 0; j < baseline.size(); ++j)
+    {
+      vxl_benchmark_result const& b = baseline[j];
+      if (b.name != r.name || b.size != r.size || b.median_ns <= 0)
+        continue;
+      const double change = 100.0*(r.median_ns/b.median_ns - 1.0);
+      const bool slower = change > threshold_percent;
+      if (slower)
+        ++n_slower;
+      os << std::left << std::setw(24) << r.name << std::right << std::setw(8) << r.size
+         << std::fixed << std::setprecision(1) << std::setw(10) << std::showpos << change
+         << std::noshowpos << "%" << (slower ? "  SLOWER" : "") << '\n';
+      os.flags(flags);
+      os.precision(precision);
+      break;
+    }
+  }
+  return n_slower;
+}
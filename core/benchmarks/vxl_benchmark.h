@@ -0,0 +1,112 @@
+// This is core/benchmarks/vxl_benchmark.h
+#ifndef vxl_benchmark_h_
+#define vxl_benchmark_h_
+//:
+// \file
+// \brief Harness for the microbenchmarks run by vxl_benchmarks
+//
+// A benchmark is a named kernel with a list of default problem sizes.
+// For each size the harness asks the benchmark to set up its data, calls
+// the kernel a few times untimed to warm caches and lazily built plans,
+// then times a number of samples, each of enough calls to last at least
+// a minimum time. It reports the median and best time per call, the time
+// stamp counter cycles per element where the processor has one, and the
+// bandwidth implied by the bytes the benchmark says one call moves.
+//
+// Results can be written as JSON and compared with a file written by an
+// earlier build, flagging any benchmark whose median time per call has
+// grown by more than a threshold.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <vcl_compiler.h>
+
+//: What one problem size of a benchmark provides to the harness
+struct vxl_benchmark_kernel
+{
+  //: One call of the timed operation
+  std::function<void()> run;
+  //: Elements processed by one call, for cycles per element
+  double elements;
+  //: Bytes read and written by one call, for bandwidth
+  double bytes;
+};
+
+//: A named kernel and the problem sizes it is timed at by default
+struct vxl_benchmark
+{
+  std::string name;
+  //: Meaning of the size, e.g. "n x n matrix"
+  std::string size_description;
+  std::vector<unsigned> default_sizes;
+  //: Set up the data for problem size n and return the kernel to time
+  std::function<vxl_benchmark_kernel(unsigned n)> make;
+};
+
+//: The timings of one benchmark at one size
+struct vxl_benchmark_result
+{
+  std::string name;
+  unsigned size;
+  //: Number of timed samples and calls per sample
+  unsigned reps, calls;
+  //: Median and best time per call, in nanoseconds
+  double median_ns, min_ns;
+  double elements, bytes;
+  //: Median time stamp counter cycles per element, or negative if not measured
+  double cycles_per_element;
+  //: Bytes per second at the median time, in units of 10^9
+  double gb_per_s;
+};
+
+//: How the benchmarks are run
+struct vxl_benchmark_options
+{
+  vxl_benchmark_options() : reps(7), warmup(2), min_sample_ms(20.0) {}
+  //: Timed samples per size
+  unsigned reps;
+  //: Untimed calls before timing
+  unsigned warmup;
+  //: Minimum duration of one sample
+  double min_sample_ms;
+};
+
+//: All the benchmarks, in the order they are run
+std::vector<vxl_benchmark>& vxl_benchmark_registry();
+
+//: Add the vnl benchmarks to the registry
+void vxl_add_vnl_benchmarks();
+
+//: Add the vil benchmarks to the registry
+void vxl_add_vil_benchmarks();
+
+//: True if cycles can be counted on this processor
+bool vxl_benchmark_has_cycle_counter();
+
+//: Time benchmark b at size n
+vxl_benchmark_result vxl_benchmark_run(vxl_benchmark const& b, unsigned n,
+                                       vxl_benchmark_options const& options);
+
+//: Write results as a JSON document
+void vxl_benchmark_write_json(std::ostream& os, std::vector<vxl_benchmark_result> const& results);
+
+//: Read results written by vxl_benchmark_write_json().
+// Only the name, size and median_ns of each result are needed.
+// Returns false if the stream holds no results.
+bool vxl_benchmark_read_json(std::istream& is, std::vector<vxl_benchmark_result>& results);
+
+//: Compare results with a baseline and print one line per benchmark found in both.
+// Returns the number of results whose median time exceeds the baseline
+// by more than threshold_percent.
+unsigned vxl_benchmark_compare(std::vector<vxl_benchmark_result> const& results,
+                               std::vector<vxl_benchmark_result> const& baseline,
+                               double threshold_percent, std::ostream& os);
+
+#endif // vxl_benchmark_h_
@@ -0,0 +1,130 @@
+// This is core/benchmarks/vxl_benchmarks.cxx
+//:
+// \file
+// \brief Microbenchmarks of the core numerics and imaging kernels
+//
+// Times each benchmark over a sweep of problem sizes and prints a table
+// of time per call, cycles per element and bandwidth. For example
+// \verbatim
+//   vxl_benchmarks -filter vil_ -sizes 512,1024 -json new.json
+//   vxl_benchmarks -json new.json -baseline old.json -threshold 5
+// \endverbatim
+// With -baseline, each result is compared with the same benchmark and
+// size in a file written by -json, and the program exits with status 1
+// if any median time grew by more than -threshold percent, so that a
+// continuous integration job can flag slowdowns.
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vul/vul_arg.h>
+#include "vxl_benchmark.h"
+
+int main(int argc, char** argv)
+{
+  vul_arg<bool> list("-list", "List the benchmarks and their default sizes", false);
+  vul_arg<std::string> filter("-filter", "Run only benchmarks whose name contains this", "");
+  vul_arg<std::vector<unsigned> > sizes("-sizes", "Problem sizes to use instead of each benchmark's own");
+  vul_arg<unsigned> reps("-reps", "Timed samples per size", 7);
+  vul_arg<unsigned> warmup("-warmup", "Untimed calls before timing", 2);
+  vul_arg<double> min_ms("-min_ms", "Minimum duration of one sample, in ms", 20.0);
+  vul_arg<bool> quick("-quick", "Smallest default size only, with short samples (smoke test)", false);
+  vul_arg<std::string> json("-json", "Write the results to this JSON file", "");
+  vul_arg<std::string> baseline("-baseline", "Compare with results in this JSON file", "");
+  vul_arg<double> threshold("-threshold", "Slowdown in percent reported as a regression", 10.0);
+  vul_arg_parse(argc, argv);
+
+  vxl_add_vnl_benchmarks();
+  vxl_add_vil_benchmarks();
+  std::vector<vxl_benchmark> const& all = vxl_benchmark_registry();
+
+  if (list())
+  {
+    for (unsigned i = 0; i < all.size(); ++i)
+    {
+      std::cout << all[i].name << " (" << all[i].size_description << "):";
+      for (unsigned j = 0; j < all[i].default_sizes.size(); ++j)
+        std::cout << ' ' << all[i].default_sizes[j];
+      std::cout << '\n';
+    }
+    return 0;
+  }
+
+  // Read the baseline first, so that a bad file is reported before the long run
+  std::vector<vxl_benchmark_result> base;
+  if (!baseline().empty())
+  {
+    std::ifstream is(baseline().c_str());
+    if (!is || !vxl_benchmark_read_json(is, base))
+    {
+      std::cerr << "vxl_benchmarks: no results in baseline file " << baseline() << '\n';
+      return 2;
+    }
+  }
+
+  vxl_benchmark_options options;
+  options.reps = reps();
+  options.warmup = warmup();
+  options.min_sample_ms = min_ms();
+  if (quick())
+  {
+    options.reps = 3;
+    options.warmup = 1;
+    options.min_sample_ms = 1.0;
+  }
+
+  std::cout << std::left << std::setw(24) << "benchmark" << std::right << std::setw(8) << "size"
+            << std::setw(14) << "median us" << std::setw(14) << "best us"
+            << std::setw(12) << (vxl_benchmark_has_cycle_counter() ? "cyc/elem" : "ns/elem")
+            << std::setw(10) << "GB/s" << '\n';
+  std::vector<vxl_benchmark_result> results;
+  for (unsigned i = 0; i < all.size(); ++i)
+  {
+    vxl_benchmark const& b = all[i];
+    if (b.name.find(filter()) == std::string::npos)
+      continue;
+    std::vector<unsigned> s = sizes().empty() ? b.default_sizes : sizes();
+    if (quick() && sizes().empty())
+      s.resize(1);
+    for (unsigned j = 0; j < s.size(); ++j)
+    {
+      vxl_benchmark_result r = vxl_benchmark_run(b, s[j], options);
+      const double per_element = r.cycles_per_element >= 0 ? r.cycles_per_element
+                                                            : r.median_ns/r.elements;
+      std::cout << std::left << std::setw(24) << r.name << std::right << std::setw(8) << r.size
+                << std::fixed << std::setprecision(2)
+                << std::setw(14) << r.median_ns*1e-3 << std::setw(14) << r.min_ns*1e-3
+                << std::setprecision(3) << std::setw(12) << per_element
+                << std::setprecision(2) << std::setw(10) << r.gb_per_s << '\n' << std::flush;
+      std::cout.unsetf(std::ios::fixed);
+      std::cout.precision(6);
+      results.push_back(r);
+    }
+  }
+
+  if (!json().empty())
+  {
+    std::ofstream os(json().c_str());
+    vxl_benchmark_write_json(os, results);
+    if (!os)
+    {
+      std::cerr << "vxl_benchmarks: could not write " << json() << '\n';
+      return 2;
+    }
+  }
+
+  if (!base.empty())
+  {
+    std::cout << "\nChange in median time from " << baseline() << ":\n";
+    const unsigned n_slower = vxl_benchmark_compare(results, base, threshold(), std::cout);
+    if (n_slower > 0)
+    {
+      std::cout << n_slower << " result(s) more than " << threshold() << "% slower\n";
+      return 1;
+    }
+  }
+  return 0;
+}
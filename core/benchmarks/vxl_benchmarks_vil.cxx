@@ -0,0 +1,123 @@
+// This is core/benchmarks/vxl_benchmarks_vil.cxx
+#include <memory>
+#include <string>
+#include <vector>
+#include "vxl_benchmark.h"
+//:
+// \file
+// \brief Benchmarks of vil_convolve_1d, vil_gauss_reduce, vil_resample_bilin and vil_load
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_image_view.h>
+#include <vil/vil_load.h>
+#include <vil/vil_save.h>
+#include <vil/vil_resample_bilin.h>
+#include <vil/algo/vil_convolve_1d.h>
+#include <vil/algo/vil_gauss_reduce.h>
+#include <vnl/vnl_random.h>
+#include <vul/vul_temp_filename.h>
+#include <vpl/vpl.h>
+
+namespace
+{
+  vil_image_view<vxl_byte> vxl_benchmark_random_image(unsigned n)
+  {
+    vnl_random rng(n);
+    vil_image_view<vxl_byte> im(n, n);
+    for (unsigned j = 0; j < n; ++j)
+      for (unsigned i = 0; i < n; ++i)
+        im(i, j) = vxl_byte(rng.lrand32(255));
+    return im;
+  }
+
+  struct vxl_benchmark_image_data
+  {
+    vil_image_view<vxl_byte> src, dest, work;
+    vil_image_view<float> fdest;
+  };
+
+  //: Rows of a byte image convolved with a symmetric 5-tap float kernel
+  vxl_benchmark_kernel vxl_benchmark_convolve_1d(unsigned n)
+  {
+    std::shared_ptr<vxl_benchmark_image_data> d(new vxl_benchmark_image_data);
+    d->src = vxl_benchmark_random_image(n);
+    vxl_benchmark_kernel k;
+    k.run = [d]() {
+      static const float kernel[5] = { 0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f };
+      vil_convolve_1d(d->src, d->fdest, kernel + 2, -2, 2, float(),
+                      vil_convolve_reflect_extend, vil_convolve_reflect_extend);
+    };
+    k.elements = double(n)*n;
+    k.bytes = double(n)*n*(sizeof(vxl_byte) + sizeof(float));
+    return k;
+  }
+
+  //: Byte image smoothed and subsampled to half size
+  vxl_benchmark_kernel vxl_benchmark_gauss_reduce(unsigned n)
+  {
+    std::shared_ptr<vxl_benchmark_image_data> d(new vxl_benchmark_image_data);
+    d->src = vxl_benchmark_random_image(n);
+    vxl_benchmark_kernel k;
+    k.run = [d]() { vil_gauss_reduce(d->src, d->dest, d->work); };
+    k.elements = double(n)*n;
+    k.bytes = 1.25*n*n*sizeof(vxl_byte);
+    return k;
+  }
+
+  //: Byte image sampled on a grid of n x n points 0.7 pixels apart
+  vxl_benchmark_kernel vxl_benchmark_resample_bilin(unsigned n)
+  {
+    std::shared_ptr<vxl_benchmark_image_data> d(new vxl_benchmark_image_data);
+    d->src = vxl_benchmark_random_image(n);
+    vxl_benchmark_kernel k;
+    k.run = [d, n]() { vil_resample_bilin(d->src, d->dest, 0.3, 0.3, 0.7, 0.0, 0.0, 0.7, int(n), int(n)); };
+    k.elements = double(n)*n;
+    k.bytes = 1.49*n*n*sizeof(vxl_byte); // 0.49 of the source is read
+    return k;
+  }
+
+  //: Temporary file removed when the last copy of the kernel goes
+  struct vxl_benchmark_temp_file
+  {
+    std::string name;
+    ~vxl_benchmark_temp_file() { vpl_unlink(name.c_str()); }
+  };
+
+  //: Byte image read from a binary PGM file, which the operating system will have cached
+  vxl_benchmark_kernel vxl_benchmark_load(unsigned n)
+  {
+    std::shared_ptr<vxl_benchmark_temp_file> f(new vxl_benchmark_temp_file);
+    f->name = vul_temp_filename() + ".pgm";
+    vil_save(vxl_benchmark_random_image(n), f->name.c_str());
+    std::shared_ptr<vil_image_view_base_sptr> sink(new vil_image_view_base_sptr);
+    vxl_benchmark_kernel k;
+    k.run = [f, sink]() { *sink = vil_load(f->name.c_str()); };
+    k.elements = double(n)*n;
+    k.bytes = 2.0*n*n*sizeof(vxl_byte);
+    return k;
+  }
+}
+
+void vxl_add_vil_benchmarks()
+{
+  std::vector<vxl_benchmark>& r = vxl_benchmark_registry();
+  vxl_benchmark b;
+  b.size_description = "n x n byte image";
+  b.default_sizes = { 256, 512, 1024, 2048 };
+
+  b.name = "vil_convolve_1d";
+  b.make = vxl_benchmark_convolve_1d;
+  r.push_back(b);
+
+  b.name = "vil_gauss_reduce";
+  b.make = vxl_benchmark_gauss_reduce;
+  r.push_back(b);
+
+  b.name = "vil_resample_bilin";
+  b.make = vxl_benchmark_resample_bilin;
+  r.push_back(b);
+
+  b.name = "vil_load";
+  b.make = vxl_benchmark_load;
+  r.push_back(b);
+}
@@ -0,0 +1,102 @@
+// This is core/benchmarks/vxl_benchmarks_vnl.cxx
+#include <complex>
+#include <memory>
+#include <vector>
+#include "vxl_benchmark.h"
+//:
+// \file
+// \brief Benchmarks of vnl_matrix multiplication, vnl_svd and vnl_fft_1d
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_fft_1d.h>
+
+namespace
+{
+  vnl_matrix<double> vxl_benchmark_random_matrix(unsigned r, unsigned c, vnl_random& rng)
+  {
+    vnl_matrix<double> M(r, c);
+    for (unsigned i = 0; i < r; ++i)
+      for (unsigned j = 0; j < c; ++j)
+        M(i, j) = rng.drand64(-1.0, 1.0);
+    return M;
+  }
+
+  struct vxl_benchmark_product_data
+  {
+    vnl_matrix<double> a, b, c;
+  };
+
+  //: C = A*B, counting one element per multiply-add
+  vxl_benchmark_kernel vxl_benchmark_matrix_multiply(unsigned n)
+  {
+    vnl_random rng(n);
+    std::shared_ptr<vxl_benchmark_product_data> d(new vxl_benchmark_product_data);
+    d->a = vxl_benchmark_random_matrix(n, n, rng);
+    d->b = vxl_benchmark_random_matrix(n, n, rng);
+    vxl_benchmark_kernel k;
+    k.run = [d]() { d->c = d->a * d->b; };
+    k.elements = double(n)*n*n;
+    k.bytes = 3.0*n*n*sizeof(double);
+    return k;
+  }
+
+  //: Full SVD of a square matrix, counting one element per matrix entry
+  vxl_benchmark_kernel vxl_benchmark_svd(unsigned n)
+  {
+    vnl_random rng(n);
+    std::shared_ptr<vnl_matrix<double> > a(new vnl_matrix<double>(vxl_benchmark_random_matrix(n, n, rng)));
+    std::shared_ptr<double> sink(new double(0.0));
+    vxl_benchmark_kernel k;
+    k.run = [a, sink]() { vnl_svd<double> svd(*a); *sink += svd.W(0); };
+    k.elements = double(n)*n;
+    k.bytes = 4.0*n*n*sizeof(double); // A, U, V and the working copy
+    return k;
+  }
+
+  struct vxl_benchmark_fft_data
+  {
+    explicit vxl_benchmark_fft_data(unsigned n) : fft(int(n)), x(n), y(n) {}
+    vnl_fft_1d<double> fft;
+    std::vector<std::complex<double> > x, y;
+  };
+
+  //: Forward transform of a complex signal; each call restores the input first
+  vxl_benchmark_kernel vxl_benchmark_fft_1d(unsigned n)
+  {
+    vnl_random rng(n);
+    std::shared_ptr<vxl_benchmark_fft_data> d(new vxl_benchmark_fft_data(n));
+    for (unsigned i = 0; i < n; ++i)
+      d->x[i] = std::complex<double>(rng.drand64(-1.0, 1.0), rng.drand64(-1.0, 1.0));
+    vxl_benchmark_kernel k;
+    k.run = [d]() { d->y = d->x; d->fft.fwd_transform(d->y); };
+    k.elements = n;
+    k.bytes = 3.0*n*sizeof(std::complex<double>);
+    return k;
+  }
+}
+
+void vxl_add_vnl_benchmarks()
+{
+  std::vector<vxl_benchmark>& r = vxl_benchmark_registry();
+  vxl_benchmark b;
+
+  b.name = "vnl_matrix_multiply";
+  b.size_description = "n x n double matrices";
+  b.default_sizes = { 64, 128, 256, 512 };
+  b.make = vxl_benchmark_matrix_multiply;
+  r.push_back(b);
+
+  b.name = "vnl_svd";
+  b.size_description = "n x n double matrix";
+  b.default_sizes = { 16, 64, 128, 256 };
+  b.make = vxl_benchmark_svd;
+  r.push_back(b);
+
+  b.name = "vnl_fft_1d";
+  b.size_description = "n complex doubles";
+  b.default_sizes = { 256, 1000, 1024, 4096, 65536 };
+  b.make = vxl_benchmark_fft_1d;
+  r.push_back(b);
+}
@@ -0,0 +1,3 @@
+// Instantiation of vgl_packed_rtree_2d<float>
+#include <vgl/algo/vgl_packed_rtree_2d.hxx>
+VGL_PACKED_RTREE_2D_INSTANTIATE(float);
@@ -16,6 +16,7 @@ DECLARE( test_homg );
 DECLARE( test_intersection );
 DECLARE( test_orient_box_3d );
 DECLARE( test_p_matrix );
+DECLARE( test_packed_rtree_2d );
 DECLARE( test_rotation_3d );
 DECLARE( test_rtree );
 
@@ -38,6 +39,7 @@ register_tests()
   REGISTER( test_intersection );
   REGISTER( test_orient_box_3d );
   REGISTER( test_p_matrix );
+  REGISTER( test_packed_rtree_2d );
   REGISTER( test_rotation_3d );
   REGISTER( test_rtree );
 }
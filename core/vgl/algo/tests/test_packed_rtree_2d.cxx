@@ -0,0 +1,148 @@
+// This is core/vgl/algo/tests/test_packed_rtree_2d.cxx
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vgl_packed_rtree_2d queries against exhaustive search
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/algo/vgl_packed_rtree_2d.h>
+#include <vnl/vnl_random.h>
+
+template <class T>
+static bool box_meets(vgl_box_2d<T> const& a, vgl_box_2d<T> const& b)
+{
+  return !a.is_empty() && !b.is_empty() &&
+         a.min_x() <= b.max_x() && a.max_x() >= b.min_x() &&
+         a.min_y() <= b.max_y() && a.max_y() >= b.min_y();
+}
+
+template <class T>
+static T box_distance2(vgl_box_2d<T> const& b, vgl_point_2d<T> const& p)
+{
+  const T dx = std::max(std::max(b.min_x() - p.x(), p.x() - b.max_x()), T(0));
+  const T dy = std::max(std::max(b.min_y() - p.y(), p.y() - b.max_y()), T(0));
+  return dx*dx + dy*dy;
+}
+
+template <class T>
+static std::vector<vgl_box_2d<T> > random_boxes(unsigned n, vnl_random& rng)
+{
+  std::vector<vgl_box_2d<T> > boxes(n);
+  for (unsigned i = 0; i < n; ++i)
+  {
+    const T x = T(rng.drand64(0.0, 100.0)), y = T(rng.drand64(0.0, 100.0));
+    boxes[i] = vgl_box_2d<T>(x, x + T(rng.drand64(0.0, 2.0)), y, y + T(rng.drand64(0.0, 2.0)));
+  }
+  return boxes;
+}
+
+template <class T>
+static void test_boxes(unsigned n, const char* type)
+{
+  std::cout << n << " boxes of " << type << '\n';
+  vnl_random rng(n);
+  std::vector<vgl_box_2d<T> > boxes = random_boxes<T>(n, rng);
+  if (n > 10)
+    boxes[10] = vgl_box_2d<T>(); // an empty box is never found
+  vgl_packed_rtree_2d<T> tree(boxes);
+  TEST("size", tree.size(), n);
+
+  std::vector<vgl_box_2d<T> > windows = random_boxes<T>(50, rng);
+  for (unsigned q = 0; q < windows.size(); ++q)
+    windows[q] = vgl_box_2d<T>(windows[q].min_x(), windows[q].min_x() + T(q % 7) * T(3),
+                               windows[q].min_y(), windows[q].min_y() + T(q % 5) * T(4));
+  windows.push_back(boxes[0]); // touching counts
+  bool same = true;
+  for (unsigned q = 0; q < windows.size(); ++q)
+  {
+    std::vector<unsigned> found, expected;
+    tree.search(windows[q], found);
+    for (unsigned i = 0; i < n; ++i)
+      if (box_meets(boxes[i], windows[q]))
+        expected.push_back(i);
+    std::sort(found.begin(), found.end());
+    same = same && found == expected;
+  }
+  TEST("window search as exhaustive search", same, true);
+
+  std::vector<std::vector<unsigned> > batch, serial(windows.size());
+  tree.search(windows, batch, 4);
+  for (unsigned q = 0; q < windows.size(); ++q)
+    tree.search(windows[q], serial[q]);
+  TEST("batched window search", batch == serial, true);
+
+  std::vector<vgl_point_2d<T> > points;
+  for (unsigned q = 0; q < 30; ++q)
+    points.push_back(vgl_point_2d<T>(T(rng.drand64(-10.0, 110.0)), T(rng.drand64(-10.0, 110.0))));
+  const unsigned k = 9;
+  same = true;
+  for (unsigned q = 0; q < points.size(); ++q)
+  {
+    std::vector<unsigned> found;
+    tree.nearest(points[q], k, found);
+    std::vector<T> d2;
+    for (unsigned i = 0; i < n; ++i)
+      if (!boxes[i].is_empty())
+        d2.push_back(box_distance2(boxes[i], points[q]));
+    std::sort(d2.begin(), d2.end());
+    same = same && found.size() == std::min<std::size_t>(k, d2.size());
+    for (unsigned j = 0; same && j < found.size(); ++j)
+      same = box_distance2(boxes[found[j]], points[q]) == d2[j];
+  }
+  TEST("k nearest as exhaustive search", same, true);
+
+  std::vector<std::vector<unsigned> > nn_batch, nn_serial(points.size());
+  tree.nearest(points, k, nn_batch, 4);
+  for (unsigned q = 0; q < points.size(); ++q)
+    tree.nearest(points[q], k, nn_serial[q]);
+  TEST("batched k nearest", nn_batch == nn_serial, true);
+
+  // The tree does not depend on the number of threads that built it
+  vgl_packed_rtree_2d<T> tree1(boxes, 1);
+  std::vector<std::vector<unsigned> > batch1;
+  tree1.search(windows, batch1, 1);
+  TEST("built on one thread", batch1 == batch, true);
+}
+
+static void test_points()
+{
+  vnl_random rng(3);
+  std::vector<vgl_point_2d<double> > points(5000);
+  for (unsigned i = 0; i < points.size(); ++i)
+    points[i] = vgl_point_2d<double>(rng.drand64(-1.0, 1.0), rng.drand64(-1.0, 1.0));
+  vgl_packed_rtree_2d<double> tree(points);
+  vgl_box_2d<double> window(-0.1, 0.2, -0.3, 0.0);
+  std::vector<unsigned> found, expected;
+  tree.search(window, found);
+  for (unsigned i = 0; i < points.size(); ++i)
+    if (window.contains(points[i]))
+      expected.push_back(i);
+  std::sort(found.begin(), found.end());
+  TEST("points in window", found == expected, true);
+  std::vector<unsigned> nn;
+  tree.nearest(points[1234], 1, nn);
+  TEST("nearest point to an item is itself", nn.size() == 1 && nn[0] == 1234, true);
+  TEST_NEAR("bounds", tree.bounds().width(), 2.0, 0.01);
+}
+
+static void test_packed_rtree_2d()
+{
+  vgl_packed_rtree_2d<double> empty;
+  std::vector<unsigned> found;
+  empty.search(vgl_box_2d<double>(0, 1, 0, 1), found);
+  empty.nearest(vgl_point_2d<double>(0, 0), 3, found);
+  TEST("empty tree", empty.empty() && found.empty() && empty.bounds().is_empty(), true);
+
+  test_boxes<double>(1, "double");
+  test_boxes<double>(16, "double");
+  test_boxes<double>(17, "double");
+  test_boxes<double>(3001, "double");
+  test_boxes<float>(70000, "float");
+  test_points();
+}
+
+TESTMAIN(test_packed_rtree_2d);
@@ -0,0 +1,109 @@
+// This is core/vgl/algo/vgl_packed_rtree_2d.h
+#ifndef vgl_packed_rtree_2d_h_
+#define vgl_packed_rtree_2d_h_
+//:
+// \file
+// \brief Static R-tree of 2D boxes or points, bulk loaded and stored in flat arrays
+//
+// vgl_rtree grows by inserting one item at a time into nodes allocated
+// separately on the heap, which suits data that changes but is slow to
+// build and to search for large static sets. vgl_packed_rtree_2d is built
+// once from all the items, using Sort-Tile-Recursive ordering (Leutenegger
+// et al., "STR: a simple and efficient algorithm for R-tree packing",
+// ICDE 1997): the items are sorted on x into vertical slices, and each
+// slice on y, so that consecutive runs of fan_out items are compact.
+// Every node is full except the last of each level.
+//
+// The boxes of each level are stored one after the other in four arrays
+// (min x, min y, max x, max y), and the children of node i of a level
+// are entries fan_out*i to fan_out*i+fan_out-1 of the level below, so
+// no pointers are stored and a node's children are tested against a
+// query with one loop over contiguous memory, which the compiler
+// vectorises. Sorting and the computation of the node boxes run on
+// several threads, as do the batched queries.
+//
+// Items are identified by their index in the vector the tree was built
+// from. Boxes are closed: a box touching the query window meets it.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_point_2d.h>
+
+template <class T>
+class vgl_packed_rtree_2d
+{
+ public:
+  //: Number of children of each node
+  static const unsigned fan_out = 16;
+
+  //: An empty tree
+  vgl_packed_rtree_2d() : n_(0) {}
+
+  //: Build a tree of the given boxes, on \p n_threads threads (0 for all)
+  explicit vgl_packed_rtree_2d(std::vector<vgl_box_2d<T> > const& boxes, unsigned n_threads = 0)
+  { build(boxes, n_threads); }
+
+  //: Build a tree of the given points, on \p n_threads threads (0 for all)
+  explicit vgl_packed_rtree_2d(std::vector<vgl_point_2d<T> > const& points, unsigned n_threads = 0)
+  { build(points, n_threads); }
+
+  //: Replace the contents with the given boxes; empty boxes meet nothing
+  void build(std::vector<vgl_box_2d<T> > const& boxes, unsigned n_threads = 0);
+
+  //: Replace the contents with the given points
+  void build(std::vector<vgl_point_2d<T> > const& points, unsigned n_threads = 0);
+
+  //: Number of items
+  std::size_t size() const { return n_; }
+
+  bool empty() const { return n_ == 0; }
+
+  //: Bounding box of all the items
+  vgl_box_2d<T> bounds() const;
+
+  //: Indices of the items that meet \p window, in no particular order.
+  // The indices are appended to \p result.
+  void search(vgl_box_2d<T> const& window, std::vector<unsigned>& result) const;
+
+  //: Search for each window in turn, on \p n_threads threads (0 for all)
+  void search(std::vector<vgl_box_2d<T> > const& windows,
+              std::vector<std::vector<unsigned> >& results, unsigned n_threads = 0) const;
+
+  //: Indices of the \p k items nearest to \p p, nearest first.
+  // The distance to a box is zero inside it. Fewer than k indices are
+  // returned if the tree holds fewer items. \p result is overwritten.
+  void nearest(vgl_point_2d<T> const& p, unsigned k, std::vector<unsigned>& result) const;
+
+  //: Find the k nearest items to each point in turn, on \p n_threads threads (0 for all)
+  void nearest(std::vector<vgl_point_2d<T> > const& points, unsigned k,
+               std::vector<std::vector<unsigned> >& results, unsigned n_threads = 0) const;
+
+ private:
+  //: Sort the items into STR order and compute the boxes of all levels
+  void pack(unsigned n_threads);
+
+  //: hit[c] is set if child c of the entries starting at \p base meets the window
+  void meets(std::size_t base, T x0, T y0, T x1, T y1, unsigned char* hit) const;
+
+  //: d2[c] is the squared distance from (x, y) to child c of the entries starting at \p base
+  void distances(std::size_t base, T x, T y, T* d2) const;
+
+  std::size_t n_;
+  //: Offset of each level in the box arrays; level 0 holds the items
+  std::vector<std::size_t> level_start_;
+  //: Box of each entry, items in STR order then each level of nodes, padded to a multiple of fan_out
+  std::vector<T> min_x_, min_y_, max_x_, max_y_;
+  //: Index in the input of the item at each position of level 0
+  std::vector<unsigned> index_;
+};
+
+#define VGL_PACKED_RTREE_2D_INSTANTIATE(T) extern "please include vgl/algo/vgl_packed_rtree_2d.hxx first"
+
+#endif // vgl_packed_rtree_2d_h_
@@ -0,0 +1,310 @@
+// This is core/vgl/algo/vgl_packed_rtree_2d.hxx
+#ifndef vgl_packed_rtree_2d_hxx_
+#define vgl_packed_rtree_2d_hxx_
+//:
+// \file
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include "vgl_packed_rtree_2d.h"
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vnl/vnl_thread_pool.h>
+
+//: Items per task in the parallel loops of the build
+const std::size_t vgl_packed_rtree_2d_grain = 16384;
+
+//: Number of tasks of about vgl_packed_rtree_2d_grain items each to process n items
+inline unsigned vgl_packed_rtree_2d_tasks(std::size_t n)
+{
+  return unsigned((n + vgl_packed_rtree_2d_grain - 1) / vgl_packed_rtree_2d_grain);
+}
+
+//: Sort v on several threads: each part is sorted, then pairs of parts are merged.
+// The result does not depend on the number of threads.
+template <class E>
+void vgl_packed_rtree_2d_sort(std::vector<E>& v, unsigned n_threads)
+{
+  unsigned parts = n_threads ? n_threads : vnl_thread_pool::hardware_threads();
+  parts = std::max(1u, std::min<unsigned>(parts, vgl_packed_rtree_2d_tasks(v.size())));
+  std::vector<std::size_t> b(parts + 1);
+  for (unsigned p = 0; p <= parts; ++p)
+    b[p] = v.size() * p / parts;
+  vnl_parallel_for(parts, [&](unsigned p) { std::sort(v.begin() + b[p], v.begin() + b[p+1]); }, n_threads);
+  for (unsigned width = 1; width < parts; width *= 2)
+  {
+    const unsigned n_merges = (parts + 2*width - 1) / (2*width);
+    vnl_parallel_for(n_merges, [&](unsigned m) {
+      const unsigned lo = 2*width*m, mid = std::min(lo + width, parts), hi = std::min(lo + 2*width, parts);
+      if (mid < hi)
+        std::inplace_merge(v.begin() + b[lo], v.begin() + b[mid], v.begin() + b[hi]);
+    }, n_threads);
+  }
+}
+
+template <class T>
+const unsigned vgl_packed_rtree_2d<T>::fan_out;
+
+template <class T>
+void vgl_packed_rtree_2d<T>::build(std::vector<vgl_box_2d<T> > const& boxes, unsigned n_threads)
+{
+  n_ = boxes.size();
+  min_x_.resize(n_); min_y_.resize(n_); max_x_.resize(n_); max_y_.resize(n_);
+  const T inf = std::numeric_limits<T>::infinity();
+  vnl_parallel_for(vgl_packed_rtree_2d_tasks(n_), [&](unsigned t) {
+    const std::size_t end = std::min(n_, (t + 1) * vgl_packed_rtree_2d_grain);
+    for (std::size_t i = t * vgl_packed_rtree_2d_grain; i < end; ++i)
+    {
+      vgl_box_2d<T> const& b = boxes[i];
+      if (b.is_empty())
+      {
+        min_x_[i] = min_y_[i] = inf;
+        max_x_[i] = max_y_[i] = -inf;
+      }
+      else
+      {
+        min_x_[i] = b.min_x(); min_y_[i] = b.min_y();
+        max_x_[i] = b.max_x(); max_y_[i] = b.max_y();
+      }
+    }
+  }, n_threads);
+  pack(n_threads);
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::build(std::vector<vgl_point_2d<T> > const& points, unsigned n_threads)
+{
+  n_ = points.size();
+  min_x_.resize(n_); min_y_.resize(n_); max_x_.resize(n_); max_y_.resize(n_);
+  vnl_parallel_for(vgl_packed_rtree_2d_tasks(n_), [&](unsigned t) {
+    const std::size_t end = std::min(n_, (t + 1) * vgl_packed_rtree_2d_grain);
+    for (std::size_t i = t * vgl_packed_rtree_2d_grain; i < end; ++i)
+    {
+      min_x_[i] = max_x_[i] = points[i].x();
+      min_y_[i] = max_y_[i] = points[i].y();
+    }
+  }, n_threads);
+  pack(n_threads);
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::pack(unsigned n_threads)
+{
+  level_start_.clear();
+  index_.clear();
+  if (n_ == 0)
+  {
+    min_x_.clear(); min_y_.clear(); max_x_.clear(); max_y_.clear();
+    return;
+  }
+  assert(n_ <= std::numeric_limits<unsigned>::max());
+  const std::size_t F = fan_out;
+  const unsigned n_tasks = vgl_packed_rtree_2d_tasks(n_);
+
+  // STR order: sort on the x of the box centres, cut into S slices of S
+  // leaves each, and sort each slice on y. Empty boxes go last.
+  typedef std::pair<T, unsigned> key_type;
+  std::vector<key_type> key(n_);
+  vnl_parallel_for(n_tasks, [&](unsigned t) {
+    const std::size_t end = std::min(n_, (t + 1) * vgl_packed_rtree_2d_grain);
+    for (std::size_t i = t * vgl_packed_rtree_2d_grain; i < end; ++i)
+      key[i] = key_type(min_x_[i] <= max_x_[i] ? (min_x_[i] + max_x_[i]) / 2 : std::numeric_limits<T>::max(),
+                        unsigned(i));
+  }, n_threads);
+  vgl_packed_rtree_2d_sort(key, n_threads);
+  const std::size_t n_leaves = (n_ + F - 1) / F;
+  const std::size_t S = std::size_t(std::ceil(std::sqrt(double(n_leaves))));
+  const std::size_t slice = S * F;
+  const unsigned n_slices = unsigned((n_ + slice - 1) / slice);
+  vnl_parallel_for(n_slices, [&](unsigned s) {
+    const std::size_t begin = s * slice, end = std::min(n_, begin + slice);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const unsigned j = key[i].second;
+      key[i].first = min_y_[j] <= max_y_[j] ? (min_y_[j] + max_y_[j]) / 2 : std::numeric_limits<T>::max();
+    }
+    std::sort(key.begin() + begin, key.begin() + end);
+  }, n_threads);
+
+  // Sizes of the levels, each padded to whole nodes; there is always a root node
+  std::vector<std::size_t> count(1, n_);
+  do
+    count.push_back((count.back() + F - 1) / F);
+  while (count.back() > 1);
+  level_start_.resize(count.size() + 1);
+  level_start_[0] = 0;
+  for (std::size_t k = 0; k < count.size(); ++k)
+    level_start_[k+1] = level_start_[k] + (count[k] + F - 1) / F * F;
+
+  const T inf = std::numeric_limits<T>::infinity();
+  std::vector<T> x0(level_start_.back(), inf), y0(level_start_.back(), inf),
+                 x1(level_start_.back(), -inf), y1(level_start_.back(), -inf);
+  index_.resize(n_);
+  vnl_parallel_for(n_tasks, [&](unsigned t) {
+    const std::size_t end = std::min(n_, (t + 1) * vgl_packed_rtree_2d_grain);
+    for (std::size_t i = t * vgl_packed_rtree_2d_grain; i < end; ++i)
+    {
+      const unsigned j = key[i].second;
+      index_[i] = j;
+      x0[i] = min_x_[j]; y0[i] = min_y_[j];
+      x1[i] = max_x_[j]; y1[i] = max_y_[j];
+    }
+  }, n_threads);
+  std::vector<key_type>().swap(key);
+
+  // Each node's box bounds its fan_out children, padding included
+  for (std::size_t k = 1; k < count.size(); ++k)
+  {
+    const std::size_t below = level_start_[k-1], here = level_start_[k], m = count[k];
+    vnl_parallel_for(vgl_packed_rtree_2d_tasks(m), [&](unsigned t) {
+      const std::size_t end = std::min(m, (t + 1) * vgl_packed_rtree_2d_grain);
+      for (std::size_t i = t * vgl_packed_rtree_2d_grain; i < end; ++i)
+      {
+        const std::size_t c = below + i*F;
+        T a0 = x0[c], b0 = y0[c], a1 = x1[c], b1 = y1[c];
+        for (std::size_t j = 1; j < F; ++j)
+        {
+          a0 = std::min(a0, x0[c+j]); b0 = std::min(b0, y0[c+j]);
+          a1 = std::max(a1, x1[c+j]); b1 = std::max(b1, y1[c+j]);
+        }
+        x0[here+i] = a0; y0[here+i] = b0; x1[here+i] = a1; y1[here+i] = b1;
+      }
+    }, n_threads);
+  }
+  min_x_.swap(x0); min_y_.swap(y0); max_x_.swap(x1); max_y_.swap(y1);
+}
+
+template <class T>
+vgl_box_2d<T> vgl_packed_rtree_2d<T>::bounds() const
+{
+  vgl_box_2d<T> b;
+  if (n_ == 0)
+    return b;
+  const std::size_t root = level_start_[level_start_.size() - 2];
+  if (min_x_[root] <= max_x_[root])
+  {
+    b.add(vgl_point_2d<T>(min_x_[root], min_y_[root]));
+    b.add(vgl_point_2d<T>(max_x_[root], max_y_[root]));
+  }
+  return b;
+}
+
+template <class T>
+inline void vgl_packed_rtree_2d<T>::meets(std::size_t base, T x0, T y0, T x1, T y1, unsigned char* hit) const
+{
+  T const* a0 = &min_x_[base];
+  T const* b0 = &min_y_[base];
+  T const* a1 = &max_x_[base];
+  T const* b1 = &max_y_[base];
+  for (unsigned c = 0; c < fan_out; ++c)
+    hit[c] = (unsigned char)((a0[c] <= x1) & (a1[c] >= x0) & (b0[c] <= y1) & (b1[c] >= y0));
+}
+
+template <class T>
+inline void vgl_packed_rtree_2d<T>::distances(std::size_t base, T x, T y, T* d2) const
+{
+  T const* a0 = &min_x_[base];
+  T const* b0 = &min_y_[base];
+  T const* a1 = &max_x_[base];
+  T const* b1 = &max_y_[base];
+  for (unsigned c = 0; c < fan_out; ++c)
+  {
+    const T dx = std::max(std::max(a0[c] - x, x - a1[c]), T(0));
+    const T dy = std::max(std::max(b0[c] - y, y - b1[c]), T(0));
+    d2[c] = dx*dx + dy*dy;
+  }
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::search(vgl_box_2d<T> const& window, std::vector<unsigned>& result) const
+{
+  if (n_ == 0 || window.is_empty())
+    return;
+  const T x0 = window.min_x(), y0 = window.min_y(), x1 = window.max_x(), y1 = window.max_y();
+  const unsigned top = unsigned(level_start_.size() - 2);
+  const std::size_t root = level_start_[top];
+  if (!(min_x_[root] <= x1 && max_x_[root] >= x0 && min_y_[root] <= y1 && max_y_[root] >= y0))
+    return;
+
+  // Nodes still to visit, as (level, index within the level)
+  std::vector<std::pair<unsigned, std::size_t> > stack;
+  stack.reserve(8 * fan_out);
+  stack.push_back(std::make_pair(top, std::size_t(0)));
+  unsigned char hit[fan_out];
+  while (!stack.empty())
+  {
+    const unsigned k = stack.back().first;
+    const std::size_t first = stack.back().second * fan_out;
+    stack.pop_back();
+    meets(level_start_[k-1] + first, x0, y0, x1, y1, hit);
+    for (unsigned c = 0; c < fan_out; ++c)
+      if (hit[c])
+      {
+        if (k == 1)
+          result.push_back(index_[first + c]);
+        else
+          stack.push_back(std::make_pair(k-1, first + c));
+      }
+  }
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::search(std::vector<vgl_box_2d<T> > const& windows,
+                                    std::vector<std::vector<unsigned> >& results, unsigned n_threads) const
+{
+  results.resize(windows.size());
+  vnl_parallel_for(unsigned(windows.size()), [&](unsigned q) {
+    results[q].clear();
+    search(windows[q], results[q]);
+  }, n_threads);
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::nearest(vgl_point_2d<T> const& p, unsigned k, std::vector<unsigned>& result) const
+{
+  result.clear();
+  if (n_ == 0 || k == 0)
+    return;
+  const T x = p.x(), y = p.y();
+
+  // Best first: entries ordered by their distance, (squared distance, (level, index within the level))
+  typedef std::pair<T, std::pair<unsigned, std::size_t> > entry;
+  std::priority_queue<entry, std::vector<entry>, std::greater<entry> > queue;
+  const unsigned top = unsigned(level_start_.size() - 2);
+  queue.push(entry(T(0), std::make_pair(top, std::size_t(0))));
+  T d2[fan_out];
+  while (!queue.empty() && result.size() < k)
+  {
+    const unsigned level = queue.top().second.first;
+    const std::size_t i = queue.top().second.second;
+    queue.pop();
+    if (level == 0)
+    {
+      result.push_back(index_[i]);
+      continue;
+    }
+    const std::size_t first = i * fan_out;
+    distances(level_start_[level-1] + first, x, y, d2);
+    for (unsigned c = 0; c < fan_out; ++c)
+      if (d2[c] < std::numeric_limits<T>::infinity())
+        queue.push(entry(d2[c], std::make_pair(level-1, first + c)));
+  }
+}
+
+template <class T>
+void vgl_packed_rtree_2d<T>::nearest(std::vector<vgl_point_2d<T> > const& points, unsigned k,
+                                     std::vector<std::vector<unsigned> >& results, unsigned n_threads) const
+{
+  results.resize(points.size());
+  vnl_parallel_for(unsigned(points.size()), [&](unsigned q) { nearest(points[q], k, results[q]); }, n_threads);
+}
+
+#undef VGL_PACKED_RTREE_2D_INSTANTIATE
+#define VGL_PACKED_RTREE_2D_INSTANTIATE(T) \
+template class vgl_packed_rtree_2d<T >
+
+#endif // vgl_packed_rtree_2d_hxx_
@@ -0,0 +1,3 @@
+#include <vil/vil_smart_ptr.hxx>
+#include <vil/vil_concurrent_block_cache.h>
+VIL_SMART_PTR_INSTANTIATE(vil_concurrent_block_cache);
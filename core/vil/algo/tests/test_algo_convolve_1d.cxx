@@ -1,12 +1,18 @@
 // This is core/vil/algo/tests/test_algo_convolve_1d.cxx
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <testlib/testlib_test.h>
 #include <vcl_compiler.h>
 #include <vxl_config.h> // for vxl_byte
 #include <vil/vil_new.h>
 #include <vil/vil_crop.h>
+#include <vil/vil_copy.h>
+#include <vil/vil_transpose.h>
 #include <vil/algo/vil_convolve_1d.h>
+#include <vil/algo/vil_convolve_1d_simd.h>
 
 
 inline void print_vector(const std::vector<double> & v)
@@ -306,9 +312,87 @@ static void test_algo_convolve_1d_double()
                                     vil_image_view<vxl_byte>(conv->get_view(n-4,4,n-4,4))), true);
 }
 
+//: Largest absolute difference between two float images of the same size
+static float max_abs_diff(const vil_image_view<float>& a, const vil_image_view<float>& b)
+{
+  float d = 0;
+  for (unsigned p=0;p<a.nplanes();++p)
+    for (unsigned j=0;j<a.nj();++j)
+      for (unsigned i=0;i<a.ni();++i)
+        d = std::max(d, std::fabs(a(i,j,p)-b(i,j,p)));
+  return d;
+}
+
+template <class srcT>
+static void test_algo_convolve_1d_simd(srcT, const char* type_name)
+{
+  std::cout << "Testing vectorised vil_convolve_1d for " << type_name << " images\n";
+  const vil_convolve_simd_level best = vil_convolve_simd_best_level();
+  std::cout << "Best available level: " << int(best) << '\n';
+
+  const float asym[7] = { 0.05f, -0.3f, 0.7f, 0.2f, 0.11f, 0.9f, -0.17f };
+  const float sym[9] = { 0.03f, 0.07f, 0.12f, 0.18f, 0.2f, 0.18f, 0.12f, 0.07f, 0.03f };
+
+  // Summed in another order, the symmetric results may differ by the rounding
+  // error bound: kernel size times float epsilon times the largest result, 255.
+  const float sym_tol = 9*std::numeric_limits<float>::epsilon()*255.0f;
+
+  bool asym_same = true, sym_close = true, sym_levels_same = true, strided_same = true;
+  for (unsigned ni=10; ni<=45; ++ni)
+  {
+    vil_image_view<srcT> src(ni, 3, 2);
+    for (unsigned p=0;p<src.nplanes();++p)
+      for (unsigned j=0;j<src.nj();++j)
+        for (unsigned i=0;i<ni;++i)
+          src(i,j,p) = srcT((i*29 + j*53 + p*7 + i*i) % 256);
+    // the same image with istep!=1
+    vil_image_view<srcT> strided = vil_transpose(vil_image_view<srcT>(src.nj(), ni, 2));
+    vil_copy_reformat(src, strided);
+
+    vil_image_view<float> asym_ref, sym_ref, sym_first, strided_ref;
+    vil_convolve_simd_set_level(vil_convolve_simd_none);
+    vil_convolve_1d(src, asym_ref, asym+2, -2, 4, float(),
+                    vil_convolve_reflect_extend, vil_convolve_constant_extend);
+    vil_convolve_1d(src, sym_ref, sym+4, -4, 4, float(),
+                    vil_convolve_zero_extend, vil_convolve_trim);
+    vil_convolve_1d(strided, strided_ref, sym+4, -4, 4, float(),
+                    vil_convolve_zero_extend, vil_convolve_trim);
+
+    for (int l=vil_convolve_simd_sse2; l<=best; ++l)
+    {
+      vil_convolve_simd_set_level(vil_convolve_simd_level(l));
+      vil_image_view<float> a, s;
+      vil_convolve_1d(src, a, asym+2, -2, 4, float(),
+                      vil_convolve_reflect_extend, vil_convolve_constant_extend);
+      vil_convolve_1d(src, s, sym+4, -4, 4, float(),
+                      vil_convolve_zero_extend, vil_convolve_trim);
+      asym_same = asym_same && vil_image_view_deep_equality(a, asym_ref);
+      sym_close = sym_close && max_abs_diff(s, sym_ref) < sym_tol;
+      if (!sym_first)
+        sym_first = s;
+      else
+        sym_levels_same = sym_levels_same && vil_image_view_deep_equality(s, sym_first);
+
+      vil_image_view<float> t_dest = vil_transpose(vil_image_view<float>(3, ni, 2));
+      vil_convolve_1d(strided, t_dest, sym+4, -4, 4, float(),
+                      vil_convolve_zero_extend, vil_convolve_trim);
+      strided_same = strided_same && vil_image_view_deep_equality(t_dest, strided_ref);
+    }
+  }
+  vil_convolve_simd_set_level(best);
+
+  TEST("Asymmetric kernel: identical to template loop", asym_same, true);
+  TEST("Symmetric kernel: close to template loop", sym_close, true);
+  TEST("Symmetric kernel: same result at every level", sym_levels_same, true);
+  TEST("Strided views: identical to template loop", strided_same, true);
+  TEST("Level restored", vil_convolve_simd_get_level(), best);
+}
+
 static void test_algo_convolve_1d()
 {
   test_algo_convolve_1d_double();
+  test_algo_convolve_1d_simd(vxl_byte(), "vxl_byte");
+  test_algo_convolve_1d_simd(float(), "float");
 }
 
 TESTMAIN(test_algo_convolve_1d);
@@ -1,11 +1,13 @@
 // This is core/vil/algo/tests/test_algo_gauss_reduce.cxx
 #include <iostream>
+#include <vector>
 #include <testlib/testlib_test.h>
 #include <vcl_compiler.h>
 #include <vxl_config.h> // for vxl_byte
 #include <vnl/vnl_math.h>
 #include <vil/vil_print.h>
 #include <vil/vil_image_view.h>
+#include <vil/vil_transpose.h>
 #include <vil/algo/vil_gauss_reduce.h>
 
 template <class T>
@@ -574,6 +576,87 @@ static void test_algo_gauss_reduce_2_3_byte_2d()
   TEST("Pixel (2,4)", image1(2,4), image0(3,6));
 }
 
+template <class T>
+static void test_algo_gauss_reduce_single_pass(T, const char* type_name)
+{
+  std::cout << "*******************************************************\n"
+            << " Testing single pass vil_gauss_reduce ("<<type_name<<")\n"
+            << "*******************************************************\n";
+  vil_gauss_reduce_workspace<T> workspace;
+  bool same = true;
+  const unsigned sizes[] = { 3, 4, 5, 6, 7, 12, 13, 24, 37 };
+  for (unsigned a=0;a<9;++a)
+    for (unsigned b=0;b<9;++b)
+    {
+      vil_image_view<T> src(sizes[a],sizes[b],2);
+      for (unsigned p=0;p<src.nplanes();++p)
+        for (unsigned j=0;j<src.nj();++j)
+          for (unsigned i=0;i<src.ni();++i)
+            src(i,j,p) = T((i*37+j*11+p*5+i*j) % 200);
+      vil_image_view<T> two_pass, work_im, single_pass;
+      vil_gauss_reduce(src,two_pass,work_im);
+      vil_gauss_reduce(src,single_pass,workspace);
+      same = same && vil_image_view_deep_equality(two_pass,single_pass);
+
+      // non-unit istep in source and destination
+      vil_image_view<T> t_src = vil_transpose(src), t_two_pass, t_single_pass;
+      vil_gauss_reduce(t_src,t_two_pass,work_im);
+      t_single_pass = vil_transpose(vil_image_view<T>(t_two_pass.nj(),t_two_pass.ni(),2));
+      vil_gauss_reduce(t_src,t_single_pass,workspace);
+      same = same && vil_image_view_deep_equality(t_two_pass,t_single_pass);
+    }
+  TEST("Same result as two pass vil_gauss_reduce", same, true);
+}
+
+static void test_algo_gauss_pyramid()
+{
+  std::cout << "***************************\n"
+            << " Testing vil_gauss_pyramid\n"
+            << "***************************\n";
+  vil_image_view<float> base(101,64,1);
+  for (unsigned j=0;j<base.nj();++j)
+    for (unsigned i=0;i<base.ni();++i)
+      base(i,j) = float((i*7+j*13)%50);
+
+  vil_gauss_reduce_workspace<float> workspace;
+  std::vector<vil_image_view<float> > levels;
+  vil_gauss_pyramid(base,levels,workspace);
+  TEST("Number of levels", levels.size(), 4);
+  TEST("Base is shallow copy", levels[0].top_left_ptr()==base.top_left_ptr(), true);
+  TEST("Top level size", levels[3].ni()==13 && levels[3].nj()==8, true);
+  bool same = true;
+  vil_image_view<float> work_im, expected = base;
+  for (unsigned l=1;l<levels.size();++l)
+  {
+    vil_image_view<float> next;
+    vil_gauss_reduce(expected,next,work_im);
+    same = same && vil_image_view_deep_equality(next,levels[l]);
+    expected = next;
+  }
+  TEST("Levels match repeated vil_gauss_reduce", same, true);
+
+  vil_memory_chunk_sptr chunk = levels[1].memory_chunk();
+  std::size_t n_bytes = workspace.size_in_bytes();
+  vil_gauss_pyramid(base,levels,workspace);
+  TEST("Workspace memory reused", levels[1].memory_chunk()==chunk &&
+       workspace.size_in_bytes()==n_bytes, true);
+  TEST("All levels in one chunk", levels[3].memory_chunk()==chunk, true);
+
+  vil_gauss_pyramid(base,levels,workspace,3);
+  TEST("max_levels", levels.size(), 3);
+  vil_gauss_pyramid(base,levels,workspace,99,20,3);
+  TEST("min_size", levels.size(), 2);
+  vil_image_view<float> reduced_121;
+  vil_gauss_reduce_121(base,reduced_121);
+  TEST("filter_width 3", vil_image_view_deep_equality(reduced_121,levels[1]), true);
+
+  // Odd sizes round up, so a 9x9 base gives a 5x5 level
+  vil_image_view<float> small_im(9,9,1);
+  small_im.fill(1.0f);
+  vil_gauss_pyramid(small_im,levels,workspace,99,5);
+  TEST("Odd size levels", levels.size()==2 && levels[1].ni()==5 && levels[1].nj()==5, true);
+}
+
 static void test_algo_gauss_reduce()
 {
   test_algo_gauss_reduce_byte(7);
@@ -608,6 +691,13 @@ static void test_algo_gauss_reduce()
   test_algo_gauss_reduce_uint_16(6);
   test_algo_gauss_reduce_121_uint_16(6,6);
   test_algo_gauss_reduce_121_uint_16(7,7);
+
+  test_algo_gauss_reduce_single_pass(vxl_byte(), "vxl_byte");
+  test_algo_gauss_reduce_single_pass(float(), "float");
+  test_algo_gauss_reduce_single_pass(double(), "double");
+  test_algo_gauss_reduce_single_pass(vxl_int_16(), "vxl_int_16");
+  test_algo_gauss_reduce_single_pass(vxl_uint_16(), "vxl_uint_16");
+  test_algo_gauss_pyramid();
 }
 
 TESTMAIN(test_algo_gauss_reduce);
@@ -0,0 +1,102 @@
+// This is core/vil/algo/tests/test_algo_parallel_for_tiles.cxx
+#include <iostream>
+#include <sstream>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_image_view.h>
+#include <vil/algo/vil_parallel_for_tiles.h>
+
+static void fill_pattern(vil_image_view<vxl_byte>& im)
+{
+  for (unsigned p=0; p<im.nplanes(); ++p)
+    for (unsigned j=0; j<im.nj(); ++j)
+      for (unsigned i=0; i<im.ni(); ++i)
+        im(i,j,p) = vxl_byte((i*37 + j*101 + p*13 + i*j*7) % 251);
+}
+
+static void test_tiling(vil_image_view<vxl_byte> const& src,
+                        vil_parallel_tiling const& tiling)
+{
+  std::ostringstream name;
+  name << " (" << src.ni() << 'x' << src.nj() << ", tiles "
+       << tiling.tile_ni << 'x' << tiling.tile_nj << ')';
+
+  vil_gauss_filter_5tap_params params(0.9);
+  vil_image_view<float> g_serial, g_parallel;
+  vil_gauss_filter_5tap(src, g_serial, params);
+  vil_gauss_filter_5tap(src, g_parallel, params, tiling);
+  TEST(("vil_gauss_filter_5tap"+name.str()).c_str(),
+       vil_image_view_deep_equality(g_serial, g_parallel), true);
+
+  vil_image_view<float> s_serial, s_parallel;
+  vil_sobel_3x3(src, s_serial);
+  vil_sobel_3x3(src, s_parallel, tiling);
+  TEST(("vil_sobel_3x3"+name.str()).c_str(),
+       vil_image_view_deep_equality(s_serial, s_parallel), true);
+
+  vil_image_view<float> gi_serial, gj_serial, gi_parallel, gj_parallel;
+  vil_sobel_3x3(src, gi_serial, gj_serial);
+  vil_sobel_3x3(src, gi_parallel, gj_parallel, tiling);
+  TEST(("vil_sobel_3x3 i,j"+name.str()).c_str(),
+       vil_image_view_deep_equality(gi_serial, gi_parallel) &&
+       vil_image_view_deep_equality(gj_serial, gj_parallel), true);
+
+  vil_structuring_element disk;
+  disk.set_to_disk(2.1);
+  vil_image_view<vxl_byte> m_serial, m_parallel;
+  vil_median(src, m_serial, disk);
+  vil_median(src, m_parallel, disk, tiling);
+  TEST(("vil_median"+name.str()).c_str(),
+       vil_image_view_deep_equality(m_serial, m_parallel), true);
+
+  const float kernel[5] = { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f };
+  vil_image_view<float> c_serial, c_parallel;
+  vil_convolve_1d(src, c_serial, kernel+2, -2, 2, float(),
+                  vil_convolve_reflect_extend, vil_convolve_periodic_extend);
+  vil_convolve_1d(src, c_parallel, kernel+2, -2, 2, float(),
+                  vil_convolve_reflect_extend, vil_convolve_periodic_extend, tiling);
+  TEST(("vil_convolve_1d"+name.str()).c_str(),
+       vil_image_view_deep_equality(c_serial, c_parallel), true);
+}
+
+static void test_algo_parallel_for_tiles()
+{
+  std::cout << "********************************\n"
+            << " Testing vil_parallel_for_tiles\n"
+            << "********************************\n";
+
+  vil_image_view<vxl_byte> src(53, 41, 2);
+  fill_pattern(src);
+
+  // bands of various heights, including single rows
+  test_tiling(src, vil_parallel_tiling(1, 0, 4));
+  test_tiling(src, vil_parallel_tiling(2, 0, 4));
+  test_tiling(src, vil_parallel_tiling(7, 0, 4));
+  test_tiling(src, vil_parallel_tiling(64, 0, 4));
+  // 2D tiles, which do not divide the image exactly
+  test_tiling(src, vil_parallel_tiling(5, 6, 4));
+  test_tiling(src, vil_parallel_tiling(1, 1, 3));
+  // images of 3 or fewer rows take a separate path in the gauss filter
+  vil_image_view<vxl_byte> small(9, 3, 1);
+  fill_pattern(small);
+  test_tiling(small, vil_parallel_tiling(2, 2, 4));
+
+  // every tile visited exactly once
+  vil_image_view<int> visits(30, 20);
+  visits.fill(0);
+  vil_parallel_for_tiles(30, 20, vil_parallel_tiling(3, 7, 4),
+    [&visits](unsigned i0, unsigned n_i, unsigned j0, unsigned n_j)
+  {
+    for (unsigned j=j0; j<j0+n_j; ++j)
+      for (unsigned i=i0; i<i0+n_i; ++i)
+        ++visits(i,j);
+  });
+  bool once = true;
+  for (unsigned j=0; j<20; ++j)
+    for (unsigned i=0; i<30; ++i)
+      once = once && visits(i,j)==1;
+  TEST("Each pixel in exactly one tile", once, true);
+}
+
+TESTMAIN(test_algo_parallel_for_tiles);
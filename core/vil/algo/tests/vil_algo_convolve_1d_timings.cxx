@@ -0,0 +1,84 @@
+//:
+// \file
+// \brief Tool to compare the speed of the vil_convolve_1d row loops.
+// Times the generic template loop against each vectorised level
+// available on this machine, for byte and float images and for
+// symmetric and asymmetric kernels of several sizes.
+
+#include <iostream>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_image_view.h>
+#include <vil/algo/vil_convolve_1d.h>
+#include <vil/algo/vil_convolve_1d_simd.h>
+
+const unsigned nstests = 5;
+
+//: Median time in ms of one convolution of src
+template <class srcT>
+double time_convolve(const vil_image_view<srcT>& src, vil_image_view<float>& dest,
+                     const std::vector<float>& kernel, int n_loops)
+{
+  const int h = int(kernel.size()/2);
+  std::vector<double> stats(nstests);
+  for (unsigned st=0;st<nstests;++st)
+  {
+    std::clock_t t0=std::clock();
+    for (int l=0;l<n_loops;++l)
+      vil_convolve_1d(src, dest, &kernel[h], -h, h, float(),
+                      vil_convolve_reflect_extend, vil_convolve_reflect_extend);
+    std::clock_t t1=std::clock();
+    stats[st] = 1000.0*(double(t1)-double(t0))/(double(n_loops)*CLOCKS_PER_SEC);
+  }
+  std::sort(stats.begin(), stats.end());
+  return stats[nstests/2];
+}
+
+template <class srcT>
+void run_for_type(const char* type_name, unsigned ni, unsigned nj, int n_loops)
+{
+  vil_image_view<srcT> src(ni, nj);
+  for (unsigned j=0;j<nj;++j)
+    for (unsigned i=0;i<ni;++i)
+      src(i,j) = srcT((i*17+j*31+i*j) % 256);
+  vil_image_view<float> dest;
+
+  const char* level_name[] = { "template", "sse2", "avx2" };
+  const vil_convolve_simd_level best = vil_convolve_simd_best_level();
+
+  for (unsigned n_taps=5; n_taps<=15; n_taps+=4)
+    for (int symmetric=1; symmetric>=0; --symmetric)
+    {
+      std::vector<float> kernel(n_taps);
+      for (unsigned k=0;k<n_taps;++k)
+      {
+        int d = int(k)-int(n_taps/2);
+        kernel[k] = 1.0f/(1.0f+float(d*d)) + (symmetric ? 0.0f : 0.01f*float(k));
+      }
+      std::cout<<type_name<<' '<<ni<<'x'<<nj<<", "<<n_taps<<" taps, "
+               <<(symmetric ? "symmetric" : "asymmetric")<<":\n";
+      double t_template = 0;
+      for (int l=vil_convolve_simd_none; l<=best; ++l)
+      {
+        vil_convolve_simd_set_level(vil_convolve_simd_level(l));
+        double t = time_convolve(src, dest, kernel, n_loops);
+        if (l==vil_convolve_simd_none) t_template = t;
+        std::cout<<"  "<<level_name[l]<<": "<<t<<"ms";
+        if (l!=vil_convolve_simd_none && t>0)
+          std::cout<<"  (x"<<t_template/t<<')';
+        std::cout<<'\n';
+      }
+    }
+  vil_convolve_simd_set_level(best);
+}
+
+int main(int, char *[])
+{
+  std::cout << "Median time per image over " << nstests << " runs\n";
+  run_for_type<vxl_byte>("vxl_byte", 512, 512, 5);
+  run_for_type<float>("float", 512, 512, 5);
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include <vil/vil_image_view.h>
 #include <vil/vil_image_resource.h>
 #include <vil/vil_property.h>
+#include <vil/algo/vil_convolve_1d_simd.h>
 
 
 //: Available options for boundary behavior
@@ -235,6 +236,54 @@ inline void vil_convolve_1d(const srcT* src0, unsigned nx, std::ptrdiff_t s_step
                        kernel,-k_hi,-k_lo,-1,ac,end_option);
 }
 
+//: Convolve kernel[x] (x in [k_lo,k_hi]) with a row of bytes, giving floats
+// Contiguous rows use the vectorised loops of vil_convolve_1d_simd.h.
+inline void vil_convolve_1d(const vxl_byte* src0, unsigned nx, std::ptrdiff_t s_step,
+                            float* dest0, std::ptrdiff_t d_step,
+                            const float* kernel,
+                            std::ptrdiff_t k_lo, std::ptrdiff_t k_hi,
+                            float ac,
+                            vil_convolve_boundary_option start_option,
+                            vil_convolve_boundary_option end_option)
+{
+  if (s_step!=1 || d_step!=1 || k_lo>0 || k_hi<0 ||
+      vil_convolve_simd_get_level()==vil_convolve_simd_none)
+  {
+    vil_convolve_1d<vxl_byte,float,float,float>(src0,nx,s_step,dest0,d_step,
+                                               kernel,k_lo,k_hi,ac,start_option,end_option);
+    return;
+  }
+  assert(k_hi - k_lo < int(nx));
+  vil_convolve_edge_1d(src0,nx,1,dest0,1,kernel,k_lo,k_hi,1,ac,start_option);
+  vil_convolve_1d_simd(src0,nx,dest0,kernel,k_lo,k_hi);
+  vil_convolve_edge_1d(src0+(nx-1),nx,-1,dest0+(nx-1),-1,
+                       kernel,-k_hi,-k_lo,-1,ac,end_option);
+}
+
+//: Convolve kernel[x] (x in [k_lo,k_hi]) with a row of floats
+// Contiguous rows use the vectorised loops of vil_convolve_1d_simd.h.
+inline void vil_convolve_1d(const float* src0, unsigned nx, std::ptrdiff_t s_step,
+                            float* dest0, std::ptrdiff_t d_step,
+                            const float* kernel,
+                            std::ptrdiff_t k_lo, std::ptrdiff_t k_hi,
+                            float ac,
+                            vil_convolve_boundary_option start_option,
+                            vil_convolve_boundary_option end_option)
+{
+  if (s_step!=1 || d_step!=1 || k_lo>0 || k_hi<0 ||
+      vil_convolve_simd_get_level()==vil_convolve_simd_none)
+  {
+    vil_convolve_1d<float,float,float,float>(src0,nx,s_step,dest0,d_step,
+                                            kernel,k_lo,k_hi,ac,start_option,end_option);
+    return;
+  }
+  assert(k_hi - k_lo < int(nx));
+  vil_convolve_edge_1d(src0,nx,1,dest0,1,kernel,k_lo,k_hi,1,ac,start_option);
+  vil_convolve_1d_simd(src0,nx,dest0,kernel,k_lo,k_hi);
+  vil_convolve_edge_1d(src0+(nx-1),nx,-1,dest0+(nx-1),-1,
+                       kernel,-k_hi,-k_lo,-1,ac,end_option);
+}
+
 //: Convolve kernel[i] (i in [k_lo,k_hi]) with srcT in i-direction
 // On exit dest_im(i,j) = sum src(i-x,j)*kernel(x)  (x=k_lo..k_hi)
 // \note  This function reverses the kernel. If you don't want the
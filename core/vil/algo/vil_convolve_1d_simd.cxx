@@ -0,0 +1,359 @@
+// This is core/vil/algo/vil_convolve_1d_simd.cxx
+#include <atomic>
+#include <cstring>
+#include "vil_convolve_1d_simd.h"
+//:
+// \file
+// \brief Vectorised inner loops of vil_convolve_1d
+//
+// Each vector lane computes one output pixel, accumulating the taps in
+// the same order as the scalar loop, and the pixels left over at the end
+// of a row go through the scalar loop. Multiplies and adds are kept
+// separate (no fused multiply-add), so every path gives the same result.
+
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vil/vil_config.h> // for VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled for that target function by function, and only
+// run if the processor supports it.
+#if defined(VXL_HAS_SSE2_HARDWARE_SUPPORT) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define VIL_CONVOLVE_SIMD_AVX2 1
+#define VIL_CONVOLVE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(VXL_HAS_SSE2_HARDWARE_SUPPORT) && defined(_MSC_VER) && _MSC_VER >= 1700 && defined(_M_X64)
+#define VIL_CONVOLVE_SIMD_AVX2 1
+#define VIL_CONVOLVE_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define VIL_CONVOLVE_SIMD_AVX2 0
+#endif
+
+//=======================================================================
+// Scalar loops, also used for the ends of rows
+//=======================================================================
+
+//: dest[i] = sum_x src[i-x]*kernel[x], for i in [i0,i1)
+template <class srcT>
+static void vil_convolve_simd_scalar(const srcT* src, float* dest,
+                                     std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                     const float* kernel,
+                                     std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  for (std::ptrdiff_t i=i0; i<i1; ++i)
+  {
+    float sum = 0;
+    for (std::ptrdiff_t k=k_hi; k>=k_lo; --k)
+      sum += kernel[k]*float(src[i-k]);
+    dest[i] = sum;
+  }
+}
+
+//: As vil_convolve_simd_scalar, for kernel[-x]==kernel[x], x in [-h,h]
+template <class srcT>
+static void vil_convolve_simd_scalar_sym(const srcT* src, float* dest,
+                                         std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                         const float* kernel, std::ptrdiff_t h)
+{
+  for (std::ptrdiff_t i=i0; i<i1; ++i)
+  {
+    float sum = 0;
+    for (std::ptrdiff_t k=h; k>0; --k)
+      sum += kernel[k]*(float(src[i-k])+float(src[i+k]));
+    sum += kernel[0]*float(src[i]);
+    dest[i] = sum;
+  }
+}
+
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+//=======================================================================
+// SSE2: 4 pixels per vector
+//=======================================================================
+
+static inline __m128 vil_convolve_simd_load4(const float* p)
+{
+  return _mm_loadu_ps(p);
+}
+
+static inline __m128 vil_convolve_simd_load4(const vxl_byte* p)
+{
+  int v;
+  std::memcpy(&v, p, 4);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+}
+
+template <class srcT>
+static void vil_convolve_simd_loop_sse2(const srcT* src, float* dest,
+                                        std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                        const float* kernel,
+                                        std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  std::ptrdiff_t i = i0;
+  for (; i+8<=i1; i+=8)
+  {
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    for (std::ptrdiff_t k=k_hi; k>=k_lo; --k)
+    {
+      const __m128 kk = _mm_set1_ps(kernel[k]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(kk, vil_convolve_simd_load4(src+i-k)));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(kk, vil_convolve_simd_load4(src+i+4-k)));
+    }
+    _mm_storeu_ps(dest+i, sum0);
+    _mm_storeu_ps(dest+i+4, sum1);
+  }
+  for (; i+4<=i1; i+=4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    for (std::ptrdiff_t k=k_hi; k>=k_lo; --k)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]),
+                                       vil_convolve_simd_load4(src+i-k)));
+    _mm_storeu_ps(dest+i, sum);
+  }
+  vil_convolve_simd_scalar(src, dest, i, i1, kernel, k_lo, k_hi);
+}
+
+template <class srcT>
+static void vil_convolve_simd_loop_sse2_sym(const srcT* src, float* dest,
+                                            std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                            const float* kernel, std::ptrdiff_t h)
+{
+  std::ptrdiff_t i = i0;
+  for (; i+8<=i1; i+=8)
+  {
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    for (std::ptrdiff_t k=h; k>0; --k)
+    {
+      const __m128 kk = _mm_set1_ps(kernel[k]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(kk, _mm_add_ps(vil_convolve_simd_load4(src+i-k),
+                                                        vil_convolve_simd_load4(src+i+k))));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(kk, _mm_add_ps(vil_convolve_simd_load4(src+i+4-k),
+                                                        vil_convolve_simd_load4(src+i+4+k))));
+    }
+    const __m128 k0 = _mm_set1_ps(kernel[0]);
+    _mm_storeu_ps(dest+i, _mm_add_ps(sum0, _mm_mul_ps(k0, vil_convolve_simd_load4(src+i))));
+    _mm_storeu_ps(dest+i+4, _mm_add_ps(sum1, _mm_mul_ps(k0, vil_convolve_simd_load4(src+i+4))));
+  }
+  for (; i+4<=i1; i+=4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    for (std::ptrdiff_t k=h; k>0; --k)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]),
+                                       _mm_add_ps(vil_convolve_simd_load4(src+i-k),
+                                                  vil_convolve_simd_load4(src+i+k))));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[0]), vil_convolve_simd_load4(src+i)));
+    _mm_storeu_ps(dest+i, sum);
+  }
+  vil_convolve_simd_scalar_sym(src, dest, i, i1, kernel, h);
+}
+
+#endif // VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+#if VIL_CONVOLVE_SIMD_AVX2
+
+//=======================================================================
+// AVX2: 8 pixels per vector
+//=======================================================================
+
+VIL_CONVOLVE_TARGET_AVX2
+static inline __m256 vil_convolve_simd_load8(const float* p)
+{
+  return _mm256_loadu_ps(p);
+}
+
+VIL_CONVOLVE_TARGET_AVX2
+static inline __m256 vil_convolve_simd_load8(const vxl_byte* p)
+{
+  __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+  return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x));
+}
+
+template <class srcT>
+VIL_CONVOLVE_TARGET_AVX2
+static void vil_convolve_simd_loop_avx2(const srcT* src, float* dest,
+                                        std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                        const float* kernel,
+                                        std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  std::ptrdiff_t i = i0;
+  for (; i+16<=i1; i+=16)
+  {
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    for (std::ptrdiff_t k=k_hi; k>=k_lo; --k)
+    {
+      const __m256 kk = _mm256_set1_ps(kernel[k]);
+      sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(kk, vil_convolve_simd_load8(src+i-k)));
+      sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(kk, vil_convolve_simd_load8(src+i+8-k)));
+    }
+    _mm256_storeu_ps(dest+i, sum0);
+    _mm256_storeu_ps(dest+i+8, sum1);
+  }
+  for (; i+8<=i1; i+=8)
+  {
+    __m256 sum = _mm256_setzero_ps();
+    for (std::ptrdiff_t k=k_hi; k>=k_lo; --k)
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel[k]),
+                                             vil_convolve_simd_load8(src+i-k)));
+    _mm256_storeu_ps(dest+i, sum);
+  }
+  vil_convolve_simd_scalar(src, dest, i, i1, kernel, k_lo, k_hi);
+}
+
+template <class srcT>
+VIL_CONVOLVE_TARGET_AVX2
+static void vil_convolve_simd_loop_avx2_sym(const srcT* src, float* dest,
+                                            std::ptrdiff_t i0, std::ptrdiff_t i1,
+                                            const float* kernel, std::ptrdiff_t h)
+{
+  std::ptrdiff_t i = i0;
+  for (; i+16<=i1; i+=16)
+  {
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    for (std::ptrdiff_t k=h; k>0; --k)
+    {
+      const __m256 kk = _mm256_set1_ps(kernel[k]);
+      sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(kk, _mm256_add_ps(vil_convolve_simd_load8(src+i-k),
+                                                                 vil_convolve_simd_load8(src+i+k))));
+      sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(kk, _mm256_add_ps(vil_convolve_simd_load8(src+i+8-k),
+                                                                 vil_convolve_simd_load8(src+i+8+k))));
+    }
+    const __m256 k0 = _mm256_set1_ps(kernel[0]);
+    _mm256_storeu_ps(dest+i, _mm256_add_ps(sum0, _mm256_mul_ps(k0, vil_convolve_simd_load8(src+i))));
+    _mm256_storeu_ps(dest+i+8, _mm256_add_ps(sum1, _mm256_mul_ps(k0, vil_convolve_simd_load8(src+i+8))));
+  }
+  for (; i+8<=i1; i+=8)
+  {
+    __m256 sum = _mm256_setzero_ps();
+    for (std::ptrdiff_t k=h; k>0; --k)
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel[k]),
+                                             _mm256_add_ps(vil_convolve_simd_load8(src+i-k),
+                                                           vil_convolve_simd_load8(src+i+k))));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel[0]), vil_convolve_simd_load8(src+i)));
+    _mm256_storeu_ps(dest+i, sum);
+  }
+  vil_convolve_simd_scalar_sym(src, dest, i, i1, kernel, h);
+}
+
+#endif // VIL_CONVOLVE_SIMD_AVX2
+
+//=======================================================================
+// Dispatch
+//=======================================================================
+
+static bool vil_convolve_simd_cpu_has_avx2()
+{
+#if VIL_CONVOLVE_SIMD_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1<<27)) != 0, avx = (info[2] & (1<<28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) // OS saves the ymm registers
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1<<5)) != 0;
+#elif VIL_CONVOLVE_SIMD_AVX2
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#else
+  return false;
+#endif
+}
+
+vil_convolve_simd_level vil_convolve_simd_best_level()
+{
+  static const vil_convolve_simd_level best =
+    vil_convolve_simd_cpu_has_avx2() ? vil_convolve_simd_avx2 :
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+    vil_convolve_simd_sse2;
+#else
+    vil_convolve_simd_none;
+#endif
+  return best;
+}
+
+//: Currently selected level, or -1 before the first use
+static std::atomic<int> vil_convolve_simd_current_level(-1);
+
+vil_convolve_simd_level vil_convolve_simd_get_level()
+{
+  int level = vil_convolve_simd_current_level.load(std::memory_order_relaxed);
+  if (level < 0)
+  {
+    level = vil_convolve_simd_best_level();
+    vil_convolve_simd_current_level.store(level, std::memory_order_relaxed);
+  }
+  return vil_convolve_simd_level(level);
+}
+
+vil_convolve_simd_level vil_convolve_simd_set_level(vil_convolve_simd_level level)
+{
+  if (level > vil_convolve_simd_best_level())
+    level = vil_convolve_simd_best_level();
+  vil_convolve_simd_current_level.store(level, std::memory_order_relaxed);
+  return level;
+}
+
+//: True if k_lo==-k_hi and kernel[-x]==kernel[x]
+static bool vil_convolve_simd_is_symmetric(const float* kernel,
+                                           std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  if (k_lo != -k_hi)
+    return false;
+  for (std::ptrdiff_t k=1; k<=k_hi; ++k)
+    if (kernel[k] != kernel[-k])
+      return false;
+  return true;
+}
+
+template <class srcT>
+static void vil_convolve_simd_dispatch(const srcT* src, unsigned nx, float* dest,
+                                       const float* kernel,
+                                       std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  assert(k_lo <= 0 && k_hi >= 0 && k_hi - k_lo < std::ptrdiff_t(nx));
+  const std::ptrdiff_t i0 = k_hi, i1 = std::ptrdiff_t(nx)+k_lo;
+  const bool sym = vil_convolve_simd_is_symmetric(kernel, k_lo, k_hi);
+  switch (vil_convolve_simd_get_level())
+  {
+#if VIL_CONVOLVE_SIMD_AVX2
+   case vil_convolve_simd_avx2:
+    if (sym) vil_convolve_simd_loop_avx2_sym(src, dest, i0, i1, kernel, k_hi);
+    else     vil_convolve_simd_loop_avx2(src, dest, i0, i1, kernel, k_lo, k_hi);
+    return;
+#endif
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+   case vil_convolve_simd_sse2:
+    if (sym) vil_convolve_simd_loop_sse2_sym(src, dest, i0, i1, kernel, k_hi);
+    else     vil_convolve_simd_loop_sse2(src, dest, i0, i1, kernel, k_lo, k_hi);
+    return;
+#endif
+   default:
+    if (sym) vil_convolve_simd_scalar_sym(src, dest, i0, i1, kernel, k_hi);
+    else     vil_convolve_simd_scalar(src, dest, i0, i1, kernel, k_lo, k_hi);
+    return;
+  }
+}
+
+void vil_convolve_1d_simd(const vxl_byte* src, unsigned nx, float* dest,
+                          const float* kernel,
+                          std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  vil_convolve_simd_dispatch(src, nx, dest, kernel, k_lo, k_hi);
+}
+
+void vil_convolve_1d_simd(const float* src, unsigned nx, float* dest,
+                          const float* kernel,
+                          std::ptrdiff_t k_lo, std::ptrdiff_t k_hi)
+{
+  vil_convolve_simd_dispatch(src, nx, dest, kernel, k_lo, k_hi);
+}
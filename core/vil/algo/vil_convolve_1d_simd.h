@@ -0,0 +1,69 @@
+// This is core/vil/algo/vil_convolve_1d_simd.h
+#ifndef vil_convolve_1d_simd_h_
+#define vil_convolve_1d_simd_h_
+//:
+// \file
+// \brief Vectorised inner loops of vil_convolve_1d for byte and float rows
+//
+// vil_convolve_1d() uses these for vxl_byte->float and float->float rows
+// with a float kernel and float accumulator, when both rows are
+// contiguous. The instruction set (SSE2 or AVX2) is chosen at run time
+// from what the processor supports, and can be lowered with
+// vil_convolve_simd_set_level(), e.g. to compare against the plain
+// template loop.
+//
+// For an asymmetric kernel the taps are accumulated in the same order as
+// in the template loop, so the results are identical. For a symmetric
+// kernel (k_lo==-k_hi and kernel[-x]==kernel[x]) the pixels under each
+// pair of equal taps are added before multiplying, which halves the
+// number of multiplies. SSE2 and AVX2 then give identical results, but
+// these agree with the template loop (vil_convolve_simd_none) only to
+// rounding, as the sums are taken in a different order.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+
+//: Instruction sets available to the vil_convolve_1d row loops
+enum vil_convolve_simd_level
+{
+  //: Use the generic vil_convolve_1d template loop
+  vil_convolve_simd_none = 0,
+  vil_convolve_simd_sse2,
+  vil_convolve_simd_avx2
+};
+
+//: Most capable instruction set supported by this processor and build
+vil_convolve_simd_level vil_convolve_simd_best_level();
+
+//: Instruction set currently used by vil_convolve_1d
+// Initially vil_convolve_simd_best_level().
+vil_convolve_simd_level vil_convolve_simd_get_level();
+
+//: Set the instruction set used by vil_convolve_1d
+// Levels above vil_convolve_simd_best_level() are reduced to it.
+// Returns the level actually selected.
+vil_convolve_simd_level vil_convolve_simd_set_level(vil_convolve_simd_level level);
+
+//: Convolve the interior of a contiguous row: dest[i] = sum_x src[i-x]*kernel[x]
+// Fills dest[i] for i in [k_hi, nx+k_lo), i.e. wherever the kernel lies
+// wholly within the row. The edges are left for vil_convolve_edge_1d().
+// Requires k_lo<=0<=k_hi and k_hi-k_lo<nx.
+void vil_convolve_1d_simd(const vxl_byte* src, unsigned nx, float* dest,
+                          const float* kernel,
+                          std::ptrdiff_t k_lo, std::ptrdiff_t k_hi);
+
+//: Convolve the interior of a contiguous row: dest[i] = sum_x src[i-x]*kernel[x]
+// Fills dest[i] for i in [k_hi, nx+k_lo), i.e. wherever the kernel lies
+// wholly within the row. The edges are left for vil_convolve_edge_1d().
+// Requires k_lo<=0<=k_hi and k_hi-k_lo<nx.
+void vil_convolve_1d_simd(const float* src, unsigned nx, float* dest,
+                          const float* kernel,
+                          std::ptrdiff_t k_lo, std::ptrdiff_t k_hi);
+
+#endif // vil_convolve_1d_simd_h_
@@ -7,13 +7,14 @@
 // \author Fred Wheeler
 
 #include <complex>
-#include <vector>
 #include "vil_fft.h"
 #include <vcl_compiler.h>
 #include <vil/vil_image_view.h>
-#include <vnl/algo/vnl_fft_1d.h>
+#include <vnl/algo/vnl_fft_plan.h>
 
 //: Perform in place FFT in one dimension.
+// All n1 x n2 signals are transformed by one shared vnl_fft_plan, which
+// does several of them at once and shares large images between threads.
 template<class T>
 static void
 vil_fft_2d_base(std::complex<T> * data,
@@ -22,37 +23,18 @@ vil_fft_2d_base(std::complex<T> * data,
                 unsigned n2, std::ptrdiff_t step2, // nplanes, planestep
                 int dir)
 {
-  vnl_fft_1d<T> fft_1d(n0);
+  vnl_fft_plan<T> const& plan = vnl_fft_plan<T>::get(n0);
   T factor = dir<0 ? T(1) : T(1)/static_cast<T>(n0);
 
-  if (1 == step0) // use contiguous data memory directly
+  // FFT every pixel row (or column) in every colour band:
+  for (unsigned i2=0; i2<n2; i2++)
   {
-    // FFT every pixel row (or column) in every colour band:
-    for (unsigned i1=0; i1<n1; i1++)
-    for (unsigned i2=0; i2<n2; i2++)
-    {
-      std::complex<T> * d = data + i1*step1 + i2*step2;
-      fft_1d.transform(d, dir);
-      if (dir >= 0)
+    std::complex<T> * d = data + i2*step2;
+    plan.transform(d, dir, n1, step0, step1);
+    if (dir >= 0)
+      for (unsigned i1=0; i1<n1; i1++)
         for (unsigned i0=0; i0<n0; ++i0)
-          d[i0] *= factor; // proper scaling for forward FFT
-    }
-  }
-  else // must copy non-contiguous data memory to a std::vector
-  {
-    std::vector<std::complex<T> > v(n0);
-    for (unsigned i1=0; i1<n1; i1++)
-    for (unsigned i2=0; i2<n2; i2++)
-    {
-      std::complex<T> * d = data + i1*step1 + i2*step2;
-      for (unsigned i0=0; i0<n0; i0++, d+=step0)
-        v[i0] = *d;
-      fft_1d.transform(v, dir);
-      // copy std::vector back to non-contiguous data memory
-      d = data + i1*step1 + i2*step2;
-      for (unsigned i0=0; i0<n0; i0++, d+=step0)
-        *d = v[i0]*factor; // proper scaling for forward FFT
-    }
+          d[i1*step1 + i0*step0] *= factor; // proper scaling for forward FFT
   }
 }
 
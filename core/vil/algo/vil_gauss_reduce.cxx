@@ -11,6 +11,10 @@
 #include <vxl_config.h> // for vxl_byte
 #include <vnl/vnl_erf.h>
 #include <vnl/vnl_math.h>
+#include <vil/vil_config.h> // for VXL_HAS_SSE2_HARDWARE_SUPPORT
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+#include <emmintrin.h>
+#endif
 
 //: Smooth and subsample single plane src_im in x to produce dest_im
 //  Applies 1-5-8-5-1 filter in x, then samples
@@ -226,6 +230,202 @@ void vil_gauss_reduce_1plane(const vxl_int_16* src_im,
   }
 }
 
+//=======================================================================
+// Row functions for the single pass vil_gauss_reduce.
+// Each gives exactly the values of the corresponding
+// vil_gauss_reduce_1plane specialisation above.
+//=======================================================================
+
+//: Smooth and subsample one row of floats in x
+//  Four outputs at a time, with the even and odd source pixels separated
+//  by shuffles.
+template <>
+void vil_gauss_reduce_1row(const float* src, unsigned ni, std::ptrdiff_t s_step, float* dest)
+{
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+  if (s_step==1 && ni>=11)
+  {
+    dest[0] = 0.071f * src[2] + 0.357f * src[1] + 0.572f * src[0];
+    // Output x is centred on src[2x]; a block of four starting at x reads
+    // up to src[2x+9]
+    const unsigned x_end = (ni-3)/2+1; // one past the last middle output
+    const __m128 k05 = _mm_set1_ps(0.05f), k25 = _mm_set1_ps(0.25f), k40 = _mm_set1_ps(0.40f);
+    unsigned x = 1;
+    for (; 2*x+9<ni && x+4<=x_end; x+=4)
+    {
+      const float* s = src+2*x;
+      __m128 a = _mm_loadu_ps(s-2), b = _mm_loadu_ps(s+2), c = _mm_loadu_ps(s+6);
+      __m128 a1 = _mm_loadu_ps(s), b1 = _mm_loadu_ps(s+4);
+      __m128 e_m1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)); // src[2x-2+2k]
+      __m128 o_m1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)); // src[2x-1+2k]
+      __m128 e_0  = _mm_shuffle_ps(a1,b1,_MM_SHUFFLE(2,0,2,0)); // src[2x+2k]
+      __m128 o_0  = _mm_shuffle_ps(a1,b1,_MM_SHUFFLE(3,1,3,1)); // src[2x+1+2k]
+      __m128 e_p1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,0,2,0)); // src[2x+2+2k]
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(k05,_mm_add_ps(e_m1,e_p1)),
+                                       _mm_mul_ps(k25,_mm_add_ps(o_m1,o_0))),
+                            _mm_mul_ps(k40,e_0));
+      _mm_storeu_ps(dest+x, d);
+    }
+    for (; x<x_end; ++x)
+    {
+      const float* s = src+2*x;
+      dest[x] =  0.05f*(s[-2] + s[2])
+               + 0.25f*(s[-1]+ s[1])
+               + 0.40f*s[0];
+    }
+    const float* s = src+2*x;
+    dest[x] = 0.071f * s[-2] + 0.357f * s[-1] + 0.572f * s[0];
+    return;
+  }
+#endif
+  vil_gauss_reduce_1plane(src,ni,1,s_step,0,dest,1,0);
+}
+
+template <>
+void vil_gauss_reduce_5rows(const vxl_byte* r0, const vxl_byte* r1, const vxl_byte* r2,
+                            const vxl_byte* r3, const vxl_byte* r4,
+                            unsigned n, vxl_byte* dest, std::ptrdiff_t d_step)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest = static_cast<vxl_byte>(
+             vnl_math::rnd( 0.05*r0[i]    + 0.05*r4[i]
+                          + 0.25*r1[i]    + 0.25*r3[i]
+                          + 0.4*r2[i]));
+}
+
+template <>
+void vil_gauss_reduce_3rows(const vxl_byte* far, const vxl_byte* near, const vxl_byte* centre,
+                            unsigned n, vxl_byte* dest, std::ptrdiff_t d_step, bool /*at_start*/)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest = static_cast<vxl_byte>(
+             vnl_math::rnd( 0.071f * far[i]
+                          + 0.357f * near[i]
+                          + 0.572f * centre[i]));
+}
+
+template <>
+void vil_gauss_reduce_5rows(const float* r0, const float* r1, const float* r2,
+                            const float* r3, const float* r4,
+                            unsigned n, float* dest, std::ptrdiff_t d_step)
+{
+  unsigned i=0;
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+  if (d_step==1)
+  {
+    const __m128 k05 = _mm_set1_ps(0.05f), k25 = _mm_set1_ps(0.25f), k40 = _mm_set1_ps(0.40f);
+    for (;i+4<=n;i+=4)
+    {
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(k05,_mm_add_ps(_mm_loadu_ps(r0+i),_mm_loadu_ps(r4+i))),
+                                       _mm_mul_ps(k25,_mm_add_ps(_mm_loadu_ps(r1+i),_mm_loadu_ps(r3+i)))),
+                            _mm_mul_ps(k40,_mm_loadu_ps(r2+i)));
+      _mm_storeu_ps(dest+i, d);
+    }
+  }
+#endif
+  for (dest+=i*d_step;i<n;++i,dest+=d_step)
+    *dest =  0.05f*(r0[i] + r4[i])
+           + 0.25f*(r1[i] + r3[i])
+           + 0.40f*r2[i];
+}
+
+template <>
+void vil_gauss_reduce_3rows(const float* far, const float* near, const float* centre,
+                            unsigned n, float* dest, std::ptrdiff_t d_step, bool /*at_start*/)
+{
+  unsigned i=0;
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+  if (d_step==1)
+  {
+    const __m128 k2 = _mm_set1_ps(0.071f), k1 = _mm_set1_ps(0.357f), k0 = _mm_set1_ps(0.572f);
+    for (;i+4<=n;i+=4)
+    {
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(k2,_mm_loadu_ps(far+i)),
+                                       _mm_mul_ps(k1,_mm_loadu_ps(near+i))),
+                            _mm_mul_ps(k0,_mm_loadu_ps(centre+i)));
+      _mm_storeu_ps(dest+i, d);
+    }
+  }
+#endif
+  for (dest+=i*d_step;i<n;++i,dest+=d_step)
+    *dest =  0.071f * far[i]
+           + 0.357f * near[i]
+           + 0.572f * centre[i];
+}
+
+template <>
+void vil_gauss_reduce_5rows(const double* r0, const double* r1, const double* r2,
+                            const double* r3, const double* r4,
+                            unsigned n, double* dest, std::ptrdiff_t d_step)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest =  0.05f*(r0[i] + r4[i])
+           + 0.25f*(r1[i] + r3[i])
+           + 0.40f*r2[i];
+}
+
+template <>
+void vil_gauss_reduce_3rows(const double* far, const double* near, const double* centre,
+                            unsigned n, double* dest, std::ptrdiff_t d_step, bool at_start)
+{
+  // vil_gauss_reduce_1plane<double> uses double taps for the first
+  // element and float taps for the last
+  if (at_start)
+    for (unsigned i=0;i<n;++i,dest+=d_step)
+      *dest =  0.071 * far[i]
+             + 0.357 * near[i]
+             + 0.572 * centre[i];
+  else
+    for (unsigned i=0;i<n;++i,dest+=d_step)
+      *dest =  0.071f * far[i]
+             + 0.357f * near[i]
+             + 0.572f * centre[i];
+}
+
+template <>
+void vil_gauss_reduce_5rows(const int* r0, const int* r1, const int* r2,
+                            const int* r3, const int* r4,
+                            unsigned n, int* dest, std::ptrdiff_t d_step)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest = vnl_math::rnd( 0.05*r0[i] + 0.25*r1[i] +
+                           0.05*r4[i] + 0.25*r3[i] +
+                           0.4 *r2[i]);
+}
+
+template <>
+void vil_gauss_reduce_3rows(const int* far, const int* near, const int* centre,
+                            unsigned n, int* dest, std::ptrdiff_t d_step, bool /*at_start*/)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest = vnl_math::rnd( 0.071f * far[i]
+                         + 0.357f * near[i]
+                         + 0.572f * centre[i]);
+}
+
+template <>
+void vil_gauss_reduce_5rows(const vxl_int_16* r0, const vxl_int_16* r1, const vxl_int_16* r2,
+                            const vxl_int_16* r3, const vxl_int_16* r4,
+                            unsigned n, vxl_int_16* dest, std::ptrdiff_t d_step)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    // The 0.5 offset in the following ensures rounding
+    *dest = vxl_int_16(0.5 + 0.05*r0[i] + 0.25*r1[i]
+                     + 0.05*r4[i] + 0.25*r3[i]
+                     + 0.4 *r2[i]);
+}
+
+template <>
+void vil_gauss_reduce_3rows(const vxl_int_16* far, const vxl_int_16* near, const vxl_int_16* centre,
+                            unsigned n, vxl_int_16* dest, std::ptrdiff_t d_step, bool /*at_start*/)
+{
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+    *dest = static_cast<vxl_int_16>(
+             vnl_math::rnd( 0.071f * far[i]
+                          + 0.357f * near[i]
+                          + 0.572f * centre[i]));
+}
+
 //: Smooth and subsample single plane src_im in x, result is 2/3rd size
 //  Applies alternate 1-3-1, 1-1 filter in x, then samples
 //  every other pixel.  Fills [0,(2*ni+1)/3-1][0,nj-1] elements of dest
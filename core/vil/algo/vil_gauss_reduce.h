@@ -13,7 +13,11 @@
 // Au contraire, let's have a generic template implementation after all
 // The previous specific types one plane functions become template specialisations
 
+#include <cstddef>
+#include <vector>
 #include <vil/vil_image_view.h>
+#include <vil/vil_memory_chunk.h>
+#include <vil/vil_pixel_format.h>
 #include <vxl_config.h> // for vxl_byte
 
 //: Smooth and subsample src_im to produce dest_im
@@ -41,6 +45,67 @@ template<class T>
 void vil_gauss_reduce_121(const vil_image_view<T>& src,
                           vil_image_view<T>& dest);
 
+//: Reusable memory for vil_gauss_reduce() and vil_gauss_pyramid()
+// Holds the rolling row buffer of the single-pass reducer and the
+// storage for pyramid levels. Memory is only allocated when a larger
+// image is seen than before, so a workspace kept from one frame to the
+// next stops hitting the allocator after the first frame.
+// A workspace must not be used by two threads at once.
+template <class T>
+class vil_gauss_reduce_workspace
+{
+  std::vector<T> rows_;
+  vil_memory_chunk_sptr levels_;
+ public:
+  //: Buffer of at least n_rows rows of n values each
+  T* rows(unsigned n_rows, unsigned n)
+  {
+    if (rows_.size() < std::size_t(n_rows)*n)
+      rows_.resize(std::size_t(n_rows)*n);
+    return &rows_[0];
+  }
+
+  //: Memory chunk of at least n_bytes, for pyramid levels
+  // The chunk is reused by later calls, overwriting its contents.
+  vil_memory_chunk_sptr level_memory(std::size_t n_bytes)
+  {
+    if (!levels_ || levels_->size() < n_bytes)
+      levels_ = new vil_memory_chunk(n_bytes, vil_pixel_format_component_format(vil_pixel_format_of(T())));
+    return levels_;
+  }
+
+  //: Total bytes held
+  std::size_t size_in_bytes() const
+  { return rows_.size()*sizeof(T) + (levels_ ? levels_->size() : 0); }
+};
+
+//: Smooth and subsample src_im to produce dest_im, in a single pass
+//  Gives the same result as vil_gauss_reduce(src,dest,work_im), but smooths
+//  in x and y and subsamples in one sweep down the image, keeping just the
+//  last five x-smoothed rows in a rolling buffer in workspace rather than
+//  a whole intermediate image. src must be at least 3x3.
+// \relatesalso vil_image_view
+template<class T>
+void vil_gauss_reduce(const vil_image_view<T>& src,
+                      vil_image_view<T>& dest,
+                      vil_gauss_reduce_workspace<T>& workspace);
+
+//: Build a Gaussian pyramid on base_im
+//  levels[0] is a shallow copy of base_im, and each further level is
+//  made from the one below by vil_gauss_reduce (filter_width 5) or
+//  vil_gauss_reduce_121 (filter_width 3). Levels are added while both
+//  dimensions of the new level would be at least min_size, up to
+//  max_levels in total. The levels above the base share one block of
+//  memory owned by workspace, which the next call with the same
+//  workspace reuses, so they are only valid until then.
+// \relatesalso vil_image_view
+template<class T>
+void vil_gauss_pyramid(const vil_image_view<T>& base_im,
+                       std::vector<vil_image_view<T> >& levels,
+                       vil_gauss_reduce_workspace<T>& workspace,
+                       unsigned max_levels = 99, unsigned min_size = 5,
+                       unsigned filter_width = 5);
+
 class vil_gauss_reduce_params
 {
   double scale_step_;
@@ -318,4 +383,44 @@ void vil_gauss_reduce_2_3_1plane(const double* src_im,
                                  std::ptrdiff_t s_x_step, std::ptrdiff_t s_y_step,
                                  double* dest_im, std::ptrdiff_t d_x_step, std::ptrdiff_t d_y_step);
 
+//: Smooth and subsample one row in x, as vil_gauss_reduce_1plane
+//  Writes (ni+1)/2 values to the contiguous dest.
+template <class T>
+void vil_gauss_reduce_1row(const T* src, unsigned ni, std::ptrdiff_t s_step, T* dest);
+
+//: Smooth and subsample one row in x, as vil_gauss_reduce_1plane
+//  Writes (ni+1)/2 values to the contiguous dest.
+template <>
+void vil_gauss_reduce_1row(const float* src, unsigned ni, std::ptrdiff_t s_step, float* dest);
+
+//: Apply the 1-5-8-5-1 filter down five rows of n values, centred on r2
+//  This is the step vil_gauss_reduce_1plane makes along x, applied
+//  across rows, and gives the same values.
+template <class T>
+void vil_gauss_reduce_5rows(const T* r0, const T* r1, const T* r2, const T* r3, const T* r4,
+                            unsigned n, T* dest, std::ptrdiff_t d_step);
+
+//: Apply the 3-tap edge filter down three rows of n values, centred on centre
+//  far is two rows from centre, into the image. at_start selects the
+//  filter used at the first (rather than the last) row.
+template <class T>
+void vil_gauss_reduce_3rows(const T* far, const T* near, const T* centre,
+                            unsigned n, T* dest, std::ptrdiff_t d_step, bool at_start);
+
+#define VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(T) \
+template <> \
+void vil_gauss_reduce_5rows(const T* r0, const T* r1, const T* r2, const T* r3, const T* r4, \
+                            unsigned n, T* dest, std::ptrdiff_t d_step); \
+template <> \
+void vil_gauss_reduce_3rows(const T* far, const T* near, const T* centre, \
+                            unsigned n, T* dest, std::ptrdiff_t d_step, bool at_start)
+
+VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(vxl_byte);
+VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(float);
+VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(double);
+VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(int);
+VIL_GAUSS_REDUCE_ROWS_SPECIALIZE(vxl_int_16);
+
+#undef VIL_GAUSS_REDUCE_ROWS_SPECIALIZE
+
 #endif // vil_gauss_reduce_h_
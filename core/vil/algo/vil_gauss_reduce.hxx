@@ -50,6 +50,105 @@ void vil_gauss_reduce(const vil_image_view<T>& src_im,
   }
 }
 
+//: Smooth and subsample src_im to produce dest_im, in a single pass
+//  Row r of the x-smoothed image is kept in row r%5 of the buffer, and
+//  each output row is made as soon as the rows it needs are there.
+template<class T>
+void vil_gauss_reduce(const vil_image_view<T>& src_im,
+                      vil_image_view<T>& dest_im,
+                      vil_gauss_reduce_workspace<T>& workspace)
+{
+  unsigned ni = src_im.ni();
+  unsigned nj = src_im.nj();
+  unsigned n_planes = src_im.nplanes();
+  assert(ni>=3 && nj>=3);
+
+  // Output image size
+  unsigned ni2 = (ni+1)/2;
+  unsigned nj2 = (nj+1)/2;
+
+  dest_im.set_size(ni2,nj2,n_planes);
+  T* buf = workspace.rows(5,ni2);
+  const std::ptrdiff_t s_istep = src_im.istep(), s_jstep = src_im.jstep();
+  const std::ptrdiff_t d_istep = dest_im.istep(), d_jstep = dest_im.jstep();
+
+  for (unsigned int p=0;p<n_planes;++p)
+  {
+    const T* s_plane = src_im.top_left_ptr()+p*src_im.planestep();
+    T* d_row = dest_im.top_left_ptr()+p*dest_im.planestep();
+
+    for (unsigned r=0;r<3;++r)
+      vil_gauss_reduce_1row(s_plane+r*s_jstep,ni,s_istep,buf+r*ni2);
+    vil_gauss_reduce_3rows(buf+2*ni2,buf+ni2,buf,ni2,d_row,d_istep,true);
+    d_row += d_jstep;
+
+    unsigned nj_mid = (nj-3)/2;
+    unsigned r = 3; // next source row to smooth
+    for (unsigned y=1;y<=nj_mid;++y,d_row+=d_jstep)
+    {
+      for (;r<=2*y+2;++r)
+        vil_gauss_reduce_1row(s_plane+r*s_jstep,ni,s_istep,buf+(r%5)*ni2);
+      vil_gauss_reduce_5rows(buf+((2*y-2)%5)*ni2, buf+((2*y-1)%5)*ni2,
+                             buf+((2*y  )%5)*ni2, buf+((2*y+1)%5)*ni2,
+                             buf+((2*y+2)%5)*ni2, ni2,d_row,d_istep);
+    }
+
+    // Last row, from rows already smoothed
+    unsigned c = 2*(nj_mid+1);
+    vil_gauss_reduce_3rows(buf+((c-2)%5)*ni2,buf+((c-1)%5)*ni2,buf+(c%5)*ni2,
+                           ni2,d_row,d_istep,false);
+  }
+}
+
+//: Build a Gaussian pyramid on base_im
+template<class T>
+void vil_gauss_pyramid(const vil_image_view<T>& base_im,
+                       std::vector<vil_image_view<T> >& levels,
+                       vil_gauss_reduce_workspace<T>& workspace,
+                       unsigned max_levels, unsigned min_size,
+                       unsigned filter_width)
+{
+  assert(filter_width==3 || filter_width==5);
+  unsigned ni = base_im.ni();
+  unsigned nj = base_im.nj();
+  unsigned np = base_im.nplanes();
+
+  // Number of levels, so that the top is no less than min_size square
+  // (the same size recurrence as used to build the levels below)
+  unsigned n_levels = 1;
+  for (unsigned li=(ni+1)/2, lj=(nj+1)/2; n_levels<max_levels && li>=min_size && lj>=min_size;
+       li=(li+1)/2, lj=(lj+1)/2)
+    ++n_levels;
+
+  // Lay out the levels above the base in one chunk, each starting on a
+  // 64 byte boundary
+  const std::size_t align = 64;
+  std::vector<std::size_t> offset(n_levels,0);
+  std::size_t n_bytes = 0;
+  for (unsigned l=1, li=ni, lj=nj; l<n_levels; ++l)
+  {
+    li = (li+1)/2; lj = (lj+1)/2;
+    offset[l] = n_bytes;
+    n_bytes += ((std::size_t(li)*lj*np*sizeof(T) + align-1)/align)*align;
+  }
+  vil_memory_chunk_sptr chunk = workspace.level_memory(n_bytes+align);
+  char* base = static_cast<char*>(chunk->data());
+  base += (align - reinterpret_cast<std::size_t>(base)%align)%align;
+
+  levels.resize(n_levels);
+  levels[0] = base_im;
+  for (unsigned l=1, li=ni, lj=nj; l<n_levels; ++l)
+  {
+    li = (li+1)/2; lj = (lj+1)/2;
+    levels[l] = vil_image_view<T>(chunk, reinterpret_cast<T*>(base+offset[l]),
+                                  li, lj, np, 1, li, std::ptrdiff_t(li)*lj);
+    if (filter_width==5)
+      vil_gauss_reduce(levels[l-1],levels[l],workspace);
+    else
+      vil_gauss_reduce_121(levels[l-1],levels[l]);
+  }
+}
+
 //: Smooth and subsample src_im to produce dest_im (2/3 size)
 //  Applies filter in x and y, then samples every other pixel.
 //  work_im provides workspace
@@ -322,6 +421,40 @@ void vil_gauss_reduce_1plane(const T* src_im,
 }
 
 
+template <class T>
+void vil_gauss_reduce_1row(const T* src, unsigned ni, std::ptrdiff_t s_step, T* dest)
+{
+  vil_gauss_reduce_1plane(src,ni,1,s_step,0,dest,1,0);
+}
+
+template <class T>
+void vil_gauss_reduce_5rows(const T* r0, const T* r1, const T* r2, const T* r3, const T* r4,
+                            unsigned n, T* dest, std::ptrdiff_t d_step)
+{
+  vil_convert_round_pixel<double,T> rounder;
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+  {
+    double dsum = 0.05*static_cast<double>(r0[i]) + 0.25*static_cast<double>(r1[i]) +
+                  0.05*static_cast<double>(r4[i]) + 0.25*static_cast<double>(r3[i]) +
+                  0.4 *static_cast<double>(r2[i]);
+    rounder(dsum, *dest);
+  }
+}
+
+template <class T>
+void vil_gauss_reduce_3rows(const T* far, const T* near, const T* centre,
+                            unsigned n, T* dest, std::ptrdiff_t d_step, bool /*at_start*/)
+{
+  vil_convert_round_pixel<double,T> rounder;
+  for (unsigned i=0;i<n;++i,dest+=d_step)
+  {
+    double dsum = 0.071 * static_cast<double>(far[i]) +
+                  0.357 * static_cast<double>(near[i]) +
+                  0.572 * static_cast<double>(centre[i]);
+    rounder(dsum, *dest);
+  }
+}
+
 //: Smooth and subsample single plane src_im in x to produce dest_im using 121 filter in x and y
 //  Smooths with a 3x3 filter and subsamples
 template <class T>
@@ -469,6 +602,14 @@ template void vil_gauss_reduce_2_3(const vil_image_view<T >& src, \
                                    vil_image_view<T >& work_im); \
 template void vil_gauss_reduce_121(const vil_image_view<T >& src, \
                                    vil_image_view<T >& dest); \
+template void vil_gauss_reduce(const vil_image_view<T >& src, \
+                               vil_image_view<T >& dest, \
+                               vil_gauss_reduce_workspace<T >& workspace); \
+template void vil_gauss_pyramid(const vil_image_view<T >& base_im, \
+                                std::vector<vil_image_view<T > >& levels, \
+                                vil_gauss_reduce_workspace<T >& workspace, \
+                                unsigned max_levels, unsigned min_size, \
+                                unsigned filter_width); \
 template void vil_gauss_reduce_general(const vil_image_view<T >& src_im, \
                                        vil_image_view<T >& dest_im, \
                                        vil_image_view<T >& worka, \
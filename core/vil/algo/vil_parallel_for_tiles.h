@@ -0,0 +1,210 @@
+// This is core/vil/algo/vil_parallel_for_tiles.h
+#ifndef vil_parallel_for_tiles_h_
+#define vil_parallel_for_tiles_h_
+//:
+// \file
+// \brief Run image filters in parallel over tiles of the output
+//
+// vil_parallel_for_tiles() cuts the output into tiles (by default
+// horizontal bands spanning the full width), and runs an ordinary serial
+// filter on each tile, extended by the halo of input pixels the filter
+// needs, on the threads of vil_thread_pool::global(). Each thread claims
+// the next unprocessed tile when it finishes one, so the load balances
+// itself. Only the tile interior is kept; the halo pixels are computed
+// with the filter's own edge handling and thrown away.
+//
+// The extended tile is clipped to the image, so a tile on the image
+// border sees exactly the border the serial filter sees. Provided the
+// filter's output at each pixel depends only on the input within the
+// halo (true of FIR filters, Sobel and median filters, though not of
+// periodic boundary extension across a tiled direction), the result is
+// bit-identical to running the filter on the whole image.
+//
+// Parallel overloads of vil_gauss_filter_5tap, vil_sobel_3x3,
+// vil_median and vil_convolve_1d, selected by a trailing
+// vil_parallel_tiling argument, are provided here.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <algorithm>
+#include <functional>
+#include <vcl_compiler.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_crop.h>
+#include <vil/vil_copy.h>
+#include <vil/vil_thread_pool.h>
+#include <vil/algo/vil_convolve_1d.h>
+#include <vil/algo/vil_gauss_filter.h>
+#include <vil/algo/vil_median.h>
+#include <vil/algo/vil_sobel_3x3.h>
+#include <vil/algo/vil_structuring_element.h>
+
+//: How to split an image into tiles and how many threads to use
+struct vil_parallel_tiling
+{
+  //: Tile width; 0 means the full image width (i.e. horizontal bands)
+  unsigned tile_ni;
+  //: Tile height
+  unsigned tile_nj;
+  //: Maximum number of threads; 0 means one per hardware thread
+  unsigned n_threads;
+
+  explicit vil_parallel_tiling(unsigned tile_nj_ = 64, unsigned tile_ni_ = 0,
+                               unsigned n_threads_ = 0)
+    : tile_ni(tile_ni_), tile_nj(tile_nj_), n_threads(n_threads_) {}
+};
+
+//: Call f(i0, n_i, j0, n_j) for each tile of an ni x nj image, in parallel
+inline void vil_parallel_for_tiles(unsigned ni, unsigned nj,
+                                   vil_parallel_tiling const& tiling,
+                                   std::function<void(unsigned, unsigned,
+                                                      unsigned, unsigned)> const& f)
+{
+  if (ni==0 || nj==0)
+    return;
+  unsigned tni = (tiling.tile_ni==0 || tiling.tile_ni>ni) ? ni : tiling.tile_ni;
+  unsigned tnj = (tiling.tile_nj==0 || tiling.tile_nj>nj) ? nj : tiling.tile_nj;
+  unsigned n_ti = (ni+tni-1)/tni, n_tj = (nj+tnj-1)/tnj;
+  vil_parallel_for(n_ti*n_tj, [&](unsigned k)
+  {
+    unsigned i0 = (k%n_ti)*tni, j0 = (k/n_ti)*tnj;
+    f(i0, std::min(tni, ni-i0), j0, std::min(tnj, nj-j0));
+  }, tiling.n_threads);
+}
+
+//: Apply a serial filter to src in parallel tiles, writing to dest.
+// filter(src_tile, dest_tile) must set dest_tile to the size of src_tile
+// with \p dest_nplanes planes, as the serial vil filters do.
+// The filter reads up to halo_i columns and halo_j rows beyond each pixel.
+// dest is resized to src.ni() x src.nj() x dest_nplanes.
+template <class srcT, class destT, class F>
+void vil_parallel_for_tiles(const vil_image_view<srcT>& src,
+                            vil_image_view<destT>& dest,
+                            unsigned dest_nplanes,
+                            unsigned halo_i, unsigned halo_j,
+                            F filter,
+                            vil_parallel_tiling const& tiling = vil_parallel_tiling())
+{
+  const unsigned ni = src.ni(), nj = src.nj();
+  dest.set_size(ni, nj, dest_nplanes);
+  vil_parallel_for_tiles(ni, nj, tiling,
+    [&](unsigned i0, unsigned n_i, unsigned j0, unsigned n_j)
+  {
+    unsigned ei0 = i0>halo_i ? i0-halo_i : 0;
+    unsigned ej0 = j0>halo_j ? j0-halo_j : 0;
+    unsigned ei1 = std::min(ni, i0+n_i+halo_i);
+    unsigned ej1 = std::min(nj, j0+n_j+halo_j);
+    vil_image_view<destT> dest_tile = vil_crop(dest, i0, n_i, j0, n_j);
+    if (ei0==i0 && ej0==j0 && ei1==i0+n_i && ej1==j0+n_j)
+    {
+      // no halo needed: write straight into dest, as set_size()
+      // leaves a view of the right size alone
+      filter(vil_crop(src, i0, n_i, j0, n_j), dest_tile);
+      return;
+    }
+    vil_image_view<destT> ext_dest;
+    filter(vil_crop(src, ei0, ei1-ei0, ej0, ej1-ej0), ext_dest);
+    vil_copy_reformat(vil_crop(ext_dest, i0-ei0, n_i, j0-ej0, n_j), dest_tile);
+  });
+}
+
+//: Smooth src_im to produce dest_im, in parallel tiles
+// Identical to the serial vil_gauss_filter_5tap.
+template <class srcT, class destT>
+inline void vil_gauss_filter_5tap(const vil_image_view<srcT>& src_im,
+                                  vil_image_view<destT>& dest_im,
+                                  const vil_gauss_filter_5tap_params& params,
+                                  vil_parallel_tiling const& tiling)
+{
+  // Images of 3 or fewer rows or columns take a separate path
+  if (src_im.ni()<=3 || src_im.nj()<=3)
+  {
+    vil_gauss_filter_5tap(src_im, dest_im, params);
+    return;
+  }
+  // The filter reads 2 pixels either side, but a halo of 3 keeps every
+  // extended tile longer than 3 pixels, so all take the same path.
+  vil_parallel_for_tiles(src_im, dest_im, src_im.nplanes(), 3, 3,
+    [&params](const vil_image_view<srcT>& s, vil_image_view<destT>& d)
+    { vil_gauss_filter_5tap(s, d, params); },
+    tiling);
+}
+
+//: Compute i and j gradients of src using 3x3 Sobel filters, in parallel tiles
+// Identical to the serial vil_sobel_3x3.
+template <class srcT, class destT>
+inline void vil_sobel_3x3(const vil_image_view<srcT>& src,
+                          vil_image_view<destT>& grad_ij,
+                          vil_parallel_tiling const& tiling)
+{
+  vil_parallel_for_tiles(src, grad_ij, 2*src.nplanes(), 1, 1,
+    [](const vil_image_view<srcT>& s, vil_image_view<destT>& d)
+    { vil_sobel_3x3(s, d); },
+    tiling);
+}
+
+//: Compute i and j gradients of src using 3x3 Sobel filters, in parallel tiles
+// Identical to the serial vil_sobel_3x3.
+template <class srcT, class destT>
+inline void vil_sobel_3x3(const vil_image_view<srcT>& src,
+                          vil_image_view<destT>& grad_i,
+                          vil_image_view<destT>& grad_j,
+                          vil_parallel_tiling const& tiling)
+{
+  const unsigned ni = src.ni(), nj = src.nj();
+  grad_i.set_size(ni, nj, src.nplanes());
+  grad_j.set_size(ni, nj, src.nplanes());
+  vil_parallel_for_tiles(ni, nj, tiling,
+    [&](unsigned i0, unsigned n_i, unsigned j0, unsigned n_j)
+  {
+    unsigned ei0 = i0>0 ? i0-1 : 0, ej0 = j0>0 ? j0-1 : 0;
+    unsigned ei1 = std::min(ni, i0+n_i+1), ej1 = std::min(nj, j0+n_j+1);
+    vil_image_view<destT> gi, gj;
+    vil_sobel_3x3(vil_crop(src, ei0, ei1-ei0, ej0, ej1-ej0), gi, gj);
+    vil_image_view<destT> gi_tile = vil_crop(grad_i, i0, n_i, j0, n_j);
+    vil_image_view<destT> gj_tile = vil_crop(grad_j, i0, n_i, j0, n_j);
+    vil_copy_reformat(vil_crop(gi, i0-ei0, n_i, j0-ej0, n_j), gi_tile);
+    vil_copy_reformat(vil_crop(gj, i0-ei0, n_i, j0-ej0, n_j), gj_tile);
+  });
+}
+
+//: Median filter of plane 0 of src_image, in parallel tiles
+// Identical to the serial vil_median.
+template <class T>
+inline void vil_median(const vil_image_view<T>& src_image,
+                       vil_image_view<T>& dest_image,
+                       const vil_structuring_element& element,
+                       vil_parallel_tiling const& tiling)
+{
+  unsigned halo_i = static_cast<unsigned>(std::max(std::max(-element.min_i(), element.max_i()), 0));
+  unsigned halo_j = static_cast<unsigned>(std::max(std::max(-element.min_j(), element.max_j()), 0));
+  vil_parallel_for_tiles(src_image, dest_image, 1, halo_i, halo_j,
+    [&element](const vil_image_view<T>& s, vil_image_view<T>& d)
+    { vil_median(s, d, element); },
+    tiling);
+}
+
+//: Convolve kernel with each row of src_im, in parallel bands
+// Identical to the serial vil_convolve_1d. Rows are independent, so the
+// image is always split into full-width bands and tiling.tile_ni is ignored.
+template <class srcT, class destT, class kernelT, class accumT>
+inline void vil_convolve_1d(const vil_image_view<srcT>& src_im,
+                            vil_image_view<destT>& dest_im,
+                            const kernelT* kernel,
+                            std::ptrdiff_t k_lo, std::ptrdiff_t k_hi,
+                            accumT ac,
+                            vil_convolve_boundary_option start_option,
+                            vil_convolve_boundary_option end_option,
+                            vil_parallel_tiling const& tiling)
+{
+  vil_parallel_tiling bands(tiling.tile_nj, 0, tiling.n_threads);
+  vil_parallel_for_tiles(src_im, dest_im, src_im.nplanes(), 0, 0,
+    [=](const vil_image_view<srcT>& s, vil_image_view<destT>& d)
+    { vil_convolve_1d(s, d, kernel, k_lo, k_hi, ac, start_option, end_option); },
+    bands);
+}
+
+#endif // vil_parallel_for_tiles_h_
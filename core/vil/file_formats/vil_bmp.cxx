@@ -13,6 +13,7 @@
 #include <vil/vil_stream.h>
 #include <vil/vil_property.h>
 #include <vil/vil_memory_chunk.h>
+#include <vil/vil_mapped_memory_chunk.h>
 #include <vil/vil_image_view.h>
 #include <vil/vil_exception.h>
 
@@ -478,6 +479,34 @@ vil_image_view_base_sptr vil_bmp_image::get_copy_view(
     np, ystep, plane_step);
 }
 
+//------------------------------------------------------------
+vil_image_view_base_sptr vil_bmp_image::get_view(
+  unsigned x0, unsigned nx, unsigned y0, unsigned ny) const
+{
+  // 32 bit pixels need their channels reordering, so cannot be viewed in place
+  if (info_hdr.compression == 0 && x0+nx <= ni() && y0+ny <= nj() &&
+      (core_hdr.bitsperpixel == 8 || core_hdr.bitsperpixel == 24))
+  {
+    unsigned const bytes_per_pixel = core_hdr.bitsperpixel / 8;
+    std::ptrdiff_t const have_bytes_per_raster = ((bytes_per_pixel * core_hdr.width + 3)/4)*4;
+    // BMP rows are normally stored bottom-up
+    std::ptrdiff_t row = y0, ystep = have_bytes_per_raster;
+    if ( core_hdr.height > 0 )
+    {
+      row = nj()-1-y0;
+      ystep = -ystep;
+    }
+    // 24 bit pixels are stored BB GG RR
+    std::ptrdiff_t top_left_plane0 = bytes_per_pixel==3 ? 2 : 0;
+    std::ptrdiff_t plane_step = bytes_per_pixel==3 ? -1 : 1;
+    vil_image_view_base_sptr view =
+      vil_mapped_image_view(is_, VIL_PIXEL_FORMAT_BYTE,
+                            bit_map_start + have_bytes_per_raster*row + x0*bytes_per_pixel + top_left_plane0,
+                            nx, ny, bytes_per_pixel, bytes_per_pixel, ystep, plane_step);
+    if (view) return view;
+  }
+  return get_copy_view(x0, nx, y0, ny);
+}
 
 bool vil_bmp_image::put_view(const vil_image_view_base& view,
                              unsigned x0, unsigned y0)
@@ -74,6 +74,14 @@ class vil_bmp_image : public vil_image_resource
   virtual vil_image_view_base_sptr get_copy_view(unsigned i0, unsigned ni,
                                                  unsigned j0, unsigned nj) const;
 
+  //: Create a view of the data.
+  // For uncompressed 8 and 24 bit images read through a memory-mapped
+  // stream, this points straight at the pixels in the mapping, with a
+  // negative jstep for bottom-up images and a negative planestep for
+  // BGR pixels. Otherwise it is a copy.
+  virtual vil_image_view_base_sptr get_view(unsigned i0, unsigned ni,
+                                            unsigned j0, unsigned nj) const;
+
   //: Put the data in this view back into the image source.
   virtual bool put_view(const vil_image_view_base& im, unsigned i0, unsigned j0);
 
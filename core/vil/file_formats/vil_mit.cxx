@@ -18,6 +18,7 @@ static char const* vil_mit_format_tag = "mit";
 #include <vil/vil_stream.h>
 #include <vil/vil_image_resource.h>
 #include <vil/vil_image_view.h>
+#include <vil/vil_mapped_memory_chunk.h>
 #include <vil/vil_stream_read.h>
 #include <vil/vil_stream_write.h>
 #include <vil/vil_exception.h>
@@ -292,6 +293,23 @@ vil_image_view_base_sptr vil_mit_image::get_copy_view(unsigned int x0, unsigned
 #undef ARGS
 }
 
+vil_image_view_base_sptr vil_mit_image::get_view(unsigned int x0, unsigned int xs,
+                                                 unsigned int y0, unsigned int ys) const
+{
+  assert(x0+xs<=ni_);
+  assert(y0+ys<=nj_);
+  // MIT image data is little-endian
+  if (format_!=VIL_PIXEL_FORMAT_BOOL && (!VXL_BIG_ENDIAN || bytes_per_pixel()==1))
+  {
+    vil_streampos row_bytes = vil_streampos(ni_)*components_*bytes_per_pixel();
+    vil_image_view_base_sptr view =
+      vil_mapped_image_view(is_, format_, 8L + y0*row_bytes + vil_streampos(x0)*components_*bytes_per_pixel(),
+                            xs, ys, components_, components_, std::ptrdiff_t(ni_)*components_, 1);
+    if (view) return view;
+  }
+  return get_copy_view(x0, xs, y0, ys);
+}
+
 bool vil_mit_image::put_view(vil_image_view_base const& buf, unsigned int x0, unsigned int y0)
 {
   assert(buf.pixel_format() == format_); // pixel formats of image and buffer must match
@@ -77,6 +77,10 @@ class vil_mit_image : public vil_image_resource
 
   //: Return part of this as buffer
   virtual vil_image_view_base_sptr get_copy_view(unsigned int x0, unsigned int ni, unsigned int y0, unsigned int nj) const;
+  //: Return part of this as buffer, in place if the stream is memory-mapped
+  // Bit-packed images, and images of more than one byte per sample on
+  // big endian machines, are always copied.
+  virtual vil_image_view_base_sptr get_view(unsigned int x0, unsigned int ni, unsigned int y0, unsigned int nj) const;
   //: Write buf into this at position (x0,y0)
   virtual bool put_view(vil_image_view_base const& buf, unsigned int x0, unsigned int y0);
 
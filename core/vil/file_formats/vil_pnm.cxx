@@ -22,6 +22,7 @@
 #include <vil/vil_image_resource.h>
 #include <vil/vil_image_view.h>
 #include <vil/vil_memory_chunk.h>
+#include <vil/vil_mapped_memory_chunk.h>
 #include <vil/vil_exception.h>
 
 #if 0 // see comment below
@@ -472,6 +473,24 @@ static void operator<<(vil_stream& vs, int a)
   char buf[128]; std::sprintf(buf, " %d\n", a); vs.write(buf,std::strlen(buf));
 }
 
+vil_image_view_base_sptr vil_pnm_image::get_view(
+  unsigned x0, unsigned ni, unsigned y0, unsigned nj) const
+{
+  unsigned bytes_per_sample = (bits_per_component_+7)/8;
+  // 16-bit samples are stored most significant byte first
+  bool same_layout = bytes_per_sample==1 || (bytes_per_sample==2 && VXL_BIG_ENDIAN);
+  if (magic_ > 4 && bits_per_component_ > 1 && same_layout &&
+      x0+ni <= ni_ && y0+nj <= nj_)
+  {
+    unsigned np = nplanes();
+    vil_image_view_base_sptr view =
+      vil_mapped_image_view(vs_, format_, start_of_data_ + (vil_streampos(y0)*ni_ + x0)*np*bytes_per_sample,
+                            ni, nj, np, np, std::ptrdiff_t(ni_)*np, 1);
+    if (view) return view;
+  }
+  return get_copy_view(x0, ni, y0, nj);
+}
+
 bool vil_pnm_image::put_view(const vil_image_view_base& view,
                              unsigned x0, unsigned y0)
 {
@@ -96,6 +96,13 @@ class vil_pnm_image : public vil_image_resource
   virtual vil_image_view_base_sptr get_copy_view(unsigned i0, unsigned ni,
                                                  unsigned j0, unsigned nj) const;
 
+  //: Create a view of the data.
+  // For raw PGM and PPM files of up to 8 bits per sample (or 16 on big
+  // endian machines) read through a memory-mapped stream, this points
+  // straight at the pixels in the mapping. Otherwise it is a copy.
+  virtual vil_image_view_base_sptr get_view(unsigned i0, unsigned ni,
+                                            unsigned j0, unsigned nj) const;
+
   virtual bool put_view(const vil_image_view_base& im, unsigned i0, unsigned j0);
 
   char const* file_format() const;
@@ -13,6 +13,7 @@
 #include <vil/vil_new.h>
 #include <vil/vil_load.h>
 #include <vil/vil_copy.h>
+#include <vil/vil_pyramid_builder.h>
 
 //:Load a pyramid image.  The path should correspond to a directory.
 //If not, return a null resource.
@@ -36,44 +37,6 @@ vil_pyramid_image_list_format::make_pyramid_output_image(char const* file)
   return new vil_pyramid_image_list(file);
 }
 
-static bool copy_base_resc(vil_image_resource_sptr const& base_image,
-                           std::string full_filename,
-                           char const* file_format,
-                           vil_blocked_image_resource_sptr& copy)
-{
-  { //scope for closing resource
-  //Create a new blocked base image resource
-  std::cout << "Copying base resource\n";
-  vil_blocked_image_resource_sptr brsc = blocked_image_resource(base_image);
-  if (!brsc||brsc->size_block_i()%2!=0||brsc->size_block_i()%2!=0)
-    brsc = new vil_blocked_image_facade(base_image);
-  vil_blocked_image_resource_sptr out_resc =
-    vil_new_blocked_image_resource(full_filename.c_str(),
-                                   brsc->ni(), brsc->nj(),
-                                   brsc->nplanes(),
-                                   brsc->pixel_format(),
-                                   brsc->size_block_i(),
-                                   brsc->size_block_j(),
-                                   file_format);
-  if (!out_resc)
-    return false;
-  for (unsigned int j = 0; j<brsc->n_block_j(); ++j)
-    for (unsigned int i = 0; i<brsc->n_block_i(); ++i)
-    {
-      vil_image_view_base_sptr blk = brsc->get_block(i,j);
-      if (!blk)
-        return 0;
-      if (!out_resc->put_block(i, j, *blk))
-        return 0;
-    }
-  }//end scope for out resource
-  //
-  //reopen the resource for reading.
-  vil_image_resource_sptr temp = vil_load_image_resource(full_filename.c_str());
-  copy = blocked_image_resource(temp);
-  return (bool)copy;
-}
-
 static std::string level_filename(std::string& directory, std::string& filename,
                                  float level)
 {
@@ -101,34 +64,34 @@ vil_pyramid_image_resource_sptr vil_pyramid_image_list_format::
                                  char const* filename
                                 )
 {
-  if (!vil_image_list::vil_is_directory(directory))
+  if (!vil_image_list::vil_is_directory(directory) || !base_image)
     return VXL_NULLPTR;
   std::string d = directory;
   std::string fn = filename;
-  std::string full_filename = level_filename(d,fn, 0.0f) + '.'+ level_file_format;
-  vil_blocked_image_resource_sptr blk_base;
-  if (copy_base)
-  {
-    if (!copy_base_resc(base_image, full_filename,
-                        level_file_format, blk_base))
-      return VXL_NULLPTR;
-  }
-  else
-  {
-    blk_base =
-      blocked_image_resource(base_image);
-    if (!blk_base)
-      return VXL_NULLPTR;
-  }
-  //Create the other pyramid levels
+  //Tile the levels like the base, if its blocks have even sizes
+  vil_blocked_image_resource_sptr brsc = blocked_image_resource(base_image);
+  if (!brsc||brsc->size_block_i()%2!=0||brsc->size_block_j()%2!=0)
+    brsc = new vil_blocked_image_facade(base_image);
+  //Create all the pyramid levels in one pass over the base
   { //program scope to close resource files
-    vil_image_resource_sptr image = blk_base.ptr();
-    for (unsigned int L = 1; L<nlevels; ++L)
+    std::vector<vil_image_resource_sptr> levels(nlevels);
+    for (unsigned int L = copy_base ? 0 : 1; L<nlevels; ++L)
     {
-      std::cout << "Decimating Level " << L << std::endl;
-      full_filename = level_filename(d, fn, float(L)) + '.'+ level_file_format;
-      image = vil_pyramid_image_resource::decimate(image,full_filename.c_str());
+      std::string full_filename =
+        level_filename(d, fn, float(L)) + '.'+ level_file_format;
+      levels[L] =
+        vil_new_blocked_image_resource(full_filename.c_str(),
+                                       vil_pyramid_level_size(brsc->ni(), L),
+                                       vil_pyramid_level_size(brsc->nj(), L),
+                                       brsc->nplanes(), brsc->pixel_format(),
+                                       brsc->size_block_i(),
+                                       brsc->size_block_j(),
+                                       level_file_format).ptr();
+      if (!levels[L])
+        return VXL_NULLPTR;
     }
+    if (!vil_build_pyramid_levels(base_image, levels))
+      return VXL_NULLPTR;
   } //end program scope to close resource files
   vil_image_list il(directory);
   std::vector<vil_image_resource_sptr> rescs = il.resources();
@@ -321,6 +284,11 @@ vil_pyramid_image_list::get_copy_view(unsigned int i0, unsigned int n_i,
   unsigned int sj0 = static_cast<unsigned int>(fj0);
   unsigned int snj = static_cast<unsigned int>(fnj);
   if (snj == 0) snj = 1;//can't have less than one pixel
+  //a region reaching the edge of the base reaches the edge of the level,
+  //as the level sizes are rounded down at each halving
+  const unsigned int lni = pl->image_->ni(), lnj = pl->image_->nj();
+  if (i0+n_i>=this->ni() && si0<lni) sni = lni-si0;
+  if (j0+n_j>=this->nj() && sj0<lnj) snj = lnj-sj0;
   vil_image_view_base_sptr v = pl->image_->get_copy_view(si0, sni, sj0, snj);
   if (!v)
   {
@@ -1,8 +1,11 @@
 //This is core/vil/file_formats/vil_tiff.cxx
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <fcntl.h> // for O_RDONLY
 #include "vil_tiff.h"
 //:
 // \file
@@ -23,8 +26,13 @@
 #include <vil/vil_property.h>
 #include <vil/vil_image_view.h>
 #include <vil/vil_memory_chunk.h>
+#include <vil/vil_mapped_memory_chunk.h>
 #include <vil/vil_copy.h>
 #include <vil/vil_image_list.h>
+#include <vil/vil_load.h>
+#include <vil/vil_new.h>
+#include <vil/vil_pyramid_builder.h>
+#include <vil/vil_thread_pool.h>
 #include "vil_tiff_header.h"
 #include <vil/vil_exception.h>
 //#define DEBUG
@@ -87,7 +95,8 @@ bool vil_tiff_file_format_probe(vil_stream* is)
 struct tif_stream_structures
 {
   tif_stream_structures(vil_stream *vs_)
-    : vs(vs_), filesize(0) /*, sample_format( SAMPLEFORMAT_VOID ), buf(0) */
+    : vs(vs_), filesize(0), stream_mutex(VXL_NULLPTR), pos(0)
+    /*, sample_format( SAMPLEFORMAT_VOID ), buf(0) */
   { if (vs) vs->ref(); }
 
   ~tif_stream_structures() { /* delete[] buf; */ if (vs) vs->unref(); }
@@ -95,11 +104,23 @@ struct tif_stream_structures
   TIFF* tif;
   vil_stream* vs;
   vil_streampos filesize;
+  //: If set, vs is shared with other handles: hold this while using it,
+  // and keep this handle's position in pos rather than in vs.
+  std::mutex* stream_mutex;
+  vil_streampos pos;
 };
 
 static tsize_t vil_tiff_readproc(thandle_t h, tdata_t buf, tsize_t n)
 {
   tif_stream_structures* p = (tif_stream_structures*)h;
+  if (p->stream_mutex)
+  {
+    std::lock_guard<std::mutex> lock(*p->stream_mutex);
+    p->vs->seek(p->pos);
+    tsize_t ret = (tsize_t)p->vs->read(buf, n);
+    p->pos += ret;
+    return ret;
+  }
   if (n > p->filesize) p->filesize= n;
   //there should be no problem with this case because n
   //is also of type tsize_t
@@ -122,6 +143,17 @@ static tsize_t vil_tiff_writeproc(thandle_t h, tdata_t buf, tsize_t n)
 static toff_t vil_tiff_seekproc(thandle_t h, toff_t offset, int whence)
 {
   tif_stream_structures* p = (tif_stream_structures*)h;
+  if (p->stream_mutex)
+  {
+    if      (whence == SEEK_SET) p->pos = offset;
+    else if (whence == SEEK_CUR) p->pos += offset;
+    else if (whence == SEEK_END)
+    {
+      std::lock_guard<std::mutex> lock(*p->stream_mutex);
+      p->pos = p->vs->file_size() + offset;
+    }
+    return (toff_t)p->pos;
+  }
   if      (whence == SEEK_SET) p->vs->seek(offset);
   else if (whence == SEEK_CUR) p->vs->seek(p->vs->tell() + offset);
   else if (whence == SEEK_END) p->vs->seek(p->filesize + offset);
@@ -149,15 +181,19 @@ static toff_t vil_tiff_sizeproc(thandle_t)
   return (toff_t)(-1); // could be unsigned - avoid compiler warning
 }
 
-static int vil_tiff_mapfileproc(thandle_t, tdata_t*, toff_t*)
+// If the stream is memory-mapped, let libtiff read from the mapping
+static int vil_tiff_mapfileproc(thandle_t h, tdata_t* base, toff_t* size)
 {
-  // TODO: Add mmap support to vil_tiff_mapfileproc
-#ifdef DEBUG
-  std::cerr << "Warning: mmap support not yet in vil_tiff_mapfileproc()\n";
-#endif
-  return 0;
+  tif_stream_structures* p = (tif_stream_structures*)h;
+  void* data = p->vs->mapped_data();
+  if (!data)
+    return 0;
+  *base = data;
+  *size = (toff_t)p->vs->file_size();
+  return 1;
 }
 
+// The mapping belongs to the stream
 static void vil_tiff_unmapfileproc(thandle_t, tdata_t, toff_t)
 {
 }
@@ -165,7 +201,10 @@ static void vil_tiff_unmapfileproc(thandle_t, tdata_t, toff_t)
 
 static TIFF* open_tiff(tif_stream_structures* tss, const char* mode)
 {
-  tss->vs->seek(0L);
+  if (tss->stream_mutex)
+    tss->pos = 0;
+  else
+    tss->vs->seek(0L);
 #if HAS_GEOTIFF
   TIFF* tiff = XTIFFClientOpen("unknown filename",
                                mode, // read, enable strip chopping
@@ -190,6 +229,69 @@ static TIFF* open_tiff(tif_stream_structures* tss, const char* mode)
     return tiff;
 }
 
+// The vil_stream under a handle made by open_tiff(), or null if the
+// handle was opened on a file by name
+static tif_stream_structures* stream_structures(TIFF* tif)
+{
+  if (!tif || TIFFGetReadProc(tif) != vil_tiff_readproc)
+    return VXL_NULLPTR;
+  return (tif_stream_structures*)TIFFClientdata(tif);
+}
+
+//: Spare read-only handles on the file of a vil_tiff_image.
+// Each handle has its own libtiff decoder state, so blocks can be decoded
+// by several threads at once. Handles on a vil_stream take turns at the
+// stream, each keeping its own position; on a memory-mapped stream
+// libtiff reads straight from the mapping instead.
+struct vil_tiff_decoder_pool
+{
+  vil_tiff_decoder_pool(TIFF* tif) : tif_(tif) {}
+
+  ~vil_tiff_decoder_pool()
+  {
+    for (unsigned k = 0; k<free_.size(); ++k)
+      TIFFClose(free_[k]);
+  }
+
+  //: A handle not in use by any other thread, or null if none can be opened
+  TIFF* acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_.empty())
+      {
+        TIFF* tif = free_.back();
+        free_.pop_back();
+        return tif;
+      }
+    }
+    tif_stream_structures* main_tss = stream_structures(tif_);
+    if (!main_tss)
+      return TIFFOpen(TIFFFileName(tif_), "rC");
+    tif_stream_structures* tss = new tif_stream_structures(main_tss->vs);
+    tss->stream_mutex = &stream_mutex_;
+    TIFF* tif = open_tiff(tss, "rC");
+    if (!tif)
+      delete tss;
+    return tif;
+  }
+
+  //: Return a handle from acquire() for reuse
+  void release(TIFF* tif)
+  {
+    if (!tif)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(tif);
+  }
+
+ private:
+  TIFF* tif_;
+  std::mutex mutex_;
+  std::mutex stream_mutex_;
+  std::vector<TIFF*> free_;
+};
+
 vil_image_resource_sptr vil_tiff_file_format::make_input_image(vil_stream* is)
 {
   if (!vil_tiff_file_format_probe(is))
@@ -253,46 +355,132 @@ static std::string level_filename(std::string& directory, std::string& filename,
   return directory + slash + filename + cs.str();
 }
 
+// The directory named by TMPDIR, TMP or TEMP, or else the usual system one
+static std::string temp_directory()
+{
+  char const* const vars[] = { "TMPDIR", "TMP", "TEMP" };
+  for (unsigned k = 0; k<3; ++k)
+  {
+    char const* d = std::getenv(vars[k]);
+    if (d && *d && vil_image_list::vil_is_directory(d))
+      return d;
+  }
+#ifdef VCL_WIN32
+  return ".";
+#else
+  return "/tmp";
+#endif
+}
+
+// Start writing page \p level of a multi-page file. The page is complete
+// once its pixels have been written and TIFFWriteDirectory() called.
+static vil_tiff_image* new_pyramid_level(tif_smart_ptr const& t,
+                                         unsigned level, unsigned n_levels,
+                                         unsigned ni, unsigned nj,
+                                         unsigned nplanes, vil_pixel_format fmt,
+                                         unsigned sbi, unsigned sbj)
+{
+  // setup the image header for the level
+  vil_tiff_header* h = new vil_tiff_header(t.tif(), ni, nj, nplanes,
+                                           fmt, sbi, sbj);
+
+  /* We are writing single page of the multipage file */
+  TIFFSetField(t.tif(), TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
+  /* Set the page number */
+  TIFFSetField(t.tif(), TIFFTAG_PAGENUMBER, level, n_levels);
+  return new vil_tiff_image(t, h, level);
+}
+
+// The base is read once and all levels are produced together by
+// vil_build_pyramid_levels(). The base is written straight into the
+// first page of the file; since a tiff file is written one page at a
+// time, the other levels (a third of the size of the base between them)
+// are collected in tiled temporary files, and appended block by block.
 vil_pyramid_image_resource_sptr vil_tiff_file_format::
 make_pyramid_image_from_base(char const* file,
                              vil_image_resource_sptr const& base_image,
                              unsigned nlevels,
                              char const* temp_dir)
 {
+  if (!base_image || nlevels==0)
+    return VXL_NULLPTR;
+  // The system temporary directory is shared, so name the files uniquely
+  std::ostringstream stem;
+  stem << "tempR";
+  const std::string system_temp_dir = temp_directory();
+  if (!temp_dir)
+  {
+    temp_dir = system_temp_dir.c_str();
+    stem << "_vil_tiff_pyramid_" << static_cast<void const*>(base_image.ptr()) << '_';
+  }
+  const unsigned ni = base_image->ni(), nj = base_image->nj();
+  const unsigned nplanes = base_image->nplanes();
+  const vil_pixel_format fmt = base_image->pixel_format();
+
+  // Tile every level like the base if possible, else in 256x256 tiles
+  unsigned sbi = 256, sbj = 256;
+  vil_blocked_image_resource_sptr bir = blocked_image_resource(base_image);
+  if (bir && bir->size_block_i()>0 && bir->size_block_i()%16==0 &&
+      bir->size_block_j()>0 && bir->size_block_j()%16==0)
+  {
+    sbi = bir->size_block_i();
+    sbj = bir->size_block_j();
+  }
+
+  std::vector<std::string> temp_files;
+  bool good = true;
   {//scope for writing the resources
-    vil_pyramid_image_resource_sptr pyr = make_pyramid_output_image(file);
-    pyr->put_resource(base_image);
-    //Create the other pyramid levels
-    {//scope for resource files
-      std::string d = temp_dir;
-      std::string fn = "tempR";
-      vil_image_resource_sptr image = base_image;
-      for (unsigned L = 1; L<nlevels; ++L)
+    vxl_uint_64 size_needed = vxl_uint_64(ni) * vxl_uint_64(nj) * vxl_uint_64(nplanes) * vil_pixel_format_sizeof_components(fmt) * vil_pixel_format_num_components(fmt);
+    bool const bigtiff_needed = size_needed >= vxl_uint_64(0x7FFFFFFF);
+    TIFF* out = TIFFOpen(file, bigtiff_needed ? "w8" : "w");
+    if (!out)
+      return VXL_NULLPTR;
+    tif_smart_ptr tsptr = new tif_ref_cnt(out);
+
+    std::vector<vil_image_resource_sptr> levels(nlevels);
+    levels[0] = new_pyramid_level(tsptr, 0, nlevels, ni, nj, nplanes,
+                                  fmt, sbi, sbj);
+    std::string d = temp_dir;
+    std::string fn = stem.str();
+    for (unsigned L = 1; L<nlevels && good; ++L)
+    {
+      temp_files.push_back(level_filename(d, fn, L) + ".tif");
+      levels[L] = vil_new_blocked_image_resource(temp_files.back().c_str(),
+                                                 vil_pyramid_level_size(ni, L),
+                                                 vil_pyramid_level_size(nj, L),
+                                                 nplanes, fmt,
+                                                 sbi, sbj, "tiff").ptr();
+      good = bool(levels[L]);
+    }
+    good = good && vil_build_pyramid_levels(base_image, levels);
+    good = good && TIFFWriteDirectory(out)==1;
+
+    for (unsigned L = 1; L<nlevels && good; ++L)
+    {
+      //close the temporary file, then reopen it for reading
+      levels[L] = VXL_NULLPTR;
+      levels[L] = vil_load_image_resource(temp_files[L-1].c_str());
+      if (!levels[L])
       {
-        std::cout << "Decimating Level " << L << std::endl;
-        std::string full_filename = level_filename(d, fn, L) + ".tif";
-        image =
-          vil_pyramid_image_resource::decimate(image, full_filename.c_str());
+        good = false;
+        break;
       }
-    }//end program scope to close resource files
-
-    //reopen them for reading
-    {//scope for il resources
-      vil_image_list il(temp_dir);
-      std::vector<vil_image_resource_sptr> rescs = il.resources();
-      for (std::vector<vil_image_resource_sptr>::iterator rit = rescs.begin();
-           rit != rescs.end(); ++rit)
-        pyr->put_resource(*rit);
-    }//close il resources
-  }//close pyr
-
-  //clean up the temporary directory
+      vil_image_resource_sptr resc =
+        new_pyramid_level(tsptr, L, nlevels, levels[L]->ni(), levels[L]->nj(),
+                          nplanes, fmt, sbi, sbj);
+      good = vil_copy_deep(levels[L], resc) && TIFFWriteDirectory(out)==1;
+      levels[L] = VXL_NULLPTR;
+    }
+  }//close the pyramid and temporary files
+
+  //clean up the temporary files
   vil_image_list vl(temp_dir);
-  if (!vl.clean_directory())
-  {
-    std::cout <<"Warning: In vil_tiff::make_pyramid_from_base(..) -"
-             << " temporary directory not cleaned\n";
-  }
+  for (unsigned k = 0; k<temp_files.size(); ++k)
+    if (!vl.remove_file(temp_files[k]))
+      std::cout << "Warning: In vil_tiff::make_pyramid_from_base(..) -"
+                << " temporary file " << temp_files[k] << " not removed\n";
+  if (!good)
+    return VXL_NULLPTR;
   //reopen for reading
   return make_input_pyramid_image(file);
 }
@@ -377,7 +565,8 @@ char const* vil_tiff_file_format::tag() const
 
 vil_tiff_image::vil_tiff_image(tif_smart_ptr const& tif_sptr,
                                vil_tiff_header* th, const unsigned nimages):
-    t_(tif_sptr), h_(th), index_(0), nimages_(nimages)
+    t_(tif_sptr), h_(th), index_(0), nimages_(nimages),
+    decode_threads_(0), decoders_(new vil_tiff_decoder_pool(tif_sptr.tif()))
 {
 }
 
@@ -454,6 +643,7 @@ vil_pixel_format vil_tiff_image::pixel_format() const
 
 vil_tiff_image::~vil_tiff_image()
 {
+  delete decoders_;
   delete h_;
 }
 
@@ -491,6 +681,101 @@ static void endian_swap( vxl_byte* a, unsigned n_bytes,
   }
 }
 
+// Tables expanding each byte of 1, 2 or 4 bit samples to 8, 4 or 2 bytes
+struct tiff_unpack_table
+{
+  explicit tiff_unpack_table(unsigned bits)
+  {
+    const unsigned per_byte = 8/bits, mask = (1u<<bits)-1;
+    for (unsigned b = 0; b<256; ++b)
+      for (unsigned s = 0; s<per_byte; ++s)
+        v[b][s] = vxl_byte((b >> (8-bits*(s+1))) & mask);
+  }
+  vxl_byte v[256][8];
+};
+
+// Sample k is bits [k*bits, (k+1)*bits) of the words of in_data, each
+// read from its most significant bit down, as taken by tiff_get_bits().
+// A must have room for sizeof(T)*8 + bits - 1 bits.
+template <class T, class A>
+static void tiff_unpack_words(const T* in_data, unsigned num_samples,
+                              unsigned bits, T* out_data)
+{
+  const unsigned word_bits = sizeof(T)*8;
+  const A mask = (A(1) << bits) - 1;
+  A acc = 0;
+  unsigned acc_bits = 0;
+  for (unsigned k = 0; k<num_samples; ++k)
+  {
+    if (acc_bits<bits)
+    {
+      acc = (acc << word_bits) | *in_data++;
+      acc_bits += word_bits;
+    }
+    acc_bits -= bits;
+    out_data[k] = T((acc >> acc_bits) & mask);
+  }
+}
+
+bool tiff_unpack_bits(const vxl_byte* in_data, unsigned num_samples,
+                      unsigned in_bits_per_sample, vxl_byte* out_data)
+{
+  const tiff_unpack_table* table = VXL_NULLPTR;
+  switch (in_bits_per_sample)
+  {
+   case 1: { static const tiff_unpack_table t1(1); table = &t1; break; }
+   case 2: { static const tiff_unpack_table t2(2); table = &t2; break; }
+   case 4: { static const tiff_unpack_table t4(4); table = &t4; break; }
+   default:
+    tiff_unpack_words<vxl_byte, vxl_uint_16>(in_data, num_samples,
+                                             in_bits_per_sample, out_data);
+    return true;
+  }
+  const unsigned per_byte = 8/in_bits_per_sample;
+  const unsigned n_whole = num_samples/per_byte;
+  for (unsigned b = 0; b<n_whole; ++b, out_data += per_byte)
+    std::memcpy(out_data, table->v[in_data[b]], per_byte);
+  if (num_samples%per_byte)
+    std::memcpy(out_data, table->v[in_data[n_whole]], num_samples%per_byte);
+  return true;
+}
+
+bool tiff_unpack_bits(const vxl_uint_16* in_data, unsigned num_samples,
+                      unsigned in_bits_per_sample, vxl_uint_16* out_data)
+{
+  if (in_bits_per_sample==12)
+  {
+    // four samples in every three words
+    unsigned k = 0;
+    for (; k+4<=num_samples; k += 4, in_data += 3)
+    {
+      const vxl_uint_16 w0 = in_data[0], w1 = in_data[1], w2 = in_data[2];
+      out_data[k]   = vxl_uint_16(w0 >> 4);
+      out_data[k+1] = vxl_uint_16(((w0 & 0x000f) << 8) | (w1 >> 8));
+      out_data[k+2] = vxl_uint_16(((w1 & 0x00ff) << 4) | (w2 >> 12));
+      out_data[k+3] = vxl_uint_16(w2 & 0x0fff);
+    }
+    tiff_unpack_words<vxl_uint_16, vxl_uint_32>(in_data, num_samples-k, 12,
+                                                out_data+k);
+    return true;
+  }
+  tiff_unpack_words<vxl_uint_16, vxl_uint_32>(in_data, num_samples,
+                                              in_bits_per_sample, out_data);
+  return true;
+}
+
+bool tiff_unpack_bits(const vxl_uint_32* in_data, unsigned num_samples,
+                      unsigned in_bits_per_sample, vxl_uint_32* out_data)
+{
+#if VXL_HAS_INT_64
+  tiff_unpack_words<vxl_uint_32, vxl_uint_64>(in_data, num_samples,
+                                              in_bits_per_sample, out_data);
+  return true;
+#else
+  return false;
+#endif
+}
+
 template<> bool* tiff_byte_align_data<bool>(bool* in_data, unsigned num_samples, unsigned in_bits_per_sample, bool* out_data)
 {
   switch (sizeof(bool))
@@ -709,8 +994,13 @@ vil_image_view_base_sptr
 vil_tiff_image::get_block( unsigned block_index_i,
                            unsigned block_index_j ) const
 {
-  // the only two possibilities
-  assert(h_->is_tiled() || h_->is_striped());
+  if (!this->select_directory())
+    return VXL_NULLPTR;
+  return this->read_block(t_.tif(), block_index_i, block_index_j);
+}
+
+bool vil_tiff_image::select_directory() const
+{
   //
   // If there are multiple images in the file it is
   // necessary to set the TIFF directory and file header corresponding to
@@ -719,13 +1009,62 @@ vil_tiff_image::get_block( unsigned block_index_i,
   if (nimages_>1)
   {
     if (TIFFSetDirectory(t_.tif(), index_)<=0)
-      return VXL_NULLPTR;
+      return false;
     vil_tiff_header* h = new vil_tiff_header(t_.tif());
     //Cast away const
     vil_tiff_image* ti = (vil_tiff_image*)this;
     delete h_;
     ti->h_=h;
   }
+  return true;
+}
+
+bool vil_tiff_image::
+get_blocks( unsigned start_block_i, unsigned end_block_i,
+            unsigned start_block_j, unsigned end_block_j,
+            std::vector< std::vector< vil_image_view_base_sptr > >& blocks ) const
+{
+  const unsigned nbi = end_block_i-start_block_i+1;
+  const unsigned nbj = end_block_j-start_block_j+1;
+  const unsigned n = nbi*nbj;
+  if (n<2 || decode_threads_==1 || TIFFGetMode(t_.tif())!=O_RDONLY ||
+      (decode_threads_==0 && vil_thread_pool::hardware_threads()<2))
+    return vil_blocked_image_resource::get_blocks(start_block_i, end_block_i,
+                                                  start_block_j, end_block_j,
+                                                  blocks);
+  if (!this->select_directory())
+    return false;
+
+  std::vector<vil_image_view_base_sptr> views(n);
+  vil_parallel_for(n, [&](unsigned k)
+  {
+    TIFF* tif = decoders_->acquire();
+    if (tif && (TIFFCurrentDirectory(tif)==index_ ||
+                TIFFSetDirectory(tif, index_)>0))
+      views[k] = this->read_block(tif, start_block_i + k/nbj,
+                                  start_block_j + k%nbj);
+    decoders_->release(tif);
+  }, decode_threads_);
+
+  for (unsigned bi = 0; bi<nbi; ++bi)
+  {
+    std::vector< vil_image_view_base_sptr > jblocks(views.begin()+bi*nbj,
+                                                    views.begin()+(bi+1)*nbj);
+    for (unsigned bj = 0; bj<nbj; ++bj)
+      if (!jblocks[bj])
+        return false;
+    blocks.push_back(jblocks);
+  }
+  return true;
+}
+
+// decode a block through the given handle, for get_block() and get_blocks()
+vil_image_view_base_sptr
+vil_tiff_image::read_block( TIFF* tif, unsigned block_index_i,
+                            unsigned block_index_j ) const
+{
+  // the only two possibilities
+  assert(h_->is_tiled() || h_->is_striped());
 
   vil_image_view_base_sptr view = VXL_NULLPTR;
 
@@ -749,7 +1088,7 @@ vil_tiff_image::get_block( unsigned block_index_i,
 
   if (h_->is_tiled())
   {
-    if (TIFFReadEncodedTile(t_.tif(), blk_indx, data, (tsize_t) -1)<=0)
+    if (TIFFReadEncodedTile(tif, blk_indx, data, (tsize_t) -1)<=0)
     {
       delete [] data;
       return view;
@@ -765,7 +1104,7 @@ vil_tiff_image::get_block( unsigned block_index_i,
 
   if (h_->is_striped())
   {
-    if (TIFFReadEncodedStrip(t_.tif(), blk_indx, data, (tsize_t) -1)<=0)
+    if (TIFFReadEncodedStrip(tif, blk_indx, data, (tsize_t) -1)<=0)
     {
       delete [] data;
       return view;
@@ -1152,6 +1491,51 @@ bool vil_tiff_image::put_view(const vil_image_view_base& im,
   return true;
 }
 
+//: A view straight onto the file, when it is memory mapped and holds uncompressed contiguous strips.
+// Otherwise, or if the mapping fails, a copy decoded block by block.
+vil_image_view_base_sptr
+vil_tiff_image::get_view(unsigned i0, unsigned n_i,
+                         unsigned j0, unsigned n_j) const
+{
+  TIFF* tif = t_.tif();
+  const vil_pixel_format fmt = h_->pix_fmt;
+  const unsigned bytes_per_sample = vil_pixel_format_sizeof_components(fmt);
+  const unsigned spp = h_->samples_per_pixel.val;
+  // Other images in the file would need their directory reading first
+  if (nimages_==1 && i0+n_i<=ni() && j0+n_j<=nj() &&
+      fmt!=VIL_PIXEL_FORMAT_BOOL && fmt!=VIL_PIXEL_FORMAT_UNKNOWN &&
+      h_->compression.val==COMPRESSION_NONE && h_->is_striped() && !h_->is_tiled() &&
+      h_->bits_per_sample.val==8*bytes_per_sample && spp==nplanes() &&
+      (spp==1 || h_->planar_config.val==PLANARCONFIG_CONTIG) &&
+      (bytes_per_sample==1 || !TIFFIsByteSwapped(tif)))
+  {
+    tif_stream_structures* tss = stream_structures(tif);
+    toff_t* offsets = VXL_NULLPTR;
+    vxl_uint_32 rows_per_strip = 0;
+    if (tss && tss->vs->mapped_data() &&
+        TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &offsets) && offsets &&
+        TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip))
+    {
+      // the strips must follow each other without gaps
+      const vil_streampos bytes_per_line = vil_streampos(ni())*spp*bytes_per_sample;
+      const vil_streampos strip_bytes = vil_streampos(std::min(rows_per_strip, nj()))*bytes_per_line;
+      const tstrip_t n_strips = TIFFNumberOfStrips(tif);
+      bool contiguous = true;
+      for (tstrip_t s = 1; s<n_strips && contiguous; ++s)
+        contiguous = vil_streampos(offsets[s]) == vil_streampos(offsets[0]) + s*strip_bytes;
+      if (contiguous)
+      {
+        vil_image_view_base_sptr view =
+          vil_mapped_image_view(tss->vs, vil_pixel_format_component_format(fmt),
+                                vil_streampos(offsets[0]) + j0*bytes_per_line + vil_streampos(i0)*spp*bytes_per_sample,
+                                n_i, n_j, spp, spp, std::ptrdiff_t(ni())*spp, 1);
+        if (view) return view;
+      }
+    }
+  }
+  return get_copy_view(i0, n_i, j0, n_j);
+}
+
 // The virtual put_block method. In this case the view is a complete block
 bool vil_tiff_image::put_block( unsigned  block_index_i,
                                 unsigned  block_index_j,
@@ -1294,6 +1678,10 @@ vil_tiff_pyramid_resource::get_copy_view(unsigned i0, unsigned n_i,
   if (sni == 0) sni = 1;//can't have less than one pixel
   unsigned snj = static_cast<unsigned>(fnj);
   if (snj == 0) snj = 1;//can't have less than one pixel
+  //a region reaching the edge of the base reaches the edge of the level,
+  //as the level sizes are rounded down at each halving
+  if (i0+n_i>=this->ni() && si0<levels_[level]->ni_) sni = levels_[level]->ni_-si0;
+  if (j0+n_j>=this->nj() && sj0<levels_[level]->nj_) snj = levels_[level]->nj_-sj0;
   vil_image_view_base_sptr view = resc->get_copy_view(si0, sni, sj0, snj);
 #if 0 //DON'T NEED CLEAR?
   resc->clear_TIFF();
@@ -1330,15 +1718,8 @@ bool vil_tiff_pyramid_resource::put_resource(vil_image_resource_sptr const& ir)
   vil_blocked_image_resource_sptr bir = blocked_image_resource(ir);
   unsigned sbi = 0, sbj = 0;
   if (bir) { sbi = bir->size_block_i(); sbj = bir->size_block_j(); }
-  // setup the image header for the level
-  vil_tiff_header* h = new vil_tiff_header(t_.tif(), ni, nj, nplanes,
-                                           fmt, sbi, sbj);
-
-  /* We are writing single page of the multipage file */
-  TIFFSetField(t_.tif(), TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
-  /* Set the page number */
-  TIFFSetField(t_.tif(), TIFFTAG_PAGENUMBER,level, 3);
-  vil_tiff_image* ti = new vil_tiff_image(t_, h, level);
+  vil_tiff_image* ti = new_pyramid_level(t_, level, 3, ni, nj, nplanes,
+                                         fmt, sbi, sbj);
   vil_image_resource_sptr resc = ti;
   if (!vil_copy_deep(ir, resc))
     return false;
@@ -57,10 +57,12 @@ class vil_tiff_file_format : public vil_file_format
   //  All levels are stored in the same resource file. Each level has the same
   //  scale ratio (0.5) to the preceding level. Level 0 is the original
   //  base image. The resource is returned open for reading.
+  //  The base is read once, and all levels are tiled like the base (or in
+  //  256x256 tiles if it is not blocked); see vil_build_pyramid_levels().
   //  The temporary directory is for storing intermediate image
   //  resources during the construction of the pyramid. Files are
   //  be removed from the directory after completion.  If temp_dir is 0
-  //  then the intermediate resources are created in memory.
+  //  the system temporary directory is used, so memory use stays bounded.
   virtual vil_pyramid_image_resource_sptr
   make_pyramid_image_from_base(char const* filename,
                                vil_image_resource_sptr const& base_image,
@@ -88,6 +90,7 @@ class vil_tiff_file_format : public vil_file_format
 };
 
 struct tif_stream_structures;
+struct vil_tiff_decoder_pool;
 class vil_tiff_header;
 //Need to create a smartpointer mechanism for the tiff
 //file in order to handle multiple images, e.g. for pyramid
@@ -207,9 +210,34 @@ class vil_tiff_image : public vil_blocked_image_resource
   virtual vil_image_view_base_sptr get_block( unsigned  block_index_i,
                                               unsigned  block_index_j ) const;
 
+  //: Get multiple blocks, decoding them in parallel when possible.
+  // The blocks are decoded on up to decode_threads() threads, each with
+  // its own libtiff handle on the file, so decompression and unpacking
+  // of one block overlaps with the others.
+  virtual bool get_blocks( unsigned start_block_i, unsigned end_block_i,
+                           unsigned start_block_j, unsigned end_block_j,
+                           std::vector< std::vector< vil_image_view_base_sptr > >& blocks ) const;
+
+  //: Set the maximum number of threads used by get_blocks().
+  // 0 (the default) means one per hardware thread; 1 decodes serially.
+  // Resources open for writing always decode serially.
+  void set_decode_threads(unsigned n) { decode_threads_ = n; }
+
+  //: The maximum number of threads used by get_blocks()
+  unsigned decode_threads() const { return decode_threads_; }
+
   virtual bool put_block( unsigned  block_index_i, unsigned  block_index_j,
                           const vil_image_view_base& blk );
 
+  //: Create a view of the data.
+  // For uncompressed, striped images with contiguous strips, samples of
+  // 8 to 64 bits in this machine's byte order, and pixels interleaved
+  // (or a single plane), read through a memory-mapped stream, this
+  // points straight at the pixels in the mapping. Otherwise it is
+  // assembled from decoded blocks.
+  virtual vil_image_view_base_sptr get_view(unsigned i0, unsigned n_i,
+                                            unsigned j0, unsigned n_j) const;
+
   //: Put the data in this view back into the image source.
   virtual bool put_view(const vil_image_view_base& im, unsigned i0, unsigned j0);
 
@@ -254,6 +282,12 @@ class vil_tiff_image : public vil_blocked_image_resource
   unsigned int index_;
   //: number of images in the file
   unsigned int nimages_;
+  //: maximum number of threads used by get_blocks()
+  unsigned decode_threads_;
+  //: extra libtiff handles for decoding in parallel, opened on first use
+  // The pool itself is made by the constructor, so that concurrent calls
+  // to get_blocks() never race to create it.
+  vil_tiff_decoder_pool* decoders_;
 #if 0
   //to keep the tiff file open during reuse of multiple tiff resources
   //in a single file otherwise the resource destructor would close the file
@@ -274,6 +308,13 @@ class vil_tiff_image : public vil_blocked_image_resource
                      unsigned samples_per_block,
                      unsigned bits_per_sample) const;
 
+  //: make h_ describe image index_, if the file holds several
+  bool select_directory() const;
+
+  //: read and decode a block using the libtiff handle \p tif
+  vil_image_view_base_sptr read_block(TIFF* tif, unsigned block_index_i,
+                                      unsigned block_index_j) const;
+
   //: the key methods for decoding the file data
   vil_image_view_base_sptr fill_block_from_tile(vil_memory_chunk_sptr const & buf) const;
 
@@ -503,6 +544,24 @@ T tiff_get_bits( const T* in_val, unsigned i0, unsigned ni )
   return temp;
 }
 
+//:
+// Fast equivalents of the loop in tiff_byte_align_data() for unsigned
+// samples: 1, 2 and 4 bit samples packed in bytes are expanded by table
+// lookup, 12 bit samples in 16 bit words four at a time, and others
+// through a bit accumulator rather than one sample per tiff_get_bits().
+// Return false, doing nothing, for types without a fast version.
+template< class T >
+inline bool tiff_unpack_bits( const T* /*in_data*/, unsigned /*num_samples*/,
+                              unsigned /*in_bits_per_sample*/, T* /*out_data*/ )
+{ return false; }
+
+bool tiff_unpack_bits( const vxl_byte* in_data, unsigned num_samples,
+                       unsigned in_bits_per_sample, vxl_byte* out_data );
+bool tiff_unpack_bits( const vxl_uint_16* in_data, unsigned num_samples,
+                       unsigned in_bits_per_sample, vxl_uint_16* out_data );
+bool tiff_unpack_bits( const vxl_uint_32* in_data, unsigned num_samples,
+                       unsigned in_bits_per_sample, vxl_uint_32* out_data );
+
 //:
 // This function will byte align the data in in_data and store the result in out_data.  For example, let's
 // say that you had in_data is of type unsigned char and contains the following data: 110010111001111010000110.
@@ -561,6 +620,9 @@ T* tiff_byte_align_data( T* in_data, unsigned num_samples, unsigned in_bits_per_
 {
   assert( in_bits_per_sample < sizeof(T)*8 );
 
+  if ( tiff_unpack_bits( static_cast<const T*>(in_data), num_samples, in_bits_per_sample, out_data ) )
+    return out_data;
+
   //grab each value from the bitstream (in_data) that we need... one
   //at a time
   unsigned bit_offset = 0;
@@ -12,6 +12,7 @@ static char const* vil_viff_format_tag = "viff";
 #include <vil/vil_stream.h>
 #include <vil/vil_image_resource.h>
 #include <vil/vil_image_view.h>
+#include <vil/vil_mapped_memory_chunk.h>
 #include <vil/vil_exception.h>
 
 static inline void swap(void* p,int length)
@@ -279,6 +280,23 @@ vil_image_view_base_sptr vil_viff_image::get_copy_view(unsigned int x0, unsigned
 #undef ARGS
 }
 
+vil_image_view_base_sptr vil_viff_image::get_view(unsigned int x0, unsigned int xs,
+                                                  unsigned int y0, unsigned int ys) const
+{
+  assert(x0+xs<=ni_);
+  assert(y0+ys<=nj_);
+  unsigned int bytes_per_sample = vil_pixel_format_sizeof_components(format_);
+  if (format_!=VIL_PIXEL_FORMAT_BOOL && (endian_consistent_ || bytes_per_sample==1))
+  {
+    vil_streampos row_bytes = vil_streampos(ni_)*bytes_per_sample;
+    vil_image_view_base_sptr view =
+      vil_mapped_image_view(is_, format_, start_of_data_ + y0*row_bytes + vil_streampos(x0)*bytes_per_sample,
+                            xs, ys, nplanes_, 1, ni_, std::ptrdiff_t(ni_)*nj_);
+    if (view) return view;
+  }
+  return get_copy_view(x0, xs, y0, ys);
+}
+
 bool vil_viff_image::put_view(vil_image_view_base const& buf, unsigned int x0, unsigned int y0)
 {
   assert(buf.pixel_format() == format_); // pixel formats of image and buffer must match
@@ -1,6 +1,9 @@
 // This is core/vil/tests/test_blocked_image_resource.cxx
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 #include <testlib/testlib_test.h>
 #include <testlib/testlib_root_dir.h>
 #include <vcl_compiler.h>
@@ -11,6 +14,7 @@
 #include <vil/vil_image_view.h>
 #include <vil/vil_blocked_image_resource.h>
 #include <vil/vil_block_cache.h>
+#include <vil/vil_concurrent_block_cache.h>
 #include <vul/vul_file.h>
 
 static std::string image_file;
@@ -265,6 +269,65 @@ static void test_blocked_image_resource()
   bool got_b0 = cache.get_block(0, 0, old_blk);
   TEST("test store and retrieve", got_b1&&the_same&&!got_b0 , true);
 
+  //
+  /////////---------------Test the concurrent cache ------------------///////
+  //
+  std::cout << "Start test of concurrent cache\n";
+  {
+    // 16x16 unsigned short blocks are 512 bytes; room for two in one shard
+    vil_concurrent_block_cache_sptr ccache = new vil_concurrent_block_cache(1024, 1);
+    int owner_a = 0, owner_b = 0;
+    vil_image_view_base_sptr b0 = ir->get_view(0, sbi, 0, sbj);
+    vil_image_view_base_sptr b1 = ir->get_view(sbi, sbi, 0, sbj);
+    vil_image_view_base_sptr b2 = ir->get_view(2*sbi, sbi, 0, sbj);
+    TEST("Block bytes", vil_concurrent_block_cache::block_bytes(*b0), 512);
+    ccache->add_block(&owner_a, 0, 0, b0);
+    ccache->add_block(&owner_a, 1, 0, b1);
+    vil_image_view_base_sptr got;
+    // touch block 0 so that block 1 is the eviction victim
+    bool hit0 = ccache->get_block(&owner_a, 0, 0, got) && got==b0;
+    bool miss_b = !ccache->get_block(&owner_b, 0, 0, got);
+    ccache->add_block(&owner_b, 0, 0, b2);
+    TEST("Hit and per-owner miss", hit0 && miss_b, true);
+    TEST("Byte budget respected", ccache->bytes_in_use()<=ccache->byte_budget(), true);
+    TEST("Second chance keeps referenced block",
+         ccache->get_block(&owner_a, 0, 0, got) && !ccache->get_block(&owner_a, 1, 0, got) &&
+         ccache->get_block(&owner_b, 0, 0, got) && got==b2, true);
+    TEST("Counters", ccache->n_hits()==3 && ccache->n_misses()==2 &&
+         ccache->n_evictions()==1, true);
+    ccache->remove_owner(&owner_b);
+    TEST("Remove owner", ccache->n_blocks()==1 &&
+         !ccache->get_block(&owner_b, 0, 0, got), true);
+
+    // hammer a sharded cache from several threads
+    vil_concurrent_block_cache_sptr scache = new vil_concurrent_block_cache(8*512, 4);
+    std::vector<vil_image_view_base_sptr> blocks;
+    for (unsigned bi = 0; bi<4; ++bi)
+      blocks.push_back(ir->get_view(bi*sbi, sbi, 0, sbj));
+    std::atomic<bool> consistent(true);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t<4; ++t)
+      threads.push_back(std::thread([&, t]() {
+        for (unsigned n = 0; n<2000; ++n)
+        {
+          unsigned bi = (n*7+t)%4, bj = (n*3+t)%8;
+          vil_image_view_base_sptr b;
+          if (scache->get_block(&owner_a, bi, bj, b))
+          {
+            if (b!=blocks[bi]) consistent = false;
+          }
+          else
+            scache->add_block(&owner_a, bi, bj, blocks[bi]);
+        }
+      }));
+    for (unsigned t = 0; t<threads.size(); ++t)
+      threads[t].join();
+    TEST("Concurrent access consistent", consistent.load(), true);
+    TEST("Concurrent access counted", scache->n_hits()+scache->n_misses(), 8000);
+    TEST("Concurrent access within budget",
+         scache->bytes_in_use()<=scache->byte_budget(), true);
+  }
+
   //
   /////////--------------Test the cached resource--------------------///////
   //
@@ -290,6 +353,25 @@ static void test_blocked_image_resource()
   {
     TEST("Get block from cache", false , true);
   }
+  // two resources sharing one cache must not see each other's blocks
+  {
+    vil_image_view<unsigned short> zeros(ni, nj);
+    zeros.fill(0);
+    vil_concurrent_block_cache_sptr shared = new vil_concurrent_block_cache(1<<16);
+    vil_blocked_image_resource_sptr s1 = vil_new_cached_image_resource(fabir, shared);
+    vil_blocked_image_resource_sptr s2 =
+      vil_new_cached_image_resource(
+        vil_new_blocked_image_facade(vil_new_image_resource_of_view(zeros), sbi, sbj),
+        shared);
+    vil_image_view<unsigned short> v1 = s1->get_block(1, 0);
+    vil_image_view<unsigned short> v2 = s2->get_block(1, 0);
+    vil_image_view<unsigned short> v1b = s1->get_block(1, 0);
+    TEST("Shared cache keeps resources apart",
+         v1(0,0)==image(sbi,0) && v2(0,0)==0 && v1b(0,0)==v1(0,0) &&
+         shared->n_hits()==1 && shared->n_blocks()==2, true);
+    s2 = VXL_NULLPTR;
+    TEST("Shared cache purged on resource deletion", shared->n_blocks(), 1);
+  }
   // set sptr's to 0 so the underlying objects are destructed and the
   // temporary image files are closed.  Otherwise the unlink below will
   // fail.
@@ -20,16 +20,22 @@ DECLARE( test_sample_grid_bicub );
 DECLARE( test_resample_bicub );
 DECLARE( test_image_view_maths );
 DECLARE( test_memory_chunk );
+DECLARE( test_memory_allocator );
+DECLARE( test_mapped_image );
+DECLARE( test_tiff_decode );
+DECLARE( test_pyramid_builder );
 DECLARE( test_deep_copy_3_plane );
 DECLARE( test_rotate_image );
 DECLARE( test_warp );
 DECLARE( test_math_value_range );
 DECLARE( test_blocked_image_resource );
+DECLARE( test_prefetch_image_resource );
 DECLARE( test_pyramid_image_resource );
 DECLARE( test_image_list );
 DECLARE( test_border );
 DECLARE( test_4_plane_tiff );
 DECLARE( test_math_median );
+DECLARE( test_math_simd );
 DECLARE( test_round );
 DECLARE( test_pyramid_image_view );
 DECLARE( test_na );
@@ -57,16 +63,22 @@ register_tests()
   REGISTER( test_resample_bicub );
   REGISTER( test_resample_nearest );
   REGISTER( test_memory_chunk );
+  REGISTER( test_memory_allocator );
+  REGISTER( test_mapped_image );
+  REGISTER( test_tiff_decode );
+  REGISTER( test_pyramid_builder );
   REGISTER( test_deep_copy_3_plane );
   REGISTER( test_rotate_image );
   REGISTER( test_warp );
   REGISTER( test_math_value_range );
   REGISTER( test_blocked_image_resource );
+  REGISTER( test_prefetch_image_resource );
   REGISTER( test_pyramid_image_resource );
   REGISTER( test_image_list );
   REGISTER( test_border );
   REGISTER( test_4_plane_tiff );
   REGISTER( test_math_median );
+  REGISTER( test_math_simd );
   REGISTER( test_round );
   REGISTER( test_pyramid_image_view );
   REGISTER( test_na );
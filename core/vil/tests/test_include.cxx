@@ -22,7 +22,10 @@
 #include <vil/vil_blocked_image_resource.h>
 #include <vil/vil_blocked_image_facade.h>
 #include <vil/vil_cached_image_resource.h>
+#include <vil/vil_concurrent_block_cache.h>
+#include <vil/vil_prefetch_image_resource.h>
 #include <vil/vil_pyramid_image_resource_sptr.h>
+#include <vil/vil_pyramid_builder.h>
 #include <vil/vil_pyramid_image_resource.h>
 #include <vil/vil_pyramid_image_view.h>
 #include <vil/vil_image_list.h>
@@ -30,6 +33,9 @@
 #include <vil/vil_image_view_base.h>
 #include <vil/vil_load.h>
 #include <vil/vil_math.h>
+#include <vil/vil_math_simd.h>
+#include <vil/vil_mapped_memory_chunk.h>
+#include <vil/vil_memory_allocator.h>
 #include <vil/vil_memory_chunk.h>
 #include <vil/vil_memory_image.h>
 #include <vil/vil_nearest_interp.h>
@@ -37,6 +43,7 @@
 #include <vil/vil_na.h>
 #include <vil/vil_open.h>
 #include <vil/vil_pixel_format.h>
+#include <vil/vil_pooled_memory_allocator.h>
 #include <vil/vil_plane.h>
 #include <vil/vil_print.h>
 #include <vil/vil_property.h>
@@ -59,8 +66,10 @@
 #include <vil/vil_stream_core.h>
 #include <vil/vil_stream_fstream.h>
 #include <vil/vil_stream_fstream64.h>
+#include <vil/vil_stream_mmap.h>
 #include <vil/vil_stream_section.h>
 #include <vil/vil_stream_url.h>
+#include <vil/vil_thread_pool.h>
 #include <vil/vil_transform.h>
 #include <vil/vil_transpose.h>
 #include <vil/vil_view_as.h>
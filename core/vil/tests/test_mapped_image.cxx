@@ -0,0 +1,157 @@
+// This is core/vil/tests/test_mapped_image.cxx
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_config.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_load.h>
+#include <vil/vil_save.h>
+#include <vil/vil_crop.h>
+#include <vil/vil_stream_mmap.h>
+#include <vil/vil_mapped_memory_chunk.h>
+#include <vpl/vpl.h>
+#include <vul/vul_temp_filename.h>
+
+template <class T>
+static void fill_pattern(vil_image_view<T>& im)
+{
+  for (unsigned p=0; p<im.nplanes(); ++p)
+    for (unsigned j=0; j<im.nj(); ++j)
+      for (unsigned i=0; i<im.ni(); ++i)
+        im(i,j,p) = T((i*7 + j*13 + p*61 + i*j) % 251);
+}
+
+static bool is_mapped(vil_image_view_base_sptr const& v)
+{
+  if (!v) return false;
+  // all vil_image_view<T> hold their memory_chunk in the same place
+  vil_image_view<vxl_byte> const& bv = static_cast<vil_image_view<vxl_byte> const&>(*v);
+  return dynamic_cast<vil_mapped_memory_chunk*>(bv.memory_chunk().as_pointer()) != VXL_NULLPTR;
+}
+
+//: Save \p im as \p format, then check views of the memory-mapped file
+template <class T>
+static void test_format(vil_image_view<T> const& im, char const* format, bool expect_mapped)
+{
+  std::ostringstream os;
+  os << format << ' ' << vil_pixel_format_of(T()) << 'x' << im.nplanes();
+  std::string name = os.str();
+  std::string fname = vul_temp_filename() + '.' + format;
+  if (!vil_save(im, fname.c_str(), format))
+  {
+    TEST(("save "+name).c_str(), false, true);
+    return;
+  }
+  {
+    vil_image_resource_sptr res = vil_load_image_resource_mapped(fname.c_str());
+    TEST(("load "+name).c_str(), !res, false);
+    if (!res) { vpl_unlink(fname.c_str()); return; }
+
+    vil_image_view_base_sptr whole = res->get_view();
+    TEST(("whole view mapped "+name).c_str(), is_mapped(whole), expect_mapped);
+    vil_image_view<T> w = whole;
+    TEST(("whole view correct "+name).c_str(), vil_image_view_deep_equality(w, im), true);
+
+    vil_image_view_base_sptr part = res->get_view(3, 10, 5, 7);
+    TEST(("window mapped "+name).c_str(), is_mapped(part), expect_mapped);
+    vil_image_view<T> pv = part;
+    TEST(("window correct "+name).c_str(),
+         vil_image_view_deep_equality(pv, vil_crop(im, 3, 10, 5, 7)), true);
+
+    // copies are never in place
+    TEST(("copy view not mapped "+name).c_str(), is_mapped(res->get_copy_view()), false);
+
+    // writing through the view never changes the file
+    if (expect_mapped)
+    {
+      pv.fill(T(1));
+      vil_image_resource_sptr res2 = vil_load_image_resource(fname.c_str());
+      vil_image_view<T> reloaded = res2->get_view();
+      TEST(("file unchanged by writes "+name).c_str(),
+           vil_image_view_deep_equality(reloaded, im), true);
+    }
+
+    // the view keeps the mapping alive after the resource has gone;
+    // views of the same mapping share any writes made through them
+    vil_image_view<T> expected;
+    expected.deep_copy(im);
+    if (expect_mapped)
+      vil_crop(expected, 3, 10, 5, 7).fill(T(1));
+    res = VXL_NULLPTR;
+    TEST(("view outlives resource "+name).c_str(),
+         vil_image_view_deep_equality(w, expected), true);
+  }
+  vpl_unlink(fname.c_str());
+}
+
+static void test_stream_mmap()
+{
+  std::string fname = vul_temp_filename() + ".pgm";
+  vil_image_view<vxl_byte> im(4, 3);
+  fill_pattern(im);
+  vil_save(im, fname.c_str(), "pnm");
+
+  vil_stream* vs = new vil_stream_mmap(fname.c_str());
+  vs->ref();
+  TEST("vil_stream_mmap ok", vs->ok(), true);
+  TEST("file_size", vs->file_size()>12, true);
+  TEST("mapped_data", vs->mapped_data()!=VXL_NULLPTR, true);
+  char magic[2];
+  TEST("read", vs->read(magic, 2), 2);
+  TEST("magic number", magic[0]=='P' && magic[1]=='5', true);
+  TEST("tell", vs->tell(), 2);
+  vs->seek(vs->file_size()-1);
+  TEST("read past end", vs->read(magic, 2), 1);
+  TEST("write refused", vs->write(magic, 1), 0);
+  vs->unref();
+
+  vil_stream* bad = new vil_stream_mmap((fname+".does_not_exist").c_str());
+  bad->ref();
+  TEST("missing file not ok", bad->ok(), false);
+  bad->unref();
+
+  vpl_unlink(fname.c_str());
+}
+
+static void test_mapped_image()
+{
+  std::cout << "***************************\n"
+            << " Testing mapped image views\n"
+            << "***************************\n";
+
+  if (!vil_stream_mmap::is_supported())
+  {
+    std::cout << "Memory mapping not supported on this platform\n";
+    return;
+  }
+  test_stream_mmap();
+
+  vil_image_view<vxl_byte> grey(23, 17), rgb(23, 17, 3);
+  fill_pattern(grey);
+  fill_pattern(rgb);
+  vil_image_view<vxl_uint_16> grey16(23, 17);
+  fill_pattern(grey16);
+  vil_image_view<float> grey_f(23, 17);
+  fill_pattern(grey_f);
+
+  test_format(grey, "pnm", true);
+  test_format(rgb, "pnm", true);
+  test_format(grey16, "pnm", VXL_BIG_ENDIAN==1);
+  test_format(grey, "bmp", true);
+  test_format(rgb, "bmp", true);
+  test_format(grey, "mit", true);
+  test_format(grey16, "mit", VXL_LITTLE_ENDIAN==1);
+  test_format(grey, "viff", true);
+  test_format(grey_f, "viff", true);
+#if HAS_TIFF
+  test_format(grey, "tiff", true);
+  test_format(rgb, "tiff", true);
+  test_format(grey16, "tiff", true);
+  test_format(grey_f, "tiff", true);
+#endif
+}
+
+TESTMAIN(test_mapped_image);
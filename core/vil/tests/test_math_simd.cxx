@@ -0,0 +1,212 @@
+// This is core/vil/tests/test_math_simd.cxx
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_image_view.h>
+#include <vil/vil_crop.h>
+#include <vil/vil_plane.h>
+#include <vil/vil_math.h>
+#include <vil/vil_math_simd.h>
+#include <vil/vil_convert.h>
+
+static const char* level_name[] = { "none", "sse2", "avx2", "avx512" };
+
+//: An image with values in [lo,hi), of width 77 so every vector width leaves a remainder
+template <class T>
+static vil_image_view<T> make_image(unsigned np, double lo, double hi, unsigned seed)
+{
+  vil_image_view<T> im(77, 5, np);
+  for (unsigned p = 0; p<np; ++p)
+    for (unsigned j = 0; j<im.nj(); ++j)
+      for (unsigned i = 0; i<im.ni(); ++i)
+      {
+        unsigned k = (i*131 + j*71 + p*29 + seed*17) % 1009;
+        im(i,j,p) = T(lo + (hi-lo)*k/1009.0);
+      }
+  return im;
+}
+
+//: Views to test: contiguous, starting at an odd address, and with istep!=1
+template <class T>
+static void make_views(vil_image_view<T> const& im, vil_image_view<T> views[3])
+{
+  views[0] = im;
+  views[1] = vil_crop(im, 3, im.ni()-3, 1, im.nj()-1);
+  vil_image_view<T> interleaved(im.ni(), im.nj(), 1, 2);
+  for (unsigned j = 0; j<im.nj(); ++j)
+    for (unsigned i = 0; i<im.ni(); ++i)
+      interleaved(i,j,0) = interleaved(i,j,1) = im(i,j,0);
+  views[2] = vil_plane(interleaved, 1);
+}
+
+template <class T>
+static bool equal(vil_image_view<T> const& a, vil_image_view<T> const& b)
+{
+  if (a.ni()!=b.ni() || a.nj()!=b.nj() || a.nplanes()!=b.nplanes())
+    return false;
+  for (unsigned p = 0; p<a.nplanes(); ++p)
+    for (unsigned j = 0; j<a.nj(); ++j)
+      for (unsigned i = 0; i<a.ni(); ++i)
+        if (!(a(i,j,p)==b(i,j,p)))
+          return false;
+  return true;
+}
+
+template <class T>
+static void test_math_ops(const char* type_name, double lo, double hi)
+{
+  vil_image_view<T> ims_a[3], ims_b[3];
+  make_views(make_image<T>(1, lo, hi, 1), ims_a);
+  make_views(make_image<T>(1, lo, hi, 2), ims_b);
+  for (unsigned v = 0; v<3; ++v)
+  {
+    vil_image_view<T> const& a = ims_a[v];
+    vil_image_view<T> const& b = ims_b[v];
+    std::ostringstream name;
+    name << type_name << " view " << v << ' '
+         << level_name[vil_math_simd_get_level()];
+
+    T min_ref = a(0,0), max_ref = a(0,0);
+    vil_image_view<T> sum_ref(a.ni(), a.nj()), diff_ref(a.ni(), a.nj()), abs_ref(a.ni(), a.nj());
+    vil_image_view<T> scaled_ref(a.ni(), a.nj());
+    for (unsigned j = 0; j<a.nj(); ++j)
+      for (unsigned i = 0; i<a.ni(); ++i)
+      {
+        if (a(i,j)<min_ref) min_ref = a(i,j);
+        if (a(i,j)>max_ref) max_ref = a(i,j);
+        sum_ref(i,j) = T(a(i,j)+b(i,j));
+        diff_ref(i,j) = T(a(i,j)-b(i,j));
+        abs_ref(i,j) = a(i,j)>b(i,j) ? T(a(i,j)-b(i,j)) : T(b(i,j)-a(i,j));
+        scaled_ref(i,j) = T(0.37*a(i,j)+3);
+      }
+
+    T min_v, max_v;
+    vil_math_value_range(a, min_v, max_v);
+    TEST(("value_range "+name.str()).c_str(), min_v==min_ref && max_v==max_ref, true);
+
+    vil_image_view<T> out;
+    vil_math_image_sum(a, b, out);
+    TEST(("image_sum "+name.str()).c_str(), equal(out, sum_ref), true);
+    vil_math_image_difference(a, b, out);
+    TEST(("image_difference "+name.str()).c_str(), equal(out, diff_ref), true);
+    vil_math_image_abs_difference(a, b, out);
+    TEST(("image_abs_difference "+name.str()).c_str(), equal(out, abs_ref), true);
+
+    // scale in place, in a view with the same layout as a
+    vil_image_view<T> scaled(a.ni(), a.nj());
+    if (v==2)
+      scaled = vil_plane(vil_image_view<T>(a.ni(), a.nj(), 1, 2), 0);
+    for (unsigned j = 0; j<a.nj(); ++j)
+      for (unsigned i = 0; i<a.ni(); ++i)
+        scaled(i,j) = a(i,j);
+    vil_math_scale_and_offset_values(scaled, 0.37, 3);
+    TEST(("scale_and_offset_values "+name.str()).c_str(), equal(scaled, scaled_ref), true);
+  }
+}
+
+//: NaNs are ignored by vil_math_value_range, unless the first pixel is one
+static void test_value_range_nan()
+{
+  vil_image_view<float> im = make_image<float>(1, -50.0, 50.0, 3);
+  im(40,2) = std::numeric_limits<float>::quiet_NaN();
+  im(5,1) = 1000.0f;
+  im(70,4) = -1000.0f;
+  float min_v, max_v;
+  vil_math_value_range(im, min_v, max_v);
+  TEST("value_range ignores NaN", min_v==-1000.0f && max_v==1000.0f, true);
+}
+
+template <class inT, class outT>
+static void test_cast(const char* name, double lo, double hi)
+{
+  vil_image_view<inT> ims[3];
+  make_views(make_image<inT>(1, lo, hi, 4), ims);
+  for (unsigned v = 0; v<3; ++v)
+  {
+    vil_image_view<inT> const& src = ims[v];
+    vil_image_view<outT> ref(src.ni(), src.nj()), out;
+    for (unsigned j = 0; j<src.nj(); ++j)
+      for (unsigned i = 0; i<src.ni(); ++i)
+        ref(i,j) = static_cast<outT>(src(i,j));
+    vil_convert_cast(src, out);
+    std::ostringstream tname;
+    tname << "convert_cast " << name << " view " << v << ' '
+          << level_name[vil_math_simd_get_level()];
+    TEST(tname.str().c_str(), equal(out, ref), true);
+  }
+}
+
+template <class T>
+static void test_stretch(const char* name, double lo, double hi)
+{
+  vil_image_view<T> ims[3];
+  make_views(make_image<T>(1, lo, hi, 5), ims);
+  for (unsigned v = 0; v<3; ++v)
+  {
+    vil_image_view<T> const& src = ims[v];
+    T min_b = src(0,0), max_b = src(0,0);
+    for (unsigned j = 0; j<src.nj(); ++j)
+      for (unsigned i = 0; i<src.ni(); ++i)
+      {
+        if (src(i,j)<min_b) min_b = src(i,j);
+        if (src(i,j)>max_b) max_b = src(i,j);
+      }
+    double a = -1.0*double(min_b), b = 255.0/(max_b-min_b);
+    vil_image_view<vxl_byte> ref(src.ni(), src.nj()), out;
+    for (unsigned j = 0; j<src.nj(); ++j)
+      for (unsigned i = 0; i<src.ni(); ++i)
+        ref(i,j) = static_cast<vxl_byte>(b*(src(i,j)+a));
+    vil_convert_stretch_range(src, out);
+    std::ostringstream tname;
+    tname << "convert_stretch_range " << name << " view " << v << ' '
+          << level_name[vil_math_simd_get_level()];
+    TEST(tname.str().c_str(), equal(out, ref), true);
+  }
+}
+
+static void test_math_simd()
+{
+  std::cout << "***************************************\n"
+            << " Testing vectorised vil_math row loops\n"
+            << "***************************************\n";
+
+  const vil_math_simd_level best = vil_math_simd_best_level();
+  std::cout << "Best level on this machine: " << level_name[best] << '\n';
+  TEST("set_level above best is reduced",
+       vil_math_simd_set_level(vil_math_simd_avx512), best);
+
+  for (int l = vil_math_simd_none; l<=best; ++l)
+  {
+    TEST("set_level", vil_math_simd_set_level(vil_math_simd_level(l)), l);
+
+    test_math_ops<vxl_byte>("byte", 0.0, 256.0);
+    test_math_ops<vxl_uint_16>("uint_16", 0.0, 65536.0);
+    test_math_ops<float>("float", -1000.0, 1000.0);
+    test_math_ops<double>("double", -1.0e6, 1.0e6);
+    test_value_range_nan();
+
+    test_cast<vxl_byte, vxl_uint_16>("byte to uint_16", 0.0, 256.0);
+    test_cast<vxl_byte, float>("byte to float", 0.0, 256.0);
+    test_cast<vxl_byte, double>("byte to double", 0.0, 256.0);
+    test_cast<vxl_uint_16, float>("uint_16 to float", 0.0, 65536.0);
+    test_cast<vxl_uint_16, double>("uint_16 to double", 0.0, 65536.0);
+    test_cast<float, vxl_byte>("float to byte", 0.0, 255.99);
+    test_cast<float, vxl_uint_16>("float to uint_16", 0.0, 65535.99);
+    test_cast<float, double>("float to double", -1.0e5, 1.0e5);
+    test_cast<double, vxl_byte>("double to byte", 0.0, 255.99);
+    test_cast<double, vxl_uint_16>("double to uint_16", 0.0, 65535.99);
+    test_cast<double, float>("double to float", -1.0e5, 1.0e5);
+
+    test_stretch<vxl_byte>("byte", 17.0, 200.0);
+    test_stretch<vxl_uint_16>("uint_16", 100.0, 60000.0);
+    test_stretch<float>("float", -3.0, 7.0);
+    test_stretch<double>("double", -3.0e3, 7.0e4);
+  }
+  vil_math_simd_set_level(best);
+}
+
+TESTMAIN(test_math_simd);
@@ -0,0 +1,202 @@
+// This is core/vil/tests/test_memory_allocator.cxx
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_memory_allocator.h>
+#include <vil/vil_pooled_memory_allocator.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_new.h>
+
+static bool is_aligned(const void* p, std::size_t a)
+{
+  return reinterpret_cast<std::size_t>(p) % a == 0;
+}
+
+static void test_size_classes()
+{
+  TEST("class of 0 bytes", vil_pooled_memory_allocator::size_class_bytes(0), 64);
+  TEST("class of 64 bytes", vil_pooled_memory_allocator::size_class_bytes(64), 64);
+  TEST("class of 65 bytes", vil_pooled_memory_allocator::size_class_bytes(65), 80);
+  TEST("class of 128 bytes", vil_pooled_memory_allocator::size_class_bytes(128), 128);
+  TEST("class of 129 bytes", vil_pooled_memory_allocator::size_class_bytes(129), 160);
+  TEST("class of 640x480 bytes", vil_pooled_memory_allocator::size_class_bytes(640*480), 320u<<10);
+
+  bool ok = true;
+  for (std::size_t n = 1; n<100000; n = n*3/2+1)
+  {
+    std::size_t c = vil_pooled_memory_allocator::size_class_bytes(n);
+    ok = ok && c>=n && (n<=64 || 4*c<=5*n+4*16) && c%16==0;
+  }
+  TEST("classes fit and waste at most a quarter", ok, true);
+}
+
+static void test_pooled_allocator()
+{
+  vil_pooled_memory_allocator pool;
+  TEST("alignment", pool.alignment(), 64);
+
+  // blocks of every size are aligned, both fresh and reused
+  std::vector<void*> blocks;
+  std::vector<std::size_t> sizes;
+  for (std::size_t n = 1; n<(4u<<20); n = n*2+3)
+  {
+    blocks.push_back(pool.allocate(n));
+    sizes.push_back(n);
+  }
+  bool aligned = true;
+  for (unsigned i = 0; i<blocks.size(); ++i)
+    aligned = aligned && is_aligned(blocks[i], 64);
+  TEST("New blocks 64-byte aligned", aligned, true);
+
+  vil_memory_allocator_stats s = pool.stats();
+  TEST("n_allocations", s.n_allocations, blocks.size());
+  TEST("n_system_allocations", s.n_system_allocations, blocks.size());
+  std::size_t total = 0;
+  for (unsigned i = 0; i<sizes.size(); ++i) total += sizes[i];
+  TEST("bytes_in_use", s.bytes_in_use, total);
+
+  for (unsigned i = 0; i<blocks.size(); ++i)
+    pool.deallocate(blocks[i], sizes[i]);
+  s = pool.stats();
+  TEST("Nothing in use after freeing", s.bytes_in_use, 0);
+  TEST("peak_bytes_in_use", s.peak_bytes_in_use, total);
+  TEST("Freed blocks cached", s.bytes_cached>=total, true);
+
+  // the same requests again are all met from the cache
+  std::vector<void*> again;
+  for (unsigned i = 0; i<sizes.size(); ++i)
+    again.push_back(pool.allocate(sizes[i]));
+  s = pool.stats();
+  TEST("Second round reuses every block", s.n_reused, sizes.size());
+  TEST("No new system allocations", s.n_system_allocations, blocks.size());
+  aligned = true;
+  for (unsigned i = 0; i<again.size(); ++i)
+    aligned = aligned && is_aligned(again[i], 64);
+  TEST("Reused blocks 64-byte aligned", aligned, true);
+  for (unsigned i = 0; i<again.size(); ++i)
+    pool.deallocate(again[i], sizes[i]);
+
+  pool.release_cached_memory();
+  s = pool.stats();
+  TEST("release_cached_memory empties the cache", s.bytes_cached, 0);
+  TEST("Every block returned to the system",
+       s.n_system_deallocations, s.n_system_allocations);
+
+  // a small shared pool only keeps what fits
+  pool.set_max_cached_bytes(0);
+  void* big = pool.allocate(8u<<20);
+  pool.deallocate(big, 8u<<20);
+  TEST("Block beyond the cache limit is freed", pool.stats().bytes_cached, 0);
+
+  // huge pages are only a hint, so allocation must still work
+  pool.set_use_huge_pages(true);
+  TEST("use_huge_pages", pool.use_huge_pages(), true);
+  void* huge = pool.allocate(5u<<20);
+  TEST("Huge page block aligned", is_aligned(huge, 64), true);
+  static_cast<char*>(huge)[(5u<<20)-1] = 1;
+  pool.deallocate(huge, 5u<<20);
+
+  // blocks freed by another thread can be reused
+  pool.set_max_cached_bytes(64u<<20);
+  std::vector<void*> from_thread(8);
+  std::thread t([&pool, &from_thread]()
+  {
+    for (unsigned i = 0; i<from_thread.size(); ++i)
+      from_thread[i] = pool.allocate(1000);
+  });
+  t.join();
+  for (unsigned i = 0; i<from_thread.size(); ++i)
+    pool.deallocate(from_thread[i], 1000);
+  unsigned long reused = pool.stats().n_reused;
+  std::vector<void*> here(8);
+  for (unsigned i = 0; i<here.size(); ++i)
+    here[i] = pool.allocate(1000);
+  TEST("Blocks freed on this thread reused", pool.stats().n_reused, reused+8);
+  for (unsigned i = 0; i<here.size(); ++i)
+    pool.deallocate(here[i], 1000);
+
+  // many threads allocating and freeing at once
+  std::vector<std::thread> threads;
+  for (unsigned k = 0; k<4; ++k)
+    threads.push_back(std::thread([&pool, k]()
+    {
+      for (unsigned r = 0; r<200; ++r)
+      {
+        std::size_t n = 100 + 997*((r*7+k)%50);
+        char* p = static_cast<char*>(pool.allocate(n));
+        p[0] = p[n-1] = char(r);
+        pool.deallocate(p, n);
+      }
+    }));
+  for (unsigned k = 0; k<threads.size(); ++k)
+    threads[k].join();
+  s = pool.stats();
+  TEST("Threads: nothing left in use", s.bytes_in_use, 0);
+  TEST("Threads: allocations balanced", s.n_allocations, s.n_deallocations);
+}
+
+static void test_image_allocation()
+{
+  vil_pooled_memory_allocator pool;
+
+  vil_image_view<vxl_byte> im;
+  im.set_size(31, 17, 3, &pool);
+  TEST("set_size uses the allocator", im.memory_chunk()->allocator(), &pool);
+  TEST("Image aligned", is_aligned(im.top_left_ptr(), 64), true);
+  void* first = im.top_left_ptr();
+  im.set_size(31, 17, 3, &pool);
+  TEST("Same size and allocator keeps the data", im.top_left_ptr(), first);
+
+  // a new frame of the same shape reuses the freed block
+  im = vil_image_view<vxl_byte>();
+  im.set_size(31, 17, 3, &pool);
+  TEST("Frame memory reused", im.top_left_ptr(), first);
+  TEST("Reuse counted", pool.stats().n_reused, 1);
+
+  vil_image_view<float> f = vil_new_image_view_i_j_plane(10, 10, 3, float(), &pool);
+  TEST("vil_new_image_view_i_j_plane uses the allocator", f.memory_chunk()->allocator(), &pool);
+
+  // copies of a chunk use the same allocator
+  vil_memory_chunk copy(*im.memory_chunk());
+  TEST("Copied chunk uses the same allocator", copy.allocator(), &pool);
+
+  // changing the default affects set_size without an allocator
+  vil_memory_allocator* old = vil_memory_allocator::set_default_allocator(&pool);
+  TEST("Previous default is heap", old, vil_memory_allocator::heap());
+  vil_image_view<short> s(8, 8);
+  TEST("Default allocator used", s.memory_chunk()->allocator(), &pool);
+  vil_memory_allocator::set_default_allocator(VXL_NULLPTR);
+  TEST("Null restores heap", vil_memory_allocator::default_allocator(), vil_memory_allocator::heap());
+  s.set_size(9, 8);
+  TEST("Resized image uses new default", s.memory_chunk()->allocator(), vil_memory_allocator::heap());
+
+  f = vil_image_view<float>();
+  s = vil_image_view<short>();
+  im = vil_image_view<vxl_byte>();
+  TEST("All image memory returned", pool.stats().bytes_in_use, copy.size());
+}
+
+static void test_memory_allocator()
+{
+  std::cout << "******************************\n"
+            << " Testing vil_memory_allocator\n"
+            << "******************************\n";
+
+  vil_memory_allocator* heap = vil_memory_allocator::heap();
+  vil_memory_allocator_stats s0 = heap->stats();
+  {
+    vil_memory_chunk chunk(100, VIL_PIXEL_FORMAT_BYTE);
+    TEST("Default allocator is heap", chunk.allocator(), heap);
+    TEST("Heap counts allocations", heap->stats().n_allocations, s0.n_allocations+1);
+  }
+  TEST("Heap counts deallocations", heap->stats().n_deallocations, s0.n_deallocations+1);
+
+  test_size_classes();
+  test_pooled_allocator();
+  test_image_allocation();
+}
+
+TESTMAIN(test_memory_allocator);
@@ -0,0 +1,200 @@
+// This is core/vil/tests/test_prefetch_image_resource.cxx
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vil/vil_new.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_prefetch_image_resource.h>
+
+typedef vil_prefetch_image_resource::block_index block_index;
+
+static bool block_matches(vil_image_view<vxl_uint_16> const& blk,
+                          vil_image_view<vxl_uint_16> const& image,
+                          unsigned bi, unsigned bj, unsigned sb)
+{
+  // border blocks of a facade are padded out to the full block size
+  for (unsigned j = 0; j<blk.nj() && bj*sb+j<image.nj(); ++j)
+    for (unsigned i = 0; i<blk.ni() && bi*sb+i<image.ni(); ++i)
+      if (blk(i,j)!=image(bi*sb+i, bj*sb+j))
+        return false;
+  return true;
+}
+
+// Counts the blocks read, fails to read one block, and can hold the
+// first read until the test releases it
+class counting_resource : public vil_blocked_image_resource
+{
+ public:
+  counting_resource(vil_blocked_image_resource_sptr const& bir, block_index const& bad,
+                    bool hold_first_read = false)
+    : bir_(bir), bad_(bad), n_reads_(0), held_(hold_first_read), first_started_(false) {}
+  virtual unsigned nplanes() const { return bir_->nplanes(); }
+  virtual unsigned ni() const { return bir_->ni(); }
+  virtual unsigned nj() const { return bir_->nj(); }
+  virtual unsigned size_block_i() const { return bir_->size_block_i(); }
+  virtual unsigned size_block_j() const { return bir_->size_block_j(); }
+  virtual enum vil_pixel_format pixel_format() const { return bir_->pixel_format(); }
+  virtual vil_image_view_base_sptr get_block(unsigned block_index_i, unsigned block_index_j) const
+  {
+    if (n_reads_++ == 0)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      first_started_ = true;
+      changed_.notify_all();
+      while (held_)
+        changed_.wait(lock);
+    }
+    if (block_index(block_index_i, block_index_j)==bad_)
+      return VXL_NULLPTR;
+    return bir_->get_block(block_index_i, block_index_j);
+  }
+  virtual bool put_view(const vil_image_view_base&, unsigned, unsigned) { return false; }
+  virtual bool put_block(unsigned, unsigned, const vil_image_view_base&) { return false; }
+  virtual bool get_property(char const* tag, void* value = VXL_NULLPTR) const
+    { return bir_->get_property(tag, value); }
+  unsigned n_reads() const { return n_reads_; }
+  //: Wait until the first read has begun
+  void wait_for_first_read() const
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!first_started_)
+      changed_.wait(lock);
+  }
+  //: Let the first read complete
+  void release_first_read()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    held_ = false;
+    changed_.notify_all();
+  }
+ private:
+  vil_blocked_image_resource_sptr bir_;
+  block_index bad_;
+  mutable std::atomic<unsigned> n_reads_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable changed_;
+  bool held_;
+  mutable bool first_started_;
+};
+
+static void test_prefetch_image_resource()
+{
+  std::cout << "***************************************\n"
+            << " Testing vil_prefetch_image_resource\n"
+            << "***************************************\n";
+  const unsigned ni = 75, nj = 51, sb = 16;
+  vil_image_view<vxl_uint_16> image(ni, nj);
+  for (unsigned j = 0; j<nj; ++j)
+    for (unsigned i = 0; i<ni; ++i)
+      image(i,j) = vxl_uint_16(i + ni*j);
+  vil_blocked_image_resource_sptr bir =
+    vil_new_blocked_image_facade(vil_new_image_resource_of_view(image), sb, sb);
+  unsigned nbi = bir->n_block_i(), nbj = bir->n_block_j();
+
+  // block orders
+  std::vector<block_index> raster = vil_prefetch_image_resource::raster_order(nbi, nbj);
+  TEST("Raster order", raster.size()==nbi*nbj && raster[1]==block_index(1,0) &&
+       raster[nbi]==block_index(0,1), true);
+  std::vector<block_index> hilbert = vil_prefetch_image_resource::hilbert_order(nbi, nbj);
+  std::set<block_index> distinct(hilbert.begin(), hilbert.end());
+  TEST("Hilbert order covers all blocks once",
+       hilbert.size()==nbi*nbj && distinct.size()==nbi*nbj, true);
+  std::vector<block_index> h4 = vil_prefetch_image_resource::hilbert_order(4, 4);
+  bool adjacent4 = true;
+  for (unsigned k = 1; k<h4.size(); ++k)
+  {
+    int di = int(h4[k].first)-int(h4[k-1].first);
+    int dj = int(h4[k].second)-int(h4[k-1].second);
+    adjacent4 = adjacent4 && di*di+dj*dj==1;
+  }
+  TEST("Hilbert order steps between adjacent blocks", adjacent4, true);
+
+  // blocks handed back in planned order
+  {
+    vil_prefetch_image_resource pf(bir, hilbert, 3);
+    bool in_order = true, values = true;
+    unsigned bi, bj, n = 0;
+    vil_image_view_base_sptr blk;
+    while (pf.next_block(bi, bj, blk))
+    {
+      in_order = in_order && block_index(bi, bj)==hilbert[n++];
+      values = values && block_matches(blk, image, bi, bj, sb);
+    }
+    TEST("next_block follows plan", in_order && n==hilbert.size(), true);
+    TEST("next_block values", values, true);
+    TEST("Plan exhausted", pf.n_remaining(), 0);
+  }
+
+  // several workers, each with its own resource
+  {
+    std::vector<vil_blocked_image_resource_sptr> birs;
+    for (unsigned r = 0; r<3; ++r)
+      birs.push_back(vil_new_blocked_image_facade(vil_new_image_resource_of_view(image), sb, sb));
+    vil_prefetch_image_resource pf(birs, raster, 5);
+    bool values = true;
+    for (unsigned bj = 0; bj<nbj; ++bj)
+      for (unsigned bi = 0; bi<nbi; ++bi)
+      {
+        vil_image_view<vxl_uint_16> blk = pf.get_block(bi, bj);
+        values = values && block_matches(blk, image, bi, bj, sb);
+      }
+    TEST("get_block with several workers", values && pf.n_remaining()==0, true);
+  }
+
+  // region reads through get_copy_view, planned and unplanned
+  {
+    std::vector<block_index> order;
+    vil_prefetch_image_resource::append_roi_order(*bir, 10, 40, 5, 30, order);
+    vil_prefetch_image_resource::append_roi_order(*bir, 50, 25, 40, 11, order);
+    vil_blocked_image_resource_sptr pf = new vil_prefetch_image_resource(bir, order, 4);
+    vil_image_view<vxl_uint_16> v1 = pf->get_copy_view(10, 40, 5, 30);
+    vil_image_view<vxl_uint_16> v2 = pf->get_copy_view(50, 25, 40, 11);
+    vil_image_view<vxl_uint_16> v3 = pf->get_copy_view(0, 20, 0, 20); // not planned
+    TEST("Copy views", v1(0,0)==image(10,5) && v1(39,29)==image(49,34) &&
+         v2(24,10)==image(74,50) && v3(19,19)==image(19,19), true);
+    TEST("Planned regions consumed",
+         static_cast<vil_prefetch_image_resource*>(pf.ptr())->n_remaining(), 0);
+  }
+
+  // a failed read is reported as a null block, not as the end of the plan
+  {
+    counting_resource* cr = new counting_resource(bir, raster[2]);
+    vil_blocked_image_resource_sptr cr_sptr = cr;
+    vil_prefetch_image_resource pf(cr_sptr, raster, 4);
+    unsigned bi, bj, n = 0, n_null = 0;
+    vil_image_view_base_sptr blk;
+    while (pf.next_block(bi, bj, blk))
+    {
+      if (!blk) ++n_null;
+      ++n;
+    }
+    TEST("Failed read gives a null block", n==raster.size() && n_null==1, true);
+  }
+
+  // blocks skipped over before their reads start are never read
+  {
+    counting_resource* cr = new counting_resource(bir, block_index(nbi, nbj), true);
+    vil_blocked_image_resource_sptr cr_sptr = cr;
+    std::vector<block_index> six(raster.begin(), raster.begin()+6);
+    vil_prefetch_image_resource pf(cr_sptr, six, 6);
+    // the single worker is held in the read of the first block while
+    // another thread asks for the last, skipping the four in between
+    cr->wait_for_first_read();
+    vil_image_view<vxl_uint_16> blk;
+    std::thread reader([&]() { blk = pf.get_block(raster[5].first, raster[5].second); });
+    while (pf.n_remaining()>1)
+      std::this_thread::yield();
+    cr->release_first_read();
+    reader.join();
+    TEST("Skipped block values", block_matches(blk, image, raster[5].first, raster[5].second, sb), true);
+    TEST("Skipped blocks not read", cr->n_reads(), 2);
+  }
+}
+
+TESTMAIN(test_prefetch_image_resource);
@@ -0,0 +1,163 @@
+// This is core/vil/tests/test_pyramid_builder.cxx
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_config.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_new.h>
+#include <vil/vil_pyramid_builder.h>
+#include <vil/vil_pyramid_image_resource.h>
+#include <vil/vil_image_list.h>
+#include <vpl/vpl.h>
+#include <vul/vul_file.h>
+#include <vul/vul_temp_filename.h>
+
+//: Level L+1 from level L, one pixel at a time
+template <class T>
+static vil_image_view<T> reference_decimate(vil_image_view<T> const& im)
+{
+  const unsigned ni = im.ni()/2, nj = im.nj()/2;
+  vil_image_view<T> out(ni, nj, im.nplanes());
+  for (unsigned p = 0; p<im.nplanes(); ++p)
+    for (unsigned j = 0; j<nj; ++j)
+      for (unsigned i = 0; i<ni; ++i)
+      {
+        unsigned i0 = 2*i, j0 = 2*j;
+        double sum = double(im(i0,j0,p)) + im(i0+1,j0,p) + im(i0,j0+1,p) + im(i0+1,j0+1,p);
+        out(i,j,p) = T(sum/4);
+      }
+  return out;
+}
+
+template <class T>
+static vil_image_view<T> make_image(unsigned ni, unsigned nj, unsigned np)
+{
+  vil_image_view<T> im(ni, nj, np);
+  for (unsigned p = 0; p<np; ++p)
+    for (unsigned j = 0; j<nj; ++j)
+      for (unsigned i = 0; i<ni; ++i)
+        im(i,j,p) = T((i*7 + j*11 + p*29 + (i*j)%13) % 250);
+  return im;
+}
+
+//: Build levels in memory, from a base read in bands of band_nj rows
+template <class T>
+static void test_in_memory(vil_image_view<T> const& im, unsigned nlevels,
+                           unsigned band_nj, bool copy_base)
+{
+  vil_image_resource_sptr base = vil_new_image_resource_of_view(im);
+  std::vector<vil_image_resource_sptr> levels(nlevels);
+  for (unsigned L = copy_base ? 0 : 1; L<nlevels; ++L)
+    levels[L] = vil_new_image_resource(vil_pyramid_level_size(im.ni(), L),
+                                       vil_pyramid_level_size(im.nj(), L),
+                                       im.nplanes(), im.pixel_format());
+  std::ostringstream name;
+  name << im.ni() << 'x' << im.nj() << 'x' << im.nplanes() << ' '
+       << im.pixel_format() << " in bands of " << band_nj;
+  TEST(("Build levels "+name.str()).c_str(),
+       vil_build_pyramid_levels(base, levels, band_nj), true);
+
+  vil_image_view<T> expected = im;
+  for (unsigned L = 0; L<nlevels; ++L)
+  {
+    if (L>0)
+      expected = reference_decimate(expected);
+    if (!levels[L])
+      continue;
+    vil_image_view<T> got = levels[L]->get_view();
+    std::ostringstream lname;
+    lname << "Level " << L << ' ' << name.str();
+    TEST(lname.str().c_str(), vil_image_view_deep_equality(got, expected), true);
+  }
+}
+
+static void test_tiff_pyramid(std::string const& temp_dir)
+{
+#if HAS_TIFF
+  vil_image_view<vxl_uint_16> im = make_image<vxl_uint_16>(150, 77, 1);
+  vil_blocked_image_resource_sptr base =
+    vil_new_blocked_image_facade(vil_new_image_resource_of_view(im), 32, 32);
+  std::string file = vul_temp_filename() + ".tif";
+  for (unsigned system_temp = 0; system_temp<2; ++system_temp)
+  {
+    vil_pyramid_image_resource_sptr pyr =
+      vil_new_pyramid_image_from_base(file.c_str(), base.ptr(), 4, "tiff",
+                                      system_temp ? VXL_NULLPTR : temp_dir.c_str());
+    TEST("Tiff pyramid from base", bool(pyr), true);
+    if (!pyr) continue;
+    TEST("Tiff pyramid levels", pyr->nlevels(), 4);
+    vil_image_view<vxl_uint_16> expected = im;
+    for (unsigned L = 0; L<pyr->nlevels(); ++L)
+    {
+      if (L>0)
+        expected = reference_decimate(expected);
+      vil_image_resource_sptr level = pyr->get_resource(L);
+      vil_image_view<vxl_uint_16> got;
+      if (level) got = level->get_view();
+      TEST("Tiff pyramid level", vil_image_view_deep_equality(got, expected), true);
+      // the reader scales base coordinates to the level sizes
+      vil_image_view<vxl_uint_16> copy = pyr->get_copy_view(L);
+      TEST("Tiff pyramid level through get_copy_view",
+           vil_image_view_deep_equality(copy, expected), true);
+      unsigned sbi = 0;
+      TEST("Tiff pyramid level is tiled like the base",
+           level && level->get_property("size_block_i", &sbi) && sbi==32, true);
+    }
+  }
+  vpl_unlink(file.c_str());
+  TEST("Temporary files removed", vil_image_list(temp_dir.c_str()).files().empty(), true);
+#endif // HAS_TIFF
+}
+
+static void test_pyramid_builder()
+{
+  std::cout << "*****************************\n"
+            << " Testing vil_pyramid_builder\n"
+            << "*****************************\n";
+
+  TEST("level size 0", vil_pyramid_level_size(73, 0), 73);
+  TEST("level size 1", vil_pyramid_level_size(73, 1), 36);
+  TEST("level size 2", vil_pyramid_level_size(75, 2), 18);
+  TEST("level size 3", vil_pyramid_level_size(72, 3), 9);
+
+  test_in_memory(make_image<vxl_byte>(73, 43, 3), 5, 5, true);
+  test_in_memory(make_image<vxl_byte>(64, 64, 1), 4, 0, false);
+  test_in_memory(make_image<vxl_uint_16>(31, 90, 1), 5, 7, true);
+  test_in_memory(make_image<float>(17, 33, 2), 4, 16, true);
+  test_in_memory(make_image<vxl_uint_32>(9, 5, 1), 3, 1, true);
+
+  // unsupported formats and wrongly sized levels are refused
+  {
+    vil_image_resource_sptr base =
+      vil_new_image_resource_of_view(make_image<vxl_byte>(10, 10, 1));
+    std::vector<vil_image_resource_sptr> levels(2);
+    levels[1] = vil_new_image_resource(6, 5, 1, VIL_PIXEL_FORMAT_BYTE);
+    TEST("Wrong level size", vil_build_pyramid_levels(base, levels), false);
+    levels[1] = VXL_NULLPTR;
+    TEST("Missing level", vil_build_pyramid_levels(base, levels), false);
+    levels.resize(5);
+    for (unsigned L = 1; L<5; ++L)
+      levels[L] = vil_new_image_resource(vil_pyramid_level_size(10, L),
+                                         vil_pyramid_level_size(10, L),
+                                         1, VIL_PIXEL_FORMAT_BYTE);
+    TEST("Empty level", vil_build_pyramid_levels(base, levels), false);
+    levels.resize(2);
+    base = vil_new_image_resource(10, 10, 1, VIL_PIXEL_FORMAT_INT_16);
+    levels[1] = vil_new_image_resource(5, 5, 1, VIL_PIXEL_FORMAT_INT_16);
+    TEST("Unsupported format", vil_build_pyramid_levels(base, levels), false);
+  }
+
+  std::string temp_dir = vul_temp_filename();
+  if (vul_file::make_directory(temp_dir))
+  {
+    test_tiff_pyramid(temp_dir);
+    vul_file::delete_file_glob(temp_dir + "/*");
+    vpl_rmdir(temp_dir.c_str());
+  }
+}
+
+TESTMAIN(test_pyramid_builder);
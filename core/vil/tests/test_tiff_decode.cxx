@@ -0,0 +1,130 @@
+// This is core/vil/tests/test_tiff_decode.cxx
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_config.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_blocked_image_resource.h>
+#include <vil/vil_crop.h>
+#include <vil/vil_load.h>
+#include <vil/vil_new.h>
+#include <vil/vil_open.h>
+#include <vpl/vpl.h>
+#include <vul/vul_temp_filename.h>
+#if HAS_TIFF
+#include <vil/file_formats/vil_tiff.h>
+
+//: Compare tiff_byte_align_data() with unpacking one sample at a time
+template <class T>
+static void test_unpack(unsigned bits, unsigned num_samples)
+{
+  std::vector<T> in(num_samples*bits/(sizeof(T)*8) + 2);
+  for (unsigned k = 0; k<in.size(); ++k)
+    in[k] = T(0x9e3779b97f4a7c15ULL * (k+1) >> (64 - sizeof(T)*8));
+
+  std::vector<T> expected(num_samples), out(num_samples);
+  for (unsigned k = 0; k<num_samples; ++k)
+    expected[k] = tiff_get_bits<T>(&in[0], k*bits, bits);
+  tiff_byte_align_data(&in[0], num_samples, bits, &out[0]);
+
+  std::ostringstream name;
+  name << "Unpack " << num_samples << " samples of " << bits
+       << " bits in " << sizeof(T)*8 << " bit words";
+  TEST(name.str().c_str(), out==expected, true);
+}
+
+//: An image with interleaved planes, as the tiff writer expects
+template <class T>
+static vil_image_view<T> make_image(unsigned ni, unsigned nj, unsigned np)
+{
+  vil_image_view<T> im(ni, nj, 1, np);
+  for (unsigned p = 0; p<np; ++p)
+    for (unsigned j = 0; j<nj; ++j)
+      for (unsigned i = 0; i<ni; ++i)
+        im(i,j,p) = T((i*3 + j*5 + p*17 + (i*j)/7) % 200);
+  return im;
+}
+
+//: Write \p im as a tiled tiff, then read it back serially and in parallel
+template <class T>
+static void test_parallel_decode(vil_image_view<T> const& im,
+                                 vil_tiff_image::compression_methods cm,
+                                 char const* name)
+{
+  std::string fname = vul_temp_filename() + ".tif";
+  {
+    vil_stream* os = vil_open(fname.c_str(), "w");
+    vil_blocked_image_resource_sptr out =
+      vil_new_blocked_image_resource(os, im.ni(), im.nj(), im.nplanes(),
+                                     vil_pixel_format_of(T()), 16, 16, "tiff");
+    vil_tiff_image* tout = dynamic_cast<vil_tiff_image*>(out.ptr());
+    TEST("Output is a vil_tiff_image", tout!=VXL_NULLPTR, true);
+    if (!tout) return;
+    tout->set_compression_method(cm);
+    TEST("Write tiled tiff", out->put_view(im, 0, 0), true);
+  }
+
+  for (unsigned mapped = 0; mapped<2; ++mapped)
+  {
+    vil_image_resource_sptr res = mapped ?
+      vil_load_image_resource_mapped(fname.c_str()) :
+      vil_load_image_resource(fname.c_str());
+    vil_tiff_image* tiff = dynamic_cast<vil_tiff_image*>(res.ptr());
+    TEST("Input is a vil_tiff_image", tiff!=VXL_NULLPTR, true);
+    if (!tiff) continue;
+    std::string suffix = std::string(" ") + name + (mapped ? " mapped" : "");
+
+    tiff->set_decode_threads(1);
+    vil_image_view<T> serial = res->get_view();
+    TEST(("Serial decode"+suffix).c_str(),
+         vil_image_view_deep_equality(serial, im), true);
+
+    tiff->set_decode_threads(4);
+    vil_image_view<T> parallel = res->get_view();
+    TEST(("Parallel decode"+suffix).c_str(),
+         vil_image_view_deep_equality(parallel, im), true);
+
+    // again, reusing the decoding handles, on a window across several tiles
+    vil_image_view<T> window = res->get_view(5, 40, 9, 30);
+    vil_image_view<T> expected = vil_crop(im, 5, 40, 9, 30);
+    TEST(("Parallel decode of window"+suffix).c_str(),
+         vil_image_view_deep_equality(window, expected), true);
+  }
+  vpl_unlink(fname.c_str());
+}
+#endif // HAS_TIFF
+
+static void test_tiff_decode()
+{
+  std::cout << "*******************************\n"
+            << " Testing decoding of tiff files\n"
+            << "*******************************\n";
+#if HAS_TIFF
+  test_unpack<vxl_byte>(1, 77);
+  test_unpack<vxl_byte>(2, 77);
+  test_unpack<vxl_byte>(3, 77);
+  test_unpack<vxl_byte>(4, 77);
+  test_unpack<vxl_byte>(7, 77);
+  test_unpack<vxl_uint_16>(4, 51);
+  test_unpack<vxl_uint_16>(10, 51);
+  test_unpack<vxl_uint_16>(12, 51);
+  test_unpack<vxl_uint_16>(12, 8);
+  test_unpack<vxl_uint_32>(12, 45);
+  test_unpack<vxl_uint_32>(24, 45);
+
+  test_parallel_decode(make_image<vxl_byte>(100, 70, 3),
+                       vil_tiff_image::NONE, "byte rgb");
+  test_parallel_decode(make_image<vxl_byte>(100, 70, 1),
+                       vil_tiff_image::LZW, "byte lzw");
+  test_parallel_decode(make_image<vxl_uint_16>(61, 83, 1),
+                       vil_tiff_image::ADOBE_DEFLATE, "uint_16 deflate");
+#else
+  std::cout << "No tiff support\n";
+#endif // HAS_TIFF
+}
+
+TESTMAIN(test_tiff_decode);
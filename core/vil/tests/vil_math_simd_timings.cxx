@@ -0,0 +1,101 @@
+//:
+// \file
+// \brief Tool to compare the speed of the vectorised vil_math and vil_convert loops.
+// Times value range, sum, absolute difference, scale and offset, casts
+// and range stretching with plain scalar loops against each vectorised
+// level available on this machine, for byte, uint_16, float and double
+// images.
+
+#include <iostream>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+#include <vil/vil_image_view.h>
+#include <vil/vil_math.h>
+#include <vil/vil_math_simd.h>
+#include <vil/vil_convert.h>
+
+const unsigned nstests = 5;
+const char* level_name[] = { "scalar", "sse2", "avx2", "avx512" };
+
+//: Operations to time
+enum op_type { op_value_range, op_sum, op_abs_difference, op_scale_and_offset,
+               op_cast_to_float, op_stretch_range, n_ops };
+const char* op_name[] = { "value_range", "image_sum", "image_abs_difference",
+                          "scale_and_offset_values", "convert_cast to float",
+                          "convert_stretch_range" };
+
+//: Median time in ms of one operation on images a and b
+template <class T>
+double time_op(op_type op, const vil_image_view<T>& a, const vil_image_view<T>& b, int n_loops)
+{
+  vil_image_view<T> out, work;
+  work.deep_copy(a);
+  vil_image_view<float> out_float;
+  vil_image_view<vxl_byte> out_byte;
+  std::vector<double> stats(nstests);
+  for (unsigned st=0;st<nstests;++st)
+  {
+    std::clock_t t0=std::clock();
+    for (int l=0;l<n_loops;++l)
+    {
+      T min_v, max_v;
+      switch (op)
+      {
+       case op_value_range: vil_math_value_range(a, min_v, max_v); break;
+       case op_sum: vil_math_image_sum(a, b, out); break;
+       case op_abs_difference: vil_math_image_abs_difference(a, b, out); break;
+       case op_scale_and_offset: vil_math_scale_and_offset_values(work, 1.0, 0.0); break;
+       case op_cast_to_float: vil_convert_cast(a, out_float); break;
+       case op_stretch_range: vil_convert_stretch_range(a, out_byte); break;
+       default: break;
+      }
+    }
+    std::clock_t t1=std::clock();
+    stats[st] = 1000.0*(double(t1)-double(t0))/(double(n_loops)*CLOCKS_PER_SEC);
+  }
+  std::sort(stats.begin(), stats.end());
+  return stats[nstests/2];
+}
+
+template <class T>
+void run_for_type(const char* type_name, unsigned ni, unsigned nj, int n_loops)
+{
+  vil_image_view<T> a(ni, nj), b(ni, nj);
+  for (unsigned j=0;j<nj;++j)
+    for (unsigned i=0;i<ni;++i)
+    {
+      a(i,j) = T((i*17+j*31+i*j) % 251);
+      b(i,j) = T((i*7+j*13) % 241);
+    }
+
+  const vil_math_simd_level best = vil_math_simd_best_level();
+  for (int op=0; op<n_ops; ++op)
+  {
+    std::cout<<type_name<<' '<<ni<<'x'<<nj<<", "<<op_name[op]<<":\n";
+    double t_scalar = 0;
+    for (int l=vil_math_simd_none; l<=best; ++l)
+    {
+      vil_math_simd_set_level(vil_math_simd_level(l));
+      double t = time_op(op_type(op), a, b, n_loops);
+      if (l==vil_math_simd_none) t_scalar = t;
+      std::cout<<"  "<<level_name[l]<<": "<<t<<"ms";
+      if (l!=vil_math_simd_none && t>0)
+        std::cout<<"  (x"<<t_scalar/t<<')';
+      std::cout<<'\n';
+    }
+  }
+  vil_math_simd_set_level(best);
+}
+
+int main(int, char *[])
+{
+  std::cout << "Median time per image over " << nstests << " runs\n";
+  run_for_type<vxl_byte>("vxl_byte", 1024, 1024, 10);
+  run_for_type<vxl_uint_16>("vxl_uint_16", 1024, 1024, 10);
+  run_for_type<float>("float", 1024, 1024, 10);
+  run_for_type<double>("double", 1024, 1024, 10);
+  return 0;
+}
@@ -5,6 +5,27 @@
 
 #include "vil_cached_image_resource.h"
 #include <vil/vil_image_view_base.h>
+#include <vil/vil_pixel_format.h>
+
+vil_cached_image_resource::
+vil_cached_image_resource(vil_blocked_image_resource_sptr bir,
+                          const unsigned cache_size)
+  : bir_(bir)
+{
+  // a budget of cache_size full blocks, in a single shard so the
+  // whole budget is available to every block
+  std::size_t bytes_per_block =
+    std::size_t(bir->size_block_i())*bir->size_block_j()*bir->nplanes()*
+    vil_pixel_format_sizeof_components(bir->pixel_format())*
+    vil_pixel_format_num_components(bir->pixel_format());
+  cache_ = new vil_concurrent_block_cache(cache_size*bytes_per_block, 1);
+}
+
+vil_cached_image_resource::~vil_cached_image_resource()
+{
+  // this resource's address may be reused, so its blocks must not outlive it
+  cache_->remove_owner(this);
+}
 
 // Get a view that is the size of a block.
 // Uses the cache to retrieve frequently used blocks
@@ -14,15 +35,18 @@ vil_cached_image_resource::get_block( unsigned  block_index_i,
 {
   // check if the block is already in the buffer
    vil_image_view_base_sptr blk;
-  if (cache_.get_block(block_index_i, block_index_j, blk))
+  if (cache_->get_block(this, block_index_i, block_index_j, blk))
     return blk;
   // no - so get the block from the resource
+  std::lock_guard<std::mutex> lock(fill_mutex_);
+  // another thread may have fetched it while we waited for the lock
+  if (cache_->get_block(this, block_index_i, block_index_j, blk))
+    return blk;
   blk = bir_->get_block(block_index_i, block_index_j);
   if (!blk)
     return blk; // get block failed
-  // put the block in the cache (cast away const since we are just caching)
-  vil_cached_image_resource* non_const = (vil_cached_image_resource*)this;
-  non_const->cache_.add_block(block_index_i, block_index_j, blk);
+  // put the block in the cache
+  cache_->add_block(this, block_index_i, block_index_j, blk);
   return blk;
 }
 
@@ -8,19 +8,32 @@
 // \file
 // \brief A cached and blocked representation of the image_resource
 // \author J. L. Mundy
+//
+// \verbatim
+//  Modifications
+//   Blocks are now held in a vil_concurrent_block_cache so get_block() may
+//   be called from several threads, and the cache may be shared between
+//   resources.
+// \endverbatim
 
+#include <mutex>
 #include <vil/vil_blocked_image_resource.h>
-#include <vil/vil_block_cache.h>
+#include <vil/vil_concurrent_block_cache.h>
 
 class vil_cached_image_resource : public vil_blocked_image_resource
 {
  public:
 
+  //: Cache up to \p cache_size blocks of \p bir in a private cache
   vil_cached_image_resource(vil_blocked_image_resource_sptr bir,
-                            const unsigned cache_size):
-    bir_(bir), cache_(vil_block_cache(cache_size)){}
+                            const unsigned cache_size);
 
-  virtual ~vil_cached_image_resource(){}
+  //: Cache blocks of \p bir in \p cache, which may be shared with other resources
+  vil_cached_image_resource(vil_blocked_image_resource_sptr bir,
+                            vil_concurrent_block_cache_sptr const& cache):
+    bir_(bir), cache_(cache){}
+
+  virtual ~vil_cached_image_resource();
 
  inline virtual unsigned nplanes() const
     {return bir_->nplanes();}
@@ -61,9 +74,14 @@ class vil_cached_image_resource : public vil_blocked_image_resource
  inline virtual bool get_property(char const* tag, void* property_value = 0) const
     {return bir_->get_property(tag, property_value);}
 
+  //: The cache holding the blocks of this resource
+  vil_concurrent_block_cache_sptr cache() const { return cache_; }
+
  protected:
   vil_blocked_image_resource_sptr bir_;
-  vil_block_cache cache_;
+  vil_concurrent_block_cache_sptr cache_;
+  //: Serialises misses, since the underlying resource need not be thread-safe
+  mutable std::mutex fill_mutex_;
 };
 
 #endif // vil_cached_image_resource_h_
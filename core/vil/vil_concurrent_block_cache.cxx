@@ -0,0 +1,189 @@
+// This is core/vil/vil_concurrent_block_cache.cxx
+#include "vil_concurrent_block_cache.h"
+//:
+// \file
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vil/vil_pixel_format.h>
+
+vil_concurrent_block_cache::vil_concurrent_block_cache(std::size_t byte_budget,
+                                                       unsigned n_shards)
+  : byte_budget_(byte_budget), hits_(0), misses_(0), evictions_(0),
+    reference_count_(0)
+{
+  if (n_shards==0) n_shards = 1;
+  shard_budget_ = byte_budget_/n_shards;
+  shards_.resize(n_shards);
+  for (unsigned s = 0; s<n_shards; ++s)
+    shards_[s] = new shard;
+}
+
+vil_concurrent_block_cache::~vil_concurrent_block_cache()
+{
+  for (unsigned s = 0; s<shards_.size(); ++s)
+    delete shards_[s];
+}
+
+void vil_concurrent_block_cache::unref()
+{
+  assert(reference_count_>0);
+  if (--reference_count_==0)
+    delete this;
+}
+
+std::size_t vil_concurrent_block_cache::key_hash::operator()(key const& k) const
+{
+  // mix the owner address and block indices (boost::hash_combine style)
+  std::size_t h = std::hash<const void*>()(k.owner_);
+  h ^= std::hash<unsigned>()(k.i_) + 0x9e3779b9 + (h<<6) + (h>>2);
+  h ^= std::hash<unsigned>()(k.j_) + 0x9e3779b9 + (h<<6) + (h>>2);
+  return h;
+}
+
+vil_concurrent_block_cache::shard&
+vil_concurrent_block_cache::shard_for(key const& k) const
+{
+  // use the high bits, the low bits of the hash are already consumed
+  // by the unordered_map buckets
+  std::size_t h = key_hash()(k);
+  return *shards_[(h ^ (h>>16)) % shards_.size()];
+}
+
+std::size_t vil_concurrent_block_cache::block_bytes(vil_image_view_base const& blk)
+{
+  vil_pixel_format fmt = blk.pixel_format();
+  return std::size_t(blk.ni())*blk.nj()*blk.nplanes()*
+         vil_pixel_format_sizeof_components(fmt)*
+         vil_pixel_format_num_components(fmt);
+}
+
+bool vil_concurrent_block_cache::get_block(const void* owner,
+                                           unsigned block_index_i,
+                                           unsigned block_index_j,
+                                           vil_image_view_base_sptr& blk) const
+{
+  key k = { owner, block_index_i, block_index_j };
+  shard& s = shard_for(k);
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(s.mutex_);
+    std::unordered_map<key, entry_list::iterator, key_hash>::const_iterator
+      it = s.index_.find(k);
+    if (it != s.index_.end())
+    {
+      it->second->referenced_.store(true, std::memory_order_relaxed);
+      blk = it->second->blk_;
+      ++hits_;
+      return true;
+    }
+  }
+  ++misses_;
+  return false;
+}
+
+void vil_concurrent_block_cache::erase_entry(shard& s, entry_list::iterator it)
+{
+  if (s.hand_ == it)
+    ++s.hand_;
+  s.bytes_ -= it->bytes_;
+  s.index_.erase(it->key_);
+  s.entries_.erase(it);
+}
+
+void vil_concurrent_block_cache::make_room(shard& s, std::size_t bytes)
+{
+  while (!s.entries_.empty() && s.bytes_ + bytes > shard_budget_)
+  {
+    if (s.hand_ == s.entries_.end())
+      s.hand_ = s.entries_.begin();
+    if (s.hand_->referenced_.exchange(false, std::memory_order_relaxed))
+    {
+      ++s.hand_; // second chance
+      continue;
+    }
+    erase_entry(s, s.hand_++);
+    ++evictions_;
+  }
+}
+
+bool vil_concurrent_block_cache::add_block(const void* owner,
+                                           unsigned block_index_i,
+                                           unsigned block_index_j,
+                                           vil_image_view_base_sptr const& blk)
+{
+  if (!blk)
+    return false;
+  std::size_t bytes = block_bytes(*blk);
+  if (bytes > shard_budget_)
+    return false;
+  key k = { owner, block_index_i, block_index_j };
+  shard& s = shard_for(k);
+  std::unique_lock<std::shared_timed_mutex> lock(s.mutex_);
+  std::unordered_map<key, entry_list::iterator, key_hash>::iterator
+    it = s.index_.find(k);
+  if (it != s.index_.end()) // another thread got there first
+    erase_entry(s, it->second);
+  make_room(s, bytes);
+  // insert just behind the hand, so the new block is the last to be examined
+  entry_list::iterator e = s.entries_.emplace(s.hand_, k, blk, bytes);
+  s.index_[k] = e;
+  s.bytes_ += bytes;
+  return true;
+}
+
+void vil_concurrent_block_cache::remove_owner(const void* owner)
+{
+  for (unsigned i = 0; i<shards_.size(); ++i)
+  {
+    shard& s = *shards_[i];
+    std::unique_lock<std::shared_timed_mutex> lock(s.mutex_);
+    for (entry_list::iterator it = s.entries_.begin(); it != s.entries_.end(); )
+    {
+      if (it->key_.owner_ == owner)
+        erase_entry(s, it++);
+      else
+        ++it;
+    }
+  }
+}
+
+void vil_concurrent_block_cache::clear()
+{
+  for (unsigned i = 0; i<shards_.size(); ++i)
+  {
+    shard& s = *shards_[i];
+    std::unique_lock<std::shared_timed_mutex> lock(s.mutex_);
+    s.index_.clear();
+    s.entries_.clear();
+    s.hand_ = s.entries_.end();
+    s.bytes_ = 0;
+  }
+}
+
+std::size_t vil_concurrent_block_cache::bytes_in_use() const
+{
+  std::size_t total = 0;
+  for (unsigned i = 0; i<shards_.size(); ++i)
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(shards_[i]->mutex_);
+    total += shards_[i]->bytes_;
+  }
+  return total;
+}
+
+std::size_t vil_concurrent_block_cache::n_blocks() const
+{
+  std::size_t total = 0;
+  for (unsigned i = 0; i<shards_.size(); ++i)
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(shards_[i]->mutex_);
+    total += shards_[i]->index_.size();
+  }
+  return total;
+}
+
+void vil_concurrent_block_cache::reset_statistics()
+{
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
@@ -0,0 +1,162 @@
+// This is core/vil/vil_concurrent_block_cache.h
+#ifndef vil_concurrent_block_cache_h_
+#define vil_concurrent_block_cache_h_
+//:
+// \file
+// \brief A thread-safe block cache limited by a budget in bytes
+//
+// Blocks are distributed over a number of independently locked shards
+// by hashing their key, so threads working on different blocks rarely
+// contend for the same lock. Within a shard, eviction uses the CLOCK
+// (second chance) approximation to LRU: a hit only sets a reference flag
+// on the block, so readers take the shard lock in shared mode and never
+// reorder any list. An insertion sweeps the clock hand, clearing flags,
+// until it finds an unreferenced block to evict. Both hits and inserts
+// are therefore O(1) amortised.
+//
+// The key of a block includes an owner, normally the address of the
+// resource the block came from, so a single cache can be shared by
+// several vil_cached_image_resource objects. An owner must call
+// remove_owner() before it is destroyed.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include <vcl_atomic_count.h>
+#include <vcl_compiler.h>
+#include <vil/vil_image_view_base.h>
+#include <vil/vil_smart_ptr.h>
+
+class vil_concurrent_block_cache
+{
+ public:
+  //: Construct a cache that holds at most \p byte_budget bytes of pixel data.
+  // The budget is divided evenly between \p n_shards shards.
+  vil_concurrent_block_cache(std::size_t byte_budget, unsigned n_shards = 16);
+
+  ~vil_concurrent_block_cache();
+
+  //: Retrieve a block. Returns false on a miss.
+  bool get_block(const void* owner,
+                 unsigned block_index_i, unsigned block_index_j,
+                 vil_image_view_base_sptr& blk) const;
+
+  //: Add a block, evicting old blocks from its shard if necessary.
+  // Returns false if the block is larger than a shard's share of the budget
+  // and so cannot be cached. Replaces any block already stored under the key.
+  bool add_block(const void* owner,
+                 unsigned block_index_i, unsigned block_index_j,
+                 vil_image_view_base_sptr const& blk);
+
+  //: Remove all blocks belonging to \p owner
+  void remove_owner(const void* owner);
+
+  //: Remove all blocks
+  void clear();
+
+  //: Maximum number of bytes held by the cache
+  std::size_t byte_budget() const { return byte_budget_; }
+
+  //: Number of bytes currently held by the cache
+  std::size_t bytes_in_use() const;
+
+  //: Number of blocks currently held by the cache
+  std::size_t n_blocks() const;
+
+  //: Number of shards
+  unsigned n_shards() const { return static_cast<unsigned>(shards_.size()); }
+
+  //: Number of successful get_block() calls
+  unsigned long n_hits() const { return hits_; }
+
+  //: Number of unsuccessful get_block() calls
+  unsigned long n_misses() const { return misses_; }
+
+  //: Number of blocks evicted to make room for new ones
+  unsigned long n_evictions() const { return evictions_; }
+
+  //: Reset the hit, miss and eviction counters
+  void reset_statistics();
+
+  //: Number of bytes of pixel data in a block
+  static std::size_t block_bytes(vil_image_view_base const& blk);
+
+  //: Increment reference count
+  void ref() { ++reference_count_; }
+
+  //: Decrement reference count, deleting the cache when it reaches zero
+  void unref();
+
+ private:
+  struct key
+  {
+    const void* owner_;
+    unsigned i_;
+    unsigned j_;
+    bool operator==(key const& k) const
+    { return owner_==k.owner_ && i_==k.i_ && j_==k.j_; }
+  };
+
+  struct key_hash
+  {
+    std::size_t operator()(key const& k) const;
+  };
+
+  struct entry
+  {
+    entry(key const& k, vil_image_view_base_sptr const& blk, std::size_t bytes)
+      : key_(k), blk_(blk), bytes_(bytes), referenced_(false) {}
+    key key_;
+    vil_image_view_base_sptr blk_;
+    std::size_t bytes_;
+    //: Set on every hit, cleared as the clock hand passes
+    mutable std::atomic<bool> referenced_;
+  };
+
+  typedef std::list<entry> entry_list;
+
+  struct shard
+  {
+    shard() : bytes_(0), hand_(entries_.end()) {}
+    mutable std::shared_timed_mutex mutex_;
+    entry_list entries_;
+    std::unordered_map<key, entry_list::iterator, key_hash> index_;
+    std::size_t bytes_;
+    entry_list::iterator hand_;
+  };
+
+  shard& shard_for(key const& k) const;
+
+  //: Erase the entry at \p it, keeping the clock hand valid. Caller holds the lock.
+  static void erase_entry(shard& s, entry_list::iterator it);
+
+  //: Evict from \p s until \p bytes more will fit. Caller holds the lock.
+  void make_room(shard& s, std::size_t bytes);
+
+  std::size_t byte_budget_;
+  std::size_t shard_budget_;
+  std::vector<shard*> shards_;
+
+  mutable std::atomic<unsigned long> hits_;
+  mutable std::atomic<unsigned long> misses_;
+  std::atomic<unsigned long> evictions_;
+
+  vcl_atomic_count reference_count_;
+
+  // not copyable
+  vil_concurrent_block_cache(vil_concurrent_block_cache const&);
+  vil_concurrent_block_cache& operator=(vil_concurrent_block_cache const&);
+};
+
+typedef vil_smart_ptr<vil_concurrent_block_cache> vil_concurrent_block_cache_sptr;
+
+#endif // vil_concurrent_block_cache_h_
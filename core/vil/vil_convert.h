@@ -235,6 +235,51 @@ inline void vil_convert_cast_pixel<In, Out>::operator () (In v, Out &d) const
 #endif
 
 
+//: Cast the pixels of a 1D image to another pixel type.
+template <class inP, class outP>
+inline void vil_convert_cast_1d_generic(const inP* src, std::ptrdiff_t s_step,
+                                        outP* dest, std::ptrdiff_t d_step,
+                                        unsigned len)
+{
+  vil_convert_cast_pixel<inP, outP> cast;
+  for (unsigned i = 0; i < len; ++i, src += s_step, dest += d_step)
+    cast(*src, *dest);
+}
+
+//: Cast the pixels of a 1D image to another pixel type.
+// Specialize this function for an optimized implementation
+template <class inP, class outP>
+inline void vil_convert_cast_1d(const inP* src, std::ptrdiff_t s_step,
+                                outP* dest, std::ptrdiff_t d_step,
+                                unsigned len)
+{
+  vil_convert_cast_1d_generic(src, s_step, dest, d_step, len);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define macro( in , out )\
+template <> \
+inline void vil_convert_cast_1d(const in* src, std::ptrdiff_t s_step, \
+                                out* dest, std::ptrdiff_t d_step, \
+                                unsigned len) \
+{ \
+  if (s_step == 1 && d_step == 1) vil_math_simd_cast(src, dest, len); \
+  else vil_convert_cast_1d_generic(src, s_step, dest, d_step, len); \
+}
+macro( vxl_byte , vxl_uint_16 )
+macro( vxl_byte , float )
+macro( vxl_byte , double )
+macro( vxl_uint_16 , float )
+macro( vxl_uint_16 , double )
+macro( float , vxl_byte )
+macro( float , vxl_uint_16 )
+macro( float , double )
+macro( double , vxl_byte )
+macro( double , vxl_uint_16 )
+macro( double , float )
+#undef macro
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Cast one pixel type to another.
 // There must be a cast operator from inP to outP
 //
@@ -246,9 +291,17 @@ inline void vil_convert_cast(const vil_image_view<inP >&src,
                              vil_image_view<outP >&dest)
 {
   if (vil_pixel_format_of(inP()) == vil_pixel_format_of(outP()))
+  {
     dest = src;
-  else
-    vil_transform2(src, dest, vil_convert_cast_pixel<inP, outP>());
+    return;
+  }
+  const unsigned ni = src.ni(), nj = src.nj(), np = src.nplanes();
+  dest.set_size(ni, nj, np);
+  for (unsigned p = 0; p < np; ++p)
+    for (unsigned j = 0; j < nj; ++j)
+      vil_convert_cast_1d(src.top_left_ptr() + p*src.planestep() + j*src.jstep(), src.istep(),
+                          dest.top_left_ptr() + p*dest.planestep() + j*dest.jstep(), dest.istep(),
+                          ni);
 }
 
 #if 0 // TODO ?
@@ -524,6 +577,43 @@ inline void vil_convert_planes_to_grey(const vil_image_view<inP>&src,
 }
 
 
+//: Set dest = b*(src+a) along a 1D image, for vil_convert_stretch_range()
+template <class T>
+inline void vil_convert_stretch_range_1d_generic(const T* src, std::ptrdiff_t s_step,
+                                                 vxl_byte* dest, std::ptrdiff_t d_step,
+                                                 unsigned len, double a, double b)
+{
+  for (unsigned i = 0; i < len; ++i, src += s_step, dest += d_step)
+    *dest = static_cast<vxl_byte>( b*( *src + a ) );
+}
+
+//: Set dest = b*(src+a) along a 1D image, for vil_convert_stretch_range()
+// Specialize this function for an optimized implementation
+template <class T>
+inline void vil_convert_stretch_range_1d(const T* src, std::ptrdiff_t s_step,
+                                         vxl_byte* dest, std::ptrdiff_t d_step,
+                                         unsigned len, double a, double b)
+{
+  vil_convert_stretch_range_1d_generic(src, s_step, dest, d_step, len, a, b);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define macro( in )\
+template <> \
+inline void vil_convert_stretch_range_1d(const in* src, std::ptrdiff_t s_step, \
+                                         vxl_byte* dest, std::ptrdiff_t d_step, \
+                                         unsigned len, double a, double b) \
+{ \
+  if (s_step == 1 && d_step == 1) vil_math_simd_linear(src, dest, len, a, b, 0.0); \
+  else vil_convert_stretch_range_1d_generic(src, s_step, dest, d_step, len, a, b); \
+}
+macro( vxl_byte )
+macro( vxl_uint_16 )
+macro( float )
+macro( double )
+#undef macro
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Convert src to byte image dest by stretching to range [0,255]
 // \relatesalso vil_image_view
 template <class T>
@@ -538,8 +628,9 @@ inline void vil_convert_stretch_range(const vil_image_view<T>& src,
   dest.set_size(src.ni(), src.nj(), src.nplanes());
   for (unsigned p = 0; p < src.nplanes(); ++p)
     for (unsigned j = 0; j < src.nj(); ++j)
-      for (unsigned i = 0; i < src.ni(); ++i)
-        dest(i,j,p) = static_cast<vxl_byte>( b*( src(i,j,p)+ a ) );
+      vil_convert_stretch_range_1d(src.top_left_ptr() + p*src.planestep() + j*src.jstep(), src.istep(),
+                                   dest.top_left_ptr() + p*dest.planestep() + j*dest.jstep(), dest.istep(),
+                                   src.ni(), a, b);
 }
 
 
@@ -9,6 +9,7 @@ class vil_image_list;
 class vil_memory_image;
 class vil_memory_chunk;
 class vil_block_cache;
+class vil_concurrent_block_cache;
 class vil_image_view_base;
 template <class T> class vil_image_view;
 template <class T> struct vil_rgb;
@@ -17,6 +18,7 @@ template <class T> class vil_smart_ptr;
 typedef vil_smart_ptr<vil_image_resource> vil_image_resource_sptr;
 typedef vil_smart_ptr<vil_image_view_base> vil_image_view_base_sptr;
 typedef vil_smart_ptr<vil_memory_chunk> vil_memory_chunk_sptr;
+typedef vil_smart_ptr<vil_concurrent_block_cache> vil_concurrent_block_cache_sptr;
 
 template <class imT> class vil_border;
 template <class imT> class vil_border_accessor;
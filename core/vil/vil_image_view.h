@@ -218,6 +218,13 @@ class vil_image_view : public vil_image_view_base
   // If already correct size, this function returns quickly
   virtual void set_size(unsigned ni, unsigned nj, unsigned nplanes);
 
+  //: resize to ni x nj x nplanes, allocating any new memory from \p allocator
+  // If already the correct size and using memory from \p allocator,
+  // this function returns quickly. A null allocator means
+  // vil_memory_allocator::default_allocator().
+  void set_size(unsigned ni, unsigned nj, unsigned nplanes,
+                vil_memory_allocator* allocator);
+
   //: Make a copy of the data in src and set this to view it
   void deep_copy(const vil_image_view<T>& src);
 
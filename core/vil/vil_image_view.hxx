@@ -663,11 +663,23 @@ void vil_image_view<T>::set_size(unsigned n_i, unsigned n_j, unsigned n_planes)
 {
   if (n_i==ni_ && n_j==nj_ && n_planes==nplanes_) return;
 
+  set_size(n_i, n_j, n_planes, VXL_NULLPTR);
+}
+
+template<class T>
+void vil_image_view<T>::set_size(unsigned n_i, unsigned n_j, unsigned n_planes,
+                                 vil_memory_allocator* allocator)
+{
+  if (!allocator) allocator = vil_memory_allocator::default_allocator();
+  if (n_i==ni_ && n_j==nj_ && n_planes==nplanes_ &&
+      ptr_ && ptr_->allocator()==allocator) return;
+
   release_memory();
 
   vil_pixel_format fmt = vil_pixel_format_of(T());
   ptr_ = new vil_memory_chunk(sizeof(T)*n_planes*n_j*n_i,
-                              vil_pixel_format_component_format(fmt));
+                              vil_pixel_format_component_format(fmt),
+                              allocator);
 
   ni_ = n_i;
   nj_ = n_j;
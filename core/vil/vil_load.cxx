@@ -12,6 +12,7 @@
 #include <vil/vil_new.h>
 #include <vil/vil_file_format.h>
 #include <vil/vil_stream.h>
+#include <vil/vil_stream_mmap.h>
 #include <vil/vil_image_resource.h>
 #include <vil/vil_image_resource_plugin.h>
 #include <vil/vil_image_view.h>
@@ -69,6 +70,32 @@ vil_image_resource_sptr vil_load_image_resource_raw(char const* filename,
   return isp;
 }
 
+vil_image_resource_sptr vil_load_image_resource_mapped(char const* filename,
+                                                       bool verbose)
+{
+  vil_smart_ptr<vil_stream> is = new vil_stream_mmap(filename);
+  if (!is->ok())
+    return vil_load_image_resource_raw(filename, verbose);
+
+  vil_image_resource_sptr isp = VXL_NULLPTR;
+#ifdef VCL_HAS_EXCEPTIONS
+  try
+  {
+    isp = vil_load_image_resource_raw(is.as_pointer(), verbose);
+  }
+  catch (const vil_exception_corrupt_image_file &e)
+  {
+    throw vil_exception_corrupt_image_file(e.function_name, e.file_type, filename, e.details);
+  }
+#else
+  isp = vil_load_image_resource_raw(is.as_pointer(), verbose);
+#endif
+
+  if (!isp && verbose)
+    std::cerr << __FILE__ ": Failed to load [" << filename << "]\n";
+  return isp;
+}
+
 vil_image_resource_sptr vil_load_image_resource(char const* filename,
                                                 bool verbose)
 {
@@ -47,6 +47,16 @@ vil_image_resource_sptr vil_load_image_resource_raw(vil_stream *,
 vil_image_resource_sptr vil_load_image_resource_raw(char const*,
                                                     bool verbose = true);
 
+//: Load an image resource object from a memory-mapped file.
+// Won't use plugins. The file is mapped into memory rather than read,
+// and for uncompressed formats (PNM, BMP, MIT, VIFF and simple TIFF)
+// get_view() then returns a view pointing straight into the mapping
+// instead of a copy. Falls back to vil_load_image_resource_raw() if the
+// file cannot be mapped.
+// \relatesalso vil_image_resource
+vil_image_resource_sptr vil_load_image_resource_mapped(char const* filename,
+                                                       bool verbose = true);
+
 //: Load from a filename with a plugin.
 // \relatesalso vil_image_resource
 vil_image_resource_sptr vil_load_image_resource_plugin(char const*);
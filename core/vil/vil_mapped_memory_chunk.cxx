@@ -0,0 +1,112 @@
+// This is core/vil/vil_mapped_memory_chunk.cxx
+#include <cstddef>
+#include "vil_mapped_memory_chunk.h"
+//:
+// \file
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vil/vil_image_view.h>
+
+vil_memory_chunk_sptr vil_mapped_memory_chunk::create(vil_stream* vs,
+                                                      vil_streampos offset,
+                                                      vil_streampos n,
+                                                      vil_pixel_format pixel_format)
+{
+  char* base = vs ? static_cast<char*>(vs->mapped_data()) : VXL_NULLPTR;
+  if (!base || offset<0 || n<=0 || offset+n>vs->file_size())
+    return VXL_NULLPTR;
+  char* data = base + offset;
+  std::size_t component_size = vil_pixel_format_sizeof_components(pixel_format);
+  if (component_size>1 && reinterpret_cast<std::size_t>(data) % component_size != 0)
+    return VXL_NULLPTR;
+  return new vil_mapped_memory_chunk(vs, data, std::size_t(n),
+                                     vil_pixel_format_component_format(pixel_format));
+}
+
+vil_mapped_memory_chunk::vil_mapped_memory_chunk(vil_stream* vs, void* data,
+                                                 std::size_t n,
+                                                 vil_pixel_format pixel_format)
+  : stream_(vs)
+{
+  stream_->ref();
+  data_ = data;
+  size_ = n;
+  pixel_format_ = pixel_format;
+}
+
+vil_mapped_memory_chunk::~vil_mapped_memory_chunk()
+{
+  // leave nothing for ~vil_memory_chunk() to free
+  release_stream();
+}
+
+void vil_mapped_memory_chunk::release_stream()
+{
+  if (!stream_) return;
+  data_ = VXL_NULLPTR;
+  size_ = 0;
+  stream_->unref();
+  stream_ = VXL_NULLPTR;
+}
+
+void vil_mapped_memory_chunk::set_size(unsigned long n, vil_pixel_format pixel_format)
+{
+  if (size_==n) return;
+  release_stream();
+  vil_memory_chunk::set_size(n, pixel_format);
+}
+
+vil_image_view_base_sptr vil_mapped_image_view(vil_stream* vs,
+                                               vil_pixel_format pixel_format,
+                                               vil_streampos offset,
+                                               unsigned ni, unsigned nj, unsigned nplanes,
+                                               std::ptrdiff_t istep, std::ptrdiff_t jstep,
+                                               std::ptrdiff_t planestep)
+{
+  assert(vil_pixel_format_num_components(pixel_format)==1);
+  if (ni==0 || nj==0 || nplanes==0)
+    return VXL_NULLPTR;
+
+  // range of bytes covered by the view
+  const vil_streampos cs = vil_pixel_format_sizeof_components(pixel_format);
+  const vil_streampos d[3] = { vil_streampos(istep)*(ni-1)*cs,
+                               vil_streampos(jstep)*(nj-1)*cs,
+                               vil_streampos(planestep)*(nplanes-1)*cs };
+  vil_streampos lo = offset, hi = offset+cs;
+  for (unsigned k=0; k<3; ++k)
+    if (d[k]<0) lo += d[k]; else hi += d[k];
+
+  vil_memory_chunk_sptr chunk =
+    vil_mapped_memory_chunk::create(vs, lo, hi-lo, pixel_format);
+  if (!chunk)
+    return VXL_NULLPTR;
+  char* top_left = static_cast<char*>(chunk->data()) + (offset-lo);
+
+  switch (pixel_format)
+  {
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define macro( F , T ) \
+   case F: \
+    return new vil_image_view<T >(chunk, reinterpret_cast<T*>(top_left), \
+                                  ni, nj, nplanes, istep, jstep, planestep);
+   macro(VIL_PIXEL_FORMAT_BYTE , vxl_byte )
+   macro(VIL_PIXEL_FORMAT_SBYTE , vxl_sbyte )
+#if VXL_HAS_INT_64
+   macro(VIL_PIXEL_FORMAT_UINT_64 , vxl_uint_64 )
+   macro(VIL_PIXEL_FORMAT_INT_64 , vxl_int_64 )
+#endif
+   macro(VIL_PIXEL_FORMAT_UINT_32 , vxl_uint_32 )
+   macro(VIL_PIXEL_FORMAT_INT_32 , vxl_int_32 )
+   macro(VIL_PIXEL_FORMAT_UINT_16 , vxl_uint_16 )
+   macro(VIL_PIXEL_FORMAT_INT_16 , vxl_int_16 )
+   macro(VIL_PIXEL_FORMAT_FLOAT , float )
+   macro(VIL_PIXEL_FORMAT_DOUBLE , double )
+   macro(VIL_PIXEL_FORMAT_BOOL , bool )
+   macro(VIL_PIXEL_FORMAT_COMPLEX_FLOAT , std::complex<float> )
+   macro(VIL_PIXEL_FORMAT_COMPLEX_DOUBLE , std::complex<double> )
+#undef macro
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+   default:
+    return VXL_NULLPTR;
+  }
+}
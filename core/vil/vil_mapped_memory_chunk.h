@@ -0,0 +1,72 @@
+// This is core/vil/vil_mapped_memory_chunk.h
+#ifndef vil_mapped_memory_chunk_h_
+#define vil_mapped_memory_chunk_h_
+//:
+// \file
+// \brief A vil_memory_chunk pointing into a memory-mapped vil_stream
+//
+// Lets image readers return views of pixels that are already in memory,
+// in the layout of the file, without copying them. The chunk holds a
+// reference to the stream, so the mapping stays valid for as long as
+// any view of it exists.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vcl_compiler.h>
+#include <vil/vil_memory_chunk.h>
+#include <vil/vil_stream.h>
+#include <vil/vil_image_view_base.h>
+
+class vil_mapped_memory_chunk : public vil_memory_chunk
+{
+ public:
+  //: A chunk viewing \p n bytes of \p vs in place, starting at \p offset.
+  // Returns a null pointer if vs->mapped_data() is null, if the bytes are
+  // not all within the stream, or if they do not start on a multiple of
+  // the size of a component of \p pixel_format.
+  static vil_memory_chunk_sptr create(vil_stream* vs,
+                                      vil_streampos offset, vil_streampos n,
+                                      vil_pixel_format pixel_format);
+
+  //: Release the stream, without freeing the data
+  ~vil_mapped_memory_chunk();
+
+  //: Create space for n bytes, detaching the chunk from the stream.
+  // The mapped bytes are left untouched if the size is already n.
+  virtual void set_size(unsigned long n, vil_pixel_format pixel_format);
+
+ private:
+  vil_mapped_memory_chunk(vil_stream* vs, void* data, std::size_t n,
+                          vil_pixel_format pixel_format);
+
+  //: Detach from the stream
+  void release_stream();
+
+  //: Stream into whose mapping data_ points, or null once detached
+  vil_stream* stream_;
+
+  // not copyable: copy a vil_memory_chunk instead
+  vil_mapped_memory_chunk(vil_mapped_memory_chunk const&);
+  vil_mapped_memory_chunk& operator=(vil_mapped_memory_chunk const&);
+};
+
+//: A view of pixels of a memory-mapped stream, in place.
+// \p offset is the position in \p vs of the first component of pixel
+// (0,0) in plane 0, and the steps are in units of components, as for
+// vil_image_view. \p pixel_format must be a scalar format. Returns a null
+// pointer if the pixels cannot be viewed in place (see
+// vil_mapped_memory_chunk::create()), in which case the caller should
+// read a copy instead.
+// \relatesalso vil_mapped_memory_chunk
+vil_image_view_base_sptr vil_mapped_image_view(vil_stream* vs,
+                                               vil_pixel_format pixel_format,
+                                               vil_streampos offset,
+                                               unsigned ni, unsigned nj, unsigned nplanes,
+                                               std::ptrdiff_t istep, std::ptrdiff_t jstep,
+                                               std::ptrdiff_t planestep);
+
+#endif // vil_mapped_memory_chunk_h_
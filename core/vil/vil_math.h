@@ -16,10 +16,47 @@
 #include <vil/vil_plane.h>
 #include <vil/vil_transform.h>
 #include <vil/vil_config.h>
+#include <vil/vil_math_simd.h>
 
-#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
-#include "vil_math_sse.h"
-#endif
+//: Update min_value and max_value to include the pixels of a 1D image
+template<class T>
+inline void vil_math_value_range_1d_generic(const T* px, std::ptrdiff_t is, unsigned len,
+                                            T& min_value, T& max_value)
+{
+  for (unsigned i=0;i<len;++i,px+=is)
+  {
+    const T pixel = *px;
+    if (pixel<min_value)
+      min_value=pixel;
+    else if (pixel>max_value)
+      max_value=pixel;
+  }
+}
+
+//: Update min_value and max_value to include the pixels of a 1D image
+// Specialize this function for an optimized implementation
+template<class T>
+inline void vil_math_value_range_1d(const T* px, std::ptrdiff_t is, unsigned len,
+                                    T& min_value, T& max_value)
+{
+  vil_math_value_range_1d_generic(px, is, len, min_value, max_value);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_VALUE_RANGE_1D_SIMD( T ) \
+template<> \
+inline void vil_math_value_range_1d(const T* px, std::ptrdiff_t is, unsigned len, \
+                                    T& min_value, T& max_value) \
+{ \
+  if (is==1) vil_math_simd_value_range(px, len, min_value, max_value); \
+  else vil_math_value_range_1d_generic(px, is, len, min_value, max_value); \
+}
+VIL_MATH_VALUE_RANGE_1D_SIMD( vxl_byte )
+VIL_MATH_VALUE_RANGE_1D_SIMD( vxl_uint_16 )
+VIL_MATH_VALUE_RANGE_1D_SIMD( float )
+VIL_MATH_VALUE_RANGE_1D_SIMD( double )
+#undef VIL_MATH_VALUE_RANGE_1D_SIMD
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 //: Compute minimum and maximum values over view
 template<class T>
@@ -38,17 +75,15 @@ inline void vil_math_value_range(const vil_image_view<T>& view, T& min_value, T&
   unsigned ni = view.ni();
   unsigned nj = view.nj();
   unsigned np = view.nplanes();
+  std::ptrdiff_t istep=view.istep(),jstep=view.jstep(),pstep=view.planestep();
 
-  for (unsigned p=0;p<np;++p)
-    for (unsigned j=0;j<nj;++j)
-      for (unsigned i=0;i<ni;++i)
-      {
-        const T pixel = view(i,j,p);
-        if (pixel<min_value)
-          min_value=pixel;
-        else if (pixel>max_value)
-          max_value=pixel;
-      }
+  const T* plane = view.top_left_ptr();
+  for (unsigned p=0;p<np;++p,plane+=pstep)
+  {
+    const T* row = plane;
+    for (unsigned j=0;j<nj;++j,row+=jstep)
+      vil_math_value_range_1d(row, istep, ni, min_value, max_value);
+  }
 }
 
 //: Compute minimum and maximum values over view
@@ -516,6 +551,39 @@ inline void vil_math_scale_values(vil_image_view<T>& image, double scale)
   vil_transform(image,vil_math_scale_functor(scale));
 }
 
+//: Multiply values in-place in a 1D image by scale and add offset
+template<class imT>
+inline void vil_math_scale_and_offset_1d_generic(imT* px, std::ptrdiff_t is, unsigned len,
+                                                 double scale, double offset)
+{
+  for (unsigned i=0;i<len;++i,px+=is) *px = imT(scale*(*px)+offset);
+}
+
+//: Multiply values in-place in a 1D image by scale and add offset
+// Specialize this function for an optimized implementation
+template<class imT>
+inline void vil_math_scale_and_offset_1d(imT* px, std::ptrdiff_t is, unsigned len,
+                                         double scale, double offset)
+{
+  vil_math_scale_and_offset_1d_generic(px, is, len, scale, offset);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_SCALE_AND_OFFSET_1D_SIMD( T ) \
+template<> \
+inline void vil_math_scale_and_offset_1d(T* px, std::ptrdiff_t is, unsigned len, \
+                                         double scale, double offset) \
+{ \
+  if (is==1) vil_math_simd_linear(px, px, len, 0.0, scale, offset); \
+  else vil_math_scale_and_offset_1d_generic(px, is, len, scale, offset); \
+}
+VIL_MATH_SCALE_AND_OFFSET_1D_SIMD( vxl_byte )
+VIL_MATH_SCALE_AND_OFFSET_1D_SIMD( vxl_uint_16 )
+VIL_MATH_SCALE_AND_OFFSET_1D_SIMD( float )
+VIL_MATH_SCALE_AND_OFFSET_1D_SIMD( double )
+#undef VIL_MATH_SCALE_AND_OFFSET_1D_SIMD
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Multiply values in-place in image view by scale and add offset
 // \relatesalso vil_image_view
 template<class imT, class offsetT>
@@ -523,12 +591,19 @@ inline void vil_math_scale_and_offset_values(vil_image_view<imT>& image, double
 {
   unsigned ni = image.ni(),nj = image.nj(),np = image.nplanes();
   std::ptrdiff_t istep=image.istep(),jstep=image.jstep(),pstep = image.planestep();
+  // scale*x+offset is evaluated in double unless offsetT is wider
+  const bool double_offset = sizeof(scale*offset)==sizeof(double);
   imT* plane = image.top_left_ptr();
   for (unsigned p=0;p<np;++p,plane += pstep)
   {
     imT* row = plane;
     for (unsigned j=0;j<nj;++j,row += jstep)
     {
+      if (double_offset)
+      {
+        vil_math_scale_and_offset_1d(row, istep, ni, scale, double(offset));
+        continue;
+      }
       imT* pixel = row;
       for (unsigned i=0;i<ni;++i,pixel+=istep) *pixel = imT(scale*(*pixel)+offset);
     }
@@ -692,6 +767,51 @@ void vil_math_sum_sqr(const vil_image_view<srcT>& src,
   }
 }
 
+//: Compute sum of two 1D images (im_sum = imA+imB)
+template<class aT, class bT, class sumT>
+inline void vil_math_image_sum_1d_generic(
+  const aT* pxA, std::ptrdiff_t isA,
+  const bT* pxB, std::ptrdiff_t isB,
+  sumT* pxS, std::ptrdiff_t isS,
+  unsigned len)
+{
+  for (unsigned i=0;i<len;++i,pxA+=isA,pxB+=isB,pxS+=isS)
+    *pxS = sumT(*pxA)+sumT(*pxB);
+}
+
+//: Compute sum of two 1D images (im_sum = imA+imB)
+// Specialize this function for an optimized implementation
+template<class aT, class bT, class sumT>
+inline void vil_math_image_sum_1d(
+  const aT* pxA, std::ptrdiff_t isA,
+  const bT* pxB, std::ptrdiff_t isB,
+  sumT* pxS, std::ptrdiff_t isS,
+  unsigned len)
+{
+  vil_math_image_sum_1d_generic<aT,bT,sumT>(pxA, isA, pxB, isB, pxS, isS, len);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_IMAGE_SUM_1D_SIMD( T ) \
+template<> \
+inline void vil_math_image_sum_1d<T,T,T >( \
+  const T* pxA, std::ptrdiff_t isA, \
+  const T* pxB, std::ptrdiff_t isB, \
+  T* pxS, std::ptrdiff_t isS, \
+  unsigned len) \
+{ \
+  if (isA==1 && isB==1 && isS==1) \
+    vil_math_simd_sum(pxA, pxB, pxS, len); \
+  else \
+    vil_math_image_sum_1d_generic<T,T,T >(pxA, isA, pxB, isB, pxS, isS, len); \
+}
+VIL_MATH_IMAGE_SUM_1D_SIMD( vxl_byte )
+VIL_MATH_IMAGE_SUM_1D_SIMD( vxl_uint_16 )
+VIL_MATH_IMAGE_SUM_1D_SIMD( float )
+VIL_MATH_IMAGE_SUM_1D_SIMD( double )
+#undef VIL_MATH_IMAGE_SUM_1D_SIMD
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Compute sum of two images (im_sum = imA+imB)
 // \relatesalso vil_image_view
 template<class aT, class bT, class sumT>
@@ -715,13 +835,7 @@ inline void vil_math_image_sum(const vil_image_view<aT>& imA,
     const bT* rowB   = planeB;
     sumT* rowS = planeS;
     for (unsigned j=0;j<nj;++j,rowA += jstepA,rowB += jstepB,rowS += jstepS)
-    {
-      const aT* pixelA = rowA;
-      const bT* pixelB = rowB;
-      sumT* pixelS = rowS;
-      for (unsigned i=0;i<ni;++i,pixelA+=istepA,pixelB+=istepB,pixelS+=istepS)
-        *pixelS = sumT(*pixelA)+sumT(*pixelB);
-    }
+      vil_math_image_sum_1d<aT,bT,sumT>(rowA, istepA, rowB, istepB, rowS, istepS, ni);
   }
 }
 
@@ -882,6 +996,51 @@ inline void vil_math_image_ratio(const vil_image_view<aT>& imA,
   }
 }
 
+//: Compute difference of two 1D images (im_sum = imA-imB)
+template<class aT, class bT, class sumT>
+inline void vil_math_image_difference_1d_generic(
+  const aT* pxA, std::ptrdiff_t isA,
+  const bT* pxB, std::ptrdiff_t isB,
+  sumT* pxS, std::ptrdiff_t isS,
+  unsigned len)
+{
+  for (unsigned i=0;i<len;++i,pxA+=isA,pxB+=isB,pxS+=isS)
+    *pxS = sumT(*pxA)-sumT(*pxB);
+}
+
+//: Compute difference of two 1D images (im_sum = imA-imB)
+// Specialize this function for an optimized implementation
+template<class aT, class bT, class sumT>
+inline void vil_math_image_difference_1d(
+  const aT* pxA, std::ptrdiff_t isA,
+  const bT* pxB, std::ptrdiff_t isB,
+  sumT* pxS, std::ptrdiff_t isS,
+  unsigned len)
+{
+  vil_math_image_difference_1d_generic<aT,bT,sumT>(pxA, isA, pxB, isB, pxS, isS, len);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD( T ) \
+template<> \
+inline void vil_math_image_difference_1d<T,T,T >( \
+  const T* pxA, std::ptrdiff_t isA, \
+  const T* pxB, std::ptrdiff_t isB, \
+  T* pxS, std::ptrdiff_t isS, \
+  unsigned len) \
+{ \
+  if (isA==1 && isB==1 && isS==1) \
+    vil_math_simd_difference(pxA, pxB, pxS, len); \
+  else \
+    vil_math_image_difference_1d_generic<T,T,T >(pxA, isA, pxB, isB, pxS, isS, len); \
+}
+VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD( vxl_byte )
+VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD( vxl_uint_16 )
+VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD( float )
+VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD( double )
+#undef VIL_MATH_IMAGE_DIFFERENCE_1D_SIMD
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Compute difference of two images (im_sum = imA-imB)
 // \relatesalso vil_image_view
 template<class aT, class bT, class sumT>
@@ -905,13 +1064,7 @@ inline void vil_math_image_difference(const vil_image_view<aT>& imA,
     const bT* rowB   = planeB;
     sumT* rowS = planeS;
     for (unsigned j=0;j<nj;++j,rowA += jstepA,rowB += jstepB,rowS += jstepS)
-    {
-      const aT* pixelA = rowA;
-      const bT* pixelB = rowB;
-      sumT* pixelS = rowS;
-      for (unsigned i=0;i<ni;++i,pixelA+=istepA,pixelB+=istepB,pixelS+=istepS)
-        *pixelS = sumT(*pixelA)-sumT(*pixelB);
-    }
+      vil_math_image_difference_1d<aT,bT,sumT>(rowA, istepA, rowB, istepB, rowS, istepS, ni);
   }
 }
 
@@ -947,6 +1100,27 @@ inline void vil_math_image_abs_difference_1d(
 }
 
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD( T ) \
+template<> \
+inline void vil_math_image_abs_difference_1d<T,T,T >( \
+  const T* pxA, vcl_ptrdiff_t isA, \
+  const T* pxB, vcl_ptrdiff_t isB, \
+  T* pxD, vcl_ptrdiff_t isD, \
+  unsigned len) \
+{ \
+  if (isA==1 && isB==1 && isD==1) \
+    vil_math_simd_abs_difference(pxA, pxB, pxD, len); \
+  else \
+    vil_math_image_abs_difference_1d_generic<T,T,T >(pxA, isA, pxB, isB, pxD, isD, len); \
+}
+VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD( vxl_byte )
+VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD( vxl_uint_16 )
+VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD( float )
+VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD( double )
+#undef VIL_MATH_IMAGE_ABS_DIFFERENCE_1D_SIMD
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 //: Compute absolute difference of two images (im_sum = |imA-imB|)
 // \relatesalso vil_image_view
 template<class aT, class bT, class dT>
@@ -1193,9 +1367,4 @@ inline void vil_math_integral_sqr_image(const vil_image_view<aT>& imA,
   }
 }
 
-
-#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
-#include "vil_math_sse.hxx"
-#endif
-
 #endif // vil_math_h_
@@ -0,0 +1,1075 @@
+// This is core/vil/vil_math_simd.cxx
+#include <atomic>
+#include <cstring>
+#include "vil_math_simd.h"
+//:
+// \file
+// \brief Vectorised row loops for pixel-wise vil_math and vil_convert functions
+//
+// For each instruction set, a traits class per pixel type wraps the
+// vector loads, stores and arithmetic, and a few loop templates use them.
+// The linear maps, and casts from double, convert each block of pixels to
+// two vectors of doubles; other casts are exact with vectors of floats.
+// Pixels left over at the end of a row go through the scalar loops.
+// Multiplies and adds are kept separate (this file is compiled
+// without floating point contraction), so every path gives the same
+// result.
+
+#include <vcl_compiler.h>
+#include <vil/vil_config.h> // for VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+#include <emmintrin.h>
+#endif
+
+// AVX2 and AVX-512 code is compiled for that target function by function,
+// and only run if the processor supports it.
+#if defined(VXL_HAS_SSE2_HARDWARE_SUPPORT) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define VIL_MATH_SIMD_AVX2 1
+#define VIL_MATH_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#if defined(__clang__) || __GNUC__ >= 6
+#define VIL_MATH_SIMD_AVX512 1
+#define VIL_MATH_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define VIL_MATH_SIMD_AVX512 0
+#endif
+#elif defined(VXL_HAS_SSE2_HARDWARE_SUPPORT) && defined(_MSC_VER) && _MSC_VER >= 1700 && defined(_M_X64)
+#define VIL_MATH_SIMD_AVX2 1
+#define VIL_MATH_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#if _MSC_VER >= 1910
+#define VIL_MATH_SIMD_AVX512 1
+#define VIL_MATH_TARGET_AVX512
+#else
+#define VIL_MATH_SIMD_AVX512 0
+#endif
+#else
+#define VIL_MATH_SIMD_AVX2 0
+#define VIL_MATH_SIMD_AVX512 0
+#endif
+
+//: Pixel-wise binary operations
+enum vil_math_simd_op { vil_math_simd_op_sum, vil_math_simd_op_difference, vil_math_simd_op_abs_difference };
+
+//=======================================================================
+// Scalar loops, also used for the ends of rows
+//=======================================================================
+
+template <class T>
+static void vil_math_simd_value_range_scalar(const T* p, unsigned n, T& min_value, T& max_value)
+{
+  for (unsigned i=0; i<n; ++i)
+  {
+    const T pixel = p[i];
+    if (pixel<min_value)
+      min_value=pixel;
+    else if (pixel>max_value)
+      max_value=pixel;
+  }
+}
+
+template <int op, class T>
+static void vil_math_simd_binary_scalar(const T* a, const T* b, T* d, unsigned n)
+{
+  for (unsigned i=0; i<n; ++i)
+  {
+    if (op==vil_math_simd_op_sum)
+      d[i] = T(a[i]+b[i]);
+    else if (op==vil_math_simd_op_difference)
+      d[i] = T(a[i]-b[i]);
+    else
+      d[i] = (a[i]>b[i]) ? T(a[i]-b[i]) : T(b[i]-a[i]);
+  }
+}
+
+//: d[i] = outT(scale*(s[i]+pre)+post) if affine, else static_cast<outT>(s[i])
+template <bool affine, class inT, class outT>
+static void vil_math_simd_linear_scalar(const inT* s, outT* d, unsigned n,
+                                        double pre, double scale, double post)
+{
+  for (unsigned i=0; i<n; ++i)
+  {
+    if (affine)
+      d[i] = outT(scale*(double(s[i])+pre)+post);
+    else
+      d[i] = static_cast<outT>(s[i]);
+  }
+}
+
+//: Merge the lanes of vector minima and maxima into [min_value,max_value]
+template <class T>
+static void vil_math_simd_merge_range(const T* mins, const T* maxs, unsigned n,
+                                      T& min_value, T& max_value)
+{
+  for (unsigned k=0; k<n; ++k)
+  {
+    if (mins[k]<min_value) min_value=mins[k];
+    if (maxs[k]>max_value) max_value=maxs[k];
+  }
+}
+
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+//=======================================================================
+// SSE2: 16 bytes per vector
+//=======================================================================
+
+template <class T> struct vil_math_sse2_ops;
+
+// Each traits class provides, for n pixels per vector:
+//   load, store, set1, add, sub, abs_diff,
+//   vmin(x,m), vmax(x,m): which return m where x is NaN,
+//   load_d, store_d: 4 pixels as two vectors of 2 doubles,
+//   load_f, store_f: 8 pixels as two vectors of 4 floats (not for
+//   loading doubles).
+
+template <> struct vil_math_sse2_ops<vxl_byte>
+{
+  typedef __m128i vec;
+  enum { n = 16 };
+  static vec load(const vxl_byte* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static void store(vxl_byte* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static vec set1(vxl_byte v) { return _mm_set1_epi8(char(v)); }
+  static vec add(vec a, vec b) { return _mm_add_epi8(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_epi8(a, b); }
+  static vec abs_diff(vec a, vec b) { return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)); }
+  static vec vmin(vec x, vec m) { return _mm_min_epu8(x, m); }
+  static vec vmax(vec x, vec m) { return _mm_max_epu8(x, m); }
+  static void load_d(const vxl_byte* p, __m128d& lo, __m128d& hi)
+  {
+    int v;
+    std::memcpy(&v, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+    lo = _mm_cvtepi32_pd(x);
+    hi = _mm_cvtepi32_pd(_mm_srli_si128(x, 8));
+  }
+  static void store_d(vxl_byte* p, __m128d lo, __m128d hi)
+  {
+    __m128i x = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+    x = _mm_packs_epi32(x, x);
+    const int v = _mm_cvtsi128_si32(_mm_packus_epi16(x, x));
+    std::memcpy(p, &v, 4);
+  }
+  static void load_f(const vxl_byte* p, __m128& lo, __m128& hi)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+    lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+    hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(x, zero));
+  }
+  static void store_f(vxl_byte* p, __m128 lo, __m128 hi)
+  {
+    __m128i x = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(x, x));
+  }
+};
+
+template <> struct vil_math_sse2_ops<vxl_uint_16>
+{
+  typedef __m128i vec;
+  enum { n = 8 };
+  static vec load(const vxl_uint_16* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static void store(vxl_uint_16* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static vec set1(vxl_uint_16 v) { return _mm_set1_epi16(short(v)); }
+  static vec add(vec a, vec b) { return _mm_add_epi16(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_epi16(a, b); }
+  static vec abs_diff(vec a, vec b) { return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a)); }
+  // SSE2 only has signed 16 bit minima and maxima: flip the sign bits
+  static vec vmin(vec x, vec m)
+  {
+    const __m128i s = _mm_set1_epi16(short(0x8000));
+    return _mm_xor_si128(_mm_min_epi16(_mm_xor_si128(x, s), _mm_xor_si128(m, s)), s);
+  }
+  static vec vmax(vec x, vec m)
+  {
+    const __m128i s = _mm_set1_epi16(short(0x8000));
+    return _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(x, s), _mm_xor_si128(m, s)), s);
+  }
+  static void load_d(const vxl_uint_16* p, __m128d& lo, __m128d& hi)
+  {
+    __m128i x = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)),
+                                   _mm_setzero_si128());
+    lo = _mm_cvtepi32_pd(x);
+    hi = _mm_cvtepi32_pd(_mm_srli_si128(x, 8));
+  }
+  static void store_d(vxl_uint_16* p, __m128d lo, __m128d hi)
+  {
+    // pack with signed saturation around 0x8000
+    const __m128i s32 = _mm_set1_epi32(0x8000);
+    __m128i x = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+    x = _mm_sub_epi32(x, s32);
+    x = _mm_xor_si128(_mm_packs_epi32(x, x), _mm_set1_epi16(short(0x8000)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), x);
+  }
+  static void load_f(const vxl_uint_16* p, __m128& lo, __m128& hi)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+    hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(x, zero));
+  }
+  static void store_f(vxl_uint_16* p, __m128 lo, __m128 hi)
+  {
+    const __m128i s32 = _mm_set1_epi32(0x8000);
+    __m128i x = _mm_packs_epi32(_mm_sub_epi32(_mm_cvttps_epi32(lo), s32),
+                                _mm_sub_epi32(_mm_cvttps_epi32(hi), s32));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_xor_si128(x, _mm_set1_epi16(short(0x8000))));
+  }
+};
+
+template <> struct vil_math_sse2_ops<float>
+{
+  typedef __m128 vec;
+  enum { n = 4 };
+  static vec load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, vec v) { _mm_storeu_ps(p, v); }
+  static vec set1(float v) { return _mm_set1_ps(v); }
+  static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+  static vec abs_diff(vec a, vec b) { return _mm_sub_ps(_mm_max_ps(a, b), _mm_min_ps(a, b)); }
+  static vec vmin(vec x, vec m) { return _mm_min_ps(x, m); }
+  static vec vmax(vec x, vec m) { return _mm_max_ps(x, m); }
+  static void load_d(const float* p, __m128d& lo, __m128d& hi)
+  {
+    __m128 x = _mm_loadu_ps(p);
+    lo = _mm_cvtps_pd(x);
+    hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+  }
+  static void store_d(float* p, __m128d lo, __m128d hi)
+  {
+    _mm_storeu_ps(p, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+  }
+  static void load_f(const float* p, __m128& lo, __m128& hi)
+  {
+    lo = _mm_loadu_ps(p);
+    hi = _mm_loadu_ps(p+4);
+  }
+  static void store_f(float* p, __m128 lo, __m128 hi)
+  {
+    _mm_storeu_ps(p, lo);
+    _mm_storeu_ps(p+4, hi);
+  }
+};
+
+template <> struct vil_math_sse2_ops<double>
+{
+  typedef __m128d vec;
+  enum { n = 2 };
+  static vec load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, vec v) { _mm_storeu_pd(p, v); }
+  static vec set1(double v) { return _mm_set1_pd(v); }
+  static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_pd(a, b); }
+  static vec abs_diff(vec a, vec b) { return _mm_sub_pd(_mm_max_pd(a, b), _mm_min_pd(a, b)); }
+  static vec vmin(vec x, vec m) { return _mm_min_pd(x, m); }
+  static vec vmax(vec x, vec m) { return _mm_max_pd(x, m); }
+  static void load_d(const double* p, __m128d& lo, __m128d& hi)
+  {
+    lo = _mm_loadu_pd(p);
+    hi = _mm_loadu_pd(p+2);
+  }
+  static void store_d(double* p, __m128d lo, __m128d hi)
+  {
+    _mm_storeu_pd(p, lo);
+    _mm_storeu_pd(p+2, hi);
+  }
+  static void store_f(double* p, __m128 lo, __m128 hi)
+  {
+    _mm_storeu_pd(p, _mm_cvtps_pd(lo));
+    _mm_storeu_pd(p+2, _mm_cvtps_pd(_mm_movehl_ps(lo, lo)));
+    _mm_storeu_pd(p+4, _mm_cvtps_pd(hi));
+    _mm_storeu_pd(p+6, _mm_cvtps_pd(_mm_movehl_ps(hi, hi)));
+  }
+};
+
+template <class T>
+static void vil_math_sse2_value_range(const T* p, unsigned n, T& min_value, T& max_value)
+{
+  typedef vil_math_sse2_ops<T> ops;
+  unsigned i = 0;
+  if (n >= unsigned(ops::n))
+  {
+    typename ops::vec vmin = ops::set1(min_value), vmax = ops::set1(max_value);
+    for (; i+ops::n<=n; i+=ops::n)
+    {
+      const typename ops::vec x = ops::load(p+i);
+      vmin = ops::vmin(x, vmin);
+      vmax = ops::vmax(x, vmax);
+    }
+    T mins[ops::n], maxs[ops::n];
+    ops::store(mins, vmin);
+    ops::store(maxs, vmax);
+    vil_math_simd_merge_range(mins, maxs, ops::n, min_value, max_value);
+  }
+  vil_math_simd_value_range_scalar(p+i, n-i, min_value, max_value);
+}
+
+template <int op, class T>
+static void vil_math_sse2_binary(const T* a, const T* b, T* d, unsigned n)
+{
+  typedef vil_math_sse2_ops<T> ops;
+  unsigned i = 0;
+  for (; i+ops::n<=n; i+=ops::n)
+  {
+    const typename ops::vec x = ops::load(a+i), y = ops::load(b+i);
+    ops::store(d+i, op==vil_math_simd_op_sum ? ops::add(x, y) :
+                    op==vil_math_simd_op_difference ? ops::sub(x, y) : ops::abs_diff(x, y));
+  }
+  vil_math_simd_binary_scalar<op>(a+i, b+i, d+i, n-i);
+}
+
+template <bool affine, class inT, class outT>
+static void vil_math_sse2_linear(const inT* s, outT* d, unsigned n,
+                                 double pre, double scale, double post)
+{
+  const __m128d vpre = _mm_set1_pd(pre), vscale = _mm_set1_pd(scale), vpost = _mm_set1_pd(post);
+  unsigned i = 0;
+  for (; i+4<=n; i+=4)
+  {
+    __m128d lo, hi;
+    vil_math_sse2_ops<inT>::load_d(s+i, lo, hi);
+    if (affine)
+    {
+      lo = _mm_add_pd(_mm_mul_pd(vscale, _mm_add_pd(lo, vpre)), vpost);
+      hi = _mm_add_pd(_mm_mul_pd(vscale, _mm_add_pd(hi, vpre)), vpost);
+    }
+    vil_math_sse2_ops<outT>::store_d(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<affine>(s+i, d+i, n-i, pre, scale, post);
+}
+
+//: Cast with float lanes; exact unless inT is double
+template <class inT, class outT>
+static void vil_math_sse2_cast(const inT* s, outT* d, unsigned n)
+{
+  unsigned i = 0;
+  for (; i+8<=n; i+=8)
+  {
+    __m128 lo, hi;
+    vil_math_sse2_ops<inT>::load_f(s+i, lo, hi);
+    vil_math_sse2_ops<outT>::store_f(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<false>(s+i, d+i, n-i, 0.0, 1.0, 0.0);
+}
+
+#endif // VXL_HAS_SSE2_HARDWARE_SUPPORT
+
+#if VIL_MATH_SIMD_AVX2
+
+//=======================================================================
+// AVX2: 32 bytes per vector
+//=======================================================================
+
+template <class T> struct vil_math_avx2_ops;
+
+// As vil_math_sse2_ops, with load_d and store_d for 8 pixels as two
+// vectors of 4 doubles, and load_f and store_f for 16 pixels as two
+// vectors of 8 floats.
+
+template <> struct vil_math_avx2_ops<vxl_byte>
+{
+  typedef __m256i vec;
+  enum { n = 32 };
+  VIL_MATH_TARGET_AVX2 static vec load(const vxl_byte* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  VIL_MATH_TARGET_AVX2 static void store(vxl_byte* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  VIL_MATH_TARGET_AVX2 static vec set1(vxl_byte v) { return _mm256_set1_epi8(char(v)); }
+  VIL_MATH_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi8(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_epi8(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec abs_diff(vec a, vec b) { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+  VIL_MATH_TARGET_AVX2 static vec vmin(vec x, vec m) { return _mm256_min_epu8(x, m); }
+  VIL_MATH_TARGET_AVX2 static vec vmax(vec x, vec m) { return _mm256_max_epu8(x, m); }
+  VIL_MATH_TARGET_AVX2 static void load_d(const vxl_byte* p, __m256d& lo, __m256d& hi)
+  {
+    __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x));
+    hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1));
+  }
+  VIL_MATH_TARGET_AVX2 static void store_d(vxl_byte* p, __m256d lo, __m256d hi)
+  {
+    __m128i x = _mm_packs_epi32(_mm256_cvttpd_epi32(lo), _mm256_cvttpd_epi32(hi));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(x, x));
+  }
+  VIL_MATH_TARGET_AVX2 static void load_f(const vxl_byte* p, __m256& lo, __m256& hi)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x));
+    hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(x, 8)));
+  }
+  VIL_MATH_TARGET_AVX2 static void store_f(vxl_byte* p, __m256 lo, __m256 hi)
+  {
+    __m256i a = _mm256_cvttps_epi32(lo), b = _mm256_cvttps_epi32(hi);
+    __m128i x = _mm_packs_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+    __m128i y = _mm_packs_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(x, y));
+  }
+};
+
+template <> struct vil_math_avx2_ops<vxl_uint_16>
+{
+  typedef __m256i vec;
+  enum { n = 16 };
+  VIL_MATH_TARGET_AVX2 static vec load(const vxl_uint_16* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  VIL_MATH_TARGET_AVX2 static void store(vxl_uint_16* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  VIL_MATH_TARGET_AVX2 static vec set1(vxl_uint_16 v) { return _mm256_set1_epi16(short(v)); }
+  VIL_MATH_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi16(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_epi16(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec abs_diff(vec a, vec b) { return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)); }
+  VIL_MATH_TARGET_AVX2 static vec vmin(vec x, vec m) { return _mm256_min_epu16(x, m); }
+  VIL_MATH_TARGET_AVX2 static vec vmax(vec x, vec m) { return _mm256_max_epu16(x, m); }
+  VIL_MATH_TARGET_AVX2 static void load_d(const vxl_uint_16* p, __m256d& lo, __m256d& hi)
+  {
+    __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x));
+    hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1));
+  }
+  VIL_MATH_TARGET_AVX2 static void store_d(vxl_uint_16* p, __m256d lo, __m256d hi)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                     _mm_packus_epi32(_mm256_cvttpd_epi32(lo), _mm256_cvttpd_epi32(hi)));
+  }
+  VIL_MATH_TARGET_AVX2 static void load_f(const vxl_uint_16* p, __m256& lo, __m256& hi)
+  {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    lo = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(x)));
+    hi = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(x, 1)));
+  }
+  VIL_MATH_TARGET_AVX2 static void store_f(vxl_uint_16* p, __m256 lo, __m256 hi)
+  {
+    __m256i a = _mm256_cvttps_epi32(lo), b = _mm256_cvttps_epi32(hi);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                     _mm_packus_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p+8),
+                     _mm_packus_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)));
+  }
+};
+
+template <> struct vil_math_avx2_ops<float>
+{
+  typedef __m256 vec;
+  enum { n = 8 };
+  VIL_MATH_TARGET_AVX2 static vec load(const float* p) { return _mm256_loadu_ps(p); }
+  VIL_MATH_TARGET_AVX2 static void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+  VIL_MATH_TARGET_AVX2 static vec set1(float v) { return _mm256_set1_ps(v); }
+  VIL_MATH_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec abs_diff(vec a, vec b) { return _mm256_sub_ps(_mm256_max_ps(a, b), _mm256_min_ps(a, b)); }
+  VIL_MATH_TARGET_AVX2 static vec vmin(vec x, vec m) { return _mm256_min_ps(x, m); }
+  VIL_MATH_TARGET_AVX2 static vec vmax(vec x, vec m) { return _mm256_max_ps(x, m); }
+  VIL_MATH_TARGET_AVX2 static void load_d(const float* p, __m256d& lo, __m256d& hi)
+  {
+    __m256 x = _mm256_loadu_ps(p);
+    lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+    hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+  }
+  VIL_MATH_TARGET_AVX2 static void store_d(float* p, __m256d lo, __m256d hi)
+  {
+    _mm_storeu_ps(p, _mm256_cvtpd_ps(lo));
+    _mm_storeu_ps(p+4, _mm256_cvtpd_ps(hi));
+  }
+  VIL_MATH_TARGET_AVX2 static void load_f(const float* p, __m256& lo, __m256& hi)
+  {
+    lo = _mm256_loadu_ps(p);
+    hi = _mm256_loadu_ps(p+8);
+  }
+  VIL_MATH_TARGET_AVX2 static void store_f(float* p, __m256 lo, __m256 hi)
+  {
+    _mm256_storeu_ps(p, lo);
+    _mm256_storeu_ps(p+8, hi);
+  }
+};
+
+template <> struct vil_math_avx2_ops<double>
+{
+  typedef __m256d vec;
+  enum { n = 4 };
+  VIL_MATH_TARGET_AVX2 static vec load(const double* p) { return _mm256_loadu_pd(p); }
+  VIL_MATH_TARGET_AVX2 static void store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+  VIL_MATH_TARGET_AVX2 static vec set1(double v) { return _mm256_set1_pd(v); }
+  VIL_MATH_TARGET_AVX2 static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+  VIL_MATH_TARGET_AVX2 static vec abs_diff(vec a, vec b) { return _mm256_sub_pd(_mm256_max_pd(a, b), _mm256_min_pd(a, b)); }
+  VIL_MATH_TARGET_AVX2 static vec vmin(vec x, vec m) { return _mm256_min_pd(x, m); }
+  VIL_MATH_TARGET_AVX2 static vec vmax(vec x, vec m) { return _mm256_max_pd(x, m); }
+  VIL_MATH_TARGET_AVX2 static void load_d(const double* p, __m256d& lo, __m256d& hi)
+  {
+    lo = _mm256_loadu_pd(p);
+    hi = _mm256_loadu_pd(p+4);
+  }
+  VIL_MATH_TARGET_AVX2 static void store_d(double* p, __m256d lo, __m256d hi)
+  {
+    _mm256_storeu_pd(p, lo);
+    _mm256_storeu_pd(p+4, hi);
+  }
+  VIL_MATH_TARGET_AVX2 static void store_f(double* p, __m256 lo, __m256 hi)
+  {
+    _mm256_storeu_pd(p, _mm256_cvtps_pd(_mm256_castps256_ps128(lo)));
+    _mm256_storeu_pd(p+4, _mm256_cvtps_pd(_mm256_extractf128_ps(lo, 1)));
+    _mm256_storeu_pd(p+8, _mm256_cvtps_pd(_mm256_castps256_ps128(hi)));
+    _mm256_storeu_pd(p+12, _mm256_cvtps_pd(_mm256_extractf128_ps(hi, 1)));
+  }
+};
+
+template <class T>
+VIL_MATH_TARGET_AVX2
+static void vil_math_avx2_value_range(const T* p, unsigned n, T& min_value, T& max_value)
+{
+  typedef vil_math_avx2_ops<T> ops;
+  unsigned i = 0;
+  if (n >= unsigned(ops::n))
+  {
+    typename ops::vec vmin = ops::set1(min_value), vmax = ops::set1(max_value);
+    for (; i+ops::n<=n; i+=ops::n)
+    {
+      const typename ops::vec x = ops::load(p+i);
+      vmin = ops::vmin(x, vmin);
+      vmax = ops::vmax(x, vmax);
+    }
+    T mins[ops::n], maxs[ops::n];
+    ops::store(mins, vmin);
+    ops::store(maxs, vmax);
+    vil_math_simd_merge_range(mins, maxs, ops::n, min_value, max_value);
+  }
+  vil_math_simd_value_range_scalar(p+i, n-i, min_value, max_value);
+}
+
+template <int op, class T>
+VIL_MATH_TARGET_AVX2
+static void vil_math_avx2_binary(const T* a, const T* b, T* d, unsigned n)
+{
+  typedef vil_math_avx2_ops<T> ops;
+  unsigned i = 0;
+  for (; i+ops::n<=n; i+=ops::n)
+  {
+    const typename ops::vec x = ops::load(a+i), y = ops::load(b+i);
+    ops::store(d+i, op==vil_math_simd_op_sum ? ops::add(x, y) :
+                    op==vil_math_simd_op_difference ? ops::sub(x, y) : ops::abs_diff(x, y));
+  }
+  vil_math_simd_binary_scalar<op>(a+i, b+i, d+i, n-i);
+}
+
+template <bool affine, class inT, class outT>
+VIL_MATH_TARGET_AVX2
+static void vil_math_avx2_linear(const inT* s, outT* d, unsigned n,
+                                 double pre, double scale, double post)
+{
+  const __m256d vpre = _mm256_set1_pd(pre), vscale = _mm256_set1_pd(scale),
+                vpost = _mm256_set1_pd(post);
+  unsigned i = 0;
+  for (; i+8<=n; i+=8)
+  {
+    __m256d lo, hi;
+    vil_math_avx2_ops<inT>::load_d(s+i, lo, hi);
+    if (affine)
+    {
+      lo = _mm256_add_pd(_mm256_mul_pd(vscale, _mm256_add_pd(lo, vpre)), vpost);
+      hi = _mm256_add_pd(_mm256_mul_pd(vscale, _mm256_add_pd(hi, vpre)), vpost);
+    }
+    vil_math_avx2_ops<outT>::store_d(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<affine>(s+i, d+i, n-i, pre, scale, post);
+}
+
+template <class inT, class outT>
+VIL_MATH_TARGET_AVX2
+static void vil_math_avx2_cast(const inT* s, outT* d, unsigned n)
+{
+  unsigned i = 0;
+  for (; i+16<=n; i+=16)
+  {
+    __m256 lo, hi;
+    vil_math_avx2_ops<inT>::load_f(s+i, lo, hi);
+    vil_math_avx2_ops<outT>::store_f(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<false>(s+i, d+i, n-i, 0.0, 1.0, 0.0);
+}
+
+#endif // VIL_MATH_SIMD_AVX2
+
+#if VIL_MATH_SIMD_AVX512
+
+//=======================================================================
+// AVX-512: 64 bytes per vector
+//=======================================================================
+
+template <class T> struct vil_math_avx512_ops;
+
+// The unmasked forms of most AVX-512 intrinsics pass an undefined vector
+// as the merge source, which GCC reports as maybe-uninitialized. The
+// zero-masking forms with every lane selected compile to the same
+// instructions without it.
+static const __mmask16 vil_math_all16 = 0xFFFF;
+static const __mmask8 vil_math_all8 = 0xFF;
+static const __mmask8 vil_math_all4 = 0xF;
+
+//: Half k (0 low, 1 high) of a vector.
+// GCC implements _mm512_castsi512_si256() and the like by an unmasked extract.
+template <int k>
+VIL_MATH_TARGET_AVX512 inline __m256i vil_math_avx512_half(__m512i x)
+{ return _mm512_maskz_extracti64x4_epi64(vil_math_all4, x, k); }
+
+template <int k>
+VIL_MATH_TARGET_AVX512 inline __m256 vil_math_avx512_half(__m512 x)
+{ return _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(vil_math_all4, _mm512_castps_pd(x), k)); }
+
+// As vil_math_sse2_ops, with load_d and store_d for 16 pixels as two
+// vectors of 8 doubles, and load_f and store_f for 32 pixels as two
+// vectors of 16 floats. Byte and 16 bit arithmetic needs AVX512BW.
+
+template <> struct vil_math_avx512_ops<vxl_byte>
+{
+  typedef __m512i vec;
+  enum { n = 64 };
+  VIL_MATH_TARGET_AVX512 static vec load(const vxl_byte* p) { return _mm512_loadu_si512(p); }
+  VIL_MATH_TARGET_AVX512 static void store(vxl_byte* p, vec v) { _mm512_storeu_si512(p, v); }
+  VIL_MATH_TARGET_AVX512 static vec set1(vxl_byte v) { return _mm512_set1_epi8(char(v)); }
+  VIL_MATH_TARGET_AVX512 static vec add(vec a, vec b) { return _mm512_add_epi8(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec sub(vec a, vec b) { return _mm512_sub_epi8(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec abs_diff(vec a, vec b) { return _mm512_or_si512(_mm512_subs_epu8(a, b), _mm512_subs_epu8(b, a)); }
+  VIL_MATH_TARGET_AVX512 static vec vmin(vec x, vec m) { return _mm512_min_epu8(x, m); }
+  VIL_MATH_TARGET_AVX512 static vec vmax(vec x, vec m) { return _mm512_max_epu8(x, m); }
+  VIL_MATH_TARGET_AVX512 static void load_d(const vxl_byte* p, __m512d& lo, __m512d& hi)
+  {
+    __m512i x = _mm512_maskz_cvtepu8_epi32(vil_math_all16, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    lo = _mm512_maskz_cvtepi32_pd(vil_math_all8, vil_math_avx512_half<0>(x));
+    hi = _mm512_maskz_cvtepi32_pd(vil_math_all8, vil_math_avx512_half<1>(x));
+  }
+  VIL_MATH_TARGET_AVX512 static void store_d(vxl_byte* p, __m512d lo, __m512d hi)
+  {
+    __m512i x = _mm512_maskz_inserti64x4(vil_math_all8,
+                                         _mm512_castsi256_si512(_mm512_maskz_cvttpd_epi32(vil_math_all8, lo)),
+                                         _mm512_maskz_cvttpd_epi32(vil_math_all8, hi), 1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_maskz_cvtusepi32_epi8(vil_math_all16, x));
+  }
+  VIL_MATH_TARGET_AVX512 static void load_f(const vxl_byte* p, __m512& lo, __m512& hi)
+  {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    lo = _mm512_maskz_cvtepi32_ps(vil_math_all16, _mm512_maskz_cvtepu8_epi32(vil_math_all16, _mm256_castsi256_si128(x)));
+    hi = _mm512_maskz_cvtepi32_ps(vil_math_all16, _mm512_maskz_cvtepu8_epi32(vil_math_all16, _mm256_extracti128_si256(x, 1)));
+  }
+  VIL_MATH_TARGET_AVX512 static void store_f(vxl_byte* p, __m512 lo, __m512 hi)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_maskz_cvtusepi32_epi8(vil_math_all16, _mm512_maskz_cvttps_epi32(vil_math_all16, lo)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p+16), _mm512_maskz_cvtusepi32_epi8(vil_math_all16, _mm512_maskz_cvttps_epi32(vil_math_all16, hi)));
+  }
+};
+
+template <> struct vil_math_avx512_ops<vxl_uint_16>
+{
+  typedef __m512i vec;
+  enum { n = 32 };
+  VIL_MATH_TARGET_AVX512 static vec load(const vxl_uint_16* p) { return _mm512_loadu_si512(p); }
+  VIL_MATH_TARGET_AVX512 static void store(vxl_uint_16* p, vec v) { _mm512_storeu_si512(p, v); }
+  VIL_MATH_TARGET_AVX512 static vec set1(vxl_uint_16 v) { return _mm512_set1_epi16(short(v)); }
+  VIL_MATH_TARGET_AVX512 static vec add(vec a, vec b) { return _mm512_add_epi16(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec sub(vec a, vec b) { return _mm512_sub_epi16(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec abs_diff(vec a, vec b) { return _mm512_or_si512(_mm512_subs_epu16(a, b), _mm512_subs_epu16(b, a)); }
+  VIL_MATH_TARGET_AVX512 static vec vmin(vec x, vec m) { return _mm512_min_epu16(x, m); }
+  VIL_MATH_TARGET_AVX512 static vec vmax(vec x, vec m) { return _mm512_max_epu16(x, m); }
+  VIL_MATH_TARGET_AVX512 static void load_d(const vxl_uint_16* p, __m512d& lo, __m512d& hi)
+  {
+    __m512i x = _mm512_maskz_cvtepu16_epi32(vil_math_all16, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    lo = _mm512_maskz_cvtepi32_pd(vil_math_all8, vil_math_avx512_half<0>(x));
+    hi = _mm512_maskz_cvtepi32_pd(vil_math_all8, vil_math_avx512_half<1>(x));
+  }
+  VIL_MATH_TARGET_AVX512 static void store_d(vxl_uint_16* p, __m512d lo, __m512d hi)
+  {
+    __m512i x = _mm512_maskz_inserti64x4(vil_math_all8,
+                                         _mm512_castsi256_si512(_mm512_maskz_cvttpd_epi32(vil_math_all8, lo)),
+                                         _mm512_maskz_cvttpd_epi32(vil_math_all8, hi), 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_maskz_cvtusepi32_epi16(vil_math_all16, x));
+  }
+  VIL_MATH_TARGET_AVX512 static void load_f(const vxl_uint_16* p, __m512& lo, __m512& hi)
+  {
+    __m512i x = _mm512_loadu_si512(p);
+    lo = _mm512_maskz_cvtepi32_ps(vil_math_all16, _mm512_maskz_cvtepu16_epi32(vil_math_all16, vil_math_avx512_half<0>(x)));
+    hi = _mm512_maskz_cvtepi32_ps(vil_math_all16, _mm512_maskz_cvtepu16_epi32(vil_math_all16, vil_math_avx512_half<1>(x)));
+  }
+  VIL_MATH_TARGET_AVX512 static void store_f(vxl_uint_16* p, __m512 lo, __m512 hi)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_maskz_cvtusepi32_epi16(vil_math_all16, _mm512_maskz_cvttps_epi32(vil_math_all16, lo)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+16), _mm512_maskz_cvtusepi32_epi16(vil_math_all16, _mm512_maskz_cvttps_epi32(vil_math_all16, hi)));
+  }
+};
+
+template <> struct vil_math_avx512_ops<float>
+{
+  typedef __m512 vec;
+  enum { n = 16 };
+  VIL_MATH_TARGET_AVX512 static vec load(const float* p) { return _mm512_loadu_ps(p); }
+  VIL_MATH_TARGET_AVX512 static void store(float* p, vec v) { _mm512_storeu_ps(p, v); }
+  VIL_MATH_TARGET_AVX512 static vec set1(float v) { return _mm512_set1_ps(v); }
+  VIL_MATH_TARGET_AVX512 static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec abs_diff(vec a, vec b) { return _mm512_sub_ps(_mm512_maskz_max_ps(vil_math_all16, a, b), _mm512_maskz_min_ps(vil_math_all16, a, b)); }
+  VIL_MATH_TARGET_AVX512 static vec vmin(vec x, vec m) { return _mm512_maskz_min_ps(vil_math_all16, x, m); }
+  VIL_MATH_TARGET_AVX512 static vec vmax(vec x, vec m) { return _mm512_maskz_max_ps(vil_math_all16, x, m); }
+  VIL_MATH_TARGET_AVX512 static void load_d(const float* p, __m512d& lo, __m512d& hi)
+  {
+    lo = _mm512_maskz_cvtps_pd(vil_math_all8, _mm256_loadu_ps(p));
+    hi = _mm512_maskz_cvtps_pd(vil_math_all8, _mm256_loadu_ps(p+8));
+  }
+  VIL_MATH_TARGET_AVX512 static void store_d(float* p, __m512d lo, __m512d hi)
+  {
+    _mm256_storeu_ps(p, _mm512_maskz_cvtpd_ps(vil_math_all8, lo));
+    _mm256_storeu_ps(p+8, _mm512_maskz_cvtpd_ps(vil_math_all8, hi));
+  }
+  VIL_MATH_TARGET_AVX512 static void load_f(const float* p, __m512& lo, __m512& hi)
+  {
+    lo = _mm512_loadu_ps(p);
+    hi = _mm512_loadu_ps(p+16);
+  }
+  VIL_MATH_TARGET_AVX512 static void store_f(float* p, __m512 lo, __m512 hi)
+  {
+    _mm512_storeu_ps(p, lo);
+    _mm512_storeu_ps(p+16, hi);
+  }
+};
+
+template <> struct vil_math_avx512_ops<double>
+{
+  typedef __m512d vec;
+  enum { n = 8 };
+  VIL_MATH_TARGET_AVX512 static vec load(const double* p) { return _mm512_loadu_pd(p); }
+  VIL_MATH_TARGET_AVX512 static void store(double* p, vec v) { _mm512_storeu_pd(p, v); }
+  VIL_MATH_TARGET_AVX512 static vec set1(double v) { return _mm512_set1_pd(v); }
+  VIL_MATH_TARGET_AVX512 static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec sub(vec a, vec b) { return _mm512_sub_pd(a, b); }
+  VIL_MATH_TARGET_AVX512 static vec abs_diff(vec a, vec b) { return _mm512_sub_pd(_mm512_maskz_max_pd(vil_math_all8, a, b), _mm512_maskz_min_pd(vil_math_all8, a, b)); }
+  VIL_MATH_TARGET_AVX512 static vec vmin(vec x, vec m) { return _mm512_maskz_min_pd(vil_math_all8, x, m); }
+  VIL_MATH_TARGET_AVX512 static vec vmax(vec x, vec m) { return _mm512_maskz_max_pd(vil_math_all8, x, m); }
+  VIL_MATH_TARGET_AVX512 static void load_d(const double* p, __m512d& lo, __m512d& hi)
+  {
+    lo = _mm512_loadu_pd(p);
+    hi = _mm512_loadu_pd(p+8);
+  }
+  VIL_MATH_TARGET_AVX512 static void store_d(double* p, __m512d lo, __m512d hi)
+  {
+    _mm512_storeu_pd(p, lo);
+    _mm512_storeu_pd(p+8, hi);
+  }
+  VIL_MATH_TARGET_AVX512 static void store_f(double* p, __m512 lo, __m512 hi)
+  {
+    _mm512_storeu_pd(p, _mm512_maskz_cvtps_pd(vil_math_all8, vil_math_avx512_half<0>(lo)));
+    _mm512_storeu_pd(p+8, _mm512_maskz_cvtps_pd(vil_math_all8, vil_math_avx512_half<1>(lo)));
+    _mm512_storeu_pd(p+16, _mm512_maskz_cvtps_pd(vil_math_all8, vil_math_avx512_half<0>(hi)));
+    _mm512_storeu_pd(p+24, _mm512_maskz_cvtps_pd(vil_math_all8, vil_math_avx512_half<1>(hi)));
+  }
+};
+
+template <class T>
+VIL_MATH_TARGET_AVX512
+static void vil_math_avx512_value_range(const T* p, unsigned n, T& min_value, T& max_value)
+{
+  typedef vil_math_avx512_ops<T> ops;
+  unsigned i = 0;
+  if (n >= unsigned(ops::n))
+  {
+    typename ops::vec vmin = ops::set1(min_value), vmax = ops::set1(max_value);
+    for (; i+ops::n<=n; i+=ops::n)
+    {
+      const typename ops::vec x = ops::load(p+i);
+      vmin = ops::vmin(x, vmin);
+      vmax = ops::vmax(x, vmax);
+    }
+    T mins[ops::n], maxs[ops::n];
+    ops::store(mins, vmin);
+    ops::store(maxs, vmax);
+    vil_math_simd_merge_range(mins, maxs, ops::n, min_value, max_value);
+  }
+  vil_math_simd_value_range_scalar(p+i, n-i, min_value, max_value);
+}
+
+template <int op, class T>
+VIL_MATH_TARGET_AVX512
+static void vil_math_avx512_binary(const T* a, const T* b, T* d, unsigned n)
+{
+  typedef vil_math_avx512_ops<T> ops;
+  unsigned i = 0;
+  for (; i+ops::n<=n; i+=ops::n)
+  {
+    const typename ops::vec x = ops::load(a+i), y = ops::load(b+i);
+    ops::store(d+i, op==vil_math_simd_op_sum ? ops::add(x, y) :
+                    op==vil_math_simd_op_difference ? ops::sub(x, y) : ops::abs_diff(x, y));
+  }
+  vil_math_simd_binary_scalar<op>(a+i, b+i, d+i, n-i);
+}
+
+template <bool affine, class inT, class outT>
+VIL_MATH_TARGET_AVX512
+static void vil_math_avx512_linear(const inT* s, outT* d, unsigned n,
+                                   double pre, double scale, double post)
+{
+  const __m512d vpre = _mm512_set1_pd(pre), vscale = _mm512_set1_pd(scale),
+                vpost = _mm512_set1_pd(post);
+  unsigned i = 0;
+  for (; i+16<=n; i+=16)
+  {
+    __m512d lo, hi;
+    vil_math_avx512_ops<inT>::load_d(s+i, lo, hi);
+    if (affine)
+    {
+      lo = _mm512_add_pd(_mm512_mul_pd(vscale, _mm512_add_pd(lo, vpre)), vpost);
+      hi = _mm512_add_pd(_mm512_mul_pd(vscale, _mm512_add_pd(hi, vpre)), vpost);
+    }
+    vil_math_avx512_ops<outT>::store_d(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<affine>(s+i, d+i, n-i, pre, scale, post);
+}
+
+template <class inT, class outT>
+VIL_MATH_TARGET_AVX512
+static void vil_math_avx512_cast(const inT* s, outT* d, unsigned n)
+{
+  unsigned i = 0;
+  for (; i+32<=n; i+=32)
+  {
+    __m512 lo, hi;
+    vil_math_avx512_ops<inT>::load_f(s+i, lo, hi);
+    vil_math_avx512_ops<outT>::store_f(d+i, lo, hi);
+  }
+  vil_math_simd_linear_scalar<false>(s+i, d+i, n-i, 0.0, 1.0, 0.0);
+}
+
+#endif // VIL_MATH_SIMD_AVX512
+
+//=======================================================================
+// Dispatch
+//=======================================================================
+
+#if VIL_MATH_SIMD_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+//: Extended features (cpuid leaf 7, ebx) if the OS saves the registers in \p xcr0_mask
+static int vil_math_simd_cpu_features7(unsigned long long xcr0_mask)
+{
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return 0;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1<<27)) != 0, avx = (info[2] & (1<<28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & xcr0_mask) != xcr0_mask)
+    return 0;
+  __cpuidex(info, 7, 0);
+  return info[1];
+}
+#endif
+
+static bool vil_math_simd_cpu_has_avx2()
+{
+#if VIL_MATH_SIMD_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+  return (vil_math_simd_cpu_features7(0x6) & (1<<5)) != 0;
+#elif VIL_MATH_SIMD_AVX2
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#else
+  return false;
+#endif
+}
+
+static bool vil_math_simd_cpu_has_avx512()
+{
+#if VIL_MATH_SIMD_AVX512 && defined(_MSC_VER) && !defined(__clang__)
+  // avx512f and avx512bw, with the opmask and zmm registers saved
+  const int f = vil_math_simd_cpu_features7(0xe6);
+  return (f & (1<<16)) != 0 && (f & (1<<30)) != 0;
+#elif VIL_MATH_SIMD_AVX512
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512bw") != 0;
+#else
+  return false;
+#endif
+}
+
+vil_math_simd_level vil_math_simd_best_level()
+{
+  static const vil_math_simd_level best =
+    vil_math_simd_cpu_has_avx512() ? vil_math_simd_avx512 :
+    vil_math_simd_cpu_has_avx2() ? vil_math_simd_avx2 :
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+    vil_math_simd_sse2;
+#else
+    vil_math_simd_none;
+#endif
+  return best;
+}
+
+//: Currently selected level, or -1 before the first use
+static std::atomic<int> vil_math_simd_current_level(-1);
+
+vil_math_simd_level vil_math_simd_get_level()
+{
+  int level = vil_math_simd_current_level.load(std::memory_order_relaxed);
+  if (level < 0)
+  {
+    level = vil_math_simd_best_level();
+    vil_math_simd_current_level.store(level, std::memory_order_relaxed);
+  }
+  return vil_math_simd_level(level);
+}
+
+vil_math_simd_level vil_math_simd_set_level(vil_math_simd_level level)
+{
+  if (level > vil_math_simd_best_level())
+    level = vil_math_simd_best_level();
+  vil_math_simd_current_level.store(level, std::memory_order_relaxed);
+  return level;
+}
+
+template <class T>
+static void vil_math_simd_value_range_dispatch(const T* p, unsigned n, T& min_value, T& max_value)
+{
+  switch (vil_math_simd_get_level())
+  {
+#if VIL_MATH_SIMD_AVX512
+   case vil_math_simd_avx512:
+    vil_math_avx512_value_range(p, n, min_value, max_value);
+    return;
+#endif
+#if VIL_MATH_SIMD_AVX2
+   case vil_math_simd_avx2:
+    vil_math_avx2_value_range(p, n, min_value, max_value);
+    return;
+#endif
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+   case vil_math_simd_sse2:
+    vil_math_sse2_value_range(p, n, min_value, max_value);
+    return;
+#endif
+   default:
+    vil_math_simd_value_range_scalar(p, n, min_value, max_value);
+    return;
+  }
+}
+
+template <int op, class T>
+static void vil_math_simd_binary_dispatch(const T* a, const T* b, T* d, unsigned n)
+{
+  switch (vil_math_simd_get_level())
+  {
+#if VIL_MATH_SIMD_AVX512
+   case vil_math_simd_avx512:
+    vil_math_avx512_binary<op>(a, b, d, n);
+    return;
+#endif
+#if VIL_MATH_SIMD_AVX2
+   case vil_math_simd_avx2:
+    vil_math_avx2_binary<op>(a, b, d, n);
+    return;
+#endif
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+   case vil_math_simd_sse2:
+    vil_math_sse2_binary<op>(a, b, d, n);
+    return;
+#endif
+   default:
+    vil_math_simd_binary_scalar<op>(a, b, d, n);
+    return;
+  }
+}
+
+template <bool affine, class inT, class outT>
+static void vil_math_simd_linear_dispatch(const inT* s, outT* d, unsigned n,
+                                          double pre, double scale, double post)
+{
+  switch (vil_math_simd_get_level())
+  {
+#if VIL_MATH_SIMD_AVX512
+   case vil_math_simd_avx512:
+    vil_math_avx512_linear<affine>(s, d, n, pre, scale, post);
+    return;
+#endif
+#if VIL_MATH_SIMD_AVX2
+   case vil_math_simd_avx2:
+    vil_math_avx2_linear<affine>(s, d, n, pre, scale, post);
+    return;
+#endif
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+   case vil_math_simd_sse2:
+    vil_math_sse2_linear<affine>(s, d, n, pre, scale, post);
+    return;
+#endif
+   default:
+    vil_math_simd_linear_scalar<affine>(s, d, n, pre, scale, post);
+    return;
+  }
+}
+
+//: Cast a row of vxl_byte, vxl_uint_16 or float pixels, exactly, with float lanes
+template <class inT, class outT>
+static void vil_math_simd_cast_dispatch(const inT* s, outT* d, unsigned n)
+{
+  switch (vil_math_simd_get_level())
+  {
+#if VIL_MATH_SIMD_AVX512
+   case vil_math_simd_avx512:
+    vil_math_avx512_cast(s, d, n);
+    return;
+#endif
+#if VIL_MATH_SIMD_AVX2
+   case vil_math_simd_avx2:
+    vil_math_avx2_cast(s, d, n);
+    return;
+#endif
+#ifdef VXL_HAS_SSE2_HARDWARE_SUPPORT
+   case vil_math_simd_sse2:
+    vil_math_sse2_cast(s, d, n);
+    return;
+#endif
+   default:
+    vil_math_simd_linear_scalar<false>(s, d, n, 0.0, 1.0, 0.0);
+    return;
+  }
+}
+
+#define VIL_MATH_SIMD_INSTANTIATE_ROW_OPS( T ) \
+void vil_math_simd_value_range(const T* row, unsigned n, T& min_value, T& max_value) \
+{ vil_math_simd_value_range_dispatch(row, n, min_value, max_value); } \
+void vil_math_simd_sum(const T* a, const T* b, T* d, unsigned n) \
+{ vil_math_simd_binary_dispatch<vil_math_simd_op_sum>(a, b, d, n); } \
+void vil_math_simd_difference(const T* a, const T* b, T* d, unsigned n) \
+{ vil_math_simd_binary_dispatch<vil_math_simd_op_difference>(a, b, d, n); } \
+void vil_math_simd_abs_difference(const T* a, const T* b, T* d, unsigned n) \
+{ vil_math_simd_binary_dispatch<vil_math_simd_op_abs_difference>(a, b, d, n); }
+
+VIL_MATH_SIMD_INSTANTIATE_ROW_OPS( vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_ROW_OPS( vxl_uint_16 )
+VIL_MATH_SIMD_INSTANTIATE_ROW_OPS( float )
+VIL_MATH_SIMD_INSTANTIATE_ROW_OPS( double )
+#undef VIL_MATH_SIMD_INSTANTIATE_ROW_OPS
+
+#define VIL_MATH_SIMD_INSTANTIATE_LINEAR( inT , outT ) \
+void vil_math_simd_linear(const inT* s, outT* d, unsigned n, \
+                          double pre_offset, double scale, double post_offset) \
+{ vil_math_simd_linear_dispatch<true>(s, d, n, pre_offset, scale, post_offset); }
+#define VIL_MATH_SIMD_INSTANTIATE_CAST( inT , outT ) \
+void vil_math_simd_cast(const inT* s, outT* d, unsigned n) \
+{ vil_math_simd_cast_dispatch(s, d, n); }
+// doubles are converted through double lanes instead
+#define VIL_MATH_SIMD_INSTANTIATE_CAST_D( outT ) \
+void vil_math_simd_cast(const double* s, outT* d, unsigned n) \
+{ vil_math_simd_linear_dispatch<false>(s, d, n, 0.0, 1.0, 0.0); }
+
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( vxl_byte , vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( vxl_uint_16 , vxl_uint_16 )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( float , float )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( double , double )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( vxl_uint_16 , vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( float , vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_LINEAR( double , vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_CAST( vxl_byte , vxl_uint_16 )
+VIL_MATH_SIMD_INSTANTIATE_CAST( vxl_byte , float )
+VIL_MATH_SIMD_INSTANTIATE_CAST( vxl_byte , double )
+VIL_MATH_SIMD_INSTANTIATE_CAST( vxl_uint_16 , float )
+VIL_MATH_SIMD_INSTANTIATE_CAST( vxl_uint_16 , double )
+VIL_MATH_SIMD_INSTANTIATE_CAST( float , vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_CAST( float , vxl_uint_16 )
+VIL_MATH_SIMD_INSTANTIATE_CAST( float , double )
+VIL_MATH_SIMD_INSTANTIATE_CAST_D( vxl_byte )
+VIL_MATH_SIMD_INSTANTIATE_CAST_D( vxl_uint_16 )
+VIL_MATH_SIMD_INSTANTIATE_CAST_D( float )
+#undef VIL_MATH_SIMD_INSTANTIATE_LINEAR
+#undef VIL_MATH_SIMD_INSTANTIATE_CAST
+#undef VIL_MATH_SIMD_INSTANTIATE_CAST_D
@@ -0,0 +1,118 @@
+// This is core/vil/vil_math_simd.h
+#ifndef vil_math_simd_h_
+#define vil_math_simd_h_
+//:
+// \file
+// \brief Vectorised row loops for pixel-wise vil_math and vil_convert functions
+//
+// vil_math_value_range(), vil_math_image_sum(), vil_math_image_difference(),
+// vil_math_image_abs_difference(), vil_math_scale_and_offset_values(),
+// vil_convert_cast() and vil_convert_stretch_range() use these for rows of
+// vxl_byte, vxl_uint_16, float and double pixels that are contiguous in
+// memory. The instruction set (SSE2, AVX2 or AVX-512) is chosen at run
+// time from what the processor supports, so a portable build still uses
+// the widest vectors available. vil_math_simd_set_level() can lower it,
+// e.g. to compare against the plain loops.
+//
+// Every level gives the same result as the scalar loop it replaces:
+// integer sums and differences wrap around, and the linear maps are
+// computed in double, with a multiply and an add that are never fused,
+// then truncated towards zero when stored as an integer. Results which
+// are out of the range of an integer destination type are undefined, as
+// they are for the scalar loops.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include <vxl_config.h> // for vxl_byte
+
+//: Instruction sets available to the vil_math_simd row loops
+enum vil_math_simd_level
+{
+  //: Use plain scalar loops
+  vil_math_simd_none = 0,
+  vil_math_simd_sse2,
+  vil_math_simd_avx2,
+  vil_math_simd_avx512
+};
+
+//: Most capable instruction set supported by this processor and build
+vil_math_simd_level vil_math_simd_best_level();
+
+//: Instruction set currently used by the vil_math_simd row loops
+// Initially vil_math_simd_best_level().
+vil_math_simd_level vil_math_simd_get_level();
+
+//: Set the instruction set used by the vil_math_simd row loops
+// Levels above vil_math_simd_best_level() are reduced to it.
+// Returns the level actually selected.
+vil_math_simd_level vil_math_simd_set_level(vil_math_simd_level level);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_SIMD_DECLARE_ROW_OPS( T ) \
+void vil_math_simd_value_range(const T* row, unsigned n, T& min_value, T& max_value); \
+void vil_math_simd_sum(const T* a, const T* b, T* d, unsigned n); \
+void vil_math_simd_difference(const T* a, const T* b, T* d, unsigned n); \
+void vil_math_simd_abs_difference(const T* a, const T* b, T* d, unsigned n)
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+//: Update [min_value,max_value] to include row[0..n-1]
+// Pixels are compared as in vil_math_value_range(), so NaNs are ignored
+// unless min_value and max_value are already NaN.
+void vil_math_simd_value_range(const vxl_byte* row, unsigned n,
+                               vxl_byte& min_value, vxl_byte& max_value);
+
+//: d[i] = a[i]+b[i] for i in [0,n)
+void vil_math_simd_sum(const vxl_byte* a, const vxl_byte* b, vxl_byte* d, unsigned n);
+
+//: d[i] = a[i]-b[i] for i in [0,n)
+void vil_math_simd_difference(const vxl_byte* a, const vxl_byte* b, vxl_byte* d, unsigned n);
+
+//: d[i] = |a[i]-b[i]| for i in [0,n)
+void vil_math_simd_abs_difference(const vxl_byte* a, const vxl_byte* b, vxl_byte* d, unsigned n);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+VIL_MATH_SIMD_DECLARE_ROW_OPS( vxl_uint_16 );
+VIL_MATH_SIMD_DECLARE_ROW_OPS( float );
+VIL_MATH_SIMD_DECLARE_ROW_OPS( double );
+#undef VIL_MATH_SIMD_DECLARE_ROW_OPS
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+//: d[i] = outT(scale*(s[i]+pre_offset)+post_offset) for i in [0,n)
+// Computed in double. s and d may be the same row.
+void vil_math_simd_linear(const vxl_byte* s, vxl_byte* d, unsigned n,
+                          double pre_offset, double scale, double post_offset);
+
+//: d[i] = static_cast<outT>(s[i]) for i in [0,n)
+void vil_math_simd_cast(const vxl_byte* s, float* d, unsigned n);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define VIL_MATH_SIMD_DECLARE_LINEAR( inT , outT ) \
+void vil_math_simd_linear(const inT* s, outT* d, unsigned n, \
+                          double pre_offset, double scale, double post_offset)
+#define VIL_MATH_SIMD_DECLARE_CAST( inT , outT ) \
+void vil_math_simd_cast(const inT* s, outT* d, unsigned n)
+VIL_MATH_SIMD_DECLARE_LINEAR( vxl_uint_16 , vxl_uint_16 );
+VIL_MATH_SIMD_DECLARE_LINEAR( float , float );
+VIL_MATH_SIMD_DECLARE_LINEAR( double , double );
+VIL_MATH_SIMD_DECLARE_LINEAR( vxl_uint_16 , vxl_byte );
+VIL_MATH_SIMD_DECLARE_LINEAR( float , vxl_byte );
+VIL_MATH_SIMD_DECLARE_LINEAR( double , vxl_byte );
+VIL_MATH_SIMD_DECLARE_CAST( vxl_byte , vxl_uint_16 );
+VIL_MATH_SIMD_DECLARE_CAST( vxl_byte , double );
+VIL_MATH_SIMD_DECLARE_CAST( vxl_uint_16 , float );
+VIL_MATH_SIMD_DECLARE_CAST( vxl_uint_16 , double );
+VIL_MATH_SIMD_DECLARE_CAST( float , vxl_byte );
+VIL_MATH_SIMD_DECLARE_CAST( float , vxl_uint_16 );
+VIL_MATH_SIMD_DECLARE_CAST( float , double );
+VIL_MATH_SIMD_DECLARE_CAST( double , vxl_byte );
+VIL_MATH_SIMD_DECLARE_CAST( double , vxl_uint_16 );
+VIL_MATH_SIMD_DECLARE_CAST( double , float );
+#undef VIL_MATH_SIMD_DECLARE_LINEAR
+#undef VIL_MATH_SIMD_DECLARE_CAST
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif // vil_math_simd_h_
@@ -0,0 +1,80 @@
+// This is core/vil/vil_memory_allocator.cxx
+#include <atomic>
+#include <cstddef>
+#include "vil_memory_allocator.h"
+//:
+// \file
+#include <vcl_compiler.h>
+
+namespace
+{
+  //: new[] and delete[], counting the bytes in use
+  class vil_heap_memory_allocator : public vil_memory_allocator
+  {
+   public:
+    vil_heap_memory_allocator()
+      : n_allocations_(0), n_deallocations_(0), bytes_in_use_(0), peak_bytes_(0) {}
+
+    void* allocate(std::size_t n)
+    {
+      char* p = new char[n];
+      ++n_allocations_;
+      std::size_t in_use = bytes_in_use_ += n;
+      std::size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+      while (in_use>peak && !peak_bytes_.compare_exchange_weak(peak, in_use))
+        ;
+      return p;
+    }
+
+    void deallocate(void* p, std::size_t n)
+    {
+      if (!p) return;
+      ++n_deallocations_;
+      bytes_in_use_ -= n;
+      delete [] static_cast<char*>(p);
+    }
+
+    // new[] guarantees alignment suitable for any fundamental type
+    std::size_t alignment() const { return alignof(std::max_align_t); }
+
+    vil_memory_allocator_stats stats() const
+    {
+      vil_memory_allocator_stats s;
+      s.n_allocations = s.n_system_allocations = n_allocations_;
+      s.n_deallocations = s.n_system_deallocations = n_deallocations_;
+      s.bytes_in_use = bytes_in_use_;
+      s.peak_bytes_in_use = peak_bytes_;
+      return s;
+    }
+
+   private:
+    std::atomic<unsigned long> n_allocations_;
+    std::atomic<unsigned long> n_deallocations_;
+    std::atomic<std::size_t> bytes_in_use_;
+    std::atomic<std::size_t> peak_bytes_;
+  };
+
+  std::atomic<vil_memory_allocator*>& vil_default_memory_allocator()
+  {
+    static std::atomic<vil_memory_allocator*> a(vil_memory_allocator::heap());
+    return a;
+  }
+}
+
+vil_memory_allocator* vil_memory_allocator::heap()
+{
+  // Never deleted, so that images in static objects can still be freed
+  // during program exit.
+  static vil_memory_allocator* a = new vil_heap_memory_allocator;
+  return a;
+}
+
+vil_memory_allocator* vil_memory_allocator::default_allocator()
+{
+  return vil_default_memory_allocator().load();
+}
+
+vil_memory_allocator* vil_memory_allocator::set_default_allocator(vil_memory_allocator* a)
+{
+  return vil_default_memory_allocator().exchange(a ? a : heap());
+}
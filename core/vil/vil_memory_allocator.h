@@ -0,0 +1,84 @@
+// This is core/vil/vil_memory_allocator.h
+#ifndef vil_memory_allocator_h_
+#define vil_memory_allocator_h_
+//:
+// \file
+// \brief Source of the memory held by vil_memory_chunk
+//
+// Every vil_memory_chunk obtains its data from a vil_memory_allocator
+// and returns it to the same allocator when it is freed or resized.
+// Chunks constructed without an explicit allocator use
+// vil_memory_allocator::default_allocator(), which is initially heap(),
+// a plain new[]/delete[] allocator. A program can change the default,
+// e.g. to vil_pooled_memory_allocator::instance(), so that every image
+// created by vil_image_view::set_size() or the vil_new_image_view_*()
+// functions is drawn from a pool.
+//
+// An allocator must outlive every chunk allocated from it.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vcl_compiler.h>
+
+//: Counters describing the use of a vil_memory_allocator
+struct vil_memory_allocator_stats
+{
+  vil_memory_allocator_stats()
+    : n_allocations(0), n_deallocations(0), n_reused(0),
+      n_system_allocations(0), n_system_deallocations(0),
+      bytes_in_use(0), peak_bytes_in_use(0), bytes_cached(0) {}
+
+  //: Number of calls to allocate()
+  unsigned long n_allocations;
+  //: Number of calls to deallocate()
+  unsigned long n_deallocations;
+  //: Number of allocations satisfied from previously freed memory
+  unsigned long n_reused;
+  //: Number of blocks requested from the operating system
+  unsigned long n_system_allocations;
+  //: Number of blocks returned to the operating system
+  unsigned long n_system_deallocations;
+  //: Bytes currently handed out, as requested by the callers
+  std::size_t bytes_in_use;
+  //: Largest value reached by bytes_in_use
+  std::size_t peak_bytes_in_use;
+  //: Bytes of freed blocks kept for reuse
+  std::size_t bytes_cached;
+};
+
+//: Source of the memory held by vil_memory_chunk
+class vil_memory_allocator
+{
+ public:
+  virtual ~vil_memory_allocator() {}
+
+  //: Return a block of at least \p n bytes. \p n may be zero.
+  virtual void* allocate(std::size_t n) = 0;
+
+  //: Release a block returned by allocate(n)
+  // \p n must be the size that was passed to allocate(). p may be null.
+  virtual void deallocate(void* p, std::size_t n) = 0;
+
+  //: Alignment in bytes guaranteed for every block returned by allocate()
+  virtual std::size_t alignment() const = 0;
+
+  //: Current values of the usage counters
+  virtual vil_memory_allocator_stats stats() const = 0;
+
+  //: Allocator using new[] and delete[], shared by the whole program
+  static vil_memory_allocator* heap();
+
+  //: Allocator used by vil_memory_chunk when none is given
+  static vil_memory_allocator* default_allocator();
+
+  //: Set the allocator used by vil_memory_chunk when none is given.
+  // A null pointer restores heap(). Returns the previous default.
+  // Chunks already allocated keep the allocator they were created with.
+  static vil_memory_allocator* set_default_allocator(vil_memory_allocator* a);
+};
+
+#endif // vil_memory_allocator_h_
@@ -10,28 +10,44 @@
 
 //: Dflt ctor
 vil_memory_chunk::vil_memory_chunk()
-: data_(VXL_NULLPTR), size_(0), pixel_format_(VIL_PIXEL_FORMAT_UNKNOWN), ref_count_(0)
+: data_(VXL_NULLPTR), size_(0), pixel_format_(VIL_PIXEL_FORMAT_UNKNOWN), ref_count_(0),
+  allocator_(vil_memory_allocator::default_allocator())
 {
 }
 
 //: Allocate n bytes of memory
 vil_memory_chunk::vil_memory_chunk(std::size_t n, vil_pixel_format pixel_form)
-: data_(new char[n]), size_(n), pixel_format_(pixel_form), ref_count_(0)
+: data_(VXL_NULLPTR), size_(n), pixel_format_(pixel_form), ref_count_(0),
+  allocator_(vil_memory_allocator::default_allocator())
 {
   assert(vil_pixel_format_num_components(pixel_form)==1
          || pixel_form==VIL_PIXEL_FORMAT_UNKNOWN );
+  data_ = allocator_->allocate(n);
+}
+
+//: Allocate n bytes of memory from allocator
+vil_memory_chunk::vil_memory_chunk(std::size_t n, vil_pixel_format pixel_form,
+                                   vil_memory_allocator* allocator)
+: data_(VXL_NULLPTR), size_(n), pixel_format_(pixel_form), ref_count_(0),
+  allocator_(allocator ? allocator : vil_memory_allocator::default_allocator())
+{
+  assert(vil_pixel_format_num_components(pixel_form)==1
+         || pixel_form==VIL_PIXEL_FORMAT_UNKNOWN );
+  data_ = allocator_->allocate(n);
 }
 
 //: Destructor
 vil_memory_chunk::~vil_memory_chunk()
 {
-  delete [] reinterpret_cast<char*>(data_);
+  allocator_->deallocate(data_, size_);
 }
 
 //: Copy ctor
 vil_memory_chunk::vil_memory_chunk(const vil_memory_chunk& d)
-: data_(new char[d.size()]), size_(d.size()), pixel_format_(d.pixel_format_), ref_count_(0)
+: data_(VXL_NULLPTR), size_(d.size()), pixel_format_(d.pixel_format_), ref_count_(0),
+  allocator_(d.allocator_)
 {
+  data_ = allocator_->allocate(size_);
   std::memcpy(data_,d.data_,size_);
 }
 
@@ -52,11 +68,10 @@ void vil_memory_chunk::unref()
   // Note: refcount decrement and zero comparison need to happen in the same
   // statement for this to be thread safe.  Otherwise a race condition can
   // lead to multiple smart pointers deleting the memory.
+  // The destructor releases the data, so that derived classes which
+  // do not own their data can prevent that.
   if (--ref_count_==0)
-  {
-    delete [] reinterpret_cast<char*>(data_); data_=VXL_NULLPTR;
     delete this;
-  }
 }
 
 //: Pointer to first element of data
@@ -70,10 +85,11 @@ void* vil_memory_chunk::const_data() const { return data_;}
 void vil_memory_chunk::set_size(unsigned long n, vil_pixel_format pixel_form)
 {
   if (size_==n) return;
-  delete [] reinterpret_cast<char*>(data_);
+  allocator_->deallocate(data_, size_);
   data_ = VXL_NULLPTR;
+  size_ = 0;
   if (n>0)
-    data_ = new char[n];
+    data_ = allocator_->allocate(n);
   size_ = n;
   pixel_format_ = pixel_form;
 }
@@ -5,12 +5,16 @@
 //  \file
 //  \brief Ref. counted block of data on the heap
 //  \author Tim Cootes
+//
+//  The data is obtained from a vil_memory_allocator, by default
+//  vil_memory_allocator::default_allocator().
 
 #include <cstddef>
 #include <vcl_atomic_count.h>
 #include <vcl_compiler.h>
 #include <vil/vil_smart_ptr.h>
 #include <vil/vil_pixel_format.h>
+#include <vil/vil_memory_allocator.h>
 
 //: Ref. counted block of data on the heap.
 //  Image data block used by vil_image_view<T>.
@@ -30,6 +34,9 @@ class vil_memory_chunk
     //: Reference count
     vcl_atomic_count ref_count_;
 
+    //: Source of data_, to which it is returned
+    vil_memory_allocator* allocator_;
+
  public:
     //: Dflt ctor
     vil_memory_chunk();
@@ -39,6 +46,12 @@ class vil_memory_chunk
     // and should always be a scalar type.
     vil_memory_chunk(std::size_t n, vil_pixel_format pixel_format);
 
+    //: Allocate n bytes of memory from \p allocator
+    // A null allocator means vil_memory_allocator::default_allocator().
+    // The allocator must outlive the chunk.
+    vil_memory_chunk(std::size_t n, vil_pixel_format pixel_format,
+                     vil_memory_allocator* allocator);
+
     //: Copy ctor
     vil_memory_chunk(const vil_memory_chunk&);
 
@@ -69,6 +82,9 @@ class vil_memory_chunk
     //: Number of bytes allocated
     std::size_t size() const { return size_; }
 
+    //: Allocator from which the data was obtained
+    vil_memory_allocator* allocator() const { return allocator_; }
+
     //: Create space for n bytes
     //  pixel_format indicates what format to be used for binary IO
     virtual void set_size(unsigned long n, vil_pixel_format pixel_format);
@@ -210,6 +210,13 @@ vil_new_cached_image_resource(const vil_blocked_image_resource_sptr& bir,
   return new vil_cached_image_resource(bir, cache_size);
 }
 
+vil_blocked_image_resource_sptr
+vil_new_cached_image_resource(const vil_blocked_image_resource_sptr& bir,
+                              vil_concurrent_block_cache_sptr const& cache)
+{
+  return new vil_cached_image_resource(bir, cache);
+}
+
 vil_pyramid_image_resource_sptr
 vil_new_pyramid_image_resource(char const* file_or_directory,
                                char const* file_format)
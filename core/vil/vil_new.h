@@ -118,6 +118,11 @@ vil_blocked_image_resource_sptr
 vil_new_cached_image_resource(const vil_blocked_image_resource_sptr& bir,
                               const unsigned cache_size = 100);
 
+//: Make a new cached resource whose blocks are held in a (possibly shared) cache
+vil_blocked_image_resource_sptr
+vil_new_cached_image_resource(const vil_blocked_image_resource_sptr& bir,
+                              vil_concurrent_block_cache_sptr const& cache);
+
 
 //: Make a new pyramid image resource for writing.
 //  Any number of pyramid layers can be inserted and with any scale.
@@ -177,26 +182,34 @@ vil_image_view<T> vil_new_image_view_j_i_plane(unsigned ni, unsigned nj, unsigne
 //: Create a new image view whose j_step is 1.
 //  Pixel data type is the type of the last (dummy) argument.
 //  i_step will be nj, planestep will be ni x nj.
+//  The memory comes from \p allocator, or if that is null from
+//  vil_memory_allocator::default_allocator().
 //  \relatesalso vil_image_view
 template <class T>
-vil_image_view<T> vil_new_image_view_plane_i_j(unsigned ni, unsigned nj, unsigned nplanes, T /*dummy*/)
+vil_image_view<T> vil_new_image_view_plane_i_j(unsigned ni, unsigned nj, unsigned nplanes, T /*dummy*/,
+                                               vil_memory_allocator* allocator = VXL_NULLPTR)
 {
   vil_pixel_format fmt = vil_pixel_format_of(T());
   vil_memory_chunk_sptr chunk = new vil_memory_chunk(ni*nj*nplanes*sizeof(T),
-                                                     vil_pixel_format_component_format(fmt));
+                                                     vil_pixel_format_component_format(fmt),
+                                                     allocator);
   return vil_image_view<T>(chunk, reinterpret_cast<T*>(chunk->data()), ni, nj, nplanes, nj, 1, nj*ni);
 }
 
 //: Create a new image view whose plane step is 1 and whose j_step is nplanes.
 //  Pixel data type is the type of the last (dummy) argument.
 //  i_step will be nplanes x nj.
+//  The memory comes from \p allocator, or if that is null from
+//  vil_memory_allocator::default_allocator().
 //  \relatesalso vil_image_view
 template <class T>
-vil_image_view<T> vil_new_image_view_i_j_plane(unsigned ni, unsigned nj, unsigned nplanes, T /*dummy*/)
+vil_image_view<T> vil_new_image_view_i_j_plane(unsigned ni, unsigned nj, unsigned nplanes, T /*dummy*/,
+                                               vil_memory_allocator* allocator = VXL_NULLPTR)
 {
   vil_pixel_format fmt = vil_pixel_format_of(T());
   vil_memory_chunk_sptr chunk = new vil_memory_chunk(ni*nj*nplanes*sizeof(T),
-                                                     vil_pixel_format_component_format(fmt));
+                                                     vil_pixel_format_component_format(fmt),
+                                                     allocator);
   return vil_image_view<T>(chunk, reinterpret_cast<T*>(chunk->data()), ni, nj, nplanes, nplanes*nj, nplanes, 1);
 }
 
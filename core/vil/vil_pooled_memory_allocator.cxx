@@ -0,0 +1,421 @@
+// This is core/vil/vil_pooled_memory_allocator.cxx
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "vil_pooled_memory_allocator.h"
+//:
+// \file
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vxl_config.h>
+#if VXL_HAS_ALIGNED_MALLOC || VXL_HAS_MINGW_ALIGNED_MALLOC
+# include <malloc.h>
+#endif
+#if defined(__linux__)
+# include <sys/mman.h>
+#endif
+
+namespace
+{
+  const std::size_t vil_pool_alignment = 64;
+  const std::size_t vil_pool_huge_page = 2u<<20;
+
+  // Requests of more than 2^vil_pool_max_log2 bytes are not pooled
+  const unsigned vil_pool_max_log2 = 30;
+
+  // Class 0 holds requests of up to 64 bytes, then there are four
+  // classes per power of two, ending at 2^vil_pool_max_log2.
+  const unsigned vil_pool_n_classes = 1 + 4*(vil_pool_max_log2-6);
+
+  //: Size class for a request of \p n bytes, or vil_pool_n_classes if not pooled
+  unsigned vil_pool_class(std::size_t n)
+  {
+    if (n<=vil_pool_alignment) return 0;
+    if (n>(std::size_t(1)<<vil_pool_max_log2)) return vil_pool_n_classes;
+    // 2^(k-1) <= m < 2^k, and the top three bits of m pick the class
+    std::size_t m = n-1;
+    unsigned k = 0;
+    while (m>>k) ++k;
+    return 1 + 4*(k-7) + unsigned(m>>(k-3)) - 4;
+  }
+
+  //: Size of the blocks in class \p c
+  std::size_t vil_pool_class_bytes(unsigned c)
+  {
+    if (c==0) return vil_pool_alignment;
+    unsigned k = (c-1)/4 + 7;
+    return std::size_t((c-1)%4 + 5) << (k-3);
+  }
+
+  //: Size of an unpooled block for a request of \p n bytes
+  std::size_t vil_pool_round_up(std::size_t n)
+  {
+    return (n+vil_pool_alignment-1) & ~(vil_pool_alignment-1);
+  }
+
+  void vil_pool_update_peak(std::atomic<std::size_t>& peak, std::size_t v)
+  {
+    std::size_t p = peak.load(std::memory_order_relaxed);
+    while (v>p && !peak.compare_exchange_weak(p, v))
+      ;
+  }
+}
+
+struct vil_pooled_memory_allocator::state
+{
+  state(std::size_t max_cached_bytes, bool use_huge_pages)
+    : free_(vil_pool_n_classes), shared_bytes_(0),
+      max_cached_bytes_(max_cached_bytes), use_huge_pages_(use_huge_pages),
+      closed_(false), n_allocations_(0), n_deallocations_(0), n_reused_(0),
+      n_system_allocations_(0), n_system_deallocations_(0),
+      bytes_in_use_(0), peak_bytes_(0), bytes_cached_(0) {}
+
+  //: Get a new block from the operating system
+  void* system_allocate(std::size_t n);
+
+  //: Return a block to the operating system
+  void system_free(void* p);
+
+  //: Keep a block of class \p c in the shared pool, or free it if the pool is full.
+  // \p counted is true if the block is already included in bytes_cached_.
+  void give_back(void* p, unsigned c, bool counted);
+
+  //: Free blocks from the shared pool, largest first, until it holds at most \p n bytes
+  void trim(std::size_t n);
+
+  //: Shared pool of free blocks, indexed by class
+  std::vector<std::vector<void*> > free_;
+  //: Bytes in free_
+  std::size_t shared_bytes_;
+  std::mutex mutex_;
+
+  std::atomic<std::size_t> max_cached_bytes_;
+  std::atomic<bool> use_huge_pages_;
+  //: Set when the allocator is destroyed. Blocks given back are then freed.
+  std::atomic<bool> closed_;
+
+  std::atomic<unsigned long> n_allocations_;
+  std::atomic<unsigned long> n_deallocations_;
+  std::atomic<unsigned long> n_reused_;
+  std::atomic<unsigned long> n_system_allocations_;
+  std::atomic<unsigned long> n_system_deallocations_;
+  std::atomic<std::size_t> bytes_in_use_;
+  std::atomic<std::size_t> peak_bytes_;
+  //: Bytes in the shared pool and all the threads' free lists
+  std::atomic<std::size_t> bytes_cached_;
+};
+
+void* vil_pooled_memory_allocator::state::system_allocate(std::size_t n)
+{
+  std::size_t align = vil_pool_alignment;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (use_huge_pages_ && n>=vil_pool_huge_page)
+    align = vil_pool_huge_page;
+#endif
+  void* p;
+#if VXL_HAS_ALIGNED_MALLOC
+  p = _aligned_malloc(n, align);
+#elif VXL_HAS_MINGW_ALIGNED_MALLOC
+  p = __mingw_aligned_malloc(n, align);
+#else
+  if (posix_memalign(&p, align, n)!=0)
+    p = VXL_NULLPTR;
+#endif
+  if (!p)
+    throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Only a hint: if the kernel declines, the block uses normal pages
+  if (align==vil_pool_huge_page)
+    madvise(p, n, MADV_HUGEPAGE);
+#endif
+  ++n_system_allocations_;
+  return p;
+}
+
+void vil_pooled_memory_allocator::state::system_free(void* p)
+{
+  ++n_system_deallocations_;
+#if VXL_HAS_ALIGNED_MALLOC
+  _aligned_free(p);
+#elif VXL_HAS_MINGW_ALIGNED_MALLOC
+  __mingw_aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+void vil_pooled_memory_allocator::state::give_back(void* p, unsigned c, bool counted)
+{
+  const std::size_t bytes = vil_pool_class_bytes(c);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!closed_ && shared_bytes_+bytes<=max_cached_bytes_)
+    {
+      free_[c].push_back(p);
+      shared_bytes_ += bytes;
+      if (!counted) bytes_cached_ += bytes;
+      return;
+    }
+  }
+  if (counted) bytes_cached_ -= bytes;
+  system_free(p);
+}
+
+void vil_pooled_memory_allocator::state::trim(std::size_t n)
+{
+  std::vector<void*> to_free;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (unsigned c = vil_pool_n_classes; c-->0 && shared_bytes_>n; )
+    {
+      const std::size_t bytes = vil_pool_class_bytes(c);
+      while (!free_[c].empty() && shared_bytes_>n)
+      {
+        to_free.push_back(free_[c].back());
+        free_[c].pop_back();
+        shared_bytes_ -= bytes;
+        bytes_cached_ -= bytes;
+      }
+    }
+  }
+  for (unsigned i = 0; i<to_free.size(); ++i)
+    system_free(to_free[i]);
+}
+
+namespace
+{
+  typedef std::shared_ptr<vil_pooled_memory_allocator::state> vil_pool_state_sptr;
+
+  //: The free lists of one thread, one set per allocator it has used
+  class vil_pool_thread_lists
+  {
+   public:
+    struct entry
+    {
+      vil_pool_state_sptr state_;
+      std::vector<std::vector<void*> > free_;
+      //: Bytes in free_
+      std::size_t bytes_;
+    };
+
+    vil_pool_thread_lists();
+
+    //: Give every block back to its allocator
+    ~vil_pool_thread_lists();
+
+    //: The lists for blocks of allocator \p s
+    entry& lists_for(vil_pool_state_sptr const& s);
+
+    //: Give every block in \p e back to its allocator's shared pool
+    static void flush(entry& e);
+
+   private:
+    std::vector<entry> entries_;
+  };
+
+  // Life cycle of this thread's vil_pool_thread_lists: 0 before it is
+  // constructed, 1 while it exists, 2 once it has been destroyed. Being
+  // trivially destructible, this can still be read while other
+  // thread-local objects free their images at thread exit.
+  thread_local int vil_pool_thread_lists_status = 0;
+
+  thread_local vil_pool_thread_lists vil_pool_this_thread_lists;
+
+  vil_pool_thread_lists::vil_pool_thread_lists()
+  {
+    vil_pool_thread_lists_status = 1;
+  }
+
+  vil_pool_thread_lists::~vil_pool_thread_lists()
+  {
+    for (unsigned i = 0; i<entries_.size(); ++i)
+      flush(entries_[i]);
+    vil_pool_thread_lists_status = 2;
+  }
+
+  vil_pool_thread_lists::entry& vil_pool_thread_lists::lists_for(vil_pool_state_sptr const& s)
+  {
+    for (unsigned i = 0; i<entries_.size(); ++i)
+      if (entries_[i].state_==s)
+        return entries_[i];
+
+    // First use of this allocator by this thread: also drop the lists
+    // of any allocators destroyed since.
+    for (unsigned i = 0; i<entries_.size(); )
+      if (entries_[i].state_->closed_)
+      {
+        flush(entries_[i]);
+        entries_.erase(entries_.begin()+i);
+      }
+      else
+        ++i;
+
+    entries_.push_back(entry());
+    entries_.back().state_ = s;
+    entries_.back().free_.resize(vil_pool_n_classes);
+    entries_.back().bytes_ = 0;
+    return entries_.back();
+  }
+
+  void vil_pool_thread_lists::flush(entry& e)
+  {
+    for (unsigned c = 0; c<e.free_.size(); ++c)
+    {
+      for (unsigned i = 0; i<e.free_[c].size(); ++i)
+        e.state_->give_back(e.free_[c][i], c, true);
+      e.free_[c].clear();
+    }
+    e.bytes_ = 0;
+  }
+
+  //: This thread's lists for \p s, or null if the thread is exiting
+  vil_pool_thread_lists::entry* vil_pool_thread_lists_for(vil_pool_state_sptr const& s)
+  {
+    if (vil_pool_thread_lists_status==2)
+      return VXL_NULLPTR;
+    return &vil_pool_this_thread_lists.lists_for(s);
+  }
+}
+
+vil_pooled_memory_allocator::vil_pooled_memory_allocator(std::size_t max_cached_bytes,
+                                                         bool use_huge_pages)
+  : state_(new state(max_cached_bytes, use_huge_pages))
+{
+}
+
+vil_pooled_memory_allocator::~vil_pooled_memory_allocator()
+{
+  state_->closed_ = true;
+  release_cached_memory();
+}
+
+void* vil_pooled_memory_allocator::allocate(std::size_t n)
+{
+  state& s = *state_;
+  const unsigned c = vil_pool_class(n);
+  void* p = VXL_NULLPTR;
+  if (c==vil_pool_n_classes)
+    p = s.system_allocate(vil_pool_round_up(n));
+  else
+  {
+    const std::size_t bytes = vil_pool_class_bytes(c);
+    if (bytes<=thread_cache_max_block())
+    {
+      vil_pool_thread_lists::entry* e = vil_pool_thread_lists_for(state_);
+      if (e && !e->free_[c].empty())
+      {
+        p = e->free_[c].back();
+        e->free_[c].pop_back();
+        e->bytes_ -= bytes;
+      }
+    }
+    if (!p)
+    {
+      std::lock_guard<std::mutex> lock(s.mutex_);
+      if (!s.free_[c].empty())
+      {
+        p = s.free_[c].back();
+        s.free_[c].pop_back();
+        s.shared_bytes_ -= bytes;
+      }
+    }
+    if (p)
+    {
+      s.bytes_cached_ -= bytes;
+      ++s.n_reused_;
+    }
+    else
+      p = s.system_allocate(bytes);
+  }
+
+  ++s.n_allocations_;
+  vil_pool_update_peak(s.peak_bytes_, s.bytes_in_use_ += n);
+  return p;
+}
+
+void vil_pooled_memory_allocator::deallocate(void* p, std::size_t n)
+{
+  if (!p) return;
+  state& s = *state_;
+  ++s.n_deallocations_;
+  s.bytes_in_use_ -= n;
+
+  const unsigned c = vil_pool_class(n);
+  if (c==vil_pool_n_classes)
+  {
+    s.system_free(p);
+    return;
+  }
+  const std::size_t bytes = vil_pool_class_bytes(c);
+  if (bytes<=thread_cache_max_block())
+  {
+    vil_pool_thread_lists::entry* e = vil_pool_thread_lists_for(state_);
+    if (e && e->bytes_+bytes<=thread_cache_max_bytes())
+    {
+      e->free_[c].push_back(p);
+      e->bytes_ += bytes;
+      s.bytes_cached_ += bytes;
+      return;
+    }
+  }
+  s.give_back(p, c, false);
+}
+
+vil_memory_allocator_stats vil_pooled_memory_allocator::stats() const
+{
+  vil_memory_allocator_stats st;
+  st.n_allocations = state_->n_allocations_;
+  st.n_deallocations = state_->n_deallocations_;
+  st.n_reused = state_->n_reused_;
+  st.n_system_allocations = state_->n_system_allocations_;
+  st.n_system_deallocations = state_->n_system_deallocations_;
+  st.bytes_in_use = state_->bytes_in_use_;
+  st.peak_bytes_in_use = state_->peak_bytes_;
+  st.bytes_cached = state_->bytes_cached_;
+  return st;
+}
+
+std::size_t vil_pooled_memory_allocator::max_cached_bytes() const
+{
+  return state_->max_cached_bytes_;
+}
+
+void vil_pooled_memory_allocator::set_max_cached_bytes(std::size_t n)
+{
+  state_->max_cached_bytes_ = n;
+  state_->trim(n);
+}
+
+bool vil_pooled_memory_allocator::use_huge_pages() const
+{
+  return state_->use_huge_pages_;
+}
+
+void vil_pooled_memory_allocator::set_use_huge_pages(bool v)
+{
+  state_->use_huge_pages_ = v;
+}
+
+void vil_pooled_memory_allocator::release_cached_memory()
+{
+  vil_pool_thread_lists::entry* e = vil_pool_thread_lists_for(state_);
+  if (e)
+    vil_pool_thread_lists::flush(*e);
+  state_->trim(0);
+}
+
+std::size_t vil_pooled_memory_allocator::size_class_bytes(std::size_t n)
+{
+  const unsigned c = vil_pool_class(n);
+  return c==vil_pool_n_classes ? vil_pool_round_up(n) : vil_pool_class_bytes(c);
+}
+
+vil_pooled_memory_allocator* vil_pooled_memory_allocator::instance()
+{
+  // Never deleted, so that images in static objects can still be freed
+  // during program exit.
+  static vil_pooled_memory_allocator* a = new vil_pooled_memory_allocator;
+  return a;
+}
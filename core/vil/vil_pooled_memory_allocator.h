@@ -0,0 +1,106 @@
+// This is core/vil/vil_pooled_memory_allocator.h
+#ifndef vil_pooled_memory_allocator_h_
+#define vil_pooled_memory_allocator_h_
+//:
+// \file
+// \brief A vil_memory_allocator that keeps freed blocks for reuse
+//
+// Requests are rounded up to one of a set of size classes, four per
+// power of two, so no more than a quarter of a block is wasted. Freed
+// blocks are kept on a free list for their class and handed out again
+// by later requests of the same class, so a program that creates images
+// of the same shapes frame after frame stops allocating once it has
+// reached a steady state. Every block is aligned to 64 bytes, a cache
+// line, which suits aligned SIMD loads of any width up to AVX-512.
+//
+// Blocks of up to thread_cache_max_block() bytes are first returned to
+// a small free list private to the freeing thread, which later requests
+// from that thread use without taking a lock. Larger blocks, and blocks
+// that do not fit in the thread's list, go to a shared pool guarded by
+// a mutex. The shared pool holds at most max_cached_bytes(); beyond
+// that, freed blocks go back to the operating system.
+//
+// Where the platform supports it (Linux transparent huge pages), blocks
+// of 2MB or more can be aligned to and backed by huge pages, reducing
+// TLB misses when large images are traversed.
+//
+// To draw all image memory from a pool:
+// \code
+//   vil_memory_allocator::set_default_allocator(vil_pooled_memory_allocator::instance());
+// \endcode
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <memory>
+#include <vcl_compiler.h>
+#include <vil/vil_memory_allocator.h>
+
+class vil_pooled_memory_allocator : public vil_memory_allocator
+{
+ public:
+  //: Construct, keeping up to \p max_cached_bytes of freed memory in the shared pool
+  explicit vil_pooled_memory_allocator(std::size_t max_cached_bytes = 256u<<20,
+                                       bool use_huge_pages = false);
+
+  //: Free all cached blocks.
+  // Every block allocated from this object must have been freed first.
+  ~vil_pooled_memory_allocator();
+
+  //: Return a 64-byte aligned block of at least \p n bytes
+  void* allocate(std::size_t n);
+
+  //: Release a block returned by allocate(n), keeping it for reuse if possible
+  void deallocate(void* p, std::size_t n);
+
+  //: Alignment of every block, 64 bytes
+  std::size_t alignment() const { return 64; }
+
+  //: Current values of the usage counters
+  vil_memory_allocator_stats stats() const;
+
+  //: Maximum number of bytes kept in the shared pool
+  std::size_t max_cached_bytes() const;
+
+  //: Set the maximum number of bytes kept in the shared pool.
+  // Excess blocks are freed immediately.
+  void set_max_cached_bytes(std::size_t n);
+
+  //: True if blocks of 2MB or more are backed by huge pages where possible
+  bool use_huge_pages() const;
+
+  //: Back blocks of 2MB or more allocated from now on by huge pages where possible
+  void set_use_huge_pages(bool v);
+
+  //: Free the blocks in the shared pool and the calling thread's free list.
+  // Blocks cached by other threads are freed when those threads exit or
+  // next use this allocator.
+  void release_cached_memory();
+
+  //: Size of the block used for a request of \p n bytes
+  static std::size_t size_class_bytes(std::size_t n);
+
+  //: Largest block kept in a thread's private free list
+  static std::size_t thread_cache_max_block() { return 1u<<20; }
+
+  //: Largest number of bytes kept in each thread's private free list
+  static std::size_t thread_cache_max_bytes() { return 4u<<20; }
+
+  //: A pool shared by the whole program, which is never destroyed
+  static vil_pooled_memory_allocator* instance();
+
+  //: Free lists and counters, shared with the per-thread free lists
+  struct state;
+
+ private:
+  std::shared_ptr<state> state_;
+
+  // not copyable
+  vil_pooled_memory_allocator(vil_pooled_memory_allocator const&);
+  vil_pooled_memory_allocator& operator=(vil_pooled_memory_allocator const&);
+};
+
+#endif // vil_pooled_memory_allocator_h_
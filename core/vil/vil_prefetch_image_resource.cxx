@@ -0,0 +1,216 @@
+// This is core/vil/vil_prefetch_image_resource.cxx
+#include "vil_prefetch_image_resource.h"
+//:
+// \file
+#include <algorithm>
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vil/vil_thread_pool.h>
+
+vil_prefetch_image_resource::
+vil_prefetch_image_resource(vil_blocked_image_resource_sptr const& bir,
+                            std::vector<block_index> const& order,
+                            unsigned n_in_flight)
+  : birs_(1, bir), order_(order), n_in_flight_(n_in_flight),
+    next_submit_(0), cancelled_(false), pool_(VXL_NULLPTR)
+{
+  start(1);
+}
+
+vil_prefetch_image_resource::
+vil_prefetch_image_resource(std::vector<vil_blocked_image_resource_sptr> const& birs,
+                            std::vector<block_index> const& order,
+                            unsigned n_in_flight)
+  : birs_(birs), order_(order), n_in_flight_(n_in_flight),
+    next_submit_(0), cancelled_(false), pool_(VXL_NULLPTR)
+{
+  assert(!birs_.empty());
+  start(static_cast<unsigned>(birs_.size()));
+}
+
+void vil_prefetch_image_resource::start(unsigned n_threads)
+{
+  if (n_in_flight_==0)
+    n_in_flight_ = 1;
+  for (unsigned r = 0; r<birs_.size(); ++r)
+    free_birs_.push_back(r);
+  pool_ = new vil_thread_pool(n_threads);
+  std::lock_guard<std::mutex> lock(mutex_);
+  fill_window();
+}
+
+vil_prefetch_image_resource::~vil_prefetch_image_resource()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+  }
+  // queued reads see cancelled_ and return at once; running ones complete
+  delete pool_;
+}
+
+void vil_prefetch_image_resource::fill_window() const
+{
+  while (window_.size()<n_in_flight_ && next_submit_<order_.size())
+  {
+    slot_sptr s(new slot(order_[next_submit_++]));
+    window_.push_back(s);
+    pool_->submit([this, s]() { this->read_slot(s); });
+  }
+}
+
+void vil_prefetch_image_resource::read_slot(slot_sptr const& s) const
+{
+  vil_image_view_base_sptr blk;
+  bool cancelled;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled = cancelled_ || s->skipped_;
+  }
+  if (!cancelled)
+    blk = read_block(s->index_.first, s->index_.second);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    s->blk_ = blk;
+    s->ready_ = true;
+  }
+  slot_ready_.notify_all();
+}
+
+vil_image_view_base_sptr
+vil_prefetch_image_resource::read_block(unsigned block_index_i,
+                                        unsigned block_index_j) const
+{
+  unsigned r;
+  {
+    std::unique_lock<std::mutex> lock(birs_mutex_);
+    while (free_birs_.empty())
+      bir_free_.wait(lock);
+    r = free_birs_.back();
+    free_birs_.pop_back();
+  }
+  vil_image_view_base_sptr blk = birs_[r]->get_block(block_index_i, block_index_j);
+  {
+    std::lock_guard<std::mutex> lock(birs_mutex_);
+    free_birs_.push_back(r);
+  }
+  bir_free_.notify_one();
+  return blk;
+}
+
+vil_image_view_base_sptr
+vil_prefetch_image_resource::take_slot(std::size_t k,
+                                       std::unique_lock<std::mutex>& lock) const
+{
+  // any planned blocks before this one are skipped; cancel those not yet read
+  for (std::size_t p = 0; p<k; ++p)
+    window_[p]->skipped_ = true;
+  slot_sptr s = window_[k];
+  window_.erase(window_.begin(), window_.begin()+k);
+  while (!s->ready_)
+    slot_ready_.wait(lock);
+  std::deque<slot_sptr>::iterator it = std::find(window_.begin(), window_.end(), s);
+  if (it!=window_.end())
+    window_.erase(it);
+  fill_window();
+  return s->blk_;
+}
+
+vil_image_view_base_sptr
+vil_prefetch_image_resource::get_block(unsigned block_index_i,
+                                       unsigned block_index_j) const
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (std::size_t k = 0; k<window_.size(); ++k)
+      if (window_[k]->index_.first==block_index_i &&
+          window_[k]->index_.second==block_index_j)
+        return take_slot(k, lock);
+  }
+  // not planned, or not yet reached
+  return read_block(block_index_i, block_index_j);
+}
+
+bool vil_prefetch_image_resource::next_block(unsigned& block_index_i,
+                                             unsigned& block_index_j,
+                                             vil_image_view_base_sptr& blk)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (window_.empty())
+    return false;
+  block_index_i = window_.front()->index_.first;
+  block_index_j = window_.front()->index_.second;
+  blk = take_slot(0, lock);
+  return true;
+}
+
+std::size_t vil_prefetch_image_resource::n_remaining() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return window_.size() + (order_.size()-next_submit_);
+}
+
+std::vector<vil_prefetch_image_resource::block_index>
+vil_prefetch_image_resource::raster_order(unsigned n_block_i, unsigned n_block_j)
+{
+  std::vector<block_index> order;
+  order.reserve(std::size_t(n_block_i)*n_block_j);
+  for (unsigned bj = 0; bj<n_block_j; ++bj)
+    for (unsigned bi = 0; bi<n_block_i; ++bi)
+      order.push_back(block_index(bi, bj));
+  return order;
+}
+
+std::vector<vil_prefetch_image_resource::block_index>
+vil_prefetch_image_resource::hilbert_order(unsigned n_block_i, unsigned n_block_j)
+{
+  std::vector<block_index> order;
+  order.reserve(std::size_t(n_block_i)*n_block_j);
+  // walk the curve over the enclosing power-of-two square,
+  // keeping the points that fall inside the block grid
+  std::size_t n = 1;
+  while (n<n_block_i || n<n_block_j)
+    n *= 2;
+  for (std::size_t d = 0; d<n*n; ++d)
+  {
+    std::size_t x = 0, y = 0, t = d;
+    for (std::size_t s = 1; s<n; s *= 2)
+    {
+      std::size_t rx = 1 & (t/2);
+      std::size_t ry = 1 & (t ^ rx);
+      if (ry==0)
+      {
+        if (rx==1)
+        {
+          x = s-1-x;
+          y = s-1-y;
+        }
+        std::size_t tmp = x; x = y; y = tmp;
+      }
+      x += s*rx;
+      y += s*ry;
+      t /= 4;
+    }
+    if (x<n_block_i && y<n_block_j)
+      order.push_back(block_index(unsigned(x), unsigned(y)));
+  }
+  return order;
+}
+
+void vil_prefetch_image_resource::
+append_roi_order(vil_blocked_image_resource const& bir,
+                 unsigned i0, unsigned n_i, unsigned j0, unsigned n_j,
+                 std::vector<block_index>& order)
+{
+  unsigned tw = bir.size_block_i(), tl = bir.size_block_j();
+  if (tw==0 || tl==0 || n_i==0 || n_j==0)
+    return;
+  unsigned bi_start = i0/tw, bi_end = (i0+n_i-1)/tw;
+  unsigned bj_start = j0/tl, bj_end = (j0+n_j-1)/tl;
+  if (bi_end>=bir.n_block_i()) bi_end = bir.n_block_i()-1;
+  if (bj_end>=bir.n_block_j()) bj_end = bir.n_block_j()-1;
+  // vil_blocked_image_resource::get_blocks() runs over j fastest
+  for (unsigned bi = bi_start; bi<=bi_end; ++bi)
+    for (unsigned bj = bj_start; bj<=bj_end; ++bj)
+      order.push_back(block_index(bi, bj));
+}
@@ -0,0 +1,167 @@
+// This is core/vil/vil_prefetch_image_resource.h
+#ifndef vil_prefetch_image_resource_h_
+#define vil_prefetch_image_resource_h_
+//:
+// \file
+// \brief A blocked resource that reads ahead along a planned block order
+//
+// The resource is given the order in which blocks will be requested,
+// for example a raster scan, the blocks covering a list of regions, or
+// a Hilbert curve. Up to n_in_flight upcoming blocks are read and
+// decoded on worker threads while the caller works on the current one.
+//
+// Blocks may be consumed either with next_block(), which hands them back
+// in planned order, or with get_block()/get_copy_view(). A requested block
+// that is in the read-ahead window is taken from it, and any planned blocks
+// before it in the window are discarded; those whose reads have not yet
+// started are not read at all. A request for a block outside the window
+// is read synchronously and does not disturb the plan.
+//
+// File-backed resources are generally not safe to read from several
+// threads at once. Reads through a single underlying resource are
+// therefore made by one worker, which still overlaps I/O and decoding
+// with the caller's processing. To decode in parallel, supply several
+// resources opened on the same image; each worker then uses its own.
+//
+// The resource is read-only; put_view() and put_block() return false.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vil/vil_blocked_image_resource.h>
+
+class vil_thread_pool;
+
+class vil_prefetch_image_resource : public vil_blocked_image_resource
+{
+ public:
+  //: A block position, (block_index_i, block_index_j)
+  typedef std::pair<unsigned, unsigned> block_index;
+
+  //: Read ahead along \p order using a single worker thread
+  vil_prefetch_image_resource(vil_blocked_image_resource_sptr const& bir,
+                              std::vector<block_index> const& order,
+                              unsigned n_in_flight = 8);
+
+  //: Read ahead along \p order with one worker thread per resource.
+  // All resources must represent the same image, and must be safe to
+  // read concurrently with each other.
+  vil_prefetch_image_resource(std::vector<vil_blocked_image_resource_sptr> const& birs,
+                              std::vector<block_index> const& order,
+                              unsigned n_in_flight = 8);
+
+  //: Abandons any outstanding reads
+  virtual ~vil_prefetch_image_resource();
+
+  virtual unsigned nplanes() const { return birs_[0]->nplanes(); }
+  virtual unsigned ni() const { return birs_[0]->ni(); }
+  virtual unsigned nj() const { return birs_[0]->nj(); }
+  virtual unsigned size_block_i() const { return birs_[0]->size_block_i(); }
+  virtual unsigned size_block_j() const { return birs_[0]->size_block_j(); }
+  virtual unsigned n_block_i() const { return birs_[0]->n_block_i(); }
+  virtual unsigned n_block_j() const { return birs_[0]->n_block_j(); }
+  virtual enum vil_pixel_format pixel_format() const
+    { return birs_[0]->pixel_format(); }
+
+  //: Block access, from the read-ahead window when possible
+  virtual vil_image_view_base_sptr get_block(unsigned block_index_i,
+                                             unsigned block_index_j) const;
+
+  //: The next block in planned order.
+  // Returns false only when the plan is exhausted. If the block could not
+  // be read, returns true with a null \p blk, so the caller can tell a
+  // failed block from the end of the plan and carry on with the next one.
+  bool next_block(unsigned& block_index_i, unsigned& block_index_j,
+                  vil_image_view_base_sptr& blk);
+
+  //: Number of planned blocks not yet consumed or skipped
+  std::size_t n_remaining() const;
+
+  //: Maximum number of blocks read ahead
+  unsigned n_in_flight() const { return n_in_flight_; }
+
+  //: Not supported - returns false
+  virtual bool put_view(const vil_image_view_base& /*im*/,
+                        unsigned /*i0*/, unsigned /*j0*/) { return false; }
+
+  //: Not supported - returns false
+  virtual bool put_block(unsigned /*block_index_i*/, unsigned /*block_index_j*/,
+                         const vil_image_view_base& /*view*/) { return false; }
+
+  virtual bool get_property(char const* tag, void* property_value = VXL_NULLPTR) const
+    { return birs_[0]->get_property(tag, property_value); }
+
+  //: All blocks in raster order, i.e. block_index_i varying fastest
+  static std::vector<block_index> raster_order(unsigned n_block_i, unsigned n_block_j);
+
+  //: All blocks along a Hilbert curve, keeping successive blocks adjacent
+  static std::vector<block_index> hilbert_order(unsigned n_block_i, unsigned n_block_j);
+
+  //: Append the blocks covering a region to \p order.
+  // Blocks are appended in the order get_copy_view() requests them.
+  static void append_roi_order(vil_blocked_image_resource const& bir,
+                               unsigned i0, unsigned n_i,
+                               unsigned j0, unsigned n_j,
+                               std::vector<block_index>& order);
+
+ private:
+  //: A block in the read-ahead window
+  struct slot
+  {
+    slot(block_index const& b) : index_(b), ready_(false), skipped_(false) {}
+    block_index index_;
+    bool ready_;
+    //: Set when the block is discarded before it has been read
+    bool skipped_;
+    vil_image_view_base_sptr blk_;
+  };
+  typedef std::shared_ptr<slot> slot_sptr;
+
+  void start(unsigned n_threads);
+
+  //: Submit planned blocks until the window is full. Caller holds mutex_.
+  void fill_window() const;
+
+  //: Read a block on a worker thread
+  void read_slot(slot_sptr const& s) const;
+
+  //: Read a block with any free resource
+  vil_image_view_base_sptr read_block(unsigned block_index_i,
+                                      unsigned block_index_j) const;
+
+  //: Wait for window slot \p k, drop it and all slots before it. Caller holds \p lock.
+  vil_image_view_base_sptr take_slot(std::size_t k, std::unique_lock<std::mutex>& lock) const;
+
+  std::vector<vil_blocked_image_resource_sptr> birs_;
+  std::vector<block_index> order_;
+  unsigned n_in_flight_;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable slot_ready_;
+  //: Index in order_ of the next block to submit
+  mutable std::size_t next_submit_;
+  mutable std::deque<slot_sptr> window_;
+  mutable bool cancelled_;
+
+  //: Indices into birs_ of the resources not currently being read
+  mutable std::vector<unsigned> free_birs_;
+  mutable std::mutex birs_mutex_;
+  mutable std::condition_variable bir_free_;
+
+  vil_thread_pool* pool_;
+
+  // not copyable
+  vil_prefetch_image_resource(vil_prefetch_image_resource const&);
+  vil_prefetch_image_resource& operator=(vil_prefetch_image_resource const&);
+};
+
+#endif // vil_prefetch_image_resource_h_
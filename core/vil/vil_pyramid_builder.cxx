@@ -0,0 +1,240 @@
+// This is core/vil/vil_pyramid_builder.cxx
+#include <algorithm>
+#include <cstddef>
+#include "vil_pyramid_builder.h"
+//:
+// \file
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vxl_config.h>
+#include <vil/vil_image_view.h>
+#include <vil/vil_property.h>
+
+//: Mean of four values, rounded down, without overflow
+template <class T>
+inline T vil_pyramid_mean4(T a, T b, T c, T d)
+{
+  return T((a>>2) + (b>>2) + (c>>2) + (d>>2) +
+           (((a&3) + (b&3) + (c&3) + (d&3)) >> 2));
+}
+
+inline float vil_pyramid_mean4(float a, float b, float c, float d)
+{
+  return 0.25f*(a+b+c+d);
+}
+
+inline double vil_pyramid_mean4(double a, double b, double c, double d)
+{
+  return 0.25*(a+b+c+d);
+}
+
+//: One level of the cascade
+template <class T>
+struct vil_pyramid_builder_level
+{
+  //: Destination, or null for an unwritten level 0
+  vil_image_resource_sptr dest;
+  unsigned ni, nj, nplanes;
+  //: Rows waiting to be written to dest, with interleaved planes
+  vil_image_view<T> band;
+  //: Row of dest at which band starts, and number of rows in band
+  unsigned band_j0, band_rows;
+  //: Even row waiting for the odd row below it, if has_pending
+  vil_image_view<T> pending;
+  bool has_pending;
+  //: Buffer for the row passed on to the next level
+  vil_image_view<T> next_row;
+};
+
+template <class T>
+class vil_pyramid_builder_cascade
+{
+ public:
+  vil_pyramid_builder_cascade(std::vector<vil_image_resource_sptr> const& levels,
+                              unsigned ni, unsigned nj, unsigned nplanes)
+    : levels_(levels.size())
+  {
+    for (unsigned L = 0; L<levels.size(); ++L)
+    {
+      vil_pyramid_builder_level<T>& l = levels_[L];
+      l.dest = levels[L];
+      l.ni = vil_pyramid_level_size(ni, L);
+      l.nj = vil_pyramid_level_size(nj, L);
+      l.nplanes = nplanes;
+      l.band_j0 = l.band_rows = 0;
+      l.has_pending = false;
+      if (l.dest)
+      {
+        // write whole rows of blocks at a time
+        unsigned sbj = 0;
+        if (!l.dest->get_property(vil_property_size_block_j, &sbj) || sbj==0)
+          sbj = 64;
+        l.band = vil_image_view<T>(l.ni, std::min(sbj, l.nj), 1, nplanes);
+      }
+      if (L+1<levels.size())
+      {
+        l.pending = vil_image_view<T>(l.ni, 1, 1, nplanes);
+        l.next_row = vil_image_view<T>(vil_pyramid_level_size(ni, L+1), 1, 1, nplanes);
+      }
+    }
+  }
+
+  //: Pass the next row of level L down the cascade
+  bool push_row(unsigned L, vil_image_view<T> const& row)
+  {
+    vil_pyramid_builder_level<T>& l = levels_[L];
+    if (l.dest)
+    {
+      copy_row(row, l.band, l.band_rows);
+      if (++l.band_rows == l.band.nj() && !flush(l))
+        return false;
+    }
+    if (L+1==levels_.size())
+      return true;
+    if (!l.has_pending)
+    {
+      copy_row(row, l.pending, 0);
+      l.has_pending = true;
+      return true;
+    }
+    l.has_pending = false;
+    decimate(l.pending, row, l.next_row);
+    return push_row(L+1, l.next_row);
+  }
+
+  //: Complete all levels after the last row of the base
+  bool finish()
+  {
+    for (unsigned L = 0; L<levels_.size(); ++L)
+    {
+      vil_pyramid_builder_level<T>& l = levels_[L];
+      // an odd number of rows: the last one has no partner, and is dropped
+      l.has_pending = false;
+      if (l.dest && l.band_rows>0 && !flush(l))
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  static void copy_row(vil_image_view<T> const& row, vil_image_view<T>& dest,
+                       unsigned j)
+  {
+    for (unsigned p = 0; p<row.nplanes(); ++p)
+    {
+      const T* s = row.top_left_ptr() + p*row.planestep();
+      T* d = dest.top_left_ptr() + p*dest.planestep() + j*dest.jstep();
+      for (unsigned i = 0; i<row.ni(); ++i, s += row.istep(), d += dest.istep())
+        *d = *s;
+    }
+  }
+
+  //: out(i) = mean of a(2i), a(2i+1), b(2i) and b(2i+1)
+  static void decimate(vil_image_view<T> const& a, vil_image_view<T> const& b,
+                       vil_image_view<T>& out)
+  {
+    const unsigned nout = out.ni();
+    const std::ptrdiff_t ia = a.istep(), ib = b.istep(), io = out.istep();
+    for (unsigned p = 0; p<out.nplanes(); ++p)
+    {
+      const T* pa = a.top_left_ptr() + p*a.planestep();
+      const T* pb = b.top_left_ptr() + p*b.planestep();
+      T* po = out.top_left_ptr() + p*out.planestep();
+      // an odd last column has no partner, and is dropped
+      for (unsigned i = 0; i<nout; ++i, pa += 2*ia, pb += 2*ib, po += io)
+        *po = vil_pyramid_mean4(pa[0], pa[ia], pb[0], pb[ib]);
+    }
+  }
+
+  static bool flush(vil_pyramid_builder_level<T>& l)
+  {
+    bool ok;
+    if (l.band_rows==l.band.nj())
+      ok = l.dest->put_view(l.band, 0, l.band_j0);
+    else
+    {
+      vil_image_view<T> part(l.band.memory_chunk(), l.band.top_left_ptr(),
+                             l.band.ni(), l.band_rows, l.band.nplanes(),
+                             l.band.istep(), l.band.jstep(), l.band.planestep());
+      ok = l.dest->put_view(part, 0, l.band_j0);
+    }
+    l.band_j0 += l.band_rows;
+    l.band_rows = 0;
+    return ok;
+  }
+
+  std::vector<vil_pyramid_builder_level<T> > levels_;
+};
+
+template <class T>
+static bool vil_build_pyramid_levels(vil_image_resource_sptr const& base,
+                                     std::vector<vil_image_resource_sptr> const& levels,
+                                     unsigned band_nj, T /*dummy*/)
+{
+  const unsigned ni = base->ni(), nj = base->nj(), np = base->nplanes();
+  vil_pyramid_builder_cascade<T> cascade(levels, ni, nj, np);
+  for (unsigned j0 = 0; j0<nj; j0 += band_nj)
+  {
+    const unsigned n = std::min(band_nj, nj-j0);
+    vil_image_view<T> band = base->get_view(0, ni, j0, n);
+    if (band.ni()!=ni || band.nj()!=n || band.nplanes()!=np)
+      return false;
+    for (unsigned j = 0; j<n; ++j)
+    {
+      vil_image_view<T> row(band.memory_chunk(),
+                            band.top_left_ptr() + j*band.jstep(),
+                            ni, 1, np, band.istep(), band.jstep(), band.planestep());
+      if (!cascade.push_row(0, row))
+        return false;
+    }
+  }
+  return cascade.finish();
+}
+
+bool vil_build_pyramid_levels(vil_image_resource_sptr const& base,
+                              std::vector<vil_image_resource_sptr> const& levels,
+                              unsigned band_nj)
+{
+  if (!base || levels.empty())
+    return false;
+  const unsigned ni = base->ni(), nj = base->nj(), np = base->nplanes();
+  if (ni==0 || nj==0)
+    return false;
+  for (unsigned L = 0; L<levels.size(); ++L)
+  {
+    if (!levels[L])
+    {
+      if (L==0) continue;
+      return false;
+    }
+    if (levels[L]->ni()==0 || levels[L]->nj()==0 ||
+        levels[L]->ni()!=vil_pyramid_level_size(ni, L) ||
+        levels[L]->nj()!=vil_pyramid_level_size(nj, L) ||
+        levels[L]->nplanes()!=np ||
+        levels[L]->pixel_format()!=base->pixel_format())
+      return false;
+  }
+  if (band_nj==0 &&
+      (!base->get_property(vil_property_size_block_j, &band_nj) || band_nj==0))
+    band_nj = 64;
+
+  switch (base->pixel_format())
+  {
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define macro( F , T ) \
+   case F: \
+    return vil_build_pyramid_levels(base, levels, band_nj, T());
+   macro(VIL_PIXEL_FORMAT_BYTE , vxl_byte )
+   macro(VIL_PIXEL_FORMAT_UINT_16 , vxl_uint_16 )
+   macro(VIL_PIXEL_FORMAT_UINT_32 , vxl_uint_32 )
+#if VXL_HAS_INT_64
+   macro(VIL_PIXEL_FORMAT_UINT_64 , vxl_uint_64 )
+#endif
+   macro(VIL_PIXEL_FORMAT_FLOAT , float )
+   macro(VIL_PIXEL_FORMAT_DOUBLE , double )
+#undef macro
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+   default:
+    return false;
+  }
+}
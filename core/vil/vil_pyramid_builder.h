@@ -0,0 +1,56 @@
+// This is core/vil/vil_pyramid_builder.h
+#ifndef vil_pyramid_builder_h_
+#define vil_pyramid_builder_h_
+//:
+// \file
+// \brief Write every level of a 2:1 image pyramid in one pass over the base
+//
+// vil_build_pyramid_levels() reads the base image once, from top to
+// bottom in bands of rows, and pushes each row down a cascade of 2:1
+// decimations, so that all levels are produced at the same time. Each
+// level keeps one row waiting for its partner, and collects its output
+// rows until a whole row of blocks of its destination can be written.
+// Memory use is therefore a few rows of blocks per level, whatever the
+// size of the image, which allows pyramids of images much larger than
+// memory to be built.
+//
+// Level L has size (ni/2^L) x (nj/2^L), rounded down as by
+// vil_pyramid_image_resource::decimate() and assumed by the pyramid
+// resources when they scale coordinates between levels. Each pixel is
+// the mean of the 2x2 pixels of level L-1 it covers, rounded down for
+// integer types; the last column or row of a level with an odd size
+// is not used.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vector>
+#include <vcl_compiler.h>
+#include <vil/vil_image_resource.h>
+
+//: Size of level \p level of a 2:1 pyramid whose base has size \p n
+inline unsigned vil_pyramid_level_size(unsigned n, unsigned level)
+{
+  return level<32 ? n>>level : 0;
+}
+
+//: Write levels 0 to levels.size()-1 of the pyramid of \p base.
+// levels[L] receives level L, and must have the size given by
+// vil_pyramid_level_size() and the pixel format and number of planes of
+// \p base. levels[0] may be null if the base need not be copied; other
+// levels may not, and may not be empty. Destinations are written with put_view() in bands
+// of whole rows of blocks, from top to bottom.
+//
+// The base is read with get_view() in bands of \p band_nj rows; 0 means
+// the block height of \p base if it is blocked, and 64 rows otherwise.
+//
+// Supports pixel formats vxl_byte, vxl_uint_16, vxl_uint_32, vxl_uint_64,
+// float and double. Returns false if the format is not supported, a
+// destination has the wrong size, or reading or writing fails.
+bool vil_build_pyramid_levels(vil_image_resource_sptr const& base,
+                              std::vector<vil_image_resource_sptr> const& levels,
+                              unsigned band_nj = 0);
+
+#endif // vil_pyramid_builder_h_
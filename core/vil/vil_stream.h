@@ -11,6 +11,7 @@
 // \date 16 Feb 00
 
 #include <vxl_config.h>
+#include <vcl_compiler.h>
 #include <vcl_atomic_count.h>
 
 #if VXL_HAS_INT_64
@@ -44,6 +45,12 @@ class vil_stream
   //: Amount of data in the stream
   virtual vil_streampos file_size() const = 0;
 
+  //: Start of the whole stream in memory, or null if it is not memory resident.
+  // A stream backed by a memory-mapped file returns the start of the
+  // mapping, which stays valid for the lifetime of the stream. Image
+  // readers use this to return views of the pixels in place.
+  virtual void* mapped_data() { return VXL_NULLPTR; }
+
   //: up/down the reference count
   void ref() { ++refcount_; }
 
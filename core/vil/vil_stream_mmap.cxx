@@ -0,0 +1,126 @@
+// This is core/vil/vil_stream_mmap.cxx
+#include <cstring>
+#include "vil_stream_mmap.h"
+//:
+// \file
+#include <vcl_compiler.h>
+
+#if defined(VCL_WIN32)
+# include <windows.h>
+# define VIL_STREAM_MMAP_WIN32 1
+#elif defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define VIL_STREAM_MMAP_POSIX 1
+#endif
+
+bool vil_stream_mmap::is_supported()
+{
+#if defined(VIL_STREAM_MMAP_WIN32) || defined(VIL_STREAM_MMAP_POSIX)
+  return true;
+#else
+  return false;
+#endif
+}
+
+#if defined(VIL_STREAM_MMAP_WIN32)
+
+vil_stream_mmap::vil_stream_mmap(char const* filename)
+  : data_(VXL_NULLPTR), size_(0), pos_(0), file_(VXL_NULLPTR), mapping_(VXL_NULLPTR)
+{
+  HANDLE f = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, VXL_NULLPTR,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, VXL_NULLPTR);
+  if (f==INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(f, &size) || size.QuadPart==0)
+  {
+    CloseHandle(f);
+    return;
+  }
+  // PAGE_WRITECOPY and FILE_MAP_COPY give a private, copy-on-write view
+  HANDLE m = CreateFileMappingA(f, VXL_NULLPTR, PAGE_WRITECOPY, 0, 0, VXL_NULLPTR);
+  if (!m)
+  {
+    CloseHandle(f);
+    return;
+  }
+  void* p = MapViewOfFile(m, FILE_MAP_COPY, 0, 0, 0);
+  if (!p)
+  {
+    CloseHandle(m);
+    CloseHandle(f);
+    return;
+  }
+  file_ = f;
+  mapping_ = m;
+  data_ = static_cast<char*>(p);
+  size_ = vil_streampos(size.QuadPart);
+}
+
+vil_stream_mmap::~vil_stream_mmap()
+{
+  if (data_)
+  {
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(file_));
+  }
+}
+
+#elif defined(VIL_STREAM_MMAP_POSIX)
+
+vil_stream_mmap::vil_stream_mmap(char const* filename)
+  : data_(VXL_NULLPTR), size_(0), pos_(0)
+{
+  int fd = ::open(filename, O_RDONLY);
+  if (fd<0) return;
+  struct stat st;
+  if (::fstat(fd, &st)==0 && S_ISREG(st.st_mode) && st.st_size>0)
+  {
+    // MAP_PRIVATE with PROT_WRITE makes the pages copy-on-write
+    void* p = ::mmap(VXL_NULLPTR, std::size_t(st.st_size), PROT_READ|PROT_WRITE,
+                     MAP_PRIVATE, fd, 0);
+    if (p!=MAP_FAILED)
+    {
+      data_ = static_cast<char*>(p);
+      size_ = vil_streampos(st.st_size);
+    }
+  }
+  // the mapping stays valid after the descriptor is closed
+  ::close(fd);
+}
+
+vil_stream_mmap::~vil_stream_mmap()
+{
+  if (data_)
+    ::munmap(data_, std::size_t(size_));
+}
+
+#else // no memory mapping on this platform
+
+vil_stream_mmap::vil_stream_mmap(char const*)
+  : data_(VXL_NULLPTR), size_(0), pos_(0)
+{
+}
+
+vil_stream_mmap::~vil_stream_mmap()
+{
+}
+
+#endif
+
+vil_streampos vil_stream_mmap::write(void const*, vil_streampos)
+{
+  return 0;
+}
+
+vil_streampos vil_stream_mmap::read(void* buf, vil_streampos n)
+{
+  if (n<=0 || pos_<0 || pos_>=size_) return 0;
+  if (n>size_-pos_) n = size_-pos_;
+  std::memcpy(buf, data_+pos_, std::size_t(n));
+  pos_ += n;
+  return n;
+}
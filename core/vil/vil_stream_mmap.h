@@ -0,0 +1,66 @@
+// This is core/vil/vil_stream_mmap.h
+#ifndef vil_stream_mmap_h_
+#define vil_stream_mmap_h_
+//:
+// \file
+// \brief A read-only vil_stream reading a memory-mapped file
+//
+// The whole file is mapped into the address space when the stream is
+// opened, which takes constant time whatever the size of the file. Pages
+// are read from disk only when first touched, and the operating system
+// may drop them again under memory pressure, so only the parts of an
+// image actually used take up resident memory.
+//
+// mapped_data() gives the start of the mapping, so readers of
+// uncompressed formats can return views pointing straight at the
+// pixels (see vil_mapped_memory_chunk). The mapping is private
+// (copy-on-write): pixels may be modified through such views, but the
+// changes are never written back to the file.
+//
+// The file must not be truncated by another process while it is mapped.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include <vil/vil_stream.h>
+
+class vil_stream_mmap : public vil_stream
+{
+ public:
+  //: Map the file \p filename. ok() is false if this is not possible.
+  explicit vil_stream_mmap(char const* filename);
+
+  // implement virtual vil_stream interface:
+  bool ok() const { return data_ != VXL_NULLPTR; }
+  //: Not supported; returns 0
+  vil_streampos write(void const* buf, vil_streampos n);
+  vil_streampos read(void* buf, vil_streampos n);
+  vil_streampos tell() const { return pos_; }
+  void seek(vil_streampos position) { pos_ = position; }
+  vil_streampos file_size() const { return size_; }
+  void* mapped_data() { return data_; }
+
+  //: True if files can be memory-mapped on this platform
+  static bool is_supported();
+
+ protected:
+  ~vil_stream_mmap();
+
+ private:
+  char* data_;
+  vil_streampos size_;
+  vil_streampos pos_;
+#if defined(VCL_WIN32)
+  void* file_;
+  void* mapping_;
+#endif
+
+  // not copyable
+  vil_stream_mmap(vil_stream_mmap const&);
+  vil_stream_mmap& operator=(vil_stream_mmap const&);
+};
+
+#endif // vil_stream_mmap_h_
@@ -118,3 +118,9 @@ vil_streampos vil_stream_section::file_size() const
 {
   return end_ >= begin_ ? end_ - begin_ : underlying_->file_size() - begin_;
 }
+
+void* vil_stream_section::mapped_data()
+{
+  char* base = static_cast<char*>(underlying_->mapped_data());
+  return base ? base + begin_ : VXL_NULLPTR;
+}
@@ -39,6 +39,9 @@ struct vil_stream_section : public vil_stream
 
   vil_streampos file_size() const;
 
+  //: The underlying stream's mapping, offset to the start of the section
+  void* mapped_data();
+
  protected:
   ~vil_stream_section();
 
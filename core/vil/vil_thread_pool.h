@@ -0,0 +1,78 @@
+// This is core/vil/vil_thread_pool.h
+#ifndef vil_thread_pool_h_
+#define vil_thread_pool_h_
+//:
+// \file
+// \brief A fixed-size pool of worker threads running queued tasks
+//
+// Tasks are run in the order they were submitted, each on whichever
+// worker becomes free first. The destructor finishes all queued tasks
+// before joining the workers.
+//
+// vil_parallel_for() runs a loop body over an index range using the
+// global pool, for data-parallel image operations.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <vcl_compiler.h>
+
+class vil_thread_pool
+{
+ public:
+  //: Start \p n_threads workers. Zero means one per hardware thread.
+  explicit vil_thread_pool(unsigned n_threads = 0);
+
+  //: Run all queued tasks, then stop the workers
+  ~vil_thread_pool();
+
+  //: Queue a task to be run on a worker thread
+  void submit(std::function<void()> const& task);
+
+  //: Block until the queue is empty and no task is running
+  void wait_idle();
+
+  //: Number of worker threads
+  unsigned n_threads() const { return static_cast<unsigned>(workers_.size()); }
+
+  //: Number of hardware threads, or 1 if that cannot be determined
+  static unsigned hardware_threads();
+
+  //: A pool with one worker per hardware thread, shared by the whole program
+  static vil_thread_pool& global();
+
+ private:
+  void worker_loop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()> > tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_ready_;
+  std::condition_variable idle_;
+  unsigned n_busy_;
+  bool stopping_;
+
+  // not copyable
+  vil_thread_pool(vil_thread_pool const&);
+  vil_thread_pool& operator=(vil_thread_pool const&);
+};
+
+//: Call f(k) for every k in [0,n), in parallel.
+// The calls are shared between the calling thread and up to n_threads-1
+// workers of vil_thread_pool::global(); n_threads==0 means one thread
+// per hardware thread.
+// Each thread repeatedly claims the next unclaimed index, so uneven
+// amounts of work per index balance themselves. Returns when all calls
+// have completed. Safe to call from within a task on the global pool.
+void vil_parallel_for(unsigned n, std::function<void(unsigned)> const& f,
+                      unsigned n_threads = 0);
+
+#endif // vil_thread_pool_h_
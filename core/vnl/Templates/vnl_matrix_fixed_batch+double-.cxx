@@ -0,0 +1,3 @@
+#include <vnl/vnl_matrix_fixed_batch.hxx>
+
+VNL_MATRIX_FIXED_BATCH_INSTANTIATE(double);
@@ -0,0 +1,3 @@
+#include <vnl/vnl_sparse_matrix_csr.hxx>
+
+VNL_SPARSE_MATRIX_CSR_INSTANTIATE(double);
@@ -0,0 +1,2 @@
+#include <vnl/algo/vnl_svd_fixed_batch.hxx>
+VNL_SVD_FIXED_BATCH_INSTANTIATE(double, 3, 4);
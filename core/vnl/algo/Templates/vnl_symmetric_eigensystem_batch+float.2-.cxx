@@ -0,0 +1,2 @@
+#include <vnl/algo/vnl_symmetric_eigensystem_batch.hxx>
+VNL_SYMMETRIC_EIGENSYSTEM_BATCH_INSTANTIATE(float, 2);
@@ -0,0 +1,137 @@
+// This is core/vnl/algo/tests/test_blocked_factor.cxx
+#include <iostream>
+#include <cmath>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check that the blocked factorizations give what the netlib ones give
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_blocked_factor.h>
+#include <vnl/algo/vnl_cholesky.h>
+#include <vnl/algo/vnl_qr.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+
+static const unsigned netlib_only = 1000000;
+
+template <class T>
+static vnl_matrix<T> random_matrix(unsigned r, unsigned c, vnl_random& rng)
+{
+  vnl_matrix<T> M(r, c);
+  for (unsigned i = 0; i < r; ++i)
+    for (unsigned j = 0; j < c; ++j)
+      M(i, j) = T(rng.drand64(-1.0, 1.0));
+  return M;
+}
+
+static void test_cholesky(unsigned n)
+{
+  vnl_random rng(17 + n);
+  vnl_matrix<double> B = random_matrix<double>(n, n, rng);
+  vnl_matrix<double> A = B * B.transpose();
+  for (unsigned i = 0; i < n; ++i)
+    A(i, i) += n;
+
+  vnl_blocked_factor_set_min_size(netlib_only);
+  vnl_cholesky ref(A, vnl_cholesky::quiet);
+  vnl_blocked_factor_set_min_size(64);
+  vnl_cholesky chol(A, vnl_cholesky::quiet);
+  TEST_NEAR("Cholesky factor as dpofa", (chol.lower_triangle() - ref.lower_triangle()).absolute_value_max(), 0.0, 1e-12*n);
+  vnl_vector<double> b(n, 1.0), x = chol.solve(b);
+  TEST_NEAR("Cholesky solve", (A*x - b).inf_norm(), 0.0, 1e-10);
+
+  // not positive definite from row 100 on
+  A(100, 100) = -1.0;
+  vnl_blocked_factor_set_min_size(netlib_only);
+  vnl_cholesky ref_bad(A, vnl_cholesky::quiet);
+  vnl_blocked_factor_set_min_size(64);
+  vnl_cholesky bad(A, vnl_cholesky::quiet);
+  TEST("failing minor as dpofa", bad.rank_deficiency() == ref_bad.rank_deficiency() &&
+                                 bad.rank_deficiency() == 101, true);
+}
+
+template <class T>
+static void test_qr(unsigned r, unsigned c, double tol)
+{
+  vnl_random rng(r*c);
+  vnl_matrix<T> M = random_matrix<T>(r, c, rng);
+  // a column already zero below the diagonal, and one that is zero throughout
+  for (unsigned i = 1; i < r; ++i)
+    M(i, 0) = T(0);
+  for (unsigned i = 0; i < r; ++i)
+    M(i, 7) = T(0);
+
+  vnl_blocked_factor_set_min_size(netlib_only);
+  vnl_qr<T> ref(M);
+  vnl_blocked_factor_set_min_size(64);
+  vnl_qr<T> qr(M);
+  std::cout << r << 'x' << c << " QR\n";
+  TEST_NEAR("R as xqrdc", (qr.R() - ref.R()).absolute_value_max(), 0.0, tol);
+  TEST_NEAR("Q as xqrdc", (qr.Q() - ref.Q()).absolute_value_max(), 0.0, tol);
+  TEST_NEAR("QR = M", (qr.Q()*qr.R() - M).absolute_value_max(), 0.0, tol);
+  TEST_NEAR("determinant as xqrdc", qr.determinant(), ref.determinant(),
+            tol*(1.0 + std::fabs(ref.determinant())));
+  if (r >= c)
+  {
+    vnl_vector<T> b(r, T(1));
+    TEST_NEAR("Q'b as xqrsl", (qr.QtB(b) - ref.QtB(b)).inf_norm(), 0.0, tol);
+  }
+}
+
+template <class T>
+static void test_svd(unsigned r, unsigned c, double tol)
+{
+  vnl_random rng(r + c);
+  vnl_matrix<T> M = random_matrix<T>(r, c, rng);
+  vnl_blocked_factor_set_min_size(netlib_only);
+  vnl_svd<T> ref(M);
+  vnl_blocked_factor_set_min_size(64);
+  vnl_svd<T> svd(M);
+  std::cout << r << 'x' << c << " SVD\n";
+  TEST("valid", svd.valid(), true);
+  TEST_NEAR("singular values as xsvdc", (svd.W().diagonal() - ref.W().diagonal()).inf_norm(), 0.0, tol);
+  TEST_NEAR("U W V' = M", (svd.recompose() - M).absolute_value_max(), 0.0, tol);
+  vnl_matrix<T> I(c, c); I.set_identity();
+  TEST_NEAR("U orthonormal", (svd.U().transpose()*svd.U() - I).absolute_value_max(), 0.0, tol);
+  TEST_NEAR("V orthonormal", (svd.V().transpose()*svd.V() - I).absolute_value_max(), 0.0, tol);
+}
+
+static void test_eigensystem(unsigned n)
+{
+  vnl_random rng(n);
+  vnl_matrix<double> B = random_matrix<double>(n, n, rng);
+  vnl_matrix<double> A = B + B.transpose();
+  vnl_blocked_factor_set_min_size(netlib_only);
+  vnl_symmetric_eigensystem<double> ref(A);
+  vnl_blocked_factor_set_min_size(64);
+  vnl_symmetric_eigensystem<double> eig(A);
+  TEST_NEAR("eigenvalues as rs", (eig.D.diagonal() - ref.D.diagonal()).inf_norm(), 0.0, 1e-11);
+  TEST_NEAR("A V = V D", (A*eig.V - eig.V*eig.D).absolute_value_max(), 0.0, 1e-11);
+}
+
+static void test_blocked_factor()
+{
+  const unsigned default_size = vnl_blocked_factor_min_size();
+  std::cout << "LAPACK " << (vnl_blocked_factor_has_lapack() ? "available" : "not available") << '\n';
+  for (int lapack = vnl_blocked_factor_has_lapack() ? 1 : 0; lapack >= 0; --lapack)
+  {
+    vnl_blocked_factor_set_use_lapack(lapack == 1);
+    TEST("LAPACK in use", vnl_blocked_factor_uses_lapack(), lapack == 1);
+    test_cholesky(150);
+    test_cholesky(301);
+    test_qr<double>(230, 170, 1e-12);
+    test_qr<double>(170, 230, 1e-12);
+    test_qr<double>(300, 300, 1e-12);
+    test_qr<float>(150, 100, 1e-4);
+    test_svd<double>(200, 120, 1e-12);
+    test_svd<float>(120, 100, 1e-4);
+    test_eigensystem(150);
+  }
+  vnl_blocked_factor_set_use_lapack(vnl_blocked_factor_has_lapack());
+  vnl_blocked_factor_set_min_size(default_size);
+}
+
+TESTMAIN(test_blocked_factor);
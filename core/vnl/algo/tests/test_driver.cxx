@@ -2,6 +2,7 @@
 
 DECLARE( test_amoeba );
 DECLARE( test_cholesky );
+DECLARE( test_blocked_factor );
 DECLARE( test_complex_eigensystem );
 DECLARE( test_convolve );
 DECLARE( test_cpoly_roots );
@@ -10,6 +11,7 @@ DECLARE( test_rank );
 DECLARE( test_fft );
 DECLARE( test_fft1d );
 DECLARE( test_fft2d );
+DECLARE( test_fft_plan );
 DECLARE( test_functions );
 DECLARE( test_generalized_eigensystem );
 DECLARE( test_ldl_cholesky );
@@ -27,6 +29,7 @@ DECLARE( test_sparse_matrix );
 DECLARE( test_integral );
 DECLARE( test_svd );
 DECLARE( test_svd_fixed );
+DECLARE( test_svd_fixed_batch );
 DECLARE( test_symmetric_eigensystem );
 DECLARE( test_algo );
 DECLARE( test_solve_qp );
@@ -41,6 +44,7 @@ register_tests()
 {
   REGISTER( test_amoeba );
   REGISTER( test_cholesky );
+  REGISTER( test_blocked_factor );
   REGISTER( test_complex_eigensystem );
   REGISTER( test_convolve );
   REGISTER( test_cpoly_roots );
@@ -49,6 +53,7 @@ register_tests()
   REGISTER( test_fft );
   REGISTER( test_fft1d );
   REGISTER( test_fft2d );
+  REGISTER( test_fft_plan );
   REGISTER( test_functions );
   REGISTER( test_generalized_eigensystem );
   REGISTER( test_ldl_cholesky );
@@ -65,6 +70,7 @@ register_tests()
   REGISTER( test_sparse_matrix );
   REGISTER( test_svd );
   REGISTER( test_svd_fixed );
+  REGISTER( test_svd_fixed_batch );
   REGISTER( test_symmetric_eigensystem );
   REGISTER( test_algo );
   REGISTER( test_solve_qp );
@@ -0,0 +1,185 @@
+// This is core/vnl/algo/tests/test_fft_plan.cxx
+#include <iostream>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vnl_fft_plan against a plain DFT, for mixed-radix, Bluestein and real transforms
+#include <vcl_compiler.h>
+#include <vnl/vnl_math.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+#include <vnl/vnl_gemm.h>
+#include <vnl/algo/vnl_fft_plan.h>
+#include <vnl/algo/vnl_fft_1d.h>
+#include <vnl/algo/vnl_fft_2d.h>
+
+//: X_k = sum_j x_j exp(2 pi i dir jk/n), in long double
+template <class T>
+static std::vector<std::complex<T> > dft(std::vector<std::complex<T> > const& x, int dir)
+{
+  const std::size_t n = x.size();
+  std::vector<std::complex<T> > X(n);
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    std::complex<long double> s(0, 0);
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      const long double a = dir * 2 * vnl_math::pi * double((j*k) % n) / double(n);
+      s += std::complex<long double>(x[j].real(), x[j].imag()) *
+           std::complex<long double>(std::cos(a), std::sin(a));
+    }
+    X[k] = std::complex<T>(T(s.real()), T(s.imag()));
+  }
+  return X;
+}
+
+template <class T>
+static double max_diff(std::complex<T> const* a, std::complex<T> const* b, std::size_t n)
+{
+  double d = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    d = std::max(d, double(std::abs(a[i] - b[i])));
+  return d;
+}
+
+//: Compare one transform of every length in [n0, n1] with the DFT, relative to sqrt(n)
+template <class T>
+static void test_lengths(unsigned n0, unsigned n1, double tol, const char* what)
+{
+  vnl_random rng(1234);
+  double d = 0, d_real = 0, d_inv = 0;
+  for (unsigned n = n0; n <= n1; ++n)
+  {
+    std::vector<std::complex<T> > x(n), r(n);
+    for (unsigned j = 0; j < n; ++j)
+    {
+      x[j] = std::complex<T>(T(rng.drand64(-1, 1)), T(rng.drand64(-1, 1)));
+      r[j] = std::complex<T>(x[j].real(), T(0));
+    }
+    vnl_fft_plan<T> const& plan = vnl_fft_plan<T>::get(n);
+    for (int dir = -1; dir <= 1; dir += 2)
+    {
+      std::vector<std::complex<T> > X = x;
+      plan.transform(&X[0], dir);
+      d = std::max(d, max_diff(&X[0], &dft(x, dir)[0], n) / std::sqrt(double(n)));
+    }
+
+    // real signal: the first n/2+1 coefficients, and back
+    std::vector<T> xr(n), back(n);
+    for (unsigned j = 0; j < n; ++j)
+      xr[j] = r[j].real();
+    std::vector<std::complex<T> > half(n/2 + 1);
+    plan.fwd_transform_real(&xr[0], &half[0]);
+    d_real = std::max(d_real, max_diff(&half[0], &dft(r, +1)[0], n/2 + 1) / std::sqrt(double(n)));
+    plan.bwd_transform_real(&half[0], &back[0]);
+    for (unsigned j = 0; j < n; ++j)
+      d_inv = std::max(d_inv, std::fabs(double(back[j] / T(n) - xr[j])));
+  }
+  std::cout << what << ": lengths " << n0 << " to " << n1 << '\n';
+  TEST_NEAR("complex transforms as DFT", d, 0.0, tol);
+  TEST_NEAR("real transforms as DFT", d_real, 0.0, tol);
+  TEST_NEAR("real transforms invert", d_inv, 0.0, tol);
+}
+
+//: Batches with different strides must give the same as one transform at a time
+static void test_batch(unsigned n, unsigned lot)
+{
+  vnl_random rng(99);
+  vnl_fft_plan<double> const& plan = vnl_fft_plan<double>::get(n);
+
+  // lot signals as the columns, and as the rows, of a row-major matrix
+  std::vector<std::complex<double> > cols(n*lot), rows(n*lot), ref(n*lot);
+  for (unsigned l = 0; l < lot; ++l)
+    for (unsigned j = 0; j < n; ++j)
+      ref[l*n + j] = rows[l*n + j] = cols[j*lot + l] =
+        std::complex<double>(rng.drand64(-1, 1), rng.drand64(-1, 1));
+  for (unsigned l = 0; l < lot; ++l)
+    plan.transform(&ref[l*n], -1);
+  plan.transform(&cols[0], -1, lot, lot, 1);
+  plan.transform(&rows[0], -1, lot, 1, n);
+
+  double dc = 0, dr = 0;
+  for (unsigned l = 0; l < lot; ++l)
+    for (unsigned j = 0; j < n; ++j)
+    {
+      dc = std::max(dc, std::abs(cols[j*lot + l] - ref[l*n + j]));
+      dr = std::max(dr, std::abs(rows[l*n + j] - ref[l*n + j]));
+    }
+  std::cout << lot << " signals of length " << n << '\n';
+  TEST_NEAR("interleaved signals", dc, 0.0, 1e-12);
+  TEST_NEAR("consecutive signals", dr, 0.0, 1e-12);
+}
+
+//: The real 2D transform is the left half of the complex one, and inverts
+static void test_2d_real(unsigned M, unsigned N)
+{
+  vnl_random rng(7);
+  vnl_matrix<double> x(M, N);
+  vnl_matrix<std::complex<double> > z(M, N);
+  for (unsigned r = 0; r < M; ++r)
+    for (unsigned c = 0; c < N; ++c)
+      z(r, c) = x(r, c) = rng.drand64(-1, 1);
+
+  vnl_fft_2d<double> fft(M, N);
+  fft.fwd_transform(z);
+  vnl_matrix<std::complex<double> > F;
+  fft.fwd_transform_real(x, F);
+  TEST("half spectrum size", F.rows() == M && F.cols() == N/2 + 1, true);
+  double d = 0;
+  for (unsigned r = 0; r < M; ++r)
+    for (unsigned c = 0; c <= N/2; ++c)
+      d = std::max(d, std::abs(F(r, c) - z(r, c)));
+  std::cout << M << 'x' << N << " real signal\n";
+  TEST_NEAR("half of the complex transform", d, 0.0, 1e-9);
+
+  vnl_matrix<double> back;
+  fft.bwd_transform_real(F, back);
+  back /= double(M*N);
+  TEST_NEAR("backward real transform", (back - x).absolute_value_max(), 0.0, 1e-12);
+}
+
+static void test_fft_plan()
+{
+  TEST("plans are shared", &vnl_fft_plan<double>::get(48) == &vnl_fft_plan<double>::get(48), true);
+  TEST("mixed radix for 2*3*29", vnl_fft_plan<double>::get(174).uses_bluestein(), false);
+  TEST("Bluestein for 37", vnl_fft_plan<double>::get(37).uses_bluestein(), true);
+
+  const vnl_gemm_level best = vnl_gemm_best_level();
+  for (int level = vnl_gemm_generic; level <= best; ++level)
+  {
+    vnl_gemm_set_level(vnl_gemm_level(level));
+    std::cout << "instruction set level " << level << '\n';
+    test_lengths<double>(1, 70, 1e-14, "double");
+    test_lengths<float>(1, 70, 1e-6, "float");
+    test_batch(60, 37);
+  }
+  vnl_gemm_set_level(best);
+
+  test_lengths<double>(97, 101, 1e-14, "double");
+  test_lengths<double>(1000, 1000, 1e-14, "double");
+  test_lengths<double>(1024, 1024, 1e-14, "double");
+  test_lengths<double>(1031, 1031, 1e-14, "double");
+  test_batch(1031, 5);
+  test_batch(256, 300); // large enough to be shared between threads
+
+  test_2d_real(48, 64);
+  test_2d_real(35, 27);
+
+  // lengths that gpfa did not support
+  vnl_fft_1d<double> fft7(7);
+  std::vector<std::complex<double> > x(7), y;
+  for (unsigned j = 0; j < 7; ++j)
+    x[j] = std::complex<double>(j, 1.0/(j+1));
+  y = x;
+  fft7.fwd_transform(y);
+  TEST_NEAR("vnl_fft_1d of length 7", max_diff(&y[0], &dft(x, +1)[0], 7), 0.0, 1e-13);
+  vnl_matrix<std::complex<double> > m(7, 11, std::complex<double>(1, 0));
+  vnl_fft_2d<double> fft2(7, 11);
+  fft2.fwd_transform(m);
+  TEST_NEAR("vnl_fft_2d of size 7x11", std::abs(m(0, 0) - 77.0) + std::abs(m(3, 5)), 0.0, 1e-12);
+}
+
+TESTMAIN(test_fft_plan);
@@ -45,9 +45,13 @@
 #include <vnl/algo/vnl_svd.h>
 #include <vnl/algo/vnl_svd_economy.h>
 #include <vnl/algo/vnl_svd_fixed.h>
+#include <vnl/algo/vnl_svd_fixed_batch.h>
 #include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vnl/algo/vnl_symmetric_eigensystem_batch.h>
 
 #include <vnl/algo/vnl_fft_base.h>
 #include <vnl/algo/vnl_fft_prime_factors.h>
+#include <vnl/algo/vnl_fft_plan.h>
+#include <vnl/algo/vnl_blocked_factor.h>
 
 int main() { return 0; }
@@ -46,6 +46,77 @@ struct linear_est : public vnl_least_squares_function
   vnl_vector<double> b_;
 };
 
+// Fit a sum of two decaying exponentials and a sinusoid to samples of one.
+// The batched version counts its calls; clone() makes independent copies.
+struct exp_sin_fit : public vnl_least_squares_function
+{
+  exp_sin_fit(vnl_vector<double> const& y, bool batched)
+  : vnl_least_squares_function(6, y.size(), no_gradient), y_(y), n_batches_(0)
+  { use_batch_ = batched; }
+
+  void f(vnl_vector<double> const& p, vnl_vector<double>& r) {
+    for (unsigned k = 0; k < y_.size(); ++k) {
+      double t = 0.1*k;
+      r[k] = p[0]*std::exp(-p[1]*t) + p[2]*std::exp(-p[3]*t) + p[4]*std::sin(p[5]*t) - y_[k];
+    }
+  }
+
+  void f_batch(vnl_matrix<double> const& x, vnl_matrix<double>& fx) {
+    ++n_batches_;
+    vnl_least_squares_function::f_batch(x, fx);
+  }
+
+  vnl_least_squares_function* clone() const { return new exp_sin_fit(*this); }
+
+  vnl_vector<double> y_;
+  unsigned n_batches_;
+};
+
+static
+void do_fd_jacobian_test()
+{
+  vnl_vector<double> y(60);
+  for (unsigned k = 0; k < y.size(); ++k) {
+    double t = 0.1*k;
+    y[k] = 2.0*std::exp(-0.5*t) - 1.0*std::exp(-3.0*t) + 0.3*std::sin(1.7*t) + 0.01*std::cos(13.0*k);
+  }
+  vnl_vector<double> x0(6);
+  x0[0] = 1.5; x0[1] = 0.4; x0[2] = -0.5; x0[3] = 2.0; x0[4] = 0.5; x0[5] = 1.5;
+
+  // reference: lmdif evaluating one column at a time
+  exp_sin_fit f(y, false);
+  vnl_levenberg_marquardt lm(f);
+  vnl_vector<double> x_ref = x0;
+  lm.minimize_without_gradient(x_ref);
+  lm.diagnose_outcome(std::cout);
+
+  // the same function on several threads, each with its own clone
+  vnl_levenberg_marquardt lm_mt(f);
+  lm_mt.set_max_threads(4);
+  vnl_vector<double> x_mt = x0;
+  TEST("minimize with threaded Jacobian", lm_mt.minimize_without_gradient(x_mt), true);
+  lm_mt.diagnose_outcome(std::cout);
+  TEST_NEAR("same solution as lmdif", (x_mt-x_ref).inf_norm(), 0.0, 1e-12);
+  TEST("same number of iterations", lm_mt.get_num_iterations(), lm.get_num_iterations());
+  TEST("same number of evaluations", lm_mt.get_num_evaluations(), lm.get_num_evaluations());
+
+  // a function that prefers batches, on one thread
+  exp_sin_fit fb(y, true);
+  vnl_levenberg_marquardt lm_b(fb);
+  vnl_vector<double> x_b = x0;
+  lm_b.minimize_without_gradient(x_b);
+  TEST_NEAR("batched: same solution as lmdif", (x_b-x_ref).inf_norm(), 0.0, 1e-12);
+  TEST("batched: one batch per Jacobian", fb.n_batches_ > 0 && fb.n_batches_ <= lm_b.get_num_iterations()+1, true);
+
+  // running out of evaluations is still reported
+  vnl_levenberg_marquardt lm_short(f);
+  lm_short.set_max_threads(2);
+  lm_short.set_max_function_evals(20);
+  vnl_vector<double> x_short = x0;
+  TEST("evaluation limit", lm_short.minimize_without_gradient(x_short), false);
+  TEST("too many iterations", lm_short.get_failure_code(), vnl_nonlinear_minimizer::TOO_MANY_ITERATIONS);
+}
+
 static
 void do_rosenbrock_test(bool with_grad)
 {
@@ -131,6 +202,8 @@ void test_levenberg_marquardt()
 
   do_linear_test(true);
   do_linear_test(false);
+
+  do_fd_jacobian_test();
 }
 
 TESTMAIN(test_levenberg_marquardt);
@@ -1,6 +1,10 @@
 #include <iostream>
+#include <string>
+#include <algorithm>
+#include <cmath>
 #include <testlib/testlib_test.h>
 #include <vnl/vnl_sparse_lst_sqr_function.h>
+#include <vnl/vnl_crs_index.h>
 #include <vnl/algo/vnl_sparse_lm.h>
 #include <vcl_compiler.h>
 #include <vcl_cassert.h>
@@ -797,11 +801,114 @@ void test_prob3()
 }
 
 
+
+//: Minimize f from (pa,pb,pc) with the given solver, returning the final RMS error
+template <class F>
+static double minimize_with(F& f, vnl_sparse_lm::schur_solver_type solver, unsigned int threads,
+                            vnl_vector<double>& pa, vnl_vector<double>& pb, vnl_vector<double>& pc)
+{
+  vnl_sparse_lm slm(f);
+  slm.set_schur_solver(solver);
+  slm.set_max_threads(threads);
+  slm.set_x_tolerance(1e-10);
+  slm.minimize(pa,pb,pc);
+  slm.diagnose_outcome();
+  if (solver == vnl_sparse_lm::schur_pcg)
+    std::cout << "conjugate gradient iterations: " << slm.get_pcg_iterations() << std::endl;
+  return slm.get_end_error();
+}
+
+
+// A strip of cameras each seeing only the points in front of it, so that
+// the reduced camera system is banded; all three ways of solving it
+// should find the same minimum (up to the choice of coordinate system).
+void test_prob4()
+{
+  const unsigned int num_cam = 12, num_pts = 60;
+  vnl_vector<double> a(3*num_cam), b(2*num_pts);
+  for (unsigned int i=0; i<num_cam; ++i)
+  {
+    a[3*i] = 0.05*std::sin(double(i));
+    a[3*i+1] = -2.0*i;
+    a[3*i+2] = 0.0;
+  }
+  std::vector<std::vector<bool> > mask(num_cam, std::vector<bool>(num_pts, false));
+  for (unsigned int j=0; j<num_pts; ++j)
+  {
+    b[2*j] = 22.0*j/(num_pts-1);
+    b[2*j+1] = 8.0 + 0.6*((7*j)%10);
+    for (unsigned int i=0; i<num_cam; ++i)
+      mask[i][j] = std::fabs(b[2*j] - 2.0*i) <= 3.0;
+  }
+  vnl_crs_index crs(mask);
+  vnl_vector<double> c(1, 1.5), no_c, proj(crs.num_non_zero(), 0.0), proj_c(crs.num_non_zero(), 0.0);
+  bundle_2d(num_cam,num_pts,proj,mask).f(a,b,no_c,proj);
+  bundle_2d_shared(num_cam,num_pts,proj_c,mask).f(a,b,c,proj_c);
+
+  // add noise to the projections so that the minimum has a nonzero error
+  vnl_random rnd(4321);
+  for (unsigned int k=0; k<proj.size(); ++k)
+  {
+    proj[k] += rnd.normal()*1e-3;
+    proj_c[k] += rnd.normal()*1e-3;
+  }
+
+  // initial conditions near the true values
+  vnl_vector<double> init_a(a), init_b(b);
+  for (unsigned int i=0; i<init_a.size(); ++i)
+    init_a[i] += rnd.normal()*0.01;
+  for (unsigned int i=0; i<init_b.size(); ++i)
+    init_b[i] += rnd.normal()*0.05;
+
+  const char* solver_name[] = { "dense Cholesky", "sparse LU", "conjugate gradients" };
+  vnl_vector<double> ref_a, ref_b, ref_ca, ref_cb, ref_c;
+  for (int s=vnl_sparse_lm::schur_dense_cholesky; s<=vnl_sparse_lm::schur_pcg; ++s)
+  {
+    const vnl_sparse_lm::schur_solver_type solver = vnl_sparse_lm::schur_solver_type(s);
+    const unsigned int threads = s==vnl_sparse_lm::schur_dense_cholesky ? 1 : 4;
+    std::cout << solver_name[s] << ", " << threads << " thread(s)" << std::endl;
+    {
+      bundle_2d my_func(num_cam,num_pts,proj,mask);
+      vnl_vector<double> pa(init_a), pb(init_b), pc;
+      double err = minimize_with(my_func, solver, threads, pa, pb, pc);
+      std::string name = std::string(solver_name[s]) + ": strip converges";
+      TEST(name.c_str(), err < 2e-3, true);
+      normalize(pa,pb);
+      if (s == vnl_sparse_lm::schur_dense_cholesky)
+      {
+        ref_a = pa;
+        ref_b = pb;
+      }
+      name = std::string(solver_name[s]) + ": same minimum as dense";
+      TEST_NEAR(name.c_str(), std::max(camera_diff(pa,ref_a).inf_norm(), (pb-ref_b).inf_norm()), 0.0, 1e-6);
+    }
+    {
+      bundle_2d_shared my_func(num_cam,num_pts,proj_c,mask);
+      vnl_vector<double> pa(init_a), pb(init_b), pc(1, 1.4);
+      double err = minimize_with(my_func, solver, threads, pa, pb, pc);
+      std::string name = std::string(solver_name[s]) + ": strip w/ globals converges";
+      TEST(name.c_str(), err < 2e-3, true);
+      normalize(pa,pb);
+      if (s == vnl_sparse_lm::schur_dense_cholesky)
+      {
+        ref_ca = pa;
+        ref_cb = pb;
+        ref_c = pc;
+      }
+      name = std::string(solver_name[s]) + ": w/ globals same minimum as dense";
+      TEST_NEAR(name.c_str(), std::max(std::max(camera_diff(pa,ref_ca).inf_norm(), (pb-ref_cb).inf_norm()),
+                                       (pc-ref_c).inf_norm()), 0.0, 1e-6);
+    }
+  }
+}
+
+
 static void test_sparse_lm()
 {
   test_prob1();
   test_prob2();
   test_prob3();
+  test_prob4();
 }
 
 TESTMAIN(test_sparse_lm);
@@ -0,0 +1,173 @@
+// This is core/vnl/algo/tests/test_svd_fixed_batch.cxx
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vnl_svd_fixed_batch and vnl_symmetric_eigensystem_batch against vnl_svd and vnl_symmetric_eigensystem
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix_fixed_batch.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_svd_fixed_batch.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vnl/algo/vnl_symmetric_eigensystem_batch.h>
+
+//: Check the decompositions of n random R x C matrices, every third one of rank 1
+template <class T, unsigned int R, unsigned int C>
+static void test_svd_batch(std::size_t n, double tol, const char* what)
+{
+  std::cout << what << ", " << n << " matrices\n";
+  vnl_random rng(4711);
+  vnl_matrix_fixed_batch<T,R,C> M(n);
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    vnl_matrix_fixed<T,R,C> m;
+    if (k % 3 == 2)
+      for (unsigned int r = 0; r < R; ++r)
+        for (unsigned int c = 0; c < C; ++c)
+          m(r,c) = T((r+1.0)*(c-1.5));
+    else
+      for (unsigned int i = 0; i < R*C; ++i)
+        m.data_block()[i] = T(rng.drand64(-1.0, 1.0));
+    M.set(k, m);
+  }
+  vnl_svd_fixed_batch<T,R,C> svd(M);
+
+  double d_rec = 0, d_orth = 0, d_w = 0;
+  bool sorted = true;
+  vnl_matrix<T> I(C, C); I.set_identity();
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    vnl_matrix<T> m = M.get(k).as_matrix(), u = svd.U().get(k).as_matrix();
+    vnl_matrix<T> v = svd.V().get(k).as_matrix(), w(C, C, T(0));
+    for (unsigned int i = 0; i < C; ++i)
+    {
+      w(i,i) = svd.W()(k,i,0);
+      if (i > 0 && w(i,i) > w(i-1,i-1)) sorted = false;
+    }
+    d_rec = std::max(d_rec, double((u*w*v.transpose() - m).absolute_value_max()));
+    d_orth = std::max(d_orth, double((v.transpose()*v - I).absolute_value_max()));
+    vnl_svd<T> ref(m);
+    for (unsigned int i = 0; i < C; ++i)
+      d_w = std::max(d_w, std::fabs(double(ref.W(i) - w(i,i))));
+  }
+  TEST_NEAR("U W V' = M", d_rec, 0.0, tol);
+  TEST_NEAR("V orthogonal", d_orth, 0.0, tol);
+  TEST_NEAR("same singular values as vnl_svd", d_w, 0.0, tol);
+  TEST("singular values decreasing", sorted, true);
+}
+
+//: Four point correspondences give a 9x9 system (8 equations and a zero row) whose nullvector is the homography
+static void test_homography_nullvector()
+{
+  const std::size_t n = 40;
+  vnl_random rng(123);
+  vnl_matrix_fixed_batch<double,9,9> A(n);
+  std::vector<vnl_matrix_fixed<double,3,3> > H(n);
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    for (unsigned int i = 0; i < 9; ++i)
+      H[k].data_block()[i] = rng.drand64(-1.0, 1.0);
+    H[k](2,2) += 3.0;
+    for (unsigned int p = 0; p < 4; ++p)
+    {
+      double x = rng.drand64(-1.0, 1.0), y = rng.drand64(-1.0, 1.0);
+      double u = H[k](0,0)*x + H[k](0,1)*y + H[k](0,2);
+      double v = H[k](1,0)*x + H[k](1,1)*y + H[k](1,2);
+      double w = H[k](2,0)*x + H[k](2,1)*y + H[k](2,2);
+      u /= w; v /= w;
+      const double r0[9] = { x, y, 1, 0, 0, 0, -u*x, -u*y, -u };
+      const double r1[9] = { 0, 0, 0, x, y, 1, -v*x, -v*y, -v };
+      for (unsigned int c = 0; c < 9; ++c)
+      {
+        A(k, 2*p, c) = r0[c];
+        A(k, 2*p+1, c) = r1[c];
+      }
+    }
+  }
+  vnl_svd_fixed_batch<double,9,9> svd(A);
+  vnl_matrix_fixed_batch<double,9,1> h = svd.nullvector();
+  double d = 0;
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    vnl_matrix_fixed<double,9,1> hk = h.get(k);
+    double scale = H[k](2,2) / hk(8,0);
+    for (unsigned int i = 0; i < 9; ++i)
+      d = std::max(d, std::fabs(hk(i,0)*scale - H[k].data_block()[i]));
+  }
+  TEST_NEAR("homographies from nullvectors", d, 0.0, 1e-8);
+}
+
+template <class T, unsigned int n>
+static void test_eigensystem_batch(std::size_t count, double tol, const char* what)
+{
+  std::cout << what << ", " << count << " matrices\n";
+  vnl_random rng(31415);
+  vnl_matrix_fixed_batch<T,n,n> M(count);
+  for (std::size_t k = 0; k < count; ++k)
+  {
+    vnl_matrix_fixed<T,n,n> m;
+    for (unsigned int i = 0; i < n; ++i)
+      for (unsigned int j = i; j < n; ++j)
+        m(i,j) = m(j,i) = T(rng.drand64(-1.0, 1.0));
+    if (k % 4 == 1) // repeated eigenvalues
+    {
+      m.set_identity();
+      m(0,0) = T(2);
+    }
+    if (k % 4 == 3) // already diagonal
+    {
+      m.fill(T(0));
+      for (unsigned int i = 0; i < n; ++i)
+        m(i,i) = T(n-i);
+    }
+    M.set(k, m);
+  }
+  vnl_symmetric_eigensystem_batch<T,n> eig(M);
+
+  double d_vec = 0, d_orth = 0, d_val = 0;
+  bool sorted = true;
+  vnl_matrix_fixed<T,n,n> I; I.set_identity();
+  for (std::size_t k = 0; k < count; ++k)
+  {
+    vnl_matrix_fixed<T,n,n> m = M.get(k), v = eig.V.get(k), dm(T(0));
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      dm(i,i) = eig.D(k,i,0);
+      if (i > 0 && dm(i,i) < dm(i-1,i-1)) sorted = false;
+    }
+    d_vec = std::max(d_vec, double((m*v - v*dm).absolute_value_max()));
+    d_orth = std::max(d_orth, double((v.transpose()*v - I).absolute_value_max()));
+    vnl_symmetric_eigensystem<T> ref(m.as_ref());
+    for (unsigned int i = 0; i < n; ++i)
+      d_val = std::max(d_val, std::fabs(double(ref.D(i,i) - dm(i,i))));
+  }
+  TEST_NEAR("M V = V D", d_vec, 0.0, tol);
+  TEST_NEAR("V orthogonal", d_orth, 0.0, tol);
+  TEST_NEAR("same eigenvalues as vnl_symmetric_eigensystem", d_val, 0.0, tol);
+  TEST("eigenvalues increasing", sorted, true);
+}
+
+static void test_svd_fixed_batch()
+{
+  test_svd_batch<double,3,3>(50, 1e-13, "double 3x3");
+  test_svd_batch<float,3,3>(50, 1e-5, "float 3x3");
+  test_svd_batch<double,3,4>(50, 1e-13, "double 3x4");
+  test_svd_batch<double,4,4>(50, 1e-13, "double 4x4");
+  test_svd_batch<float,4,4>(50, 1e-5, "float 4x4");
+  test_svd_batch<double,9,9>(20, 1e-12, "double 9x9");
+  test_svd_batch<double,3,3>(3000, 1e-13, "double 3x3");
+  test_homography_nullvector();
+
+  test_eigensystem_batch<double,3>(50, 1e-13, "double 3x3");
+  test_eigensystem_batch<float,3>(50, 1e-5, "float 3x3");
+  test_eigensystem_batch<double,2>(20, 1e-13, "double 2x2");
+  test_eigensystem_batch<double,4>(20, 1e-13, "double 4x4");
+  test_eigensystem_batch<double,3>(3000, 1e-13, "double 3x3");
+}
+
+TESTMAIN(test_svd_fixed_batch);
@@ -0,0 +1,478 @@
+// This is core/vnl/algo/vnl_blocked_factor.cxx
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "vnl_blocked_factor.h"
+//:
+// \file
+// \brief Recursive Cholesky, panel-blocked Householder QR, and the LAPACK calls
+//
+// The Cholesky factorization splits the matrix in two and recurses:
+// after factoring the leading block, the block below it is found by a
+// triangular solve and the trailing block is updated by a symmetric
+// rank-k product, and both of those recurse in the same way, so that
+// all but the O(n^2) work at the leaves is in large vnl_gemm() calls.
+//
+// The QR factorization works on panels of a few columns. Each panel is
+// factored one column at a time exactly as xqrdc does it, then its
+// Householder reflections are gathered into the compact WY form
+// $I - V T V^\top$ (T upper triangular, as LAPACK's xlarft) and applied
+// to the rest of the matrix with three vnl_gemm() calls.
+//
+// The factorizations work on the netlib column-major arrays in place.
+// Read row-major, the upper triangle of a column-major array is the
+// lower triangle, so the Cholesky code below works with a row-major
+// lower triangular L, $A = L L^\top$, whose rows are contiguous; and
+// the columns being reduced by QR are the contiguous rows of x.
+
+#include <vcl_compiler.h>
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_thread_pool.h>
+
+#ifdef VNL_ALGO_HAS_LAPACK
+// Fortran LAPACK. Lengths of character arguments are passed after the others.
+extern "C"
+{
+  void dpotrf_(char const* uplo, int const* n, double* a, int const* lda, int* info,
+               std::size_t);
+  void dgeqrf_(int const* m, int const* n, double* a, int const* lda, double* tau,
+               double* work, int const* lwork, int* info);
+  void sgeqrf_(int const* m, int const* n, float* a, int const* lda, float* tau,
+               float* work, int const* lwork, int* info);
+  void dgesdd_(char const* jobz, int const* m, int const* n, double* a, int const* lda,
+               double* s, double* u, int const* ldu, double* vt, int const* ldvt,
+               double* work, int const* lwork, int* iwork, int* info, std::size_t);
+  void sgesdd_(char const* jobz, int const* m, int const* n, float* a, int const* lda,
+               float* s, float* u, int const* ldu, float* vt, int const* ldvt,
+               float* work, int const* lwork, int* iwork, int* info, std::size_t);
+  void dsyevd_(char const* jobz, char const* uplo, int const* n, double* a, int const* lda,
+               double* w, double* work, int const* lwork, int* iwork, int const* liwork,
+               int* info, std::size_t, std::size_t);
+}
+static const bool vnl_blocked_factor_lapack_built = true;
+#else
+static const bool vnl_blocked_factor_lapack_built = false;
+#endif
+
+static std::atomic<bool> vnl_blocked_factor_lapack(vnl_blocked_factor_lapack_built);
+static std::atomic<unsigned> vnl_blocked_factor_size(128);
+
+bool vnl_blocked_factor_has_lapack()
+{
+  return vnl_blocked_factor_lapack_built;
+}
+
+bool vnl_blocked_factor_uses_lapack()
+{
+  return vnl_blocked_factor_lapack;
+}
+
+void vnl_blocked_factor_set_use_lapack(bool use)
+{
+  vnl_blocked_factor_lapack = use && vnl_blocked_factor_lapack_built;
+}
+
+unsigned vnl_blocked_factor_min_size()
+{
+  return vnl_blocked_factor_size;
+}
+
+void vnl_blocked_factor_set_min_size(unsigned n)
+{
+  vnl_blocked_factor_size = n;
+}
+
+//: The recursions stop at blocks of this size
+static const long vnl_blocked_factor_leaf = 32;
+
+//-----------------------------------------------------------------------------
+// Cholesky
+
+//: Unblocked Cholesky of the n x n lower triangle of a; returns 0 or the order of the first non-positive minor
+static long vnl_blocked_cholesky_leaf(double* a, long lda, long n)
+{
+  for (long j = 0; j < n; ++j)
+  {
+    double* aj = a + j*lda;
+    double s = aj[j];
+    for (long i = 0; i < j; ++i)
+      s -= aj[i]*aj[i];
+    if (s <= 0.0)
+      return j+1;
+    aj[j] = std::sqrt(s);
+    for (long r = j+1; r < n; ++r)
+    {
+      double* ar = a + r*lda;
+      double t = ar[j];
+      for (long i = 0; i < j; ++i)
+        t -= ar[i]*aj[i];
+      ar[j] = t / aj[j];
+    }
+  }
+  return 0;
+}
+
+//: Solve X L^T = B for the rows x rows of X, overwriting B, where L is k x k lower triangular
+static void vnl_blocked_trsm_leaf(double const* l, long ldl, long k,
+                                  double* b, long ldb, long rows)
+{
+  for (long r = 0; r < rows; ++r)
+  {
+    double* br = b + r*ldb;
+    for (long j = 0; j < k; ++j)
+    {
+      double const* lj = l + j*ldl;
+      double t = br[j];
+      for (long i = 0; i < j; ++i)
+        t -= br[i]*lj[i];
+      br[j] = t / lj[j];
+    }
+  }
+}
+
+static void vnl_blocked_trsm(double const* l, long ldl, long k,
+                             double* b, long ldb, long rows)
+{
+  if (k <= vnl_blocked_factor_leaf)
+  {
+    // the rows are independent
+    const long chunk = 64;
+    const long n_chunks = (rows + chunk - 1) / chunk;
+    if (n_chunks < 2 || rows*k*k < (1L << 16))
+      vnl_blocked_trsm_leaf(l, ldl, k, b, ldb, rows);
+    else
+      vnl_parallel_for(unsigned(n_chunks), [=](unsigned c)
+      {
+        const long r0 = long(c)*chunk;
+        vnl_blocked_trsm_leaf(l, ldl, k, b + r0*ldb, ldb, std::min(chunk, rows - r0));
+      });
+    return;
+  }
+  // [X1 X2] [L11 0; L21 L22]^T = [B1 B2]
+  const long k1 = k/2;
+  vnl_blocked_trsm(l, ldl, k1, b, ldb, rows);
+  vnl_gemm(false, true, unsigned(rows), unsigned(k - k1), unsigned(k1),
+           -1.0, b, unsigned(ldb), l + k1*ldl, unsigned(ldl),
+           1.0, b + k1, unsigned(ldb));
+  vnl_blocked_trsm(l + k1*ldl + k1, ldl, k - k1, b + k1, ldb, rows);
+}
+
+//: Lower triangle of the n x n matrix C -= A A^T, where A is n x k
+static void vnl_blocked_syrk(double* c, long ldc, long n,
+                             double const* a, long lda, long k)
+{
+  if (n <= vnl_blocked_factor_leaf)
+  {
+    double t[vnl_blocked_factor_leaf*vnl_blocked_factor_leaf];
+    vnl_gemm(false, true, unsigned(n), unsigned(n), unsigned(k),
+             1.0, a, unsigned(lda), a, unsigned(lda), 0.0, t, unsigned(n));
+    for (long i = 0; i < n; ++i)
+      for (long j = 0; j <= i; ++j)
+        c[i*ldc + j] -= t[i*n + j];
+    return;
+  }
+  const long n1 = n/2;
+  vnl_blocked_syrk(c, ldc, n1, a, lda, k);
+  vnl_gemm(false, true, unsigned(n - n1), unsigned(n1), unsigned(k),
+           -1.0, a + n1*lda, unsigned(lda), a, unsigned(lda),
+           1.0, c + n1*ldc, unsigned(ldc));
+  vnl_blocked_syrk(c + n1*ldc + n1, ldc, n - n1, a + n1*lda, lda, k);
+}
+
+static long vnl_blocked_cholesky_lower(double* a, long lda, long n)
+{
+  if (n <= vnl_blocked_factor_leaf)
+    return vnl_blocked_cholesky_leaf(a, lda, n);
+  // [L11 0; L21 L22] [L11 0; L21 L22]^T = [A11 .; A21 A22]
+  const long n1 = n/2;
+  long info = vnl_blocked_cholesky_lower(a, lda, n1);
+  if (info != 0)
+    return info;
+  double* a21 = a + n1*lda;
+  double* a22 = a21 + n1;
+  vnl_blocked_trsm(a, lda, n1, a21, lda, n - n1);
+  vnl_blocked_syrk(a22, lda, n - n1, a21, lda, n1);
+  info = vnl_blocked_cholesky_lower(a22, lda, n - n1);
+  return info != 0 ? info + n1 : 0;
+}
+
+long vnl_blocked_cholesky(double* a, long n)
+{
+#ifdef VNL_ALGO_HAS_LAPACK
+  if (vnl_blocked_factor_lapack)
+  {
+    const int ni = int(n);
+    int info = 0;
+    dpotrf_("U", &ni, a, &ni, &info, 1);
+    return info;
+  }
+#endif
+  return vnl_blocked_cholesky_lower(a, n, n);
+}
+
+//-----------------------------------------------------------------------------
+// QR
+
+//: Euclidean norm, rescaling only if the sum of squares under- or overflows
+template <class T>
+static T vnl_blocked_qr_norm(T const* x, long n)
+{
+  T s(0);
+  for (long i = 0; i < n; ++i)
+    s += x[i]*x[i];
+  if (s >= std::numeric_limits<T>::min() && s <= std::numeric_limits<T>::max())
+    return std::sqrt(s);
+  T scale(0);
+  for (long i = 0; i < n; ++i)
+    scale = std::max(scale, T(std::abs(x[i])));
+  if (!(scale > T(0)))
+    return scale;
+  s = T(0);
+  for (long i = 0; i < n; ++i)
+    s += (x[i]/scale)*(x[i]/scale);
+  return scale*std::sqrt(s);
+}
+
+template <class T>
+static void vnl_blocked_qr_native(T* x, long n, long p, T* qraux)
+{
+  const long lup = std::min(n, p);
+  const long nb = vnl_blocked_factor_leaf;
+  std::vector<T> vt, g, t(nb*nb), w, wt;
+  for (long k = 0; k < lup; k += nb)
+  {
+    const long kend = std::min(k + nb, lup);
+    const long kb = kend - k;
+
+    // The panel, as xqrdc: column l is scaled to the Householder vector u,
+    // with H = I - u u^T / u_l, and u_l is kept in qraux.
+    for (long l = k; l < kend; ++l)
+    {
+      qraux[l] = T(0);
+      if (l == n-1)
+        continue;
+      T* xl = x + l*n + l;
+      const long len = n - l;
+      T nrmxl = vnl_blocked_qr_norm(xl, len);
+      if (nrmxl == T(0))
+        continue;
+      if (xl[0] < T(0))
+        nrmxl = -nrmxl;
+      const T scale = T(1)/nrmxl;
+      for (long i = 0; i < len; ++i)
+        xl[i] *= scale;
+      xl[0] += T(1);
+      for (long j = l+1; j < kend; ++j)
+      {
+        T* xj = x + j*n + l;
+        T d(0);
+        for (long i = 0; i < len; ++i)
+          d += xl[i]*xj[i];
+        const T f = -d / xl[0];
+        for (long i = 0; i < len; ++i)
+          xj[i] += f*xl[i];
+      }
+      qraux[l] = xl[0];
+      xl[0] = -nrmxl;
+    }
+
+    const long ncols = p - kend;
+    if (ncols <= 0)
+      continue;
+    const long len = n - k;
+
+    // Rows of vt are the vectors u of the panel, zero above the diagonal,
+    // and H_i = I - tau_i u u^T with tau_i = 1/u_l.
+    vt.assign(kb*len, T(0));
+    for (long i = 0; i < kb; ++i)
+    {
+      const long l = k + i;
+      if (qraux[l] == T(0))
+        continue;
+      T* vi = &vt[i*len];
+      vi[i] = qraux[l];
+      std::copy(x + l*n + l + 1, x + (l+1)*n, vi + i + 1);
+    }
+
+    // H_0 H_1 ... H_{kb-1} = I - V T V^T, T upper triangular
+    g.resize(kb*kb);
+    vnl_gemm(false, true, unsigned(kb), unsigned(kb), unsigned(len),
+             T(1), &vt[0], unsigned(len), &vt[0], unsigned(len), T(0), &g[0], unsigned(kb));
+    std::fill(t.begin(), t.end(), T(0));
+    for (long i = 0; i < kb; ++i)
+    {
+      const T tau = qraux[k+i] == T(0) ? T(0) : T(1)/qraux[k+i];
+      t[i*kb + i] = tau;
+      for (long r = 0; r < i; ++r)
+      {
+        T s(0);
+        for (long c = r; c < i; ++c)
+          s += t[r*kb + c]*g[c*kb + i];
+        t[r*kb + i] = -tau*s;
+      }
+    }
+
+    // Q^T C = C - V T^T V^T C, done on the rows of x holding C^T:
+    // C^T -= ((C^T V) T) V^T
+    T* ct = x + kend*n + k;
+    w.resize(ncols*kb);
+    wt.resize(ncols*kb);
+    vnl_gemm(false, true, unsigned(ncols), unsigned(kb), unsigned(len),
+             T(1), ct, unsigned(n), &vt[0], unsigned(len), T(0), &w[0], unsigned(kb));
+    vnl_gemm(false, false, unsigned(ncols), unsigned(kb), unsigned(kb),
+             T(1), &w[0], unsigned(kb), &t[0], unsigned(kb), T(0), &wt[0], unsigned(kb));
+    vnl_gemm(false, false, unsigned(ncols), unsigned(len), unsigned(kb),
+             T(-1), &wt[0], unsigned(kb), &vt[0], unsigned(len), T(1), ct, unsigned(n));
+  }
+}
+
+#ifdef VNL_ALGO_HAS_LAPACK
+static void vnl_lapack_geqrf(int const* m, int const* n, double* a, int const* lda, double* tau,
+                             double* work, int const* lwork, int* info)
+{ dgeqrf_(m, n, a, lda, tau, work, lwork, info); }
+static void vnl_lapack_geqrf(int const* m, int const* n, float* a, int const* lda, float* tau,
+                             float* work, int const* lwork, int* info)
+{ sgeqrf_(m, n, a, lda, tau, work, lwork, info); }
+
+//: xgeqrf, then its reflections I - tau v v^T (v_l = 1) rewritten as xqrdc's I - u u^T/u_l
+template <class T>
+static bool vnl_blocked_qr_lapack(T* x, long n, long p, T* qraux)
+{
+  const int m = int(n), ni = int(p);
+  const long lup = std::min(n, p);
+  std::vector<T> tau(lup);
+  T size_query(0);
+  int lwork = -1, info = 0;
+  vnl_lapack_geqrf(&m, &ni, x, &m, &tau[0], &size_query, &lwork, &info);
+  lwork = std::max(1, int(size_query));
+  std::vector<T> work(lwork);
+  vnl_lapack_geqrf(&m, &ni, x, &m, &tau[0], &work[0], &lwork, &info);
+  if (info != 0)
+    return false;
+
+  for (long l = 0; l < lup; ++l)
+  {
+    T* xl = x + l*n + l;
+    qraux[l] = T(0);
+    if (l == n-1)
+      continue;
+    if (tau[l] != T(0))
+    {
+      // u = tau v
+      qraux[l] = tau[l];
+      for (long i = 1; i < n - l; ++i)
+        xl[i] *= tau[l];
+    }
+    else if (xl[0] != T(0))
+    {
+      // LAPACK leaves a column that is already zero below the diagonal
+      // alone, where xqrdc reflects it with u = 2 e_l, negating row l of R.
+      qraux[l] = T(2);
+      for (long j = l; j < p; ++j)
+        x[j*n + l] = -x[j*n + l];
+    }
+  }
+  return true;
+}
+#endif
+
+template <class T>
+static bool vnl_blocked_qr_any(T* x, long n, long p, T* qraux)
+{
+#ifdef VNL_ALGO_HAS_LAPACK
+  if (vnl_blocked_factor_lapack)
+    return vnl_blocked_qr_lapack(x, n, p, qraux);
+#endif
+  vnl_blocked_qr_native(x, n, p, qraux);
+  return true;
+}
+
+bool vnl_blocked_qr(double* x, long n, long p, double* qraux)
+{
+  return vnl_blocked_qr_any(x, n, p, qraux);
+}
+
+bool vnl_blocked_qr(float* x, long n, long p, float* qraux)
+{
+  return vnl_blocked_qr_any(x, n, p, qraux);
+}
+
+//-----------------------------------------------------------------------------
+// SVD and symmetric eigensystem
+
+#ifdef VNL_ALGO_HAS_LAPACK
+static void vnl_lapack_gesdd(int const* m, int const* n, double* a, double* s, double* u, double* vt,
+                             double* work, int const* lwork, int* iwork, int* info)
+{ dgesdd_("S", m, n, a, m, s, u, m, vt, n, work, lwork, iwork, info, 1); }
+static void vnl_lapack_gesdd(int const* m, int const* n, float* a, float* s, float* u, float* vt,
+                             float* work, int const* lwork, int* iwork, int* info)
+{ sgesdd_("S", m, n, a, m, s, u, m, vt, n, work, lwork, iwork, info, 1); }
+
+template <class T>
+static bool vnl_blocked_svd_lapack(T const* x, long n, long p, T* s, T* u, T* v)
+{
+  if (!vnl_blocked_factor_lapack || n < p)
+    return false;
+  const int m = int(n), ni = int(p);
+  std::vector<T> a(x, x + n*p), vt(p*p);
+  std::vector<int> iwork(8*p);
+  T size_query(0);
+  int lwork = -1, info = 0;
+  vnl_lapack_gesdd(&m, &ni, &a[0], s, u, &vt[0], &size_query, &lwork, &iwork[0], &info);
+  lwork = std::max(1, int(size_query));
+  std::vector<T> work(lwork);
+  vnl_lapack_gesdd(&m, &ni, &a[0], s, u, &vt[0], &work[0], &lwork, &iwork[0], &info);
+  if (info != 0)
+    return false;
+  for (long j = 0; j < p; ++j)
+    for (long i = 0; i < p; ++i)
+      v[i + j*p] = vt[j + i*p];
+  return true;
+}
+#endif
+
+bool vnl_blocked_svd(double const* x, long n, long p, double* s, double* u, double* v)
+{
+#ifdef VNL_ALGO_HAS_LAPACK
+  return vnl_blocked_svd_lapack(x, n, p, s, u, v);
+#else
+  (void)x; (void)n; (void)p; (void)s; (void)u; (void)v;
+  return false;
+#endif
+}
+
+bool vnl_blocked_svd(float const* x, long n, long p, float* s, float* u, float* v)
+{
+#ifdef VNL_ALGO_HAS_LAPACK
+  return vnl_blocked_svd_lapack(x, n, p, s, u, v);
+#else
+  (void)x; (void)n; (void)p; (void)s; (void)u; (void)v;
+  return false;
+#endif
+}
+
+bool vnl_blocked_symmetric_eigensystem(double const* a, long n, double* w, double* z)
+{
+#ifdef VNL_ALGO_HAS_LAPACK
+  if (!vnl_blocked_factor_lapack)
+    return false;
+  // a is symmetric, so its row-major and column-major readings agree
+  std::copy(a, a + n*n, z);
+  const int ni = int(n);
+  double size_query = 0;
+  int isize_query = 0, lwork = -1, liwork = -1, info = 0;
+  dsyevd_("V", "L", &ni, z, &ni, w, &size_query, &lwork, &isize_query, &liwork, &info, 1, 1);
+  lwork = std::max(1, int(size_query));
+  liwork = std::max(1, isize_query);
+  std::vector<double> work(lwork);
+  std::vector<int> iwork(liwork);
+  dsyevd_("V", "L", &ni, z, &ni, w, &work[0], &lwork, &iwork[0], &liwork, &info, 1, 1);
+  return info == 0;
+#else
+  (void)a; (void)n; (void)w; (void)z;
+  return false;
+#endif
+}
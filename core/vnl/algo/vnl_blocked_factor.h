@@ -0,0 +1,96 @@
+// This is core/vnl/algo/vnl_blocked_factor.h
+#ifndef vnl_blocked_factor_h_
+#define vnl_blocked_factor_h_
+//:
+// \file
+// \brief Blocked dense factorizations behind vnl_cholesky, vnl_qr, vnl_svd and vnl_symmetric_eigensystem
+//
+// The LINPACK and EISPACK routines used by those classes work one
+// column at a time, so for large matrices they are limited by memory
+// bandwidth rather than arithmetic. Once the matrix is at least
+// vnl_blocked_factor_min_size() in each dimension, the classes call the
+// functions below instead. Each one leaves its results in the same
+// layout as the netlib routine it replaces, so the rest of each class is
+// unchanged.
+//
+// If an external LAPACK was found when vnl_algo was configured (CMake
+// option VNL_CONFIG_USE_LAPACK), it is used for all four. Otherwise the
+// Cholesky and QR factorizations are done by blocked algorithms in which
+// nearly all the arithmetic is in vnl_gemm() products, and so vectorised
+// and multithreaded; the SVD and symmetric eigensystem functions return
+// false, and the classes keep using netlib.
+//
+// Results agree with the netlib routines to rounding error, but not to
+// the last bit; singular vectors and eigenvectors may differ in sign.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include <vnl/algo/vnl_algo_export.h>
+
+//: True if vnl_algo was built with an external LAPACK
+VNL_ALGO_EXPORT bool vnl_blocked_factor_has_lapack();
+
+//: True if the functions below use the external LAPACK
+// Initially the same as vnl_blocked_factor_has_lapack().
+VNL_ALGO_EXPORT bool vnl_blocked_factor_uses_lapack();
+
+//: Choose between the external LAPACK and the built-in blocked algorithms
+// Ignored if vnl_algo was built without LAPACK.
+VNL_ALGO_EXPORT void vnl_blocked_factor_set_use_lapack(bool use);
+
+//: Smallest dimension from which the decomposition classes use these functions (default 128)
+VNL_ALGO_EXPORT unsigned vnl_blocked_factor_min_size();
+
+//: Set the smallest dimension from which the decomposition classes use these functions
+VNL_ALGO_EXPORT void vnl_blocked_factor_set_min_size(unsigned n);
+
+//: Cholesky factorization in place, as LINPACK dpofa.
+// a is an n x n column-major array whose upper triangle holds the
+// symmetric matrix; on return the upper triangle holds R with
+// $A = R^\top R$ and the strict lower triangle is unchanged. Returns 0,
+// or k > 0 if the leading minor of order k is not positive definite.
+VNL_ALGO_EXPORT long vnl_blocked_cholesky(double* a, long n);
+
+//: QR factorization in place, as LINPACK xqrdc without pivoting.
+// x is an n x p column-major array. On return its upper triangle holds
+// R and the Householder vectors are stored below it and in qraux[0..min(n,p)-1],
+// exactly as xqrdc stores them, so xqrsl can use the result.
+// Returns false, doing nothing, for types it does not handle.
+template <class T>
+inline bool vnl_blocked_qr(T* /*x*/, long /*n*/, long /*p*/, T* /*qraux*/)
+{
+  return false;
+}
+
+VNL_ALGO_EXPORT bool vnl_blocked_qr(double* x, long n, long p, double* qraux);
+VNL_ALGO_EXPORT bool vnl_blocked_qr(float* x, long n, long p, float* qraux);
+
+//: Thin singular value decomposition, as LINPACK xsvdc with job 21.
+// x is an n x p column-major array with n >= p. The
+// p singular values are written to s in decreasing order, the left
+// singular vectors to the n x p column-major array u and the right ones
+// to the p x p column-major array v.
+// Returns false, doing nothing, when no LAPACK is in use, for types it
+// does not handle, or if the iteration did not converge.
+template <class T>
+inline bool vnl_blocked_svd(T const* /*x*/, long /*n*/, long /*p*/, T* /*s*/, T* /*u*/, T* /*v*/)
+{
+  return false;
+}
+
+VNL_ALGO_EXPORT bool vnl_blocked_svd(double const* x, long n, long p, double* s, double* u, double* v);
+VNL_ALGO_EXPORT bool vnl_blocked_svd(float const* x, long n, long p, float* s, float* u, float* v);
+
+//: Eigenvalues and eigenvectors of a symmetric matrix, as EISPACK rs.
+// a is an n x n symmetric array. The eigenvalues are
+// written to w in increasing order and the eigenvectors to the columns
+// of the n x n column-major array z.
+// Returns false when no LAPACK is in use or if the iteration did not
+// converge; z is then undefined.
+VNL_ALGO_EXPORT bool vnl_blocked_symmetric_eigensystem(double const* a, long n, double* w, double* z);
+
+#endif // vnl_blocked_factor_h_
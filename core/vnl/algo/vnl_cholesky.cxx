@@ -16,6 +16,7 @@
 #include <vcl_compiler.h>
 #include <vcl_cassert.h>
 #include <vnl/algo/vnl_netlib.h> // dpofa_(), dposl_(), dpoco_(), dpodi_()
+#include <vnl/algo/vnl_blocked_factor.h>
 
 //: Cholesky decomposition.
 // Make cholesky decomposition of M optionally computing
@@ -39,7 +40,10 @@ vnl_cholesky::vnl_cholesky(vnl_matrix<double> const & M, Operation mode):
 
   if (mode != estimate_condition) {
     // Quick factorization
-    v3p_netlib_dpofa_(A_.data_block(), &n, &n, &num_dims_rank_def_);
+    if (n >= long(vnl_blocked_factor_min_size()))
+      num_dims_rank_def_ = vnl_blocked_cholesky(A_.data_block(), n);
+    else
+      v3p_netlib_dpofa_(A_.data_block(), &n, &n, &num_dims_rank_def_);
     if (mode == verbose && num_dims_rank_def_ != 0)
       std::cerr << "vnl_cholesky: " << num_dims_rank_def_ << " dimensions of non-posdeffness\n";
   }
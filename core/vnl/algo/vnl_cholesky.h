@@ -15,6 +15,7 @@
 //   Peter Vanroose, Leuven, Apr 1998: added L() (return decomposition matrix)
 //   dac (Manchester) 26/03/2001: tidied up documentation
 //   Feb.2002 - Peter Vanroose - brief doxygen comment placed on single line
+//   Oct 2026 - large matrices are factored by vnl_blocked_cholesky()
 // \endverbatim
 
 #include <vnl/vnl_vector.h>
@@ -12,6 +12,7 @@
 // \verbatim
 //  Modifications
 //   19 June 2003 - Peter Vanroose - added cmplx* and vector<cmplx> interfaces
+//   Oct 2026 - any length N is supported, not only 2^p 3^q 5^r
 // \endverbatim
 
 #include <vector>
@@ -28,11 +29,11 @@ struct vnl_fft_1d : public vnl_fft_base<1, T>
 
   //: constructor takes length of signal.
   vnl_fft_1d(int N) {
-    base::factors_[0].resize(N);
+    base::set_size(0, N);
   }
 
   //: return length of signal.
-  unsigned int size() const { return base::factors_[0].number(); }
+  unsigned int size() const { return base::plans_[0]->size(); }
 
   //: dir = +1/-1 according to direction of transform.
   void transform(std::vector<std::complex<T> > &signal, int dir)
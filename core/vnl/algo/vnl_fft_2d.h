@@ -8,6 +8,11 @@
 // \file
 // \brief In-place 2D fast Fourier transform
 // \author fsm
+//
+// \verbatim
+//  Modifications
+//   Oct 2026 - any size is supported; added transforms of real signals
+// \endverbatim
 
 #include <vnl/vnl_matrix.h>
 #include <vnl/algo/vnl_fft_base.h>
@@ -21,8 +26,8 @@ struct vnl_fft_2d : public vnl_fft_base<2, T>
 
   //: constructor takes size of signal.
   vnl_fft_2d(int M, int N) {
-    base::factors_[0].resize(M);
-    base::factors_[1].resize(N);
+    base::set_size(0, M);
+    base::set_size(1, N);
   }
 
   //: dir = +1/-1 according to direction of transform.
@@ -37,9 +42,20 @@ struct vnl_fft_2d : public vnl_fft_base<2, T>
   void bwd_transform(vnl_matrix<std::complex<T> > &signal)
   { transform(signal, -1); }
 
+  //: forward FFT of a real signal.
+  // Only the cols()/2+1 columns of the transform that the others do not
+  // follow from, by conjugate symmetry, are computed and written to F.
+  // This costs about half as much as the complex transform.
+  void fwd_transform_real(vnl_matrix<T> const& signal, vnl_matrix<std::complex<T> >& F);
+
+  //: backward FFT of the left half of a conjugate-symmetric transform.
+  // F is as made by fwd_transform_real(); the result is real. Like
+  // bwd_transform(), this does not divide by the number of elements.
+  void bwd_transform_real(vnl_matrix<std::complex<T> > const& F, vnl_matrix<T>& signal);
+
   //: return size of signal.
-  unsigned rows() const { return base::factors_[0].number(); }
-  unsigned cols() const { return base::factors_[1].number(); }
+  unsigned rows() const { return base::plans_[0]->size(); }
+  unsigned cols() const { return base::plans_[1]->size(); }
 };
 
 #endif // vnl_fft_2d_h_
@@ -3,6 +3,31 @@
 // -*- c++ -*-
 
 #include "vnl_fft_2d.h"
+#include <vcl_cassert.h>
+
+template <class T>
+void vnl_fft_2d<T>::fwd_transform_real(vnl_matrix<T> const& signal, vnl_matrix<std::complex<T> >& F)
+{
+  assert(signal.rows() == rows() && signal.cols() == cols());
+  const unsigned M = rows(), N = cols(), H = N/2 + 1;
+  F.set_size(M, H);
+
+  // real transforms of the rows, then complex transforms of the H columns
+  base::plans_[1]->fwd_transform_real(signal.data_block(), F.data_block(), M, N, H);
+  base::plans_[0]->transform(F.data_block(), +1, H, H, 1);
+}
+
+template <class T>
+void vnl_fft_2d<T>::bwd_transform_real(vnl_matrix<std::complex<T> > const& F, vnl_matrix<T>& signal)
+{
+  const unsigned M = rows(), N = cols(), H = N/2 + 1;
+  assert(F.rows() == M && F.cols() == H);
+  signal.set_size(M, N);
+
+  vnl_matrix<std::complex<T> > G(F);
+  base::plans_[0]->transform(G.data_block(), -1, H, H, 1);
+  base::plans_[1]->bwd_transform_real(G.data_block(), signal.data_block(), M, H, N);
+}
 
 #undef VNL_FFT_2D_INSTANTIATE
 #define VNL_FFT_2D_INSTANTIATE(T) \
@@ -8,25 +8,35 @@
 // \file
 // \brief In-place n-D fast Fourier transform
 // \author fsm
+//
+// \verbatim
+//  Modifications
+//   Oct 2026 - transform through shared vnl_fft_plan objects instead of gpfa,
+//              so any signal size is supported
+// \endverbatim
 
 #include <complex>
 #include <vcl_compiler.h>
 #include <vnl/algo/vnl_algo_export.h>
 #include <vnl/algo/vnl_fft_prime_factors.h>
+#include <vnl/algo/vnl_fft_plan.h>
 
 //: Base class for in-place ND fast Fourier transform.
 
 VCL_TEMPLATE_EXPORT template <int D, class T>
 struct vnl_fft_base
 {
-  vnl_fft_base() { }
+  vnl_fft_base() { for (int i=0; i<D; ++i) plans_[i] = VXL_NULLPTR; }
 
   //: dir = +1/-1 according to direction of transform.
   void transform(std::complex<T> *signal, int dir);
 
  protected:
-  //: prime factorizations of signal dimensions.
-  vnl_fft_prime_factors<T> factors_[D];
+  //: set the size of dimension i of the signal.
+  void set_size(int i, int N) { plans_[i] = &vnl_fft_plan<T>::get(N); }
+
+  //: shared plans for the signal dimensions.
+  vnl_fft_plan<T> const* plans_[D];
 };
 
 #endif // vnl_fft_base_h_
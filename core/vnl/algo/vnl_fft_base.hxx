@@ -4,7 +4,7 @@
   fsm
 */
 #include "vnl_fft_base.h"
-#include <vnl/algo/vnl_fft.h>
+#include <vnl/algo/vnl_fft_plan.h>
 #include <vcl_cassert.h>
 
 template <int D, class T>
@@ -18,7 +18,7 @@ void vnl_fft_base<D, T>::transform(std::complex<T> *signal, int dir)
     int N2 = 1; // n[i]
     int N3 = 1; // n[i+1] n[i+2] ... n[D-1]
     for (int j=0; j<D; ++j) {
-      int d = factors_[j].number();
+      int d = plans_[j]->size();
       if (j <  i) N1 *= d;
       if (j == i) N2 *= d;
       if (j >  i) N3 *= d;
@@ -26,30 +26,13 @@ void vnl_fft_base<D, T>::transform(std::complex<T> *signal, int dir)
 
     // pretend the signal is N1xN2xN3. we want to transform
     // along the second dimension.
-    for (int n1=0; n1<N1; ++n1) {
-      // FIXME: we could avoid one loop by using the LOT parameter
-      // but it's not entirely clear that would save us anything.
-
-      for (int n3=0; n3<N3; ++n3) {
-        // This relies on the assumption that std::complex<T> is layout
-        // compatible with "struct { T real; T imag; }". It is probably
-        // a valid assumption for all sane C++ libraries.
-        T *data = (T *) (signal + n1*N2*N3 + n3);
-
-        long info = 0;
-        vnl_fft_gpfa (/* A */     data,
-                      /* B */     data + 1,
-                      /* TRIGS */ factors_[i].trigs (),
-                      /* INC */   2*N3,
-                      /* JUMP */  0,
-                      /* N */     N2,
-                      /* LOT */   1,
-                      /* ISIGN */ dir,
-                      /* NIPQ */  factors_[i].pqr (),
-                      /* INFO */  &info);
-        assert(info != -1);
-      }
-    }
+    if (N3 == 1)
+      // N1 contiguous signals of length N2
+      plans_[i]->transform(signal, dir, N1, 1, N2);
+    else
+      // for each n1, N3 signals interleaved element by element
+      for (int n1=0; n1<N1; ++n1)
+        plans_[i]->transform(signal + n1*N2*N3, dir, N3, N3, 1);
   }
 }
 
@@ -0,0 +1,132 @@
+// This is core/vnl/algo/vnl_fft_plan.h
+#ifndef vnl_fft_plan_h_
+#define vnl_fft_plan_h_
+//:
+// \file
+// \brief Precomputed mixed-radix fast Fourier transform of a given length
+//
+// A plan holds everything about a transform length that does not depend
+// on the data: its factorisation into radices and the twiddle factors
+// of every pass. Building one costs about as much as a few transforms,
+// so vnl_fft_plan<T>::get() keeps one plan per length for the lifetime
+// of the program and vnl_fft_1d, vnl_fft_2d and vil_fft use those.
+//
+// Any length is supported. Lengths whose prime factors are all at most
+// 31 are done by mixed-radix passes (specialised radix 2, 3, 4 and 5
+// butterflies, and a plain DFT for the other primes); other lengths use
+// Bluestein's algorithm on top of a power-of-two plan.
+//
+// The transform is unnormalised and uses the same sign convention as
+// vnl_fft_1d: for direction dir (+1 or -1)
+// \f[ X_k = \sum_{j=0}^{n-1} x_j e^{2 \pi i \, dir \, j k / n} \f]
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vnl/algo/vnl_algo_export.h>
+
+//: Precomputed 1D fast Fourier transform of length n.
+// Transforms are done on blocks of several signals ("lanes") at once,
+// with the lane index innermost, so that the butterflies of every pass
+// run across SIMD registers; the passes are compiled for the
+// instruction set selected by vnl_gemm_get_level(). Large batches are
+// shared between threads with vnl_parallel_for().
+//
+// The transform functions are const and use no shared scratch space, so
+// one plan may be used from several threads at once.
+VCL_TEMPLATE_EXPORT template <class T>
+class vnl_fft_plan
+{
+ public:
+  //: Build a plan for transforms of length n > 0
+  explicit vnl_fft_plan(unsigned n);
+
+  //: The shared plan for length n, built on first use.
+  // Thread safe. Plans are never destroyed before the program exits.
+  static vnl_fft_plan<T> const& get(unsigned n);
+
+  //: Length of the transform
+  unsigned size() const { return n_; }
+
+  //: True when the length has a prime factor too large for mixed-radix passes
+  bool uses_bluestein() const { return sub_ != VXL_NULLPTR; }
+
+  //: In-place transform of one contiguous signal; dir = +1 or -1.
+  void transform(std::complex<T>* data, int dir) const
+  { transform(data, dir, 1, 1, 0); }
+
+  //: In-place transform of lot signals.
+  // Element j of signal l is data[j*stride + l*dist], both counted in
+  // complex elements. Signals that are interleaved element by element
+  // (dist == 1, e.g. the columns of a row-major matrix) are the
+  // cheapest to gather.
+  void transform(std::complex<T>* data, int dir, unsigned lot,
+                 std::ptrdiff_t stride, std::ptrdiff_t dist) const;
+
+  //: Transform (dir = +1) of the real signal in[0..n-1].
+  // Writes the n/2+1 coefficients X_0 ... X_{n/2} to out; the rest
+  // follow from $X_{n-k} = \overline{X_k}$. For even n this costs about
+  // half a complex transform of length n.
+  void fwd_transform_real(T const* in, std::complex<T>* out) const
+  { fwd_transform_real(in, out, 1, 0, 0); }
+
+  //: Transforms (dir = +1) of lot real signals.
+  // Signal l starts at in + l*in_dist and its n/2+1 coefficients are
+  // written from out + l*out_dist.
+  void fwd_transform_real(T const* in, std::complex<T>* out, unsigned lot,
+                          std::ptrdiff_t in_dist, std::ptrdiff_t out_dist) const;
+
+  //: Backward transform (dir = -1) of a spectrum with Hermitian symmetry.
+  // in holds X_0 ... X_{n/2}; the real signal is written to out[0..n-1].
+  // Unnormalised: fwd_transform_real followed by this multiplies by n.
+  void bwd_transform_real(std::complex<T> const* in, T* out) const
+  { bwd_transform_real(in, out, 1, 0, 0); }
+
+  //: Backward transforms (dir = -1) of lot spectra with Hermitian symmetry.
+  // Spectrum l starts at in + l*in_dist and its real signal is written
+  // from out + l*out_dist.
+  void bwd_transform_real(std::complex<T> const* in, T* out, unsigned lot,
+                          std::ptrdiff_t in_dist, std::ptrdiff_t out_dist) const;
+
+ private:
+  unsigned n_;
+  //: radix of each pass, in order
+  std::vector<unsigned> radix_;
+  //: twiddle factors of all passes, (radix-1)*(n/length so far) per pass
+  std::vector<T> twr_, twi_;
+  //: roots of unity of all passes, radix per pass
+  std::vector<T> rootr_, rooti_;
+  //: exp(2 pi i k/n), k < n/2, for real transforms of even length
+  std::vector<T> halfr_, halfi_;
+
+  //: Bluestein: power-of-two plan of length m_ >= 2n-1, or null
+  vnl_fft_plan<T> const* sub_;
+  unsigned m_;
+  //: Bluestein: chirp exp(i pi j^2/n), j < n
+  std::vector<T> chirpr_, chirpi_;
+  //: Bluestein: transform of the conjugate chirp, divided by m_
+  std::vector<T> kernelr_, kerneli_;
+
+  //: dir = +1 transform of a block of lanes signals, held split into real and imaginary arrays.
+  // x and y each hold n*lanes values (m_*lanes for Bluestein); returns
+  // whichever of xr and yr holds the result, with its imaginary part at
+  // the same offset in xi or yi.
+  T* execute(T* xr, T* xi, T* yr, T* yi, std::size_t lanes) const;
+
+  //: Transform of signals [l0, l1) of a batch
+  void transform_block(std::complex<T>* data, int dir, unsigned l0, unsigned l1,
+                       std::ptrdiff_t stride, std::ptrdiff_t dist,
+                       std::vector<T>& work) const;
+
+  // not copyable
+  vnl_fft_plan(vnl_fft_plan<T> const&);
+  vnl_fft_plan<T>& operator=(vnl_fft_plan<T> const&);
+};
+
+#endif // vnl_fft_plan_h_
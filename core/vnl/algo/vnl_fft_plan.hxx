@@ -0,0 +1,603 @@
+// This is core/vnl/algo/vnl_fft_plan.hxx
+#ifndef vnl_fft_plan_hxx_
+#define vnl_fft_plan_hxx_
+//:
+// \file
+//
+// The passes are those of the Stockham autosort FFT. A pass of radix p
+// on a sequence of current length p*m reads the p sub-sequences
+// a_r = x[j + r*m] (j < m) from one buffer, combines them with a radix-p
+// butterfly, multiplies output u by the twiddle factor w^{ju} and writes
+// it to y[p*j + u] in the other buffer, so no bit-reversal permutation
+// is needed at the end.
+//
+// A block of L signals is transformed together, with the signal ("lane")
+// index innermost. Every element of the sequences above is then a run of
+// L numbers, and after passes of radices p_0 ... p_{s-1} it is a run of
+// L p_0 ... p_{s-1} numbers, contiguous in both buffers, which is the
+// innermost loop of every butterfly. Real and imaginary parts are kept
+// in separate arrays so that loop vectorises without shuffles.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "vnl_fft_plan.h"
+#include <vnl/vnl_math.h>
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_thread_pool.h>
+#include <vcl_cassert.h>
+
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && (defined(__x86_64__) || defined(__i386__))
+#define VNL_FFT_X86 1
+#define VNL_FFT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define VNL_FFT_TARGET_AVX512 __attribute__((target("avx512f")))
+#define VNL_FFT_INLINE inline __attribute__((always_inline))
+#else
+#define VNL_FFT_X86 0
+#define VNL_FFT_INLINE inline
+#endif
+
+//: Radix-2 pass; runs of sb numbers, m groups
+template <class T>
+VNL_FFT_INLINE void vnl_fft_pass2(std::size_t m, std::size_t sb, T const* twr, T const* twi,
+                                  T const* xr, T const* xi, T* yr, T* yi)
+{
+  const std::size_t ms = m*sb;
+  for (std::size_t j = 0; j < m; ++j)
+  {
+    T const* ar = xr + j*sb; T const* ai = xi + j*sb;
+    T* br = yr + 2*j*sb; T* bi = yi + 2*j*sb;
+    const T w1r = twr[j], w1i = twi[j];
+    for (std::size_t t = 0; t < sb; ++t)
+    {
+      const T a0r = ar[t], a0i = ai[t], a1r = ar[t+ms], a1i = ai[t+ms];
+      const T dr = a0r - a1r, di = a0i - a1i;
+      br[t] = a0r + a1r;        bi[t] = a0i + a1i;
+      br[t+sb] = dr*w1r - di*w1i; bi[t+sb] = dr*w1i + di*w1r;
+    }
+  }
+}
+
+//: Radix-3 pass
+template <class T>
+VNL_FFT_INLINE void vnl_fft_pass3(std::size_t m, std::size_t sb, T const* twr, T const* twi,
+                                  T const* rooti, T const* xr, T const* xi, T* yr, T* yi)
+{
+  const std::size_t ms = m*sb;
+  const T s3 = rooti[1]; // sin(2 pi/3)
+  for (std::size_t j = 0; j < m; ++j)
+  {
+    T const* ar = xr + j*sb; T const* ai = xi + j*sb;
+    T* br = yr + 3*j*sb; T* bi = yi + 3*j*sb;
+    const T w1r = twr[j], w1i = twi[j], w2r = twr[m+j], w2i = twi[m+j];
+    for (std::size_t t = 0; t < sb; ++t)
+    {
+      const T a0r = ar[t], a0i = ai[t];
+      const T a1r = ar[t+ms], a1i = ai[t+ms], a2r = ar[t+2*ms], a2i = ai[t+2*ms];
+      const T sr = a1r + a2r, si = a1i + a2i;
+      const T dr = s3*(a1r - a2r), di = s3*(a1i - a2i);
+      const T mr = a0r - T(0.5)*sr, mi = a0i - T(0.5)*si;
+      const T v1r = mr - di, v1i = mi + dr, v2r = mr + di, v2i = mi - dr;
+      br[t] = a0r + sr;             bi[t] = a0i + si;
+      br[t+sb] = v1r*w1r - v1i*w1i;   bi[t+sb] = v1r*w1i + v1i*w1r;
+      br[t+2*sb] = v2r*w2r - v2i*w2i; bi[t+2*sb] = v2r*w2i + v2i*w2r;
+    }
+  }
+}
+
+//: Radix-4 pass
+template <class T>
+VNL_FFT_INLINE void vnl_fft_pass4(std::size_t m, std::size_t sb, T const* twr, T const* twi,
+                                  T const* xr, T const* xi, T* yr, T* yi)
+{
+  const std::size_t ms = m*sb;
+  for (std::size_t j = 0; j < m; ++j)
+  {
+    T const* ar = xr + j*sb; T const* ai = xi + j*sb;
+    T* br = yr + 4*j*sb; T* bi = yi + 4*j*sb;
+    const T w1r = twr[j], w1i = twi[j], w2r = twr[m+j], w2i = twi[m+j],
+            w3r = twr[2*m+j], w3i = twi[2*m+j];
+    for (std::size_t t = 0; t < sb; ++t)
+    {
+      const T a0r = ar[t], a0i = ai[t], a1r = ar[t+ms], a1i = ai[t+ms];
+      const T a2r = ar[t+2*ms], a2i = ai[t+2*ms], a3r = ar[t+3*ms], a3i = ai[t+3*ms];
+      const T t0r = a0r + a2r, t0i = a0i + a2i, t1r = a0r - a2r, t1i = a0i - a2i;
+      const T t2r = a1r + a3r, t2i = a1i + a3i;
+      const T t3r = a3i - a1i, t3i = a1r - a3r; // i (a1 - a3)
+      const T v1r = t1r + t3r, v1i = t1i + t3i, v2r = t0r - t2r, v2i = t0i - t2i;
+      const T v3r = t1r - t3r, v3i = t1i - t3i;
+      br[t] = t0r + t2r;              bi[t] = t0i + t2i;
+      br[t+sb] = v1r*w1r - v1i*w1i;   bi[t+sb] = v1r*w1i + v1i*w1r;
+      br[t+2*sb] = v2r*w2r - v2i*w2i; bi[t+2*sb] = v2r*w2i + v2i*w2r;
+      br[t+3*sb] = v3r*w3r - v3i*w3i; bi[t+3*sb] = v3r*w3i + v3i*w3r;
+    }
+  }
+}
+
+//: Radix-5 pass
+template <class T>
+VNL_FFT_INLINE void vnl_fft_pass5(std::size_t m, std::size_t sb, T const* twr, T const* twi,
+                                  T const* rootr, T const* rooti,
+                                  T const* xr, T const* xi, T* yr, T* yi)
+{
+  const std::size_t ms = m*sb;
+  const T c1 = rootr[1], s1 = rooti[1], c2 = rootr[2], s2 = rooti[2];
+  for (std::size_t j = 0; j < m; ++j)
+  {
+    T const* ar = xr + j*sb; T const* ai = xi + j*sb;
+    T* br = yr + 5*j*sb; T* bi = yi + 5*j*sb;
+    T wr[4], wi[4];
+    for (unsigned int u = 0; u < 4; ++u)
+    {
+      wr[u] = twr[u*m+j]; wi[u] = twi[u*m+j];
+    }
+    for (std::size_t t = 0; t < sb; ++t)
+    {
+      const T a0r = ar[t], a0i = ai[t], a1r = ar[t+ms], a1i = ai[t+ms];
+      const T a2r = ar[t+2*ms], a2i = ai[t+2*ms], a3r = ar[t+3*ms], a3i = ai[t+3*ms];
+      const T a4r = ar[t+4*ms], a4i = ai[t+4*ms];
+      const T b1r = a1r + a4r, b1i = a1i + a4i, b2r = a2r + a3r, b2i = a2i + a3i;
+      const T d1r = a1r - a4r, d1i = a1i - a4i, d2r = a2r - a3r, d2i = a2i - a3i;
+      const T m1r = a0r + c1*b1r + c2*b2r, m1i = a0i + c1*b1i + c2*b2i;
+      const T m2r = a0r + c2*b1r + c1*b2r, m2i = a0i + c2*b1i + c1*b2i;
+      const T n1r = s1*d1r + s2*d2r, n1i = s1*d1i + s2*d2i;
+      const T n2r = s2*d1r - s1*d2r, n2i = s2*d1i - s1*d2i;
+      // outputs 1 to 4 are m1 + i n1, m2 + i n2, m2 - i n2, m1 - i n1
+      const T vr[4] = { m1r - n1i, m2r - n2i, m2r + n2i, m1r + n1i };
+      const T vi[4] = { m1i + n1r, m2i + n2r, m2i - n2r, m1i - n1r };
+      br[t] = a0r + b1r + b2r; bi[t] = a0i + b1i + b2i;
+      for (unsigned int u = 0; u < 4; ++u)
+      {
+        br[t+(u+1)*sb] = vr[u]*wr[u] - vi[u]*wi[u];
+        bi[t+(u+1)*sb] = vr[u]*wi[u] + vi[u]*wr[u];
+      }
+    }
+  }
+}
+
+//: Pass of any other radix p, as a plain DFT of length p
+template <class T>
+VNL_FFT_INLINE void vnl_fft_pass_dft(unsigned p, std::size_t m, std::size_t sb,
+                                     T const* twr, T const* twi, T const* rootr, T const* rooti,
+                                     T const* xr, T const* xi, T* yr, T* yi)
+{
+  const std::size_t ms = m*sb;
+  for (std::size_t j = 0; j < m; ++j)
+  {
+    T const* ar = xr + j*sb; T const* ai = xi + j*sb;
+    for (unsigned int u = 0; u < p; ++u)
+    {
+      T* br = yr + (p*j+u)*sb; T* bi = yi + (p*j+u)*sb;
+      for (std::size_t t = 0; t < sb; ++t)
+      {
+        br[t] = ar[t]; bi[t] = ai[t];
+      }
+      for (unsigned int r = 1; r < p; ++r)
+      {
+        const T cr = rootr[(r*u) % p], ci = rooti[(r*u) % p];
+        for (std::size_t t = 0; t < sb; ++t)
+        {
+          const T xr_ = ar[t+r*ms], xi_ = ai[t+r*ms];
+          br[t] += xr_*cr - xi_*ci;
+          bi[t] += xr_*ci + xi_*cr;
+        }
+      }
+      if (u == 0)
+        continue;
+      const T wr = twr[(u-1)*m+j], wi = twi[(u-1)*m+j];
+      for (std::size_t t = 0; t < sb; ++t)
+      {
+        const T vr = br[t], vi = bi[t];
+        br[t] = vr*wr - vi*wi;
+        bi[t] = vr*wi + vi*wr;
+      }
+    }
+  }
+}
+
+//: All passes of a plan over a block of lanes signals; returns the buffer holding the result
+template <class T>
+VNL_FFT_INLINE T* vnl_fft_passes(std::size_t n, std::size_t n_passes, unsigned const* radix,
+                                 T const* twr, T const* twi, T const* rootr, T const* rooti,
+                                 T* xr, T* xi, T* yr, T* yi, std::size_t lanes)
+{
+  std::size_t m = n, sb = lanes;
+  for (std::size_t s = 0; s < n_passes; ++s)
+  {
+    const unsigned p = radix[s];
+    m /= p;
+    switch (p)
+    {
+      case 2: vnl_fft_pass2(m, sb, twr, twi, xr, xi, yr, yi); break;
+      case 3: vnl_fft_pass3(m, sb, twr, twi, rooti, xr, xi, yr, yi); break;
+      case 4: vnl_fft_pass4(m, sb, twr, twi, xr, xi, yr, yi); break;
+      case 5: vnl_fft_pass5(m, sb, twr, twi, rootr, rooti, xr, xi, yr, yi); break;
+      default: vnl_fft_pass_dft(p, m, sb, twr, twi, rootr, rooti, xr, xi, yr, yi); break;
+    }
+    twr += (p-1)*m; twi += (p-1)*m;
+    rootr += p; rooti += p;
+    sb *= p;
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+  }
+  return xr;
+}
+
+template <class T>
+static T* vnl_fft_passes_generic(std::size_t n, std::size_t n_passes, unsigned const* radix,
+                                 T const* twr, T const* twi, T const* rootr, T const* rooti,
+                                 T* xr, T* xi, T* yr, T* yi, std::size_t lanes)
+{
+  return vnl_fft_passes(n, n_passes, radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+}
+
+#if VNL_FFT_X86
+template <class T>
+VNL_FFT_TARGET_AVX2 static T* vnl_fft_passes_avx2(std::size_t n, std::size_t n_passes, unsigned const* radix,
+                                                  T const* twr, T const* twi, T const* rootr, T const* rooti,
+                                                  T* xr, T* xi, T* yr, T* yi, std::size_t lanes)
+{
+  return vnl_fft_passes(n, n_passes, radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+}
+
+template <class T>
+VNL_FFT_TARGET_AVX512 static T* vnl_fft_passes_avx512(std::size_t n, std::size_t n_passes, unsigned const* radix,
+                                                      T const* twr, T const* twi, T const* rootr, T const* rooti,
+                                                      T* xr, T* xi, T* yr, T* yi, std::size_t lanes)
+{
+  return vnl_fft_passes(n, n_passes, radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+}
+#endif
+
+//: Largest prime done by mixed-radix passes; lengths with larger prime factors use Bluestein
+static const unsigned vnl_fft_max_radix = 31;
+
+//: Largest block of lanes, and the scratch space it may take
+static const unsigned vnl_fft_max_lanes = 16;
+static const std::size_t vnl_fft_block_bytes = 1 << 20;
+
+template <class T>
+vnl_fft_plan<T>::vnl_fft_plan(unsigned n)
+  : n_(n), sub_(VXL_NULLPTR), m_(0)
+{
+  assert(n > 0);
+
+  // fours first, then a two, then the odd primes in increasing order
+  std::vector<unsigned> radix;
+  unsigned long r = n;
+  while (r % 4 == 0) { radix.push_back(4); r /= 4; }
+  if (r % 2 == 0) { radix.push_back(2); r /= 2; }
+  for (unsigned long p = 3; p*p <= r; p += 2)
+    while (r % p == 0) { radix.push_back(unsigned(p)); r /= p; }
+  if (r > 1)
+    radix.push_back(unsigned(r));
+
+  if (!radix.empty() && radix.back() > vnl_fft_max_radix)
+  {
+    // Bluestein: X_k = b_k sum_j (x_j b_j) conj(b_{k-j}) with b_j = exp(i pi j^2/n),
+    // a convolution done with a power-of-two transform of length m_ >= 2n-1
+    m_ = 1;
+    while (m_ < 2*n-1)
+      m_ *= 2;
+    sub_ = &get(m_);
+    chirpr_.resize(n); chirpi_.resize(n);
+    for (unsigned j = 0; j < n; ++j)
+    {
+      const double a = vnl_math::pi * double((static_cast<unsigned long long>(j)*j) % (2ull*n)) / n;
+      chirpr_[j] = T(std::cos(a));
+      chirpi_[j] = T(std::sin(a));
+    }
+    std::vector<T> h(4*m_, T(0));
+    T* hr = &h[0]; T* hi = hr + m_;
+    for (unsigned j = 0; j < n; ++j)
+    {
+      hr[j] = chirpr_[j]; hi[j] = -chirpi_[j];
+      if (j > 0)
+      {
+        hr[m_-j] = chirpr_[j]; hi[m_-j] = -chirpi_[j];
+      }
+    }
+    T* kr = sub_->execute(hr, hi, hr + 2*m_, hi + 2*m_, 1);
+    T* ki = kr == hr ? hi : hi + 2*m_;
+    kernelr_.resize(m_); kerneli_.resize(m_);
+    for (unsigned k = 0; k < m_; ++k)
+    {
+      kernelr_[k] = kr[k] / T(m_);
+      kerneli_[k] = ki[k] / T(m_);
+    }
+  }
+  else
+  {
+    radix_ = radix;
+    unsigned long len = n;
+    for (std::size_t s = 0; s < radix_.size(); ++s)
+    {
+      const unsigned p = radix_[s];
+      const unsigned long m = len / p;
+      for (unsigned u = 1; u < p; ++u)
+        for (unsigned long j = 0; j < m; ++j)
+        {
+          const double a = vnl_math::twopi * double((j*u) % len) / double(len);
+          twr_.push_back(T(std::cos(a)));
+          twi_.push_back(T(std::sin(a)));
+        }
+      for (unsigned k = 0; k < p; ++k)
+      {
+        const double a = vnl_math::twopi * k / p;
+        rootr_.push_back(T(std::cos(a)));
+        rooti_.push_back(T(std::sin(a)));
+      }
+      len = m;
+    }
+  }
+
+  if (n % 2 == 0)
+  {
+    halfr_.resize(n/2); halfi_.resize(n/2);
+    for (unsigned k = 0; k < n/2; ++k)
+    {
+      const double a = vnl_math::twopi * k / n;
+      halfr_[k] = T(std::cos(a));
+      halfi_[k] = T(std::sin(a));
+    }
+  }
+}
+
+template <class T>
+vnl_fft_plan<T> const& vnl_fft_plan<T>::get(unsigned n)
+{
+  static std::mutex mutex;
+  static std::map<unsigned, std::unique_ptr<vnl_fft_plan<T> > > plans;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    typename std::map<unsigned, std::unique_ptr<vnl_fft_plan<T> > >::const_iterator it = plans.find(n);
+    if (it != plans.end())
+      return *it->second;
+  }
+  // Build outside the lock, as a Bluestein plan gets its power-of-two plan from here.
+  // If two threads build the same plan, the first one stored is kept.
+  std::unique_ptr<vnl_fft_plan<T> > plan(new vnl_fft_plan<T>(n));
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<vnl_fft_plan<T> >& slot = plans[n];
+  if (!slot)
+    slot = std::move(plan);
+  return *slot;
+}
+
+template <class T>
+T* vnl_fft_plan<T>::execute(T* xr, T* xi, T* yr, T* yi, std::size_t lanes) const
+{
+  if (!sub_)
+  {
+    unsigned const* radix = radix_.empty() ? VXL_NULLPTR : &radix_[0];
+    T const* twr = twr_.empty() ? VXL_NULLPTR : &twr_[0];
+    T const* twi = twi_.empty() ? VXL_NULLPTR : &twi_[0];
+    T const* rootr = rootr_.empty() ? VXL_NULLPTR : &rootr_[0];
+    T const* rooti = rooti_.empty() ? VXL_NULLPTR : &rooti_[0];
+#if VNL_FFT_X86
+    switch (vnl_gemm_get_level())
+    {
+      case vnl_gemm_avx512:
+        return vnl_fft_passes_avx512(n_, radix_.size(), radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+      case vnl_gemm_avx2:
+        return vnl_fft_passes_avx2(n_, radix_.size(), radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+      default:
+        break;
+    }
+#endif
+    return vnl_fft_passes_generic(n_, radix_.size(), radix, twr, twi, rootr, rooti, xr, xi, yr, yi, lanes);
+  }
+
+  // Bluestein. a = x b, zero padded to m_, into y
+  const std::size_t L = lanes, nL = std::size_t(n_)*L, mL = std::size_t(m_)*L;
+  for (std::size_t j = 0; j < n_; ++j)
+  {
+    const T br = chirpr_[j], bi = chirpi_[j];
+    for (std::size_t l = 0; l < L; ++l)
+    {
+      const T ar = xr[j*L+l], ai = xi[j*L+l];
+      yr[j*L+l] = ar*br - ai*bi;
+      yi[j*L+l] = ar*bi + ai*br;
+    }
+  }
+  std::fill(yr + nL, yr + mL, T(0));
+  std::fill(yi + nL, yi + mL, T(0));
+
+  // convolve with conj(b): multiply the transforms, and transform back
+  // as conj(transform(conj(.)))
+  T* cr = sub_->execute(yr, yi, xr, xi, L);
+  T* ci = cr == yr ? yi : xi;
+  for (std::size_t k = 0; k < m_; ++k)
+  {
+    const T hr = kernelr_[k], hi = kerneli_[k];
+    for (std::size_t l = 0; l < L; ++l)
+    {
+      const T vr = cr[k*L+l], vi = ci[k*L+l];
+      cr[k*L+l] = vr*hr - vi*hi;
+      ci[k*L+l] = -(vr*hi + vi*hr);
+    }
+  }
+  T* dr = sub_->execute(cr, ci, cr == yr ? xr : yr, cr == yr ? xi : yi, L);
+  T* di = dr == yr ? yi : xi;
+
+  // X = b conj(d)
+  for (std::size_t k = 0; k < n_; ++k)
+  {
+    const T br = chirpr_[k], bi = chirpi_[k];
+    for (std::size_t l = 0; l < L; ++l)
+    {
+      const T vr = dr[k*L+l], vi = -di[k*L+l];
+      xr[k*L+l] = vr*br - vi*bi;
+      xi[k*L+l] = vr*bi + vi*br;
+    }
+  }
+  return xr;
+}
+
+template <class T>
+void vnl_fft_plan<T>::transform_block(std::complex<T>* data, int dir, unsigned l0, unsigned l1,
+                                      std::ptrdiff_t stride, std::ptrdiff_t dist,
+                                      std::vector<T>& work) const
+{
+  const std::size_t L = l1 - l0, len = sub_ ? m_ : n_;
+  work.resize(4*len*L);
+  T* xr = &work[0]; T* xi = xr + len*L;
+  T* yr = xi + len*L; T* yi = yr + len*L;
+
+  // the backward transform is conj(forward(conj(x)))
+  const T sign = dir < 0 ? T(-1) : T(1);
+  for (std::size_t j = 0; j < n_; ++j)
+  {
+    std::complex<T> const* d = data + std::ptrdiff_t(j)*stride + std::ptrdiff_t(l0)*dist;
+    for (std::size_t l = 0; l < L; ++l)
+    {
+      std::complex<T> const& v = d[std::ptrdiff_t(l)*dist];
+      xr[j*L+l] = v.real();
+      xi[j*L+l] = sign*v.imag();
+    }
+  }
+  T* rr = execute(xr, xi, yr, yi, L);
+  T* ri = rr == xr ? xi : yi;
+  for (std::size_t j = 0; j < n_; ++j)
+  {
+    std::complex<T>* d = data + std::ptrdiff_t(j)*stride + std::ptrdiff_t(l0)*dist;
+    for (std::size_t l = 0; l < L; ++l)
+      d[std::ptrdiff_t(l)*dist] = std::complex<T>(rr[j*L+l], sign*ri[j*L+l]);
+  }
+}
+
+template <class T>
+void vnl_fft_plan<T>::transform(std::complex<T>* data, int dir, unsigned lot,
+                                std::ptrdiff_t stride, std::ptrdiff_t dist) const
+{
+  assert(dir == +1 || dir == -1);
+  if (lot == 0 || n_ == 1)
+    return;
+
+  // as many lanes as fit the scratch space, which is four buffers of len*lanes numbers
+  const std::size_t len = sub_ ? m_ : n_;
+  unsigned lanes = std::min(lot, vnl_fft_max_lanes);
+  while (lanes > 1 && 4*len*lanes*sizeof(T) > vnl_fft_block_bytes)
+    lanes /= 2;
+  const unsigned n_blocks = (lot + lanes - 1) / lanes;
+
+  // share large batches between threads, each with its own scratch space
+  unsigned n_parts = 1;
+  if (std::size_t(n_)*lot >= (1u << 15))
+    n_parts = std::min(n_blocks, vnl_thread_pool::hardware_threads());
+  if (n_parts <= 1)
+  {
+    std::vector<T> work;
+    for (unsigned b = 0; b < n_blocks; ++b)
+      transform_block(data, dir, b*lanes, std::min(lot, (b+1)*lanes), stride, dist, work);
+    return;
+  }
+  vnl_parallel_for(n_parts, [&](unsigned part)
+  {
+    std::vector<T> work;
+    for (unsigned b = part*n_blocks/n_parts; b < (part+1)*n_blocks/n_parts; ++b)
+      transform_block(data, dir, b*lanes, std::min(lot, (b+1)*lanes), stride, dist, work);
+  });
+}
+
+template <class T>
+void vnl_fft_plan<T>::fwd_transform_real(T const* in, std::complex<T>* out, unsigned lot,
+                                         std::ptrdiff_t in_dist, std::ptrdiff_t out_dist) const
+{
+  if (n_ % 2)
+  {
+    std::vector<std::complex<T> > z(std::size_t(n_)*lot);
+    for (std::size_t l = 0; l < lot; ++l)
+      std::copy(in + std::ptrdiff_t(l)*in_dist, in + std::ptrdiff_t(l)*in_dist + n_, z.begin() + l*n_);
+    transform(&z[0], +1, lot, 1, n_);
+    for (std::size_t l = 0; l < lot; ++l)
+      std::copy(z.begin() + l*n_, z.begin() + l*n_ + (n_/2 + 1), out + std::ptrdiff_t(l)*out_dist);
+    return;
+  }
+
+  // z_j = x_2j + i x_2j+1 has transform Z = E + i O, with E and O the
+  // transforms of the even and odd samples; then X_k = E_k + w^k O_k
+  const unsigned h = n_/2;
+  std::vector<std::complex<T> > zs(std::size_t(h)*lot);
+  for (std::size_t l = 0; l < lot; ++l)
+  {
+    T const* x = in + std::ptrdiff_t(l)*in_dist;
+    for (unsigned j = 0; j < h; ++j)
+      zs[l*h + j] = std::complex<T>(x[2*j], x[2*j+1]);
+  }
+  get(h).transform(&zs[0], +1, lot, 1, h);
+
+  for (std::size_t l = 0; l < lot; ++l)
+  {
+    std::complex<T> const* z = &zs[l*h];
+    std::complex<T>* X = out + std::ptrdiff_t(l)*out_dist;
+    X[0] = std::complex<T>(z[0].real() + z[0].imag(), T(0));
+    X[h] = std::complex<T>(z[0].real() - z[0].imag(), T(0));
+    for (unsigned k = 1; k < h; ++k)
+    {
+      const T ar = z[k].real(), ai = z[k].imag();
+      const T br = z[h-k].real(), bi = -z[h-k].imag();
+      const T er = T(0.5)*(ar + br), ei = T(0.5)*(ai + bi);
+      const T or_ = T(0.5)*(ai - bi), oi = T(-0.5)*(ar - br); // (a - b)/2i
+      const T wr = halfr_[k], wi = halfi_[k];
+      X[k] = std::complex<T>(er + or_*wr - oi*wi, ei + or_*wi + oi*wr);
+    }
+  }
+}
+
+template <class T>
+void vnl_fft_plan<T>::bwd_transform_real(std::complex<T> const* in, T* out, unsigned lot,
+                                         std::ptrdiff_t in_dist, std::ptrdiff_t out_dist) const
+{
+  if (n_ % 2)
+  {
+    std::vector<std::complex<T> > z(std::size_t(n_)*lot);
+    for (std::size_t l = 0; l < lot; ++l)
+    {
+      std::complex<T> const* X = in + std::ptrdiff_t(l)*in_dist;
+      for (unsigned k = 0; k < n_; ++k)
+        z[l*n_ + k] = 2*k <= n_ ? X[k] : std::conj(X[n_-k]);
+    }
+    transform(&z[0], -1, lot, 1, n_);
+    for (std::size_t l = 0; l < lot; ++l)
+      for (unsigned k = 0; k < n_; ++k)
+        out[std::ptrdiff_t(l)*out_dist + k] = z[l*n_ + k].real();
+    return;
+  }
+
+  // undo the combination in fwd_transform_real: Z_k = E_k + i O_k with
+  // E_k = X_k + conj(X_{h-k}) and O_k = (X_k - conj(X_{h-k})) w^-k
+  const unsigned h = n_/2;
+  std::vector<std::complex<T> > zs(std::size_t(h)*lot);
+  for (std::size_t l = 0; l < lot; ++l)
+  {
+    std::complex<T> const* X = in + std::ptrdiff_t(l)*in_dist;
+    for (unsigned k = 0; k < h; ++k)
+    {
+      const T ar = X[k].real(), ai = X[k].imag();
+      const T br = X[h-k].real(), bi = -X[h-k].imag();
+      const T er = ar + br, ei = ai + bi, dr = ar - br, di = ai - bi;
+      const T wr = halfr_[k], wi = -halfi_[k];
+      const T or_ = dr*wr - di*wi, oi = dr*wi + di*wr;
+      zs[l*h + k] = std::complex<T>(er - oi, ei + or_);
+    }
+  }
+  get(h).transform(&zs[0], -1, lot, 1, h);
+  for (std::size_t l = 0; l < lot; ++l)
+  {
+    T* x = out + std::ptrdiff_t(l)*out_dist;
+    for (unsigned j = 0; j < h; ++j)
+    {
+      x[2*j] = zs[l*h + j].real();
+      x[2*j+1] = zs[l*h + j].imag();
+    }
+  }
+}
+
+#undef VNL_FFT_PLAN_INSTANTIATE
+#define VNL_FFT_PLAN_INSTANTIATE(T) \
+template class VNL_ALGO_EXPORT vnl_fft_plan<T >
+
+#endif // vnl_fft_plan_hxx_
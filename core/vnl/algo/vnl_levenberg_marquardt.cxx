@@ -10,6 +10,10 @@
 //-----------------------------------------------------------------------------
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include "vnl_levenberg_marquardt.h"
 
 #include <vcl_cassert.h>
@@ -21,6 +25,7 @@
 #include <vnl/vnl_vector_ref.h>
 #include <vnl/vnl_matrix_ref.h>
 #include <vnl/vnl_least_squares_function.h>
+#include <vnl/vnl_thread_pool.h>
 #include <vnl/algo/vnl_netlib.h> // lmdif_()
 
 // see header
@@ -50,6 +55,8 @@ void vnl_levenberg_marquardt::init(vnl_least_squares_function* f)
   unsigned int n = f_->get_number_of_unknowns();  // I  Number of unknowns
 
   set_covariance_ = false;
+  max_threads_ = 1;
+  fd_out_of_evaluations_ = false;
   fdjac_.set_size(n,m);
   fdjac_.fill(0.0);
   ipvt_.set_size(n);
@@ -147,6 +154,9 @@ bool vnl_levenberg_marquardt::minimize_without_gradient(vnl_vector<double>& x)
     return false;
   }
 
+  if (f_->has_batch() || max_threads_ != 1)
+    return minimize_using_fd_jacobian(x);
+
   vnl_vector<double> fx(m, 0.0);    // W m   Storage for target vector
   vnl_vector<double> diag(n, 0);  // I     Multiplicative scale factors for variables
   long user_provided_scale_factors = 1;  // 1 is no, 2 is yes
@@ -203,6 +213,166 @@ bool vnl_levenberg_marquardt::minimize_without_gradient(vnl_vector<double>& x)
 
 //--------------------------------------------------------------------------------
 
+bool vnl_levenberg_marquardt::fd_jacobian(double* x, double const* fx, double* fJ)
+{
+  const unsigned int m = f_->get_number_of_residuals();
+  const unsigned int n = f_->get_number_of_unknowns();
+
+  // step lengths as chosen by fdjac2
+  const double eps = std::sqrt(std::max(epsfcn, std::numeric_limits<double>::epsilon()));
+  vnl_vector<double> h(n);
+  for (unsigned int j = 0; j < n; ++j) {
+    h[j] = eps * std::fabs(x[j]);
+    if (h[j] == 0.0)
+      h[j] = eps;
+  }
+
+  // Part k evaluates columns [k*n/parts, (k+1)*n/parts) with its own
+  // copy of the function, writing f(x + h_j e_j) straight into column j
+  const unsigned int parts = (unsigned int)clones_.size() + 1;
+  vnl_parallel_for(parts, [&](unsigned int k)
+  {
+    vnl_least_squares_function* f = k==0 ? f_ : clones_[k-1];
+    const unsigned int j0 = k*n/parts, j1 = (k+1)*n/parts;
+    if (j0 == j1)
+      return;
+    vnl_matrix<double> tx(j1-j0, n);
+    for (unsigned int r = 0; r < j1-j0; ++r) {
+      tx.set_row(r, x);
+      tx(r, j0+r) += h[j0+r];
+    }
+    vnl_matrix_ref<double> col(j1-j0, m, fJ + std::size_t(j0)*m);
+    f->f_batch(tx, col);
+    for (unsigned int r = 0; r < j1-j0; ++r) {
+      const double hj = h[j0+r];
+      double* cj = col[r];
+      for (unsigned int i = 0; i < m; ++i)
+        cj[i] = (cj[i] - fx[i]) / hj;
+    }
+  }, parts);
+
+  bool ok = !f_->failure;
+  f_->clear_failure();
+  for (unsigned int k = 0; k < clones_.size(); ++k) {
+    ok = ok && !clones_[k]->failure;
+    clones_[k]->clear_failure();
+  }
+  return ok;
+}
+
+void vnl_levenberg_marquardt::lmder_fdjac_lsqfun(long* n,     // I   Number of residuals
+                                                 long* p,     // I   Number of unknowns
+                                                 double* x,   // I   Solution vector, size n
+                                                 double* fx,  // IO  Residual vector f(x)
+                                                 double* fJ,  // O   m * n Jacobian f(x)
+                                                 long*,
+                                                 long* iflag, // I   1 -> calc fx, 2 -> calc fjac
+                                                 void* userdata)
+{
+  vnl_levenberg_marquardt* self =
+    static_cast<vnl_levenberg_marquardt*>(userdata);
+
+  if (*iflag == 2) {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    if (!self->fd_jacobian(x, fx, fJ))
+      *iflag = -1;
+    self->num_evaluations_ += *p;
+    if (self->verbose_)
+      std::cerr << "vnl_levenberg_marquardt: iteration " << self->num_iterations_ << ": "
+                << *p << " Jacobian columns on " << self->clones_.size()+1 << " thread(s) in "
+                << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-t0).count()
+                << " ms\n";
+    return;
+  }
+
+  // Everything else is as for lmdif, except that the evaluations of the
+  // Jacobian are not counted by lmder.
+  const bool evaluate = *iflag == 1;
+  lmdif_lsqfun(n, p, x, fx, iflag, userdata);
+  if (evaluate && ++(self->num_evaluations_) >= self->maxfev) {
+    self->fd_out_of_evaluations_ = true;
+    *iflag = -1;
+  }
+}
+
+//
+bool vnl_levenberg_marquardt::minimize_using_fd_jacobian(vnl_vector<double>& x)
+{
+  long m = f_->get_number_of_residuals(); // I  Number of residuals, must be > #unknowns
+  long n = f_->get_number_of_unknowns();  // I  Number of unknowns
+
+  // one copy of the function for each extra thread, if it can be copied
+  unsigned int threads = max_threads_ ? max_threads_ : vnl_thread_pool::hardware_threads();
+  threads = std::min(threads, (unsigned int)n);
+  for (unsigned int k = 1; k < threads; ++k) {
+    vnl_least_squares_function* c = f_->clone();
+    if (!c)
+      break;
+    clones_.push_back(c);
+  }
+
+  vnl_vector<double> fx(m, 0.0);
+  vnl_vector<double> diag(n, 0);
+  long mode = 1; // scale variables internally
+  double factor = 100;
+  long nprint = 1;
+  long nfev, njev;
+
+  vnl_vector<double> qtf(n, 0);
+  vnl_vector<double> wa1(n, 0);
+  vnl_vector<double> wa2(n, 0);
+  vnl_vector<double> wa3(n, 0);
+  vnl_vector<double> wa4(m, 0);
+
+  num_iterations_ = 0;
+  num_evaluations_ = 0;
+  fd_out_of_evaluations_ = false;
+  set_covariance_ = false;
+  long info;
+  start_error_ = 0; // Set to 0 so first call to lmdif_lsqfun will know to set it.
+  v3p_netlib_lmder_(
+          lmder_fdjac_lsqfun, &m, &n,
+          x.data_block(),
+          fx.data_block(),
+          fdjac_.data_block(), &m,
+          &ftol, &xtol, &gtol, &maxfev,
+          diag.data_block(),
+          &mode, &factor, &nprint,
+          &info, &nfev, &njev,
+          ipvt_.data_block(),
+          qtf.data_block(),
+          wa1.data_block(), wa2.data_block(), wa3.data_block(), wa4.data_block(),
+          this);
+  if (fd_out_of_evaluations_)
+    info = TOO_MANY_ITERATIONS;
+  failure_code_ = (ReturnCodes) info;
+
+  for (unsigned int k = 0; k < clones_.size(); ++k)
+    delete clones_[k];
+  clones_.clear();
+
+  // One more call to compute final error.
+  lmdif_lsqfun(&m,              // I    Number of residuals
+               &n,              // I    Number of unknowns
+               x.data_block(),  // I    Solution vector, size n
+               fx.data_block(), // O    Residual vector f(x)
+               &info, this);
+  end_error_ = fx.rms();
+
+  // Translate status code
+  switch ((int)failure_code_) {
+  case 1: // ftol
+  case 2: // xtol
+  case 3: // both
+  case 4: // gtol
+    return true;
+  default:
+    return false;
+  }
+}
+
+//--------------------------------------------------------------------------------
+
 void vnl_levenberg_marquardt::lmder_lsqfun(long* n,     // I   Number of residuals
                                            long* p,     // I   Number of unknowns
                                            double* x,  // I   Solution vector, size n
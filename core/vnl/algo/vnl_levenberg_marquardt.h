@@ -17,10 +17,13 @@
 //  RWMC 001097 Added verbose flag to get rid of all that blathering.
 //  AWF  151197 Added trace flag to increase blather.
 //   Feb.2002 - Peter Vanroose - brief doxygen comment placed on single line
+//   Oct 2026 - set_max_threads(): finite-difference Jacobian columns can be
+//              evaluated in batches on several threads.
 // \endverbatim
 //
 
 #include <iosfwd>
+#include <vector>
 #include <vcl_compiler.h>
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_vector_fixed.h>
@@ -38,6 +41,13 @@ class vnl_least_squares_function;
 //  one function evaluation per dimension, but is perfectly accurate.
 //  (See Hartley in ``Applications of Invariance in Computer Vision''
 //  for example).
+//
+//  Without derivatives, lmdif evaluates the Jacobian one column at a time.
+//  If the function implements f_batch(), or set_max_threads() allows more
+//  than one thread and the function implements clone(), the columns are
+//  instead evaluated in batches, split between threads that each use their
+//  own clone. The iterates are the same as lmdif's; only maxfev is checked
+//  once per function evaluation rather than once per iteration.
 
 class vnl_levenberg_marquardt : public vnl_nonlinear_minimizer
 {
@@ -78,6 +88,12 @@ class vnl_levenberg_marquardt : public vnl_nonlinear_minimizer
   //  it is an approximation of inverse of covariance
   vnl_matrix<double> const& get_JtJ();
 
+  //: Set the maximum number of threads used to evaluate a finite-difference Jacobian.
+  //  Zero means one per hardware thread. The default is 1. More than one
+  //  thread is only used if the cost function implements clone().
+  void set_max_threads(unsigned int n) { max_threads_ = n; }
+  unsigned int get_max_threads() const { return max_threads_; }
+
  protected:
 
   vnl_least_squares_function* f_;
@@ -87,14 +103,29 @@ class vnl_levenberg_marquardt : public vnl_nonlinear_minimizer
   vnl_matrix<double> inv_covar_;
   bool set_covariance_; // Set if covariance_ holds J'*J
 
+  unsigned int max_threads_;
+  // Copies of f_ used by the extra threads, during minimize_without_gradient()
+  std::vector<vnl_least_squares_function*> clones_;
+  bool fd_out_of_evaluations_;
+
   void init(vnl_least_squares_function* f);
 
+  //: minimize_without_gradient() using lmder and fd_jacobian()
+  bool minimize_using_fd_jacobian(vnl_vector<double>& x);
+
+  //: Forward-difference Jacobian at x, as in MINPACK fdjac2, into the m by n fortran order fJ.
+  //  Returns false if the cost function failed.
+  bool fd_jacobian(double* x, double const* fx, double* fJ);
+
   // Communication with callback
   static void lmdif_lsqfun(long* m, long* n, double* x,
                            double* fx, long* iflag, void* userdata);
   static void lmder_lsqfun(long* m, long* n, double* x,
                            double* fx, double* fJ, long*, long* iflag,
                            void* userdata);
+  static void lmder_fdjac_lsqfun(long* m, long* n, double* x,
+                                 double* fx, double* fJ, long*, long* iflag,
+                                 void* userdata);
 };
 
 //: Find minimum of "f", starting at "initial_estimate", and return.
@@ -21,6 +21,7 @@
 //   28/03/2001 - dac (Manchester) - tidied up documentation
 //   13 Jan.2003 - Peter Vanroose - added missing implementation for inverse(),
 //                                tinverse(), solve(matrix), extract_q_and_r().
+//   Oct 2026 - large float and double matrices are factored by vnl_blocked_qr()
 // \endverbatim
 
 #include <iosfwd>
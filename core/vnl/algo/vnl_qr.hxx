@@ -6,6 +6,7 @@
 // \author Andrew W. Fitzgibbon, Oxford RRG
 // \date   08 Dec 1996
 
+#include <algorithm>
 #include <iostream>
 #include <complex>
 #include "vnl_qr.h"
@@ -16,6 +17,7 @@
 #include <vnl/vnl_matlab_print.h>
 #include <vnl/vnl_complex_traits.h>
 #include <vnl/algo/vnl_netlib.h> // dqrdc_(), dqrsl_()
+#include <vnl/algo/vnl_blocked_factor.h>
 
 // use C++ overloading to call the right linpack routine from the template code:
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -51,6 +53,11 @@ vnl_qr<T>::vnl_qr(vnl_matrix<T> const& M):
   long do_pivot = 0; // Enable[!=0]/disable[==0] pivoting.
   jpvt_.fill(0); // Allow all columns to be pivoted if pivoting is enabled.
 
+  // Same result, in the same packed form, from the blocked factorization
+  if (std::min(r, c) >= long(vnl_blocked_factor_min_size()) &&
+      vnl_blocked_qr(qrdc_out_.data_block(), r, c, qraux_.data_block()))
+    return;
+
   vnl_vector<T> work(M.rows());
   vnl_linpack_qrdc(qrdc_out_.data_block(), // On output, UT is R, below diag is mangled Q
                    &r, &r, &c,
@@ -22,9 +22,12 @@
 #include <vnl/vnl_vector_ref.h>
 #include <vnl/vnl_crs_index.h>
 #include <vnl/vnl_sparse_lst_sqr_function.h>
+#include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_thread_pool.h>
 
 #include <vnl/algo/vnl_cholesky.h>
 #include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_sparse_lu.h>
 
 
 //: Initialize with the function object that is to be minimized.
@@ -55,7 +58,15 @@ vnl_sparse_lm::vnl_sparse_lm(vnl_sparse_lst_sqr_function& f)
    Y_(num_nz_),
    Z_(num_a_),
    Ma_(num_a_),
-   Mb_(num_b_)
+   Mb_(num_b_),
+   Sa_cholesky_(VXL_NULLPTR),
+   Sa_svd_(VXL_NULLPTR),
+   Sa_lu_(VXL_NULLPTR),
+   schur_solver_(schur_dense_cholesky),
+   pcg_tolerance_(1e-10),
+   pcg_max_iterations_(0),
+   pcg_iterations_(0),
+   max_threads_(0)
 {
   init(&f);
 }
@@ -81,6 +92,7 @@ void vnl_sparse_lm::init(vnl_sparse_lst_sqr_function* f)
 
 vnl_sparse_lm::~vnl_sparse_lm()
 {
+  clear_S_factors();
 }
 
 
@@ -102,8 +114,7 @@ bool vnl_sparse_lm::minimize(vnl_vector<double>& a,
     return false;
 
   //: Systems to solve will be Sc*dc=sec and Sa*da=sea
-  vnl_matrix<double> Sc(size_c_,size_c_), Sa(size_a_, size_a_);
-  vnl_vector<double> sec(size_c_), sea(size_a_);
+  vnl_vector<double> sea(size_a_);
   // update vectors
   vnl_vector<double> da(size_a_), db(size_b_), dc(size_c_);
 
@@ -124,6 +135,8 @@ bool vnl_sparse_lm::minimize(vnl_vector<double>& a,
 
   double sqr_error = e_.squared_magnitude();
   start_error_ = std::sqrt(sqr_error/e_.size()); // RMS error
+  pcg_iterations_ = 0;
+  failure_code_ = ERROR_FAILURE;
 
   for (num_iterations_=0; num_iterations_<(unsigned int)maxfev; ++num_iterations_)
   {
@@ -178,72 +191,44 @@ bool vnl_sparse_lm::minimize(vnl_vector<double>& a,
       // compute inv(Vj) and Yij
       compute_invV_Y();
 
+      // |I -W*inv(V)| * |U  W| * |da| = |I -W*inv(V)| * |ea|
+      // |0     I    |   |Wt V|   |db|   |0     I    |   |eb|
+      //
+      // premultiplying as shown above gives:
+      // |Sa 0| * |da| = |sea|
+      // |Wt V|   |db|   |eb |
+      //
+      // so we can first solve  Sa*da = sea  and then substitute to find db
+      // (with c parameters, dc is found first in the same way)
+      compute_S();
+
+      // this large factorisation is the bottle neck of this algorithm
+      factor_S();
+#ifdef DEBUG
+      if (schur_solver_ == schur_dense_cholesky)
+        std::cout << "singular values = "<< vnl_svd<double>(Sa_).W() <<std::endl;
+#endif
+
       if ( size_c_ > 0 )
       {
-        // compute Z = RYt-Q and Sa
-        compute_Z_Sa(Sa);
-
-        // this large inverse is the bottle neck of this algorithm
-        vnl_matrix<double> H;
-        vnl_cholesky Sa_cholesky(Sa,vnl_cholesky::quiet);
-        vnl_svd<double> *Sa_svd = VXL_NULLPTR;
-        // use SVD as a backup if Cholesky is deficient
-        if ( Sa_cholesky.rank_deficiency() > 0 )
-        {
-          Sa_svd = new vnl_svd<double>(Sa);
-          H = Sa_svd->inverse();
-        }
-        else
-          H = Sa_cholesky.inverse();
+        // compute Z = RYt-Q
+        compute_Z();
 
-        // construct the Ma = ZH
-        compute_Ma(H);
+        // construct the Ma = Z inv(Sa)
+        compute_Ma();
         // construct Mb = (R+MaW)inv(V)
         compute_Mb();
 
         // use Ma and Mb to solve for dc
         solve_dc(dc);
-
-        // compute sea from ea, Z, dc, Y, and eb
-        compute_sea(dc,sea);
-
-
-        if ( Sa_svd )
-          da = Sa_svd->solve(sea);
-        else
-          da = Sa_cholesky.solve(sea);
-        delete Sa_svd;
       }
-      else // size_c_ == 0
-      {
-        // |I -W*inv(V)| * |U  W| * |da| = |I -W*inv(V)| * |ea|
-        // |0     I    |   |Wt V|   |db|   |0     I    |   |eb|
-        //
-        // premultiplying as shown above gives:
-        // |Sa 0| * |da| = |sea|
-        // |Wt V|   |db|   |eb |
-        //
-        // so we can first solve  Sa*da = sea  and then substitute to find db
-
-        // compute Sa and sea
-        compute_Sa_sea(Sa,sea);
 
-#ifdef DEBUG
-        std::cout << "singular values = "<< vnl_svd<double>(Sa).W() <<std::endl;
-#endif
-        // We could use a faster solver here, maybe conjugate gradients?
-        // Solve the system  Sa*da = sea  for da
+      // compute sea from ea, Z, dc, Y, and eb
+      compute_sea(dc,sea);
 
-        vnl_cholesky Sa_cholesky(Sa,vnl_cholesky::quiet);
-        // use SVD as a backup if Cholesky is deficient
-        if ( Sa_cholesky.rank_deficiency() > 0 )
-        {
-          vnl_svd<double> Sa_svd(Sa);
-          da = Sa_svd.solve(sea);
-        }
-        else
-          da = Sa_cholesky.solve(sea);
-      }
+      // Solve the system  Sa*da = sea  for da
+      solve_S(sea, da);
+      clear_S_factors();
 
       // substitute da and dc to compute db
       backsolve_db(da, dc, db);
@@ -299,6 +284,9 @@ bool vnl_sparse_lm::minimize(vnl_vector<double>& a,
                  << " mu = " << std::setprecision(6) << std::setw(12) << mu
                  << " nu = " << nu << std::endl;
     }
+    // the step was too small to make any further progress
+    if (failure_code_ == CONVERGED_XTOL)
+      break;
   }
 
 
@@ -359,6 +347,24 @@ bool vnl_sparse_lm::check_vector_sizes(vnl_vector<double> const& a,
 }
 
 
+//: Number of parts to split n items into for sums with one copy per part
+static unsigned int vnl_sparse_lm_num_parts(unsigned int n, unsigned int max_threads)
+{
+  unsigned int threads = max_threads ? max_threads : vnl_thread_pool::hardware_threads();
+  unsigned int parts = threads > 1 ? 4*threads : 1;
+  return parts < n ? parts : n;
+}
+
+
+//: Position in S of block (i,h), which must be one of the blocks in row i
+static unsigned int vnl_sparse_lm_find_block(std::vector<unsigned int> const& start,
+                                             std::vector<unsigned int> const& cols,
+                                             unsigned int i, unsigned int h)
+{
+  return unsigned(std::lower_bound(cols.begin()+start[i], cols.begin()+start[i+1], h) - cols.begin());
+}
+
+
 //: allocate matrix memory by setting all the matrix sizes
 void vnl_sparse_lm::allocate_matrices()
 {
@@ -398,6 +404,53 @@ void vnl_sparse_lm::allocate_matrices()
     Mb_[j].set_size(size_c_, bj_size);
     inv_V_[j].set_size(bj_size,bj_size);
   }
+
+  allocate_schur();
+}
+
+
+//: find the nonzero blocks of the reduced system S
+void vnl_sparse_lm::allocate_schur()
+{
+  // CRS matrix of indices into e, A, B, C, W, Y
+  const vnl_crs_index& crs = f_->residual_indices();
+  // sparse vector iterator
+  typedef vnl_crs_index::sparse_vector::iterator sv_itr;
+
+  // S_ih is nonzero if a blocks i and h have residuals with a common b block
+  S_start_.assign(num_a_+1, 0);
+  S_cols_.clear();
+  S_diag_.resize(num_a_);
+  std::vector<int> seen(num_a_, -1);
+  std::vector<unsigned int> row_cols;
+  for (int i=0; i<num_a_; ++i)
+  {
+    // the diagonal block is always present
+    row_cols.assign(1, i);
+    seen[i] = i;
+    vnl_crs_index::sparse_vector row = crs.sparse_row(i);
+    for (sv_itr r_itr=row.begin(); r_itr!=row.end(); ++r_itr)
+    {
+      vnl_crs_index::sparse_vector col = crs.sparse_col(r_itr->second);
+      for (sv_itr c_itr=col.begin(); c_itr!=col.end(); ++c_itr)
+      {
+        if (seen[c_itr->second] != i)
+        {
+          seen[c_itr->second] = i;
+          row_cols.push_back(c_itr->second);
+        }
+      }
+    }
+    std::sort(row_cols.begin(), row_cols.end());
+    S_cols_.insert(S_cols_.end(), row_cols.begin(), row_cols.end());
+    S_start_[i+1] = unsigned(S_cols_.size());
+    S_diag_[i] = vnl_sparse_lm_find_block(S_start_, S_cols_, i, i);
+  }
+
+  S_.resize(S_cols_.size());
+  for (int i=0; i<num_a_; ++i)
+    for (unsigned int s=S_start_[i]; s<S_start_[i+1]; ++s)
+      S_[s].set_size(f_->number_of_params_a(i), f_->number_of_params_a(S_cols_[s]));
 }
 
 
@@ -409,55 +462,82 @@ void vnl_sparse_lm::compute_normal_equations()
   // sparse vector iterator
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
-  // clear the ea and eb for summation
+  // clear the ea, eb, ec and T for summation
   ea_.fill(0.0);
   eb_.fill(0.0);
   ec_.fill(0.0);
-  // clear the V for summation
-  for (unsigned int j=0; j<f_->number_of_b(); ++j)
-  {
-    V_[j].fill(0.0);
-    R_[j].fill(0.0);
-  }
   T_.fill(0.0);
   // compute blocks T, Q, R, U, V, W, ea, eb, and ec
   // JtJ = |T  Q  R|
   //       |Qt U  W|  with U and V block diagonal
   //       |Rt Wt V|  and W with same sparsity as residuals
-  for (unsigned int i=0; i<f_->number_of_a(); ++i)
+  //
+  // Ui, Qi, eai and the Wij of row i only depend on the residuals of a
+  // block i, and Vj, Rj and ebj only on those of b block j, so threads
+  // share out the rows and then the columns. T and ec sum over every
+  // residual, so each part of the rows sums its own copy.
+  const unsigned int n_parts = vnl_sparse_lm_num_parts(num_a_, max_threads_);
+  std::vector<vnl_matrix<double> > part_T(n_parts, T_);
+  std::vector<vnl_vector<double> > part_ec(n_parts, ec_);
+  vnl_parallel_for(n_parts, [&](unsigned int p)
   {
-    vnl_matrix<double>& Ui = U_[i];
-    Ui.fill(0.0);
-    vnl_matrix<double>& Qi = Q_[i];
-    Qi.fill(0.0);
-    unsigned int ai_size = f_->number_of_params_a(i);
-    vnl_vector_ref<double> eai(ai_size, ea_.data_block()+f_->index_a(i));
+    const int i_end = int(std::size_t(num_a_)*(p+1)/n_parts);
+    for (int i=int(std::size_t(num_a_)*p/n_parts); i<i_end; ++i)
+    {
+      vnl_matrix<double>& Ui = U_[i];
+      Ui.fill(0.0);
+      vnl_matrix<double>& Qi = Q_[i];
+      Qi.fill(0.0);
+      unsigned int ai_size = f_->number_of_params_a(i);
+      vnl_vector_ref<double> eai(ai_size, ea_.data_block()+f_->index_a(i));
+
+      vnl_crs_index::sparse_vector row = crs.sparse_row(i);
+      for (sv_itr r_itr=row.begin(); r_itr!=row.end(); ++r_itr)
+      {
+        unsigned int k = r_itr->first;
+        vnl_matrix<double>& Aij = A_[k];
+        vnl_matrix<double>& Bij = B_[k];
+        vnl_matrix<double>& Cij = C_[k];
+
+        vnl_fastops::inc_X_by_AtA(part_T[p], Cij); // T = C^T * C
+        vnl_fastops::inc_X_by_AtA(Ui,Aij);       // Ui += A_ij^T * A_ij
+        vnl_fastops::AtB(W_[k],Aij,Bij);          // Wij = A_ij^T * B_ij
+        vnl_fastops::inc_X_by_AtB(Qi,Cij,Aij);   // Qi += C_ij^T * A_ij
+
+        vnl_vector_ref<double> eij(f_->number_of_residuals(k), e_.data_block()+f_->index_e(k));
+        vnl_fastops::inc_X_by_AtB(eai,Aij,eij);  // e_a_i += A_ij^T * e_ij
+        vnl_fastops::inc_X_by_AtB(part_ec[p],Cij,eij); // e_c += C_ij^T * e_ij
+      }
+    }
+  }, max_threads_);
+  for (unsigned int p=0; p<n_parts; ++p)
+  {
+    T_ += part_T[p];
+    ec_ += part_ec[p];
+  }
 
-    vnl_crs_index::sparse_vector row = crs.sparse_row(i);
-    for (sv_itr r_itr=row.begin(); r_itr!=row.end(); ++r_itr)
+  vnl_parallel_for(num_b_, [&](unsigned int j)
+  {
+    vnl_matrix<double>& Vj = V_[j];
+    Vj.fill(0.0);
+    vnl_matrix<double>& Rj = R_[j];
+    Rj.fill(0.0);
+    vnl_vector_ref<double> ebj(Vj.rows(), eb_.data_block()+f_->index_b(j));
+
+    vnl_crs_index::sparse_vector col = crs.sparse_col(j);
+    for (sv_itr c_itr=col.begin(); c_itr!=col.end(); ++c_itr)
     {
-      unsigned int j = r_itr->second;
-      unsigned int k = r_itr->first;;
-      vnl_matrix<double>& Aij = A_[k];
+      unsigned int k = c_itr->first;
       vnl_matrix<double>& Bij = B_[k];
       vnl_matrix<double>& Cij = C_[k];
-      vnl_matrix<double>& Vj = V_[j];
-      vnl_matrix<double>& Rj = R_[j];
-      vnl_vector_ref<double> ebj(Bij.cols(), eb_.data_block()+f_->index_b(j));
 
-      vnl_fastops::inc_X_by_AtA(T_, Cij);       // T = C^T * C
-      vnl_fastops::inc_X_by_AtA(Ui,Aij);       // Ui += A_ij^T * A_ij
       vnl_fastops::inc_X_by_AtA(Vj,Bij);       // Vj += B_ij^T * B_ij
-      vnl_fastops::AtB(W_[k],Aij,Bij);          // Wij = A_ij^T * B_ij
-      vnl_fastops::inc_X_by_AtB(Qi,Cij,Aij);   // Qi += C_ij^T * A_ij
       vnl_fastops::inc_X_by_AtB(Rj,Cij,Bij);   // Rj += C_ij^T * B_ij
 
       vnl_vector_ref<double> eij(f_->number_of_residuals(k), e_.data_block()+f_->index_e(k));
-      vnl_fastops::inc_X_by_AtB(eai,Aij,eij);  // e_a_i += A_ij^T * e_ij
       vnl_fastops::inc_X_by_AtB(ebj,Bij,eij);  // e_b_j += B_ij^T * e_ij
-      vnl_fastops::inc_X_by_AtB(ec_,Cij,eij);   // e_c   += C_ij^T * e_ij
     }
-  }
+  }, max_threads_);
 }
 
 
@@ -511,7 +591,8 @@ void vnl_sparse_lm::compute_invV_Y()
   // sparse vector iterator
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
-  for (int j=0; j<num_b_; ++j) {
+  vnl_parallel_for(num_b_, [&](unsigned int j)
+  {
     vnl_matrix<double>& inv_Vj = inv_V_[j];
     vnl_cholesky Vj_cholesky(V_[j],vnl_cholesky::quiet);
     // use SVD as a backup if Cholesky is deficient
@@ -529,86 +610,269 @@ void vnl_sparse_lm::compute_invV_Y()
       unsigned int k = c_itr->first;
       Y_[k] = W_[k]*inv_Vj;  // Y_ij = W_ij * inv(V_j)
     }
-  }
+  }, max_threads_);
 }
 
 
-// compute Z and Sa
-void vnl_sparse_lm::compute_Z_Sa(vnl_matrix<double>& Sa)
+//: compute the blocks of S
+void vnl_sparse_lm::compute_S()
 {
   // CRS matrix of indices into e, A, B, C, W, Y
   const vnl_crs_index& crs = f_->residual_indices();
   // sparse vector iterator
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
-  // compute Z = RYt-Q and Sa
-  for (int i=0; i<num_a_; ++i)
+  // S_ii = U_i - sum_j Y_ij * W_ij^T  and  S_ih = - sum_j Y_ij * W_hj^T
+  // Each block row i computes its blocks with h >= i; the blocks below
+  // the diagonal are then copied from their transposes.
+  vnl_parallel_for(num_a_, [&](unsigned int i)
   {
+    for (unsigned int s=S_diag_[i]+1; s<S_start_[i+1]; ++s)
+      S_[s].fill(0.0);
+    S_[S_diag_[i]] = U_[i];
+
     vnl_crs_index::sparse_vector row_i = crs.sparse_row(i);
+    for (sv_itr ri = row_i.begin(); ri != row_i.end(); ++ri)
+    {
+      vnl_matrix<double>& Yij = Y_[ri->first];
+      // both column j and row i of S are in increasing order of h
+      vnl_crs_index::sparse_vector col_j = crs.sparse_col(ri->second);
+      unsigned int s = S_diag_[i];
+      for (sv_itr ch = col_j.begin(); ch != col_j.end(); ++ch)
+      {
+        const unsigned int h = ch->second;
+        if (h < i)
+          continue;
+        while (S_cols_[s] < h)
+          ++s;
+        vnl_fastops::dec_X_by_ABt(S_[s],Yij,W_[ch->first]); // S_ih -= Y_ij * W_hj^T
+      }
+    }
+  }, max_threads_);
+
+  vnl_parallel_for(num_a_, [&](unsigned int h)
+  {
+    for (unsigned int s=S_start_[h]; s<S_diag_[h]; ++s)
+      S_[s] = S_[vnl_sparse_lm_find_block(S_start_, S_cols_, S_cols_[s], h)].transpose();
+  }, max_threads_);
+}
+
+
+//: compute Z = RYt-Q
+void vnl_sparse_lm::compute_Z()
+{
+  // CRS matrix of indices into e, A, B, C, W, Y
+  const vnl_crs_index& crs = f_->residual_indices();
+  // sparse vector iterator
+  typedef vnl_crs_index::sparse_vector::iterator sv_itr;
+
+  vnl_parallel_for(num_a_, [&](unsigned int i)
+  {
     vnl_matrix<double>& Zi = Z_[i];
     Zi.fill(0.0);
     Zi -= Q_[i];
 
-    // handle the diagonal blocks separately
-    vnl_matrix<double> Sii(U_[i]); // copy Ui to initialize Sii
+    vnl_crs_index::sparse_vector row_i = crs.sparse_row(i);
     for (sv_itr ri = row_i.begin(); ri != row_i.end();  ++ri)
-    {
-      unsigned int j = ri->second;
-      unsigned int k = ri->first;
-      vnl_matrix<double>& Yij = Y_[k];
-      vnl_fastops::dec_X_by_ABt(Sii,Yij,W_[k]); // S_ii -= Y_ij * W_ij^T
-      vnl_fastops::inc_X_by_ABt(Zi,R_[j],Yij);  // Z_i  += R_j * Y_ij^T
-    }
-    Sa.update(Sii,f_->index_a(i),f_->index_a(i));
+      vnl_fastops::inc_X_by_ABt(Zi,R_[ri->second],Y_[ri->first]);  // Z_i  += R_j * Y_ij^T
+  }, max_threads_);
+}
+
 
-    // handle the (symmetric) off diagonal blocks
-    for (int h=i+1; h<num_a_; ++h)
+//: factor S (or prepare to solve with it) using the chosen solver
+void vnl_sparse_lm::factor_S()
+{
+  clear_S_factors();
+  switch (schur_solver_)
+  {
+   case schur_sparse_lu:
+   {
+    vnl_sparse_matrix<double> S(size_a_, size_a_);
+    std::vector<int> cols;
+    std::vector<double> vals;
+    for (int i=0; i<num_a_; ++i)
     {
-      vnl_crs_index::sparse_vector row_h = crs.sparse_row(h);
-      vnl_matrix<double> Sih(f_->number_of_params_a(i),
-                             f_->number_of_params_a(h), 0.0);
-
-      // iterate through both sparse rows finding matching columns
-      bool row_done = false;
-      for (sv_itr ri = row_i.begin(), rh = row_h.begin();
-           ri != row_i.end() && rh != row_h.end();  ++ri, ++rh)
+      for (unsigned int r=0; r<f_->number_of_params_a(i); ++r)
       {
-        while (!row_done && ri->second != rh->second)
+        cols.clear();
+        vals.clear();
+        for (unsigned int s=S_start_[i]; s<S_start_[i+1]; ++s)
         {
-          while (!row_done && ri->second < rh->second)
-            row_done = (++ri == row_i.end());
-          while (!row_done && rh->second < ri->second)
-            row_done = (++rh == row_h.end());
+          const vnl_matrix<double>& Sih = S_[s];
+          const int h0 = f_->index_a(S_cols_[s]);
+          for (unsigned int c=0; c<Sih.cols(); ++c)
+          {
+            cols.push_back(h0+c);
+            vals.push_back(Sih(r,c));
+          }
         }
-        if (row_done)
-          break;
-        // S_ih -= Y_ij * W_hj^T
-        vnl_fastops::dec_X_by_ABt(Sih,Y_[ri->first],W_[rh->first]);
+        S.set_row(f_->index_a(i)+r, cols, vals);
       }
-      // this should also be a symmetric matrix
-      Sa.update(Sih,f_->index_a(i),f_->index_a(h));
-      Sa.update(Sih.transpose(),f_->index_a(h),f_->index_a(i));
     }
+    Sa_lu_ = new vnl_sparse_lu(S);
+    break;
+   }
+   case schur_pcg:
+    inv_S_diag_.resize(num_a_);
+    vnl_parallel_for(num_a_, [&](unsigned int i)
+    {
+      const vnl_matrix<double>& Sii = S_[S_diag_[i]];
+      vnl_cholesky Sii_cholesky(Sii,vnl_cholesky::quiet);
+      // use SVD as a backup if Cholesky is deficient
+      if ( Sii_cholesky.rank_deficiency() > 0 )
+        inv_S_diag_[i] = vnl_svd<double>(Sii).inverse();
+      else
+        inv_S_diag_[i] = Sii_cholesky.inverse();
+    }, max_threads_);
+    break;
+   default:
+    Sa_.set_size(size_a_, size_a_);
+    Sa_.fill(0.0);
+    for (int i=0; i<num_a_; ++i)
+      for (unsigned int s=S_start_[i]; s<S_start_[i+1]; ++s)
+        Sa_.update(S_[s],f_->index_a(i),f_->index_a(S_cols_[s]));
+    Sa_cholesky_ = new vnl_cholesky(Sa_,vnl_cholesky::quiet);
+    // use SVD as a backup if Cholesky is deficient
+    if ( Sa_cholesky_->rank_deficiency() > 0 )
+      Sa_svd_ = new vnl_svd<double>(Sa_);
+    break;
   }
 }
 
 
-//: compute Ma
-void vnl_sparse_lm::compute_Ma(const vnl_matrix<double>& H)
+//: solve S x = rhs using the results of factor_S()
+void vnl_sparse_lm::solve_S(vnl_vector<double> const& rhs, vnl_vector<double>& x)
 {
-  // construct Ma = ZH
-  vnl_matrix<double> Hik;
+  if ( Sa_svd_ )
+  {
+    x = Sa_svd_->solve(rhs);
+    return;
+  }
+  if ( Sa_cholesky_ )
+  {
+    x = Sa_cholesky_->solve(rhs);
+    return;
+  }
+  x.set_size(size_a_);
+  if ( Sa_lu_ )
+  {
+    Sa_lu_->solve(rhs, &x);
+    return;
+  }
+
+  // conjugate gradients, preconditioned by the inverse diagonal blocks of S
+  const unsigned int max_iter = pcg_max_iterations_ ? pcg_max_iterations_ : size_a_;
+  const double stop = pcg_tolerance_*rhs.magnitude();
+  vnl_vector<double> r(rhs), z(size_a_), p(size_a_), q(size_a_);
+  x.fill(0.0);
   for (int i=0; i<num_a_; ++i)
   {
-    vnl_matrix<double>& Mai = Ma_[i];
-    Mai.fill(0.0);
+    vnl_vector_ref<double> zi(f_->number_of_params_a(i), z.data_block()+f_->index_a(i));
+    const vnl_vector_ref<double> ri(f_->number_of_params_a(i), r.data_block()+f_->index_a(i));
+    vnl_fastops::Ab(zi,inv_S_diag_[i],ri);
+  }
+  p = z;
+  double rz = dot_product(r,z);
+  for (unsigned int it=0; it<max_iter && r.magnitude() > stop; ++it)
+  {
+    multiply_S(p, q);
+    const double pq = dot_product(p,q);
+    if (pq <= 0.0) // S is not positive definite along p
+      break;
+    const double alpha = rz/pq;
+    for (int n=0; n<size_a_; ++n)
+    {
+      x[n] += alpha*p[n];
+      r[n] -= alpha*q[n];
+    }
+    for (int i=0; i<num_a_; ++i)
+    {
+      vnl_vector_ref<double> zi(f_->number_of_params_a(i), z.data_block()+f_->index_a(i));
+      const vnl_vector_ref<double> ri(f_->number_of_params_a(i), r.data_block()+f_->index_a(i));
+      vnl_fastops::Ab(zi,inv_S_diag_[i],ri);
+    }
+    const double rz_new = dot_product(r,z);
+    const double beta = rz_new/rz;
+    rz = rz_new;
+    for (int n=0; n<size_a_; ++n)
+      p[n] = z[n] + beta*p[n];
+    ++pcg_iterations_;
+  }
+}
+
 
-    for (int k=0; k<num_a_; ++k)
+//: y = S x
+void vnl_sparse_lm::multiply_S(vnl_vector<double> const& x, vnl_vector<double>& y) const
+{
+  y.set_size(size_a_);
+  vnl_parallel_for(num_a_, [&](unsigned int i)
+  {
+    double* yi = y.data_block()+f_->index_a(i);
+    const unsigned int ni = f_->number_of_params_a(i);
+    std::fill(yi, yi+ni, 0.0);
+    for (unsigned int s=S_start_[i]; s<S_start_[i+1]; ++s)
     {
-      Hik.set_size(f_->number_of_params_a(i), f_->number_of_params_a(k));
-      H.extract(Hik,f_->index_a(i), f_->index_a(k));
-      vnl_fastops::inc_X_by_AB(Mai, Z_[k], Hik);
+      const vnl_matrix<double>& Sih = S_[s];
+      const double* xh = x.data_block()+f_->index_a(S_cols_[s]);
+      for (unsigned int r=0; r<ni; ++r)
+      {
+        const double* Sr = Sih[r];
+        double sum = 0.0;
+        for (unsigned int c=0; c<Sih.cols(); ++c)
+          sum += Sr[c]*xh[c];
+        yi[r] += sum;
+      }
     }
+  }, max_threads_);
+}
+
+
+//: release the results of factor_S()
+void vnl_sparse_lm::clear_S_factors()
+{
+  delete Sa_cholesky_; Sa_cholesky_ = VXL_NULLPTR;
+  delete Sa_svd_; Sa_svd_ = VXL_NULLPTR;
+  delete Sa_lu_; Sa_lu_ = VXL_NULLPTR;
+}
+
+
+//: compute Ma
+void vnl_sparse_lm::compute_Ma()
+{
+  if ( Sa_cholesky_ )
+  {
+    // this large inverse is the bottle neck of this algorithm
+    const vnl_matrix<double> H = Sa_svd_ ? Sa_svd_->inverse() : Sa_cholesky_->inverse();
+
+    // construct Ma = ZH
+    vnl_parallel_for(num_a_, [&](unsigned int i)
+    {
+      vnl_matrix<double>& Mai = Ma_[i];
+      Mai.fill(0.0);
+
+      vnl_matrix<double> Hki;
+      for (int k=0; k<num_a_; ++k)
+      {
+        Hki.set_size(f_->number_of_params_a(k), f_->number_of_params_a(i));
+        H.extract(Hki,f_->index_a(k), f_->index_a(i));
+        vnl_fastops::inc_X_by_AB(Mai, Z_[k], Hki);
+      }
+    }, max_threads_);
+    return;
+  }
+
+  // Ma = Z inv(S), and S is symmetric, so row r of Ma solves S m = z
+  // where z is row r of Z
+  vnl_vector<double> z(size_a_), m;
+  for (int r=0; r<size_c_; ++r)
+  {
+    for (int i=0; i<num_a_; ++i)
+      for (unsigned int c=0; c<Z_[i].cols(); ++c)
+        z[f_->index_a(i)+c] = Z_[i](r,c);
+    solve_S(z, m);
+    for (int i=0; i<num_a_; ++i)
+      for (unsigned int c=0; c<Ma_[i].cols(); ++c)
+        Ma_[i](r,c) = m[f_->index_a(i)+c];
   }
 }
 
@@ -621,12 +885,10 @@ void vnl_sparse_lm::compute_Mb()
   // sparse vector iterator
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
-  vnl_matrix<double> temp;
   // construct Mb = (-R-MaW)inv(V)
-  for (int j=0; j<num_b_; ++j)
+  vnl_parallel_for(num_b_, [&](unsigned int j)
   {
-    temp.set_size(size_c_,f_->number_of_params_b(j));
-    temp.fill(0.0);
+    vnl_matrix<double> temp(size_c_,f_->number_of_params_b(j), 0.0);
     temp -= R_[j];
 
     vnl_crs_index::sparse_vector col = crs.sparse_col(j);
@@ -637,7 +899,7 @@ void vnl_sparse_lm::compute_Mb()
       vnl_fastops::dec_X_by_AB(temp,Ma_[i],W_[k]);
     }
     vnl_fastops::AB(Mb_[j],temp,inv_V_[j]);
-  }
+  }, max_threads_);
 }
 
 
@@ -692,80 +954,22 @@ void vnl_sparse_lm::compute_sea(vnl_vector<double> const& dc,
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
   sea = ea_; // initialize se to ea_
-  for (int i=0; i<num_a_; ++i)
+  vnl_parallel_for(num_a_, [&](unsigned int i)
   {
     vnl_vector_ref<double> sei(f_->number_of_params_a(i),sea.data_block()+f_->index_a(i));
     vnl_crs_index::sparse_vector row_i = crs.sparse_row(i);
 
-    vnl_fastops::inc_X_by_AtB(sei,Z_[i],dc);
-
-    for (sv_itr ri = row_i.begin(); ri != row_i.end();  ++ri)
-    {
-      unsigned int k = ri->first;
-      vnl_matrix<double>& Yij = Y_[k];
-      vnl_vector_ref<double> ebj(Yij.cols(), eb_.data_block()+f_->index_b(ri->second));
-      sei -= Yij*ebj;  // se_i -= Y_ij * e_b_j
-    }
-  }
-}
-
-
-//: compute Sa and sea
-// only used when size_c_ == 0
-void vnl_sparse_lm::compute_Sa_sea(vnl_matrix<double>& Sa,
-                                   vnl_vector<double>& sea)
-{
-  // CRS matrix of indices into e, A, B, C, W, Y
-  const vnl_crs_index& crs = f_->residual_indices();
-  // sparse vector iterator
-  typedef vnl_crs_index::sparse_vector::iterator sv_itr;
-
-  sea = ea_; // initialize se to ea_
-  for (int i=0; i<num_a_; ++i)
-  {
-    vnl_vector_ref<double> sei(f_->number_of_params_a(i),sea.data_block()+f_->index_a(i));
-    vnl_crs_index::sparse_vector row_i = crs.sparse_row(i);
+    if ( size_c_ > 0 )
+      vnl_fastops::inc_X_by_AtB(sei,Z_[i],dc);
 
-    // handle the diagonal blocks and computation of se separately
-    vnl_matrix<double> Sii(U_[i]); // copy Ui to initialize Sii
     for (sv_itr ri = row_i.begin(); ri != row_i.end();  ++ri)
     {
       unsigned int k = ri->first;
       vnl_matrix<double>& Yij = Y_[k];
-      vnl_fastops::dec_X_by_ABt(Sii,Yij,W_[k]); // S_ii -= Y_ij * W_ij^T
       vnl_vector_ref<double> ebj(Yij.cols(), eb_.data_block()+f_->index_b(ri->second));
       sei -= Yij*ebj;  // se_i -= Y_ij * e_b_j
     }
-    Sa.update(Sii,f_->index_a(i),f_->index_a(i));
-
-    // handle the (symmetric) off diagonal blocks
-    for (int h=i+1; h<num_a_; ++h)
-    {
-      vnl_crs_index::sparse_vector row_h = crs.sparse_row(h);
-      vnl_matrix<double> Sih(f_->number_of_params_a(i),f_->number_of_params_a(h),0.0);
-
-      // iterate through both sparse rows finding matching columns
-      bool row_done = false;
-      for (sv_itr ri = row_i.begin(), rh = row_h.begin();
-           ri != row_i.end() && rh != row_h.end();  ++ri, ++rh)
-      {
-        while (!row_done && ri->second != rh->second)
-        {
-          while (!row_done && ri->second < rh->second)
-            row_done = (++ri == row_i.end());
-          while (!row_done && rh->second < ri->second)
-            row_done = (++rh == row_h.end());
-        }
-        if (row_done)
-          break;
-        // S_ih -= Y_ij * W_hj^T
-        vnl_fastops::dec_X_by_ABt(Sih,Y_[ri->first],W_[rh->first]);
-      }
-      // this should also be a symmetric matrix
-      Sa.update(Sih,f_->index_a(i),f_->index_a(h));
-      Sa.update(Sih.transpose(),f_->index_a(h),f_->index_a(i));
-    }
-  }
+  }, max_threads_);
 }
 
 
@@ -779,7 +983,7 @@ void vnl_sparse_lm::backsolve_db(vnl_vector<double> const& da,
   // sparse vector iterator
   typedef vnl_crs_index::sparse_vector::iterator sv_itr;
 
-  for (int j=0; j<num_b_; ++j)
+  vnl_parallel_for(num_b_, [&](unsigned int j)
   {
     vnl_vector<double> seb(eb_.data_block()+f_->index_b(j),f_->number_of_params_b(j));
     vnl_crs_index::sparse_vector col = crs.sparse_col(j);
@@ -797,7 +1001,7 @@ void vnl_sparse_lm::backsolve_db(vnl_vector<double> const& da,
     }
     vnl_vector_ref<double> dbi(f_->number_of_params_b(j),db.data_block()+f_->index_b(j));
     vnl_fastops::Ab(dbi,inv_V_[j],seb);
-  }
+  }, max_threads_);
 }
 
 //------------------------------------------------------------------------------
@@ -13,6 +13,9 @@
 // \verbatim
 //  Modifications
 //   Mar 15, 2010  MJL - Modified to handle 'c' parameters (globals)
+//   Oct 2026 - Normal equations and Schur complement built in parallel;
+//              the reduced system is stored by blocks and can be solved
+//              by sparse LU or preconditioned conjugate gradients
 // \endverbatim
 //
 
@@ -24,6 +27,9 @@
 #include <vnl/vnl_nonlinear_minimizer.h>
 
 class vnl_sparse_lst_sqr_function;
+class vnl_cholesky;
+class vnl_sparse_lu;
+template <class T> class vnl_svd;
 
 //: Sparse Levenberg Marquardt nonlinear least squares
 //  Unlike vnl_levenberg_marquardt this does not use the MINPACK routines.
@@ -31,9 +37,31 @@ class vnl_sparse_lst_sqr_function;
 //  the Hartley and Zisserman "Multiple View Geometry" book and further
 //  described in a technical report on sparse bundle adjustment available
 //  at http://www.ics.forth.gr/~lourakis/sba
+//
+//  Eliminating the b parameters leaves the reduced system S da = sea
+//  in the a parameters (the Schur complement of the b blocks), which
+//  has a nonzero block S_ih wherever a blocks i and h share a b block.
+//  By default S is assembled densely and solved by Cholesky
+//  factorisation, whose cost grows with the cube of the number of a
+//  parameters. For problems with many a blocks set_schur_solver() can
+//  choose a sparse LU factorisation of the nonzero blocks or conjugate
+//  gradients preconditioned by the inverses of the diagonal blocks.
+//
+//  The normal equations, S and the back substitution are computed in
+//  parallel over a blocks and b blocks; see set_max_threads().
 class vnl_sparse_lm : public vnl_nonlinear_minimizer
 {
  public:
+  //: Methods for solving the reduced system in the a parameters
+  enum schur_solver_type
+  {
+    //: Dense Cholesky factorisation (SVD if that fails)
+    schur_dense_cholesky = 0,
+    //: Sparse LU factorisation of the nonzero blocks (vnl_sparse_lu)
+    schur_sparse_lu,
+    //: Block Jacobi preconditioned conjugate gradients
+    schur_pcg
+  };
 
   //: Initialize with the function object that is to be minimized.
   vnl_sparse_lm(vnl_sparse_lst_sqr_function& f);
@@ -67,6 +95,25 @@ class vnl_sparse_lm : public vnl_nonlinear_minimizer
   //: Access the final weights after optimization
   const vnl_vector<double>& get_weights() const { return weights_; }
 
+  //: Set the method used to solve the reduced system (default schur_dense_cholesky)
+  void set_schur_solver(schur_solver_type s) { schur_solver_ = s; }
+  schur_solver_type get_schur_solver() const { return schur_solver_; }
+
+  //: Stop conjugate gradients once the residual falls below tol times its initial size (default 1e-10)
+  void set_pcg_tolerance(double tol) { pcg_tolerance_ = tol; }
+  double get_pcg_tolerance() const { return pcg_tolerance_; }
+
+  //: Maximum conjugate gradient iterations per solve; zero (the default) means the number of a parameters
+  void set_pcg_max_iterations(unsigned int n) { pcg_max_iterations_ = n; }
+  unsigned int get_pcg_max_iterations() const { return pcg_max_iterations_; }
+
+  //: Total conjugate gradient iterations in the last minimization
+  unsigned long get_pcg_iterations() const { return pcg_iterations_; }
+
+  //: Maximum number of threads; zero (the default) means one per hardware thread
+  void set_max_threads(unsigned int n) { max_threads_ = n; }
+  unsigned int get_max_threads() const { return max_threads_; }
+
 protected:
 
   //: used to compute the initial damping
@@ -80,6 +127,9 @@ protected:
   void init(vnl_sparse_lst_sqr_function* f);
 
 private:
+  // not copyable: the factors of S are owned by pointer
+  vnl_sparse_lm(vnl_sparse_lm const&);
+  vnl_sparse_lm& operator=(vnl_sparse_lm const&);
 
   //: allocate matrix memory by setting all the matrix sizes
   void allocate_matrices();
@@ -101,11 +151,29 @@ private:
   //: compute all inv(Vi) and Yij
   void compute_invV_Y();
 
-  //: compute Z and Sa
-  void compute_Z_Sa(vnl_matrix<double>& Sa);
+  //: find the nonzero blocks of the reduced system S
+  void allocate_schur();
+
+  //: compute the blocks of S
+  void compute_S();
+
+  //: compute Z = RYt-Q
+  void compute_Z();
+
+  //: factor S (or prepare to solve with it) using the chosen solver
+  void factor_S();
+
+  //: solve S x = rhs using the results of factor_S()
+  void solve_S(vnl_vector<double> const& rhs, vnl_vector<double>& x);
+
+  //: y = S x
+  void multiply_S(vnl_vector<double> const& x, vnl_vector<double>& y) const;
+
+  //: release the results of factor_S()
+  void clear_S_factors();
 
   //: compute Ma
-  void compute_Ma(const vnl_matrix<double>& H);
+  void compute_Ma();
 
   //: compute Mb
   void compute_Mb();
@@ -117,10 +185,6 @@ private:
   void compute_sea(vnl_vector<double> const& dc,
                    vnl_vector<double>& sea);
 
-  //: compute Sa and sea
-  // only used when size_c_ == 0
-  void compute_Sa_sea(vnl_matrix<double>& Sa, vnl_vector<double>& sea);
-
   //: back solve to find db using da and dc
   void backsolve_db(vnl_vector<double> const& da,
                     vnl_vector<double> const& dc,
@@ -168,6 +232,28 @@ private:
   std::vector<vnl_matrix<double> > Ma_;
   std::vector<vnl_matrix<double> > Mb_;
 
+  //: Blocks of the reduced system S, row by row
+  // Row i holds S_ih for each h in S_cols_[S_start_[i]] to S_cols_[S_start_[i+1]-1],
+  // in increasing order of h.
+  std::vector<vnl_matrix<double> > S_;
+  std::vector<unsigned int> S_start_;
+  std::vector<unsigned int> S_cols_;
+  //: Position of S_ii in S_ for each i
+  std::vector<unsigned int> S_diag_;
+
+  //: Factors of S
+  vnl_matrix<double> Sa_;
+  vnl_cholesky* Sa_cholesky_;
+  vnl_svd<double>* Sa_svd_;
+  vnl_sparse_lu* Sa_lu_;
+  //: inverses of the diagonal blocks of S, the conjugate gradient preconditioner
+  std::vector<vnl_matrix<double> > inv_S_diag_;
+
+  schur_solver_type schur_solver_;
+  double pcg_tolerance_;
+  unsigned int pcg_max_iterations_;
+  unsigned long pcg_iterations_;
+  unsigned int max_threads_;
 };
 
 
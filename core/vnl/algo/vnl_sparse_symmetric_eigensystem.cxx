@@ -81,6 +81,7 @@ int vnl_sparse_symmetric_eigensystem::CalculateNPairs(vnl_sparse_matrix<double>&
                                                       long nfigures)
 {
   mat = &M;
+  csr_mat = vnl_sparse_matrix_csr<double>(M);
 
   // Clear current vectors.
   if (vectors) {
@@ -214,6 +215,8 @@ int vnl_sparse_symmetric_eigensystem::CalculateNPairs(
 {
   mat = &A;
   Bmat = &B;
+  csr_mat = vnl_sparse_matrix_csr<double>(A);
+  csr_Bmat = vnl_sparse_matrix_csr<double>(B);
 
   // Clear current vectors.
   if (vectors) {
@@ -375,7 +378,7 @@ int vnl_sparse_symmetric_eigensystem::CalculateNPairs(
         case -1:
             // Performing y <- OP*x for the first time when mode != 2.
             if (mode != 2)
-              B.mult(x, z);
+              csr_Bmat.mult(x, z);
             // no "break;" - initialization continues below
         case  1:
             // Performing y <- OP*w.
@@ -383,13 +386,13 @@ int vnl_sparse_symmetric_eigensystem::CalculateNPairs(
               opLU.solve(z, &y);
             else
               {
-              A.mult(x, workVector);
+              csr_mat.mult(x, workVector);
               x.update(workVector);
               opLU.solve(x, &y);
               }
           break;
         case  2:
-            B.mult(x, y);
+            csr_Bmat.mult(x, y);
           break;
         default:
             break;
@@ -446,7 +449,7 @@ int vnl_sparse_symmetric_eigensystem::CalculateProduct(int n, int m,
                                                        double* q)
 {
   // Call the special multiply method on the matrix.
-  mat->mult(n,m,p,q);
+  csr_mat.mult(n,m,p,q);
 
   return 0;
 }
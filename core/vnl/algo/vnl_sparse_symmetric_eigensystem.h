@@ -15,10 +15,12 @@
 //  28 Mar 2001: dac (Manchester) - tidied up documentation
 //  17 Dec 2010: Michael Bowers - added generalized sparse symmetric eigensystem
 //                                solver (see 2nd CalculateNPairs() method)
+//  Oct 2026: products use vnl_sparse_matrix_csr copies of the matrices
 // \endverbatim
 
 #include <vector>
 #include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_sparse_matrix_csr.h>
 #include <vcl_compiler.h>
 
 //: Find the eigenvalues of a sparse symmetric matrix
@@ -77,6 +79,9 @@ class vnl_sparse_symmetric_eigensystem
   vnl_sparse_matrix<double> * mat;
   // Matrix B of A*x = lambda*B*x
   vnl_sparse_matrix<double> * Bmat;
+  // Compressed copies of mat and Bmat, used for the products
+  vnl_sparse_matrix_csr<double> csr_mat;
+  vnl_sparse_matrix_csr<double> csr_Bmat;
 
   std::vector<double*> temp_store;
 };
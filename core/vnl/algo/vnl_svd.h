@@ -16,6 +16,7 @@
 //     1. The singular values are now stored as reals (not complexes) when T is complex.
 //     2. Fixed bug : for complex T, matrices have to be conjugated as well as transposed.
 //   Feb.2002 - Peter Vanroose - brief doxygen comment placed on single line
+//   Oct 2026 - large float and double matrices are decomposed by vnl_blocked_svd() if LAPACK is available
 // \endverbatim
 
 #include <iosfwd>
@@ -16,6 +16,7 @@
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_fortran_copy.h>
 #include <vnl/algo/vnl_netlib.h> // dsvdc_()
+#include <vnl/algo/vnl_blocked_factor.h>
 
 // use C++ overloading to call the right linpack routine from the template code :
 #define macro(p, T) \
@@ -60,16 +61,19 @@ vnl_svd<T>::vnl_svd(vnl_matrix<T> const& M, double zero_out_tol):
     vnl_vector<T> wspace(mm, T(0)); // complex fortran routine actually _wants_ complex W!
     vnl_vector<T> espace(p, T(0));
 
-    // Call Linpack SVD
+    // Call Linpack SVD, unless the blocked (LAPACK) one can do it
     long info = 0;
     const long job = 21; // min(n,p) svs in U, n svs in V (i.e. economy size)
-    vnl_linpack_svdc((T*)X, &n, &n, &p,
-                     wspace.data_block(),
-                     espace.data_block(),
-                     uspace.data_block(), &n,
-                     vspace.data_block(), &p,
-                     work.data_block(),
-                     &job, &info);
+    if (n < p || p < long(vnl_blocked_factor_min_size()) ||
+        !vnl_blocked_svd((T const*)X, n, p, wspace.data_block(),
+                         uspace.data_block(), vspace.data_block()))
+      vnl_linpack_svdc((T*)X, &n, &n, &p,
+                       wspace.data_block(),
+                       espace.data_block(),
+                       uspace.data_block(), &n,
+                       vspace.data_block(), &p,
+                       work.data_block(),
+                       &job, &info);
 
     // Error return?
     if (info != 0)
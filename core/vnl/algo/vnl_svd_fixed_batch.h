@@ -0,0 +1,60 @@
+// This is core/vnl/algo/vnl_svd_fixed_batch.h
+#ifndef vnl_svd_fixed_batch_h_
+#define vnl_svd_fixed_batch_h_
+//:
+// \file
+// \brief Singular value decompositions of many small matrices at once
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix_fixed_batch.h>
+#include <vnl/algo/vnl_algo_export.h>
+
+//: Singular value decompositions of a batch of R x C matrices.
+//
+//  Holds, for every matrix M of the batch, U, W and V such that
+//  $M = U W V^\top$, laid out as in vnl_svd_fixed: U is R x C, the
+//  singular values W are in decreasing order, and V is C x C. The
+//  columns of V for zero singular values span the nullspace; the
+//  corresponding columns of U are zero, rather than completing an
+//  orthonormal basis as vnl_svd_fixed does.
+//
+//  The decompositions use one-sided (Hestenes) Jacobi rotations, which
+//  have no data-dependent branches, applied to
+//  VNL_MATRIX_FIXED_BATCH_LANES matrices at a time in SIMD lanes (see
+//  vnl_matrix_fixed_batch). The signs of corresponding columns of U and
+//  V may differ from those given by vnl_svd_fixed.
+//
+//  Instantiated for float and double, 3x3, 3x4 and 4x4, and for double,
+//  9x9 (the design matrix of a four-point homography, padded with a
+//  zero row).
+VCL_TEMPLATE_EXPORT template <class T, unsigned int R, unsigned int C>
+class vnl_svd_fixed_batch
+{
+ public:
+  //: Decompose every matrix in M
+  explicit vnl_svd_fixed_batch(vnl_matrix_fixed_batch<T,R,C> const& M);
+
+  //: Left singular vectors, as columns
+  vnl_matrix_fixed_batch<T,R,C> const& U() const { return U_; }
+
+  //: Singular values, in decreasing order
+  vnl_matrix_fixed_batch<T,C,1> const& W() const { return W_; }
+
+  //: Right singular vectors, as columns
+  vnl_matrix_fixed_batch<T,C,C> const& V() const { return V_; }
+
+  //: The right singular vector of the smallest singular value of each matrix
+  vnl_matrix_fixed_batch<T,C,1> nullvector() const;
+
+ private:
+  vnl_matrix_fixed_batch<T,R,C> U_;
+  vnl_matrix_fixed_batch<T,C,1> W_;
+  vnl_matrix_fixed_batch<T,C,C> V_;
+};
+
+#endif // vnl_svd_fixed_batch_h_
@@ -0,0 +1,148 @@
+// This is core/vnl/algo/vnl_svd_fixed_batch.hxx
+#ifndef vnl_svd_fixed_batch_hxx_
+#define vnl_svd_fixed_batch_hxx_
+//:
+// \file
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "vnl_svd_fixed_batch.h"
+#include <vnl/vnl_matrix_fixed_batch.hxx>
+
+//: One-sided Jacobi for one block of matrices
+template <class T, unsigned int R, unsigned int C>
+struct vnl_svd_fixed_batch_kernel
+{
+  T const* m; T* u; T* w; T* v; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    const unsigned int L = VNL_MATRIX_FIXED_BATCH_LANES;
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tiny = std::numeric_limits<T>::min();
+    T a[R*C][L], x[C*C][L];
+    vnl_batch_load<T,R*C>(a, m, stride, blk);
+    for (unsigned int i = 0; i < C*C; ++i)
+      for (unsigned int l = 0; l < L; ++l)
+        x[i][l] = T(i % (C+1) == 0);
+
+    // Rotate pairs of columns of A until they are all orthogonal.
+    // A then holds U W and X holds V.
+    for (unsigned int sweep = 0; sweep < 60; ++sweep)
+    {
+      int active = 0;
+      for (unsigned int p = 0; p+1 < C; ++p)
+        for (unsigned int q = p+1; q < C; ++q)
+        {
+          T alpha[L], beta[L], gamma[L], c[L], s[L];
+          for (unsigned int l = 0; l < L; ++l)
+            alpha[l] = beta[l] = gamma[l] = T(0);
+          for (unsigned int k = 0; k < R; ++k)
+            for (unsigned int l = 0; l < L; ++l)
+            {
+              alpha[l] += a[k*C+p][l]*a[k*C+p][l];
+              beta[l]  += a[k*C+q][l]*a[k*C+q][l];
+              gamma[l] += a[k*C+p][l]*a[k*C+q][l];
+            }
+          for (unsigned int l = 0; l < L; ++l)
+          {
+            const T g = gamma[l];
+            active |= int(g*g > eps*eps*alpha[l]*beta[l] && std::fabs(g) > tiny);
+            const T zeta = (beta[l] - alpha[l]) / (T(2) * (g != T(0) ? g : T(1)));
+            T t = T(1) / (std::fabs(zeta) + std::sqrt(zeta*zeta + T(1)));
+            t = g == T(0) ? T(0) : (zeta < T(0) ? -t : t);
+            c[l] = T(1) / std::sqrt(t*t + T(1));
+            s[l] = t * c[l];
+          }
+          for (unsigned int k = 0; k < R; ++k)
+            for (unsigned int l = 0; l < L; ++l)
+            {
+              const T akp = a[k*C+p][l], akq = a[k*C+q][l];
+              a[k*C+p][l] = c[l]*akp - s[l]*akq;
+              a[k*C+q][l] = s[l]*akp + c[l]*akq;
+            }
+          for (unsigned int k = 0; k < C; ++k)
+            for (unsigned int l = 0; l < L; ++l)
+            {
+              const T xkp = x[k*C+p][l], xkq = x[k*C+q][l];
+              x[k*C+p][l] = c[l]*xkp - s[l]*xkq;
+              x[k*C+q][l] = s[l]*xkp + c[l]*xkq;
+            }
+        }
+      if (!active)
+        break;
+    }
+
+    // singular values are the column lengths; sort into decreasing order
+    T sv[C][L];
+    for (unsigned int j = 0; j < C; ++j)
+    {
+      for (unsigned int l = 0; l < L; ++l)
+        sv[j][l] = T(0);
+      for (unsigned int k = 0; k < R; ++k)
+        for (unsigned int l = 0; l < L; ++l)
+          sv[j][l] += a[k*C+j][l]*a[k*C+j][l];
+      for (unsigned int l = 0; l < L; ++l)
+        sv[j][l] = std::sqrt(sv[j][l]);
+    }
+    for (unsigned int pass = 0; pass+1 < C; ++pass)
+      for (unsigned int j = 0; j+1 < C-pass; ++j)
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          const bool swap = sv[j][l] < sv[j+1][l];
+          const T s0 = sv[j][l], s1 = sv[j+1][l];
+          sv[j][l] = swap ? s1 : s0;
+          sv[j+1][l] = swap ? s0 : s1;
+          for (unsigned int k = 0; k < R; ++k)
+          {
+            const T a0 = a[k*C+j][l], a1 = a[k*C+j+1][l];
+            a[k*C+j][l] = swap ? a1 : a0;
+            a[k*C+j+1][l] = swap ? a0 : a1;
+          }
+          for (unsigned int k = 0; k < C; ++k)
+          {
+            const T x0 = x[k*C+j][l], x1 = x[k*C+j+1][l];
+            x[k*C+j][l] = swap ? x1 : x0;
+            x[k*C+j+1][l] = swap ? x0 : x1;
+          }
+        }
+
+    // U = A inv(W), with zero columns for zero singular values
+    for (unsigned int j = 0; j < C; ++j)
+      for (unsigned int l = 0; l < L; ++l)
+      {
+        const T inv = sv[j][l] > T(0) ? T(1)/sv[j][l] : T(0);
+        for (unsigned int k = 0; k < R; ++k)
+          a[k*C+j][l] *= inv;
+      }
+
+    vnl_batch_store<T,R*C>(a, u, stride, blk);
+    vnl_batch_store<T,C>(sv, w, stride, blk);
+    vnl_batch_store<T,C*C>(x, v, stride, blk);
+  }
+};
+
+template <class T, unsigned int R, unsigned int C>
+vnl_svd_fixed_batch<T,R,C>::vnl_svd_fixed_batch(vnl_matrix_fixed_batch<T,R,C> const& M)
+  : U_(M.size()), W_(M.size()), V_(M.size())
+{
+  vnl_svd_fixed_batch_kernel<T,R,C> k =
+    { M.data_block(), U_.data_block(), W_.data_block(), V_.data_block(), M.stride() };
+  vnl_batch_run(k, M.stride()/VNL_MATRIX_FIXED_BATCH_LANES);
+}
+
+template <class T, unsigned int R, unsigned int C>
+vnl_matrix_fixed_batch<T,C,1> vnl_svd_fixed_batch<T,R,C>::nullvector() const
+{
+  vnl_matrix_fixed_batch<T,C,1> n(V_.size());
+  for (unsigned int i = 0; i < C; ++i)
+    std::copy(V_.element(i, C-1), V_.element(i, C-1) + V_.stride(), n.element(i, 0));
+  return n;
+}
+
+#undef VNL_SVD_FIXED_BATCH_INSTANTIATE
+#define VNL_SVD_FIXED_BATCH_INSTANTIATE(T, R, C) \
+template class VNL_ALGO_EXPORT vnl_svd_fixed_batch<T, R, C >
+
+#endif // vnl_svd_fixed_batch_hxx_
@@ -18,8 +18,10 @@
 //
 //    Uses the EISPACK routine RS, which in turn calls TRED2 to reduce A
 //    to tridiagonal form, followed by TQL2, to find the eigensystem.
-//    This is summarized in Golub and van Loan, pgf 8.2.  The following are
-//    the original subroutine headers:
+//    This is summarized in Golub and van Loan, pgf 8.2.  Matrices of at
+//    least vnl_blocked_factor_min_size() rows are passed to LAPACK instead,
+//    through vnl_blocked_symmetric_eigensystem(), if vnl_algo was built
+//    with it.  The following are the original subroutine headers:
 //
 // \remark TRED2 is a translation of the Algol procedure tred2,
 //     Num. Math. 11, 181-195(1968) by Martin, Reinsch, and Wilkinson.
@@ -50,6 +52,7 @@
 //   Jan.2003 - Peter Vanroose - added missing implementation for solve(b,x)
 //   Mar.2010 - Peter Vanroose - also made vnl_symmetric_eigensystem_compute()
 //                               & vnl_symmetric_eigensystem_compute_eigenvals() templated
+//   Oct 2026 - large matrices go to vnl_blocked_symmetric_eigensystem()
 // \endverbatim
 
 #include <vnl/vnl_matrix.h>
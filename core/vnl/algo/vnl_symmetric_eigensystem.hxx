@@ -18,6 +18,7 @@
 #include <vnl/vnl_copy.h>
 #include <vnl/vnl_math.h>
 #include <vnl/algo/vnl_netlib.h> // rs_()
+#include <vnl/algo/vnl_blocked_factor.h>
 
 //: Find eigenvalues of a symmetric 3x3 matrix
 // \verbatim
@@ -113,7 +114,9 @@ bool vnl_symmetric_eigensystem_compute(vnl_matrix<T> const & A,
   long ierr = 0;
 
   // No need to transpose A, 'cos it's symmetric...
-  v3p_netlib_rs_(&n, &n, Ad.data_block(), &Dd[0], &want_eigenvectors, &Vvec[0], &work1[0], &work2[0], &ierr);
+  if (n < long(vnl_blocked_factor_min_size()) ||
+      !vnl_blocked_symmetric_eigensystem(Ad.data_block(), n, &Dd[0], &Vvec[0]))
+    v3p_netlib_rs_(&n, &n, Ad.data_block(), &Dd[0], &want_eigenvectors, &Vvec[0], &work1[0], &work2[0], &ierr);
   vnl_copy(Dd, D);
 
   if (ierr) {
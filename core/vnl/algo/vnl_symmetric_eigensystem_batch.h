@@ -0,0 +1,43 @@
+// This is core/vnl/algo/vnl_symmetric_eigensystem_batch.h
+#ifndef vnl_symmetric_eigensystem_batch_h_
+#define vnl_symmetric_eigensystem_batch_h_
+//:
+// \file
+// \brief Eigensystems of many small real symmetric matrices at once
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix_fixed_batch.h>
+#include <vnl/algo/vnl_algo_export.h>
+
+//: Eigensystems of a batch of n x n real symmetric matrices.
+//  Each matrix is diagonalised by cyclic Jacobi rotations, applied to
+//  VNL_MATRIX_FIXED_BATCH_LANES matrices at a time in SIMD lanes (see
+//  vnl_matrix_fixed_batch). Jacobi is used rather than the tridiagonal QL
+//  of vnl_symmetric_eigensystem because it has no data-dependent
+//  branches, so every lane follows the same instruction stream.
+//
+//  As in vnl_symmetric_eigensystem, the eigenvalues of each matrix are
+//  sorted in increasing order and the eigenvectors are the columns of V.
+//  Only the upper triangle of each matrix is read.
+//
+//  Instantiated for n = 2, 3 and 4.
+VCL_TEMPLATE_EXPORT template <class T, unsigned int n>
+class vnl_symmetric_eigensystem_batch
+{
+ public:
+  //: Solve the eigenproblem of every matrix in M
+  explicit vnl_symmetric_eigensystem_batch(vnl_matrix_fixed_batch<T,n,n> const& M);
+
+  //: Eigenvectors of each matrix, as columns
+  vnl_matrix_fixed_batch<T,n,n> V;
+
+  //: Eigenvalues of each matrix, in increasing order
+  vnl_matrix_fixed_batch<T,n,1> D;
+};
+
+#endif // vnl_symmetric_eigensystem_batch_h_
@@ -0,0 +1,112 @@
+// This is core/vnl/algo/vnl_symmetric_eigensystem_batch.hxx
+#ifndef vnl_symmetric_eigensystem_batch_hxx_
+#define vnl_symmetric_eigensystem_batch_hxx_
+//:
+// \file
+
+#include <cmath>
+#include <limits>
+#include "vnl_symmetric_eigensystem_batch.h"
+#include <vnl/vnl_matrix_fixed_batch.hxx>
+
+//: Jacobi rotations for one block of matrices
+template <class T, unsigned int n>
+struct vnl_symmetric_eigensystem_batch_kernel
+{
+  T const* m; T* v; T* d; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    const unsigned int L = VNL_MATRIX_FIXED_BATCH_LANES;
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tiny = std::numeric_limits<T>::min();
+    T a[n*n][L], x[n*n][L];
+    vnl_batch_load<T,n*n>(a, m, stride, blk);
+    for (unsigned int i = 0; i < n; ++i)
+      for (unsigned int j = 0; j < n; ++j)
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          if (j < i) a[i*n+j][l] = a[j*n+i][l];
+          x[i*n+j][l] = T(i == j);
+        }
+
+    for (unsigned int sweep = 0; sweep < 50; ++sweep)
+    {
+      int active = 0;
+      for (unsigned int p = 0; p+1 < n; ++p)
+        for (unsigned int q = p+1; q < n; ++q)
+        {
+          // the rotation in the (p,q) plane that zeroes a(p,q)
+          T c[L], s[L];
+          for (unsigned int l = 0; l < L; ++l)
+          {
+            const T apq = a[p*n+q][l], app = a[p*n+p][l], aqq = a[q*n+q][l];
+            const T aapq = std::fabs(apq);
+            active |= int(aapq > eps*(std::fabs(app)+std::fabs(aqq)) && aapq > tiny);
+            const T theta = (aqq - app) / (T(2) * (apq != T(0) ? apq : T(1)));
+            T t = T(1) / (std::fabs(theta) + std::sqrt(theta*theta + T(1)));
+            t = apq == T(0) ? T(0) : (theta < T(0) ? -t : t);
+            c[l] = T(1) / std::sqrt(t*t + T(1));
+            s[l] = t * c[l];
+          }
+          // A = J' A J and X = X J
+          for (unsigned int k = 0; k < n; ++k)
+            for (unsigned int l = 0; l < L; ++l)
+            {
+              const T akp = a[k*n+p][l], akq = a[k*n+q][l];
+              a[k*n+p][l] = c[l]*akp - s[l]*akq;
+              a[k*n+q][l] = s[l]*akp + c[l]*akq;
+              const T xkp = x[k*n+p][l], xkq = x[k*n+q][l];
+              x[k*n+p][l] = c[l]*xkp - s[l]*xkq;
+              x[k*n+q][l] = s[l]*xkp + c[l]*xkq;
+            }
+          for (unsigned int k = 0; k < n; ++k)
+            for (unsigned int l = 0; l < L; ++l)
+            {
+              const T apk = a[p*n+k][l], aqk = a[q*n+k][l];
+              a[p*n+k][l] = c[l]*apk - s[l]*aqk;
+              a[q*n+k][l] = s[l]*apk + c[l]*aqk;
+            }
+        }
+      if (!active)
+        break;
+    }
+
+    // sort into increasing order
+    T e[n][L];
+    for (unsigned int i = 0; i < n; ++i)
+      for (unsigned int l = 0; l < L; ++l)
+        e[i][l] = a[i*n+i][l];
+    for (unsigned int pass = 0; pass+1 < n; ++pass)
+      for (unsigned int i = 0; i+1 < n-pass; ++i)
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          const bool swap = e[i+1][l] < e[i][l];
+          const T e0 = e[i][l], e1 = e[i+1][l];
+          e[i][l] = swap ? e1 : e0;
+          e[i+1][l] = swap ? e0 : e1;
+          for (unsigned int k = 0; k < n; ++k)
+          {
+            const T x0 = x[k*n+i][l], x1 = x[k*n+i+1][l];
+            x[k*n+i][l] = swap ? x1 : x0;
+            x[k*n+i+1][l] = swap ? x0 : x1;
+          }
+        }
+    vnl_batch_store<T,n*n>(x, v, stride, blk);
+    vnl_batch_store<T,n>(e, d, stride, blk);
+  }
+};
+
+template <class T, unsigned int n>
+vnl_symmetric_eigensystem_batch<T,n>::vnl_symmetric_eigensystem_batch(vnl_matrix_fixed_batch<T,n,n> const& M)
+  : V(M.size()), D(M.size())
+{
+  vnl_symmetric_eigensystem_batch_kernel<T,n> k = { M.data_block(), V.data_block(), D.data_block(), M.stride() };
+  vnl_batch_run(k, M.stride()/VNL_MATRIX_FIXED_BATCH_LANES);
+}
+
+#undef VNL_SYMMETRIC_EIGENSYSTEM_BATCH_INSTANTIATE
+#define VNL_SYMMETRIC_EIGENSYSTEM_BATCH_INSTANTIATE(T, n) \
+template class VNL_ALGO_EXPORT vnl_symmetric_eigensystem_batch<T, n >
+
+#endif // vnl_symmetric_eigensystem_batch_hxx_
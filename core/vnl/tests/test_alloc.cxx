@@ -0,0 +1,73 @@
+// This is core/vnl/tests/test_alloc.cxx
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vnl_alloc, also when several threads allocate and free at once
+#include <vnl/vnl_alloc.h>
+#include <vnl/vnl_thread_pool.h>
+
+//: Allocate objects of many sizes, fill them, and free half of them in another order
+static bool churn(unsigned seed, std::vector<char*>& keep, std::vector<std::size_t>& keep_size)
+{
+  bool ok = true;
+  std::vector<char*> p(2000);
+  std::vector<std::size_t> n(p.size());
+  for (unsigned i = 0; i < p.size(); ++i)
+  {
+    n[i] = 1 + (seed*7919u + i*104729u) % 300; // some above VNL_ALLOC_MAX_BYTES
+    p[i] = (char*)vnl_alloc::allocate(n[i]);
+    std::memset(p[i], int((seed + i) & 0xff), n[i]);
+  }
+  for (unsigned i = 0; i < p.size(); ++i)
+  {
+    const char v = char((seed + i) & 0xff);
+    for (std::size_t j = 0; j < n[i]; ++j)
+      ok = ok && p[i][j] == v;
+  }
+  for (unsigned i = 1; i < p.size(); i += 2)
+    vnl_alloc::deallocate(p[i], n[i]);
+  for (unsigned i = 0; i < p.size(); i += 2)
+  {
+    keep.push_back(p[i]);
+    keep_size.push_back(n[i]);
+  }
+  return ok;
+}
+
+static void test_alloc()
+{
+  char* p = (char*)vnl_alloc::allocate(10);
+  std::strcpy(p, "fred");
+  TEST("allocate", std::strcmp(p, "fred"), 0);
+  p = (char*)vnl_alloc::reallocate(p, 10, 100);
+  TEST("reallocate keeps contents", std::strcmp(p, "fred"), 0);
+  vnl_alloc::deallocate(p, 100);
+
+  // Objects allocated by one task are freed by another, usually on another thread
+  const unsigned n_tasks = 16;
+  std::vector<std::vector<char*> > keep(n_tasks);
+  std::vector<std::vector<std::size_t> > keep_size(n_tasks);
+  std::vector<int> ok(n_tasks, 0);
+  vnl_parallel_for(n_tasks, [&](unsigned t) { ok[t] = churn(t, keep[t], keep_size[t]); }, 4);
+  vnl_parallel_for(n_tasks, [&](unsigned t) {
+    const unsigned u = (t + 5) % n_tasks;
+    for (unsigned i = 0; i < keep[u].size(); ++i)
+      vnl_alloc::deallocate(keep[u][i], keep_size[u][i]);
+    std::vector<char*> k;
+    std::vector<std::size_t> ks;
+    if (!churn(t + 100, k, ks))
+      ok[t] = 0;
+    for (unsigned i = 0; i < k.size(); ++i)
+      vnl_alloc::deallocate(k[i], ks[i]);
+  }, 4);
+  bool all_ok = true;
+  for (unsigned t = 0; t < n_tasks; ++t)
+    all_ok = all_ok && ok[t] != 0;
+  TEST("objects intact with several threads", all_ok, true);
+}
+
+TESTMAIN(test_alloc);
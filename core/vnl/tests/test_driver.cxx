@@ -1,5 +1,6 @@
 #include <testlib/testlib_register.h>
 
+DECLARE( test_alloc );
 DECLARE( test_bignum );
 DECLARE( test_decnum );
 DECLARE( test_complexify );
@@ -29,6 +30,7 @@ DECLARE( test_rotation_matrix );
 DECLARE( test_sym_matrix );
 DECLARE( test_transpose );
 DECLARE( test_fastops );
+DECLARE( test_gemm );
 DECLARE( test_vector );
 DECLARE( test_vector_fixed_ref );
 DECLARE( test_gamma );
@@ -41,12 +43,16 @@ DECLARE( test_bessel );
 DECLARE( test_crs_index );
 DECLARE( test_sparse_lst_sqr_function );
 DECLARE( test_sparse_matrix );
+DECLARE( test_sparse_matrix_csr );
+DECLARE( test_matrix_fixed_batch );
+DECLARE( test_expr );
 DECLARE( test_pow_log );
 DECLARE( test_vnl_index_sort );
 
 void
 register_tests()
 {
+  REGISTER( test_alloc );
   REGISTER( test_bignum );
   REGISTER( test_decnum );
   REGISTER( test_complexify );
@@ -75,6 +81,7 @@ register_tests()
   REGISTER( test_sym_matrix );
   REGISTER( test_transpose );
   REGISTER( test_fastops );
+  REGISTER( test_gemm );
   REGISTER( test_vector );
   REGISTER( test_vector_fixed_ref );
   REGISTER( test_gamma );
@@ -87,6 +94,9 @@ register_tests()
   REGISTER( test_crs_index );
   REGISTER( test_sparse_lst_sqr_function );
   REGISTER( test_sparse_matrix );
+  REGISTER( test_sparse_matrix_csr );
+  REGISTER( test_matrix_fixed_batch );
+  REGISTER( test_expr );
   REGISTER( test_pow_log );
   REGISTER( test_vnl_index_sort );
 }
@@ -0,0 +1,109 @@
+// This is core/vnl/tests/test_expr.cxx
+#include <iostream>
+#include <cmath>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check that lazy expressions give what the eager vnl_vector and vnl_matrix operators give
+#include <vnl/vnl_expr.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_vector_ref.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+
+template <class T>
+static vnl_vector<T> random_vector(unsigned n, vnl_random& rng)
+{
+  vnl_vector<T> v(n);
+  for (unsigned i = 0; i < n; ++i)
+    v[i] = T(rng.drand64(-1.0, 1.0));
+  return v;
+}
+
+template <class T>
+static void test_vectors(unsigned n, double tol, const char* what)
+{
+  std::cout << what << ", length " << n << '\n';
+  vnl_random rng(n);
+  vnl_vector<T> a = random_vector<T>(n, rng), b = random_vector<T>(n, rng),
+                c = random_vector<T>(n, rng);
+  const T s = T(1.5);
+
+  vnl_vector<T> x = vnl_lazy(a) + vnl_lazy(b)*s - c;
+  TEST_NEAR("a + b*s - c", (x - (a + b*s - c)).inf_norm(), 0.0, tol);
+
+  // assignment to a vector of the right size keeps its storage
+  T const* before = x.data_block();
+  x = s*vnl_lazy(a) - b/s + T(2);
+  TEST("no reallocation", x.data_block() == before, true);
+  TEST_NEAR("s*a - b/s + 2", (x - (a*s - b/s + T(2))).inf_norm(), 0.0, tol);
+
+  // assignment to a vector of another size resizes it
+  vnl_vector<T> y(3);
+  y = -vnl_lazy(a) + (T(1) - vnl_lazy(c));
+  TEST("resized", y.size(), n);
+  TEST_NEAR("-a + (1 - c)", (y - (-a + (T(1) - c))).inf_norm(), 0.0, tol);
+
+  // the destination may be an operand
+  vnl_vector<T> z = a;
+  z = vnl_lazy(z)*T(2) + b;
+  TEST_NEAR("z = z*2 + b", (z - (a*T(2) + b)).inf_norm(), 0.0, tol);
+  z += vnl_lazy(c)*s;
+  z -= vnl_lazy(a) - b;
+  TEST_NEAR("+= and -=", (z - (a*T(2) + b + c*s - (a - b))).inf_norm(), 0.0, tol);
+
+  vnl_vector<T> e = element_quotient(element_product(vnl_lazy(a), b), element_product(vnl_lazy(c), c) + T(1));
+  TEST_NEAR("element product and quotient",
+            (e - element_quotient(element_product(a, b), element_product(c, c) + T(1))).inf_norm(),
+            0.0, tol);
+
+  // reductions, without forming the vectors
+  TEST_NEAR("sum", (vnl_lazy(a) + b).sum(), (a + b).sum(), tol*n);
+  TEST_NEAR("squared_magnitude", (vnl_lazy(a) - b).squared_magnitude(), (a - b).squared_magnitude(), tol*n);
+  TEST_NEAR("dot_product", dot_product(vnl_lazy(a)*s, c), dot_product(a*s, c), tol*n);
+
+  // a vnl_vector_ref is a vnl_vector
+  vnl_vector_ref<T> ra(n, a.data_block());
+  vnl_vector<T> w = vnl_lazy(ra) + ra;
+  TEST_NEAR("vnl_vector_ref operands", (w - a*T(2)).inf_norm(), 0.0, tol);
+}
+
+static double max_abs(vnl_matrix<double> const& M)
+{
+  return M.absolute_value_max();
+}
+
+static void test_matrices()
+{
+  vnl_random rng(5);
+  vnl_matrix<double> A(7, 5), B(7, 5);
+  for (unsigned i = 0; i < 7; ++i)
+    for (unsigned j = 0; j < 5; ++j)
+    {
+      A(i, j) = rng.drand64(-1.0, 1.0);
+      B(i, j) = rng.drand64(-1.0, 1.0);
+    }
+  vnl_matrix<double> C = vnl_lazy(A)*2.0 - B + 1.0;
+  TEST("matrix size", C.rows() == 7 && C.cols() == 5, true);
+  TEST_NEAR("A*2 - B + 1", (C - (A*2.0 - B + 1.0)).absolute_value_max(), 0.0, 1e-15);
+  C -= element_product(vnl_lazy(A), B);
+  TEST_NEAR("-= element_product", (C - (A*2.0 - B + 1.0 - element_product(A, B))).absolute_value_max(),
+            0.0, 1e-15);
+  vnl_matrix<double> D;
+  D = -vnl_lazy(B);
+  TEST_NEAR("-B", (D + B).absolute_value_max(), 0.0, 0.0);
+
+  // a lazy matrix can be passed where a vnl_matrix is expected
+  TEST_NEAR("converted to vnl_matrix", max_abs(vnl_lazy(A) + B), (A + B).absolute_value_max(), 0.0);
+}
+
+static void test_expr()
+{
+  test_vectors<double>(1, 1e-15, "double");
+  test_vectors<double>(1001, 1e-15, "double");
+  test_vectors<float>(37, 1e-6, "float");
+  test_matrices();
+}
+
+TESTMAIN(test_expr);
@@ -0,0 +1,149 @@
+// This is core/vnl/tests/test_gemm.cxx
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vnl_gemm against simple loops, at every level and for edge sizes
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_fastops.h>
+#include <vnl/vnl_random.h>
+
+static const char* level_name[] = { "generic", "avx2", "avx512" };
+
+//: Largest |x-y| over the elements, relative to the largest |y|
+template <class T>
+static double max_rel_diff(std::vector<T> const& x, std::vector<double> const& y)
+{
+  double d = 0, s = 1e-300;
+  for (unsigned i=0; i<y.size(); ++i)
+  {
+    d = std::max(d, std::fabs(double(x[i])-y[i]));
+    s = std::max(s, std::fabs(y[i]));
+  }
+  return d/s;
+}
+
+//: Compare one call of vnl_gemm with a reference computed in double
+template <class T>
+static void test_case(bool ta, bool tb, unsigned m, unsigned n, unsigned k,
+                      double alpha, double beta, unsigned pad, vnl_random& rng,
+                      double tol)
+{
+  // stored sizes of A and B, with pad spare elements at the end of each row
+  const unsigned ra = ta ? k : m, ca = ta ? m : k;
+  const unsigned rb = tb ? n : k, cb = tb ? k : n;
+  const unsigned lda = ca+pad, ldb = cb+pad, ldc = n+pad;
+  std::vector<T> A(ra*lda), B(rb*ldb), C(m*ldc);
+  for (unsigned i=0; i<A.size(); ++i) A[i] = T(rng.drand64(-1.0, 1.0));
+  for (unsigned i=0; i<B.size(); ++i) B[i] = T(rng.drand64(-1.0, 1.0));
+  for (unsigned i=0; i<C.size(); ++i) C[i] = T(rng.drand64(-1.0, 1.0));
+
+  std::vector<double> ref(C.begin(), C.end());
+  for (unsigned i=0; i<m; ++i)
+    for (unsigned j=0; j<n; ++j)
+    {
+      double sum = 0;
+      for (unsigned p=0; p<k; ++p)
+        sum += double(ta ? A[p*lda+i] : A[i*lda+p]) *
+               double(tb ? B[j*ldb+p] : B[p*ldb+j]);
+      ref[i*ldc+j] = alpha*sum + (beta==0 ? 0.0 : beta*double(C[i*ldc+j]));
+    }
+
+  vnl_gemm(ta, tb, m, n, k, T(alpha), A.data(), lda, B.data(), ldb, T(beta), C.data(), ldc);
+
+  std::ostringstream name;
+  name << (sizeof(T)==sizeof(double) ? "double " : "float ")
+       << level_name[vnl_gemm_get_level()] << ' ' << (ta ? 'T' : 'N') << (tb ? 'T' : 'N')
+       << ' ' << m << 'x' << n << 'x' << k << " alpha=" << alpha << " beta=" << beta;
+  TEST_NEAR(name.str().c_str(), max_rel_diff(C, ref), 0.0, tol);
+}
+
+template <class T>
+static void test_type(vnl_random& rng, double tol)
+{
+  // sizes around the tile and block edges of every level
+  const unsigned sizes[][3] = { {1,1,1}, {7,9,5}, {13,17,29}, {37,35,33},
+                                {145,67,260}, {200,300,400}, {6,129,600} };
+  for (unsigned s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s)
+    for (int t=0; t<4; ++t)
+      test_case<T>((t&1)!=0, (t&2)!=0, sizes[s][0], sizes[s][1], sizes[s][2],
+                   1.0, 0.0, 0, rng, tol);
+  test_case<T>(false, false, 50, 60, 70, -0.5, 2.0, 3, rng, tol);
+  test_case<T>(true, true, 61, 47, 90, 1.5, 1.0, 5, rng, tol);
+  test_case<T>(false, true, 20, 20, 0, 1.0, 0.5, 0, rng, tol);
+  test_case<T>(true, false, 20, 20, 20, 0.0, -1.0, 1, rng, tol);
+}
+
+static void test_gemm()
+{
+  vnl_random rng(1234);
+  const vnl_gemm_level best = vnl_gemm_best_level();
+  std::cout << "Best vnl_gemm level: " << level_name[best] << '\n';
+  TEST("set_level above best is reduced", vnl_gemm_set_level(vnl_gemm_avx512), best);
+
+  // one thread, then four, which also splits small products
+  for (unsigned threads=1; threads<=4; threads+=3)
+  {
+    vnl_gemm_set_max_threads(threads);
+    std::cout << "Up to " << threads << " threads\n";
+    for (int l=vnl_gemm_generic; l<=best; ++l)
+    {
+      vnl_gemm_set_level(vnl_gemm_level(l));
+      test_type<double>(rng, 1e-13);
+      test_type<float>(rng, 1e-5);
+    }
+  }
+  vnl_gemm_set_max_threads(0);
+  vnl_gemm_set_level(best);
+
+  // The operators and vnl_fastops use vnl_gemm for large products
+  vnl_matrix<double> A(70, 90), B(90, 50), X(70, 50);
+  for (unsigned i=0; i<A.size(); ++i) A.data_block()[i] = rng.drand64(-1.0, 1.0);
+  for (unsigned i=0; i<B.size(); ++i) B.data_block()[i] = rng.drand64(-1.0, 1.0);
+  vnl_matrix<double> ref(70, 50);
+  for (unsigned i=0; i<70; ++i)
+    for (unsigned j=0; j<50; ++j)
+    {
+      double sum = 0;
+      for (unsigned p=0; p<90; ++p)
+        sum += A(i,p)*B(p,j);
+      ref(i,j) = sum;
+    }
+  TEST_NEAR("vnl_matrix operator*", (A*B - ref).absolute_value_max(), 0.0, 1e-12);
+
+  X.fill(1.0);
+  vnl_fastops::inc_X_by_AB(X, A, B);
+  X -= 1.0;
+  TEST_NEAR("vnl_fastops::inc_X_by_AB", (X - ref).absolute_value_max(), 0.0, 1e-12);
+  vnl_fastops::AtB(X, A.transpose(), B);
+  TEST_NEAR("vnl_fastops::AtB", (X - ref).absolute_value_max(), 0.0, 1e-12);
+  vnl_fastops::ABt(X, A, B.transpose());
+  TEST_NEAR("vnl_fastops::ABt", (X - ref).absolute_value_max(), 0.0, 1e-12);
+  vnl_matrix<double> AtA;
+  vnl_fastops::AtA(AtA, A);
+  TEST_NEAR("vnl_fastops::AtA", (AtA - A.transpose()*A).absolute_value_max(), 0.0, 1e-12);
+  TEST("vnl_fastops::AtA is symmetric", AtA == AtA.transpose(), true);
+
+  vnl_matrix_fixed<float, 40, 40> F, G;
+  for (unsigned i=0; i<40; ++i)
+    for (unsigned j=0; j<40; ++j)
+    {
+      F(i,j) = float(i+j);
+      G(i,j) = (i==j) ? 2.0f : 0.0f;
+    }
+  vnl_matrix_fixed<float, 40, 40> FG = F*G;
+  float max_diff = 0.0f;
+  for (unsigned i=0; i<40; ++i)
+    for (unsigned j=0; j<40; ++j)
+      max_diff = std::max(max_diff, std::fabs(FG(i,j) - 2.0f*F(i,j)));
+  TEST_NEAR("vnl_matrix_fixed operator*", max_diff, 0.0, 1e-6);
+}
+
+TESTMAIN(test_gemm);
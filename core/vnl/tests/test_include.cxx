@@ -40,6 +40,7 @@
 #include <vnl/vnl_double_4x3.h>
 #include <vnl/vnl_double_4x4.h>
 #include <vnl/vnl_erf.h>
+#include <vnl/vnl_expr.h>
 #include <vnl/vnl_error.h>
 #include <vnl/vnl_fastops.h>
 #include <vnl/vnl_file_matrix.h>
@@ -61,6 +62,7 @@
 #include <vnl/vnl_fortran_copy.h>
 #include <vnl/vnl_fortran_copy_fixed.h>
 #include <vnl/vnl_gamma.h>
+#include <vnl/vnl_gemm.h>
 #include <vnl/vnl_hungarian_algorithm.h>
 #include <vnl/vnl_identity.h>
 #include <vnl/vnl_identity_3x3.h>
@@ -112,10 +114,13 @@
 #include <vnl/vnl_scalar_join_iterator.h>
 #include <vnl/vnl_sparse_lst_sqr_function.h>
 #include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_sparse_matrix_csr.h>
+#include <vnl/vnl_matrix_fixed_batch.h>
 #include <vnl/vnl_sparse_matrix_linear_system.h>
 #include <vnl/vnl_sse.h>
 #include <vnl/vnl_sym_matrix.h>
 #include <vnl/vnl_tag.h>
+#include <vnl/vnl_thread_pool.h>
 #include <vnl/vnl_trace.h>
 #include <vnl/vnl_transpose.h>
 #include <vnl/vnl_unary_function.h>
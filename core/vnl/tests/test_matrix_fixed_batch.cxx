@@ -0,0 +1,147 @@
+// This is core/vnl/tests/test_matrix_fixed_batch.cxx
+#include <iostream>
+#include <cmath>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check the batched small-matrix kernels against vnl_matrix_fixed, vnl_det and vnl_inverse
+#include <vnl/vnl_matrix_fixed_batch.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_inverse.h>
+#include <vnl/vnl_det.h>
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_random.h>
+
+template <class T, unsigned int R, unsigned int C>
+static void random_batch(vnl_matrix_fixed_batch<T,R,C>& B, std::size_t n, vnl_random& rng)
+{
+  B.set_size(n);
+  for (std::size_t k = 0; k < n; ++k)
+    for (unsigned int r = 0; r < R; ++r)
+      for (unsigned int c = 0; c < C; ++c)
+        B(k,r,c) = T(rng.drand64(-1.0, 1.0));
+}
+
+//: Largest difference between the matrices of a batch and those given by f
+template <class T, unsigned int R, unsigned int C>
+static double max_diff(vnl_matrix_fixed_batch<T,R,C> const& B, std::size_t k,
+                       vnl_matrix_fixed<T,R,C> const& m)
+{
+  return (B.get(k) - m).absolute_value_max();
+}
+
+template <class T>
+static void test_batch_kernels(std::size_t n, double tol, const char* what)
+{
+  std::cout << what << ", " << n << " matrices\n";
+  vnl_random rng(9667 + (unsigned)n);
+
+  vnl_matrix_fixed_batch<T,3,3> A, B, AB;
+  random_batch(A, n, rng);
+  random_batch(B, n, rng);
+  vnl_batch_mult(A, B, AB);
+  double d = 0;
+  for (std::size_t k = 0; k < n; ++k)
+    d = std::max(d, max_diff(AB, k, A.get(k)*B.get(k)));
+  TEST_NEAR("3x3 times 3x3", d, 0.0, tol);
+
+  // one camera, many points
+  vnl_matrix_fixed<T,3,4> P;
+  for (unsigned int i = 0; i < 12; ++i)
+    P.data_block()[i] = T(rng.drand64(-1.0, 1.0));
+  vnl_matrix_fixed_batch<T,4,1> X;
+  vnl_matrix_fixed_batch<T,3,1> x;
+  random_batch(X, n, rng);
+  vnl_batch_mult(P, X, x);
+  d = 0;
+  for (std::size_t k = 0; k < n; ++k)
+    d = std::max(d, max_diff(x, k, P*X.get(k)));
+  TEST_NEAR("3x4 camera times points", d, 0.0, tol);
+
+  vnl_matrix_fixed_batch<T,4,4> M4, M4i;
+  random_batch(M4, n, rng);
+  vnl_matrix_fixed_batch<T,3,4> A34, A34M4;
+  random_batch(A34, n, rng);
+  vnl_batch_mult(A34, M4, A34M4);
+  d = 0;
+  for (std::size_t k = 0; k < n; ++k)
+    d = std::max(d, max_diff(A34M4, k, A34.get(k)*M4.get(k)));
+  TEST_NEAR("3x4 times 4x4", d, 0.0, tol);
+
+  // determinants, relative to their size
+  vnl_matrix_fixed_batch<T,2,2> M2, M2i;
+  random_batch(M2, n, rng);
+  vnl_vector<T> det2, det3, det4;
+  vnl_batch_det(M2, det2);
+  vnl_batch_det(A, det3);
+  vnl_batch_det(M4, det4);
+  TEST("det sizes", det2.size() == n && det3.size() == n && det4.size() == n, true);
+  d = 0;
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    d = std::max(d, std::fabs(double(det2[k] - vnl_det(M2.get(k)))));
+    d = std::max(d, std::fabs(double(det3[k] - vnl_det(A.get(k)))));
+    d = std::max(d, std::fabs(double(det4[k] - vnl_det(M4.get(k)))));
+  }
+  TEST_NEAR("determinants", d, 0.0, tol);
+
+  // inverses: M * inverse(M) = I, for the better conditioned ones
+  vnl_matrix_fixed_batch<T,3,3> Ai;
+  vnl_batch_inverse(M2, M2i);
+  vnl_batch_inverse(A, Ai);
+  vnl_batch_inverse(M4, M4i);
+  double d2 = 0, d3 = 0, d4 = 0;
+  vnl_matrix_fixed<T,2,2> I2; I2.set_identity();
+  vnl_matrix_fixed<T,3,3> I3; I3.set_identity();
+  vnl_matrix_fixed<T,4,4> I4; I4.set_identity();
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    if (std::fabs(det2[k]) > 0.1)
+      d2 = std::max(d2, double((M2.get(k)*M2i.get(k) - I2).absolute_value_max()));
+    if (std::fabs(det3[k]) > 0.1)
+      d3 = std::max(d3, double((A.get(k)*Ai.get(k) - I3).absolute_value_max()));
+    if (std::fabs(det4[k]) > 0.1)
+      d4 = std::max(d4, double((M4.get(k)*M4i.get(k) - I4).absolute_value_max()));
+  }
+  TEST_NEAR("2x2 inverse", d2, 0.0, 100*tol);
+  TEST_NEAR("3x3 inverse", d3, 0.0, 100*tol);
+  TEST_NEAR("4x4 inverse", d4, 0.0, 100*tol);
+  if (n > 0)
+  {
+    d = (Ai.get(0) - vnl_inverse(A.get(0))).absolute_value_max();
+    TEST_NEAR("3x3 inverse as vnl_inverse", d, 0.0, 100*tol*vnl_inverse(A.get(0)).absolute_value_max());
+  }
+}
+
+static void test_matrix_fixed_batch()
+{
+  vnl_matrix_fixed_batch<double,3,3> E;
+  TEST("default is empty", E.size() == 0 && E.stride() == 0, true);
+  vnl_matrix_fixed_batch<double,3,3> S(5);
+  TEST("padded to the lane count", S.size() == 5 && S.stride() == VNL_MATRIX_FIXED_BATCH_LANES, true);
+  vnl_matrix_fixed<double,3,3> m;
+  for (unsigned int i = 0; i < 9; ++i) m.data_block()[i] = i+1;
+  S.set(3, m);
+  TEST("set and get", S.get(3) == m && S(3,1,2) == 6.0 && S.element(1,2)[3] == 6.0, true);
+
+  // singular matrices invert to zero
+  vnl_matrix_fixed_batch<double,3,3> Si;
+  vnl_batch_inverse(S, Si);
+  TEST("singular inverse is zero", Si.get(3).absolute_value_max() == 0.0, true);
+
+  const vnl_gemm_level best = vnl_gemm_best_level();
+  for (int level = vnl_gemm_generic; level <= best; ++level)
+  {
+    vnl_gemm_set_level(vnl_gemm_level(level));
+    std::cout << "instruction set level " << level << '\n';
+    test_batch_kernels<double>(37, 1e-14, "double");
+    test_batch_kernels<float>(37, 1e-5, "float");
+  }
+  vnl_gemm_set_level(best);
+
+  // large enough to be split between threads
+  test_batch_kernels<double>(5000, 1e-14, "double");
+}
+
+TESTMAIN(test_matrix_fixed_batch);
@@ -1,10 +1,90 @@
 // This is core/vnl/tests/test_random.cxx
 #include <iostream>
 #include <cmath>
+#include <vector>
 #include <vcl_compiler.h>
+#include <vxl_config.h>
 #include <vnl/vnl_random.h>
+#include <vnl/vnl_thread_pool.h>
 #include <testlib/testlib_test.h>
 
+static void test_counter_based()
+{
+  std::cout << "*********************************\n"
+           << " Testing counter-based vnl_random\n"
+           << "*********************************\n";
+
+  // Known answers of Philox4x32-10 from the Random123 distribution
+  vnl_random zero(0ul, 0ul);
+  TEST("counter-based", zero.is_counter_based(), true);
+  TEST("Philox of zero counter and key",
+       zero.lrand32() == 0x6627e8d5ul && zero.lrand32() == 0xe169c58dul &&
+       zero.lrand32() == 0xbc57ac4cul && zero.lrand32() == 0x9b00dbd8ul, true);
+  vnl_random pi(vxl_uint_64(0x299f31d0a4093822ull), vxl_uint_64(0x0370734413198a2eull));
+  for (int i = 0; i < 4; ++i)
+    pi.discard(vxl_uint_64(0x85a308d3243f6a88ull)); // four times as many numbers as blocks
+  TEST("Philox of digits of pi",
+       pi.lrand32() == 0xd16cfe09ul && pi.lrand32() == 0x94fdccebul &&
+       pi.lrand32() == 0x5001e420ul && pi.lrand32() == 0x24126ea1ul, true);
+
+  // discard() gives what drawing the numbers gives
+  vnl_random a(9667566ul, 3ul), b(9667566ul, 3ul);
+  for (int i = 0; i < 1003; ++i) a.lrand32();
+  b.discard(1000);
+  b.discard(3);
+  TEST("discard", a.lrand32(), b.lrand32());
+  vnl_random c(9667566ul, 4ul);
+  c.discard(1004);
+  TEST("streams differ", a.lrand32() != c.lrand32(), true);
+  b = a;
+  TEST("copy", b.lrand32(), a.lrand32());
+  a.restart();
+  vnl_random d(9667566ul, 3ul);
+  TEST("restart", a.lrand32(), d.lrand32());
+
+  // bulk generation gives what single calls give, from any position
+  const unsigned n = 1001;
+  std::vector<double> x(n), y(n);
+  vnl_random e(42ul, 7ul), f(42ul, 7ul);
+  e.lrand32(); f.lrand32();
+  e.fill_drand64(&x[0], n, -2.0, 3.0);
+  bool same = true;
+  for (unsigned i = 0; i < n; ++i)
+    same = same && f.drand64(-2.0, 3.0) == x[i];
+  TEST("fill_drand64", same, true);
+  e.normal(); f.normal();
+  e.fill_normal(&x[0], n);
+  same = true;
+  for (unsigned i = 0; i < n; ++i)
+    same = same && f.normal64() == x[i];
+  TEST("fill_normal", same, true);
+  TEST("then in step", e.normal(), f.normal());
+
+  double sum = 0.0, sum_sq = 0.0;
+  const unsigned m = 100000;
+  std::vector<double> z(m);
+  e.fill_normal(&z[0], m);
+  for (unsigned i = 0; i < m; ++i)
+  {
+    sum += z[i];
+    sum_sq += z[i]*z[i];
+  }
+  TEST_NEAR("normal mean near zero", sum/m, 0.0, 0.01);
+  TEST_NEAR("normal var near one", sum_sq/m, 1.0, 0.02);
+
+  // one stream per task: the same whatever the number of threads
+  for (unsigned i = 0; i < n; ++i)
+  {
+    vnl_random rng(5ul, i);
+    x[i] = rng.normal() + rng.drand64();
+  }
+  vnl_parallel_for(n, [&](unsigned i) { vnl_random rng(5ul, i); y[i] = rng.normal() + rng.drand64(); }, 4);
+  TEST("threads give the same samples", x == y, true);
+
+  a.reseed(123456);
+  TEST("reseed returns to the original generator", a.is_counter_based(), false);
+}
+
 void test_random()
 {
   std::cout << "********************\n"
@@ -49,6 +129,8 @@ void test_random()
   var  = std::sqrt(sum_sq/n-mean*mean);
   TEST_NEAR("normal64() mean near zero",mean, 0.0, 0.01);
   TEST_NEAR("normal64() var near one",var, 1.0, 0.01);
+
+  test_counter_based();
 }
 
 TESTMAIN(test_random);
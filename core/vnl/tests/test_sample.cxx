@@ -3,6 +3,7 @@
 #include <testlib/testlib_test.h>
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_sample.h>
+#include <vnl/vnl_thread_pool.h>
 #include <vul/vul_get_timestamp.h> // to generate a random number
 
 static double eps = 0.02;
@@ -158,12 +159,40 @@ static void test_sample_bernoulli()
   TEST_NEAR("sample stddev squared", sigma_bar_sqr /= N-1, p*(1-p), eps);
 }
 
+static void test_sample_streams()
+{
+  std::cout << "*************** sample with streams ***************\n";
+  unsigned const N = 1000;
+  double X[N], Y[N];
+  for (unsigned i=0; i<N; ++i)
+  {
+    vnl_sample_reseed(17, i);
+    X[i] = vnl_sample_normal(1.0, 2.0) + vnl_sample_uniform(0.0, 1.0);
+  }
+  vnl_parallel_for(N, [&](unsigned i) {
+    vnl_sample_reseed(17, i);
+    Y[i] = vnl_sample_normal(1.0, 2.0) + vnl_sample_uniform(0.0, 1.0);
+  }, 4);
+  bool same = true;
+  for (unsigned i=0; i<N; ++i)
+    same = same && X[i] == Y[i];
+  TEST("same samples on several threads", same, true);
+
+  vnl_sample_reseed(17, 0);
+  double X_bar = 0;
+  for (unsigned i=0; i<100000; ++i)
+    X_bar += vnl_sample_uniform(0.0, 1.0);
+  TEST_NEAR("stream sample mean", X_bar/100000, 0.5, eps);
+  vnl_sample_reseed(17);
+}
+
 static void test_sample()
 {
   test_sample_normal();
   test_sample_uniform();
   test_sample_binomial();
   test_sample_bernoulli();
+  test_sample_streams();
 }
 
 TESTMAIN(test_sample);
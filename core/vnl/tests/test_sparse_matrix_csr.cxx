@@ -0,0 +1,170 @@
+// This is core/vnl/tests/test_sparse_matrix_csr.cxx
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <vcl_compiler.h>
+#include <testlib/testlib_test.h>
+//:
+// \file
+// \brief Check vnl_sparse_matrix_csr against vnl_sparse_matrix, on one thread and on several
+#include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_sparse_matrix_csr.h>
+#include <vnl/vnl_sparse_matrix_linear_system.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_random.h>
+
+//: Random rows x cols matrix with about per_row entries in each row, some rows empty
+static vnl_sparse_matrix<double> random_matrix(unsigned rows, unsigned cols, unsigned per_row,
+                                               vnl_random& rng)
+{
+  vnl_sparse_matrix<double> A(rows, cols);
+  for (unsigned r=0; r<rows; ++r)
+  {
+    if (r%7 == 3) continue;
+    unsigned n = 1 + rng.lrand32(2*per_row);
+    for (unsigned k=0; k<n; ++k)
+      A(r, rng.lrand32(cols-1)) += rng.drand64(-1.0, 1.0);
+  }
+  return A;
+}
+
+static vnl_vector<double> random_vector(unsigned n, vnl_random& rng)
+{
+  vnl_vector<double> x(n);
+  for (unsigned i=0; i<n; ++i)
+    x[i] = rng.drand64(-1.0, 1.0);
+  return x;
+}
+
+//: Compare all the products of C with those of A
+static void compare_products(vnl_sparse_matrix<double> const& A,
+                             vnl_sparse_matrix_csr<double> const& C,
+                             vnl_random& rng, const char* what)
+{
+  std::cout << what << ": " << A.rows() << 'x' << A.cols() << ", "
+            << C.nnz() << " entries, up to " << C.max_threads() << " threads\n";
+  vnl_vector<double> x = random_vector(A.cols(), rng), y, yc;
+  A.mult(x, y);
+  C.mult(x, yc);
+  TEST_NEAR("mult", (y-yc).inf_norm(), 0.0, 1e-12);
+
+  vnl_vector<double> u = random_vector(A.rows(), rng);
+  A.pre_mult(u, y);
+  C.pre_mult(u, yc);
+  TEST_NEAR("pre_mult", (y-yc).inf_norm(), 0.0, 1e-12);
+
+  A.diag_AtA(y);
+  C.diag_AtA(yc);
+  TEST_NEAR("diag_AtA", (y-yc).inf_norm(), 0.0, 1e-12);
+
+  // three right hand sides in fortran order
+  const unsigned m = 3;
+  std::vector<double> p(A.cols()*m), q(A.rows()*m), qc(A.rows()*m);
+  for (unsigned i=0; i<p.size(); ++i) p[i] = rng.drand64(-1.0, 1.0);
+  A.mult(A.cols(), m, p.data(), q.data());
+  C.mult(A.cols(), m, p.data(), qc.data());
+  double d = 0;
+  for (unsigned i=0; i<q.size(); ++i) d = std::max(d, std::fabs(q[i]-qc[i]));
+  TEST_NEAR("mult by fortran order matrix", d, 0.0, 1e-12);
+
+  // AtA times x must equal A^T (A x)
+  vnl_sparse_matrix_csr<double> AtA = C.AtA();
+  TEST("AtA size", AtA.rows()==A.cols() && AtA.cols()==A.cols(), true);
+  vnl_vector<double> Ax, AtAx;
+  A.mult(x, Ax);
+  A.pre_mult(Ax, y);
+  AtA.mult(x, AtAx);
+  TEST_NEAR("AtA", (y-AtAx).inf_norm(), 0.0, 1e-10);
+  A.diag_AtA(y);
+  d = 0;
+  for (unsigned i=0; i<A.cols(); ++i) d = std::max(d, std::fabs(AtA.get(i,i)-y[i]));
+  TEST_NEAR("diagonal of AtA", d, 0.0, 1e-12);
+}
+
+static void test_sparse_matrix_csr()
+{
+  vnl_random rng(5172);
+
+  // construction and element access
+  vnl_sparse_matrix_csr<double> E;
+  TEST("default is empty", E.rows()==0 && E.cols()==0 && E.nnz()==0, true);
+
+  vnl_sparse_matrix<double> S(4, 5);
+  S(0,4) = 1.0; S(0,1) = 2.0; S(2,2) = 3.0; S(3,0) = 4.0;
+  vnl_sparse_matrix_csr<double> C(S);
+  TEST("size", C.rows()==4 && C.cols()==5 && C.nnz()==4, true);
+  TEST("get stored entry", C.get(0,4)==1.0 && C.get(0,1)==2.0 && C.get(3,0)==4.0, true);
+  TEST("get missing entry", C.get(1,1)==0.0 && C.get(0,0)==0.0, true);
+  TEST("row starts", C.row_start()[0]==0 && C.row_start()[1]==2 && C.row_start()[2]==2 &&
+                     C.row_start()[4]==4, true);
+  TEST("columns sorted", C.col_index()[0]==1 && C.col_index()[1]==4, true);
+  TEST("as_sparse_matrix", C.as_sparse_matrix() == S, true);
+
+  vnl_sparse_matrix_csr<double> Ct = C.transpose();
+  TEST("transpose", Ct.rows()==5 && Ct.cols()==4 && Ct.get(4,0)==1.0 && Ct.get(0,3)==4.0 &&
+                    Ct.as_sparse_matrix() == S.transpose(), true);
+
+  // triplets in any order, with a repeated position
+  std::vector<unsigned> ri, ci;
+  std::vector<double> v;
+  ri.push_back(3); ci.push_back(0); v.push_back(4.0);
+  ri.push_back(0); ci.push_back(4); v.push_back(0.5);
+  ri.push_back(2); ci.push_back(2); v.push_back(3.0);
+  ri.push_back(0); ci.push_back(1); v.push_back(2.0);
+  ri.push_back(0); ci.push_back(4); v.push_back(0.5);
+  vnl_sparse_matrix_csr<double> T(4, 5, ri, ci, v);
+  TEST("triplets: repeated entries summed", T.nnz()==4 && T.get(0,4)==1.0, true);
+  TEST("triplets: same as sparse matrix", T.as_sparse_matrix() == S, true);
+
+  // Products, small enough for one part and large enough to be split
+  vnl_sparse_matrix<double> A = random_matrix(300, 200, 6, rng);
+  vnl_sparse_matrix_csr<double> Ac(A);
+  Ac.set_max_threads(1);
+  compare_products(A, Ac, rng, "small");
+
+  vnl_sparse_matrix<double> B = random_matrix(40000, 30000, 12, rng);
+  vnl_sparse_matrix_csr<double> Bc(B);
+  Bc.set_max_threads(1);
+  compare_products(B, Bc, rng, "large");
+  Bc.set_max_threads(4);
+  compare_products(B, Bc, rng, "large");
+
+  // The same matrix built from triplets
+  std::vector<unsigned> bi, bj;
+  std::vector<double> bv;
+  for (unsigned r=0; r<B.rows(); ++r)
+  {
+    vnl_sparse_matrix<double>::row const& row = B.get_row(r);
+    for (unsigned k=0; k<row.size(); ++k)
+    {
+      bi.push_back(r); bj.push_back(row[k].first); bv.push_back(row[k].second);
+    }
+  }
+  std::reverse(bi.begin(), bi.end());
+  std::reverse(bj.begin(), bj.end());
+  std::reverse(bv.begin(), bv.end());
+  vnl_sparse_matrix_csr<double> Bt(B.rows(), B.cols(), bi, bj, bv);
+  TEST("large triplets: same as sparse matrix", Bt.as_sparse_matrix() == B, true);
+
+  // float
+  vnl_sparse_matrix<float> F(3, 3);
+  F(0,0) = 1.0f; F(1,2) = 2.0f; F(2,1) = -1.0f;
+  vnl_vector<float> xf(3, 1.0f), yf;
+  vnl_sparse_matrix_csr<float>(F).mult(xf, yf);
+  TEST("float mult", yf[0]==1.0f && yf[1]==2.0f && yf[2]==-1.0f, true);
+
+  // The linear system adaptor uses the compressed copy
+  vnl_vector<double> b = random_vector(B.rows(), rng), x = random_vector(B.cols(), rng);
+  vnl_sparse_matrix_linear_system<double> ls(B, b);
+  vnl_vector<double> lx(B.rows()), ref;
+  ls.multiply(x, lx);
+  B.mult(x, ref);
+  TEST_NEAR("linear system multiply", (lx-ref).inf_norm(), 0.0, 1e-12);
+  vnl_vector<double> lt(B.cols());
+  ls.transpose_multiply(b, lt);
+  B.pre_mult(b, ref);
+  TEST_NEAR("linear system transpose_multiply", (lt-ref).inf_norm(), 0.0, 1e-12);
+}
+
+TESTMAIN(test_sparse_matrix_csr);
@@ -0,0 +1,110 @@
+//:
+// \file
+// \brief Tool to measure the speed of vnl_gemm, in GFLOP/s.
+// Times square products of float and double matrices with the simple
+// triple loop (for the smaller sizes) and with vnl_gemm at each level
+// available on this machine, on one thread and on all hardware threads.
+// Pass sizes on the command line to override the default list.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_thread_pool.h>
+#include <vnl/vnl_random.h>
+
+const char* level_name[] = { "generic", "avx2", "avx512" };
+
+//: Wall clock seconds for one call of f, best of a few runs
+template <class F>
+double best_time(F f)
+{
+  // enough runs for about a third of a second, and at least two
+  double best = 1e30;
+  unsigned n_runs = 2;
+  for (unsigned r=0; r<n_runs; ++r)
+  {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    f();
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+    if (t<best) best = t;
+    if (r==0 && t>0)
+      n_runs = std::max(2u, std::min(20u, unsigned(0.3/t)));
+  }
+  return best;
+}
+
+template <class T>
+void naive_product(unsigned n, const T* a, const T* b, T* c)
+{
+  for (unsigned i=0; i<n; ++i)
+    for (unsigned k=0; k<n; ++k)
+    {
+      T sum(0);
+      for (unsigned j=0; j<n; ++j)
+        sum += a[i*n+j]*b[j*n+k];
+      c[i*n+k] = sum;
+    }
+}
+
+template <class T>
+void run_for_type(const char* type_name, std::vector<unsigned> const& sizes)
+{
+  vnl_random rng(9667566);
+  const vnl_gemm_level best = vnl_gemm_best_level();
+  const unsigned hw = vnl_thread_pool::hardware_threads();
+  for (unsigned s=0; s<sizes.size(); ++s)
+  {
+    const unsigned n = sizes[s];
+    std::vector<T> a(n*n), b(n*n), c(n*n);
+    for (unsigned i=0; i<n*n; ++i)
+    {
+      a[i] = T(rng.drand64(-1.0, 1.0));
+      b[i] = T(rng.drand64(-1.0, 1.0));
+    }
+    const double flops = 2.0*n*n*n;
+    std::cout << type_name << ' ' << n << 'x' << n << ":\n";
+    if (n<=512)
+    {
+      double t = best_time([&]() { naive_product(n, &a[0], &b[0], &c[0]); });
+      std::cout << "  triple loop: " << flops/t*1e-9 << " GFLOP/s\n";
+    }
+    for (int l=vnl_gemm_generic; l<=best; ++l)
+    {
+      vnl_gemm_set_level(vnl_gemm_level(l));
+      for (unsigned threads=1; threads<=hw; threads = (threads==hw ? hw+1 : hw))
+      {
+        vnl_gemm_set_max_threads(threads);
+        double t = best_time([&]()
+        {
+          vnl_gemm(false, false, n, n, n, T(1), &a[0], n, &b[0], n, T(0), &c[0], n);
+        });
+        std::cout << "  " << level_name[l] << ", " << threads << " thread(s): "
+                  << flops/t*1e-9 << " GFLOP/s\n";
+      }
+    }
+  }
+  vnl_gemm_set_level(best);
+  vnl_gemm_set_max_threads(0);
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<unsigned> sizes;
+  for (int i=1; i<argc; ++i)
+    sizes.push_back(unsigned(std::atoi(argv[i])));
+  if (sizes.empty())
+  {
+    sizes.push_back(64);
+    sizes.push_back(256);
+    sizes.push_back(512);
+    sizes.push_back(1000);
+    sizes.push_back(2000);
+  }
+  run_for_type<double>("double", sizes);
+  run_for_type<float>("float", sizes);
+  return 0;
+}
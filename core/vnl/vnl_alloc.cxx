@@ -6,101 +6,259 @@
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <atomic>
 #include "vnl_alloc.h"
 
 #include <vcl_compiler.h>
 
-char*
-vnl_alloc::chunk_alloc(std::size_t size, int& nobjs)
+namespace
 {
-  char * result;
-  std::size_t total_bytes = size * nobjs;
-  std::size_t bytes_left = end_free - start_free;
+  union vnl_alloc_obj
+  {
+    union vnl_alloc_obj * free_list_link;
+    char client_data[1];    /* The client sees this.        */
+  };
 
-  if (bytes_left >= total_bytes) {
-    result = start_free;
-    start_free += total_bytes;
-    return result;
+  //: A thread keeps at most twice this many objects of one size before handing some on
+  const int vnl_alloc_batch = 64;
+
+  std::size_t vnl_alloc_freelist_index(std::size_t bytes)
+  {
+    return (bytes + VNL_ALLOC_ALIGN-1)/VNL_ALLOC_ALIGN - 1;
+  }
+
+  //: Central free lists, shared by all threads.
+  // Objects are only ever pushed one list at a time, or the whole list
+  // taken with an exchange, so compare-and-swap is free of the ABA problem.
+  std::atomic<vnl_alloc_obj*> vnl_alloc_central[VNL_ALLOC_NFREELISTS];
+
+  //: Push the list from head to tail onto central list i
+  void vnl_alloc_central_push(std::size_t i, vnl_alloc_obj* head, vnl_alloc_obj* tail)
+  {
+    vnl_alloc_obj* old = vnl_alloc_central[i].load(std::memory_order_relaxed);
+    do
+      tail->free_list_link = old;
+    while (!vnl_alloc_central[i].compare_exchange_weak(old, head, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+  }
+
+  //: The free lists and current chunk of one thread
+  class vnl_alloc_thread_cache
+  {
+   public:
+    vnl_alloc_thread_cache();
+
+    //: Hand every free object to the central pool
+    ~vnl_alloc_thread_cache();
+
+    void* allocate(std::size_t n);
+    void deallocate(void* p, std::size_t n);
+
+   private:
+    // Returns an object of size n, and optionally adds to size n free list.
+    void* refill(std::size_t n);
+    // Allocates a chunk for nobjs of size size.  nobjs may be reduced
+    // if it is inconvenient to allocate the requested number.
+    char* chunk_alloc(std::size_t size, int& nobjs);
+
+    vnl_alloc_obj* free_list_[VNL_ALLOC_NFREELISTS];
+    int count_[VNL_ALLOC_NFREELISTS];
+
+    // Chunk allocation state.
+    char* start_free_;
+    char* end_free_;
+    std::size_t heap_size_;
+  };
+
+  // Life cycle of this thread's vnl_alloc_thread_cache: 0 before it is
+  // constructed, 1 while it exists, 2 once it has been destroyed. Being
+  // trivially destructible, this can still be read while other
+  // thread-local objects release their memory at thread exit.
+  thread_local int vnl_alloc_thread_cache_status = 0;
+
+  thread_local vnl_alloc_thread_cache vnl_alloc_this_thread_cache;
+
+  vnl_alloc_thread_cache::vnl_alloc_thread_cache()
+    : start_free_(VXL_NULLPTR), end_free_(VXL_NULLPTR), heap_size_(0)
+  {
+    for (std::size_t i = 0; i < VNL_ALLOC_NFREELISTS; ++i)
+    {
+      free_list_[i] = VXL_NULLPTR;
+      count_[i] = 0;
+    }
+    vnl_alloc_thread_cache_status = 1;
   }
-  else if (bytes_left >= size) {
-    nobjs = int(bytes_left/size);
-    total_bytes = size * nobjs;
-    result = start_free;
-    start_free += total_bytes;
+
+  vnl_alloc_thread_cache::~vnl_alloc_thread_cache()
+  {
+    for (std::size_t i = 0; i < VNL_ALLOC_NFREELISTS; ++i)
+      if (free_list_[i])
+      {
+        vnl_alloc_obj* tail = free_list_[i];
+        while (tail->free_list_link)
+          tail = tail->free_list_link;
+        vnl_alloc_central_push(i, free_list_[i], tail);
+        free_list_[i] = VXL_NULLPTR;
+        count_[i] = 0;
+      }
+    vnl_alloc_thread_cache_status = 2;
+  }
+
+  void* vnl_alloc_thread_cache::allocate(std::size_t n)
+  {
+    const std::size_t i = vnl_alloc_freelist_index(n);
+    vnl_alloc_obj* result = free_list_[i];
+    if (result == VXL_NULLPTR)
+    {
+      // Take everything other threads have handed back for this size
+      result = vnl_alloc_central[i].exchange(VXL_NULLPTR, std::memory_order_acquire);
+      if (result == VXL_NULLPTR)
+        return refill((n + VNL_ALLOC_ALIGN-1) & ~std::size_t(VNL_ALLOC_ALIGN - 1));
+      int count = 0;
+      for (vnl_alloc_obj* p = result->free_list_link; p; p = p->free_list_link)
+        ++count;
+      count_[i] = count;
+    }
+    else
+      --count_[i];
+    free_list_[i] = result->free_list_link;
     return result;
   }
-  else
+
+  void vnl_alloc_thread_cache::deallocate(void* p, std::size_t n)
+  {
+    const std::size_t i = vnl_alloc_freelist_index(n);
+    vnl_alloc_obj* q = (vnl_alloc_obj*)p;
+    q->free_list_link = free_list_[i];
+    free_list_[i] = q;
+    if (++count_[i] < 2*vnl_alloc_batch)
+      return;
+
+    // Hand a batch to the central pool, for threads that free less than they allocate
+    vnl_alloc_obj* tail = q;
+    for (int k = 1; k < vnl_alloc_batch; ++k)
+      tail = tail->free_list_link;
+    free_list_[i] = tail->free_list_link;
+    count_[i] -= vnl_alloc_batch;
+    vnl_alloc_central_push(i, q, tail);
+  }
+
+  char* vnl_alloc_thread_cache::chunk_alloc(std::size_t size, int& nobjs)
   {
-    std::size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
-    // Try to make use of the left-over piece.
-    if (bytes_left > 0) {
-      obj *  * my_free_list =
-        free_list + FREELIST_INDEX(bytes_left);
-      ((obj *)start_free) -> free_list_link = *my_free_list;
-      *my_free_list = (obj *)start_free;
+    char * result;
+    std::size_t total_bytes = size * nobjs;
+    std::size_t bytes_left = end_free_ - start_free_;
+
+    if (bytes_left >= total_bytes) {
+      result = start_free_;
+      start_free_ += total_bytes;
+      return result;
+    }
+    else if (bytes_left >= size) {
+      nobjs = int(bytes_left/size);
+      total_bytes = size * nobjs;
+      result = start_free_;
+      start_free_ += total_bytes;
+      return result;
     }
-    start_free = (char*)std::malloc(bytes_to_get);
-    if (VXL_NULLPTR == start_free)
+    else
     {
-      obj *  * my_free_list, *p;
-      // Try to make do with what we have.  That can't
-      // hurt.  We do not try smaller requests, since that tends
-      // to result in disaster on multi-process machines.
-      for (std::size_t i = size; i <= VNL_ALLOC_MAX_BYTES; i += VNL_ALLOC_ALIGN)
+      std::size_t bytes_to_get = 2 * total_bytes + (((heap_size_ >> 4) + VNL_ALLOC_ALIGN-1) & ~std::size_t(VNL_ALLOC_ALIGN - 1));
+      // Try to make use of the left-over piece.
+      if (bytes_left > 0) {
+        const std::size_t i = vnl_alloc_freelist_index(bytes_left);
+        ((vnl_alloc_obj *)start_free_) -> free_list_link = free_list_[i];
+        free_list_[i] = (vnl_alloc_obj *)start_free_;
+        ++count_[i];
+      }
+      start_free_ = (char*)std::malloc(bytes_to_get);
+      if (VXL_NULLPTR == start_free_)
       {
-        my_free_list = free_list + FREELIST_INDEX(i);
-        p = *my_free_list;
-        if (VXL_NULLPTR != p) {
-          *my_free_list = p -> free_list_link;
-          start_free = (char *)p;
-          end_free = start_free + i;
-          return chunk_alloc(size, nobjs);
-          // Any leftover piece will eventually make it to the
-          // right free std::list.
+        // Try to make do with what we have.  That can't
+        // hurt.  We do not try smaller requests, since that tends
+        // to result in disaster on multi-process machines.
+        for (std::size_t i = size; i <= VNL_ALLOC_MAX_BYTES; i += VNL_ALLOC_ALIGN)
+        {
+          const std::size_t j = vnl_alloc_freelist_index(i);
+          vnl_alloc_obj* p = free_list_[j];
+          if (VXL_NULLPTR != p) {
+            free_list_[j] = p -> free_list_link;
+            --count_[j];
+            start_free_ = (char *)p;
+            end_free_ = start_free_ + i;
+            return chunk_alloc(size, nobjs);
+            // Any leftover piece will eventually make it to the
+            // right free std::list.
+          }
         }
+        start_free_ = (char*)std::malloc(bytes_to_get);
+        // This should either throw an
+        // exception or remedy the situation.  Thus we assume it
+        // succeeded.
+      }
+      heap_size_ += bytes_to_get;
+      end_free_ = start_free_ + bytes_to_get;
+      return chunk_alloc(size, nobjs);
+    }
+  }
+
+  /* Returns an object of size n, and optionally adds to size n free std::list.*/
+  /* We assume that n is properly aligned and that the free list is empty.     */
+  void* vnl_alloc_thread_cache::refill(std::size_t n)
+  {
+    int nobjs = 20;
+    char * chunk = chunk_alloc(n, nobjs);
+    vnl_alloc_obj * result;
+    vnl_alloc_obj * current_obj, * next_obj;
+
+    if (1 == nobjs) return chunk;
+    const std::size_t i = vnl_alloc_freelist_index(n);
+
+    /* Build free std::list in chunk */
+    result = (vnl_alloc_obj *)chunk;
+    free_list_[i] = next_obj = (vnl_alloc_obj *)(chunk + n);
+    count_[i] = nobjs - 1;
+    for (int k = 1; ; k++) {
+      current_obj = next_obj;
+      next_obj = (vnl_alloc_obj *)((char *)next_obj + n);
+      if (nobjs - 1 == k) {
+        current_obj -> free_list_link = VXL_NULLPTR;
+        break;
+      }
+      else {
+        current_obj -> free_list_link = next_obj;
       }
-      start_free = (char*)std::malloc(bytes_to_get);
-      // This should either throw an
-      // exception or remedy the situation.  Thus we assume it
-      // succeeded.
     }
-    heap_size += bytes_to_get;
-    end_free = start_free + bytes_to_get;
-    return chunk_alloc(size, nobjs);
+    return result;
   }
 }
 
+void* vnl_alloc::allocate(std::size_t n)
+{
+  if (n > VNL_ALLOC_MAX_BYTES) {
+    return (void*)new char[n];
+  }
+  if (vnl_alloc_thread_cache_status == 2)
+  {
+    // The thread is exiting: its objects may still be freed to the pool
+    return std::malloc(ROUND_UP(n));
+  }
+  return vnl_alloc_this_thread_cache.allocate(n);
+}
 
-/* Returns an object of size n, and optionally adds to size n free std::list.*/
-/* We assume that n is properly aligned.                                */
-/* We hold the allocation lock.                                         */
-void* vnl_alloc::refill(std::size_t n)
+void vnl_alloc::deallocate(void *p, std::size_t n)
 {
-  int nobjs = 20;
-  char * chunk = chunk_alloc(n, nobjs);
-  obj *  * my_free_list;
-  obj * result;
-  obj * current_obj, * next_obj;
-  int i;
-
-  if (1 == nobjs) return chunk;
-  my_free_list = free_list + FREELIST_INDEX(n);
-
-  /* Build free std::list in chunk */
-  result = (obj *)chunk;
-  *my_free_list = next_obj = (obj *)(chunk + n);
-  for (i = 1; ; i++) {
-    current_obj = next_obj;
-    next_obj = (obj *)((char *)next_obj + n);
-    if (nobjs - 1 == i) {
-      current_obj -> free_list_link = VXL_NULLPTR;
-      break;
-    }
-    else {
-      current_obj -> free_list_link = next_obj;
-    }
+  if (n > VNL_ALLOC_MAX_BYTES) {
+    delete [] (char*)p;
+    return;
   }
-  return result;
+  if (vnl_alloc_thread_cache_status == 2)
+  {
+    vnl_alloc_obj* q = (vnl_alloc_obj*)p;
+    vnl_alloc_central_push(vnl_alloc_freelist_index(n), q, q);
+    return;
+  }
+  vnl_alloc_this_thread_cache.deallocate(p, n);
 }
 
 void*
@@ -122,13 +280,6 @@ vnl_alloc::reallocate(void *p,
   return result;
 }
 
-char *vnl_alloc::start_free = VXL_NULLPTR;
-char *vnl_alloc::end_free = VXL_NULLPTR;
-std::size_t vnl_alloc::heap_size = 0;
-
-vnl_alloc::obj *
-vnl_alloc::free_list[VNL_ALLOC_NFREELISTS] = { VXL_NULLPTR };
-
 #ifdef TEST
 int main()
 {
@@ -23,16 +23,21 @@
 //    information that we can return the object to the proper free li*st
 //    without permanently losing part of the object.
 //
-// The first template parameter specifies whether more than one thread
-// may use this allocator.  It is safe to allocate an object from
-// one instance of a default_alloc and deallocate it with another
-// one.  This effectively transfers its ownership to the second one.
-// This may have undesirable effects on reference locality.
-// The second parameter is unreferenced and serves only to allow the
-// creation of multiple default_alloc instances.
+// Each thread keeps its own free lists, so allocate() and deallocate()
+// normally touch no shared state. A thread whose list for a size has
+// grown long hands a batch of objects to a central pool, and a thread
+// whose list is empty takes the whole central list for that size. The
+// central pool is updated with compare-and-swap only, never locked.
+// Memory is still obtained from malloc in chunks holding many objects,
+// each chunk private to the thread that requested it, and is never
+// returned to the system. An object may be freed by a thread other than
+// the one that allocated it.
 //
-// Note that containers built on different allocator instances have
-// different types, limiting the utility of this approach.
+// \verbatim
+//  Modifications
+//   Oct 2026 - per-thread free lists and a lock-free central pool, so that
+//              vnl_alloc may be used from several threads at once
+// \endverbatim
 
 #include <cstddef>
 #include <vcl_compiler.h>
@@ -47,80 +52,16 @@ class VNL_EXPORT vnl_alloc
   static std::size_t ROUND_UP(std::size_t bytes) {
     return (bytes + VNL_ALLOC_ALIGN-1) & ~(VNL_ALLOC_ALIGN - 1);
   }
-  union obj;
-  friend union obj;
-  union obj {
-    union obj * free_list_link;
-    char client_data[1];    /* The client sees this.        */
-  };
-# if defined ( _AIX )
-  static obj * free_list[];
-  // Specifying a size results in duplicate def for 4.1
-# else
-  static obj * free_list[VNL_ALLOC_NFREELISTS];
-# endif
-  static  std::size_t FREELIST_INDEX(std::size_t bytes) {
-    return (bytes + VNL_ALLOC_ALIGN-1)/VNL_ALLOC_ALIGN - 1;
-  }
-
-  // Returns an object of size n, and optionally adds to size n free li*st.
-  static void *refill(std::size_t n);
-  // Allocates a chunk for nobjs of size size.  nobjs may be reduced
-  // if it is inconvenient to allocate the requested number.
-  static char *chunk_alloc(std::size_t size, int &nobjs);
-
-  // Chunk allocation state.
-  static char *start_free;
-  static char *end_free;
-  static std::size_t heap_size;
-
-  class lock
-  {
-   public:
-    lock() {}
-    ~lock() {}
-  };
-  friend class lock;
 
  public:
   // this one is needed for proper vcl_simple_alloc wrapping
   typedef char value_type;
 
   /* n must be > 0      */
-  static void * allocate(std::size_t n) {
-    obj * * my_free_list;
-    obj *  result;
-
-    if (n > VNL_ALLOC_MAX_BYTES) {
-      return (void*)new char[n];
-    }
-    my_free_list = free_list + FREELIST_INDEX(n);
-    // Acquire the lock here with a constructor call.
-    // This ensures that it is released in exit or during stack
-    // unwinding.
-    result = *my_free_list;
-    if (result == VXL_NULLPTR) {
-      void *r = refill(ROUND_UP(n));
-      return r;
-    }
-    *my_free_list = result -> free_list_link;
-    return result;
-  };
+  static void * allocate(std::size_t n);
 
   /* p may not be 0 */
-  static void deallocate(void *p, std::size_t n)
-  {
-    obj *q = (obj *)p;
-    obj *  * my_free_list;
-
-    if (n > VNL_ALLOC_MAX_BYTES) {
-      delete [] (char*)p;
-      return;
-    }
-    my_free_list = free_list + FREELIST_INDEX(n);
-    q -> free_list_link = *my_free_list;
-    *my_free_list = q;
-  }
+  static void deallocate(void *p, std::size_t n);
 
   static void * reallocate(void *p, std::size_t old_sz, std::size_t new_sz);
 };
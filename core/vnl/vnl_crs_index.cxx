@@ -25,6 +25,18 @@ vnl_crs_index::vnl_crs_index(const std::vector<std::vector<bool> >& mask)
     }
   }
   row_ptr_[mask.size()] = k;
+
+  // counting sort of the elements by column, keeping rows in order
+  col_ptr_.assign(num_cols_+1, 0);
+  for (unsigned int e=0; e<col_idx_.size(); ++e)
+    ++col_ptr_[col_idx_[e]+1];
+  for (unsigned int j=0; j<num_cols_; ++j)
+    col_ptr_[j+1] += col_ptr_[j];
+  col_elem_.resize(col_idx_.size());
+  std::vector<int> next(col_ptr_.begin(), col_ptr_.end()-1);
+  for (unsigned int i=0; i<mask.size(); ++i)
+    for (int e=row_ptr_[i]; e<row_ptr_[i+1]; ++e)
+      col_elem_[next[col_idx_[e]]++] = idx_pair(e,i);
 }
 
 
@@ -67,16 +79,10 @@ vnl_crs_index::sparse_row(int i) const
 
 
 //: returns column \p j as a vector of index-row pairs
-// \note because of CRS this method is a bit less efficient than sparse_row
 vnl_crs_index::sparse_vector
 vnl_crs_index::sparse_col(int j) const
 {
-  sparse_vector col;
-  for (int i=0; i<num_rows(); ++i){
-    int idx = (*this)(i,j);
-    if (idx >= 0)
-      col.push_back(idx_pair(idx,i));
-  }
-
-  return col;
+  if (col_ptr_.empty())
+    return sparse_vector();
+  return sparse_vector(col_elem_.begin()+col_ptr_[j], col_elem_.begin()+col_ptr_[j+1]);
 }
@@ -12,6 +12,7 @@
 //
 // \verbatim
 //  Modifications
+//   Oct 2026 - keep a column index too, so sparse_col() no longer searches every row
 // \endverbatim
 //
 #include <vector>
@@ -31,7 +32,7 @@ class VNL_EXPORT vnl_crs_index
   typedef std::vector<idx_pair> sparse_vector;
 
   //: Constructor - default
-  vnl_crs_index() : num_cols_(0), col_idx_(), row_ptr_() {}
+  vnl_crs_index() : num_cols_(0), col_idx_(), row_ptr_(), col_ptr_(), col_elem_() {}
 
   //: Constructor - from a binary mask
   vnl_crs_index(const std::vector<std::vector<bool> >& mask);
@@ -52,7 +53,6 @@ class VNL_EXPORT vnl_crs_index
   sparse_vector sparse_row(int i) const;
 
   //: returns column \p j as a vector of index-row pairs
-  // \note because of CRS this method is a bit less efficient than sparse_row
   sparse_vector sparse_col(int j) const;
 
   //: return the index at location (i,j)
@@ -66,6 +66,10 @@ class VNL_EXPORT vnl_crs_index
   std::vector<int> col_idx_;
   //: The index of the first non-zero element in each row
   std::vector<int> row_ptr_;
+  //: The position in col_elem_ of the first non-zero element in each column
+  std::vector<int> col_ptr_;
+  //: The index and row of each non-zero element, column by column
+  sparse_vector col_elem_;
 };
 
 #endif // vnl_crs_index_h_
@@ -0,0 +1,373 @@
+// This is core/vnl/vnl_expr.h
+#ifndef vnl_expr_h_
+#define vnl_expr_h_
+//:
+// \file
+// \brief Lazy element-wise arithmetic on vnl_vector and vnl_matrix
+//
+// Each operator of vnl_vector and vnl_matrix returns a new object, so an
+// expression such as a + b*s - c allocates and fills two temporaries
+// before the result. Wrapping an operand in vnl_lazy() makes the
+// operators build a small expression object instead, which records the
+// operations and references the operands without copying them. Nothing
+// is computed until the expression is stored in a vnl_vector or
+// vnl_matrix; then every element is computed by one loop over all the
+// operands, which the compiler can vectorise, with no temporaries:
+// \code
+//   #include <vnl/vnl_expr.h>
+//   x = vnl_lazy(a) + vnl_lazy(b)*s - c;          // one loop, no allocation
+//   r -= alpha * vnl_lazy(q);
+//   vnl_vector<double> y = element_product(vnl_lazy(u), v) / 2.0;
+//   double e = (vnl_lazy(x) - x0).squared_magnitude();
+// \endcode
+// Only one operand of each operator needs to be lazy; the other may be a
+// plain vnl_vector (or vnl_matrix) or another expression. Note that in
+// vnl_lazy(a) + b*s the product b*s is computed by vnl_vector, eagerly,
+// before + is reached; write vnl_lazy(b)*s to fuse it too.
+//
+// Expressions support +, - and unary - between vectors (or matrices) of
+// the same size, +, -, * and / with a scalar on either side,
+// element_product() and element_quotient(), and the reductions sum(),
+// squared_magnitude() and dot_product(). There is no lazy matrix
+// product. The operators are only found when an operand is already a
+// lazy expression, so code that does not use vnl_lazy() is unaffected.
+//
+// Every element of the result depends only on the same element of each
+// operand, so the destination may also appear in the expression, as in
+// x = vnl_lazy(x)*2 + y. An expression refers to its operands, and must
+// not outlive them.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_matrix.h>
+
+//: Base of every lazy expression, to recognise them
+struct vnl_expr_tag {};
+
+//: Base of the lazy expression E, which is of vectors or, if M, of matrices.
+// E provides value_type, is_matrix, size(), rows(), cols() and element
+// access by operator[].
+template <class E, bool M>
+class vnl_expr : public vnl_expr_tag
+{
+ public:
+  //: The expression itself
+  E const& self() const { return static_cast<E const&>(*this); }
+
+  //: Number of elements
+  std::size_t size() const { return self().size(); }
+
+  //: Write all the elements to out[0..size()-1]
+  template <class U>
+  void assign_to(U* out) const
+  {
+    E const& e = self();
+    const std::size_t n = e.size();
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = U(e[i]);
+  }
+
+  //: Add all the elements to out[0..size()-1]
+  template <class U>
+  void add_to(U* out) const
+  {
+    E const& e = self();
+    const std::size_t n = e.size();
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] += U(e[i]);
+  }
+
+  //: Subtract all the elements from out[0..size()-1]
+  template <class U>
+  void subtract_from(U* out) const
+  {
+    E const& e = self();
+    const std::size_t n = e.size();
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] -= U(e[i]);
+  }
+
+  //: Sum of the elements
+  // (The return type is deduced as E is still incomplete here.)
+  auto sum() const
+  {
+    E const& e = self();
+    const std::size_t n = e.size();
+    typename E::value_type s(0);
+    for (std::size_t i = 0; i < n; ++i)
+      s += e[i];
+    return s;
+  }
+
+  //: Sum of the squares of the elements
+  auto squared_magnitude() const
+  {
+    E const& e = self();
+    const std::size_t n = e.size();
+    typename E::value_type s(0);
+    for (std::size_t i = 0; i < n; ++i)
+      s += e[i]*e[i];
+    return s;
+  }
+};
+
+//: The elements of a vnl_vector or vnl_matrix
+template <class T, bool M>
+class vnl_expr_ref : public vnl_expr<vnl_expr_ref<T, M>, M>
+{
+ public:
+  typedef T value_type;
+  static const bool is_matrix = M;
+  vnl_expr_ref(T const* data, unsigned rows, unsigned cols)
+    : data_(data), rows_(rows), cols_(cols) {}
+  std::size_t size() const { return std::size_t(rows_)*cols_; }
+  unsigned rows() const { return rows_; }
+  unsigned cols() const { return cols_; }
+  T operator[](std::size_t i) const { return data_[i]; }
+ private:
+  T const* data_;
+  unsigned rows_, cols_;
+};
+
+//: Lazy view of v, to start an expression
+template <class T>
+inline vnl_expr_ref<T, false> vnl_lazy(vnl_vector<T> const& v)
+{
+  return vnl_expr_ref<T, false>(v.data_block(), unsigned(v.size()), 1u);
+}
+
+//: Lazy view of M, to start an expression
+template <class T>
+inline vnl_expr_ref<T, true> vnl_lazy(vnl_matrix<T> const& M)
+{
+  return vnl_expr_ref<T, true>(M.data_block(), M.rows(), M.cols());
+}
+
+//: The element-wise operations
+struct vnl_expr_add { template <class T> static T apply(T a, T b) { return a + b; } };
+struct vnl_expr_sub { template <class T> static T apply(T a, T b) { return a - b; } };
+struct vnl_expr_mul { template <class T> static T apply(T a, T b) { return a * b; } };
+struct vnl_expr_div { template <class T> static T apply(T a, T b) { return a / b; } };
+
+//: Element-wise Op of two expressions of the same shape
+template <class L, class R, class Op>
+class vnl_expr_binary : public vnl_expr<vnl_expr_binary<L, R, Op>, L::is_matrix>
+{
+ public:
+  typedef typename L::value_type value_type;
+  static const bool is_matrix = L::is_matrix;
+  vnl_expr_binary(L const& l, R const& r) : l_(l), r_(r)
+  {
+    static_assert(L::is_matrix == R::is_matrix, "vnl_expr: vector and matrix mixed");
+    static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+                  "vnl_expr: element types differ");
+    assert(l.rows() == r.rows() && l.cols() == r.cols());
+  }
+  std::size_t size() const { return l_.size(); }
+  unsigned rows() const { return l_.rows(); }
+  unsigned cols() const { return l_.cols(); }
+  value_type operator[](std::size_t i) const { return Op::apply(l_[i], r_[i]); }
+ private:
+  L l_;
+  R r_;
+};
+
+//: Element-wise Op of an expression and a scalar, or of a scalar and an expression if scalar_first
+template <class E, class Op, bool scalar_first>
+class vnl_expr_scalar : public vnl_expr<vnl_expr_scalar<E, Op, scalar_first>, E::is_matrix>
+{
+ public:
+  typedef typename E::value_type value_type;
+  static const bool is_matrix = E::is_matrix;
+  vnl_expr_scalar(E const& e, value_type s) : e_(e), s_(s) {}
+  std::size_t size() const { return e_.size(); }
+  unsigned rows() const { return e_.rows(); }
+  unsigned cols() const { return e_.cols(); }
+  value_type operator[](std::size_t i) const
+  { return scalar_first ? Op::apply(s_, e_[i]) : Op::apply(e_[i], s_); }
+ private:
+  E e_;
+  value_type s_;
+};
+
+//: Element-wise negation
+template <class E>
+class vnl_expr_negate : public vnl_expr<vnl_expr_negate<E>, E::is_matrix>
+{
+ public:
+  typedef typename E::value_type value_type;
+  static const bool is_matrix = E::is_matrix;
+  explicit vnl_expr_negate(E const& e) : e_(e) {}
+  std::size_t size() const { return e_.size(); }
+  unsigned rows() const { return e_.rows(); }
+  unsigned cols() const { return e_.cols(); }
+  value_type operator[](std::size_t i) const { return -e_[i]; }
+ private:
+  E e_;
+};
+
+//: An operand as an expression: plain vectors and matrices become vnl_expr_ref
+template <class T>
+inline vnl_expr_ref<T, false> vnl_expr_operand(vnl_vector<T> const& v) { return vnl_lazy(v); }
+template <class T>
+inline vnl_expr_ref<T, true> vnl_expr_operand(vnl_matrix<T> const& M) { return vnl_lazy(M); }
+template <class E, bool M>
+inline E const& vnl_expr_operand(vnl_expr<E, M> const& e) { return e.self(); }
+
+//: True if A is a lazy expression
+template <class A>
+struct vnl_expr_is_expr
+{
+  enum { value = std::is_base_of<vnl_expr_tag, A>::value };
+};
+
+//: The expression type of an element-wise Op of a and b, if either of them is a lazy expression
+#define vnl_expr_binary_type(Op, A, B, a, b) \
+  typename std::enable_if<vnl_expr_is_expr<A>::value || vnl_expr_is_expr<B>::value, \
+    vnl_expr_binary<typename std::decay<decltype(vnl_expr_operand(a))>::type, \
+                    typename std::decay<decltype(vnl_expr_operand(b))>::type, Op> >::type
+
+//: a + b, element by element
+template <class A, class B>
+inline auto operator+(A const& a, B const& b) -> vnl_expr_binary_type(vnl_expr_add, A, B, a, b)
+{
+  return vnl_expr_binary_type(vnl_expr_add, A, B, a, b)(vnl_expr_operand(a), vnl_expr_operand(b));
+}
+
+//: a - b, element by element
+template <class A, class B>
+inline auto operator-(A const& a, B const& b) -> vnl_expr_binary_type(vnl_expr_sub, A, B, a, b)
+{
+  return vnl_expr_binary_type(vnl_expr_sub, A, B, a, b)(vnl_expr_operand(a), vnl_expr_operand(b));
+}
+
+//: a .* b, element by element
+template <class A, class B>
+inline auto element_product(A const& a, B const& b) -> vnl_expr_binary_type(vnl_expr_mul, A, B, a, b)
+{
+  return vnl_expr_binary_type(vnl_expr_mul, A, B, a, b)(vnl_expr_operand(a), vnl_expr_operand(b));
+}
+
+//: a ./ b, element by element
+template <class A, class B>
+inline auto element_quotient(A const& a, B const& b) -> vnl_expr_binary_type(vnl_expr_div, A, B, a, b)
+{
+  return vnl_expr_binary_type(vnl_expr_div, A, B, a, b)(vnl_expr_operand(a), vnl_expr_operand(b));
+}
+
+#undef vnl_expr_binary_type
+
+//: Sum of the products of corresponding elements of a and b, without forming either
+template <class A, class B>
+inline auto dot_product(A const& a, B const& b)
+  -> typename std::enable_if<vnl_expr_is_expr<A>::value || vnl_expr_is_expr<B>::value,
+                             typename std::decay<decltype(vnl_expr_operand(a))>::type::value_type>::type
+{
+  return element_product(a, b).sum();
+}
+
+#define vnl_expr_scalar_op(op, Op) \
+template <class E, bool M> \
+inline vnl_expr_scalar<E, Op, false> operator op(vnl_expr<E, M> const& e, typename E::value_type s) \
+{ return vnl_expr_scalar<E, Op, false>(e.self(), s); } \
+template <class E, bool M> \
+inline vnl_expr_scalar<E, Op, true> operator op(typename E::value_type s, vnl_expr<E, M> const& e) \
+{ return vnl_expr_scalar<E, Op, true>(e.self(), s); }
+vnl_expr_scalar_op(+, vnl_expr_add)
+vnl_expr_scalar_op(-, vnl_expr_sub)
+vnl_expr_scalar_op(*, vnl_expr_mul)
+vnl_expr_scalar_op(/, vnl_expr_div)
+#undef vnl_expr_scalar_op
+
+//: -e, element by element
+template <class E, bool M>
+inline vnl_expr_negate<E> operator-(vnl_expr<E, M> const& e)
+{
+  return vnl_expr_negate<E>(e.self());
+}
+
+//-----------------------------------------------------------------------------
+// Storing expressions in vnl_vector and vnl_matrix
+
+template <class T>
+template <class E>
+vnl_vector<T>::vnl_vector(vnl_expr<E, false> const& e)
+  : num_elmts(0), data(VXL_NULLPTR)
+{
+  this->set_size(e.size());
+  e.assign_to(this->data);
+}
+
+template <class T>
+template <class E>
+vnl_vector<T>& vnl_vector<T>::operator=(vnl_expr<E, false> const& e)
+{
+  this->set_size(e.size());
+  e.assign_to(this->data);
+  return *this;
+}
+
+template <class T>
+template <class E>
+vnl_vector<T>& vnl_vector<T>::operator+=(vnl_expr<E, false> const& e)
+{
+  assert(e.size() == this->size());
+  e.add_to(this->data);
+  return *this;
+}
+
+template <class T>
+template <class E>
+vnl_vector<T>& vnl_vector<T>::operator-=(vnl_expr<E, false> const& e)
+{
+  assert(e.size() == this->size());
+  e.subtract_from(this->data);
+  return *this;
+}
+
+template <class T>
+template <class E>
+vnl_matrix<T>::vnl_matrix(vnl_expr<E, true> const& e)
+  : num_rows(0), num_cols(0), data(VXL_NULLPTR)
+{
+  this->set_size(e.self().rows(), e.self().cols());
+  e.assign_to(this->data_block());
+}
+
+template <class T>
+template <class E>
+vnl_matrix<T>& vnl_matrix<T>::operator=(vnl_expr<E, true> const& e)
+{
+  this->set_size(e.self().rows(), e.self().cols());
+  e.assign_to(this->data_block());
+  return *this;
+}
+
+template <class T>
+template <class E>
+vnl_matrix<T>& vnl_matrix<T>::operator+=(vnl_expr<E, true> const& e)
+{
+  assert(e.self().rows() == this->rows() && e.self().cols() == this->cols());
+  e.add_to(this->data_block());
+  return *this;
+}
+
+template <class T>
+template <class E>
+vnl_matrix<T>& vnl_matrix<T>::operator-=(vnl_expr<E, true> const& e)
+{
+  assert(e.self().rows() == this->rows() && e.self().cols() == this->cols());
+  e.subtract_from(this->data_block());
+  return *this;
+}
+
+#endif // vnl_expr_h_
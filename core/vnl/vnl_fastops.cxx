@@ -13,6 +13,7 @@
 #include <cstring>
 #include <iostream>
 #include "vnl_fastops.h"
+#include <vnl/vnl_gemm.h>
 
 #include <vcl_compiler.h>
 
@@ -26,6 +27,11 @@ void vnl_fastops::AtA(vnl_matrix<double>& out, const vnl_matrix<double>& A)
 
   const unsigned int m = A.rows();
 
+  if (vnl_gemm_is_worthwhile(n, n, m)) {
+    vnl_gemm(true, false, n, n, m, 1.0, A.data_block(), n, A.data_block(), n, 0.0, out.data_block(), n);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double** ata = out.data_array();
 
@@ -73,6 +79,11 @@ void vnl_fastops::AB(vnl_matrix<double>& out, const vnl_matrix<double>& A, const
   if (out.rows() != ma || out.columns() != nb)
     out.set_size(ma,nb);
 
+  if (vnl_gemm_is_worthwhile(ma, nb, na)) {
+    vnl_gemm(false, false, ma, nb, na, 1.0, A.data_block(), na, B.data_block(), nb, 0.0, out.data_block(), nb);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** outdata = out.data_array();
@@ -105,6 +116,11 @@ void vnl_fastops::AtB(vnl_matrix<double>& out, const vnl_matrix<double>& A, cons
   if (out.rows() != na || out.columns() != nb)
     out.set_size(na,nb);
 
+  if (vnl_gemm_is_worthwhile(na, nb, ma)) {
+    vnl_gemm(true, false, na, nb, ma, 1.0, A.data_block(), na, B.data_block(), nb, 0.0, out.data_block(), nb);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** outdata = out.data_array();
@@ -197,6 +213,11 @@ void vnl_fastops::ABt(vnl_matrix<double>& out, const vnl_matrix<double>& A, cons
   if (out.rows() != ma || out.columns() != mb)
     out.set_size(ma,mb);
 
+  if (vnl_gemm_is_worthwhile(ma, mb, na)) {
+    vnl_gemm(false, true, ma, mb, na, 1.0, A.data_block(), na, B.data_block(), nb, 0.0, out.data_block(), mb);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** outdata = out.data_array();
@@ -346,6 +367,11 @@ void vnl_fastops::inc_X_by_AB(vnl_matrix<double>& X, const vnl_matrix<double>& A
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(ma, nb, na)) {
+    vnl_gemm(false, false, ma, nb, na, 1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
@@ -379,6 +405,11 @@ void vnl_fastops::dec_X_by_AB(vnl_matrix<double>& X, const vnl_matrix<double>& A
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(ma, nb, na)) {
+    vnl_gemm(false, false, ma, nb, na, -1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
@@ -412,6 +443,11 @@ void vnl_fastops::inc_X_by_AtB(vnl_matrix<double>& X, const vnl_matrix<double>&
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(na, nb, ma)) {
+    vnl_gemm(true, false, na, nb, ma, 1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
@@ -448,6 +484,11 @@ void vnl_fastops::dec_X_by_AtB(vnl_matrix<double>& X, const vnl_matrix<double>&
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(na, nb, ma)) {
+    vnl_gemm(true, false, na, nb, ma, -1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
@@ -616,6 +657,11 @@ void vnl_fastops::inc_X_by_ABt(vnl_matrix<double>& X, const vnl_matrix<double>&
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(ma, mb, na)) {
+    vnl_gemm(false, true, ma, mb, na, 1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
@@ -665,6 +711,11 @@ void vnl_fastops::dec_X_by_ABt(vnl_matrix<double>& X, const vnl_matrix<double>&
     std::abort();
   }
 
+  if (vnl_gemm_is_worthwhile(ma, mb, na)) {
+    vnl_gemm(false, true, ma, mb, na, -1.0, A.data_block(), na, B.data_block(), nb, 1.0, X.data_block(), nx);
+    return;
+  }
+
   double const* const* a = A.data_array();
   double const* const* b = B.data_array();
   double** x = X.data_array();
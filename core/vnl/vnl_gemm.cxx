@@ -0,0 +1,579 @@
+// This is core/vnl/vnl_gemm.cxx
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "vnl_gemm.h"
+//:
+// \file
+// \brief Blocked matrix product: packing, register-tiled kernels and threading
+//
+// The loops follow the usual layered scheme. For each slab of kc rows of
+// op(B) (and nc columns), the slab is packed into slivers of nr columns,
+// each stored p by p. Then blocks of mc rows of op(A) are packed into
+// slivers of mr rows, and every mr x nr tile of the block of C is
+// computed by a kernel holding the tile in vector registers, with one
+// broadcast of A and nr/width loads of B per step of p. A packed sliver of
+// B stays in the L1 cache while it is used with every sliver of A in the
+// block, which stays in L2.
+//
+// Tiles that overhang the edges of C are computed in a local buffer from
+// zero-padded slivers, then added to C.
+
+#include <vcl_compiler.h>
+#include <vnl/vnl_thread_pool.h>
+
+// AVX2 and AVX-512 code is compiled for that target function by function,
+// and only run if the processor supports it.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define VNL_GEMM_AVX2 1
+#define VNL_GEMM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#if defined(__clang__) || __GNUC__ >= 6
+#define VNL_GEMM_AVX512 1
+#define VNL_GEMM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define VNL_GEMM_AVX512 0
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && defined(_M_X64)
+#define VNL_GEMM_AVX2 1
+#define VNL_GEMM_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#if _MSC_VER >= 1910
+#define VNL_GEMM_AVX512 1
+#define VNL_GEMM_TARGET_AVX512
+#else
+#define VNL_GEMM_AVX512 0
+#endif
+#else
+#define VNL_GEMM_AVX2 0
+#define VNL_GEMM_AVX512 0
+#endif
+
+//: c = alpha*a*b + beta*c for an mr x nr tile, or alpha*a*b if beta is zero
+// a is a packed sliver of mr rows and b a packed sliver of nr columns,
+// both kc long.
+template <class T>
+struct vnl_gemm_kernel_fn
+{
+  typedef void (*type)(unsigned kc, const T* a, const T* b,
+                       T* c, std::ptrdiff_t ldc, T alpha, T beta);
+};
+
+//: Tile and block sizes, with the kernel that goes with them
+template <class T>
+struct vnl_gemm_config
+{
+  unsigned mr, nr, mc, kc, nc;
+  typename vnl_gemm_kernel_fn<T>::type kernel;
+};
+
+//: Write an accumulated tile value to c
+template <class T>
+inline void vnl_gemm_store(T& c, T acc, T alpha, T beta)
+{
+  c = (beta == T(0)) ? T(alpha*acc) : T(alpha*acc + beta*c);
+}
+
+//=======================================================================
+// Portable kernel
+//=======================================================================
+
+template <class T, unsigned MR, unsigned NR>
+static void vnl_gemm_generic_kernel(unsigned kc, const T* a, const T* b,
+                                    T* c, std::ptrdiff_t ldc, T alpha, T beta)
+{
+  T acc[MR][NR];
+  for (unsigned i=0; i<MR; ++i)
+    for (unsigned j=0; j<NR; ++j)
+      acc[i][j] = T(0);
+  for (unsigned p=0; p<kc; ++p, a+=MR, b+=NR)
+    for (unsigned i=0; i<MR; ++i)
+    {
+      const T ai = a[i];
+      for (unsigned j=0; j<NR; ++j)
+        acc[i][j] += ai*b[j];
+    }
+  for (unsigned i=0; i<MR; ++i)
+    for (unsigned j=0; j<NR; ++j)
+      vnl_gemm_store(c[i*ldc+j], acc[i][j], alpha, beta);
+}
+
+#if VNL_GEMM_AVX2
+
+//=======================================================================
+// AVX2 with FMA: 16 vector registers, so 6 rows by 2 vectors
+//=======================================================================
+
+template <class T> struct vnl_gemm_avx2_ops;
+
+template <> struct vnl_gemm_avx2_ops<double>
+{
+  typedef __m256d vec;
+  enum { width = 4 };
+  VNL_GEMM_TARGET_AVX2 static vec zero() { return _mm256_setzero_pd(); }
+  VNL_GEMM_TARGET_AVX2 static vec load(const double* p) { return _mm256_loadu_pd(p); }
+  VNL_GEMM_TARGET_AVX2 static void store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+  VNL_GEMM_TARGET_AVX2 static vec set1(double v) { return _mm256_set1_pd(v); }
+  VNL_GEMM_TARGET_AVX2 static vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+  VNL_GEMM_TARGET_AVX2 static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_pd(a, b, c); }
+};
+
+template <> struct vnl_gemm_avx2_ops<float>
+{
+  typedef __m256 vec;
+  enum { width = 8 };
+  VNL_GEMM_TARGET_AVX2 static vec zero() { return _mm256_setzero_ps(); }
+  VNL_GEMM_TARGET_AVX2 static vec load(const float* p) { return _mm256_loadu_ps(p); }
+  VNL_GEMM_TARGET_AVX2 static void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+  VNL_GEMM_TARGET_AVX2 static vec set1(float v) { return _mm256_set1_ps(v); }
+  VNL_GEMM_TARGET_AVX2 static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+  VNL_GEMM_TARGET_AVX2 static vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_ps(a, b, c); }
+};
+
+template <class T, unsigned MR, unsigned NV>
+VNL_GEMM_TARGET_AVX2
+static void vnl_gemm_avx2_kernel(unsigned kc, const T* a, const T* b,
+                                 T* c, std::ptrdiff_t ldc, T alpha, T beta)
+{
+  typedef vnl_gemm_avx2_ops<T> ops;
+  typedef typename ops::vec vec;
+  const unsigned W = ops::width, NR = NV*W;
+  vec acc[MR][NV];
+  for (unsigned i=0; i<MR; ++i)
+    for (unsigned v=0; v<NV; ++v)
+      acc[i][v] = ops::zero();
+  for (unsigned p=0; p<kc; ++p, a+=MR, b+=NR)
+  {
+    vec bv[NV];
+    for (unsigned v=0; v<NV; ++v)
+      bv[v] = ops::load(b+v*W);
+    for (unsigned i=0; i<MR; ++i)
+    {
+      const vec ai = ops::set1(a[i]);
+      for (unsigned v=0; v<NV; ++v)
+        acc[i][v] = ops::fmadd(ai, bv[v], acc[i][v]);
+    }
+  }
+  const vec va = ops::set1(alpha);
+  if (beta == T(0))
+  {
+    for (unsigned i=0; i<MR; ++i)
+      for (unsigned v=0; v<NV; ++v)
+        ops::store(c+i*ldc+v*W, ops::mul(va, acc[i][v]));
+  }
+  else
+  {
+    const vec vb = ops::set1(beta);
+    for (unsigned i=0; i<MR; ++i)
+      for (unsigned v=0; v<NV; ++v)
+        ops::store(c+i*ldc+v*W,
+                   ops::fmadd(va, acc[i][v], ops::mul(vb, ops::load(c+i*ldc+v*W))));
+  }
+}
+
+#endif // VNL_GEMM_AVX2
+
+#if VNL_GEMM_AVX512
+
+//=======================================================================
+// AVX-512: 32 vector registers, so 12 rows by 2 vectors
+//=======================================================================
+
+template <class T> struct vnl_gemm_avx512_ops;
+
+template <> struct vnl_gemm_avx512_ops<double>
+{
+  typedef __m512d vec;
+  enum { width = 8 };
+  VNL_GEMM_TARGET_AVX512 static vec zero() { return _mm512_setzero_pd(); }
+  VNL_GEMM_TARGET_AVX512 static vec load(const double* p) { return _mm512_loadu_pd(p); }
+  VNL_GEMM_TARGET_AVX512 static void store(double* p, vec v) { _mm512_storeu_pd(p, v); }
+  VNL_GEMM_TARGET_AVX512 static vec set1(double v) { return _mm512_set1_pd(v); }
+  VNL_GEMM_TARGET_AVX512 static vec mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+  VNL_GEMM_TARGET_AVX512 static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_pd(a, b, c); }
+};
+
+template <> struct vnl_gemm_avx512_ops<float>
+{
+  typedef __m512 vec;
+  enum { width = 16 };
+  VNL_GEMM_TARGET_AVX512 static vec zero() { return _mm512_setzero_ps(); }
+  VNL_GEMM_TARGET_AVX512 static vec load(const float* p) { return _mm512_loadu_ps(p); }
+  VNL_GEMM_TARGET_AVX512 static void store(float* p, vec v) { _mm512_storeu_ps(p, v); }
+  VNL_GEMM_TARGET_AVX512 static vec set1(float v) { return _mm512_set1_ps(v); }
+  VNL_GEMM_TARGET_AVX512 static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+  VNL_GEMM_TARGET_AVX512 static vec fmadd(vec a, vec b, vec c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+template <class T, unsigned MR, unsigned NV>
+VNL_GEMM_TARGET_AVX512
+static void vnl_gemm_avx512_kernel(unsigned kc, const T* a, const T* b,
+                                   T* c, std::ptrdiff_t ldc, T alpha, T beta)
+{
+  typedef vnl_gemm_avx512_ops<T> ops;
+  typedef typename ops::vec vec;
+  const unsigned W = ops::width, NR = NV*W;
+  vec acc[MR][NV];
+  for (unsigned i=0; i<MR; ++i)
+    for (unsigned v=0; v<NV; ++v)
+      acc[i][v] = ops::zero();
+  for (unsigned p=0; p<kc; ++p, a+=MR, b+=NR)
+  {
+    vec bv[NV];
+    for (unsigned v=0; v<NV; ++v)
+      bv[v] = ops::load(b+v*W);
+    for (unsigned i=0; i<MR; ++i)
+    {
+      const vec ai = ops::set1(a[i]);
+      for (unsigned v=0; v<NV; ++v)
+        acc[i][v] = ops::fmadd(ai, bv[v], acc[i][v]);
+    }
+  }
+  const vec va = ops::set1(alpha);
+  if (beta == T(0))
+  {
+    for (unsigned i=0; i<MR; ++i)
+      for (unsigned v=0; v<NV; ++v)
+        ops::store(c+i*ldc+v*W, ops::mul(va, acc[i][v]));
+  }
+  else
+  {
+    const vec vb = ops::set1(beta);
+    for (unsigned i=0; i<MR; ++i)
+      for (unsigned v=0; v<NV; ++v)
+        ops::store(c+i*ldc+v*W,
+                   ops::fmadd(va, acc[i][v], ops::mul(vb, ops::load(c+i*ldc+v*W))));
+  }
+}
+
+#endif // VNL_GEMM_AVX512
+
+//=======================================================================
+// Level selection
+//=======================================================================
+
+#if VNL_GEMM_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+//: Extended features (cpuid leaf 7, ebx) if the OS saves the registers in \p xcr0_mask
+static int vnl_gemm_cpu_features7(unsigned long long xcr0_mask)
+{
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return 0;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1<<27)) != 0, avx = (info[2] & (1<<28)) != 0;
+  const bool fma = (info[2] & (1<<12)) != 0;
+  if (!osxsave || !avx || !fma || (_xgetbv(0) & xcr0_mask) != xcr0_mask)
+    return 0;
+  __cpuidex(info, 7, 0);
+  return info[1];
+}
+#endif
+
+static bool vnl_gemm_cpu_has_avx2()
+{
+#if VNL_GEMM_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+  return (vnl_gemm_cpu_features7(0x6) & (1<<5)) != 0;
+#elif VNL_GEMM_AVX2
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0;
+#else
+  return false;
+#endif
+}
+
+static bool vnl_gemm_cpu_has_avx512()
+{
+#if VNL_GEMM_AVX512 && defined(_MSC_VER) && !defined(__clang__)
+  // avx512f, with the opmask and zmm registers saved
+  return (vnl_gemm_cpu_features7(0xe6) & (1<<16)) != 0;
+#elif VNL_GEMM_AVX512
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") != 0;
+#else
+  return false;
+#endif
+}
+
+vnl_gemm_level vnl_gemm_best_level()
+{
+  static const vnl_gemm_level best =
+    vnl_gemm_cpu_has_avx512() ? vnl_gemm_avx512 :
+    vnl_gemm_cpu_has_avx2() ? vnl_gemm_avx2 : vnl_gemm_generic;
+  return best;
+}
+
+//: Currently selected level, or -1 before the first use
+static std::atomic<int> vnl_gemm_current_level(-1);
+
+vnl_gemm_level vnl_gemm_get_level()
+{
+  int level = vnl_gemm_current_level.load(std::memory_order_relaxed);
+  if (level < 0)
+  {
+    level = vnl_gemm_best_level();
+    vnl_gemm_current_level.store(level, std::memory_order_relaxed);
+  }
+  return vnl_gemm_level(level);
+}
+
+vnl_gemm_level vnl_gemm_set_level(vnl_gemm_level level)
+{
+  if (level > vnl_gemm_best_level())
+    level = vnl_gemm_best_level();
+  vnl_gemm_current_level.store(level, std::memory_order_relaxed);
+  return level;
+}
+
+static std::atomic<unsigned> vnl_gemm_thread_limit(0);
+
+unsigned vnl_gemm_max_threads()
+{
+  return vnl_gemm_thread_limit.load(std::memory_order_relaxed);
+}
+
+void vnl_gemm_set_max_threads(unsigned n)
+{
+  vnl_gemm_thread_limit.store(n, std::memory_order_relaxed);
+}
+
+//: Kernel and blocking for the current level
+// mc is a multiple of mr, nc of nr. A block of mc x kc stays in L2, and
+// a sliver of kc x nr in L1.
+template <class T>
+static vnl_gemm_config<T> vnl_gemm_get_config()
+{
+  vnl_gemm_config<T> cfg;
+  const bool is_double = sizeof(T) == sizeof(double);
+  switch (vnl_gemm_get_level())
+  {
+#if VNL_GEMM_AVX512
+   case vnl_gemm_avx512:
+    cfg.mr = 12; cfg.nr = 2*vnl_gemm_avx512_ops<T>::width;
+    cfg.mc = 144; cfg.kc = is_double ? 256 : 384; cfg.nc = 4096;
+    cfg.kernel = &vnl_gemm_avx512_kernel<T, 12, 2>;
+    return cfg;
+#endif
+#if VNL_GEMM_AVX2
+   case vnl_gemm_avx2:
+    cfg.mr = 6; cfg.nr = 2*vnl_gemm_avx2_ops<T>::width;
+    cfg.mc = 144; cfg.kc = 256; cfg.nc = 4096;
+    cfg.kernel = &vnl_gemm_avx2_kernel<T, 6, 2>;
+    return cfg;
+#endif
+   default:
+    cfg.mr = 4; cfg.nr = is_double ? 4 : 8;
+    cfg.mc = 128; cfg.kc = 256; cfg.nc = 4096;
+    cfg.kernel = is_double ? &vnl_gemm_generic_kernel<T, 4, 4> : &vnl_gemm_generic_kernel<T, 4, 8>;
+    return cfg;
+  }
+}
+
+//=======================================================================
+// Packing
+//=======================================================================
+
+//: Pack rows [i0,i0+mc) and columns [p0,p0+kc) of op(A) into slivers of mr rows
+// Rows past the end are filled with zeros.
+template <class T>
+static void vnl_gemm_pack_a(bool trans, const T* A, std::ptrdiff_t lda,
+                            unsigned i0, unsigned mc, unsigned p0, unsigned kc,
+                            unsigned mr, T* out)
+{
+  for (unsigned s=0; s<mc; s+=mr)
+  {
+    const unsigned rows = std::min(mr, mc-s);
+    for (unsigned i=0; i<rows; ++i)
+    {
+      const unsigned row = i0+s+i;
+      T* o = out + i;
+      if (trans)
+      {
+        const T* a = A + std::ptrdiff_t(p0)*lda + row;
+        for (unsigned p=0; p<kc; ++p, a+=lda, o+=mr)
+          *o = *a;
+      }
+      else
+      {
+        const T* a = A + std::ptrdiff_t(row)*lda + p0;
+        for (unsigned p=0; p<kc; ++p, o+=mr)
+          *o = a[p];
+      }
+    }
+    for (unsigned i=rows; i<mr; ++i)
+    {
+      T* o = out + i;
+      for (unsigned p=0; p<kc; ++p, o+=mr)
+        *o = T(0);
+    }
+    out += std::size_t(mr)*kc;
+  }
+}
+
+//: Pack rows [p0,p0+kc) and slivers [s0,s1) of nr columns from column j0 of op(B)
+// Columns past n are filled with zeros.
+template <class T>
+static void vnl_gemm_pack_b(bool trans, const T* B, std::ptrdiff_t ldb,
+                            unsigned p0, unsigned kc, unsigned j0, unsigned n,
+                            unsigned nr, unsigned s0, unsigned s1, T* out)
+{
+  for (unsigned s=s0; s<s1; ++s)
+  {
+    T* o = out + std::size_t(s)*nr*kc;
+    const unsigned jb = j0 + s*nr;
+    const unsigned cols = std::min(nr, n-jb);
+    for (unsigned p=0; p<kc; ++p, o+=nr)
+    {
+      if (trans)
+      {
+        const T* b = B + std::ptrdiff_t(jb)*ldb + p0+p;
+        for (unsigned j=0; j<cols; ++j, b+=ldb)
+          o[j] = *b;
+      }
+      else
+      {
+        const T* b = B + std::ptrdiff_t(p0+p)*ldb + jb;
+        for (unsigned j=0; j<cols; ++j)
+          o[j] = b[j];
+      }
+      for (unsigned j=cols; j<nr; ++j)
+        o[j] = T(0);
+    }
+  }
+}
+
+//=======================================================================
+// Driver
+//=======================================================================
+
+//: C *= beta, or C = 0 if beta is zero
+template <class T>
+static void vnl_gemm_scale(unsigned m, unsigned n, T beta, T* C, unsigned ldc)
+{
+  for (unsigned i=0; i<m; ++i)
+  {
+    T* c = C + std::ptrdiff_t(i)*ldc;
+    for (unsigned j=0; j<n; ++j)
+      c[j] = (beta == T(0)) ? T(0) : T(beta*c[j]);
+  }
+}
+
+//: Number of threads worth using for a product of this size
+static unsigned vnl_gemm_n_threads(unsigned m, unsigned n, unsigned k)
+{
+  unsigned n_threads = vnl_gemm_max_threads();
+  if (n_threads == 0)
+    n_threads = vnl_thread_pool::hardware_threads();
+  // about 2^22 flops per thread makes the hand-off worthwhile
+  const double work = 2.0*double(m)*double(n)*double(k) / double(1<<22);
+  if (work < double(n_threads))
+    n_threads = work < 1.0 ? 1u : unsigned(work);
+  return n_threads;
+}
+
+template <class T>
+static void vnl_gemm_impl(bool trans_a, bool trans_b,
+                          unsigned m, unsigned n, unsigned k,
+                          T alpha, const T* A, unsigned lda,
+                          const T* B, unsigned ldb,
+                          T beta, T* C, unsigned ldc)
+{
+  if (m == 0 || n == 0)
+    return;
+  if (k == 0 || alpha == T(0))
+  {
+    vnl_gemm_scale(m, n, beta, C, ldc);
+    return;
+  }
+
+  const vnl_gemm_config<T> cfg = vnl_gemm_get_config<T>();
+  const unsigned mr = cfg.mr, nr = cfg.nr;
+  const unsigned n_threads = vnl_gemm_n_threads(m, n, k);
+
+  // Smaller blocks of rows if there would not be one per thread
+  unsigned mc = cfg.mc;
+  if (n_threads > 1)
+  {
+    const unsigned rows_per_thread = (m + n_threads - 1) / n_threads;
+    mc = std::min(mc, std::max(mr, (rows_per_thread + mr - 1) / mr * mr));
+  }
+  const unsigned n_iblocks = (m + mc - 1) / mc;
+
+  const unsigned nc_max = std::min(cfg.nc, (n + nr - 1) / nr * nr);
+  const unsigned kc_max = std::min(cfg.kc, k);
+  std::vector<T> packed_b(std::size_t(kc_max)*nc_max);
+
+  for (unsigned jc=0; jc<n; jc+=cfg.nc)
+  {
+    const unsigned nc = std::min(cfg.nc, n-jc);
+    const unsigned n_slivers = (nc + nr - 1) / nr;
+    // Split the columns too if there are still fewer blocks than threads
+    const unsigned n_jparts = std::min(n_slivers, (n_threads + n_iblocks - 1) / n_iblocks);
+
+    for (unsigned pc=0; pc<k; pc+=cfg.kc)
+    {
+      const unsigned kc = std::min(cfg.kc, k-pc);
+      const T beta_pc = (pc == 0) ? beta : T(1);
+      T* bp = &packed_b[0];
+
+      const unsigned n_bparts = std::min(n_threads, n_slivers);
+      vnl_parallel_for(n_bparts, [&](unsigned t)
+      {
+        vnl_gemm_pack_b(trans_b, B, ldb, pc, kc, jc, n, nr,
+                        t*n_slivers/n_bparts, (t+1)*n_slivers/n_bparts, bp);
+      }, n_threads);
+
+      vnl_parallel_for(n_iblocks*n_jparts, [&](unsigned t)
+      {
+        const unsigned ib = t / n_jparts, jp = t % n_jparts;
+        const unsigned ic = ib*mc, mcur = std::min(mc, m-ic);
+        std::vector<T> packed_a(std::size_t((mcur + mr - 1) / mr * mr)*kc);
+        vnl_gemm_pack_a(trans_a, A, lda, ic, mcur, pc, kc, mr, &packed_a[0]);
+
+        T tile[32*32];
+        const unsigned s1 = (jp+1)*n_slivers/n_jparts;
+        for (unsigned s=jp*n_slivers/n_jparts; s<s1; ++s)
+        {
+          const unsigned j = jc + s*nr, ncur = std::min(nr, n-j);
+          const T* b = bp + std::size_t(s)*nr*kc;
+          for (unsigned ir=0; ir<mcur; ir+=mr)
+          {
+            const T* a = &packed_a[0] + std::size_t(ir)*kc;
+            T* c = C + std::ptrdiff_t(ic+ir)*ldc + j;
+            const unsigned mcur_r = std::min(mr, mcur-ir);
+            if (mcur_r == mr && ncur == nr)
+              cfg.kernel(kc, a, b, c, ldc, alpha, beta_pc);
+            else
+            {
+              cfg.kernel(kc, a, b, tile, nr, T(1), T(0));
+              for (unsigned i=0; i<mcur_r; ++i)
+                for (unsigned jj=0; jj<ncur; ++jj)
+                  vnl_gemm_store(c[std::ptrdiff_t(i)*ldc+jj], tile[i*nr+jj], alpha, beta_pc);
+            }
+          }
+        }
+      }, n_threads);
+    }
+  }
+}
+
+void vnl_gemm(bool trans_a, bool trans_b,
+              unsigned m, unsigned n, unsigned k,
+              double alpha, const double* A, unsigned lda,
+              const double* B, unsigned ldb,
+              double beta, double* C, unsigned ldc)
+{
+  vnl_gemm_impl(trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void vnl_gemm(bool trans_a, bool trans_b,
+              unsigned m, unsigned n, unsigned k,
+              float alpha, const float* A, unsigned lda,
+              const float* B, unsigned ldb,
+              float beta, float* C, unsigned ldc)
+{
+  vnl_gemm_impl(trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
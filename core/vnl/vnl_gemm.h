@@ -0,0 +1,119 @@
+// This is core/vnl/vnl_gemm.h
+#ifndef vnl_gemm_h_
+#define vnl_gemm_h_
+//:
+// \file
+// \brief Blocked, vectorised and multithreaded matrix product for float and double
+//
+// vnl_gemm() computes C = alpha*op(A)*op(B) + beta*C for row-major
+// matrices, where op(X) is X or its transpose. The operands are copied
+// ("packed") in blocks sized for the L1 and L2 caches into the order the
+// inner kernel reads them, and each block of C is computed in registers
+// by a small kernel using AVX2 or AVX-512 fused multiply-adds. The
+// instruction set is chosen at run time from what the processor supports;
+// vnl_gemm_set_level() can lower it. Blocks of rows of C are shared
+// between threads with vnl_parallel_for().
+//
+// vnl_matrix<T>::operator*, vnl_matrix_fixed products and the
+// vnl_fastops matrix products use vnl_gemm() for float and double once
+// vnl_gemm_is_worthwhile() says the product is large enough; smaller
+// products keep their simple loops.
+//
+// Results can differ from the simple loops in the last bits, as the sums
+// are accumulated in a different order and with fused multiply-adds.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <vcl_compiler.h>
+#include "vnl/vnl_export.h"
+
+//: Instruction sets available to vnl_gemm()
+enum vnl_gemm_level
+{
+  //: Portable C++ kernel
+  vnl_gemm_generic = 0,
+  //: AVX2 and FMA kernel
+  vnl_gemm_avx2,
+  //: AVX-512 kernel
+  vnl_gemm_avx512
+};
+
+//: Most capable instruction set supported by this processor and build
+VNL_EXPORT vnl_gemm_level vnl_gemm_best_level();
+
+//: Instruction set currently used by vnl_gemm(); initially vnl_gemm_best_level()
+VNL_EXPORT vnl_gemm_level vnl_gemm_get_level();
+
+//: Set the instruction set used by vnl_gemm()
+// Levels above vnl_gemm_best_level() are reduced to it.
+// Returns the level actually selected.
+VNL_EXPORT vnl_gemm_level vnl_gemm_set_level(vnl_gemm_level level);
+
+//: Maximum number of threads used by one vnl_gemm() call
+// Zero (the default) means one per hardware thread.
+VNL_EXPORT unsigned vnl_gemm_max_threads();
+
+//: Set the maximum number of threads used by one vnl_gemm() call
+// Zero means one per hardware thread.
+VNL_EXPORT void vnl_gemm_set_max_threads(unsigned n);
+
+//: C = alpha*op(A)*op(B) + beta*C, with row-major storage.
+// op(A) is m x k and op(B) is k x n. If \p trans_a, A is stored as a
+// k x m matrix and op(A) is its transpose; likewise for \p trans_b.
+// lda, ldb and ldc are the distances between the starts of consecutive
+// rows of A, B and C as stored. If beta is zero, C need not be
+// initialised.
+VNL_EXPORT void vnl_gemm(bool trans_a, bool trans_b,
+                         unsigned m, unsigned n, unsigned k,
+                         double alpha, const double* A, unsigned lda,
+                         const double* B, unsigned ldb,
+                         double beta, double* C, unsigned ldc);
+
+//: C = alpha*op(A)*op(B) + beta*C, with row-major storage.
+VNL_EXPORT void vnl_gemm(bool trans_a, bool trans_b,
+                         unsigned m, unsigned n, unsigned k,
+                         float alpha, const float* A, unsigned lda,
+                         const float* B, unsigned ldb,
+                         float beta, float* C, unsigned ldc);
+
+//: True if an (m x k) times (k x n) product is large enough to be worth passing to vnl_gemm()
+// Below this the packing costs more than the simple loops lose.
+inline bool vnl_gemm_is_worthwhile(unsigned m, unsigned n, unsigned k)
+{
+  return m >= 8 && n >= 8 && k >= 8 &&
+         double(m)*double(n)*double(k) >= 32.0*32.0*32.0;
+}
+
+//: C = A*B for contiguous row-major A (m x k), B (k x n) and C (m x n), if it is worth using vnl_gemm()
+// Returns false, leaving C untouched, if T is not float or double or the
+// product is too small, so that templated callers can fall back to
+// their own loops.
+template <class T>
+inline bool vnl_gemm_multiply(unsigned /*m*/, unsigned /*n*/, unsigned /*k*/,
+                              const T* /*A*/, const T* /*B*/, T* /*C*/)
+{
+  return false;
+}
+
+inline bool vnl_gemm_multiply(unsigned m, unsigned n, unsigned k,
+                              const double* A, const double* B, double* C)
+{
+  if (!vnl_gemm_is_worthwhile(m, n, k))
+    return false;
+  vnl_gemm(false, false, m, n, k, 1.0, A, k, B, n, 0.0, C, n);
+  return true;
+}
+
+inline bool vnl_gemm_multiply(unsigned m, unsigned n, unsigned k,
+                              const float* A, const float* B, float* C)
+{
+  if (!vnl_gemm_is_worthwhile(m, n, k))
+    return false;
+  vnl_gemm(false, false, m, n, k, 1.0f, A, k, B, n, 0.0f, C, n);
+  return true;
+}
+
+#endif // vnl_gemm_h_
@@ -11,6 +11,7 @@
 #include "vnl_least_squares_function.h"
 #include <vcl_compiler.h>
 #include <vcl_cassert.h>
+#include <vnl/vnl_vector_ref.h>
 
 void vnl_least_squares_function::dim_warning(unsigned int number_of_unknowns,
                                              unsigned int number_of_residuals)
@@ -27,6 +28,22 @@ void vnl_least_squares_function::gradf(vnl_vector<double> const& /*x*/,
   std::cerr << "Warning: gradf() called but not implemented in derived class\n";
 }
 
+void vnl_least_squares_function::f_batch(vnl_matrix<double> const& x,
+                                         vnl_matrix<double>& fx)
+{
+  assert(x.columns() == get_number_of_unknowns());
+  assert(fx.columns() == get_number_of_residuals());
+  assert(fx.rows() == x.rows());
+
+  vnl_vector<double> xk(x.columns());
+  for (unsigned int k = 0; k < x.rows(); ++k)
+  {
+    xk.copy_in(x[k]);
+    vnl_vector_ref<double> fxk(fx.columns(), fx[k]);
+    this->f(xk, fxk);
+  }
+}
+
 //: Compute finite differences gradient using central differences.
 void vnl_least_squares_function::fdgradf(vnl_vector<double> const& x,
                                          vnl_matrix<double>& jacobian,
@@ -38,25 +55,47 @@ void vnl_least_squares_function::fdgradf(vnl_vector<double> const& x,
   assert(n == get_number_of_residuals());
   assert(dim == jacobian.columns());
 
-  vnl_vector<double> tx = x;
-  vnl_vector<double> fplus(n);
-  vnl_vector<double> fminus(n);
-  for (unsigned int i = 0; i < dim; ++i)
+  if (!has_batch())
   {
-    // calculate f just to the right of x[i]
-    double tplus = tx[i] = x[i] + stepsize;
-    this->f(tx, fplus);
+    vnl_vector<double> tx = x;
+    vnl_vector<double> fplus(n);
+    vnl_vector<double> fminus(n);
+    for (unsigned int i = 0; i < dim; ++i)
+    {
+      // calculate f just to the right of x[i]
+      double tplus = tx[i] = x[i] + stepsize;
+      this->f(tx, fplus);
 
-    // calculate f just to the left of x[i]
-    double tminus = tx[i] = x[i] - stepsize;
-    this->f(tx, fminus);
+      // calculate f just to the left of x[i]
+      double tminus = tx[i] = x[i] - stepsize;
+      this->f(tx, fminus);
 
-    double h = 1.0 / (tplus - tminus);
-    for (unsigned int j = 0; j < n; ++j)
-      jacobian(j,i) = (fplus[j] - fminus[j]) * h;
+      double h = 1.0 / (tplus - tminus);
+      for (unsigned int j = 0; j < n; ++j)
+        jacobian(j,i) = (fplus[j] - fminus[j]) * h;
 
-    // restore tx
-    tx[i] = x[i];
+      // restore tx
+      tx[i] = x[i];
+    }
+    return;
+  }
+
+  // calculate f just to the right (row 2i) and left (row 2i+1) of each x[i]
+  vnl_matrix<double> tx(2*dim, dim), fx(2*dim, n);
+  for (unsigned int i = 0; i < dim; ++i)
+  {
+    tx.set_row(2*i, x);
+    tx(2*i,i) = x[i] + stepsize;
+    tx.set_row(2*i+1, x);
+    tx(2*i+1,i) = x[i] - stepsize;
+  }
+  this->f_batch(tx, fx);
+
+  for (unsigned int i = 0; i < dim; ++i)
+  {
+    double h = 1.0 / (tx(2*i,i) - tx(2*i+1,i));
+    for (unsigned int j = 0; j < n; ++j)
+      jacobian(j,i) = (fx(2*i,j) - fx(2*i+1,j)) * h;
   }
 }
 
@@ -72,22 +111,43 @@ void vnl_least_squares_function::ffdgradf(vnl_vector<double> const& x,
   assert(n == get_number_of_residuals());
   assert(dim == jacobian.columns());
 
-  vnl_vector<double> tx = x;
-  vnl_vector<double> fplus(n);
   vnl_vector<double> fcentre(n);
   this->f(x, fcentre);
+
+  if (!has_batch())
+  {
+    vnl_vector<double> tx = x;
+    vnl_vector<double> fplus(n);
+    for (unsigned int i = 0; i < dim; ++i)
+    {
+      // calculate f just to the right of x[i]
+      double tplus = tx[i] = x[i] + stepsize;
+      this->f(tx, fplus);
+
+      double h = 1.0 / (tplus - x[i]);
+      for (unsigned int j = 0; j < n; ++j)
+        jacobian(j,i) = (fplus[j] - fcentre[j]) * h;
+
+      // restore tx
+      tx[i] = x[i];
+    }
+    return;
+  }
+
+  // calculate f just to the right of each x[i], all in one batch
+  vnl_matrix<double> tx(dim, dim), fplus(dim, n);
   for (unsigned int i = 0; i < dim; ++i)
   {
-    // calculate f just to the right of x[i]
-    double tplus = tx[i] = x[i] + stepsize;
-    this->f(tx, fplus);
+    tx.set_row(i, x);
+    tx(i,i) = x[i] + stepsize;
+  }
+  this->f_batch(tx, fplus);
 
-    double h = 1.0 / (tplus - x[i]);
+  for (unsigned int i = 0; i < dim; ++i)
+  {
+    double h = 1.0 / (tx(i,i) - x[i]);
     for (unsigned int j = 0; j < n; ++j)
-      jacobian(j,i) = (fplus[j] - fcentre[j]) * h;
-
-    // restore tx
-    tx[i] = x[i];
+      jacobian(j,i) = (fplus(i,j) - fcentre[j]) * h;
   }
 }
 
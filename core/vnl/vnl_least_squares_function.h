@@ -17,9 +17,11 @@
 //   20 Apr 1999 FSM Added failure flag so that f() and grad() may signal failure to the caller.
 //   23/3/01 LSB (Manchester) Tidied documentation
 //   Feb.2002 - Peter Vanroose - brief doxygen comment placed on single line
+//   Oct 2026 - Added f_batch() and clone() so finite-difference Jacobians can
+//              be evaluated many parameter vectors at a time, on several threads.
 // \endverbatim
 //
-// not used? #include <vcl_compiler.h>
+#include <vcl_compiler.h>
 #include <string>
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_matrix.h>
@@ -35,6 +37,13 @@
 //    want to cache some information during the call, and if they're compute
 //    objects, will almost certainly be writing to members during the
 //    computation.  For the moment it's non-const, but we'll see...
+//
+//    Because f is non-const, one object cannot be evaluated on several
+//    threads at once.  A class that can be copied into an independent
+//    evaluator should implement clone(); optimizers then give each thread
+//    its own copy.  A class that can evaluate many parameter vectors
+//    faster together than one at a time should implement f_batch() and
+//    set use_batch_ in its constructor.
 class VNL_EXPORT vnl_least_squares_function
 {
  public:
@@ -53,7 +62,7 @@ class VNL_EXPORT vnl_least_squares_function
                              unsigned int number_of_residuals,
                              UseGradient g = use_gradient)
   : failure(false), p_(number_of_unknowns), n_(number_of_residuals),
-    use_gradient_(g == use_gradient)
+    use_gradient_(g == use_gradient), use_batch_(false)
   { dim_warning(p_,n_); }
 
   virtual ~vnl_least_squares_function() {}
@@ -67,6 +76,19 @@ class VNL_EXPORT vnl_least_squares_function
   //  Fx has been sized appropriately before the call.
   virtual void f(vnl_vector<double> const& x, vnl_vector<double>& fx) = 0;
 
+  //: Evaluate f at many parameter vectors in one call.
+  //  Row k of fx is set to f(row k of x). x has get_number_of_unknowns()
+  //  columns and fx, sized before the call, has get_number_of_residuals()
+  //  columns. The default calls f() on each row in turn.
+  virtual void f_batch(vnl_matrix<double> const& x, vnl_matrix<double>& fx);
+
+  //: Return a new copy of this function that may be evaluated concurrently with it.
+  //  The copy's f() must return the same residuals as this one's, and
+  //  calling it must not touch any state shared with this object. The
+  //  caller deletes the copy. The default returns a null pointer, meaning
+  //  that this function can only be evaluated on one thread at a time.
+  virtual vnl_least_squares_function* clone() const { return VXL_NULLPTR; }
+
   //: Calculate the Jacobian, given the parameter vector x.
   virtual void gradf(vnl_vector<double> const& x, vnl_matrix<double>& jacobian);
 
@@ -96,10 +118,14 @@ class VNL_EXPORT vnl_least_squares_function
   //: Return true if the derived class has indicated that gradf has been implemented
   bool has_gradient() const { return use_gradient_; }
 
+  //: Return true if the derived class has indicated that f_batch is faster than calling f repeatedly
+  bool has_batch() const { return use_batch_; }
+
  protected:
   unsigned int p_;
   unsigned int n_;
   bool use_gradient_;
+  bool use_batch_;
 
   void init(unsigned int number_of_unknowns, unsigned int number_of_residuals)
   { p_ = number_of_unknowns; n_ = number_of_residuals; dim_warning(p_,n_); }
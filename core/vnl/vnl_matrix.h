@@ -34,6 +34,7 @@
 //   20 Mar 1997  - PVR - get_row, get_column.
 //   24-Oct-2010 - Peter Vanroose - mutators and filling methods now return *this
 //   18-Jan-2011 - Peter Vanroose - added methods set_diagonal() & get_diagonal()
+//   Oct 2026 - can be built from and assigned lazy expressions (vnl_expr.h)
 // \endverbatim
 
 #include <iosfwd>
@@ -55,6 +56,7 @@
 
 VCL_TEMPLATE_EXPORT template <class T> class vnl_vector;
 VCL_TEMPLATE_EXPORT template <class T> class vnl_matrix;
+template <class E, bool M> class vnl_expr;
 
 //--------------------------------------------------------------------------------
 
@@ -149,6 +151,10 @@ class VNL_TEMPLATE_EXPORT vnl_matrix
   // Complexity $O(r.c)$
   vnl_matrix(vnl_matrix<T> const&);                             // from another matrix.
 
+  //: Evaluates a lazy expression, such as vnl_lazy(A) - B*s (see vnl_expr.h).
+  template <class E>
+  vnl_matrix(vnl_expr<E, true> const& e);
+
 #ifndef VXL_DOXYGEN_SHOULD_SKIP_THIS
 // <internal>
   // These constructors are here so that operator* etc can take
@@ -291,6 +297,11 @@ class VNL_TEMPLATE_EXPORT vnl_matrix
   // Complexity $O(\min(r,c))$
   vnl_matrix<T>& operator=(vnl_matrix<T> const&);
 
+  //: Evaluate a lazy expression (see vnl_expr.h) into this matrix, in one pass.
+  //  The matrix is resized only if its size differs.
+  template <class E>
+  vnl_matrix<T>& operator=(vnl_expr<E, true> const& e);
+
   // ----------------------- Arithmetic --------------------------------
   // note that these functions should not pass scalar as a const&.
   // Look what would happen to A /= A(0,0).
@@ -311,6 +322,12 @@ class VNL_TEMPLATE_EXPORT vnl_matrix
   vnl_matrix<T>& operator+=(vnl_matrix<T> const&);
   //: Subtract rhs from lhs matrix in situ
   vnl_matrix<T>& operator-=(vnl_matrix<T> const&);
+  //: Add a lazy expression (see vnl_expr.h) in situ, in one pass
+  template <class E>
+  vnl_matrix<T>& operator+=(vnl_expr<E, true> const& e);
+  //: Subtract a lazy expression (see vnl_expr.h) in situ, in one pass
+  template <class E>
+  vnl_matrix<T>& operator-=(vnl_expr<E, true> const& e);
   //: Multiply lhs matrix in situ by rhs
   vnl_matrix<T>& operator*=(vnl_matrix<T> const&rhs) { return *this = (*this) * rhs; }
 
@@ -92,6 +92,7 @@
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_c_vector.h>
+#include <vnl/vnl_gemm.h>
 #include <vnl/vnl_numeric_traits.h>
 //--------------------------------------------------------------------------------
 
@@ -347,6 +348,11 @@ vnl_matrix<T>::vnl_matrix (vnl_matrix<T> const &A, vnl_matrix<T> const &B, vnl_t
   vnl_matrix_construct_hack();
   vnl_matrix_alloc_blah();
 
+  // large float and double products go to the blocked kernels
+  if (l > 0 && n > 0 && m > 0 &&
+      vnl_gemm_multiply(l, n, m, A.data[0], B.data[0], this->data[0]))
+    return;
+
   for (unsigned int i=0; i<l; ++i) {
     for (unsigned int k=0; k<n; ++k) {
       T sum(0);
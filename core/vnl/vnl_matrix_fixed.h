@@ -36,6 +36,7 @@
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_vector_fixed.h> // needed for e.g. vnl_matrix_fixed_mat_vec_mult()
 #include <vnl/vnl_c_vector.h>
+#include <vnl/vnl_gemm.h> // for vnl_matrix_fixed_mat_mat_mult()
 #include <vnl/vnl_config.h> // for VNL_CONFIG_CHECK_BOUNDS
 #include "vnl/vnl_export.h"
 
@@ -931,6 +932,9 @@ vnl_matrix_fixed_mat_mat_mult(const vnl_matrix_fixed<T, M, N>& a,
                               const vnl_matrix_fixed<T, N, O>& b)
 {
   vnl_matrix_fixed<T, M, O> out;
+  // large float and double products go to the blocked kernels
+  if (vnl_gemm_multiply(M, O, N, a.data_block(), b.data_block(), out.data_block()))
+    return out;
   for (unsigned i = 0; i < M; ++i)
     for (unsigned j = 0; j < O; ++j)
     {
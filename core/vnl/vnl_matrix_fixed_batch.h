@@ -0,0 +1,144 @@
+// This is core/vnl/vnl_matrix_fixed_batch.h
+#ifndef vnl_matrix_fixed_batch_h_
+#define vnl_matrix_fixed_batch_h_
+//:
+// \file
+// \brief Many small fixed-size matrices stored element by element, and kernels acting on all of them
+//
+// vnl_matrix_fixed_batch<T,R,C> holds N matrices of size R x C in
+// "structure of arrays" order: element (r,c) of all N matrices is stored
+// contiguously, one array per element. The batched functions below then
+// work on VNL_MATRIX_FIXED_BATCH_LANES matrices at a time, with every
+// arithmetic operation applied to all of them together, which lets the
+// compiler use one SIMD lane per matrix. The instruction set is the one
+// selected for vnl_gemm() (see vnl_gemm_set_level()); large batches are
+// also shared between threads with vnl_parallel_for().
+//
+// This pays when the same small operation is applied to thousands of
+// matrices, for instance transforming points by many homographies or
+// projecting many points with one camera. For a single matrix use
+// vnl_matrix_fixed, vnl_inverse() and vnl_det().
+//
+// The batch SVD and symmetric eigensystem are in vnl/algo
+// (vnl_svd_fixed_batch and vnl_symmetric_eigensystem_batch).
+//
+// The kernels are instantiated for float and double, and vnl_batch_mult()
+// for the sizes listed in vnl_matrix_fixed_batch.hxx; include that file
+// to instantiate other sizes.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vcl_cassert.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector.h>
+#include "vnl/vnl_export.h"
+
+//: Number of matrices the batched kernels process together.
+// Batches are padded to a multiple of this with zero matrices.
+#define VNL_MATRIX_FIXED_BATCH_LANES 16
+
+//: N matrices of size R x C, stored element by element
+template <class T, unsigned int R, unsigned int C>
+class vnl_matrix_fixed_batch
+{
+ public:
+  //: Construct an empty batch
+  vnl_matrix_fixed_batch() : n_(0), stride_(0) {}
+
+  //: Construct a batch of n zero matrices
+  explicit vnl_matrix_fixed_batch(std::size_t n) { set_size(n); }
+
+  //: Resize to n matrices, all set to zero
+  void set_size(std::size_t n)
+  {
+    n_ = n;
+    stride_ = (n + VNL_MATRIX_FIXED_BATCH_LANES - 1) / VNL_MATRIX_FIXED_BATCH_LANES
+              * VNL_MATRIX_FIXED_BATCH_LANES;
+    data_.assign(stride_*R*C, T(0));
+  }
+
+  //: Number of matrices
+  std::size_t size() const { return n_; }
+
+  //: Length of each element array, which is size() rounded up to a multiple of VNL_MATRIX_FIXED_BATCH_LANES
+  std::size_t stride() const { return stride_; }
+
+  //: Element (r,c) of every matrix, as an array of stride() values
+  T* element(unsigned int r, unsigned int c) { return data_block() + (r*C+c)*stride_; }
+  T const* element(unsigned int r, unsigned int c) const { return data_block() + (r*C+c)*stride_; }
+
+  //: Element (r,c) of matrix k
+  T& operator()(std::size_t k, unsigned int r, unsigned int c)
+  { assert(k < n_ && r < R && c < C); return data_[(r*C+c)*stride_ + k]; }
+  T const& operator()(std::size_t k, unsigned int r, unsigned int c) const
+  { assert(k < n_ && r < R && c < C); return data_[(r*C+c)*stride_ + k]; }
+
+  //: Set matrix k
+  void set(std::size_t k, vnl_matrix_fixed<T,R,C> const& m)
+  {
+    assert(k < n_);
+    for (unsigned int i = 0; i < R*C; ++i)
+      data_[i*stride_ + k] = m.data_block()[i];
+  }
+
+  //: Get matrix k
+  vnl_matrix_fixed<T,R,C> get(std::size_t k) const
+  {
+    assert(k < n_);
+    vnl_matrix_fixed<T,R,C> m;
+    for (unsigned int i = 0; i < R*C; ++i)
+      m.data_block()[i] = data_[i*stride_ + k];
+    return m;
+  }
+
+  //: All the element arrays, one after the other
+  T* data_block() { return data_.empty() ? VXL_NULLPTR : &data_[0]; }
+  T const* data_block() const { return data_.empty() ? VXL_NULLPTR : &data_[0]; }
+
+ private:
+  std::size_t n_;
+  std::size_t stride_;
+  std::vector<T> data_;
+};
+
+//: out[k] = A[k] * B[k] for every k.
+//  out is resized to the size of A and B, which must be equal.
+//  \relatesalso vnl_matrix_fixed_batch
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+VNL_TEMPLATE_EXPORT void vnl_batch_mult(vnl_matrix_fixed_batch<T,R,K> const& A,
+                                        vnl_matrix_fixed_batch<T,K,C> const& B,
+                                        vnl_matrix_fixed_batch<T,R,C>& out);
+
+//: out[k] = A * B[k] for every k, e.g. one camera applied to many points.
+//  \relatesalso vnl_matrix_fixed_batch
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+VNL_TEMPLATE_EXPORT void vnl_batch_mult(vnl_matrix_fixed<T,R,K> const& A,
+                                        vnl_matrix_fixed_batch<T,K,C> const& B,
+                                        vnl_matrix_fixed_batch<T,R,C>& out);
+
+//: det[k] = determinant of M[k]; det is resized to M.size()
+//  \relatesalso vnl_matrix_fixed_batch
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,2,2> const& M, vnl_vector<T>& det);
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,3,3> const& M, vnl_vector<T>& det);
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,4,4> const& M, vnl_vector<T>& det);
+
+//: out[k] = inverse of M[k], as vnl_inverse() would compute it.
+//  Matrices with zero determinant give zero matrices.
+//  \relatesalso vnl_matrix_fixed_batch
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,2,2> const& M, vnl_matrix_fixed_batch<T,2,2>& out);
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,3,3> const& M, vnl_matrix_fixed_batch<T,3,3>& out);
+template <class T>
+VNL_TEMPLATE_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,4,4> const& M, vnl_matrix_fixed_batch<T,4,4>& out);
+
+#endif // vnl_matrix_fixed_batch_h_
@@ -0,0 +1,423 @@
+// This is core/vnl/vnl_matrix_fixed_batch.hxx
+#ifndef vnl_matrix_fixed_batch_hxx_
+#define vnl_matrix_fixed_batch_hxx_
+//:
+// \file
+//
+// Every kernel is a function object whose operator() handles one block
+// of VNL_MATRIX_FIXED_BATCH_LANES matrices. It copies the block into
+// local arrays, with the lane index innermost, computes on them with
+// loops over the lanes and copies the results out, so the compiler can
+// keep the block in vector registers. vnl_batch_run() calls it for every
+// block from a function compiled for the chosen instruction set, into
+// which the kernel is inlined.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "vnl_matrix_fixed_batch.h"
+#include <vnl/vnl_gemm.h>
+#include <vnl/vnl_thread_pool.h>
+
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && (defined(__x86_64__) || defined(__i386__))
+#define VNL_BATCH_X86 1
+#define VNL_BATCH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define VNL_BATCH_TARGET_AVX512 __attribute__((target("avx512f")))
+#define VNL_BATCH_INLINE inline __attribute__((always_inline))
+#else
+#define VNL_BATCH_X86 0
+#define VNL_BATCH_INLINE inline
+#endif
+
+#define VNL_BATCH_L VNL_MATRIX_FIXED_BATCH_LANES
+
+//: Copy n element arrays of block b into x
+template <class T, unsigned int n>
+VNL_BATCH_INLINE void vnl_batch_load(T (&x)[n][VNL_BATCH_L], T const* p, std::size_t stride, std::size_t b)
+{
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+      x[i][l] = p[i*stride + b*VNL_BATCH_L + l];
+}
+
+//: Copy x into n element arrays of block b
+template <class T, unsigned int n>
+VNL_BATCH_INLINE void vnl_batch_store(T const (&x)[n][VNL_BATCH_L], T* p, std::size_t stride, std::size_t b)
+{
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+      p[i*stride + b*VNL_BATCH_L + l] = x[i][l];
+}
+
+template <class Kernel>
+static void vnl_batch_run_generic(Kernel const& k, std::size_t b0, std::size_t b1)
+{
+  for (std::size_t b = b0; b < b1; ++b)
+    k(b);
+}
+
+#if VNL_BATCH_X86
+template <class Kernel>
+VNL_BATCH_TARGET_AVX2 static void vnl_batch_run_avx2(Kernel const& k, std::size_t b0, std::size_t b1)
+{
+  for (std::size_t b = b0; b < b1; ++b)
+    k(b);
+}
+
+template <class Kernel>
+VNL_BATCH_TARGET_AVX512 static void vnl_batch_run_avx512(Kernel const& k, std::size_t b0, std::size_t b1)
+{
+  for (std::size_t b = b0; b < b1; ++b)
+    k(b);
+}
+#endif
+
+//: Call k(b) for each of n_blocks blocks
+// Batches of more than 64 blocks are split between threads.
+template <class Kernel>
+void vnl_batch_run(Kernel const& k, std::size_t n_blocks)
+{
+  const vnl_gemm_level level = vnl_gemm_get_level();
+  const unsigned int parts = n_blocks < 128 ? 1u :
+    (unsigned int)std::min<std::size_t>(n_blocks/64, 4*vnl_thread_pool::hardware_threads());
+  std::function<void(unsigned int)> part = [&](unsigned int p)
+  {
+    const std::size_t b0 = n_blocks*p/parts, b1 = n_blocks*(p+1)/parts;
+#if VNL_BATCH_X86
+    if (level == vnl_gemm_avx512)
+      vnl_batch_run_avx512(k, b0, b1);
+    else if (level == vnl_gemm_avx2)
+      vnl_batch_run_avx2(k, b0, b1);
+    else
+#endif
+      vnl_batch_run_generic(k, b0, b1);
+  };
+  if (parts == 1)
+    part(0);
+  else
+    vnl_parallel_for(parts, part);
+  (void)level;
+}
+
+//----------------------------------------------------------------------
+// Products
+
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+struct vnl_batch_mult_kernel
+{
+  T const* a; T const* b; T* o; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[R*K][VNL_BATCH_L], y[K*C][VNL_BATCH_L], z[R*C][VNL_BATCH_L];
+    vnl_batch_load<T,R*K>(x, a, stride, blk);
+    vnl_batch_load<T,K*C>(y, b, stride, blk);
+    for (unsigned int r = 0; r < R; ++r)
+      for (unsigned int c = 0; c < C; ++c)
+      {
+        for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+          z[r*C+c][l] = x[r*K][l] * y[c][l];
+        for (unsigned int k = 1; k < K; ++k)
+          for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+            z[r*C+c][l] += x[r*K+k][l] * y[k*C+c][l];
+      }
+    vnl_batch_store<T,R*C>(z, o, stride, blk);
+  }
+};
+
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+struct vnl_batch_mult_fixed_kernel
+{
+  T a[R*K]; T const* b; T* o; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T y[K*C][VNL_BATCH_L], z[R*C][VNL_BATCH_L];
+    vnl_batch_load<T,K*C>(y, b, stride, blk);
+    for (unsigned int r = 0; r < R; ++r)
+      for (unsigned int c = 0; c < C; ++c)
+      {
+        for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+          z[r*C+c][l] = a[r*K] * y[c][l];
+        for (unsigned int k = 1; k < K; ++k)
+          for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+            z[r*C+c][l] += a[r*K+k] * y[k*C+c][l];
+      }
+    vnl_batch_store<T,R*C>(z, o, stride, blk);
+  }
+};
+
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+void vnl_batch_mult(vnl_matrix_fixed_batch<T,R,K> const& A,
+                    vnl_matrix_fixed_batch<T,K,C> const& B,
+                    vnl_matrix_fixed_batch<T,R,C>& out)
+{
+  assert(A.size() == B.size());
+  if (out.size() != A.size())
+    out.set_size(A.size());
+  vnl_batch_mult_kernel<T,R,K,C> k;
+  k.a = A.data_block(); k.b = B.data_block(); k.o = out.data_block(); k.stride = A.stride();
+  vnl_batch_run(k, A.stride()/VNL_BATCH_L);
+}
+
+template <class T, unsigned int R, unsigned int K, unsigned int C>
+void vnl_batch_mult(vnl_matrix_fixed<T,R,K> const& A,
+                    vnl_matrix_fixed_batch<T,K,C> const& B,
+                    vnl_matrix_fixed_batch<T,R,C>& out)
+{
+  if (out.size() != B.size())
+    out.set_size(B.size());
+  vnl_batch_mult_fixed_kernel<T,R,K,C> k;
+  std::copy(A.data_block(), A.data_block()+R*K, k.a);
+  k.b = B.data_block(); k.o = out.data_block(); k.stride = B.stride();
+  vnl_batch_run(k, B.stride()/VNL_BATCH_L);
+}
+
+//----------------------------------------------------------------------
+// Determinants and inverses
+
+//: Store the first n-b*L lanes of block b of d into det
+template <class T>
+VNL_BATCH_INLINE void vnl_batch_store_tail(T const (&d)[VNL_BATCH_L], T* det, std::size_t n, std::size_t b)
+{
+  for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+    if (b*VNL_BATCH_L + l < n)
+      det[b*VNL_BATCH_L + l] = d[l];
+}
+
+template <class T>
+struct vnl_batch_det2_kernel
+{
+  T const* m; T* det; std::size_t stride, n;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[4][VNL_BATCH_L], d[VNL_BATCH_L];
+    vnl_batch_load<T,4>(x, m, stride, blk);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+      d[l] = x[0][l]*x[3][l] - x[1][l]*x[2][l];
+    vnl_batch_store_tail(d, det, n, blk);
+  }
+};
+
+template <class T>
+struct vnl_batch_det3_kernel
+{
+  T const* m; T* det; std::size_t stride, n;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[9][VNL_BATCH_L], d[VNL_BATCH_L];
+    vnl_batch_load<T,9>(x, m, stride, blk);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+      d[l] = x[0][l]*(x[4][l]*x[8][l] - x[5][l]*x[7][l])
+           - x[1][l]*(x[3][l]*x[8][l] - x[5][l]*x[6][l])
+           + x[2][l]*(x[3][l]*x[7][l] - x[4][l]*x[6][l]);
+    vnl_batch_store_tail(d, det, n, blk);
+  }
+};
+
+//: The 2x2 minors of the top two rows (s) and bottom two rows (c) of a 4x4 matrix
+template <class T>
+VNL_BATCH_INLINE void vnl_batch_minors4(T const (&x)[16][VNL_BATCH_L],
+                                        T (&s)[6][VNL_BATCH_L], T (&c)[6][VNL_BATCH_L])
+{
+  for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+  {
+    s[0][l] = x[0][l]*x[5][l] - x[4][l]*x[1][l];
+    s[1][l] = x[0][l]*x[6][l] - x[4][l]*x[2][l];
+    s[2][l] = x[0][l]*x[7][l] - x[4][l]*x[3][l];
+    s[3][l] = x[1][l]*x[6][l] - x[5][l]*x[2][l];
+    s[4][l] = x[1][l]*x[7][l] - x[5][l]*x[3][l];
+    s[5][l] = x[2][l]*x[7][l] - x[6][l]*x[3][l];
+    c[5][l] = x[10][l]*x[15][l] - x[14][l]*x[11][l];
+    c[4][l] = x[9][l]*x[15][l] - x[13][l]*x[11][l];
+    c[3][l] = x[9][l]*x[14][l] - x[13][l]*x[10][l];
+    c[2][l] = x[8][l]*x[15][l] - x[12][l]*x[11][l];
+    c[1][l] = x[8][l]*x[14][l] - x[12][l]*x[10][l];
+    c[0][l] = x[8][l]*x[13][l] - x[12][l]*x[9][l];
+  }
+}
+
+template <class T>
+struct vnl_batch_det4_kernel
+{
+  T const* m; T* det; std::size_t stride, n;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[16][VNL_BATCH_L], s[6][VNL_BATCH_L], c[6][VNL_BATCH_L], d[VNL_BATCH_L];
+    vnl_batch_load<T,16>(x, m, stride, blk);
+    vnl_batch_minors4(x, s, c);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+      d[l] = s[0][l]*c[5][l] - s[1][l]*c[4][l] + s[2][l]*c[3][l]
+           + s[3][l]*c[2][l] - s[4][l]*c[1][l] + s[5][l]*c[0][l];
+    vnl_batch_store_tail(d, det, n, blk);
+  }
+};
+
+template <class T>
+struct vnl_batch_inverse2_kernel
+{
+  T const* m; T* o; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[4][VNL_BATCH_L], y[4][VNL_BATCH_L];
+    vnl_batch_load<T,4>(x, m, stride, blk);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+    {
+      T d = x[0][l]*x[3][l] - x[1][l]*x[2][l];
+      d = d != T(0) ? T(1)/d : T(0);
+      y[0][l] =  x[3][l]*d; y[1][l] = -x[1][l]*d;
+      y[2][l] = -x[2][l]*d; y[3][l] =  x[0][l]*d;
+    }
+    vnl_batch_store<T,4>(y, o, stride, blk);
+  }
+};
+
+template <class T>
+struct vnl_batch_inverse3_kernel
+{
+  T const* m; T* o; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[9][VNL_BATCH_L], y[9][VNL_BATCH_L];
+    vnl_batch_load<T,9>(x, m, stride, blk);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+    {
+      // adjugate, by cofactors
+      y[0][l] = x[4][l]*x[8][l] - x[5][l]*x[7][l];
+      y[1][l] = x[2][l]*x[7][l] - x[1][l]*x[8][l];
+      y[2][l] = x[1][l]*x[5][l] - x[2][l]*x[4][l];
+      y[3][l] = x[5][l]*x[6][l] - x[3][l]*x[8][l];
+      y[4][l] = x[0][l]*x[8][l] - x[2][l]*x[6][l];
+      y[5][l] = x[2][l]*x[3][l] - x[0][l]*x[5][l];
+      y[6][l] = x[3][l]*x[7][l] - x[4][l]*x[6][l];
+      y[7][l] = x[1][l]*x[6][l] - x[0][l]*x[7][l];
+      y[8][l] = x[0][l]*x[4][l] - x[1][l]*x[3][l];
+      T d = x[0][l]*y[0][l] + x[1][l]*y[3][l] + x[2][l]*y[6][l];
+      d = d != T(0) ? T(1)/d : T(0);
+      for (unsigned int i = 0; i < 9; ++i)
+        y[i][l] *= d;
+    }
+    vnl_batch_store<T,9>(y, o, stride, blk);
+  }
+};
+
+template <class T>
+struct vnl_batch_inverse4_kernel
+{
+  T const* m; T* o; std::size_t stride;
+
+  VNL_BATCH_INLINE void operator()(std::size_t blk) const
+  {
+    T x[16][VNL_BATCH_L], s[6][VNL_BATCH_L], c[6][VNL_BATCH_L], y[16][VNL_BATCH_L];
+    vnl_batch_load<T,16>(x, m, stride, blk);
+    vnl_batch_minors4(x, s, c);
+    for (unsigned int l = 0; l < VNL_BATCH_L; ++l)
+    {
+      T d = s[0][l]*c[5][l] - s[1][l]*c[4][l] + s[2][l]*c[3][l]
+          + s[3][l]*c[2][l] - s[4][l]*c[1][l] + s[5][l]*c[0][l];
+      d = d != T(0) ? T(1)/d : T(0);
+      y[ 0][l] = ( x[ 5][l]*c[5][l] - x[ 6][l]*c[4][l] + x[ 7][l]*c[3][l])*d;
+      y[ 1][l] = (-x[ 1][l]*c[5][l] + x[ 2][l]*c[4][l] - x[ 3][l]*c[3][l])*d;
+      y[ 2][l] = ( x[13][l]*s[5][l] - x[14][l]*s[4][l] + x[15][l]*s[3][l])*d;
+      y[ 3][l] = (-x[ 9][l]*s[5][l] + x[10][l]*s[4][l] - x[11][l]*s[3][l])*d;
+      y[ 4][l] = (-x[ 4][l]*c[5][l] + x[ 6][l]*c[2][l] - x[ 7][l]*c[1][l])*d;
+      y[ 5][l] = ( x[ 0][l]*c[5][l] - x[ 2][l]*c[2][l] + x[ 3][l]*c[1][l])*d;
+      y[ 6][l] = (-x[12][l]*s[5][l] + x[14][l]*s[2][l] - x[15][l]*s[1][l])*d;
+      y[ 7][l] = ( x[ 8][l]*s[5][l] - x[10][l]*s[2][l] + x[11][l]*s[1][l])*d;
+      y[ 8][l] = ( x[ 4][l]*c[4][l] - x[ 5][l]*c[2][l] + x[ 7][l]*c[0][l])*d;
+      y[ 9][l] = (-x[ 0][l]*c[4][l] + x[ 1][l]*c[2][l] - x[ 3][l]*c[0][l])*d;
+      y[10][l] = ( x[12][l]*s[4][l] - x[13][l]*s[2][l] + x[15][l]*s[0][l])*d;
+      y[11][l] = (-x[ 8][l]*s[4][l] + x[ 9][l]*s[2][l] - x[11][l]*s[0][l])*d;
+      y[12][l] = (-x[ 4][l]*c[3][l] + x[ 5][l]*c[1][l] - x[ 6][l]*c[0][l])*d;
+      y[13][l] = ( x[ 0][l]*c[3][l] - x[ 1][l]*c[1][l] + x[ 2][l]*c[0][l])*d;
+      y[14][l] = (-x[12][l]*s[3][l] + x[13][l]*s[1][l] - x[14][l]*s[0][l])*d;
+      y[15][l] = ( x[ 8][l]*s[3][l] - x[ 9][l]*s[1][l] + x[10][l]*s[0][l])*d;
+    }
+    vnl_batch_store<T,16>(y, o, stride, blk);
+  }
+};
+
+template <class T>
+void vnl_batch_det(vnl_matrix_fixed_batch<T,2,2> const& M, vnl_vector<T>& det)
+{
+  det.set_size((unsigned int)M.size());
+  vnl_batch_det2_kernel<T> k = { M.data_block(), det.data_block(), M.stride(), M.size() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+template <class T>
+void vnl_batch_det(vnl_matrix_fixed_batch<T,3,3> const& M, vnl_vector<T>& det)
+{
+  det.set_size((unsigned int)M.size());
+  vnl_batch_det3_kernel<T> k = { M.data_block(), det.data_block(), M.stride(), M.size() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+template <class T>
+void vnl_batch_det(vnl_matrix_fixed_batch<T,4,4> const& M, vnl_vector<T>& det)
+{
+  det.set_size((unsigned int)M.size());
+  vnl_batch_det4_kernel<T> k = { M.data_block(), det.data_block(), M.stride(), M.size() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+template <class T>
+void vnl_batch_inverse(vnl_matrix_fixed_batch<T,2,2> const& M, vnl_matrix_fixed_batch<T,2,2>& out)
+{
+  if (out.size() != M.size())
+    out.set_size(M.size());
+  vnl_batch_inverse2_kernel<T> k = { M.data_block(), out.data_block(), M.stride() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+template <class T>
+void vnl_batch_inverse(vnl_matrix_fixed_batch<T,3,3> const& M, vnl_matrix_fixed_batch<T,3,3>& out)
+{
+  if (out.size() != M.size())
+    out.set_size(M.size());
+  vnl_batch_inverse3_kernel<T> k = { M.data_block(), out.data_block(), M.stride() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+template <class T>
+void vnl_batch_inverse(vnl_matrix_fixed_batch<T,4,4> const& M, vnl_matrix_fixed_batch<T,4,4>& out)
+{
+  if (out.size() != M.size())
+    out.set_size(M.size());
+  vnl_batch_inverse4_kernel<T> k = { M.data_block(), out.data_block(), M.stride() };
+  vnl_batch_run(k, M.stride()/VNL_BATCH_L);
+}
+
+#undef VNL_BATCH_L
+
+#define VNL_BATCH_MULT_INSTANTIATE(T, R, K, C) \
+template VNL_EXPORT void vnl_batch_mult(vnl_matrix_fixed_batch<T,R,K > const&, \
+                                        vnl_matrix_fixed_batch<T,K,C > const&, \
+                                        vnl_matrix_fixed_batch<T,R,C >&); \
+template VNL_EXPORT void vnl_batch_mult(vnl_matrix_fixed<T,R,K > const&, \
+                                        vnl_matrix_fixed_batch<T,K,C > const&, \
+                                        vnl_matrix_fixed_batch<T,R,C >&)
+
+#define VNL_MATRIX_FIXED_BATCH_INSTANTIATE(T) \
+template VNL_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,2,2 > const&, vnl_vector<T >&); \
+template VNL_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,3,3 > const&, vnl_vector<T >&); \
+template VNL_EXPORT void vnl_batch_det(vnl_matrix_fixed_batch<T,4,4 > const&, vnl_vector<T >&); \
+template VNL_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,2,2 > const&, vnl_matrix_fixed_batch<T,2,2 >&); \
+template VNL_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,3,3 > const&, vnl_matrix_fixed_batch<T,3,3 >&); \
+template VNL_EXPORT void vnl_batch_inverse(vnl_matrix_fixed_batch<T,4,4 > const&, vnl_matrix_fixed_batch<T,4,4 >&); \
+VNL_BATCH_MULT_INSTANTIATE(T, 2, 2, 1); \
+VNL_BATCH_MULT_INSTANTIATE(T, 2, 2, 2); \
+VNL_BATCH_MULT_INSTANTIATE(T, 3, 3, 1); \
+VNL_BATCH_MULT_INSTANTIATE(T, 3, 3, 3); \
+VNL_BATCH_MULT_INSTANTIATE(T, 3, 4, 1); \
+VNL_BATCH_MULT_INSTANTIATE(T, 3, 3, 4); \
+VNL_BATCH_MULT_INSTANTIATE(T, 3, 4, 4); \
+VNL_BATCH_MULT_INSTANTIATE(T, 4, 4, 1); \
+VNL_BATCH_MULT_INSTANTIATE(T, 4, 4, 4)
+
+#endif // vnl_matrix_fixed_batch_hxx_
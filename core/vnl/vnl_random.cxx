@@ -7,9 +7,98 @@
 
 #include <ctime>
 #include <cmath>
+#include <algorithm>
 #include "vnl_random.h"
 #include <vcl_compiler.h>
 #include <vcl_cassert.h>
+#include <vnl/vnl_math.h>
+
+namespace
+{
+  // Philox4x32-10 constants
+  const vxl_uint_32 philox_m0 = 0xD2511F53, philox_m1 = 0xCD9E8D57;
+  const vxl_uint_32 philox_w0 = 0x9E3779B9, philox_w1 = 0xBB67AE85;
+
+  //: One Philox4x32-10 round of the counter c with key k
+  inline void vnl_random_philox_round(vxl_uint_32& c0, vxl_uint_32& c1, vxl_uint_32& c2, vxl_uint_32& c3,
+                                      vxl_uint_32 k0, vxl_uint_32 k1)
+  {
+    const vxl_uint_64 p0 = vxl_uint_64(philox_m0) * c0;
+    const vxl_uint_64 p1 = vxl_uint_64(philox_m1) * c2;
+    c0 = vxl_uint_32(p1 >> 32) ^ c1 ^ k0;
+    c1 = vxl_uint_32(p1);
+    c2 = vxl_uint_32(p0 >> 32) ^ c3 ^ k1;
+    c3 = vxl_uint_32(p0);
+  }
+
+  //: Philox4x32-10 of the counters (b, stream) for blocks b = first .. first+nblocks-1.
+  // The four words of each block are written to out[4*(b-first) .. 4*(b-first)+3].
+  // Groups of eight blocks are computed side by side so that the compiler
+  // can vectorise the rounds.
+  void vnl_random_philox(vxl_uint_32 const key[2], vxl_uint_64 first, vxl_uint_64 stream,
+                         std::size_t nblocks, vxl_uint_32* out)
+  {
+    const unsigned lanes = 8;
+    const vxl_uint_32 s0 = vxl_uint_32(stream & 0xffffffff);
+    const vxl_uint_32 s1 = vxl_uint_32((vxl_uint_64(stream) >> 32) & 0xffffffff);
+    std::size_t b = 0;
+    for (; b + lanes <= nblocks; b += lanes)
+    {
+      vxl_uint_32 c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+      for (unsigned l = 0; l < lanes; ++l)
+      {
+        const vxl_uint_64 block = first + b + l;
+        c0[l] = vxl_uint_32(block);
+        c1[l] = vxl_uint_32(block >> 32);
+        c2[l] = s0;
+        c3[l] = s1;
+      }
+      vxl_uint_32 k0 = key[0], k1 = key[1];
+      for (int round = 0; round < 10; ++round)
+      {
+        for (unsigned l = 0; l < lanes; ++l)
+          vnl_random_philox_round(c0[l], c1[l], c2[l], c3[l], k0, k1);
+        k0 += philox_w0;
+        k1 += philox_w1;
+      }
+      for (unsigned l = 0; l < lanes; ++l)
+      {
+        vxl_uint_32* o = out + 4*(b + l);
+        o[0] = c0[l]; o[1] = c1[l]; o[2] = c2[l]; o[3] = c3[l];
+      }
+    }
+    for (; b < nblocks; ++b)
+    {
+      const vxl_uint_64 block = first + b;
+      vxl_uint_32 c0 = vxl_uint_32(block), c1 = vxl_uint_32(block >> 32), c2 = s0, c3 = s1;
+      vxl_uint_32 k0 = key[0], k1 = key[1];
+      for (int round = 0; round < 10; ++round)
+      {
+        vnl_random_philox_round(c0, c1, c2, c3, k0, k1);
+        k0 += philox_w0;
+        k1 += philox_w1;
+      }
+      vxl_uint_32* o = out + 4*b;
+      o[0] = c0; o[1] = c1; o[2] = c2; o[3] = c3;
+    }
+  }
+
+  //: The double drand64() makes from two 32-bit numbers, in [0,1]
+  inline double vnl_random_unit64(vxl_uint_32 w0, vxl_uint_32 w1)
+  {
+    return double(w0)/0xffffffff + double(w1)/(double(0xffffffff)*double(0xffffffff));
+  }
+
+  //: Box-Muller transform of the four numbers w, used by counter-based generators
+  inline void vnl_random_box_muller(vxl_uint_32 const w[4], double& x, double& y)
+  {
+    const double u = std::max(vnl_random_unit64(w[0], w[1]), 1e-300);
+    const double r = std::sqrt(-2.0*std::log(u));
+    const double theta = vnl_math::twopi * vnl_random_unit64(w[2], w[3]);
+    x = r*std::cos(theta);
+    y = r*std::sin(theta);
+  }
+}
 
 unsigned long vnl_random::linear_congruential_lrand32()
 {
@@ -26,17 +115,18 @@ vnl_random::vnl_random(unsigned long seed[vnl_random_array_size])
   : mz_array_position(0UL), mz_borrow(0), mz_previous_normal_flag(0)
 {reseed(seed);}
 
-vnl_random::vnl_random(const vnl_random& r)
-  : linear_congruential_previous(r.linear_congruential_previous)
-  , mz_array_position(r.mz_array_position)
-  , mz_borrow(r.mz_borrow)
-  , mz_previous_normal_flag(r.mz_previous_normal_flag)
+//: Construct a counter-based generator
+vnl_random::vnl_random(vxl_uint_64 seed, vxl_uint_64 stream)
+  : linear_congruential_previous((unsigned long)seed), mz_array_position(0UL), mz_borrow(0), mz_previous_normal_flag(0)
 {
   for (unsigned int i=0;i<vnl_random_array_size;++i)
-  {
-    mz_seed_array[i] = r.mz_seed_array[i];
-    mz_array[i] = r.mz_array[i];
-  }
+    mz_seed_array[i] = mz_array[i] = 0;
+  reseed(seed, stream);
+}
+
+vnl_random::vnl_random(const vnl_random& r)
+{
+  *this = r;
 }
 
 vnl_random& vnl_random::operator=(const vnl_random& r)
@@ -44,12 +134,21 @@ vnl_random& vnl_random::operator=(const vnl_random& r)
   linear_congruential_previous=r.linear_congruential_previous;
   mz_array_position=r.mz_array_position;
   mz_borrow=r.mz_borrow;
+  mz_previous_normal=r.mz_previous_normal;
   mz_previous_normal_flag=r.mz_previous_normal_flag;
   for (unsigned int i=0;i<vnl_random_array_size;++i)
   {
     mz_seed_array[i] = r.mz_seed_array[i];
     mz_array[i] = r.mz_array[i];
   }
+  use_philox=r.use_philox;
+  philox_key[0]=r.philox_key[0];
+  philox_key[1]=r.philox_key[1];
+  philox_stream=r.philox_stream;
+  philox_next_block=r.philox_next_block;
+  for (unsigned int i=0;i<4;++i)
+    philox_block[i]=r.philox_block[i];
+  philox_position=r.philox_position;
   return *this;
 }
 
@@ -74,6 +173,7 @@ void vnl_random::reseed()
 
 void vnl_random::reseed(unsigned long seed)
 {
+  philox_clear();
   mz_array_position = 0UL;
   mz_borrow = 0;
 
@@ -91,6 +191,7 @@ void vnl_random::reseed(unsigned long seed)
 
 void vnl_random::reseed(unsigned long seed[vnl_random_array_size])
 {
+  philox_clear();
   mz_array_position = 0UL;
   mz_borrow = 0L;
 
@@ -101,8 +202,39 @@ void vnl_random::reseed(unsigned long seed[vnl_random_array_size])
   }
 }
 
+//: Leave the counter-based mode, giving its state defined values
+void vnl_random::philox_clear()
+{
+  use_philox = false;
+  philox_key[0] = philox_key[1] = 0;
+  philox_stream = 0;
+  philox_next_block = 0;
+  for (unsigned int i=0;i<4;++i)
+    philox_block[i] = 0;
+  philox_position = 4;
+}
+
+void vnl_random::reseed(vxl_uint_64 seed, vxl_uint_64 stream)
+{
+  philox_clear();
+  use_philox = true;
+  philox_key[0] = vxl_uint_32(seed & 0xffffffff);
+  philox_key[1] = vxl_uint_32((seed >> 32) & 0xffffffff);
+  philox_stream = stream;
+  philox_next_block = 0;
+  philox_position = 4;
+  mz_previous_normal_flag = 0;
+}
+
 void vnl_random::restart()
 {
+  if (use_philox)
+  {
+    philox_next_block = 0;
+    philox_position = 4;
+    mz_previous_normal_flag = 0;
+    return;
+  }
   mz_array_position = 0UL;
 
   for (unsigned int i=0;i<vnl_random_array_size;++i)
@@ -111,6 +243,53 @@ void vnl_random::restart()
   }
 }
 
+void vnl_random::discard(vxl_uint_64 n)
+{
+  mz_previous_normal_flag = 0;
+  if (!use_philox)
+  {
+    for (; n > 0; --n) lrand32();
+    return;
+  }
+  // Block and position within it of the next number, counting in blocks
+  // so that nothing overflows before the block counter itself wraps
+  vxl_uint_64 block = philox_next_block;
+  unsigned int offset = 0;
+  if (philox_position < 4)
+  {
+    --block;
+    offset = philox_position;
+  }
+  offset += (unsigned int)(n%4);
+  block += n/4 + offset/4;
+  offset %= 4;
+  philox_next_block = block;
+  philox_position = 4;
+  if (offset)
+  {
+    vnl_random_philox(philox_key, philox_next_block++, philox_stream, 1, philox_block);
+    philox_position = offset;
+  }
+}
+
+//: Copy the next n numbers of a counter-based generator to words
+void vnl_random::philox_fill(vxl_uint_32* words, std::size_t n)
+{
+  for (; n > 0 && philox_position < 4; --n)
+    *words++ = philox_block[philox_position++];
+  const std::size_t nblocks = n/4;
+  vnl_random_philox(philox_key, philox_next_block, philox_stream, nblocks, words);
+  philox_next_block += nblocks;
+  words += 4*nblocks;
+  n -= 4*nblocks;
+  if (n > 0)
+  {
+    vnl_random_philox(philox_key, philox_next_block++, philox_stream, 1, philox_block);
+    for (philox_position = 0; philox_position < n; ++philox_position)
+      words[philox_position] = philox_block[philox_position];
+  }
+}
+
 double vnl_random::normal()
 {
   if (mz_previous_normal_flag)
@@ -118,6 +297,16 @@ double vnl_random::normal()
     mz_previous_normal_flag = 0;
     return mz_previous_normal;
   }
+  else if (use_philox)
+  {
+    vxl_uint_32 w[4];
+    philox_fill(w, 4);
+    double x, y;
+    vnl_random_box_muller(w, x, y);
+    mz_previous_normal = y;
+    mz_previous_normal_flag = 1;
+    return x;
+  }
   else
   {
     double x,y,r2;
@@ -143,6 +332,8 @@ double vnl_random::normal()
 // is from zero, the lower the number of bits on which it is random.
 double vnl_random::normal64()
 {
+  if (use_philox)
+    return normal();
   if (mz_previous_normal_flag)
   {
     mz_previous_normal_flag = 0;
@@ -167,6 +358,15 @@ double vnl_random::normal64()
 
 unsigned long vnl_random::lrand32()
 {
+  if (use_philox)
+  {
+    if (philox_position == 4)
+    {
+      vnl_random_philox(philox_key, philox_next_block++, philox_stream, 1, philox_block);
+      philox_position = 0;
+    }
+    return philox_block[philox_position++];
+  }
   unsigned long p1 = mz_array[(vnl_random_array_size + mz_array_position - mz_previous1)%vnl_random_array_size];
   unsigned long p2 = (p1 - mz_array[mz_array_position] - mz_borrow)&0xffffffff;
   if (p2 < p1) mz_borrow = 0;
@@ -217,5 +417,54 @@ double vnl_random::drand32(double lower, double upper)
 double vnl_random::drand64(double lower, double upper)
 {
   assert(lower <= upper);
-  return  (double(lrand32())/0xffffffff + double(lrand32())/(double(0xffffffff)*double(0xffffffff)))*(upper-lower) + lower;
+  vxl_uint_32 w0 = vxl_uint_32(lrand32());
+  vxl_uint_32 w1 = vxl_uint_32(lrand32());
+  return vnl_random_unit64(w0, w1)*(upper-lower) + lower;
+}
+
+void vnl_random::fill_drand64(double* x, std::size_t n, double lower, double upper)
+{
+  assert(lower <= upper);
+  if (!use_philox)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      x[i] = drand64(lower, upper);
+    return;
+  }
+  const std::size_t chunk = 256;
+  vxl_uint_32 w[2*chunk];
+  for (std::size_t i = 0; i < n; i += chunk)
+  {
+    const std::size_t m = std::min(chunk, n - i);
+    philox_fill(w, 2*m);
+    for (std::size_t j = 0; j < m; ++j)
+      x[i+j] = vnl_random_unit64(w[2*j], w[2*j+1])*(upper-lower) + lower;
+  }
+}
+
+void vnl_random::fill_normal(double* x, std::size_t n)
+{
+  if (!use_philox)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      x[i] = normal64();
+    return;
+  }
+  if (n > 0 && mz_previous_normal_flag)
+  {
+    *x++ = normal();
+    --n;
+  }
+  const std::size_t chunk = 128; // pairs
+  vxl_uint_32 w[4*chunk];
+  const std::size_t pairs = n/2;
+  for (std::size_t i = 0; i < pairs; i += chunk)
+  {
+    const std::size_t m = std::min(chunk, pairs - i);
+    philox_fill(w, 4*m);
+    for (std::size_t j = 0; j < m; ++j)
+      vnl_random_box_muller(w + 4*j, x[2*(i+j)], x[2*(i+j)+1]);
+  }
+  if (n%2)
+    x[n-1] = normal();
 }
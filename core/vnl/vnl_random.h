@@ -4,13 +4,20 @@
 #ifdef VCL_NEEDS_PRAGMA_INTERFACE
 #pragma interface
 #endif
+#include <cstddef>
 #include <vcl_compiler.h>
+#include <vxl_config.h>
 #include "vnl/vnl_export.h"
 
 //:
 // \file
 // \author Aaron Kotcheff (Manchester)
 // \brief A superior random number generator
+// \verbatim
+//  Modifications
+//   Oct 2026 - added a counter-based (Philox4x32-10) mode with jump-ahead,
+//              for reproducible parallel Monte Carlo, and bulk generation
+// \endverbatim
 
 VXL_CONSTEXPR_VAR unsigned int vnl_random_array_size = 37;
 
@@ -23,6 +30,17 @@ VXL_CONSTEXPR_VAR unsigned int vnl_random_array_size = 37;
 // For the mathematics behind it see:
 // "A New Class of Random Number Generators" G. Marsaglia and A. Zaman,
 // Annals of Applied Probability 1991, Vol. 1, No. 3, 462.
+//
+// Constructed with a seed and a stream number, the generator instead
+// uses the counter-based Philox4x32-10 generator of Salmon et al.
+// ("Parallel random numbers: as easy as 1, 2, 3", SC 2011). Number i of
+// stream s is then a fixed function of (seed, s, i), so a generator for
+// any stream is set up at once and discard() jumps ahead in constant
+// time. Giving each task of a parallel computation its own stream, e.g.
+// \code
+//   vnl_parallel_for(n, [&](unsigned i) { vnl_random rng(seed, i); ... });
+// \endcode
+// makes the result independent of how many threads run the tasks.
 class VNL_EXPORT vnl_random
 {
     enum {linear_congruential_multiplier = 1664525, mz_previous1 = 24};
@@ -36,6 +54,16 @@ class VNL_EXPORT vnl_random
     double mz_previous_normal;
     int mz_previous_normal_flag;
 
+    // Counter-based mode
+    bool use_philox;
+    vxl_uint_32 philox_key[2];
+    vxl_uint_64 philox_stream;
+    vxl_uint_64 philox_next_block;
+    vxl_uint_32 philox_block[4];
+    unsigned int philox_position;
+    void philox_clear();
+    void philox_fill(vxl_uint_32* words, std::size_t n);
+
  public:
     //: Default constructor.
     // Initializes the random number generator non-deterministically.
@@ -62,6 +90,13 @@ class VNL_EXPORT vnl_random
     //  produce the same series of random numbers.
     vnl_random(unsigned long seed[vnl_random_array_size]);
 
+    //: Construct a counter-based generator for stream number \p stream.
+    //  Generators with the same seed and stream produce the same
+    //  series of random numbers; different streams are independent.
+    //  Seed and stream are 64 bits wide on every platform.
+    //  Construction is cheap enough to do once per task.
+    vnl_random(vxl_uint_64 seed, vxl_uint_64 stream);
+
     //: Copy constructor.
     //  Initializes/sets the random number generator to exactly
     //  the same state as the argument, i.e. both will generate exactly
@@ -83,6 +118,19 @@ class VNL_EXPORT vnl_random
     //: Starts a new deterministic sequence from an already declared generator using the provided seed.
     void reseed(unsigned long[vnl_random_array_size]);
 
+    //: Starts stream number \p stream of the counter-based generator for the given seed.
+    //  The other reseed() functions return to the original generator.
+    void reseed(vxl_uint_64 seed, vxl_uint_64 stream);
+
+    //: True if this is a counter-based generator
+    bool is_counter_based() const { return use_philox; }
+
+    //: Skip the next \p n numbers that lrand32() would return.
+    //  Takes constant time for a counter-based generator, and time
+    //  proportional to n otherwise. Any normal value held over from the
+    //  last call to normal() is dropped.
+    void discard(vxl_uint_64 n);
+
     //: This restarts the sequence of random numbers.
     //  Restarts so that it repeats
     //  from the point at which you declared the generator, last
@@ -143,6 +191,18 @@ class VNL_EXPORT vnl_random
     // quantisation) is non-linearly dependent on the value. The further the
     // sample is from zero, the lower the number of bits on which it is random.
     double normal64();
+
+    //: Fill x[0..n-1] with random doubles in the range a <= x <= b with 64 bit randomness.
+    //  Gives the same values as n calls of drand64(a, b), but a
+    //  counter-based generator makes them several at a time.
+    void fill_drand64(double* x, std::size_t n, double a = 0.0, double b = 1.0);
+
+    //: Fill x[0..n-1] with random values from a unit normal distribution about zero.
+    //  Gives the same values as n calls of normal64(). A counter-based
+    //  generator uses the Box-Muller transform, with no rejection step,
+    //  for both normal() and normal64(), and makes the values several at
+    //  a time.
+    void fill_normal(double* x, std::size_t n);
 };
 
 #endif // vnl_random_h
@@ -7,6 +7,7 @@
 #include <ctime>
 #include "vnl_sample.h"
 #include <vnl/vnl_math.h>
+#include <vnl/vnl_random.h>
 
 #include <vcl_compiler.h>
 #include <vxl_config.h>
@@ -19,9 +20,16 @@
 static unsigned long vnl_sample_seed = 12345;
 #endif
 
+namespace
+{
+  // Generator of the calling thread, used once it has been given a stream
+  thread_local bool vnl_sample_use_stream = false;
+  thread_local vnl_random vnl_sample_stream(0ul, 0ul);
+}
 
 void vnl_sample_reseed()
 {
+  vnl_sample_use_stream = false;
 #if VXL_STDLIB_HAS_SRAND48
   srand48( std::time(VXL_NULLPTR) );
 #elif !VXL_STDLIB_HAS_DRAND48
@@ -31,6 +39,7 @@ void vnl_sample_reseed()
 
 void vnl_sample_reseed(int seed)
 {
+  vnl_sample_use_stream = false;
 #if VXL_STDLIB_HAS_SRAND48
   srand48( seed );
 #elif !VXL_STDLIB_HAS_DRAND48
@@ -38,8 +47,22 @@ void vnl_sample_reseed(int seed)
 #endif
 }
 
+void vnl_sample_reseed(int seed, vxl_uint_64 stream)
+{
+  vnl_sample_stream.reseed(vxl_uint_64(seed), stream);
+  vnl_sample_use_stream = true;
+}
+
 double vnl_sample_uniform(double a, double b)
 {
+  if (vnl_sample_use_stream)
+  {
+    // 53 random bits, uniform on [0, 1)
+    double hi = double(vnl_sample_stream.lrand32() >> 5);
+    double lo = double(vnl_sample_stream.lrand32() >> 6);
+    double u = (hi*67108864.0 + lo)/9007199254740992.0;
+    return (1.0 - u)*a + u*b;
+  }
 #if VXL_STDLIB_HAS_DRAND48
   double u = drand48(); // uniform on [0, 1)
 #else
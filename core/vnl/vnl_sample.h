@@ -5,6 +5,7 @@
 #pragma interface
 #endif
 
+#include <vxl_config.h>
 #include "vnl/vnl_export.h"
 //:
 //  \file
@@ -16,7 +17,18 @@
 //   2007-03-26 Peter Vanroose - avoid returning log(0.0) by switching params
 //   2010-09-12 Peter Vanroose - added implementation for binomial sampling
 //   2010-09-12 Peter Vanroose - added Bernoulli (unfair coin toss) sampling
+//   Oct 2026 - per-thread counter-based streams, for parallel Monte Carlo
 // \endverbatim
+//
+// By default all threads draw from one shared generator (drand48 where
+// available), which must not be used by two threads at once. A thread
+// that calls vnl_sample_reseed(seed, stream) draws from a generator of
+// its own instead: stream number \p stream of the counter-based
+// vnl_random. A parallel loop that reseeds with the index of each task,
+// \code
+//   vnl_parallel_for(n, [&](unsigned i) { vnl_sample_reseed(seed, i); ... });
+// \endcode
+// draws the same samples for each task whatever the number of threads.
 
 //: re-seed the random number generator.
 VNL_EXPORT void vnl_sample_reseed();
@@ -24,6 +36,11 @@ VNL_EXPORT void vnl_sample_reseed();
 //: re-seed the random number generator given a seed.
 VNL_EXPORT void vnl_sample_reseed(int seed);
 
+//: make the calling thread draw from stream \p stream of a counter-based generator.
+// vnl_sample_reseed() and vnl_sample_reseed(int) return the calling thread to the
+// shared generator.
+VNL_EXPORT void vnl_sample_reseed(int seed, vxl_uint_64 stream);
+
 //: return a random number uniformly drawn on [a, b)
 VNL_EXPORT double vnl_sample_uniform(double a, double b);
 
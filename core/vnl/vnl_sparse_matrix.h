@@ -160,6 +160,9 @@ class VNL_TEMPLATE_EXPORT vnl_sparse_matrix
   //  Added to aid binary I/O
   row& get_row(unsigned int r) {return elements[r];}
 
+  //: Return row as vector of pairs
+  row const& get_row(unsigned int r) const {return elements[r];}
+
   //: Laminate matrix A onto the bottom of this one
   vnl_sparse_matrix<T>& vcat(vnl_sparse_matrix<T> const& A);
 
@@ -0,0 +1,125 @@
+// This is core/vnl/vnl_sparse_matrix_csr.h
+#ifndef vnl_sparse_matrix_csr_h_
+#define vnl_sparse_matrix_csr_h_
+//:
+// \file
+// \brief Frozen compressed sparse row matrix with multithreaded products
+//
+// vnl_sparse_matrix_csr<T> holds a sparse matrix in three flat arrays:
+// the column indices and values of all the stored entries, row after
+// row, and the offset of the start of each row in them. A double entry
+// costs 12 bytes and there is no allocation per row, so products stream
+// through memory instead of chasing one heap block per row. The matrix
+// cannot be edited once built; build it from a vnl_sparse_matrix<T>, or
+// in bulk from (row, column, value) triplets.
+//
+// mult(), pre_mult() and AtA() split their work between threads with
+// vnl_parallel_for() once the matrix is large enough for that to pay.
+// Sparse products are limited by memory bandwidth rather than by
+// arithmetic, so the row loops are written to let the compiler keep
+// several independent sums in flight rather than using explicit SIMD.
+//
+// vnl_sparse_matrix_linear_system (and so vnl_lsqr) and
+// vnl_sparse_symmetric_eigensystem copy their matrices into this form.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <cstddef>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_sparse_matrix.h>
+#include "vnl/vnl_export.h"
+
+//: Frozen compressed sparse row matrix
+//  Row r holds the entries [row_start()[r], row_start()[r+1]) of
+//  col_index() and values(), in increasing column order.
+template <class T>
+class VNL_TEMPLATE_EXPORT vnl_sparse_matrix_csr
+{
+ public:
+  //: Construct an empty 0x0 matrix
+  vnl_sparse_matrix_csr();
+
+  //: Copy the entries of a vnl_sparse_matrix
+  explicit vnl_sparse_matrix_csr(vnl_sparse_matrix<T> const& A);
+
+  //: Build a rows x cols matrix from triplets A(row_index[i], col_index[i]) = values[i].
+  //  The triplets may come in any order; values given for the same
+  //  position are summed.
+  vnl_sparse_matrix_csr(unsigned int rows, unsigned int cols,
+                        std::vector<unsigned int> const& row_index,
+                        std::vector<unsigned int> const& col_index,
+                        std::vector<T> const& values);
+
+  //: Get the number of rows in the matrix.
+  unsigned int rows() const { return rs_; }
+
+  //: Get the number of columns in the matrix.
+  unsigned int columns() const { return cs_; }
+
+  //: Get the number of columns in the matrix.
+  unsigned int cols() const { return cs_; }
+
+  //: Number of stored entries
+  std::size_t nnz() const { return values_.size(); }
+
+  //: Get the value of an entry in the matrix (zero if it is not stored)
+  T get(unsigned int row, unsigned int column) const;
+
+  //: Offsets of the start of each row, and of the end of the last one
+  std::size_t const* row_start() const { return &row_start_[0]; }
+
+  //: Column index of each stored entry
+  unsigned int const* col_index() const { return col_index_.empty() ? VXL_NULLPTR : &col_index_[0]; }
+
+  //: Value of each stored entry
+  T const* values() const { return values_.empty() ? VXL_NULLPTR : &values_[0]; }
+
+  //: Multiply this*rhs, where rhs is a vector.
+  void mult(vnl_vector<T> const& rhs, vnl_vector<T>& result) const;
+
+  //: Multiply this*p, a fortran order matrix with prows==columns() rows and pcols columns.
+  //  q is the rows() x pcols result, also in fortran order.
+  void mult(unsigned int prows, unsigned int pcols, T const* p, T* q) const;
+
+  //: Multiplies lhs*this, where lhs is a vector
+  void pre_mult(vnl_vector<T> const& lhs, vnl_vector<T>& result) const;
+
+  //: Get diag(A_transpose * A).
+  void diag_AtA(vnl_vector<T>& result) const;
+
+  //: Return the transpose of this matrix
+  vnl_sparse_matrix_csr<T> transpose() const;
+
+  //: Return A_transpose * A, where A is this matrix
+  vnl_sparse_matrix_csr<T> AtA() const;
+
+  //: Copy the entries into a vnl_sparse_matrix
+  vnl_sparse_matrix<T> as_sparse_matrix() const;
+
+  //: Maximum number of threads used by the products; zero (the default) means one per hardware thread
+  unsigned int max_threads() const { return max_threads_; }
+
+  //: Set the maximum number of threads used by the products
+  void set_max_threads(unsigned int n) { max_threads_ = n; }
+
+ private:
+  unsigned int rs_, cs_;
+  std::vector<std::size_t> row_start_;
+  std::vector<unsigned int> col_index_;
+  std::vector<T> values_;
+  unsigned int max_threads_;
+
+  //: Number of parts to split work of \p work entries into
+  unsigned int n_parts(std::size_t work) const;
+
+  //: Split the rows into n parts with about the same number of entries
+  //  Part i is rows [bounds[i], bounds[i+1]).
+  void split_rows(unsigned int n, std::vector<unsigned int>& bounds) const;
+};
+
+#endif // vnl_sparse_matrix_csr_h_
@@ -0,0 +1,407 @@
+// This is core/vnl/vnl_sparse_matrix_csr.hxx
+#ifndef vnl_sparse_matrix_csr_hxx_
+#define vnl_sparse_matrix_csr_hxx_
+//:
+// \file
+
+#include <algorithm>
+#include "vnl_sparse_matrix_csr.h"
+#include <vcl_cassert.h>
+#include <vcl_compiler.h>
+#include <vnl/vnl_thread_pool.h>
+
+//: Number of entries below which a part of a product is not worth a thread of its own
+static const std::size_t vnl_sparse_matrix_csr_grain = 32768;
+
+//: Sum of v[i]*x[c[i]] for i in [0,n)
+//  Four partial sums let the multiplies and loads of consecutive entries
+//  overlap instead of waiting on one running total.
+template <class T>
+inline T vnl_sparse_matrix_csr_row_dot(T const* v, unsigned int const* c, std::size_t n, T const* x)
+{
+  T s0(0), s1(0), s2(0), s3(0);
+  std::size_t i = 0;
+  for (; i+4 <= n; i += 4)
+  {
+    s0 += v[i]   * x[c[i]];
+    s1 += v[i+1] * x[c[i+1]];
+    s2 += v[i+2] * x[c[i+2]];
+    s3 += v[i+3] * x[c[i+3]];
+  }
+  for (; i < n; ++i)
+    s0 += v[i] * x[c[i]];
+  return (s0 + s1) + (s2 + s3);
+}
+
+//: Sort the entries [b,e) of c and v into increasing order of c
+template <class T>
+static void vnl_sparse_matrix_csr_sort_row(unsigned int* c, T* v, std::size_t b, std::size_t e,
+                                           std::vector<vnl_sparse_matrix_pair<T> >& buf)
+{
+  std::size_t i = b+1;
+  while (i < e && c[i-1] <= c[i]) ++i;
+  if (i >= e) return; // already sorted
+  buf.clear();
+  for (i = b; i < e; ++i)
+    buf.push_back(vnl_sparse_matrix_pair<T>(c[i], v[i]));
+  typedef typename vnl_sparse_matrix_pair<T>::less less;
+  std::stable_sort(buf.begin(), buf.end(), less());
+  for (i = b; i < e; ++i)
+  {
+    c[i] = buf[i-b].first;
+    v[i] = buf[i-b].second;
+  }
+}
+
+template <class T>
+vnl_sparse_matrix_csr<T>::vnl_sparse_matrix_csr()
+  : rs_(0), cs_(0), row_start_(1, 0), max_threads_(0)
+{
+}
+
+template <class T>
+vnl_sparse_matrix_csr<T>::vnl_sparse_matrix_csr(vnl_sparse_matrix<T> const& A)
+  : rs_(A.rows()), cs_(A.columns()), row_start_(A.rows()+1, 0), max_threads_(0)
+{
+  for (unsigned int r = 0; r < rs_; ++r)
+    row_start_[r+1] = row_start_[r] + A.get_row(r).size();
+  col_index_.resize(row_start_[rs_]);
+  values_.resize(row_start_[rs_]);
+
+  std::vector<vnl_sparse_matrix_pair<T> > buf;
+  for (unsigned int r = 0; r < rs_; ++r)
+  {
+    typename vnl_sparse_matrix<T>::row const& row = A.get_row(r);
+    std::size_t k = row_start_[r];
+    for (std::size_t i = 0; i < row.size(); ++i, ++k)
+    {
+      assert(row[i].first < cs_);
+      col_index_[k] = row[i].first;
+      values_[k] = row[i].second;
+    }
+    // Rows are normally kept sorted, but get_row() allows them to be edited.
+    vnl_sparse_matrix_csr_sort_row(&col_index_[0], &values_[0], row_start_[r], k, buf);
+  }
+}
+
+template <class T>
+vnl_sparse_matrix_csr<T>::vnl_sparse_matrix_csr(unsigned int rows, unsigned int cols,
+                                                std::vector<unsigned int> const& row_index,
+                                                std::vector<unsigned int> const& col_index,
+                                                std::vector<T> const& values)
+  : rs_(rows), cs_(cols), row_start_(rows+1, 0), max_threads_(0)
+{
+  assert(row_index.size() == values.size());
+  assert(col_index.size() == values.size());
+  const std::size_t n = values.size();
+
+  // Counting sort of the triplets by row
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    assert(row_index[i] < rows && col_index[i] < cols);
+    ++row_start_[row_index[i]+1];
+  }
+  for (unsigned int r = 0; r < rs_; ++r)
+    row_start_[r+1] += row_start_[r];
+  col_index_.resize(n);
+  values_.resize(n);
+  std::vector<std::size_t> next(row_start_.begin(), row_start_.end()-1);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    std::size_t k = next[row_index[i]]++;
+    col_index_[k] = col_index[i];
+    values_[k] = values[i];
+  }
+
+  // Sort each row by column and sum repeated positions, closing up the gaps
+  std::vector<vnl_sparse_matrix_pair<T> > buf;
+  std::size_t out = 0;
+  for (unsigned int r = 0; r < rs_; ++r)
+  {
+    const std::size_t b = row_start_[r], e = row_start_[r+1];
+    row_start_[r] = out;
+    if (b == e) continue;
+    vnl_sparse_matrix_csr_sort_row(&col_index_[0], &values_[0], b, e, buf);
+    col_index_[out] = col_index_[b];
+    values_[out] = values_[b];
+    for (std::size_t i = b+1; i < e; ++i)
+    {
+      if (col_index_[i] == col_index_[out])
+        values_[out] += values_[i];
+      else
+      {
+        ++out;
+        col_index_[out] = col_index_[i];
+        values_[out] = values_[i];
+      }
+    }
+    ++out;
+  }
+  row_start_[rs_] = out;
+  col_index_.resize(out);
+  values_.resize(out);
+}
+
+template <class T>
+unsigned int vnl_sparse_matrix_csr<T>::n_parts(std::size_t work) const
+{
+  unsigned int n = max_threads_ ? max_threads_ : vnl_thread_pool::hardware_threads();
+  std::size_t max_parts = work / vnl_sparse_matrix_csr_grain;
+  if (max_parts < n) n = static_cast<unsigned int>(max_parts);
+  return n ? n : 1;
+}
+
+template <class T>
+void vnl_sparse_matrix_csr<T>::split_rows(unsigned int n, std::vector<unsigned int>& bounds) const
+{
+  bounds.resize(n+1);
+  bounds[0] = 0;
+  bounds[n] = rs_;
+  const std::size_t total = row_start_[rs_];
+  for (unsigned int i = 1; i < n; ++i)
+  {
+    std::size_t target = total / n * i + total % n * i / n;
+    bounds[i] = static_cast<unsigned int>(
+      std::lower_bound(row_start_.begin(), row_start_.end()-1, target) - row_start_.begin());
+    if (bounds[i] < bounds[i-1]) bounds[i] = bounds[i-1];
+  }
+}
+
+template <class T>
+T vnl_sparse_matrix_csr<T>::get(unsigned int row, unsigned int column) const
+{
+  assert(row < rs_ && column < cs_);
+  std::vector<unsigned int>::const_iterator b = col_index_.begin() + row_start_[row];
+  std::vector<unsigned int>::const_iterator e = col_index_.begin() + row_start_[row+1];
+  std::vector<unsigned int>::const_iterator i = std::lower_bound(b, e, column);
+  return (i != e && *i == column) ? values_[i - col_index_.begin()] : T(0);
+}
+
+template <class T>
+void vnl_sparse_matrix_csr<T>::mult(vnl_vector<T> const& rhs, vnl_vector<T>& result) const
+{
+  assert(rhs.size() == cs_);
+  result.set_size(rs_);
+  if (rs_ == 0) return;
+
+  T const* x = rhs.data_block();
+  T* y = result.data_block();
+  const unsigned int n = n_parts(nnz());
+  std::vector<unsigned int> bounds;
+  split_rows(n, bounds);
+  vnl_parallel_for(n, [&](unsigned int part)
+  {
+    for (unsigned int r = bounds[part]; r < bounds[part+1]; ++r)
+    {
+      const std::size_t b = row_start_[r];
+      y[r] = vnl_sparse_matrix_csr_row_dot(values() + b, col_index() + b, row_start_[r+1] - b, x);
+    }
+  }, n);
+}
+
+template <class T>
+void vnl_sparse_matrix_csr<T>::mult(unsigned int prows, unsigned int pcols, T const* p, T* q) const
+{
+  assert(prows == cs_);
+  if (rs_ == 0) return;
+
+  const unsigned int n = n_parts(nnz() * pcols);
+  std::vector<unsigned int> bounds;
+  split_rows(n, bounds);
+  vnl_parallel_for(n, [&](unsigned int part)
+  {
+    for (unsigned int r = bounds[part]; r < bounds[part+1]; ++r)
+    {
+      const std::size_t b = row_start_[r], len = row_start_[r+1] - b;
+      for (unsigned int c = 0; c < pcols; ++c)
+        q[r + std::size_t(c)*rs_] =
+          vnl_sparse_matrix_csr_row_dot(values() + b, col_index() + b, len, p + std::size_t(c)*prows);
+    }
+  }, n);
+}
+
+template <class T>
+void vnl_sparse_matrix_csr<T>::pre_mult(vnl_vector<T> const& lhs, vnl_vector<T>& result) const
+{
+  assert(lhs.size() == rs_);
+  result.set_size(cs_);
+  result.fill(T(0));
+  if (rs_ == 0 || cs_ == 0) return;
+
+  // Each part scatters into its own copy of the result, so more parts
+  // than there are entries per column would spend longer adding the
+  // copies together than they save.
+  unsigned int n = n_parts(nnz());
+  if (std::size_t(n) * cs_ > 2 * nnz())
+    n = static_cast<unsigned int>(std::max<std::size_t>(1, 2 * nnz() / cs_));
+  std::vector<unsigned int> bounds;
+  split_rows(n, bounds);
+  std::vector<std::vector<T> > partial(n-1);
+  T const* x = lhs.data_block();
+  vnl_parallel_for(n, [&](unsigned int part)
+  {
+    T* y = result.data_block();
+    if (part > 0)
+    {
+      partial[part-1].assign(cs_, T(0));
+      y = &partial[part-1][0];
+    }
+    for (unsigned int r = bounds[part]; r < bounds[part+1]; ++r)
+    {
+      const T xr = x[r];
+      for (std::size_t k = row_start_[r]; k < row_start_[r+1]; ++k)
+        y[col_index_[k]] += xr * values_[k];
+    }
+  }, n);
+
+  if (n == 1) return;
+  // Add the copies together, sharing the columns between the threads
+  const unsigned int n_chunks = n_parts(std::size_t(n) * cs_);
+  vnl_parallel_for(n_chunks, [&](unsigned int chunk)
+  {
+    const unsigned int c0 = unsigned(std::size_t(cs_) * chunk / n_chunks);
+    const unsigned int c1 = unsigned(std::size_t(cs_) * (chunk+1) / n_chunks);
+    T* y = result.data_block();
+    for (unsigned int i = 0; i+1 < n; ++i)
+    {
+      T const* z = &partial[i][0];
+      for (unsigned int c = c0; c < c1; ++c)
+        y[c] += z[c];
+    }
+  }, n_chunks);
+}
+
+template <class T>
+void vnl_sparse_matrix_csr<T>::diag_AtA(vnl_vector<T>& result) const
+{
+  result.set_size(cs_);
+  result.fill(T(0));
+  for (std::size_t k = 0; k < values_.size(); ++k)
+    result[col_index_[k]] += values_[k] * values_[k];
+}
+
+template <class T>
+vnl_sparse_matrix_csr<T> vnl_sparse_matrix_csr<T>::transpose() const
+{
+  vnl_sparse_matrix_csr<T> At;
+  At.rs_ = cs_;
+  At.cs_ = rs_;
+  At.max_threads_ = max_threads_;
+  At.row_start_.assign(cs_+1, 0);
+  for (std::size_t k = 0; k < col_index_.size(); ++k)
+    ++At.row_start_[col_index_[k]+1];
+  for (unsigned int c = 0; c < cs_; ++c)
+    At.row_start_[c+1] += At.row_start_[c];
+  At.col_index_.resize(nnz());
+  At.values_.resize(nnz());
+  // Visiting the rows in order leaves each row of the transpose sorted
+  std::vector<std::size_t> next(At.row_start_.begin(), At.row_start_.end()-1);
+  for (unsigned int r = 0; r < rs_; ++r)
+    for (std::size_t k = row_start_[r]; k < row_start_[r+1]; ++k)
+    {
+      std::size_t j = next[col_index_[k]]++;
+      At.col_index_[j] = r;
+      At.values_[j] = values_[k];
+    }
+  return At;
+}
+
+template <class T>
+vnl_sparse_matrix_csr<T> vnl_sparse_matrix_csr<T>::AtA() const
+{
+  // Row i of AtA is the sum over the entries A(r,i) of A(r,i) times row r
+  // of A. The rows of AtA are shared between threads; each thread gathers
+  // its rows in a dense accumulator, then the parts are joined.
+  vnl_sparse_matrix_csr<T> At = transpose();
+
+  // work of a row of AtA is the total length of the rows of A it adds
+  std::size_t work = 0;
+  for (std::size_t k = 0; k < At.col_index_.size(); ++k)
+    work += row_start_[At.col_index_[k]+1] - row_start_[At.col_index_[k]];
+  const unsigned int n = n_parts(work);
+  std::vector<unsigned int> bounds;
+  At.split_rows(n, bounds);
+
+  std::vector<std::vector<std::size_t> > part_lengths(n);
+  std::vector<std::vector<unsigned int> > part_cols(n);
+  std::vector<std::vector<T> > part_values(n);
+  vnl_parallel_for(n, [&](unsigned int part)
+  {
+    const unsigned int unset = static_cast<unsigned int>(-1);
+    std::vector<T> acc(cs_, T(0));
+    std::vector<unsigned int> owner(cs_, unset);
+    std::vector<unsigned int> touched;
+    std::vector<std::size_t>& lengths = part_lengths[part];
+    std::vector<unsigned int>& cols = part_cols[part];
+    std::vector<T>& vals = part_values[part];
+    for (unsigned int i = bounds[part]; i < bounds[part+1]; ++i)
+    {
+      touched.clear();
+      for (std::size_t k = At.row_start_[i]; k < At.row_start_[i+1]; ++k)
+      {
+        const unsigned int r = At.col_index_[k];
+        const T a = At.values_[k];
+        for (std::size_t j = row_start_[r]; j < row_start_[r+1]; ++j)
+        {
+          const unsigned int c = col_index_[j];
+          if (owner[c] != i)
+          {
+            owner[c] = i;
+            acc[c] = T(0);
+            touched.push_back(c);
+          }
+          acc[c] += a * values_[j];
+        }
+      }
+      std::sort(touched.begin(), touched.end());
+      for (std::size_t t = 0; t < touched.size(); ++t)
+      {
+        cols.push_back(touched[t]);
+        vals.push_back(acc[touched[t]]);
+      }
+      lengths.push_back(touched.size());
+    }
+  }, n);
+
+  vnl_sparse_matrix_csr<T> C;
+  C.rs_ = cs_;
+  C.cs_ = cs_;
+  C.max_threads_ = max_threads_;
+  C.row_start_.assign(cs_+1, 0);
+  std::size_t total = 0;
+  for (unsigned int part = 0; part < n; ++part)
+    total += part_values[part].size();
+  C.col_index_.reserve(total);
+  C.values_.reserve(total);
+  unsigned int i = 0;
+  for (unsigned int part = 0; part < n; ++part)
+  {
+    for (std::size_t k = 0; k < part_lengths[part].size(); ++k, ++i)
+      C.row_start_[i+1] = C.row_start_[i] + part_lengths[part][k];
+    C.col_index_.insert(C.col_index_.end(), part_cols[part].begin(), part_cols[part].end());
+    C.values_.insert(C.values_.end(), part_values[part].begin(), part_values[part].end());
+    std::vector<unsigned int>().swap(part_cols[part]);
+    std::vector<T>().swap(part_values[part]);
+  }
+  return C;
+}
+
+template <class T>
+vnl_sparse_matrix<T> vnl_sparse_matrix_csr<T>::as_sparse_matrix() const
+{
+  vnl_sparse_matrix<T> A(rs_, cs_);
+  std::vector<int> cols;
+  std::vector<T> vals;
+  for (unsigned int r = 0; r < rs_; ++r)
+  {
+    cols.assign(col_index_.begin() + row_start_[r], col_index_.begin() + row_start_[r+1]);
+    vals.assign(values_.begin() + row_start_[r], values_.begin() + row_start_[r+1]);
+    A.set_row(r, cols, vals);
+  }
+  return A;
+}
+
+#define VNL_SPARSE_MATRIX_CSR_INSTANTIATE(T) \
+template class VNL_EXPORT vnl_sparse_matrix_csr<T >
+
+#endif // vnl_sparse_matrix_csr_hxx_
@@ -16,7 +16,7 @@ void vnl_sparse_matrix_linear_system<double>::get_rhs(vnl_vector<double>& b) con
 template <>
 void vnl_sparse_matrix_linear_system<double>::transpose_multiply(vnl_vector<double> const& b, vnl_vector<double> & x) const
 {
-  A_.pre_mult(b,x);
+  csr_.pre_mult(b,x);
 }
 
 template <>
@@ -35,14 +35,14 @@ void vnl_sparse_matrix_linear_system<float>::transpose_multiply(vnl_vector<doubl
   if (b_float.size() != b.size()) b_float = vnl_vector<float> (b.size());
 
   vnl_copy(b, b_float);
-  A_.pre_mult(b_float,x_float);
+  csr_.pre_mult(b_float,x_float);
   vnl_copy(x_float, x);
 }
 
 template <>
 void vnl_sparse_matrix_linear_system<double>::multiply(vnl_vector<double> const& x, vnl_vector<double> & b) const
 {
-  A_.mult(x,b);
+  csr_.mult(x,b);
 }
 
 
@@ -56,7 +56,7 @@ void vnl_sparse_matrix_linear_system<float>::multiply(vnl_vector<double> const&
   if (b_float.size() != b.size()) b_float = vnl_vector<float> (b.size());
 
   vnl_copy(x, x_float);
-  A_.mult(x_float,b_float);
+  csr_.mult(x_float,b_float);
   vnl_copy(b_float, b);
 }
 
@@ -68,7 +68,7 @@ void vnl_sparse_matrix_linear_system<T>::apply_preconditioner(vnl_vector<double>
 
   if (jacobi_precond_.size() == 0) {
     vnl_vector<T> tmp(get_number_of_unknowns());
-    A_.diag_AtA(tmp);
+    csr_.diag_AtA(tmp);
     const_cast<vnl_vector<double> &>(jacobi_precond_) = vnl_vector<double> (tmp.size());
     for (unsigned int i=0; i < tmp.size(); ++i)
       const_cast<vnl_vector<double> &>(jacobi_precond_)[i] = 1.0 / double(tmp[i]);
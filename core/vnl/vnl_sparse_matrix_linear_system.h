@@ -16,12 +16,14 @@
 // \verbatim
 //  Modifications
 //  LSB (Manchester) 19/3/01 Documentation tidied
+//  Oct 2026 - products use a vnl_sparse_matrix_csr copy of A
 // \endverbatim
 //
 //-----------------------------------------------------------------------------
 
 #include <vnl/vnl_linear_system.h>
 #include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_sparse_matrix_csr.h>
 #include "vnl/vnl_export.h"
 
 //: vnl_sparse_matrix -> vnl_linear_system adaptor
@@ -32,8 +34,10 @@ class VNL_TEMPLATE_EXPORT vnl_sparse_matrix_linear_system : public vnl_linear_sy
  public:
   //::Constructor from vnl_sparse_matrix<double> for system Ax = b
   // Keeps a reference to the original sparse matrix A and vector b so DO NOT DELETE THEM!!
+  // The products use a compressed copy of A taken here, so later changes
+  // to the entries of A are not seen.
   vnl_sparse_matrix_linear_system(vnl_sparse_matrix<T> const& A, vnl_vector<T> const& b) :
-    vnl_linear_system(A.columns(), A.rows()), A_(A), b_(b), jacobi_precond_() {}
+    vnl_linear_system(A.columns(), A.rows()), A_(A), b_(b), jacobi_precond_(), csr_(A) {}
 
   //:  Implementations of the vnl_linear_system virtuals.
   void multiply(vnl_vector<double> const& x, vnl_vector<double> & b) const;
@@ -48,6 +52,8 @@ class VNL_TEMPLATE_EXPORT vnl_sparse_matrix_linear_system : public vnl_linear_sy
   vnl_sparse_matrix<T> const& A_;
   vnl_vector<T> const& b_;
   vnl_vector<double> jacobi_precond_;
+  //: Copy of A_ used for the products
+  vnl_sparse_matrix_csr<T> csr_;
 };
 
 template <>
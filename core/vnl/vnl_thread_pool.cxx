@@ -0,0 +1,136 @@
+// This is core/vnl/vnl_thread_pool.cxx
+#include <atomic>
+#include <memory>
+#include "vnl_thread_pool.h"
+//:
+// \file
+#include <vcl_compiler.h>
+
+unsigned vnl_thread_pool::hardware_threads()
+{
+  unsigned n = std::thread::hardware_concurrency();
+  return n>0 ? n : 1;
+}
+
+vnl_thread_pool& vnl_thread_pool::global()
+{
+  static vnl_thread_pool pool;
+  return pool;
+}
+
+vnl_thread_pool::vnl_thread_pool(unsigned n_threads)
+  : n_busy_(0), stopping_(false)
+{
+  if (n_threads==0)
+    n_threads = hardware_threads();
+  workers_.reserve(n_threads);
+  for (unsigned t = 0; t<n_threads; ++t)
+    workers_.push_back(std::thread(&vnl_thread_pool::worker_loop, this));
+}
+
+vnl_thread_pool::~vnl_thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  task_ready_.notify_all();
+  for (unsigned t = 0; t<workers_.size(); ++t)
+    workers_[t].join();
+}
+
+void vnl_thread_pool::submit(std::function<void()> const& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  task_ready_.notify_one();
+}
+
+void vnl_thread_pool::wait_idle()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!tasks_.empty() || n_busy_>0)
+    idle_.wait(lock);
+}
+
+void vnl_thread_pool::worker_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    while (tasks_.empty() && !stopping_)
+      task_ready_.wait(lock);
+    if (tasks_.empty()) // and stopping
+      return;
+    std::function<void()> task = tasks_.front();
+    tasks_.pop_front();
+    ++n_busy_;
+    lock.unlock();
+    task();
+    lock.lock();
+    --n_busy_;
+    if (tasks_.empty() && n_busy_==0)
+      idle_.notify_all();
+  }
+}
+
+//: State shared between the threads running one vnl_parallel_for() call
+struct vnl_parallel_for_state
+{
+  vnl_parallel_for_state(unsigned n, std::function<void(unsigned)> const& f)
+    : n_(n), f_(f), next_(0), done_(0) {}
+  unsigned n_;
+  std::function<void(unsigned)> f_;
+  std::atomic<unsigned> next_;
+  std::atomic<unsigned> done_;
+  std::mutex mutex_;
+  std::condition_variable finished_;
+
+  //: Claim and run indices until none remain
+  void run()
+  {
+    unsigned k;
+    while ((k = next_++) < n_)
+    {
+      f_(k);
+      if (++done_ == n_)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.notify_all();
+      }
+    }
+  }
+};
+
+void vnl_parallel_for(unsigned n, std::function<void(unsigned)> const& f,
+                      unsigned n_threads)
+{
+  if (n==0)
+    return;
+  vnl_thread_pool& pool = vnl_thread_pool::global();
+  if (n_threads==0)
+    n_threads = pool.n_threads();
+  else if (n_threads>pool.n_threads()+1)
+    n_threads = pool.n_threads()+1;
+  if (n_threads>n)
+    n_threads = n;
+  if (n_threads<=1)
+  {
+    for (unsigned k = 0; k<n; ++k)
+      f(k);
+    return;
+  }
+
+  // Helpers that start after all the indices have been claimed return at
+  // once, so the shared state must outlive this call.
+  std::shared_ptr<vnl_parallel_for_state> state(new vnl_parallel_for_state(n, f));
+  for (unsigned t = 1; t<n_threads; ++t)
+    pool.submit([state]() { state->run(); });
+  state->run();
+
+  std::unique_lock<std::mutex> lock(state->mutex_);
+  while (state->done_ < n)
+    state->finished_.wait(lock);
+}
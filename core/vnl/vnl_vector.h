@@ -15,6 +15,7 @@
 //   Mar.2004 - Peter Vanroose - deprecated fixed-size constructors now compile only when VNL_CONFIG_LEGACY_METHODS==1
 //   Mar.2009 - Peter Vanroose - added arg_min() and arg_max()
 //   Oct.2010 - Peter Vanroose - mutators and setters now return *this
+//   Oct.2026 - can be built from and assigned lazy expressions (vnl_expr.h)
 // \endverbatim
 #include <iosfwd>
 # include <vnl/vnl_error.h>
@@ -40,6 +41,7 @@
 
 VCL_TEMPLATE_EXPORT template <class T> class vnl_vector;
 VCL_TEMPLATE_EXPORT template <class T> class vnl_matrix;
+template <class E, bool M> class vnl_expr;
 
 //----------------------------------------------------------------------
 
@@ -100,6 +102,10 @@ class VNL_TEMPLATE_EXPORT vnl_vector
   //: Copy constructor.
   vnl_vector(vnl_vector<T> const&);
 
+  //: Evaluates a lazy expression, such as vnl_lazy(a) + b*s (see vnl_expr.h).
+  template <class E>
+  vnl_vector(vnl_expr<E, false> const& e);
+
 #if VNL_CONFIG_LEGACY_METHODS // these constructors are deprecated and should not be used
   //: Creates a vector of length 2 and initializes with the arguments, px,py.
   //  Requires that len==2.
@@ -200,6 +206,11 @@ class VNL_TEMPLATE_EXPORT vnl_vector
   //: Copy operator
   vnl_vector<T>& operator=(vnl_vector<T> const& rhs);
 
+  //: Evaluate a lazy expression (see vnl_expr.h) into this vector, in one pass.
+  //  The vector is resized only if its size differs.
+  template <class E>
+  vnl_vector<T>& operator=(vnl_expr<E, false> const& e);
+
   //: Add scalar value to all elements
   vnl_vector<T>& operator+=(T );
 
@@ -218,6 +229,14 @@ class VNL_TEMPLATE_EXPORT vnl_vector
   //: Subtract rhs from this and return *this
   vnl_vector<T>& operator-=(vnl_vector<T> const& rhs);
 
+  //: Add a lazy expression (see vnl_expr.h), in one pass.
+  template <class E>
+  vnl_vector<T>& operator+=(vnl_expr<E, false> const& e);
+
+  //: Subtract a lazy expression (see vnl_expr.h), in one pass.
+  template <class E>
+  vnl_vector<T>& operator-=(vnl_expr<E, false> const& e);
+
   //: *this = M*(*this) where M is a suitable matrix.
   //  this is treated as a column vector
   vnl_vector<T>& pre_multiply(vnl_matrix<T> const& M);
@@ -3,6 +3,7 @@
 #include <testlib/testlib_test.h>
 #include <vpgl/algo/vpgl_backproject.h>
 #include <vpgl/vpgl_rational_camera.h>
+#include <vpgl/vpgl_local_rational_camera.h>
 #include <vnl/vnl_double_2.h>
 #include <vnl/vnl_double_3.h>
 #include <vnl/vnl_double_4.h>
@@ -11,6 +12,21 @@
 #include <vgl/vgl_plane_3d.h>
 #include <vcl_compiler.h>
 
+// A rational camera followed by a shift of the image, which, like
+// bpgl_comp_rational_camera, keeps the type_name() of its base class
+class shifted_rational_camera : public vpgl_rational_camera<double>
+{
+ public:
+  shifted_rational_camera(vpgl_rational_camera<double> const& rcam)
+    : vpgl_rational_camera<double>(rcam) {}
+  using vpgl_rational_camera<double>::project;
+  virtual void project(const double x, const double y, const double z, double& u, double& v) const
+  {
+    vpgl_rational_camera<double>::project(x, y, z, u, v);
+    u += 7.0; v -= 3.0;
+  }
+};
+
 static void test_backproject()
 {
   //Make the rational camera
@@ -98,6 +114,55 @@ static void test_backproject()
   success = vpgl_backproject::bproj_plane(rcam, img_pt, pl3, iguess, wp);
   TEST("arbitrary plane backprojection convergence", success, true);
   TEST_NEAR("test backprojection on arbitrary plane", (wp-correct).length(), 0, 1e-8);
+
+  // Newton iteration on its own
+  vgl_plane_3d<double> z10(0, 0, 1, -10);
+  success = vpgl_backproject::bproj_plane_newton(rcam, vgl_point_2d<double>(1250, 332), z10,
+                                                 vgl_point_3d<double>(200, 150, 10), wp);
+  TEST("Newton backprojection convergence", success, true);
+  TEST_NEAR("Newton backprojection", std::min((wp-p0).length(), (wp-p3).length()), 0, 1e-8);
+
+  // A raster, from neighbouring pixels and from a coarse grid, on one or more threads
+  const unsigned ni = 61, nj = 37;
+  std::vector<vgl_point_3d<double> > pts, grid_pts, pts1;
+  std::vector<unsigned char> valid, grid_valid, valid1;
+  unsigned n_valid = vpgl_backproject::bproj_plane_raster(rcam, 1200, 300, ni, nj, z10, p0, pts, valid);
+  TEST("raster backprojection", n_valid, ni*nj);
+  double max_err = 0;
+  for (unsigned j = 0; j < nj; ++j)
+    for (unsigned i = 0; i < ni; ++i)
+      max_err = std::max(max_err, (rcam.project(pts[j*ni+i]) - vgl_point_2d<double>(1200+i, 300+j)).length());
+  TEST_NEAR("raster backprojection reprojects", max_err, 0, 1e-6);
+  n_valid = vpgl_backproject::bproj_plane_raster(rcam, 1200, 300, ni, nj, z10, p0, grid_pts, grid_valid, 8);
+  TEST("raster backprojection from a grid", n_valid, ni*nj);
+  max_err = 0;
+  for (unsigned k = 0; k < ni*nj; ++k)
+    max_err = std::max(max_err, (pts[k] - grid_pts[k]).length());
+  TEST_NEAR("grid and neighbour starts agree", max_err, 0, 1e-6);
+  vpgl_backproject::bproj_plane_raster(rcam, 1200, 300, ni, nj, z10, p0, pts1, valid1, 8, 0.05, 1);
+  TEST("raster backprojection on one thread", pts1 == grid_pts && valid1 == grid_valid, true);
+
+  // A local rational camera, whose world points go through an lvcs
+  vpgl_rational_camera<double> gcam(neu_u, den_u, neu_v, den_v,
+                                    0.01, -71.4, 0.01, 41.8, 50.0, 0.0,
+                                    su, ou, sv, ov);
+  vpgl_local_rational_camera<double> lcam(vpgl_lvcs(41.8, -71.4, 0.0), gcam);
+  vgl_point_3d<double> local_pt(120, -80, 5);
+  success = vpgl_backproject::bproj_plane_newton(lcam, lcam.project(local_pt),
+                                                 vgl_plane_3d<double>(0, 0, 1, -5),
+                                                 vgl_point_3d<double>(0, 0, 5), wp);
+  TEST("local Newton backprojection convergence", success, true);
+  TEST_NEAR("local Newton backprojection", (wp-local_pt).length(), 0, 1e-4);
+
+  // A derived camera with an image map of its own is not solved by Newton
+  // iteration on the bare rational polynomials
+  shifted_rational_camera scam(rcam);
+  TEST("Newton refuses derived camera",
+       vpgl_backproject::bproj_plane_newton(scam, scam.project(p1), z10, p0, wp), false);
+  success = vpgl_backproject::bproj_plane(scam, scam.project(p1), z10, p0, wp);
+  TEST("derived camera backprojection convergence", success, true);
+  TEST_NEAR("derived camera backprojection reprojects",
+            (scam.project(wp)-scam.project(p1)).length(), 0, 0.05);
 }
 
 TESTMAIN(test_backproject);
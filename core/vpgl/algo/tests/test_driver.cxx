@@ -17,6 +17,7 @@ DECLARE( test_bundle_adjust );
 DECLARE( test_ba_fixed_k_lsqr );
 DECLARE( test_ba_shared_k_lsqr );
 DECLARE( test_affine_rect );
+DECLARE( test_ransac );
 
 void register_tests()
 {
@@ -37,6 +38,7 @@ REGISTER( test_bundle_adjust );
 REGISTER( test_ba_fixed_k_lsqr );
 REGISTER( test_ba_shared_k_lsqr );
 REGISTER( test_affine_rect );
+REGISTER( test_ransac );
 
 }
 
@@ -1,12 +1,17 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <testlib/testlib_test.h>
 #include <vcl_compiler.h>
 
+#include <vpgl/algo/vpgl_fm_compute_7_point.h>
 #include <vpgl/algo/vpgl_fm_compute_8_point.h>
 #include <vpgl/algo/vpgl_fm_compute_2_point.h>
 #include <vpgl/vpgl_fundamental_matrix.h>
 #include <vnl/vnl_fwd.h>
 #include <vnl/vnl_double_3x3.h>
+#include <vnl/vnl_double_3.h>
+#include <vnl/algo/vnl_determinant.h>
 #include <vgl/vgl_homg_point_2d.h>
 #include <vgl/vgl_homg_point_3d.h>
 
@@ -52,6 +57,27 @@ static void test_fm_compute()
   TEST_NEAR( "fm compute 8 point from perfect correspondences with outliers",
              (fm1_vnl-fm1est_vnl).frobenius_norm(), 0, 1 );
 
+  // Test the 7 point algorithm: every solution must be singular and fit the points
+  std::vector< vgl_homg_point_2d<double> > p7r(p1r.begin(), p1r.begin()+7), p7l(p1l.begin(), p1l.begin()+7);
+  std::vector< vpgl_fundamental_matrix<double>* > fm7;
+  vpgl_fm_compute_7_point fmc7;
+  fmc7.compute( p7r, p7l, fm7 );
+  double max_det = 0, max_res = 0;
+  for ( unsigned i = 0; i < fm7.size(); i++ ) {
+    vnl_double_3x3 F = fm7[i]->get_matrix();
+    F /= F.frobenius_norm();
+    max_det = std::max( max_det, std::fabs( vnl_determinant(F) ) );
+    for ( unsigned j = 0; j < 7; j++ ) {
+      vnl_double_3 r( p7r[j].x()/p7r[j].w(), p7r[j].y()/p7r[j].w(), 1 );
+      vnl_double_3 l( p7l[j].x()/p7l[j].w(), p7l[j].y()/p7l[j].w(), 1 );
+      max_res = std::max( max_res, std::fabs( dot_product( l, F*r ) ) );
+    }
+    delete fm7[i];
+  }
+  TEST( "fm compute 7 point solutions", fm7.empty(), false );
+  TEST_NEAR( "fm compute 7 point solutions are singular", max_det, 0, 1e-8 );
+  TEST_NEAR( "fm compute 7 point solutions fit the points", max_res, 0, 1e-6 );
+
   //Part 2a: Test the 2 point algorithm
   double clm[] = { 1.0, 0.0, 0.0, 0,
                    0.0, 1.0, 0.0, 0,
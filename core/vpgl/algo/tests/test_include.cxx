@@ -19,6 +19,7 @@
 #include <vpgl/algo/vpgl_rational_adjust.h>
 #include <vpgl/algo/vpgl_rational_adjust_multipt.h>
 #include <vpgl/algo/vpgl_ray.h>
+#include <vpgl/algo/vpgl_ransac.h>
 #include <vpgl/algo/vpgl_ray_intersect.h>
 #include <vpgl/algo/vpgl_triangulate_points.h>
 
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <testlib/testlib_test.h>
+#include <vcl_compiler.h>
+
+#include <vpgl/algo/vpgl_ransac.h>
+#include <vpgl/vpgl_perspective_camera.h>
+#include <vpgl/vpgl_essential_matrix.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/algo/vgl_rotation_3d.h>
+#include <vnl/vnl_random.h>
+#include <vnl/vnl_vector_fixed.h>
+
+// Two views of random scene points, with a fraction of the correspondences
+// replaced by random pairs of pixels. The scene points lie on the plane
+// z = 10 if planar is set. inlier[i] tells which are true correspondences.
+static void make_views(unsigned n, double outlier_fraction, bool planar,
+                       vpgl_perspective_camera<double>& cr, vpgl_perspective_camera<double>& cl,
+                       std::vector<vgl_point_2d<double> >& pr, std::vector<vgl_point_2d<double> >& pl,
+                       std::vector<bool>& inlier)
+{
+  vpgl_calibration_matrix<double> K(800.0, vgl_point_2d<double>(500.0, 400.0));
+  cr = vpgl_perspective_camera<double>(K, vgl_point_3d<double>(0.0, 0.0, 0.0), vgl_rotation_3d<double>());
+  vnl_vector_fixed<double,3> w(0.02, -0.1, 0.03);
+  cl = vpgl_perspective_camera<double>(K, vgl_point_3d<double>(1.0, 0.2, -0.3), vgl_rotation_3d<double>(w));
+  vnl_random rng(4242);
+  pr.clear(); pl.clear(); inlier.clear();
+  for (unsigned i = 0; i < n; ++i)
+  {
+    if (rng.drand64() < outlier_fraction) {
+      pr.push_back(vgl_point_2d<double>(rng.drand64(0.0, 1000.0), rng.drand64(0.0, 800.0)));
+      pl.push_back(vgl_point_2d<double>(rng.drand64(0.0, 1000.0), rng.drand64(0.0, 800.0)));
+      inlier.push_back(false);
+      continue;
+    }
+    double z = planar ? 10.0 : rng.drand64(5.0, 15.0);
+    vgl_point_3d<double> X(rng.drand64(-0.5, 0.5)*z, rng.drand64(-0.4, 0.4)*z, z);
+    vgl_point_2d<double> ur = cr.project(X), ul = cl.project(X);
+    pr.push_back(vgl_point_2d<double>(ur.x() + rng.drand64(-0.3, 0.3), ur.y() + rng.drand64(-0.3, 0.3)));
+    pl.push_back(vgl_point_2d<double>(ul.x() + rng.drand64(-0.3, 0.3), ul.y() + rng.drand64(-0.3, 0.3)));
+    inlier.push_back(true);
+  }
+}
+
+// Fractions of the true correspondences found, and of the false ones accepted
+static void recall(std::vector<bool> const& truth, std::vector<bool> const& found,
+                   double& found_true, double& found_false)
+{
+  double nt = 0, nf = 0, ft = 0, ff = 0;
+  for (unsigned i = 0; i < truth.size(); ++i) {
+    if (truth[i]) { ++nt; if (found[i]) ++ft; }
+    else          { ++nf; if (found[i]) ++ff; }
+  }
+  found_true = ft/nt;
+  found_false = nf > 0 ? ff/nf : 0.0;
+}
+
+static void test_ransac()
+{
+  vpgl_perspective_camera<double> cr, cl;
+  std::vector<vgl_point_2d<double> > pr, pl;
+  std::vector<bool> truth;
+
+  // ----- fundamental matrix, 40% outliers -----
+  make_views(2000, 0.4, false, cr, cl, pr, pl, truth);
+  vpgl_ransac ransac;
+  vpgl_fundamental_matrix<double> fm;
+  TEST("fundamental matrix found", ransac.compute(pr, pl, fm), true);
+  double ft, ff;
+  recall(truth, ransac.inliers(), ft, ff);
+  TEST("most true correspondences are inliers", ft > 0.97, true);
+  TEST("few false correspondences are inliers", ff < 0.03, true);
+  vpgl_fundamental_matrix<double> f_true(cr, cl);
+  vnl_matrix_fixed<double,3,3> Fe = fm.get_matrix(), Ft = f_true.get_matrix();
+  Fe /= Fe.frobenius_norm(); Ft /= Ft.frobenius_norm();
+  TEST_NEAR("fundamental matrix", std::min((Fe-Ft).frobenius_norm(), (Fe+Ft).frobenius_norm()), 0.0, 0.02);
+  TEST("some hypotheses rejected by the ratio test", ransac.n_rejected() > 0, true);
+  std::cout << ransac.n_hypotheses() << " hypotheses, " << ransac.n_rejected() << " rejected early, "
+            << ransac.n_inliers() << " inliers\n";
+
+  // the same result on one thread
+  vpgl_ransac serial;
+  serial.set_n_threads(1);
+  vpgl_fundamental_matrix<double> fm1;
+  serial.compute(pr, pl, fm1);
+  TEST("same result on one thread", fm1.get_matrix() == fm.get_matrix() &&
+       serial.n_hypotheses() == ransac.n_hypotheses(), true);
+
+  // ----- PROSAC finds 15% inliers ordered first, where plain sampling cannot -----
+  make_views(2000, 0.85, false, cr, cl, pr, pl, truth);
+  std::vector<vgl_point_2d<double> > sr, sl;
+  std::vector<bool> sorted_truth;
+  for (unsigned pass = 0; pass < 2; ++pass)
+    for (unsigned i = 0; i < pr.size(); ++i)
+      if (truth[i] == (pass == 0)) {
+        sr.push_back(pr[i]); sl.push_back(pl[i]); sorted_truth.push_back(truth[i]);
+      }
+  vpgl_ransac prosac;
+  prosac.set_prosac(true);
+  prosac.set_max_hypotheses(500);
+  TEST("PROSAC fundamental matrix found", prosac.compute(sr, sl, fm), true);
+  recall(sorted_truth, prosac.inliers(), ft, ff);
+  TEST("PROSAC finds the true correspondences", ft > 0.97 && ff < 0.03, true);
+
+  // ----- essential matrix -----
+  make_views(1000, 0.3, false, cr, cl, pr, pl, truth);
+  vpgl_essential_matrix<double> em;
+  TEST("essential matrix found", ransac.compute(pr, cr.get_calibration(), pl, cl.get_calibration(), em), true);
+  recall(truth, ransac.inliers(), ft, ff);
+  TEST("essential matrix inliers", ft > 0.97 && ff < 0.03, true);
+  vpgl_essential_matrix<double> e_true(cr, cl);
+  vnl_matrix_fixed<double,3,3> Ee = em.get_matrix(), Et = e_true.get_matrix();
+  Ee /= Ee.frobenius_norm(); Et /= Et.frobenius_norm();
+  TEST_NEAR("essential matrix", std::min((Ee-Et).frobenius_norm(), (Ee+Et).frobenius_norm()), 0.0, 0.02);
+
+  // ----- homography of a plane -----
+  make_views(1000, 0.5, true, cr, cl, pr, pl, truth);
+  vgl_h_matrix_2d<double> H;
+  TEST("homography found", ransac.compute(pr, pl, H), true);
+  recall(truth, ransac.inliers(), ft, ff);
+  TEST("homography inliers", ft > 0.97 && ff < 0.01, true);
+  double max_err = 0.0;
+  for (unsigned i = 0; i < 20; ++i) {
+    vgl_point_3d<double> X(-4.0 + 0.4*i, 3.0 - 0.3*i, 10.0);
+    vgl_point_2d<double> ul = cl.project(X);
+    vgl_point_2d<double> uh(H(vgl_homg_point_2d<double>(cr.project(X))));
+    max_err = std::max(max_err, (uh - ul).length());
+  }
+  TEST_NEAR("homography transfer", max_err, 0.0, 0.5);
+
+  // ----- too few correspondences -----
+  pr.resize(6); pl.resize(6);
+  TEST("too few correspondences", ransac.compute(pr, pl, fm), false);
+}
+
+TESTMAIN(test_ransac);
@@ -9,6 +9,208 @@
 #include <vgl/vgl_intersection.h>
 #include <vpgl/vpgl_generic_camera.h>
 #include <vnl/vnl_random.h>
+#include <vnl/vnl_thread_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+#include <vcl_compiler.h>
+
+namespace
+{
+  //: Newton iteration for the point of a plane that a rational camera projects to a given image point
+  // The plane is parameterised by the two world coordinates along which
+  // its normal is smallest, so that the third is well defined.
+  class vpgl_rational_newton
+  {
+   public:
+    vpgl_rational_newton(vpgl_rational_camera<double> const& rcam,
+                         vgl_plane_3d<double> const& plane);
+
+    //: False if the camera type or the plane cannot be handled
+    bool usable() const { return usable_; }
+
+    //: For a local rational camera, the derivatives of the geographic coordinates near \p X
+    // Geographic coordinates change slowly enough with position that
+    // those at one point serve for a whole image tile.
+    void linearise_lvcs(const double X[3]);
+
+    //: The two free coordinates of a world point
+    void free_coords(vgl_point_3d<double> const& X, double p[2]) const
+    { const double x[3] = { X.x(), X.y(), X.z() }; p[0] = x[i_]; p[1] = x[j_]; }
+
+    //: The point of the plane with free coordinates \p p
+    void point(const double p[2], double X[3]) const
+    {
+      X[i_] = p[0]; X[j_] = p[1];
+      X[k_] = -(plane_[3] + plane_[i_]*p[0] + plane_[j_]*p[1])/plane_[k_];
+    }
+
+    //: Refine the free coordinates \p p so that the point projects to (u, v).
+    // Returns the distance in the image left.
+    double solve(double u, double v, double p[2], unsigned max_iterations) const;
+
+   private:
+    //: The image point of X and its derivatives with respect to X
+    void eval(const double X[3], double uv[2], double J[2][3]) const;
+
+    bool usable_;
+    bool local_;
+    //: local_to_global() is not const, but only reads the lvcs
+    mutable vpgl_lvcs lvcs_;
+    double coeffs_[4][20];
+    double scale_[5], offset_[5];
+    double L_[3][3];
+    double plane_[4];
+    unsigned i_, j_, k_;
+  };
+
+  vpgl_rational_newton::vpgl_rational_newton(vpgl_rational_camera<double> const& rcam,
+                                             vgl_plane_3d<double> const& plane)
+    : usable_(false), local_(false)
+  {
+    // Other derived classes may change the projection, e.g. by an image
+    // map, and do not always override type_name(); check the exact type.
+    if (typeid(rcam) == typeid(vpgl_local_rational_camera<double>))
+    {
+      local_ = true;
+      lvcs_ = static_cast<vpgl_local_rational_camera<double> const&>(rcam).lvcs();
+    }
+    else if (typeid(rcam) != typeid(vpgl_rational_camera<double>))
+      return;
+    const vnl_matrix_fixed<double, 4, 20> c = rcam.coefficient_matrix();
+    for (unsigned r = 0; r < 4; ++r)
+      for (unsigned m = 0; m < 20; ++m)
+        coeffs_[r][m] = c[r][m];
+    std::vector<vpgl_scale_offset<double> > so = rcam.scale_offsets();
+    for (unsigned r = 0; r < 5; ++r)
+    {
+      scale_[r] = so[r].scale();
+      offset_[r] = so[r].offset();
+    }
+    for (unsigned r = 0; r < 3; ++r)
+      for (unsigned m = 0; m < 3; ++m)
+        L_[r][m] = r == m ? 1.0 : 0.0;
+    plane_[0] = plane.a(); plane_[1] = plane.b(); plane_[2] = plane.c(); plane_[3] = plane.d();
+    const double an[3] = { std::fabs(plane_[0]), std::fabs(plane_[1]), std::fabs(plane_[2]) };
+    k_ = an[0] >= an[1] && an[0] >= an[2] ? 0 : (an[1] >= an[2] ? 1 : 2);
+    i_ = (k_ + 1) % 3; j_ = (k_ + 2) % 3;
+    if (i_ > j_)
+      std::swap(i_, j_);
+    usable_ = an[k_] > 0;
+  }
+
+  void vpgl_rational_newton::linearise_lvcs(const double X[3])
+  {
+    if (!local_)
+      return;
+    double g0[3], g1[3];
+    lvcs_.local_to_global(X[0], X[1], X[2], vpgl_lvcs::wgs84, g0[0], g0[1], g0[2]);
+    for (unsigned m = 0; m < 3; ++m)
+    {
+      double Y[3] = { X[0], X[1], X[2] };
+      Y[m] += 1.0;
+      lvcs_.local_to_global(Y[0], Y[1], Y[2], vpgl_lvcs::wgs84, g1[0], g1[1], g1[2]);
+      for (unsigned r = 0; r < 3; ++r)
+        L_[r][m] = g1[r] - g0[r];
+    }
+  }
+
+  void vpgl_rational_newton::eval(const double X[3], double uv[2], double J[2][3]) const
+  {
+    double G[3] = { X[0], X[1], X[2] };
+    if (local_)
+      lvcs_.local_to_global(X[0], X[1], X[2], vpgl_lvcs::wgs84, G[0], G[1], G[2]);
+    // normalised coordinates and their derivatives with respect to G
+    double n[3], dn[3];
+    for (unsigned m = 0; m < 3; ++m)
+    {
+      dn[m] = scale_[m] == 0 ? 0.0 : 1.0/scale_[m];
+      n[m] = scale_[m] == 0 ? 0.0 : (G[m] - offset_[m])/scale_[m];
+    }
+    const double x = n[0], y = n[1], z = n[2];
+    const double xx = x*x, xy = x*y, xz = x*z, yy = y*y, yz = y*z, zz = z*z;
+    double p[4], g[4][3];
+    for (unsigned r = 0; r < 4; ++r)
+    {
+      const double* c = coeffs_[r];
+      p[r] = x*(x*(c[0]*x + c[1]*y + c[2]*z + c[3]) + y*(c[4]*y + c[5]*z + c[6]) + z*(c[7]*z + c[8]) + c[9])
+           + y*(y*(c[10]*y + c[11]*z + c[12]) + z*(c[13]*z + c[14]) + c[15])
+           + z*(z*(c[16]*z + c[17]) + c[18]) + c[19];
+      g[r][0] = 3*c[0]*xx + 2*c[1]*xy + 2*c[2]*xz + 2*c[3]*x + c[4]*yy + c[5]*yz + c[6]*y
+              + c[7]*zz + c[8]*z + c[9];
+      g[r][1] = c[1]*xx + 2*c[4]*xy + c[5]*xz + c[6]*x + 3*c[10]*yy + 2*c[11]*yz + 2*c[12]*y
+              + c[13]*zz + c[14]*z + c[15];
+      g[r][2] = c[2]*xx + c[5]*xy + 2*c[7]*xz + c[8]*x + c[11]*yy + 2*c[13]*yz + c[14]*y
+              + 3*c[16]*zz + 2*c[17]*z + c[18];
+    }
+    double Jg[2][3];
+    for (unsigned r = 0; r < 2; ++r)
+    {
+      const double num = p[2*r], den = p[2*r+1];
+      uv[r] = num/den*scale_[3+r] + offset_[3+r];
+      for (unsigned m = 0; m < 3; ++m)
+        Jg[r][m] = scale_[3+r]*(g[2*r][m]*den - num*g[2*r+1][m])/(den*den)*dn[m];
+    }
+    for (unsigned r = 0; r < 2; ++r)
+      for (unsigned m = 0; m < 3; ++m)
+        J[r][m] = Jg[r][0]*L_[0][m] + Jg[r][1]*L_[1][m] + Jg[r][2]*L_[2][m];
+  }
+
+  double vpgl_rational_newton::solve(double u, double v, double p[2], unsigned max_iterations) const
+  {
+    double X[3], uv[2], J[2][3];
+    point(p, X);
+    eval(X, uv, J);
+    double ru = uv[0] - u, rv = uv[1] - v;
+    double err = std::sqrt(ru*ru + rv*rv);
+    for (unsigned it = 0; it < max_iterations && err > 1e-9; ++it)
+    {
+      // derivatives with respect to the free coordinates, moving along the plane
+      const double ri = -plane_[i_]/plane_[k_], rj = -plane_[j_]/plane_[k_];
+      const double a = J[0][i_] + J[0][k_]*ri, b = J[0][j_] + J[0][k_]*rj;
+      const double c = J[1][i_] + J[1][k_]*ri, d = J[1][j_] + J[1][k_]*rj;
+      const double det = a*d - b*c;
+      if (det == 0 || !(err == err))
+        break;
+      const double dp0 = -( d*ru - b*rv)/det;
+      const double dp1 = -(-c*ru + a*rv)/det;
+      // A polynomial has other, distant, solutions; so that the iteration
+      // stays near the start, no step may move a normalised coordinate by
+      // more than a quarter.
+      const double dX[3] = { i_ == 0 ? dp0 : (j_ == 0 ? dp1 : ri*dp0 + rj*dp1),
+                             i_ == 1 ? dp0 : (j_ == 1 ? dp1 : ri*dp0 + rj*dp1),
+                             i_ == 2 ? dp0 : (j_ == 2 ? dp1 : ri*dp0 + rj*dp1) };
+      double largest = 0;
+      for (unsigned r = 0; r < 3; ++r)
+      {
+        const double dG = L_[r][0]*dX[0] + L_[r][1]*dX[1] + L_[r][2]*dX[2];
+        if (scale_[r] != 0)
+          largest = std::max(largest, std::fabs(dG/scale_[r]));
+      }
+      // halve the step until the image distance drops
+      double step = largest > 0.25 ? 0.25/largest : 1.0, new_err = err, q[2], Jq[2][3];
+      for (unsigned h = 0; h < 12; ++h, step *= 0.5)
+      {
+        q[0] = p[0] + step*dp0; q[1] = p[1] + step*dp1;
+        point(q, X);
+        eval(X, uv, Jq);
+        const double qu = uv[0] - u, qv = uv[1] - v;
+        new_err = std::sqrt(qu*qu + qv*qv);
+        if (new_err < err)
+        {
+          ru = qu; rv = qv;
+          break;
+        }
+      }
+      if (!(new_err < err))
+        break; // no further progress at this precision
+      p[0] = q[0]; p[1] = q[1];
+      err = new_err;
+      std::copy(&Jq[0][0], &Jq[0][0] + 6, &J[0][0]);
+    }
+    return err;
+  }
+}
 
 //: Backproject an image point onto a plane, start with initial_guess
 bool vpgl_backproject::bproj_plane(const vpgl_camera<double>* cam,
@@ -32,6 +234,21 @@ bool vpgl_backproject::bproj_plane(const vpgl_camera<double>* cam,
     world_point[0]=ipt.x(); world_point[1]=ipt.y(); world_point[2]=ipt.z();
     return true;
   }
+  // rational and local rational cameras, unless they fail to converge;
+  // bproj_plane_newton() refuses other classes derived from them
+  const vpgl_rational_camera<double>* rcam = dynamic_cast<const vpgl_rational_camera<double>*>(cam);
+  if (rcam)
+  {
+    vgl_point_3d<double> wp;
+    if (bproj_plane_newton(*rcam, vgl_point_2d<double>(image_point[0], image_point[1]),
+                           vgl_plane_3d<double>(plane[0], plane[1], plane[2], plane[3]),
+                           vgl_point_3d<double>(initial_guess[0], initial_guess[1], initial_guess[2]),
+                           wp, error_tol))
+    {
+      world_point[0] = wp.x(); world_point[1] = wp.y(); world_point[2] = wp.z();
+      return true;
+    }
+  }
   // general case
   vpgl_invmap_cost_function cf(image_point, plane, cam);
   vnl_double_2 x1(0.000, 0.0000);
@@ -108,6 +325,139 @@ bool vpgl_backproject::bproj_plane(vpgl_rational_camera<double> const& rcam,
   return bproj_plane(cam, image_point, plane, initial_guess, world_point, error_tol, relative_diameter);
 }
 
+//: Backproject an image point onto a world plane by Newton iteration
+bool vpgl_backproject::bproj_plane_newton(vpgl_rational_camera<double> const& rcam,
+                                          vgl_point_2d<double> const& image_point,
+                                          vgl_plane_3d<double> const& plane,
+                                          vgl_point_3d<double> const& initial_guess,
+                                          vgl_point_3d<double>& world_point,
+                                          double error_tol,
+                                          unsigned max_iterations)
+{
+  vpgl_rational_newton solver(rcam, plane);
+  if (!solver.usable())
+    return false;
+  const double guess[3] = { initial_guess.x(), initial_guess.y(), initial_guess.z() };
+  solver.linearise_lvcs(guess);
+  double p[2], X[3];
+  solver.free_coords(initial_guess, p);
+  const double err = solver.solve(image_point.x(), image_point.y(), p, max_iterations);
+  solver.point(p, X);
+  world_point.set(X[0], X[1], X[2]);
+  return err <= error_tol;
+}
+
+//: Backproject each pixel of a raster onto a world plane
+unsigned vpgl_backproject::bproj_plane_raster(vpgl_rational_camera<double> const& rcam,
+                                              double u0, double v0, unsigned ni, unsigned nj,
+                                              vgl_plane_3d<double> const& plane,
+                                              vgl_point_3d<double> const& initial_guess,
+                                              std::vector<vgl_point_3d<double> >& world_points,
+                                              std::vector<unsigned char>& valid,
+                                              unsigned grid_step,
+                                              double error_tol,
+                                              unsigned n_threads)
+{
+  world_points.assign(std::size_t(ni)*nj, initial_guess);
+  valid.assign(std::size_t(ni)*nj, 0);
+  vpgl_rational_newton solver(rcam, plane);
+  if (!solver.usable() || ni == 0 || nj == 0)
+    return 0;
+  const double guess[3] = { initial_guess.x(), initial_guess.y(), initial_guess.z() };
+  solver.linearise_lvcs(guess);
+  const unsigned max_iterations = 20;
+  double start[2];
+  solver.free_coords(initial_guess, start);
+
+  // Coarse grid of pixels, solved in raster order from the neighbour to
+  // the left, or above at the start of a row
+  std::vector<unsigned> gi, gj;
+  std::vector<double> gp;
+  std::vector<unsigned char> gvalid;
+  if (grid_step > 1 && ni > 1 && nj > 1)
+  {
+    for (unsigned i = 0; i < ni; i += grid_step) gi.push_back(i);
+    if (gi.back() != ni-1) gi.push_back(ni-1);
+    for (unsigned j = 0; j < nj; j += grid_step) gj.push_back(j);
+    if (gj.back() != nj-1) gj.push_back(nj-1);
+    gp.resize(2*gi.size()*gj.size());
+    gvalid.resize(gi.size()*gj.size());
+    double row_start[2] = { start[0], start[1] };
+    for (unsigned b = 0; b < gj.size(); ++b)
+    {
+      double p[2] = { row_start[0], row_start[1] };
+      for (unsigned a = 0; a < gi.size(); ++a)
+      {
+        double q[2] = { p[0], p[1] };
+        const std::size_t k = b*gi.size() + a;
+        gvalid[k] = solver.solve(u0 + gi[a], v0 + gj[b], q, max_iterations) <= error_tol;
+        gp[2*k] = q[0]; gp[2*k+1] = q[1];
+        if (gvalid[k])
+        {
+          p[0] = q[0]; p[1] = q[1];
+          if (a == 0) { row_start[0] = q[0]; row_start[1] = q[1]; }
+        }
+      }
+    }
+  }
+  else
+  {
+    // The first column, from which each row starts
+    double p[2] = { start[0], start[1] };
+    for (unsigned j = 0; j < nj; ++j)
+    {
+      double q[2] = { p[0], p[1] }, X[3];
+      const bool ok = solver.solve(u0, v0 + j, q, max_iterations) <= error_tol;
+      solver.point(q, X);
+      world_points[std::size_t(j)*ni].set(X[0], X[1], X[2]);
+      valid[std::size_t(j)*ni] = ok;
+      if (ok) { p[0] = q[0]; p[1] = q[1]; }
+    }
+  }
+
+  vnl_parallel_for(nj, [&](unsigned j)
+  {
+    // the last valid solution in this row
+    double last[2] = { start[0], start[1] };
+    solver.free_coords(world_points[std::size_t(j)*ni], last);
+    // grid row and its fraction
+    unsigned b = 0;
+    double fb = 0;
+    if (!gj.empty())
+    {
+      b = unsigned(std::min<std::size_t>(std::upper_bound(gj.begin(), gj.end(), j) - gj.begin(), gj.size()-1) - 1);
+      fb = double(j - gj[b])/(gj[b+1] - gj[b]);
+    }
+    const unsigned first = gi.empty() ? 1 : 0;
+    unsigned a = 0;
+    for (unsigned i = first; i < ni; ++i)
+    {
+      double q[2] = { last[0], last[1] };
+      if (!gi.empty())
+      {
+        while (a+2 < gi.size() && gi[a+1] <= i)
+          ++a;
+        const double fa = double(i - gi[a])/(gi[a+1] - gi[a]);
+        const std::size_t k00 = b*gi.size() + a, k10 = k00 + 1;
+        const std::size_t k01 = k00 + gi.size(), k11 = k01 + 1;
+        if (gvalid[k00] && gvalid[k10] && gvalid[k01] && gvalid[k11])
+          for (unsigned m = 0; m < 2; ++m)
+            q[m] = (1-fb)*((1-fa)*gp[2*k00+m] + fa*gp[2*k10+m]) +
+                   fb*((1-fa)*gp[2*k01+m] + fa*gp[2*k11+m]);
+      }
+      double X[3];
+      const bool ok = solver.solve(u0 + i, v0 + j, q, max_iterations) <= error_tol;
+      solver.point(q, X);
+      const std::size_t k = std::size_t(j)*ni + i;
+      world_points[k].set(X[0], X[1], X[2]);
+      valid[k] = ok;
+      if (ok) { last[0] = q[0]; last[1] = q[1]; }
+    }
+  }, n_threads);
+
+  return unsigned(std::count(valid.begin(), valid.end(), 1));
+}
+
 //Only the direction of the vector is important so it can be
 //normalized to a unit vector. Two rays can be constructed, one through
 //point and one through a point formed by adding the vector to the point
@@ -10,8 +10,11 @@
 // \verbatim
 //   Modifications
 //    Yi Dong  Jun-2015   added relative diameter as one argument, with default value 1.0 (same as before)
+//    Oct 2026 - Added Newton iteration for rational cameras, used first by
+//               bproj_plane(), and backprojection of whole rasters
 // \endverbatim
 
+#include <vector>
 #include <vpgl/vpgl_rational_camera.h>
 #include <vpgl/vpgl_local_rational_camera.h>
 #include <vpgl/vpgl_proj_camera.h>
@@ -30,6 +33,8 @@ class vpgl_backproject
   // vnl interface
 
   //:Backproject an image point onto a plane, start with initial_guess
+  // Rational and local rational cameras are first solved with
+  // bproj_plane_newton(); the general search is used if that fails.
   static bool bproj_plane(const vpgl_camera<double>* cam,
                           vnl_double_2 const& image_point,
                           vnl_double_4 const& plane,
@@ -73,6 +78,40 @@ class vpgl_backproject
                           double error_tol = 0.05,
                           double relative_diameter = 1.0);
 
+  //:Backproject an image point onto a plane by Newton iteration, start with initial_guess
+  // The derivatives of the rational polynomials are evaluated exactly, so
+  // that a few iterations suffice from a guess that projects within some
+  // pixels of \p image_point, such as the solution for a neighbouring
+  // pixel. Works for vpgl_rational_camera and vpgl_local_rational_camera;
+  // returns false for other derived classes, or if the image distance
+  // remains above \p error_tol.
+  static bool bproj_plane_newton(vpgl_rational_camera<double> const& rcam,
+                                 vgl_point_2d<double> const& image_point,
+                                 vgl_plane_3d<double> const& plane,
+                                 vgl_point_3d<double> const& initial_guess,
+                                 vgl_point_3d<double>& world_point,
+                                 double error_tol = 0.05,
+                                 unsigned max_iterations = 20);
+
+  //:Backproject every pixel (u0+i, v0+j), 0<=i<ni, 0<=j<nj, onto a plane
+  // \p world_points receives the ni*nj solutions row by row, and \p valid
+  // is set to 1 where bproj_plane_newton() converged and 0 elsewhere.
+  // Each pixel starts from the solution of its neighbour. If \p grid_step
+  // is above 1, a coarse grid of pixels grid_step apart is solved first
+  // and each pixel instead starts from the bilinear interpolation of the
+  // grid, which usually needs a single iteration to refine. The rows are
+  // shared between \p n_threads threads (0 for all). Only the first pixel
+  // solved depends on \p initial_guess. Returns the number of valid pixels.
+  static unsigned bproj_plane_raster(vpgl_rational_camera<double> const& rcam,
+                                     double u0, double v0, unsigned ni, unsigned nj,
+                                     vgl_plane_3d<double> const& plane,
+                                     vgl_point_3d<double> const& initial_guess,
+                                     std::vector<vgl_point_3d<double> >& world_points,
+                                     std::vector<unsigned char>& valid,
+                                     unsigned grid_step = 0,
+                                     double error_tol = 0.05,
+                                     unsigned n_threads = 0);
+
   //:Backproject a point with associated direction vector in the image to a plane in 3-d, passing through the center of projection and containing the point and vector.
   //  ** Defined only for a projective camera **
   static bool bproj_point_vector(vpgl_proj_camera<double> const& cam,
@@ -4,6 +4,7 @@
 //:
 // \file
 
+#include <cmath>
 #include <iostream>
 #include "vpgl_fm_compute_7_point.h"
 //
@@ -80,7 +81,7 @@ vpgl_fm_compute_7_point::compute(
   std::vector<double> a = get_coeffs(F1, F2);
   std::vector<double> roots = solve_cubic(a);
   for (unsigned int i = 0; i < roots.size(); i++) {
-    vpgl_fundamental_matrix<double> F_temp( F1.as_ref()*roots[0] + F2*(1 - roots[i]) );
+    vpgl_fundamental_matrix<double> F_temp( F1.as_ref()*roots[i] + F2*(1 - roots[i]) );
     if ( precondition_ )
       F_temp.set_matrix( plnt.get_matrix().transpose()*F_temp.get_matrix()*prnt.get_matrix() );
     fm.push_back( new vpgl_fundamental_matrix<double>(F_temp) );
@@ -170,9 +171,7 @@ vpgl_fm_compute_7_point::solve_cubic( std::vector<double> v )
   d = r*r - q*q*q;
   if ( d >= 0.0 ) {
     // Compute a cube root
-    double z;
-    if ( -r + std::sqrt(d) >= 0 ) z = std::exp(std::log(-r + std::sqrt(d))/3.0);
-    else z = -std::exp(std::log(-r + std::sqrt(d))/3.0);
+    double z = std::cbrt(-r + std::sqrt(d));
 
     // The case z=0 is excluded since this is q==0 which is handled above
     std::vector<double> w; w.push_back(z + q/z - b); return w;
@@ -180,7 +179,10 @@ vpgl_fm_compute_7_point::solve_cubic( std::vector<double> v )
 
   // And finally the "irreducible case" (with 3 solutions):
   c = std::sqrt(q);
-  double theta = std::acos( r/q/c ) / 3;
+  double cos3theta = r/q/c; // round off error
+  if (cos3theta > 1.0) cos3theta = 1.0;
+  else if (cos3theta < -1.0) cos3theta = -1.0;
+  double theta = std::acos( cos3theta ) / 3;
   std::vector<double> l;
   l.push_back(-2.0*c*std::cos(theta)                     - b);
   l.push_back(-2.0*c*std::cos(theta + vnl_math::twopi/3) - b);
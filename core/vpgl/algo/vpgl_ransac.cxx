@@ -0,0 +1,417 @@
+// This is core/vpgl/algo/vpgl_ransac.cxx
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "vpgl_ransac.h"
+//:
+// \file
+#include <vnl/vnl_random.h>
+#include <vnl/vnl_inverse.h>
+#include <vnl/vnl_thread_pool.h>
+#include <vgl/vgl_homg_point_2d.h>
+#include <vgl/algo/vgl_h_matrix_2d_compute_4point.h>
+#include <vgl/algo/vgl_h_matrix_2d_compute_linear.h>
+#include <vpgl/algo/vpgl_fm_compute_7_point.h>
+#include <vpgl/algo/vpgl_fm_compute_8_point.h>
+#include <vpgl/algo/vpgl_em_compute_5_point.h>
+
+namespace
+{
+  //: Number of correspondences scored at a time
+  const unsigned vpgl_ransac_block = 256;
+
+  //: Number of hypotheses made between updates of the stopping and test parameters
+  const unsigned vpgl_ransac_batch = 64;
+
+  //: Time to make the models of one sample, in units of the time to score a correspondence
+  const double vpgl_ransac_solve_cost = 200.0;
+
+  //: Squared Sampson distances of m correspondences to the epipolar geometry of F
+  // F is held row by row, with pl^t F pr = 0.
+  void vpgl_ransac_sampson(const double* F, const double* xr, const double* yr,
+                           const double* xl, const double* yl, unsigned m, double* e)
+  {
+    const double f00 = F[0], f01 = F[1], f02 = F[2];
+    const double f10 = F[3], f11 = F[4], f12 = F[5];
+    const double f20 = F[6], f21 = F[7], f22 = F[8];
+    for (unsigned i = 0; i < m; ++i)
+    {
+      // the epipolar lines F pr and F^t pl
+      const double a = f00*xr[i] + f01*yr[i] + f02;
+      const double b = f10*xr[i] + f11*yr[i] + f12;
+      const double c = f20*xr[i] + f21*yr[i] + f22;
+      const double d = f00*xl[i] + f10*yl[i] + f20;
+      const double g = f01*xl[i] + f11*yl[i] + f21;
+      const double t = xl[i]*a + yl[i]*b + c;
+      e[i] = t*t/(a*a + b*b + d*d + g*g);
+    }
+  }
+
+  //: Squared distances from the left points to the right points mapped by H
+  void vpgl_ransac_transfer(const double* H, const double* xr, const double* yr,
+                            const double* xl, const double* yl, unsigned m, double* e)
+  {
+    const double h00 = H[0], h01 = H[1], h02 = H[2];
+    const double h10 = H[3], h11 = H[4], h12 = H[5];
+    const double h20 = H[6], h21 = H[7], h22 = H[8];
+    for (unsigned i = 0; i < m; ++i)
+    {
+      const double w = 1.0/(h20*xr[i] + h21*yr[i] + h22);
+      const double du = (h00*xr[i] + h01*yr[i] + h02)*w - xl[i];
+      const double dv = (h10*xr[i] + h11*yr[i] + h12)*w - yl[i];
+      e[i] = du*du + dv*dv;
+    }
+  }
+
+  //: Number of errors e[0..m-1] at most t2
+  // Kept apart from the error loops, which then vectorise.
+  inline unsigned vpgl_ransac_count(const double* e, unsigned m, double t2)
+  {
+    unsigned c = 0;
+    for (unsigned i = 0; i < m; ++i)
+      if (e[i] <= t2) ++c;
+    return c;
+  }
+
+  //: The best model of one hypothesis, and the scoring of the others
+  struct vpgl_ransac_result
+  {
+    vnl_matrix_fixed<double,3,3> model;
+    unsigned n_inliers;
+    //: models rejected by the ratio test, or abandoned as unable to win
+    unsigned n_rejected, n_dropped;
+    //: correspondences scored and found consistent for the rejected and abandoned models
+    double n_scored, n_consistent;
+  };
+}
+
+vpgl_ransac::vpgl_ransac()
+  : inlier_threshold_(1.0), confidence_(0.99), max_hypotheses_(10000),
+    prosac_(false), sprt_(true), refine_(true), n_threads_(0), seed_(9667566),
+    n_inliers_(0), n_hypotheses_(0), n_rejected_(0)
+{
+}
+
+bool vpgl_ransac::set_points(std::vector<vgl_point_2d<double> > const& pr,
+                             std::vector<vgl_point_2d<double> > const& pl,
+                             unsigned sample_size)
+{
+  inliers_.clear();
+  n_inliers_ = n_hypotheses_ = n_rejected_ = 0;
+  if (pr.size() != pl.size() || pr.size() < sample_size) {
+    std::cerr << "vpgl_ransac: need two lists of at least " << sample_size
+              << " corresponding points, not " << pr.size() << " and " << pl.size() << '\n';
+    return false;
+  }
+  const std::size_t n = pr.size();
+  xr_.resize(n); yr_.resize(n); xl_.resize(n); yl_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    xr_[i] = pr[i].x(); yr_[i] = pr[i].y();
+    xl_[i] = pl[i].x(); yl_[i] = pl[i].y();
+  }
+  return true;
+}
+
+unsigned vpgl_ransac::count_inliers(vnl_matrix_fixed<double,3,3> const& M, bool homography,
+                                    std::vector<bool>* inliers) const
+{
+  const unsigned n = static_cast<unsigned>(xr_.size());
+  const double t2 = inlier_threshold_*inlier_threshold_;
+  if (inliers)
+    inliers->assign(n, false);
+  double e[vpgl_ransac_block];
+  unsigned count = 0;
+  for (unsigned b = 0; b < n; b += vpgl_ransac_block)
+  {
+    const unsigned m = std::min(vpgl_ransac_block, n - b);
+    if (homography)
+      vpgl_ransac_transfer(M.data_block(), &xr_[b], &yr_[b], &xl_[b], &yl_[b], m, e);
+    else
+      vpgl_ransac_sampson(M.data_block(), &xr_[b], &yr_[b], &xl_[b], &yl_[b], m, e);
+    count += vpgl_ransac_count(e, m, t2);
+    if (inliers)
+      for (unsigned i = 0; i < m; ++i)
+        (*inliers)[b+i] = e[i] <= t2;
+  }
+  return count;
+}
+
+// The search proceeds in batches of hypotheses. The best model, the
+// parameters of the ratio test and the PROSAC subset sizes change only
+// between batches, so that the hypotheses of a batch are independent.
+bool vpgl_ransac::search(unsigned sample_size, double models_per_sample,
+                         solver const& solve, bool homography,
+                         vnl_matrix_fixed<double,3,3>& best)
+{
+  const unsigned n = static_cast<unsigned>(xr_.size());
+  const unsigned m = sample_size;
+  const double t2 = inlier_threshold_*inlier_threshold_;
+  unsigned best_count = 0;
+
+  // PROSAC: hypothesis t samples from the first subset_n correspondences,
+  // growing as in Chum and Matas (2005), with T_N = max_hypotheses_
+  unsigned subset_n = m;
+  double T_n = max_hypotheses_;
+  for (unsigned i = 0; i < m; ++i)
+    T_n *= double(m - i)/double(n - i);
+  double T_n_prime = 1.0;
+
+  // probability that a correspondence is consistent with a bad model
+  double delta = 0.05;
+  double scored = 0.0, consistent = 0.0;
+
+  std::vector<unsigned> subset(vpgl_ransac_batch);
+  std::vector<vpgl_ransac_result> results(vpgl_ransac_batch);
+  while (n_hypotheses_ < max_hypotheses_)
+  {
+    const unsigned n_batch = std::min(vpgl_ransac_batch, max_hypotheses_ - n_hypotheses_);
+    for (unsigned j = 0; j < n_batch; ++j) {
+      const double t = n_hypotheses_ + j + 1;
+      while (prosac_ && subset_n < n && t > T_n_prime) {
+        const double T_n1 = T_n*double(subset_n + 1)/double(subset_n + 1 - m);
+        T_n_prime += std::ceil(T_n1 - T_n);
+        T_n = T_n1;
+        ++subset_n;
+      }
+      subset[j] = prosac_ ? subset_n : n;
+    }
+
+    // the ratio test is worthwhile once the best model has clearly more
+    // inliers than a bad one; its threshold A balances the time to make a
+    // hypothesis against the time to score a correspondence
+    const double epsilon = double(best_count)/n;
+    const bool use_sprt = sprt_ && epsilon > 1.5*delta && epsilon < 1.0;
+    double log_A = 0.0, log_in = 0.0, log_out = 0.0;
+    if (use_sprt) {
+      log_in = std::log(delta/epsilon);
+      log_out = std::log((1.0 - delta)/(1.0 - epsilon));
+      const double C = (1.0 - delta)*log_out + delta*log_in;
+      const double K = vpgl_ransac_solve_cost*C/models_per_sample;
+      double A = K + 1.0;
+      for (unsigned it = 0; it < 10; ++it)
+        A = K + 1.0 + std::log(A);
+      log_A = std::log(A);
+    }
+
+    const unsigned first = n_hypotheses_;
+    const unsigned to_beat = best_count;
+    vnl_parallel_for(n_batch, [&](unsigned j)
+    {
+      vpgl_ransac_result& res = results[j];
+      res.n_inliers = 0;
+      res.n_rejected = res.n_dropped = 0;
+      res.n_scored = res.n_consistent = 0.0;
+
+      // draw the sample; with PROSAC it holds the last correspondence of the subset
+      vnl_random rng(seed_, first + j);
+      unsigned sample[8];
+      unsigned k = 0;
+      const unsigned range = subset[j];
+      if (range < n)
+        sample[k++] = range - 1;
+      while (k < m) {
+        const unsigned s = static_cast<unsigned>(rng.lrand32(0, range < n ? range - 2 : range - 1));
+        if (std::find(sample, sample + k, s) == sample + k)
+          sample[k++] = s;
+      }
+
+      std::vector<vnl_matrix_fixed<double,3,3> > models;
+      solve(sample, models);
+      double e[vpgl_ransac_block];
+      for (unsigned h = 0; h < models.size(); ++h)
+      {
+        const double* M = models[h].data_block();
+        const unsigned bar = std::max(to_beat, res.n_inliers);
+        unsigned count = 0, b = 0;
+        double log_lambda = 0.0;
+        bool stopped = false;
+        while (b < n && !stopped)
+        {
+          const unsigned mb = std::min(vpgl_ransac_block, n - b);
+          if (homography)
+            vpgl_ransac_transfer(M, &xr_[b], &yr_[b], &xl_[b], &yl_[b], mb, e);
+          else
+            vpgl_ransac_sampson(M, &xr_[b], &yr_[b], &xl_[b], &yl_[b], mb, e);
+          const unsigned c = vpgl_ransac_count(e, mb, t2);
+          count += c;
+          b += mb;
+          if (use_sprt) {
+            log_lambda += c*log_in + (mb - c)*log_out;
+            if (log_lambda > log_A) {
+              ++res.n_rejected;
+              stopped = true;
+            }
+          }
+          if (!stopped && count + (n - b) <= bar) {
+            ++res.n_dropped;
+            stopped = true;
+          }
+        }
+        if (stopped) {
+          res.n_scored += b;
+          res.n_consistent += count;
+        }
+        else if (count > res.n_inliers) {
+          res.n_inliers = count;
+          res.model = models[h];
+        }
+      }
+    }, n_threads_);
+
+    // the first hypothesis with the most inliers wins, whatever the threads did
+    for (unsigned j = 0; j < n_batch; ++j) {
+      vpgl_ransac_result const& res = results[j];
+      if (res.n_inliers > best_count) {
+        best_count = res.n_inliers;
+        best = res.model;
+      }
+      n_rejected_ += res.n_rejected;
+      scored += res.n_scored;
+      consistent += res.n_consistent;
+    }
+    n_hypotheses_ += n_batch;
+    if (scored > 0.0)
+      delta = std::min(0.5, std::max(1e-4, consistent/scored));
+
+    // stop when an all-inlier sample, not rejected by the test, has been
+    // drawn with the required confidence
+    if (best_count > 0) {
+      double p = std::pow(double(best_count)/n, double(m));
+      if (use_sprt)
+        p *= 1.0 - std::exp(-log_A);
+      if (p >= 1.0)
+        break;
+      const double needed = std::log(1.0 - confidence_)/std::log(1.0 - p);
+      if (n_hypotheses_ >= needed)
+        break;
+    }
+  }
+  return best_count >= m;
+}
+
+bool vpgl_ransac::compute(std::vector<vgl_point_2d<double> > const& pr,
+                          std::vector<vgl_point_2d<double> > const& pl,
+                          vpgl_fundamental_matrix<double>& fm)
+{
+  if (!this->set_points(pr, pl, 7))
+    return false;
+  solver solve = [this](const unsigned* s, std::vector<vnl_matrix_fixed<double,3,3> >& models)
+  {
+    std::vector<vgl_homg_point_2d<double> > r7, l7;
+    for (unsigned k = 0; k < 7; ++k) {
+      r7.push_back(vgl_homg_point_2d<double>(xr_[s[k]], yr_[s[k]]));
+      l7.push_back(vgl_homg_point_2d<double>(xl_[s[k]], yl_[s[k]]));
+    }
+    std::vector<vpgl_fundamental_matrix<double>*> fms;
+    vpgl_fm_compute_7_point fc7(true);
+    if (fc7.compute(r7, l7, fms))
+      for (unsigned i = 0; i < fms.size(); ++i)
+        models.push_back(fms[i]->get_matrix());
+    for (unsigned i = 0; i < fms.size(); ++i)
+      delete fms[i];
+  };
+  vnl_matrix_fixed<double,3,3> F;
+  if (!this->search(7, 1.5, solve, false, F))
+    return false;
+  n_inliers_ = this->count_inliers(F, false, &inliers_);
+
+  if (refine_) {
+    std::vector<vgl_homg_point_2d<double> > rin, lin;
+    for (unsigned i = 0; i < inliers_.size(); ++i)
+      if (inliers_[i]) {
+        rin.push_back(vgl_homg_point_2d<double>(xr_[i], yr_[i]));
+        lin.push_back(vgl_homg_point_2d<double>(xl_[i], yl_[i]));
+      }
+    vpgl_fundamental_matrix<double> refit;
+    vpgl_fm_compute_8_point fc8(true);
+    if (rin.size() >= 8 && fc8.compute(rin, lin, refit)) {
+      std::vector<bool> refit_inliers;
+      const unsigned count = this->count_inliers(refit.get_matrix(), false, &refit_inliers);
+      if (count >= n_inliers_) {
+        F = refit.get_matrix();
+        n_inliers_ = count;
+        inliers_.swap(refit_inliers);
+      }
+    }
+  }
+  fm.set_matrix(F);
+  return true;
+}
+
+bool vpgl_ransac::compute(std::vector<vgl_point_2d<double> > const& pr,
+                          vpgl_calibration_matrix<double> const& kr,
+                          std::vector<vgl_point_2d<double> > const& pl,
+                          vpgl_calibration_matrix<double> const& kl,
+                          vpgl_essential_matrix<double>& em)
+{
+  if (!this->set_points(pr, pl, 5))
+    return false;
+  // hypotheses are scored as fundamental matrices, in pixels
+  const vnl_matrix_fixed<double,3,3> kr_inv = vnl_inverse(kr.get_matrix());
+  const vnl_matrix_fixed<double,3,3> kl_inv_t = vnl_inverse(kl.get_matrix()).transpose();
+  solver solve = [&](const unsigned* s, std::vector<vnl_matrix_fixed<double,3,3> >& models)
+  {
+    std::vector<vgl_point_2d<double> > r5, l5;
+    for (unsigned k = 0; k < 5; ++k) {
+      r5.push_back(vgl_point_2d<double>(xr_[s[k]], yr_[s[k]]));
+      l5.push_back(vgl_point_2d<double>(xl_[s[k]], yl_[s[k]]));
+    }
+    std::vector<vpgl_essential_matrix<double> > ems;
+    vpgl_em_compute_5_point<double> fc5;
+    if (fc5.compute(r5, kr, l5, kl, ems))
+      for (unsigned i = 0; i < ems.size(); ++i)
+        models.push_back(kl_inv_t*ems[i].get_matrix()*kr_inv);
+  };
+  vnl_matrix_fixed<double,3,3> F;
+  if (!this->search(5, 4.0, solve, false, F))
+    return false;
+  n_inliers_ = this->count_inliers(F, false, &inliers_);
+  em = vpgl_essential_matrix<double>(vpgl_fundamental_matrix<double>(F), kl, kr);
+  return true;
+}
+
+bool vpgl_ransac::compute(std::vector<vgl_point_2d<double> > const& pr,
+                          std::vector<vgl_point_2d<double> > const& pl,
+                          vgl_h_matrix_2d<double>& H)
+{
+  if (!this->set_points(pr, pl, 4))
+    return false;
+  solver solve = [this](const unsigned* s, std::vector<vnl_matrix_fixed<double,3,3> >& models)
+  {
+    std::vector<vgl_homg_point_2d<double> > r4, l4;
+    for (unsigned k = 0; k < 4; ++k) {
+      r4.push_back(vgl_homg_point_2d<double>(xr_[s[k]], yr_[s[k]]));
+      l4.push_back(vgl_homg_point_2d<double>(xl_[s[k]], yl_[s[k]]));
+    }
+    vgl_h_matrix_2d<double> h;
+    vgl_h_matrix_2d_compute_4point hc4;
+    if (hc4.compute(r4, l4, h))
+      models.push_back(h.get_matrix());
+  };
+  vnl_matrix_fixed<double,3,3> M;
+  if (!this->search(4, 1.0, solve, true, M))
+    return false;
+  n_inliers_ = this->count_inliers(M, true, &inliers_);
+
+  if (refine_) {
+    std::vector<vgl_homg_point_2d<double> > rin, lin;
+    for (unsigned i = 0; i < inliers_.size(); ++i)
+      if (inliers_[i]) {
+        rin.push_back(vgl_homg_point_2d<double>(xr_[i], yr_[i]));
+        lin.push_back(vgl_homg_point_2d<double>(xl_[i], yl_[i]));
+      }
+    vgl_h_matrix_2d<double> refit;
+    vgl_h_matrix_2d_compute_linear hcl;
+    if (rin.size() >= 5 && hcl.compute(rin, lin, refit)) {
+      std::vector<bool> refit_inliers;
+      const unsigned count = this->count_inliers(refit.get_matrix(), true, &refit_inliers);
+      if (count >= n_inliers_) {
+        M = refit.get_matrix();
+        n_inliers_ = count;
+        inliers_.swap(refit_inliers);
+      }
+    }
+  }
+  H = vgl_h_matrix_2d<double>(M);
+  return true;
+}
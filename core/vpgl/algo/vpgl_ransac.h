@@ -0,0 +1,164 @@
+// This is core/vpgl/algo/vpgl_ransac.h
+#ifndef vpgl_ransac_h_
+#define vpgl_ransac_h_
+//:
+// \file
+// \brief Robust estimation of fundamental, essential and homography matrices
+//
+// vpgl_ransac fits a two-view model to point correspondences, of which
+// many may be wrong, by random sampling: a minimal solver makes model
+// hypotheses from random samples of the correspondences, and the model
+// consistent with the most correspondences wins. The fundamental matrix
+// is found with vpgl_fm_compute_7_point, the essential matrix with
+// vpgl_em_compute_5_point and the homography with
+// vgl_h_matrix_2d_compute_4point.
+//
+// The hypotheses are made and scored on several threads, a fixed batch
+// at a time, so for a given seed the result does not depend on the number
+// of threads. Each hypothesis draws its sample from its own counter-based
+// vnl_random stream. The correspondences are held in separate coordinate
+// arrays, and the error of each is computed in a loop that the compiler
+// vectorises, a block at a time.
+//
+// A hypothesis is rejected early by Wald's sequential probability ratio
+// test (Matas and Chum, "Randomized RANSAC with sequential probability
+// ratio test", ICCV 2005), checked after each block of correspondences:
+// a bad model is dismissed after a few blocks instead of being scored
+// against every correspondence. If the correspondences are ordered from
+// most to least reliable, for instance by descriptor distance, PROSAC
+// (Chum and Matas, "Matching with PROSAC - progressive sample consensus",
+// CVPR 2005) draws the early samples from the best of them.
+//
+// The search stops when an all-inlier sample has been drawn with the
+// requested confidence, given the best inlier ratio found, or after the
+// maximum number of hypotheses. The fundamental matrix and homography
+// are then refitted to all their inliers, by the 8 point and the linear
+// algorithm respectively, if that does not lose inliers.
+//
+// To process many image pairs, call compute() for several pairs in
+// parallel with set_n_threads(1), one vpgl_ransac per thread.
+//
+// \verbatim
+//  Modifications
+//   <none yet>
+// \endverbatim
+
+#include <functional>
+#include <vector>
+#include <vcl_compiler.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/algo/vgl_h_matrix_2d.h>
+#include <vpgl/vpgl_fundamental_matrix.h>
+#include <vpgl/vpgl_essential_matrix.h>
+#include <vpgl/vpgl_calibration_matrix.h>
+
+class vpgl_ransac
+{
+ public:
+  //: Default options: 1 pixel threshold, 0.99 confidence, SPRT and refitting on
+  vpgl_ransac();
+
+  //: Largest error of an inlier, in pixels
+  // The error is the Sampson distance to the epipolar geometry for
+  // fundamental and essential matrices, and the distance between the left
+  // point and the mapped right point for homographies.
+  void set_inlier_threshold(double t) { inlier_threshold_ = t; }
+
+  //: Probability of having drawn an all-inlier sample when the search stops
+  void set_confidence(double c) { confidence_ = c; }
+
+  //: Largest number of hypotheses, that is of minimal samples
+  void set_max_hypotheses(unsigned n) { max_hypotheses_ = n; }
+
+  //: Set if the correspondences are ordered best first, to sample them by PROSAC
+  void set_prosac(bool p) { prosac_ = p; }
+
+  //: Reject hypotheses early by the sequential probability ratio test
+  void set_sprt(bool s) { sprt_ = s; }
+
+  //: Refit the fundamental matrix or homography to all its inliers
+  void set_refine(bool r) { refine_ = r; }
+
+  //: Number of threads to use, 0 for all
+  void set_n_threads(unsigned n) { n_threads_ = n; }
+
+  //: Seed of the random samples; equal seeds give equal results
+  void set_seed(unsigned long s) { seed_ = s; }
+
+  //: Estimate the fundamental matrix F with pl^t F pr = 0
+  // Returns false if there are fewer than 7 correspondences or no
+  // hypothesis has 7 inliers.
+  bool compute(std::vector<vgl_point_2d<double> > const& pr,
+               std::vector<vgl_point_2d<double> > const& pl,
+               vpgl_fundamental_matrix<double>& fm);
+
+  //: Estimate the essential matrix of two calibrated cameras
+  // The points are in pixels; the inlier threshold applies to the
+  // fundamental matrix Kl^-t E Kr^-1. Returns false if there are fewer
+  // than 5 correspondences or no hypothesis has 5 inliers.
+  bool compute(std::vector<vgl_point_2d<double> > const& pr,
+               vpgl_calibration_matrix<double> const& kr,
+               std::vector<vgl_point_2d<double> > const& pl,
+               vpgl_calibration_matrix<double> const& kl,
+               vpgl_essential_matrix<double>& em);
+
+  //: Estimate the homography H that maps each point of pr to that of pl
+  // Returns false if there are fewer than 4 correspondences or no
+  // hypothesis has 4 inliers.
+  bool compute(std::vector<vgl_point_2d<double> > const& pr,
+               std::vector<vgl_point_2d<double> > const& pl,
+               vgl_h_matrix_2d<double>& H);
+
+  //: Which correspondences are inliers of the last estimate
+  std::vector<bool> const& inliers() const { return inliers_; }
+
+  //: Number of inliers of the last estimate
+  unsigned n_inliers() const { return n_inliers_; }
+
+  //: Number of samples drawn by the last estimation
+  unsigned n_hypotheses() const { return n_hypotheses_; }
+
+  //: Number of models from those samples rejected early by the probability ratio test
+  unsigned n_rejected() const { return n_rejected_; }
+
+ private:
+  //: Models computed from the correspondences of a minimal sample
+  typedef std::function<void(const unsigned* sample,
+                              std::vector<vnl_matrix_fixed<double,3,3> >& models)> solver;
+
+  //: Copy the correspondences into the coordinate arrays
+  bool set_points(std::vector<vgl_point_2d<double> > const& pr,
+                  std::vector<vgl_point_2d<double> > const& pl,
+                  unsigned sample_size);
+
+  //: Search for the best model from samples of sample_size correspondences
+  // models_per_sample is the average number of solutions of the solver,
+  // used to weigh the cost of making a hypothesis against scoring it.
+  bool search(unsigned sample_size, double models_per_sample,
+              solver const& solve, bool homography,
+              vnl_matrix_fixed<double,3,3>& best);
+
+  //: The number of inliers of M, and which they are if \p inliers is given
+  unsigned count_inliers(vnl_matrix_fixed<double,3,3> const& M, bool homography,
+                         std::vector<bool>* inliers) const;
+
+  double inlier_threshold_;
+  double confidence_;
+  unsigned max_hypotheses_;
+  bool prosac_;
+  bool sprt_;
+  bool refine_;
+  unsigned n_threads_;
+  unsigned long seed_;
+
+  //: coordinates of the right and left points
+  std::vector<double> xr_, yr_, xl_, yl_;
+
+  std::vector<bool> inliers_;
+  unsigned n_inliers_;
+  unsigned n_hypotheses_;
+  unsigned n_rejected_;
+};
+
+#endif // vpgl_ransac_h_
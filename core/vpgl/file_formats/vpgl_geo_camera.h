@@ -72,6 +72,8 @@ class vpgl_geo_camera : public vpgl_camera<double>
   //  x,y,z are in local coordinates, u represents image column, v image row
   void project(const double x, const double y, const double z, double& u, double& v) const;
 
+  using vpgl_camera<double>::project;
+
   //: backprojects an image point into local coordinates (based on lvcs_)
   void backproject(const double u, const double v, double& x, double& y, double& z);
 
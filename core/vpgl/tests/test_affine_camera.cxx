@@ -1,3 +1,4 @@
+#include <cmath>
 #include <testlib/testlib_test.h>
 
 #include <vpgl/vpgl_affine_camera.h>
@@ -41,6 +42,20 @@ static void test_affine_camera()
   vgl_homg_plane_3d<double> pp = C.principal_plane();
   double algd = (pp.a()+pp.b()+pp.c())*1000*sq3+pp.d();
   TEST_NEAR("principal plane", algd, 0.0, 1e-08);
+
+  // Batch projection, through the base class as an orthorectification loop would
+  double xyz[3*5] = { 0.5, 0.5, 0.0,  0, 0, 0,  1, 0, 0,  0, 1, 0,  -3, 7, 12.5 };
+  double uv[2*5];
+  vpgl_camera<double> const& cam = C;
+  cam.project(xyz, 5, uv);
+  double err = 0;
+  for (unsigned i = 0; i < 5; ++i)
+  {
+    double u, v;
+    C.project(xyz[3*i], xyz[3*i+1], xyz[3*i+2], u, v);
+    err += std::fabs(u - uv[2*i]) + std::fabs(v - uv[2*i+1]);
+  }
+  TEST_NEAR("batch projection", err, 0.0, 1e-12);
 }
 
 TESTMAIN(test_affine_camera);
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <sstream>
+#include <string>
 #include <testlib/testlib_test.h>
 
 #include <vpgl/vpgl_generic_camera.h>
@@ -144,10 +147,108 @@ static void proj_test()
 }
 
 
+static void compact_test()
+{
+  unsigned ni = 640;
+  unsigned nj = 479;
+  vpgl_calibration_matrix<double> K(ni, vgl_point_2d<double>((double)ni/2.0, (double)nj/2.0));
+  vgl_point_3d<double> center(10.0, 5.0, 15.0);
+  vgl_rotation_3d<double> R;
+  vpgl_perspective_camera<double> pcam(K, center, R);
+
+  // rays of every 8th pixel, and of the last row and column
+  const unsigned step = 8;
+  unsigned gni = (ni+step-2)/step+1, gnj = (nj+step-2)/step+1;
+  vbl_array_2d<vgl_ray_3d<double> > grid(gnj, gni);
+  for (unsigned j=0; j<gnj; ++j)
+    for (unsigned i=0; i<gni; ++i)
+      grid(j,i) = pcam.backproject_ray(std::min(i*step, ni-1), std::min(j*step, nj-1));
+  vpgl_generic_camera<double> gcam(grid, step, nj, ni);
+  TEST("compact camera", gcam.is_compact() && gcam.grid_step() == step &&
+       gcam.cols() == ni && gcam.rows() == nj && gcam.rays(0).rows() == 0, true);
+
+  std::vector<vgl_point_2d<double> > test_pts;
+  test_pts.push_back(vgl_point_2d<double>(16.0, 24.0));   // grid ray
+  test_pts.push_back(vgl_point_2d<double>(639.0, 478.0)); // last grid ray
+  test_pts.push_back(vgl_point_2d<double>(280.9, 1.9));
+  test_pts.push_back(vgl_point_2d<double>(635.3, 475.7)); // last, narrower cell
+  test_pts.push_back(vgl_point_2d<double>(-0.5, -0.5));
+  test_pts.push_back(vgl_point_2d<double>(639.5, 478.5));
+  double max_err = 0.0;
+  for (unsigned k = 0; k<test_pts.size(); ++k) {
+    double u = test_pts[k].x(), v = test_pts[k].y();
+    vgl_ray_3d<double> ray = pcam.backproject_ray(u, v);
+    vgl_ray_3d<double> r = gcam.ray(u, v);
+    double err = (r.origin()-ray.origin()).length() + (r.direction()-ray.direction()).length();
+    if (err>max_err) max_err = err;
+  }
+  TEST_NEAR("interpolated rays of compact camera", max_err, 0.0, 1e-4);
+  TEST_NEAR("grid ray of compact camera is exact",
+            (gcam.ray(16.0, 24.0).direction()-grid(3,2).direction()).length(), 0.0, 1e-15);
+
+  // level 2 is not stored, but is printed from interpolated rays
+  std::ostringstream vrml;
+  gcam.print_to_vrml(2, vrml);
+  std::string vs = vrml.str();
+  unsigned n_spheres = 0;
+  for (std::size_t p = vs.find("Transform"); p != std::string::npos; p = vs.find("Transform", p+1))
+    ++n_spheres;
+  TEST("vrml of a level a compact camera does not store",
+       gcam.rays(2).rows() == 0 && n_spheres == gcam.cols(2)*gcam.rows(2), true);
+
+  std::vector<vgl_point_3d<double> > pts;
+  vgl_vector_3d<double> offset(center.x(), center.y(), center.z());
+  pts.push_back(vgl_point_3d<double>(-4.2, -1.0, 10.9)+offset);
+  pts.push_back(vgl_point_3d<double>(4.0, 2.9, 11.3)+offset);
+  pts.push_back(vgl_point_3d<double>(1.3, 0.1, 5.4)+offset);
+  pts.push_back(vgl_point_3d<double>(-1.5, -2.1, 10.0)+offset);
+  max_err = 0.0;
+  for (unsigned k = 0; k<pts.size(); ++k) {
+    vgl_point_2d<double> p2d = pcam.project(pts[k]);
+    double u, v;
+    gcam.project(pts[k].x(), pts[k].y(), pts[k].z(), u, v);
+    double err = std::fabs(u-p2d.x()) + std::fabs(v-p2d.y());
+    if (err>max_err) max_err = err;
+  }
+  // the ray error times the focal length, in pixels
+  TEST_NEAR("projection by compact camera", max_err, 0.0, 2e-2);
+
+  // the batch project() of vpgl_camera is visible through the derived class
+  double xyz[12], uv[8];
+  for (unsigned k = 0; k<pts.size(); ++k) {
+    xyz[3*k] = pts[k].x(); xyz[3*k+1] = pts[k].y(); xyz[3*k+2] = pts[k].z();
+  }
+  gcam.project(xyz, pts.size(), uv);
+  double u3, v3;
+  gcam.project(xyz[9], xyz[10], xyz[11], u3, v3);
+  TEST("batch projection", uv[6]==u3 && uv[7]==v3, true);
+
+  // compact a full camera in single precision
+  vbl_array_2d<vgl_ray_3d<double> > rays(nj, ni);
+  for (unsigned j=0; j<nj; ++j)
+    for (unsigned i=0; i<ni; ++i)
+      rays(j,i) = pcam.backproject_ray(i, j);
+  vpgl_generic_camera<double> fcam(rays);
+  double cerr = fcam.compact(step, true);
+  TEST("compacted camera", fcam.is_compact() && fcam.rays(0).rows() == 0, true);
+  TEST_NEAR("interpolation error of compacted camera", cerr, 0.0, 1e-4);
+  vgl_ray_3d<double> r = fcam.ray(280.9, 1.9), ray = pcam.backproject_ray(280.9, 1.9);
+  TEST_NEAR("ray of single precision camera",
+            (r.origin()-ray.origin()).length() + (r.direction()-ray.direction()).length(), 0.0, 1e-4);
+  double u, v;
+  fcam.project(pts[1].x(), pts[1].y(), pts[1].z(), u, v);
+  vgl_point_2d<double> p2d = pcam.project(pts[1]);
+  TEST_NEAR("projection by single precision camera",
+            std::fabs(u-p2d.x()) + std::fabs(v-p2d.y()), 0.0, 2e-2);
+  TEST_NEAR("compacting twice does nothing", fcam.compact(2), 0.0, 0.0);
+}
+
+
 static void test_generic_camera()
 {
   simple_test();
   proj_test();
+  compact_test();
 }
 
 TESTMAIN(test_generic_camera);
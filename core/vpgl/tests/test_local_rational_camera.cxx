@@ -110,6 +110,19 @@ static void test_local_rational_camera()
   lrcam.project(0, 200, 46, ul1, vl1);
   TEST_NEAR("test displacement North", std::fabs(ug1-ul1)+std::fabs(vg1-vl1),
             0.0, 3);
+
+  // Batch projection of local points
+  double xyz[3*4] = { 0, 0, 0,  202.47, 0, 50,  0, 200, 46,  -150, 75, 10 };
+  double uv[2*4];
+  lrcam.project(xyz, 4, uv);
+  double err = 0;
+  for (unsigned i = 0; i < 4; ++i)
+  {
+    double u, v;
+    lrcam.project(xyz[3*i], xyz[3*i+1], xyz[3*i+2], u, v);
+    err += std::fabs(u-uv[2*i]) + std::fabs(v-uv[2*i+1]);
+  }
+  TEST_NEAR("batch projection", err, 0.0, 1e-8);
 }
 
 TESTMAIN(test_local_rational_camera);
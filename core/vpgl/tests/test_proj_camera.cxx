@@ -1,3 +1,4 @@
+#include <cmath>
 #include <iostream>
 #include <testlib/testlib_test.h>
 // not used? #include <vcl_compiler.h>
@@ -215,6 +216,25 @@ static void test_proj_camera()
     }
   }
   TEST("test image Jacobians", valid, true);
+
+  // Batch projection agrees with projecting one point at a time; the
+  // second point lies on the principal plane and projects to infinity.
+  {
+    vpgl_proj_camera<double> P(random_matrix3);
+    double xyz[3*4] = { 1, 2, 3,  0, 0, 5,  -4, 0.5, 2,  10, -20, 30 };
+    double uv[2*4];
+    P.project(xyz, 4, uv);
+    bool same = uv[2] == 0 && uv[3] == 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+      if (i == 1) continue;
+      double u, v;
+      P.project(xyz[3*i], xyz[3*i+1], xyz[3*i+2], u, v);
+      same = same && std::fabs(u - uv[2*i]) < 1e-12*(1+std::fabs(u))
+                  && std::fabs(v - uv[2*i+1]) < 1e-12*(1+std::fabs(v));
+    }
+    TEST("batch projection", same, true);
+  }
 }
 
 
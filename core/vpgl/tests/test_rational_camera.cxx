@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <testlib/testlib_test.h>
@@ -60,6 +61,47 @@ static void test_rational_camera()
     good = good && eu<0.01 && ev < 0.01;
   }
   TEST("test rational camera projection", good, true);
+
+  // Batch projection, first of the points above, then of enough points
+  // to be split between threads
+  {
+    double xyz[3*8], uv[2*8];
+    for (unsigned i = 0; i<8; ++i)
+    {
+      xyz[3*i] = act_x[i]; xyz[3*i+1] = act_y[i]; xyz[3*i+2] = act_z[i];
+    }
+    rcam.project(xyz, 8, uv);
+    good = true;
+    for (unsigned i = 0; i<8; ++i)
+      good = good && std::fabs(uv[2*i]-act_u[i]) < 0.01 && std::fabs(uv[2*i+1]-act_v[i]) < 0.01;
+    TEST("batch projection", good, true);
+
+    const unsigned n = 50001;
+    std::vector<double> pts(3*n), batch(2*n);
+    for (unsigned i = 0; i<n; ++i)
+    {
+      pts[3*i] = 150.0 + 50.0*(i%101)/100.0;
+      pts[3*i+1] = 100.0 + 125.0*((i/101)%97)/96.0;
+      pts[3*i+2] = 10.0 + 5.0*(i%7)/6.0;
+    }
+    vpgl_camera<double> const& cam = rcam;
+    cam.project(&pts[0], n, &batch[0]);
+    double max_err = 0;
+    for (unsigned i = 0; i<n; ++i)
+    {
+      rcam.project(pts[3*i], pts[3*i+1], pts[3*i+2], u, v);
+      max_err = std::max(max_err, std::max(std::fabs(u-batch[2*i]), std::fabs(v-batch[2*i+1])));
+    }
+    TEST_NEAR("large batch projection", max_err, 0.0, 1e-9);
+
+    vpgl_rational_camera<float> fcam(&neu_u[0], &den_u[0], &neu_v[0], &den_v[0],
+                                     float(sx), float(ox), float(sy), float(oy), float(sz), float(oz),
+                                     float(su), float(ou), float(sv), float(ov));
+    float fxyz[3] = { 175.0f, 160.0f, 12.0f }, fuv[2];
+    fcam.project(fxyz, 1, fuv);
+    rcam.project(175.0, 160.0, 12.0, u, v);
+    TEST_NEAR("float batch projection", std::fabs(fuv[0]-u) + std::fabs(fuv[1]-v), 0.0, 1e-2);
+  }
   //Test various constructors
   // Set values on default constructor
   std::vector<std::vector<double> > coeff_array;
@@ -14,6 +14,8 @@
 //  viewing distance to allow these methods to construct finite objects when
 //  the camera center is infinity.
 //  at infinity.
+//  Oct 2026 - Added block-wise projection of arrays of points, without the
+//  division by w of the projective camera.
 // \endverbatim
 
 #include <vnl/vnl_fwd.h>
@@ -59,6 +61,13 @@ class vpgl_affine_camera : public vpgl_proj_camera<T>
   void set_rows( const vnl_vector_fixed<T,4>& row1,
                  const vnl_vector_fixed<T,4>& row2 );
 
+  using vpgl_proj_camera<T>::project;
+
+  //: Project \p n points stored as x, y, z triples into \p uv, as u, v pairs.
+  // The last row of an affine camera is (0 0 0 1), so each point needs only
+  // the first two rows of the matrix.
+  virtual void project(const T* xyz, std::size_t n, T* uv) const;
+
   // === The following virtual functions require special treatment for the affine camera ===
 
   //: set a finite viewing distance to allow the methods below to return finite objects
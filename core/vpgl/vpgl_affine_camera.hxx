@@ -4,6 +4,7 @@
 //:
 // \file
 
+#include <algorithm>
 #include "vpgl_affine_camera.h"
 #include <vnl/vnl_vector_fixed.h>
 #include <vnl/vnl_matrix_fixed.h>
@@ -153,6 +154,36 @@ bool vpgl_affine_camera<T>::set_matrix( const T* new_camera_matrix_p )
   return true;
 }
 
+template <class T>
+void vpgl_affine_camera<T>::project(const T* xyz, std::size_t n, T* uv) const
+{
+  const T* P = this->get_matrix().data_block();
+  vpgl_project_ranges(n, [&](std::size_t begin, std::size_t end)
+  {
+    T x[vpgl_project_block_size], y[vpgl_project_block_size], z[vpgl_project_block_size];
+    T u[vpgl_project_block_size], v[vpgl_project_block_size];
+    for (std::size_t b = begin; b < end; b += vpgl_project_block_size)
+    {
+      const unsigned m = unsigned(std::min<std::size_t>(vpgl_project_block_size, end - b));
+      const T* in = xyz + 3*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        x[i] = in[3*i]; y[i] = in[3*i+1]; z[i] = in[3*i+2];
+      }
+      for (unsigned i = 0; i < m; ++i)
+      {
+        u[i] = P[0]*x[i] + P[1]*y[i] + P[2]*z[i] + P[3];
+        v[i] = P[4]*x[i] + P[5]*y[i] + P[6]*z[i] + P[7];
+      }
+      T* out = uv + 2*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        out[2*i] = u[i]; out[2*i+1] = v[i];
+      }
+    }
+  });
+}
+
 //: Find the 3d coordinates of the center of the camera. Will be an ideal point with the sense of the ray direction.
 template <class T>
 vgl_homg_point_3d<T> vpgl_affine_camera<T>::camera_center() const
@@ -0,0 +1,23 @@
+// This is core/vpgl/vpgl_camera.cxx
+#include "vpgl_camera.h"
+//:
+// \file
+#include <vnl/vnl_thread_pool.h>
+
+void vpgl_project_ranges(std::size_t n,
+                         std::function<void(std::size_t, std::size_t)> const& f)
+{
+  // Below this many points the projection takes less time than waking workers
+  const std::size_t min_parallel = 16384;
+  const std::size_t range = 64*vpgl_project_block_size;
+  if (n < min_parallel || vnl_thread_pool::hardware_threads() < 2)
+  {
+    f(0, n);
+    return;
+  }
+  const unsigned n_ranges = unsigned((n + range - 1)/range);
+  vnl_parallel_for(n_ranges, [&](unsigned k) {
+    const std::size_t begin = k*range;
+    f(begin, begin + range < n ? begin + range : n);
+  });
+}
@@ -19,11 +19,16 @@
 //  Modifications
 //   October 26, 2006 - Moved homogeneous methods to projective camera, since
 //                      projective geometry may not apply in the most general case, e.g. rational cameras. - JLM
+//   Oct 2026 - Added project() of an array of points, overridden with
+//              block-wise kernels by the projective and rational cameras
 // \endverbatim
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vcl_compiler.h>
 #include <vbl/vbl_ref_count.h>
+#include <vpgl/vpgl_export.h>
 
 template <class T>
 class vpgl_camera : public vbl_ref_count
@@ -40,8 +45,31 @@ class vpgl_camera : public vbl_ref_count
 
   //: The generic camera interface. u represents image column, v image row.
   virtual void project(const T x, const T y, const T z, T& u, T& v) const = 0;
+
+  //: Project \p n points at once.
+  // \p xyz holds x, y, z of each point in turn and \p uv receives u, v of
+  // each. The default calls the single point project() for each point;
+  // cameras with a closed form projection override it, so that a large
+  // set of points costs one virtual call rather than one per point.
+  // A class that overrides the single point project() of a camera with
+  // its own batch project() must override this one as well.
+  virtual void project(const T* xyz, std::size_t n, T* uv) const
+  {
+    for (std::size_t i = 0; i < n; ++i, xyz += 3, uv += 2)
+      this->project(xyz[0], xyz[1], xyz[2], uv[0], uv[1]);
+  }
 };
 
+//: Number of points processed together by the batch projection kernels
+const unsigned vpgl_project_block_size = 64;
+
+//: Call f(begin, end) on consecutive ranges covering [0, n).
+// The ranges are processed on several threads when \p n is large enough
+// to pay for them; each range is a multiple of vpgl_project_block_size
+// long, except perhaps the last.
+VPGL_EXPORT void vpgl_project_ranges(std::size_t n,
+                                     std::function<void(std::size_t, std::size_t)> const& f);
+
 // convenience typedefs for smart pointers to abstract cameras
 #include "vpgl_camera_double_sptr.h"
 #include "vpgl_camera_float_sptr.h"
@@ -20,9 +20,17 @@
 //
 //   Pixels (point samples, really) are centered at integer values; consequently,
 //   the leading edge of pixel (0,0) is technically (-0.5, -0.5).
+//
+//   Storing a ray for every pixel takes six numbers per pixel, which is
+//   gigabytes for a large image. A compact camera instead stores the rays
+//   of every grid_step-th pixel, optionally in single precision, and
+//   interpolates the ray of any other pixel bilinearly on demand, as ray()
+//   does between pixels. The coarse levels of the projection pyramid are
+//   stored; the fine levels are interpolated as they are searched.
 
 // \verbatim
-//  Modifications <none>
+//  Modifications
+//   Oct 2026 - Added compact cameras, storing a subsampled ray grid
 // \endverbatim
 
 #include <iosfwd>
@@ -42,6 +50,16 @@ class vpgl_generic_camera : public vpgl_camera<T>
   vpgl_generic_camera( vbl_array_2d<vgl_ray_3d<T> > const& rays);
   vpgl_generic_camera( std::vector<vbl_array_2d<vgl_ray_3d<T> > > const& rays,
                                               std::vector<int> nrs,   std::vector<int> ncs  );
+
+  //: A compact camera for an image of \p nr rows and \p nc columns
+  // grid[r][c] is the ray of pixel (c*grid_step, r*grid_step), except that
+  // the last row and column of the grid hold the rays of the last row and
+  // column of the image, so the grid has (nr+grid_step-2)/grid_step+1 rows
+  // and (nc+grid_step-2)/grid_step+1 columns. The grid is held in single
+  // precision if \p single_precision is set.
+  vpgl_generic_camera( vbl_array_2d<vgl_ray_3d<T> > const& grid, unsigned grid_step,
+                       int nr, int nc, bool single_precision = false);
+
   virtual ~vpgl_generic_camera() {}
 
   virtual std::string type_name() const { return "vpgl_generic_camera"; }
@@ -49,13 +67,15 @@ class vpgl_generic_camera : public vpgl_camera<T>
   //: The generic camera interface. u represents image column, v image row. Finds projection using a pyramid search over the rays and so not particularly efficient.
   virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+  using vpgl_camera<T>::project;
+
   //: the number of columns (u coordinate) in the ray image
-  unsigned cols(int level) const {return rays_[level].cols();}
-  unsigned cols() const { return rays_[0].cols();}
+  unsigned cols(int level) const {return nc_[level];}
+  unsigned cols() const { return nc_[0];}
 
   //: the number of rows (v coordinate) in the ray image
-  unsigned rows(int level) const {return rays_[level].rows();}
-  unsigned rows() const { return rays_[0].rows();}
+  unsigned rows(int level) const {return nr_[level];}
+  unsigned rows() const { return nr_[0];}
 
   //: the number of pyramid levels
   unsigned n_levels() {return static_cast<unsigned>(n_levels_);}
@@ -67,8 +87,25 @@ class vpgl_generic_camera : public vpgl_camera<T>
   vgl_ray_3d<T> ray(vgl_point_3d<T> const& p) const;
 
   //: the ray index at a given level
+  // Empty for the fine levels of a compact camera, see ray_at()
   vbl_array_2d<vgl_ray_3d<T> >& rays(int level) { return rays_[level];}
 
+  //: the ray of pixel (c, r) at a given level, stored or interpolated
+  vgl_ray_3d<T> ray_at(int level, int r, int c) const;
+
+  //: Replace the rays by the compact grid of every grid_step-th ray
+  // Returns the largest error of the interpolated rays of the other
+  // pixels: the distance between the origins or between the unit
+  // directions, whichever is larger. Does nothing and returns 0 if the
+  // camera is already compact.
+  T compact(unsigned grid_step, bool single_precision = false);
+
+  //: true if only a grid of the rays is stored
+  bool is_compact() const { return grid_step_ > 0; }
+
+  //: the pixel spacing of the ray grid of a compact camera, 0 otherwise
+  unsigned grid_step() const { return grid_step_; }
+
   //: the nearest ray origin to the coordinate origin
   vgl_point_3d<T> min_ray_origin() {return min_ray_origin_;}
   vgl_vector_3d<T> min_ray_direction() {return min_ray_direction_;}
@@ -78,9 +115,13 @@ class vpgl_generic_camera : public vpgl_camera<T>
   vgl_vector_3d<T> max_ray_direction() {return max_ray_direction_;}
 
   //: debug function
+  // Prints the ray origins of a pyramid level through ray_at(), so the
+  // levels a compact camera does not store are printed interpolated.
   void print_orig(int level);
 
   //: visualization
+  // Writes a sphere at each ray origin of a pyramid level, through ray_at()
+  // as for print_orig().
   void print_to_vrml(int level, std::ostream& os);
 
  protected:
@@ -100,6 +141,16 @@ class vpgl_generic_camera : public vpgl_camera<T>
                            vgl_point_3d<T> const& p,
                            vgl_ray_3d<T>& ray) const;
 
+  //: the number of pyramid levels and their sizes for an nr x nc image
+  void set_levels(int nr, int nc);
+
+  //: store the grid and the pyramid levels coarser than the grid
+  void set_grid(vbl_array_2d<vgl_ray_3d<T> > const& grid, unsigned grid_step,
+                bool single_precision);
+
+  //: the ray at (u, v) interpolated from the grid of a compact camera
+  vgl_ray_3d<T> grid_ray(double u, double v) const;
+
   // === members ===
 
   //: ray origin bound to support occlusion reasoning
@@ -118,6 +169,14 @@ class vpgl_generic_camera : public vpgl_camera<T>
   std::vector<int> nc_;
   //: the pyramid
   std::vector<vbl_array_2d<vgl_ray_3d<T> > > rays_;
+
+  //: pixel spacing of the ray grid, 0 if every ray is stored
+  unsigned grid_step_;
+  //: size of the ray grid
+  int grid_rows_, grid_cols_;
+  //: origin and direction of each grid ray, in row order, in one of the two
+  std::vector<T> grid_;
+  std::vector<float> grid_float_;
 };
 
 #endif // vpgl_generic_camera_h_
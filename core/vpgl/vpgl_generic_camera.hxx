@@ -4,7 +4,9 @@
 //:
 // \file
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 #include "vpgl_generic_camera.h"
 #include <vnl/vnl_numeric_traits.h>
@@ -21,6 +23,7 @@
 //-------------------------------------------
 template <class T>
 vpgl_generic_camera<T>::vpgl_generic_camera()
+  : n_levels_(0), grid_step_(0), grid_rows_(0), grid_cols_(0)
 {
     // rays_ is empty and min ray and max ray origins are (0 0 0)
 }
@@ -29,6 +32,7 @@ vpgl_generic_camera<T>::vpgl_generic_camera()
 template <class T>
 vpgl_generic_camera<T>::
     vpgl_generic_camera( vbl_array_2d<vgl_ray_3d<T> > const& rays)
+  : grid_step_(0), grid_rows_(0), grid_cols_(0)
 {
     int nc = rays.cols(), nr = rays.rows();
     assert(nc>0&&nr>0);
@@ -52,28 +56,14 @@ vpgl_generic_camera<T>::
             }
         }
         // form the pyramid for efficient projection
-        // find the number of levels
-        double dim = nc;
-        if (nr<nc)
-            dim = nr;
-        double lv = std::log(dim)/std::log(2.0);
-        n_levels_ = static_cast<int>(lv);// round down
-        if (dim*std::pow(0.5, static_cast<double>(n_levels_-1)) < 32.0) n_levels_--;
-        if (n_levels_<=0) n_levels_ = 1;
-        rays_.resize(n_levels_);
-        nr_.resize(n_levels_);
-        nc_.resize(n_levels_);
+        this->set_levels(nr, nc);
         rays_[0]=rays;
-        nr_[0]=nr; nc_[0]=nc;
-        int nrlv = (nr)/2, nclv = (nc)/2;
         for (int lev = 1; lev<n_levels_; ++lev) {
+            int nrlv = nr_[lev], nclv = nc_[lev];
             rays_[lev].resize(nrlv, nclv);
-            nr_[lev]=nrlv; nc_[lev]=nclv;
             for (int r = 0; r<nrlv; ++r)
                 for (int c = 0; c<nclv; ++c)// nearest neighbor downsampling
                     rays_[lev][r][c] = rays_[lev-1][2*r][2*c];
-            //next level
-            nrlv =(nrlv) / 2; nclv = (nclv) / 2;
         }
 }
 //------------------------------------------
@@ -81,6 +71,7 @@ template <class T>
 vpgl_generic_camera<T>::
     vpgl_generic_camera( std::vector<vbl_array_2d<vgl_ray_3d<T> > > const& rays,
     std::vector<int> nrs,   std::vector<int> ncs  )
+  : grid_step_(0), grid_rows_(0), grid_cols_(0)
 {
     assert(rays.size()>0 && nrs.size()>0 && ncs.size()>0);
     //compute bounds on ray origins
@@ -108,6 +99,186 @@ vpgl_generic_camera<T>::
     nc_ = ncs;
     n_levels_ = rays.size();
 }
+//------------------------------------------
+template <class T>
+vpgl_generic_camera<T>::
+    vpgl_generic_camera( vbl_array_2d<vgl_ray_3d<T> > const& grid, unsigned grid_step,
+                         int nr, int nc, bool single_precision)
+{
+    assert(grid_step>0 && nr>0 && nc>0);
+    //compute bounds on ray origins. The distance from the datum is convex
+    //along the segments between grid origins, so the furthest is a grid ray
+    double min_dist = vnl_numeric_traits<double>::maxval;
+    double max_dist = 0.0;
+    vgl_point_3d<T> datum(T(0), T(0), T(0));
+    for (unsigned v = 0; v<grid.rows(); ++v)
+        for (unsigned u = 0; u<grid.cols(); ++u) {
+            vgl_point_3d<T> org = grid[v][u].origin();
+            double d = vgl_distance(datum, org);
+            if (d>max_dist) {
+                max_dist = d;
+                max_ray_origin_ = org;
+                max_ray_direction_ = grid[v][u].direction();
+            }
+            if (d<min_dist) {
+                min_dist = d;
+                min_ray_origin_ = org;
+                min_ray_direction_ = grid[v][u].direction();
+            }
+        }
+    this->set_levels(nr, nc);
+    this->set_grid(grid, grid_step, single_precision);
+}
+
+// levels are halved in size, down to about 32 pixels
+template <class T>
+void vpgl_generic_camera<T>::set_levels(int nr, int nc)
+{
+    // find the number of levels
+    double dim = nc;
+    if (nr<nc)
+        dim = nr;
+    double lv = std::log(dim)/std::log(2.0);
+    n_levels_ = static_cast<int>(lv);// round down
+    if (dim*std::pow(0.5, static_cast<double>(n_levels_-1)) < 32.0) n_levels_--;
+    if (n_levels_<=0) n_levels_ = 1;
+    rays_.resize(n_levels_);
+    nr_.resize(n_levels_);
+    nc_.resize(n_levels_);
+    int nrlv = nr, nclv = nc;
+    for (int lev = 0; lev<n_levels_; ++lev) {
+        nr_[lev]=nrlv; nc_[lev]=nclv;
+        nrlv =(nrlv) / 2; nclv = (nclv) / 2;
+    }
+}
+
+// Levels with pixels at least grid_step apart are stored, so that the
+// search for the nearest ray interpolates only a few rays at each of the
+// finer levels, and the storage is about that of the grid
+template <class T>
+void vpgl_generic_camera<T>::
+    set_grid(vbl_array_2d<vgl_ray_3d<T> > const& grid, unsigned grid_step,
+    bool single_precision)
+{
+    int step = static_cast<int>(grid_step);
+    grid_step_ = grid_step;
+    grid_rows_ = static_cast<int>(grid.rows());
+    grid_cols_ = static_cast<int>(grid.cols());
+    assert(grid_rows_ == (nr_[0]+step-2)/step+1);
+    assert(grid_cols_ == (nc_[0]+step-2)/step+1);
+    std::vector<T> g(6*grid.size());
+    for (int r = 0, i = 0; r<grid_rows_; ++r)
+        for (int c = 0; c<grid_cols_; ++c, i+=6) {
+            vgl_point_3d<T> org = grid[r][c].origin();
+            vgl_vector_3d<T> dir = grid[r][c].direction();
+            g[i] = org.x(); g[i+1] = org.y(); g[i+2] = org.z();
+            g[i+3] = dir.x(); g[i+4] = dir.y(); g[i+5] = dir.z();
+        }
+    if (single_precision) {
+        grid_float_.assign(g.begin(), g.end());
+        grid_.clear();
+    }
+    else {
+        grid_.swap(g);
+        grid_float_.clear();
+    }
+    for (int lev = 0; lev<n_levels_; ++lev) {
+        if (lev == 0 || (1<<lev) < step) {
+            rays_[lev].clear();
+            continue;
+        }
+        rays_[lev].resize(nr_[lev], nc_[lev]);
+        for (int r = 0; r<nr_[lev]; ++r)
+            for (int c = 0; c<nc_[lev]; ++c)
+                rays_[lev][r][c] = this->grid_ray(double(c<<lev), double(r<<lev));
+    }
+}
+
+namespace
+{
+  //: bilinear interpolation of the origins and directions of four grid rays
+  template <class S>
+  void vpgl_generic_grid_interpolate(const S* g, std::size_t i00, std::size_t i01,
+                                     std::size_t i10, std::size_t i11,
+                                     double a, double b, double* x)
+  {
+    const double w00 = (1-a)*(1-b), w01 = a*(1-b), w10 = (1-a)*b, w11 = a*b;
+    const S* g00 = g+6*i00; const S* g01 = g+6*i01;
+    const S* g10 = g+6*i10; const S* g11 = g+6*i11;
+    for (unsigned k = 0; k<6; ++k)
+      x[k] = w00*g00[k] + w01*g01[k] + w10*g10[k] + w11*g11[k];
+  }
+}
+
+// the grid cell is found directly, the last cell may be narrower than
+// the grid step and points outside the grid are extrapolated
+template <class T>
+vgl_ray_3d<T> vpgl_generic_camera<T>::grid_ray(double u, double v) const
+{
+    int step = static_cast<int>(grid_step_);
+    int c = 0, r = 0, dc = 0, dr = 0;
+    double a = 0.0, b = 0.0;
+    if (grid_cols_>1) {
+        c = u>0.0 ? static_cast<int>(u)/step : 0;
+        if (c>grid_cols_-2) c = grid_cols_-2;
+        int u0 = c*step, u1 = std::min(u0+step, nc_[0]-1);
+        a = (u-u0)/(u1-u0);
+        dc = 1;
+    }
+    if (grid_rows_>1) {
+        r = v>0.0 ? static_cast<int>(v)/step : 0;
+        if (r>grid_rows_-2) r = grid_rows_-2;
+        int v0 = r*step, v1 = std::min(v0+step, nr_[0]-1);
+        b = (v-v0)/(v1-v0);
+        dr = grid_cols_;
+    }
+    std::size_t i00 = static_cast<std::size_t>(r)*grid_cols_ + c;
+    double x[6];
+    if (grid_float_.empty())
+        vpgl_generic_grid_interpolate(&grid_[0], i00, i00+dc, i00+dr, i00+dr+dc, a, b, x);
+    else
+        vpgl_generic_grid_interpolate(&grid_float_[0], i00, i00+dc, i00+dr, i00+dr+dc, a, b, x);
+    return vgl_ray_3d<T>(vgl_point_3d<T>(static_cast<T>(x[0]), static_cast<T>(x[1]), static_cast<T>(x[2])),
+                         vgl_vector_3d<T>(static_cast<T>(x[3]), static_cast<T>(x[4]), static_cast<T>(x[5])));
+}
+
+template <class T>
+vgl_ray_3d<T> vpgl_generic_camera<T>::ray_at(int level, int r, int c) const
+{
+    if (rays_[level].rows()>0)
+        return rays_[level][r][c];
+    return this->grid_ray(double(c<<level), double(r<<level));
+}
+
+template <class T>
+T vpgl_generic_camera<T>::compact(unsigned grid_step, bool single_precision)
+{
+    if (grid_step_>0 || rays_.empty())
+        return T(0);
+    assert(grid_step>0);
+    int step = static_cast<int>(grid_step);
+    int nr = nr_[0], nc = nc_[0];
+    vbl_array_2d<vgl_ray_3d<T> > grid((nr+step-2)/step+1, (nc+step-2)/step+1);
+    for (unsigned r = 0; r<grid.rows(); ++r)
+        for (unsigned c = 0; c<grid.cols(); ++c)
+            grid[r][c] = rays_[0][std::min(int(r)*step, nr-1)][std::min(int(c)*step, nc-1)];
+    // keep the full rays to measure the interpolation error
+    std::vector<vbl_array_2d<vgl_ray_3d<T> > > full(n_levels_);
+    full.swap(rays_);
+    this->set_grid(grid, grid_step, single_precision);
+    T max_err = T(0);
+    for (int r = 0; r<nr; ++r)
+        for (int c = 0; c<nc; ++c) {
+            vgl_ray_3d<T> const& fr = full[0][r][c];
+            vgl_ray_3d<T> gr = this->grid_ray(double(c), double(r));
+            T err = static_cast<T>(vgl_distance(fr.origin(), gr.origin()));
+            T derr = static_cast<T>((fr.direction()-gr.direction()).length());
+            if (derr>err) err = derr;
+            if (err>max_err) max_err = err;
+        }
+    return max_err;
+}
+
 // the ray closest to the given 3-d point is selected
 // note that the ray is taken to be an infinite 3-d line
 // and so the bound of the ray origin is not taken into account
@@ -126,7 +297,7 @@ void vpgl_generic_camera<T>::nearest_ray(int level,
     double min_d = vnl_numeric_traits<double>::maxval;
     for (int r = start_r; r<=end_r; ++r)
         for (int c = start_c; c<=end_c; ++c) {
-            double d = vgl_distance(rays_[level][r][c], p);
+            double d = vgl_distance(this->ray_at(level, r, c), p);
             if (d<min_d) {
                 min_d=d;
                 nearest_r = r;
@@ -196,7 +367,7 @@ void vpgl_generic_camera<T>::
     T& u, T& v) const
 {
     // the ray closest to the projected 3-d point
-    vgl_ray_3d<T> nr = rays_[0][nearest_r][nearest_c];
+    vgl_ray_3d<T> nr = this->ray_at(0, nearest_r, nearest_c);
     // construct plane with normal given by -nr.direction() through p
     vgl_plane_3d<T> pl(-nr.direction(), p);
     bool valid_inter = true;
@@ -212,7 +383,7 @@ void vpgl_generic_camera<T>::
     bool horiz = false;
     bool vert = false;
     if (nearest_r>0 && !horiz) {
-        vgl_ray_3d<T> r = rays_[0][nearest_r-1][nearest_c];
+        vgl_ray_3d<T> r = this->ray_at(0, nearest_r-1, nearest_c);
         valid_inter = vgl_intersection(r, pl, ipt);
         if(std::fabs((ipt-inter_pts[0]).length())  > vnl_math::eps)
         {
@@ -222,7 +393,7 @@ void vpgl_generic_camera<T>::
         }
     }
     if (nearest_c>0 && !vert) {
-        vgl_ray_3d<T> r = rays_[0][nearest_r][nearest_c-1];
+        vgl_ray_3d<T> r = this->ray_at(0, nearest_r, nearest_c-1);
         valid_inter = vgl_intersection(r, pl, ipt);
         if(std::fabs((ipt-inter_pts[0]).length())  > vnl_math::eps)
         {
@@ -233,7 +404,7 @@ void vpgl_generic_camera<T>::
     }
     int nrght = static_cast<int>(cols())-1;
     if (nearest_c<nrght && !vert ) {
-        vgl_ray_3d<T> r = rays_[0][nearest_r][nearest_c+1];
+        vgl_ray_3d<T> r = this->ray_at(0, nearest_r, nearest_c+1);
         valid_inter = vgl_intersection(r, pl, ipt);
         if(std::fabs((ipt-inter_pts[0]).length())  > vnl_math::eps)
         {
@@ -244,7 +415,7 @@ void vpgl_generic_camera<T>::
     }
     int nbl = static_cast<int>(rows())-1;
     if (nearest_r<nbl && !horiz ) {
-        vgl_ray_3d<T> r = rays_[0][nearest_r+1][nearest_c];
+        vgl_ray_3d<T> r = this->ray_at(0, nearest_r+1, nearest_c);
         valid_inter = vgl_intersection(r, pl, ipt);
         if(std::fabs((ipt-inter_pts[0]).length())  > vnl_math::eps)
         {
@@ -309,6 +480,8 @@ vgl_ray_3d<T> vpgl_generic_camera<T>::ray(const T u, const T v) const
         assert(false);
         return vgl_ray_3d<T>();
     }
+    if (grid_step_>0)
+        return this->grid_ray(du, dv);
     int iu, iv;
     iu = du<nright ? static_cast<int>(du) : nright-1;
     iv = dv<nbelow ? static_cast<int>(dv) : nbelow-1;
@@ -371,7 +544,7 @@ void vpgl_generic_camera<T>::print_orig(int level)
 {
     for (int r = 0; r<nr_[level]; ++r) {
         for (int c = 0; c<nc_[level]; ++c) {
-            vgl_point_3d<T> o = rays_[level][r][c].origin();
+            vgl_point_3d<T> o = this->ray_at(level, r, c).origin();
             std::cout << '(' << o.x() << ' ' << o.y() << ") ";
         }
         std::cout << '\n';
@@ -383,7 +556,7 @@ void vpgl_generic_camera<T>::print_to_vrml(int level, std::ostream& os)
 {
     for (int r = 0; r<nr_[level]; ++r) {
         for (int c = 0; c<nc_[level]; ++c) {
-            vgl_point_3d<T> o = rays_[level][r][c].origin();
+            vgl_point_3d<T> o = this->ray_at(level, r, c).origin();
             os<< "Transform {\n"
                 << "translation " << o.x() << ' ' << o.y() << ' '
                 << ' ' << o.z() << '\n'
@@ -63,6 +63,11 @@ vpgl_lvcs lvcs() const {return lvcs_;}
 //: The generic camera interface. u represents image column, v image row.
 virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+//: Project \p n points stored as local x, y, z triples into \p uv, as u, v pairs.
+// Each block of points is converted to geographic coordinates and then
+// projected by the block-wise rational polynomial kernel.
+virtual void project(const T* xyz, std::size_t n, T* uv) const;
+
 // Interface for vnl
 
 //: Project a world point onto the image
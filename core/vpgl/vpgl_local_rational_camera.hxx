@@ -4,6 +4,7 @@
 //:
 // \file
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include "vpgl_local_rational_camera.h"
 #include <vcl_compiler.h>
@@ -60,6 +61,29 @@ void vpgl_local_rational_camera<T>::project(const T x, const T y, const T z,
   vpgl_rational_camera<T>::project((T)lon, (T)lat, (T)gz, u, v);
 }
 
+template <class T>
+void vpgl_local_rational_camera<T>::project(const T* xyz, std::size_t n, T* uv) const
+{
+  // local_to_global() only reads the lvcs, so the threads may share it
+  vpgl_lvcs& non_const_lvcs = const_cast<vpgl_lvcs&>(lvcs_);
+  vpgl_project_ranges(n, [&](std::size_t begin, std::size_t end)
+  {
+    T x[vpgl_project_block_size], y[vpgl_project_block_size], z[vpgl_project_block_size];
+    for (std::size_t b = begin; b < end; b += vpgl_project_block_size)
+    {
+      const unsigned m = unsigned(std::min<std::size_t>(vpgl_project_block_size, end - b));
+      const T* in = xyz + 3*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        double lon, lat, gz;
+        non_const_lvcs.local_to_global(in[3*i], in[3*i+1], in[3*i+2], vpgl_lvcs::wgs84, lon, lat, gz);
+        x[i] = T(lon); y[i] = T(lat); z[i] = T(gz);
+      }
+      this->project_block(x, y, z, m, uv + 2*b);
+    }
+  });
+}
+
 //vnl interface methods
 template <class T>
 vnl_vector_fixed<T, 2>
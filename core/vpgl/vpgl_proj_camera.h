@@ -12,6 +12,7 @@
 //  Modifications
 //  May 6, 2005  Ricardo Fabbri   Added binary I/O
 //  March 14, 2010 J.L. Mundy made some methods virtual to handle affine case
+//  Oct 2026 - Added block-wise projection of arrays of points
 // \endverbatim
 //
 // This is the most general camera class based around the 3x4 matrix camera model.
@@ -101,6 +102,13 @@ class vpgl_proj_camera : public vpgl_camera<T>
   //: Projection from base class
   virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+  //: Project \p n points stored as x, y, z triples into \p uv, as u, v pairs.
+  // The points are multiplied by the matrix in blocks, one coordinate array
+  // at a time so that the loops vectorise, and large arrays are split
+  // between threads. As with the single point project(), points that
+  // project to infinity give (0, 0); one warning is printed for the lot.
+  virtual void project(const T* xyz, std::size_t n, T* uv) const;
+
   //: Project a point in world coordinates onto the image plane.
   virtual vgl_homg_point_2d<T> project( const vgl_homg_point_3d<T>& world_point ) const;
 
@@ -4,6 +4,9 @@
 //:
 // \file
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include "vpgl_proj_camera.h"
@@ -114,6 +117,57 @@ vpgl_proj_camera<T>::project(const T x, const T y, const T z, T& u, T& v) const
   v = image_point.y()/image_point.w();
 }
 
+//------------------------------------
+template <class T>
+void
+vpgl_proj_camera<T>::project(const T* xyz, std::size_t n, T* uv) const
+{
+  const T* P = P_.data_block();
+  const T tol = static_cast<T>(1.0e-10);
+  std::atomic<bool> any_ideal(false);
+  vpgl_project_ranges(n, [&](std::size_t begin, std::size_t end)
+  {
+    T x[vpgl_project_block_size], y[vpgl_project_block_size], z[vpgl_project_block_size];
+    T a[vpgl_project_block_size], c[vpgl_project_block_size], w[vpgl_project_block_size];
+    T u[vpgl_project_block_size], v[vpgl_project_block_size];
+    bool ideal = false;
+    for (std::size_t b = begin; b < end; b += vpgl_project_block_size)
+    {
+      const unsigned m = unsigned(std::min<std::size_t>(vpgl_project_block_size, end - b));
+      const T* in = xyz + 3*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        x[i] = in[3*i]; y[i] = in[3*i+1]; z[i] = in[3*i+2];
+      }
+      for (unsigned i = 0; i < m; ++i)
+      {
+        a[i] = P[0]*x[i] + P[1]*y[i] + P[2]*z[i] + P[3];
+        c[i] = P[4]*x[i] + P[5]*y[i] + P[6]*z[i] + P[7];
+        w[i] = P[8]*x[i] + P[9]*y[i] + P[10]*z[i] + P[11];
+        u[i] = a[i]/w[i];
+        v[i] = c[i]/w[i];
+      }
+      // Kept out of the loop above, which would not vectorise with it
+      for (unsigned i = 0; i < m; ++i)
+        if (std::abs(w[i]) <= tol*std::abs(a[i]) || std::abs(w[i]) <= tol*std::abs(c[i]))
+        {
+          u[i] = v[i] = T(0);
+          ideal = true;
+        }
+      T* out = uv + 2*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        out[2*i] = u[i]; out[2*i+1] = v[i];
+      }
+    }
+    if (ideal)
+      any_ideal = true;
+  });
+  if (any_ideal)
+    std::cerr << "Warning: projection to ideal image point in vpgl_proj_camera -"
+              << " result not valid\n";
+}
+
 //------------------------------------
 template <class T>
 vgl_line_segment_2d<T> vpgl_proj_camera<T>::project(
@@ -213,6 +213,12 @@ class vpgl_rational_camera : public vpgl_camera<T>
   //: The generic camera interface. u represents image column, v image row.
   virtual void project(const T x, const T y, const T z, T& u, T& v) const;
 
+  //: Project \p n points stored as x, y, z triples into \p uv, as u, v pairs.
+  // The polynomials are evaluated in nested (Horner) form on blocks of
+  // points held one coordinate per array, and large arrays are split
+  // between threads.
+  virtual void project(const T* xyz, std::size_t n, T* uv) const;
+
         // --- Interface for vnl ---
 
   //: Project a world point onto the image
@@ -232,6 +238,9 @@ class vpgl_rational_camera : public vpgl_camera<T>
  protected:
   // utilities
   vnl_vector_fixed<T, 20> power_vector(const T x, const T y, const T z) const;
+  //: Project the \p m <= vpgl_project_block_size points (x[i], y[i], z[i]) into \p uv.
+  // The coordinate arrays are overwritten with their normalized values.
+  void project_block(T* x, T* y, T* z, unsigned m, T* uv) const;
   // members
   vnl_matrix_fixed<T, 4, 20> rational_coeffs_;
   std::vector<vpgl_scale_offset<T> > scale_offsets_;
@@ -5,6 +5,7 @@
 // \file
 
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include "vpgl_rational_camera.h"
 #include <vcl_compiler.h>
@@ -207,6 +208,80 @@ void vpgl_rational_camera<T>::project(const T x, const T y, const T z,
   v = scale_offsets_[V_INDX].un_normalize(sv);
 }
 
+namespace
+{
+  //: a[i] = so.normalize(a[i]) for each i < m
+  template <class T>
+  inline void vpgl_rational_normalize(T* a, unsigned m, vpgl_scale_offset<T> const& so)
+  {
+    const T scale = so.scale(), offset = so.offset();
+    if (scale == 0)
+      std::fill(a, a + m, T(0));
+    else
+      for (unsigned i = 0; i < m; ++i)
+        a[i] = (a[i] - offset)/scale;
+  }
+
+  //: p[i] = the cubic with coefficients c, in power_vector() order, at (x[i], y[i], z[i])
+  template <class T>
+  inline void vpgl_rational_horner(const T* c, const T* x, const T* y, const T* z,
+                                   unsigned m, T* p)
+  {
+    for (unsigned i = 0; i < m; ++i)
+    {
+      const T xi = x[i], yi = y[i], zi = z[i];
+      p[i] = xi*(xi*(c[0]*xi + c[1]*yi + c[2]*zi + c[3]) +
+                 yi*(c[4]*yi + c[5]*zi + c[6]) + zi*(c[7]*zi + c[8]) + c[9]) +
+             yi*(yi*(c[10]*yi + c[11]*zi + c[12]) + zi*(c[13]*zi + c[14]) + c[15]) +
+             zi*(zi*(c[16]*zi + c[17]) + c[18]) + c[19];
+    }
+  }
+}
+
+template <class T>
+void vpgl_rational_camera<T>::project_block(T* x, T* y, T* z, unsigned m, T* uv) const
+{
+  vpgl_rational_normalize(x, m, scale_offsets_[X_INDX]);
+  vpgl_rational_normalize(y, m, scale_offsets_[Y_INDX]);
+  vpgl_rational_normalize(z, m, scale_offsets_[Z_INDX]);
+  T nu[vpgl_project_block_size], du[vpgl_project_block_size];
+  T nv[vpgl_project_block_size], dv[vpgl_project_block_size];
+  vpgl_rational_horner(rational_coeffs_[NEU_U], x, y, z, m, nu);
+  vpgl_rational_horner(rational_coeffs_[DEN_U], x, y, z, m, du);
+  vpgl_rational_horner(rational_coeffs_[NEU_V], x, y, z, m, nv);
+  vpgl_rational_horner(rational_coeffs_[DEN_V], x, y, z, m, dv);
+  const T u_scale = scale_offsets_[U_INDX].scale(), u_off = scale_offsets_[U_INDX].offset();
+  const T v_scale = scale_offsets_[V_INDX].scale(), v_off = scale_offsets_[V_INDX].offset();
+  for (unsigned i = 0; i < m; ++i)
+  {
+    nu[i] = nu[i]/du[i]*u_scale + u_off;
+    nv[i] = nv[i]/dv[i]*v_scale + v_off;
+  }
+  for (unsigned i = 0; i < m; ++i)
+  {
+    uv[2*i] = nu[i]; uv[2*i+1] = nv[i];
+  }
+}
+
+template <class T>
+void vpgl_rational_camera<T>::project(const T* xyz, std::size_t n, T* uv) const
+{
+  vpgl_project_ranges(n, [&](std::size_t begin, std::size_t end)
+  {
+    T x[vpgl_project_block_size], y[vpgl_project_block_size], z[vpgl_project_block_size];
+    for (std::size_t b = begin; b < end; b += vpgl_project_block_size)
+    {
+      const unsigned m = unsigned(std::min<std::size_t>(vpgl_project_block_size, end - b));
+      const T* in = xyz + 3*b;
+      for (unsigned i = 0; i < m; ++i)
+      {
+        x[i] = in[3*i]; y[i] = in[3*i+1]; z[i] = in[3*i+2];
+      }
+      project_block(x, y, z, m, uv + 2*b);
+    }
+  });
+}
+
 //vnl interface methods
 template <class T>
 vnl_vector_fixed<T, 2>